@@ -10,6 +10,8 @@
 #include <linux/uaccess.h>
 #include <linux/highmem.h>
 
+#include <asm/special_insns.h>
+
 /*
  * Zero Userspace
  */
@@ -90,6 +92,33 @@ void __memcpy_flushcache(void *_dst, const void *_src, size_t size)
 			return;
 	}
 
+	/*
+	 * MOVDIR64B does 64-byte direct stores to the destination without
+	 * a read for ownership, so prefer it for bulk copies when available.
+	 * The destination must be 64-byte aligned, the source may have any
+	 * alignment.
+	 */
+	if (static_cpu_has(X86_FEATURE_MOVDIR64B) && size >= 64) {
+		/* 1x8 movnti to align the destination to 64 bytes */
+		while (size >= 64 && !IS_ALIGNED(dest, 64)) {
+			asm("movq    (%0), %%r8\n"
+			    "movnti  %%r8,   (%1)\n"
+			    :: "r" (source), "r" (dest)
+			    : "memory", "r8");
+			dest += 8;
+			source += 8;
+			size -= 8;
+		}
+
+		/* 1x64 movdir64b loop */
+		while (size >= 64) {
+			movdir64b((void __iomem *) dest, (void *) source);
+			dest += 64;
+			source += 64;
+			size -= 64;
+		}
+	}
+
 	/* 4x8 movnti loop */
 	while (size >= 32) {
 		asm("movq    (%0), %%r8\n"
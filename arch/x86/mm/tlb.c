@@ -978,7 +978,7 @@ static void put_flush_tlb_info(void)
 #endif
 }
 
-void flush_tlb_mm_range(struct mm_struct *mm, unsigned long start,
+static void __flush_tlb_mm_range(struct mm_struct *mm, unsigned long start,
 				unsigned long end, unsigned int stride_shift,
 				bool freed_tables)
 {
@@ -1019,6 +1019,109 @@ void flush_tlb_mm_range(struct mm_struct *mm, unsigned long start,
 	put_cpu();
 }
 
+/* Flush rounds that batching collapsed into one; exposed via debugfs */
+static atomic_t tlb_batch_flushes_saved;
+
+/*
+ * Absorb a flush request into the mm's pending batch if the calling task
+ * has one open.  Only the batch owner defers its flushes - requests from
+ * other tasks (and other tasks' flushes of this mm) keep their immediate
+ * semantics - so the accumulation needs no locking.
+ */
+static bool tlb_batch_defer(struct mm_struct *mm, unsigned long start,
+			    unsigned long end, unsigned int stride_shift,
+			    bool freed_tables)
+{
+	struct tlb_flush_batch *batch = &mm->tlb_batch;
+
+	if (READ_ONCE(batch->owner) != current)
+		return false;
+
+	batch->start = min(batch->start, start);
+	batch->end = max(batch->end, end);
+	if (stride_shift < batch->stride_shift)
+		batch->stride_shift = stride_shift;
+	batch->freed_tables |= freed_tables;
+	batch->deferred++;
+	return true;
+}
+
+/**
+ * flush_tlb_batch_begin - open a TLB flush accumulation section
+ * @mm: the mm whose flushes are to be batched
+ *
+ * Until the matching flush_tlb_batch_end(), ranged TLB flushes that the
+ * calling task requests for @mm are accumulated instead of being issued
+ * individually, and one combined flush covering the union of the ranges is
+ * sent at the end.  This turns a burst of small unmaps into a single
+ * shootdown round.
+ *
+ * The caller must not free any page unmapped inside the section until
+ * flush_tlb_batch_end() returns - the same contract as mmu_gather - which
+ * makes page-table lock release and pte_unmap the natural places to close
+ * a section.  Sections nest, and only the task that opened the batch has
+ * its flushes deferred: if another task is already batching on @mm, this
+ * call is a no-op and the caller's flushes stay immediate.
+ */
+void flush_tlb_batch_begin(struct mm_struct *mm)
+{
+	struct tlb_flush_batch *batch = &mm->tlb_batch;
+
+	if (READ_ONCE(batch->owner) == current) {
+		batch->depth++;
+		return;
+	}
+
+	if (cmpxchg(&batch->owner, NULL, current) != NULL)
+		return;
+
+	batch->depth = 1;
+	batch->start = TLB_FLUSH_ALL;
+	batch->end = 0;
+	batch->stride_shift = PAGE_SHIFT;
+	batch->freed_tables = false;
+	batch->deferred = 0;
+}
+
+/**
+ * flush_tlb_batch_end - close a TLB flush accumulation section
+ * @mm: the mm whose flushes were batched
+ *
+ * On leaving the outermost section, issue one combined flush covering all
+ * the ranges deferred since flush_tlb_batch_begin().
+ */
+void flush_tlb_batch_end(struct mm_struct *mm)
+{
+	struct tlb_flush_batch *batch = &mm->tlb_batch;
+
+	if (READ_ONCE(batch->owner) != current)
+		return;
+
+	if (--batch->depth)
+		return;
+
+	if (batch->end) {
+		__flush_tlb_mm_range(mm, batch->start, batch->end,
+				     batch->stride_shift, batch->freed_tables);
+		if (batch->deferred > 1)
+			atomic_add(batch->deferred - 1,
+				   &tlb_batch_flushes_saved);
+	}
+
+	/* Release ownership only once the combined flush is done */
+	smp_store_release(&batch->owner, NULL);
+}
+
+void flush_tlb_mm_range(struct mm_struct *mm, unsigned long start,
+				unsigned long end, unsigned int stride_shift,
+				bool freed_tables)
+{
+	if (tlb_batch_defer(mm, start, end, stride_shift, freed_tables))
+		return;
+
+	__flush_tlb_mm_range(mm, start, end, stride_shift, freed_tables);
+}
+
 
 static void do_flush_tlb_all(void *info)
 {
@@ -1318,6 +1421,8 @@ static int __init create_tlb_single_page_flush_ceiling(void)
 {
 	debugfs_create_file("tlb_single_page_flush_ceiling", S_IRUSR | S_IWUSR,
 			    arch_debugfs_dir, NULL, &fops_tlbflush);
+	debugfs_create_atomic_t("tlb_batch_flushes_saved", S_IRUSR,
+				arch_debugfs_dir, &tlb_batch_flushes_saved);
 	return 0;
 }
 late_initcall(create_tlb_single_page_flush_ceiling);
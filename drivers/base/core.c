@@ -2427,6 +2427,7 @@ static void device_release(struct kobject *kobj)
 	devres_release_all(dev);
 
 	kfree(dev->dma_range_map);
+	swiotlb_dev_exit(dev);
 
 	if (dev->release)
 		dev->release(dev);
@@ -833,6 +833,24 @@ static int __init save_async_options(char *buf)
 }
 __setup("driver_async_probe=", save_async_options);
 
+/*
+ * Probe devices asynchronously by default so that independent subtrees
+ * of the device hierarchy are brought up on all CPUs in parallel.
+ * Drivers can force synchronous probing with PROBE_FORCE_SYNCHRONOUS
+ * and whole buses can opt out via bus_type::sync_probe; boot with
+ * "driver_probe_parallel=off" to fall back to opt-in async probing.
+ */
+static bool driver_probe_parallel = true;
+
+static int __init save_probe_parallel(char *buf)
+{
+	if (kstrtobool(buf, &driver_probe_parallel))
+		pr_warn("Invalid 'driver_probe_parallel' value, ignoring\n");
+
+	return 1;
+}
+__setup("driver_probe_parallel=", save_probe_parallel);
+
 static bool driver_allows_async_probing(struct device_driver *drv)
 {
 	switch (drv->probe_type) {
@@ -849,6 +867,9 @@ static bool driver_allows_async_probing(struct device_driver *drv)
 		if (module_requested_async_probing(drv->owner))
 			return true;
 
+		if (driver_probe_parallel && drv->bus && !drv->bus->sync_probe)
+			return true;
+
 		return false;
 	}
 }
@@ -929,6 +950,43 @@ static int __device_attach_driver(struct device_driver *drv, void *_data)
 	return ret == 0;
 }
 
+/*
+ * Order an asynchronous probe behind the device's dependency edges so
+ * that independent subtrees proceed in parallel while any given path
+ * through the parent/supplier graph is probed in topological order.
+ * Waiting here is an optimization, not a correctness requirement: a
+ * consumer that slips through before its supplier is bound still gets
+ * -EPROBE_DEFER from really_probe() and is retried once the supplier
+ * binds, it just burns a deferral cycle doing so.
+ */
+static void driver_async_probe_order(struct device *dev)
+{
+	struct device *parent = dev->parent;
+	struct device_link *link;
+	int idx;
+
+	if (parent && parent->p) {
+		wait_event(probe_waitqueue, !parent->p->async_driver);
+		/* Serialize against a parent probe already in flight. */
+		device_lock(parent);
+		device_unlock(parent);
+	}
+
+	idx = device_links_read_lock();
+	list_for_each_entry_rcu(link, &dev->links.suppliers, c_node,
+				device_links_read_lock_held()) {
+		struct device *supplier = link->supplier;
+
+		if (link->flags & DL_FLAG_SYNC_STATE_ONLY)
+			continue;
+
+		if (supplier->p)
+			wait_event(probe_waitqueue,
+				   !supplier->p->async_driver);
+	}
+	device_links_read_unlock(idx);
+}
+
 static void __device_attach_async_helper(void *_dev, async_cookie_t cookie)
 {
 	struct device *dev = _dev;
@@ -938,6 +996,8 @@ static void __device_attach_async_helper(void *_dev, async_cookie_t cookie)
 		.want_async	= true,
 	};
 
+	driver_async_probe_order(dev);
+
 	device_lock(dev);
 
 	/*
@@ -1110,6 +1170,8 @@ static void __driver_attach_async_helper(void *_dev, async_cookie_t cookie)
 	struct device_driver *drv;
 	int ret;
 
+	driver_async_probe_order(dev);
+
 	__device_driver_lock(dev, dev->parent);
 	drv = dev->p->async_driver;
 	dev->p->async_driver = NULL;
@@ -35,6 +35,7 @@
 #include <linux/syscore_ops.h>
 #include <linux/reboot.h>
 #include <linux/security.h>
+#include <linux/sizes.h>
 #include <linux/zstd.h>
 #include <linux/xz.h>
 
@@ -229,6 +230,100 @@ void free_fw_priv(struct fw_priv *fw_priv)
 		spin_unlock(&fwc->lock);
 }
 
+/*
+ * Successfully loaded blobs are retained in memory for a grace period
+ * after the last user releases them, so that a burst of requests for
+ * the same image - instantiating all the VFs of a NIC, say - is served
+ * from the in-memory copy via the usual request batching instead of
+ * re-reading the blob from disk once per function.
+ */
+#define FW_RETENTION_TIMEOUT	(30 * HZ)
+
+struct fw_retained {
+	struct list_head list;
+	struct fw_priv *fw_priv;
+	unsigned long expiry;
+};
+
+static LIST_HEAD(fw_retention_list);
+static DEFINE_SPINLOCK(fw_retention_lock);
+static void fw_retention_reap(struct work_struct *work);
+static DECLARE_DELAYED_WORK(fw_retention_work, fw_retention_reap);
+
+static void fw_retention_reap(struct work_struct *work)
+{
+	struct fw_retained *fr, *tmp;
+	unsigned long next = 0;
+	LIST_HEAD(expired);
+
+	spin_lock(&fw_retention_lock);
+	list_for_each_entry_safe(fr, tmp, &fw_retention_list, list) {
+		if (time_after_eq(jiffies, fr->expiry))
+			list_move(&fr->list, &expired);
+		else if (!next || time_before(fr->expiry, next))
+			next = fr->expiry;
+	}
+	spin_unlock(&fw_retention_lock);
+
+	list_for_each_entry_safe(fr, tmp, &expired, list) {
+		free_fw_priv(fr->fw_priv);
+		kfree(fr);
+	}
+
+	if (next)
+		schedule_delayed_work(&fw_retention_work, next - jiffies);
+}
+
+static void fw_retention_add(struct fw_priv *fw_priv)
+{
+	struct fw_retained *fr;
+
+	/* Only plain cacheable full reads are worth keeping around. */
+	if (fw_priv->opt_flags & (FW_OPT_NOCACHE | FW_OPT_PARTIAL))
+		return;
+
+	spin_lock(&fw_retention_lock);
+	list_for_each_entry(fr, &fw_retention_list, list) {
+		if (fr->fw_priv == fw_priv) {
+			fr->expiry = jiffies + FW_RETENTION_TIMEOUT;
+			spin_unlock(&fw_retention_lock);
+			return;
+		}
+	}
+	spin_unlock(&fw_retention_lock);
+
+	fr = kzalloc(sizeof(*fr), GFP_KERNEL);
+	if (!fr)
+		return;
+
+	kref_get(&fw_priv->ref);
+	fr->fw_priv = fw_priv;
+	fr->expiry = jiffies + FW_RETENTION_TIMEOUT;
+
+	spin_lock(&fw_retention_lock);
+	list_add_tail(&fr->list, &fw_retention_list);
+	spin_unlock(&fw_retention_lock);
+
+	schedule_delayed_work(&fw_retention_work, FW_RETENTION_TIMEOUT);
+}
+
+static void fw_retention_flush(void)
+{
+	struct fw_retained *fr, *tmp;
+	LIST_HEAD(doomed);
+
+	cancel_delayed_work_sync(&fw_retention_work);
+
+	spin_lock(&fw_retention_lock);
+	list_splice_init(&fw_retention_list, &doomed);
+	spin_unlock(&fw_retention_lock);
+
+	list_for_each_entry_safe(fr, tmp, &doomed, list) {
+		free_fw_priv(fr->fw_priv);
+		kfree(fr);
+	}
+}
+
 #ifdef CONFIG_FW_LOADER_PAGED_BUF
 bool fw_is_paged_buf(struct fw_priv *fw_priv)
 {
@@ -484,6 +579,117 @@ static const char * const fw_path[] = {
 module_param_string(path, fw_path_para, sizeof(fw_path_para), 0644);
 MODULE_PARM_DESC(path, "customized firmware image search path with a higher priority than default path");
 
+/*
+ * Blobs at least this large are pulled in with parallel segmented reads
+ * rather than one sequential read on the requesting CPU.
+ */
+#define FW_PARALLEL_READ_MIN		SZ_8M
+#define FW_PARALLEL_READ_MAX_SEGS	8
+
+static ASYNC_DOMAIN_EXCLUSIVE(fw_parallel_read_domain);
+
+struct fw_read_segment {
+	const char *path;
+	void *buf;
+	size_t offset;
+	size_t size;
+	int ret;
+};
+
+static void fw_read_segment_work(void *data, async_cookie_t cookie)
+{
+	struct fw_read_segment *seg = data;
+	size_t file_size = 0;
+	void *buf = seg->buf;
+	ssize_t rc;
+
+	rc = kernel_read_file_from_path_initns(seg->path, seg->offset, &buf,
+					       seg->size, &file_size,
+					       READING_FIRMWARE);
+	if (rc >= 0 && rc != seg->size)
+		rc = -EIO;
+	seg->ret = rc < 0 ? rc : 0;
+}
+
+/*
+ * Probe the file size with a one-page bounce read, then fill the rest of
+ * the buffer with segment reads fanned out across CPUs.  Returns -EAGAIN
+ * for files below the parallelism threshold so the caller can fall back
+ * to the plain single read.
+ */
+static int fw_try_read_parallel(struct device *device, const char *path,
+				struct fw_priv *fw_priv)
+{
+	struct fw_read_segment *segs;
+	size_t file_size = 0, seg_size, off;
+	unsigned int nr_segs, i;
+	void *probe_buf, *buffer;
+	ssize_t rc;
+	int ret = 0;
+
+	probe_buf = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!probe_buf)
+		return -ENOMEM;
+
+	rc = kernel_read_file_from_path_initns(path, 0, &probe_buf, PAGE_SIZE,
+					       &file_size, READING_FIRMWARE);
+	if (rc < 0 || file_size < FW_PARALLEL_READ_MIN) {
+		kfree(probe_buf);
+		return rc < 0 ? rc : -EAGAIN;
+	}
+
+	buffer = vmalloc(file_size);
+	if (!buffer) {
+		kfree(probe_buf);
+		return -ENOMEM;
+	}
+	memcpy(buffer, probe_buf, rc);
+	off = rc;
+	kfree(probe_buf);
+
+	nr_segs = clamp_t(unsigned int, num_online_cpus(), 1,
+			  FW_PARALLEL_READ_MAX_SEGS);
+	segs = kcalloc(nr_segs, sizeof(*segs), GFP_KERNEL);
+	if (!segs) {
+		vfree(buffer);
+		return -ENOMEM;
+	}
+
+	seg_size = DIV_ROUND_UP(file_size - off, nr_segs);
+	for (i = 0; i < nr_segs; i++) {
+		size_t seg_off = off + (size_t)i * seg_size;
+
+		if (seg_off >= file_size)
+			break;
+
+		segs[i].path = path;
+		segs[i].buf = buffer + seg_off;
+		segs[i].offset = seg_off;
+		segs[i].size = min(seg_size, file_size - seg_off);
+		async_schedule_domain(fw_read_segment_work, &segs[i],
+				      &fw_parallel_read_domain);
+	}
+	async_synchronize_full_domain(&fw_parallel_read_domain);
+
+	while (i--) {
+		if (segs[i].ret)
+			ret = segs[i].ret;
+	}
+	kfree(segs);
+
+	if (ret) {
+		vfree(buffer);
+		return ret;
+	}
+
+	dev_dbg(device, "parallel-loading %s (%zu bytes, %u segments)\n",
+		fw_priv->fw_name, file_size, nr_segs);
+	fw_priv->data = buffer;
+	fw_priv->size = file_size;
+
+	return 0;
+}
+
 static int
 fw_get_filesystem_firmware(struct device *device, struct fw_priv *fw_priv,
 			   const char *suffix,
@@ -535,6 +741,18 @@ fw_get_filesystem_firmware(struct device *device, struct fw_priv *fw_priv,
 		if ((fw_priv->opt_flags & FW_OPT_PARTIAL) && buffer)
 			file_size_ptr = &file_size;
 
+		/*
+		 * Large direct loads into a loader-owned buffer are read in
+		 * parallel segments; any failure (including files below the
+		 * size threshold) falls back to the single full read.
+		 */
+		if (!decompress && !buffer &&
+		    !fw_try_read_parallel(device, path, fw_priv)) {
+			rc = 0;
+			fw_state_done(fw_priv);
+			break;
+		}
+
 		/* load firmware files from the mount namespace of init */
 		rc = kernel_read_file_from_path_initns(path, fw_priv->offset,
 						       &buffer, msize,
@@ -855,8 +1073,11 @@ _request_firmware(const struct firmware **firmware_p, const char *name,
 		if (nondirect)
 			ret = firmware_fallback_sysfs(fw, name, device,
 						      opt_flags, ret);
-	} else
+	} else {
 		ret = assign_fw(fw, device);
+		if (!ret)
+			fw_retention_add(fw->priv);
+	}
 
 	revert_creds(old_cred);
 	put_cred(kern_cred);
@@ -1590,6 +1811,7 @@ out:
 
 static void __exit firmware_class_exit(void)
 {
+	fw_retention_flush();
 	unregister_fw_pm_ops();
 	unregister_reboot_notifier(&fw_shutdown_nb);
 	unregister_sysfs_loader();
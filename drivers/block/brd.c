@@ -48,6 +48,12 @@ struct brd_device {
 	u64			brd_nr_pages;
 };
 
+/*
+ * NUMA node to allocate the backing pages from; NUMA_NO_NODE means local
+ * to the CPU submitting the write that instantiates the page.
+ */
+static int rd_node = NUMA_NO_NODE;
+
 /*
  * Look up and return a brd's page for a given sector.
  */
@@ -57,15 +63,11 @@ static struct page *brd_lookup_page(struct brd_device *brd, sector_t sector)
 	struct page *page;
 
 	/*
-	 * The page lifetime is protected by the fact that we have opened the
-	 * device node -- brd pages will never be deleted under us, so we
-	 * don't need any further locking or refcounting.
-	 *
-	 * This is strictly true for the radix-tree nodes as well (ie. we
-	 * don't actually need the rcu_read_lock()), however that is not a
-	 * documented feature of the radix-tree API so it is better to be
-	 * safe here (we don't have total exclusion from radix tree updates
-	 * here, only deletes).
+	 * The page lifetime is protected by RCU: pages are only deleted by
+	 * discard, which defers the actual freeing by a grace period, so a
+	 * page looked up under rcu_read_lock() stays valid until the lock
+	 * is dropped. Callers that touch the page contents must therefore
+	 * hold the rcu read lock across both the lookup and the access.
 	 */
 	rcu_read_lock();
 	idx = sector >> PAGE_SECTORS_SHIFT; /* sector to page index */
@@ -90,7 +92,7 @@ static int brd_insert_page(struct brd_device *brd, sector_t sector, gfp_t gfp)
 	if (page)
 		return 0;
 
-	page = alloc_page(gfp | __GFP_ZERO | __GFP_HIGHMEM);
+	page = alloc_pages_node(rd_node, gfp | __GFP_ZERO | __GFP_HIGHMEM, 0);
 	if (!page)
 		return -ENOMEM;
 
@@ -194,6 +196,7 @@ static void copy_to_brd(struct brd_device *brd, const void *src,
 	size_t copy;
 
 	copy = min_t(size_t, n, PAGE_SIZE - offset);
+	rcu_read_lock();
 	page = brd_lookup_page(brd, sector);
 	BUG_ON(!page);
 
@@ -212,6 +215,7 @@ static void copy_to_brd(struct brd_device *brd, const void *src,
 		memcpy(dst, src, copy);
 		kunmap_atomic(dst);
 	}
+	rcu_read_unlock();
 }
 
 /*
@@ -226,6 +230,7 @@ static void copy_from_brd(void *dst, struct brd_device *brd,
 	size_t copy;
 
 	copy = min_t(size_t, n, PAGE_SIZE - offset);
+	rcu_read_lock();
 	page = brd_lookup_page(brd, sector);
 	if (page) {
 		src = kmap_atomic(page);
@@ -246,6 +251,7 @@ static void copy_from_brd(void *dst, struct brd_device *brd,
 		} else
 			memset(dst, 0, copy);
 	}
+	rcu_read_unlock();
 }
 
 /*
@@ -284,6 +290,41 @@ out:
 	return err;
 }
 
+static void brd_free_page_rcu(struct rcu_head *head)
+{
+	struct page *page = container_of(head, struct page, rcu_head);
+
+	__free_page(page);
+}
+
+/*
+ * Free the backing pages fully covered by the discarded range. The pages
+ * are freed after a grace period since lockless readers may still hold
+ * references obtained from brd_lookup_page().
+ */
+static void brd_do_discard(struct brd_device *brd, sector_t sector, u32 size)
+{
+	sector_t aligned_sector = ALIGN(sector, PAGE_SECTORS);
+	struct page *page;
+
+	if ((aligned_sector - sector) << SECTOR_SHIFT > size)
+		return;
+
+	size -= (aligned_sector - sector) << SECTOR_SHIFT;
+	spin_lock(&brd->brd_lock);
+	while (size >= PAGE_SIZE) {
+		page = radix_tree_delete(&brd->brd_pages,
+					 aligned_sector >> PAGE_SECTORS_SHIFT);
+		if (page) {
+			call_rcu(&page->rcu_head, brd_free_page_rcu);
+			brd->brd_nr_pages--;
+		}
+		aligned_sector += PAGE_SECTORS;
+		size -= PAGE_SIZE;
+	}
+	spin_unlock(&brd->brd_lock);
+}
+
 static void brd_submit_bio(struct bio *bio)
 {
 	struct brd_device *brd = bio->bi_bdev->bd_disk->private_data;
@@ -291,6 +332,12 @@ static void brd_submit_bio(struct bio *bio)
 	struct bio_vec bvec;
 	struct bvec_iter iter;
 
+	if (unlikely(op_is_discard(bio->bi_opf))) {
+		brd_do_discard(brd, sector, bio->bi_iter.bi_size);
+		bio_endio(bio);
+		return;
+	}
+
 	bio_for_each_segment(bvec, bio, iter) {
 		unsigned int len = bvec.bv_len;
 		int err;
@@ -335,6 +382,9 @@ static int max_part = 1;
 module_param(max_part, int, 0444);
 MODULE_PARM_DESC(max_part, "Num Minors to reserve between devices");
 
+module_param(rd_node, int, 0444);
+MODULE_PARM_DESC(rd_node, "NUMA node to allocate RAM disk pages from. Default: local to the writer");
+
 MODULE_LICENSE("GPL");
 MODULE_ALIAS_BLOCKDEV_MAJOR(RAMDISK_MAJOR);
 MODULE_ALIAS("rd");
@@ -401,6 +451,11 @@ static int brd_alloc(int i)
 	 */
 	blk_queue_physical_block_size(disk->queue, PAGE_SIZE);
 
+	/* discard can only free whole backing pages */
+	disk->queue->limits.discard_granularity = PAGE_SIZE;
+	blk_queue_max_discard_sectors(disk->queue,
+				      round_down(UINT_MAX, PAGE_SECTORS));
+
 	/* Tell the block layer that this is not a rotational device */
 	blk_queue_flag_set(QUEUE_FLAG_NONROT, disk->queue);
 	blk_queue_flag_set(QUEUE_FLAG_SYNCHRONOUS, disk->queue);
@@ -69,6 +69,7 @@ struct loop_device {
 	struct rb_root          worker_tree;
 	struct timer_list       timer;
 	bool			use_dio;
+	bool			inline_dio;
 	bool			sysfs_inited;
 
 	struct request_queue	*lo_queue;
@@ -815,6 +816,7 @@ struct loop_worker {
 };
 
 static void loop_workfn(struct work_struct *work);
+static void loop_handle_cmd(struct loop_cmd *cmd);
 
 #ifdef CONFIG_BLK_CGROUP
 static inline int queue_on_root_worker(struct cgroup_subsys_state *css)
@@ -1788,6 +1790,10 @@ MODULE_PARM_DESC(max_loop, "Maximum number of loop devices");
 module_param(max_part, int, 0444);
 MODULE_PARM_DESC(max_part, "Maximum number of partitions per loop device");
 
+static bool inline_dio = true;
+module_param(inline_dio, bool, 0444);
+MODULE_PARM_DESC(inline_dio, "Submit direct I/O requests from the submitting context instead of a worker. Default: 1");
+
 static int hw_queue_depth = LOOP_DEFAULT_HW_Q_DEPTH;
 
 static int loop_set_hw_queue_depth(const char *s, const struct kernel_param *p)
@@ -1852,6 +1858,25 @@ static blk_status_t loop_queue_rq(struct blk_mq_hw_ctx *hctx,
 #endif
 	}
 #endif
+
+	/*
+	 * Translate direct I/O requests into backing-file iocbs right here in
+	 * the submitting context, skipping the worker and its context switch.
+	 * The queue is BLK_MQ_F_BLOCKING, so sleeping in the ->read_iter() or
+	 * ->write_iter() of the backing file is fine. Requests carrying a
+	 * cgroup association still go through the worker, which issues them
+	 * under the submitter's cgroups.
+	 */
+	if (lo->inline_dio && cmd->use_aio &&
+	    !cmd->blkcg_css && !cmd->memcg_css) {
+		unsigned int orig_flags = current->flags;
+
+		current->flags |= PF_LOCAL_THROTTLE | PF_MEMALLOC_NOIO;
+		loop_handle_cmd(cmd);
+		current->flags = orig_flags;
+		return BLK_STS_OK;
+	}
+
 	loop_queue_work(lo, cmd);
 
 	return BLK_STS_OK;
@@ -1998,6 +2023,10 @@ static int loop_add(int i)
 	lo->tag_set.cmd_size = sizeof(struct loop_cmd);
 	lo->tag_set.flags = BLK_MQ_F_SHOULD_MERGE | BLK_MQ_F_STACKING |
 		BLK_MQ_F_NO_SCHED_BY_DEFAULT;
+	/* Inline submission sleeps in the backing file's aio paths. */
+	lo->inline_dio = inline_dio;
+	if (lo->inline_dio)
+		lo->tag_set.flags |= BLK_MQ_F_BLOCKING;
 	lo->tag_set.driver_data = lo;
 
 	err = blk_mq_alloc_tag_set(&lo->tag_set);
@@ -538,6 +538,49 @@ static int sock_xmit(struct nbd_device *nbd, int index, int send,
 	return result;
 }
 
+/*
+ * Send the bytes of a page directly to the socket, avoiding the copy that
+ * kernel_sendmsg() does. The pages of a write request are not reused before
+ * the server's reply has been received, so handing page references to the
+ * TCP stack is safe. Returns a positive value on success and a negative
+ * value on failure, and never returns 0.
+ */
+static int sock_send_page(struct nbd_device *nbd, int index, struct page *page,
+			  unsigned int offset, unsigned int len, int msg_flags,
+			  int *sent)
+{
+	struct nbd_config *config = nbd->config;
+	struct socket *sock = config->socks[index]->sock;
+	unsigned int noreclaim_flag;
+	int result;
+
+	if (unlikely(!sock)) {
+		dev_err_ratelimited(disk_to_dev(nbd->disk),
+			"Attempted send on closed socket in sock_send_page\n");
+		return -EINVAL;
+	}
+
+	noreclaim_flag = memalloc_noreclaim_save();
+	do {
+		sock->sk->sk_allocation = GFP_NOIO | __GFP_MEMALLOC;
+		sock->sk->sk_use_task_frag = false;
+		result = kernel_sendpage(sock, page, offset, len,
+					 msg_flags | MSG_NOSIGNAL);
+		if (result <= 0) {
+			if (result == 0)
+				result = -EPIPE;
+			break;
+		}
+		offset += result;
+		len -= result;
+		*sent += result;
+	} while (len);
+
+	memalloc_noreclaim_restore(noreclaim_flag);
+
+	return result;
+}
+
 /*
  * Different settings for sk->sk_sndtimeo can result in different return values
  * if there is a signal pending when we enter sendmsg, because reasons?
@@ -659,7 +702,20 @@ send_pages:
 				iov_iter_advance(&from, skip);
 				skip = 0;
 			}
-			result = sock_xmit(nbd, index, 1, &from, flags, &sent);
+			if (sendpage_ok(bvec.bv_page)) {
+				unsigned int count = iov_iter_count(&from);
+
+				if (!is_last)
+					flags |= MSG_SENDPAGE_NOTLAST;
+				result = sock_send_page(nbd, index,
+						bvec.bv_page,
+						bvec.bv_offset +
+							bvec.bv_len - count,
+						count, flags, &sent);
+			} else {
+				result = sock_xmit(nbd, index, 1, &from, flags,
+						   &sent);
+			}
 			if (result < 0) {
 				if (was_interrupted(result)) {
 					/* We've already sent the header, we
@@ -819,6 +875,25 @@ out:
 	return ret ? ERR_PTR(ret) : cmd;
 }
 
+/* Maximum number of reaped replies completed in one batch. */
+#define NBD_RECV_BATCH 16
+
+static void nbd_complete_batch(struct request_queue *q, struct request **batch,
+			       int nr)
+{
+	for (int i = 0; i < nr; i++) {
+		blk_mq_complete_request(batch[i]);
+		percpu_ref_put(&q->q_usage_counter);
+	}
+}
+
+static bool nbd_sock_has_data(struct nbd_config *config, int index)
+{
+	struct socket *sock = config->socks[index]->sock;
+
+	return sock && !skb_queue_empty_lockless(&sock->sk->sk_receive_queue);
+}
+
 static void recv_work(struct work_struct *work)
 {
 	struct recv_thread_args *args = container_of(work,
@@ -827,13 +902,25 @@ static void recv_work(struct work_struct *work)
 	struct nbd_device *nbd = args->nbd;
 	struct nbd_config *config = nbd->config;
 	struct request_queue *q = nbd->disk->queue;
+	struct request *batch[NBD_RECV_BATCH];
 	struct nbd_sock *nsock;
 	struct nbd_cmd *cmd;
 	struct request *rq;
+	int nr_batched = 0;
 
 	while (1) {
 		struct nbd_reply reply;
 
+		/*
+		 * Flush the reaped replies before a read that may block.
+		 * Deferring the completions while more replies are already
+		 * queued on the socket amortizes their cost over the batch.
+		 */
+		if (nr_batched && !nbd_sock_has_data(config, args->index)) {
+			nbd_complete_batch(q, batch, nr_batched);
+			nr_batched = 0;
+		}
+
 		if (nbd_read_reply(nbd, args->index, &reply))
 			break;
 
@@ -863,12 +950,24 @@ static void recv_work(struct work_struct *work)
 			complete = __test_and_clear_bit(NBD_CMD_INFLIGHT,
 							&cmd->flags);
 			mutex_unlock(&cmd->lock);
-			if (complete)
-				blk_mq_complete_request(rq);
+			if (complete) {
+				/* The q_usage_counter ref is dropped with the
+				 * completion when the batch is flushed.
+				 */
+				batch[nr_batched++] = rq;
+				if (nr_batched == NBD_RECV_BATCH) {
+					nbd_complete_batch(q, batch,
+							   nr_batched);
+					nr_batched = 0;
+				}
+				continue;
+			}
 		}
 		percpu_ref_put(&q->q_usage_counter);
 	}
 
+	nbd_complete_batch(q, batch, nr_batched);
+
 	nsock = config->socks[args->index];
 	mutex_lock(&nsock->tx_lock);
 	nbd_mark_nsock_dead(nbd, nsock, 1);
@@ -9,6 +9,7 @@
 #include <linux/sched.h>
 #include <linux/fs.h>
 #include <linux/init.h>
+#include <linux/random.h>
 #include "null_blk.h"
 
 #undef pr_fmt
@@ -403,6 +404,10 @@ static int nullb_apply_poll_queues(struct nullb_device *dev,
 
 NULLB_DEVICE_ATTR(size, ulong, NULL);
 NULLB_DEVICE_ATTR(completion_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(completion_nsec_p95, ulong, NULL);
+NULLB_DEVICE_ATTR(completion_nsec_p99, ulong, NULL);
+NULLB_DEVICE_ATTR(completion_nsec_per_inflight, ulong, NULL);
+NULLB_DEVICE_ATTR(zone_mgmt_nsec, ulong, NULL);
 NULLB_DEVICE_ATTR(submit_queues, uint, nullb_apply_submit_queues);
 NULLB_DEVICE_ATTR(poll_queues, uint, nullb_apply_poll_queues);
 NULLB_DEVICE_ATTR(home_node, uint, NULL);
@@ -544,6 +549,9 @@ CONFIGFS_ATTR_WO(nullb_device_, zone_offline);
 static struct configfs_attribute *nullb_device_attrs[] = {
 	&nullb_device_attr_size,
 	&nullb_device_attr_completion_nsec,
+	&nullb_device_attr_completion_nsec_p95,
+	&nullb_device_attr_completion_nsec_p99,
+	&nullb_device_attr_completion_nsec_per_inflight,
 	&nullb_device_attr_submit_queues,
 	&nullb_device_attr_poll_queues,
 	&nullb_device_attr_home_node,
@@ -567,6 +575,7 @@ static struct configfs_attribute *nullb_device_attrs[] = {
 	&nullb_device_attr_zone_nr_conv,
 	&nullb_device_attr_zone_max_open,
 	&nullb_device_attr_zone_max_active,
+	&nullb_device_attr_zone_mgmt_nsec,
 	&nullb_device_attr_zone_readonly,
 	&nullb_device_attr_zone_offline,
 	&nullb_device_attr_virt_boundary,
@@ -629,12 +638,15 @@ static ssize_t memb_group_features_show(struct config_item *item, char *page)
 {
 	return snprintf(page, PAGE_SIZE,
 			"badblocks,blocking,blocksize,cache_size,"
-			"completion_nsec,discard,home_node,hw_queue_depth,"
+			"completion_nsec,completion_nsec_p95,"
+			"completion_nsec_p99,completion_nsec_per_inflight,"
+			"discard,home_node,hw_queue_depth,"
 			"irqmode,max_sectors,mbps,memory_backed,no_sched,"
 			"poll_queues,power,queue_mode,shared_tag_bitmap,size,"
 			"submit_queues,use_per_node_hctx,virt_boundary,zoned,"
 			"zone_capacity,zone_max_active,zone_max_open,"
-			"zone_nr_conv,zone_offline,zone_readonly,zone_size\n");
+			"zone_mgmt_nsec,zone_nr_conv,zone_offline,"
+			"zone_readonly,zone_size\n");
 }
 
 CONFIGFS_ATTR_RO(memb_group_, features);
@@ -813,14 +825,67 @@ static void end_cmd(struct nullb_cmd *cmd)
 
 static enum hrtimer_restart null_cmd_timer_expired(struct hrtimer *timer)
 {
-	end_cmd(container_of(timer, struct nullb_cmd, timer));
+	struct nullb_cmd *cmd = container_of(timer, struct nullb_cmd, timer);
+
+	atomic_dec(&cmd->nq->dev->cur_inflight);
+	end_cmd(cmd);
 
 	return HRTIMER_NORESTART;
 }
 
+/*
+ * Emulated completion time of a request. The base time is completion_nsec,
+ * optionally replaced by a tail latency for a percentile-sized share of the
+ * requests, and optionally growing with the number of requests in flight to
+ * model a device whose service time degrades with queue depth. Zone
+ * management requests can carry an extra penalty, as zone resets and
+ * transitions are much slower than data commands on real zoned devices.
+ */
+static unsigned long null_cmd_completion_nsec(struct nullb_cmd *cmd,
+					      unsigned int inflight)
+{
+	struct nullb_device *dev = cmd->nq->dev;
+	unsigned long nsec = dev->completion_nsec;
+
+	if (dev->completion_nsec_p95 || dev->completion_nsec_p99) {
+		u32 draw = get_random_u32_below(100);
+
+		if (dev->completion_nsec_p99 && draw >= 99)
+			nsec = dev->completion_nsec_p99;
+		else if (dev->completion_nsec_p95 && draw >= 95)
+			nsec = dev->completion_nsec_p95;
+	}
+
+	if (dev->completion_nsec_per_inflight)
+		nsec += inflight * dev->completion_nsec_per_inflight;
+
+	if (dev->zoned && dev->zone_mgmt_nsec) {
+		enum req_op op = (dev->queue_mode == NULL_Q_BIO) ?
+				bio_op(cmd->bio) : req_op(cmd->rq);
+
+		switch (op) {
+		case REQ_OP_ZONE_RESET:
+		case REQ_OP_ZONE_RESET_ALL:
+		case REQ_OP_ZONE_OPEN:
+		case REQ_OP_ZONE_CLOSE:
+		case REQ_OP_ZONE_FINISH:
+			nsec += dev->zone_mgmt_nsec;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return nsec;
+}
+
 static void null_cmd_end_timer(struct nullb_cmd *cmd)
 {
-	ktime_t kt = cmd->nq->dev->completion_nsec;
+	unsigned int inflight;
+	ktime_t kt;
+
+	inflight = atomic_inc_return(&cmd->nq->dev->cur_inflight) - 1;
+	kt = null_cmd_completion_nsec(cmd, inflight);
 
 	hrtimer_start(&cmd->timer, kt, HRTIMER_MODE_REL);
 }
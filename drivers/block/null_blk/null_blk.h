@@ -86,8 +86,14 @@ struct nullb_device {
 	bool need_zone_res_mgmt;
 	spinlock_t zone_res_lock;
 
+	atomic_t cur_inflight; /* requests waiting in the completion timer */
+
 	unsigned long size; /* device size in MB */
 	unsigned long completion_nsec; /* time in ns to complete a request */
+	unsigned long completion_nsec_p95; /* ns for the slowest 5% of requests */
+	unsigned long completion_nsec_p99; /* ns for the slowest 1% of requests */
+	unsigned long completion_nsec_per_inflight; /* ns added per in-flight request */
+	unsigned long zone_mgmt_nsec; /* ns added to zone management requests */
 	unsigned long cache_size; /* disk cache size in MB */
 	unsigned long zone_size; /* zone size in MB if device is zoned */
 	unsigned long zone_capacity; /* zone capacity in MB if device is zoned */
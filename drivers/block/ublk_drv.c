@@ -53,7 +53,8 @@
 		| UBLK_F_NEED_GET_DATA \
 		| UBLK_F_USER_RECOVERY \
 		| UBLK_F_USER_RECOVERY_REISSUE \
-		| UBLK_F_UNPRIVILEGED_DEV)
+		| UBLK_F_UNPRIVILEGED_DEV \
+		| UBLK_F_DESC_RING)
 
 /* All UBLK_PARAM_TYPE_* should be included here */
 #define UBLK_PARAM_TYPE_ALL (UBLK_PARAM_TYPE_BASIC | \
@@ -106,6 +107,14 @@ struct ublk_uring_cmd_pdu {
  */
 #define UBLK_IO_FLAG_NEED_GET_DATA 0x08
 
+/*
+ * The io was dispatched through the descriptor ring, so its fetch command
+ * was not completed at dispatch time and is still owned by the driver.
+ * The command is completed lazily when the server commits this io, or
+ * when the queue is canceled.
+ */
+#define UBLK_IO_FLAG_DESC_RING 0x10
+
 struct ublk_io {
 	/* userspace buffer address from io cmd */
 	__u64	addr;
@@ -123,6 +132,20 @@ struct ublk_queue {
 	struct task_struct	*ubq_daemon;
 	char *io_cmd_buf;
 
+	/*
+	 * Optional shared descriptor ring (UBLK_F_DESC_RING), mapped
+	 * writable into the server at UBLKSRV_DESC_RING_OFFSET +
+	 * q_id * UBLKSRV_DESC_RING_MAX_SIZE. While the server keeps
+	 * UBLKSRV_DESC_RING_POLLING set in ->flags, arriving requests are
+	 * published as tags made visible by advancing ->prod instead of
+	 * completing the pending fetch command, so the dispatch hot path
+	 * never posts a cqe; the server consumes tags by advancing ->cons.
+	 * When the server stops polling before going to sleep, dispatch
+	 * falls back to the usual io_uring command completion.
+	 */
+	struct ublksrv_desc_ring *desc_ring;
+	unsigned int desc_ring_mask;
+
 	struct llist_head	io_cmds;
 
 	unsigned long io_addr;	/* mapped vm address */
@@ -303,6 +326,13 @@ static inline bool ublk_need_get_data(const struct ublk_queue *ubq)
 	return false;
 }
 
+static inline bool ublk_support_desc_ring(const struct ublk_queue *ubq)
+{
+	if (ubq->flags & UBLK_F_DESC_RING)
+		return true;
+	return false;
+}
+
 static struct ublk_device *ublk_get_device(struct ublk_device *ub)
 {
 	if (kobject_get_unless_zero(&ub->cdev_dev.kobj))
@@ -346,6 +376,13 @@ static inline int ublk_queue_cmd_buf_size(struct ublk_device *ub, int q_id)
 			PAGE_SIZE);
 }
 
+static inline int ublk_queue_desc_ring_size(const struct ublk_queue *ubq)
+{
+	return round_up(sizeof(struct ublksrv_desc_ring) +
+			roundup_pow_of_two(ubq->q_depth) * sizeof(__u16),
+			PAGE_SIZE);
+}
+
 static inline bool ublk_queue_can_use_recovery_reissue(
 		struct ublk_queue *ubq)
 {
@@ -731,6 +768,36 @@ static void ubq_complete_io_cmd(struct ublk_io *io, int res,
 	io_uring_cmd_done(io->cmd, res, 0, issue_flags);
 }
 
+static bool ublk_publish_io_desc(struct ublk_queue *ubq, struct ublk_io *io,
+		int tag)
+{
+	struct ublksrv_desc_ring *ring = ubq->desc_ring;
+	u32 prod;
+
+	if (!(READ_ONCE(ring->flags) & UBLKSRV_DESC_RING_POLLING))
+		return false;
+
+	prod = ring->prod;
+	/*
+	 * Cannot happen as long as the server consumes a tag before
+	 * committing it, but do not corrupt the ring if it misbehaves.
+	 */
+	if (unlikely(prod - READ_ONCE(ring->cons) > ubq->desc_ring_mask))
+		return false;
+
+	/*
+	 * This io is owned by ublksrv now, but its fetch command stays
+	 * pending and is completed lazily on the next commit.
+	 */
+	io->flags |= UBLK_IO_FLAG_OWNED_BY_SRV | UBLK_IO_FLAG_DESC_RING;
+	io->flags &= ~UBLK_IO_FLAG_ACTIVE;
+
+	ring->tags[prod & ubq->desc_ring_mask] = tag;
+	/* make the tag visible before publishing the new producer index */
+	smp_store_release(&ring->prod, prod + 1);
+	return true;
+}
+
 #define UBLK_REQUEUE_DELAY_MS	3
 
 static inline void __ublk_abort_rq(struct ublk_queue *ubq,
@@ -822,6 +889,10 @@ static inline void __ublk_rq_task_work(struct request *req,
 			mapped_bytes >> 9;
 	}
 
+	if (ublk_support_desc_ring(ubq) &&
+	    ublk_publish_io_desc(ubq, io, tag))
+		return;
+
 	ubq_complete_io_cmd(io, UBLK_IO_RES_OK, issue_flags);
 }
 
@@ -980,6 +1051,32 @@ static int ublk_ch_release(struct inode *inode, struct file *filp)
 	return 0;
 }
 
+/* map the per-queue descriptor ring writable to the ublksrv daemon */
+static int ublk_ch_mmap_desc_ring(struct ublk_device *ub,
+		struct vm_area_struct *vma)
+{
+	size_t sz = vma->vm_end - vma->vm_start;
+	unsigned long pfn, end, phys_off = vma->vm_pgoff << PAGE_SHIFT;
+	unsigned max_sz = UBLKSRV_DESC_RING_MAX_SIZE;
+	struct ublk_queue *ubq;
+	int q_id;
+
+	end = UBLKSRV_DESC_RING_OFFSET + ub->dev_info.nr_hw_queues * max_sz;
+	if (phys_off >= end)
+		return -EINVAL;
+
+	q_id = (phys_off - UBLKSRV_DESC_RING_OFFSET) / max_sz;
+	ubq = ublk_get_queue(ub, q_id);
+	if (!ubq->desc_ring)
+		return -EOPNOTSUPP;
+
+	if (sz != ublk_queue_desc_ring_size(ubq))
+		return -EINVAL;
+
+	pfn = virt_to_phys(ubq->desc_ring) >> PAGE_SHIFT;
+	return remap_pfn_range(vma, vma->vm_start, pfn, sz, vma->vm_page_prot);
+}
+
 /* map pre-allocated per-queue cmd buffer to ublksrv daemon */
 static int ublk_ch_mmap(struct file *filp, struct vm_area_struct *vma)
 {
@@ -999,6 +1096,9 @@ static int ublk_ch_mmap(struct file *filp, struct vm_area_struct *vma)
 	if (ret)
 		return ret;
 
+	if (phys_off >= UBLKSRV_DESC_RING_OFFSET)
+		return ublk_ch_mmap_desc_ring(ub, vma);
+
 	if (vma->vm_flags & VM_WRITE)
 		return -EPERM;
 
@@ -1114,9 +1214,12 @@ static void ublk_cancel_queue(struct ublk_queue *ubq)
 	for (i = 0; i < ubq->q_depth; i++) {
 		struct ublk_io *io = &ubq->ios[i];
 
-		if (io->flags & UBLK_IO_FLAG_ACTIVE)
+		if (io->flags & (UBLK_IO_FLAG_ACTIVE |
+					UBLK_IO_FLAG_DESC_RING)) {
+			io->flags &= ~UBLK_IO_FLAG_DESC_RING;
 			io_uring_cmd_done(io->cmd, UBLK_IO_RES_ABORT, 0,
 						IO_URING_F_UNLOCKED);
+		}
 	}
 
 	/* all io commands are canceled */
@@ -1337,6 +1440,12 @@ static int ublk_ch_uring_cmd(struct io_uring_cmd *cmd, unsigned int issue_flags)
 			goto out;
 		if (!(io->flags & UBLK_IO_FLAG_OWNED_BY_SRV))
 			goto out;
+		/* complete the fetch command a ring dispatch left pending */
+		if (io->flags & UBLK_IO_FLAG_DESC_RING) {
+			io->flags &= ~UBLK_IO_FLAG_DESC_RING;
+			io_uring_cmd_done(io->cmd, UBLK_IO_RES_OK, 0,
+					issue_flags);
+		}
 		io->addr = ub_cmd->addr;
 		io->flags |= UBLK_IO_FLAG_ACTIVE;
 		io->cmd = cmd;
@@ -1380,6 +1489,9 @@ static void ublk_deinit_queue(struct ublk_device *ub, int q_id)
 		put_task_struct(ubq->ubq_daemon);
 	if (ubq->io_cmd_buf)
 		free_pages((unsigned long)ubq->io_cmd_buf, get_order(size));
+	if (ubq->desc_ring)
+		free_pages((unsigned long)ubq->desc_ring,
+				get_order(ublk_queue_desc_ring_size(ubq)));
 }
 
 static int ublk_init_queue(struct ublk_device *ub, int q_id)
@@ -1399,6 +1511,17 @@ static int ublk_init_queue(struct ublk_device *ub, int q_id)
 		return -ENOMEM;
 
 	ubq->io_cmd_buf = ptr;
+
+	if (ublk_support_desc_ring(ubq)) {
+		size = ublk_queue_desc_ring_size(ubq);
+		ptr = (void *) __get_free_pages(gfp_flags, get_order(size));
+		if (!ptr)
+			return -ENOMEM;
+
+		ubq->desc_ring = ptr;
+		ubq->desc_ring_mask = roundup_pow_of_two(ubq->q_depth) - 1;
+	}
+
 	ubq->dev = ub;
 	return 0;
 }
@@ -1919,6 +1919,122 @@ release_init_lock:
 	up_read(&zram->init_lock);
 	return ret;
 }
+
+/*
+ * Number of slots one background recompression pass visits before it
+ * re-arms itself.  Keeps each pass short so that the init_lock is never
+ * read-held for too long.
+ */
+#define ZRAM_BG_RECOMP_BATCH	1024
+
+static void zram_bg_recomp_workfn(struct work_struct *work)
+{
+	struct zram *zram = container_of(work, struct zram, recomp_work.work);
+	unsigned int budget = ZRAM_BG_RECOMP_BATCH;
+	unsigned long nr_pages, index;
+	struct page *page;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram->bg_recompress_ms)
+		goto release_init_lock;
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page)
+		goto requeue;
+
+	nr_pages = zram->disksize >> PAGE_SHIFT;
+	index = zram->recomp_cursor;
+	while (budget--) {
+		if (index >= nr_pages)
+			index = 0;
+
+		zram_slot_lock(zram, index);
+
+		if (!zram_allocated(zram, index))
+			goto next;
+
+		/* Only cold (idle) objects and objects stored uncompressed */
+		if (!zram_test_flag(zram, index, ZRAM_IDLE) &&
+		    !zram_test_flag(zram, index, ZRAM_HUGE))
+			goto next;
+
+		if (zram_test_flag(zram, index, ZRAM_WB) ||
+		    zram_test_flag(zram, index, ZRAM_UNDER_WB) ||
+		    zram_test_flag(zram, index, ZRAM_SAME) ||
+		    zram_test_flag(zram, index, ZRAM_INCOMPRESSIBLE))
+			goto next;
+
+		/*
+		 * Errors are not fatal in the background: the slot simply
+		 * gets visited again on a later pass.
+		 */
+		zram_recompress(zram, index, page, 0, ZRAM_SECONDARY_COMP,
+				ZRAM_MAX_COMPS);
+next:
+		zram_slot_unlock(zram, index);
+		index++;
+		cond_resched();
+	}
+	zram->recomp_cursor = index;
+
+	__free_page(page);
+requeue:
+	schedule_delayed_work(&zram->recomp_work,
+			      msecs_to_jiffies(zram->bg_recompress_ms));
+release_init_lock:
+	up_read(&zram->init_lock);
+}
+
+static void zram_start_bg_recomp(struct zram *zram)
+{
+	if (zram->bg_recompress_ms)
+		schedule_delayed_work(&zram->recomp_work,
+				msecs_to_jiffies(zram->bg_recompress_ms));
+}
+
+static void zram_stop_bg_recomp(struct zram *zram)
+{
+	cancel_delayed_work_sync(&zram->recomp_work);
+}
+
+static ssize_t bg_recompress_ms_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", zram->bg_recompress_ms);
+}
+
+static ssize_t bg_recompress_ms_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	u32 val;
+	int ret;
+
+	ret = kstrtouint(buf, 10, &val);
+	if (ret)
+		return ret;
+
+	down_read(&zram->init_lock);
+	zram->bg_recompress_ms = val;
+	if (init_done(zram) && val)
+		schedule_delayed_work(&zram->recomp_work,
+				      msecs_to_jiffies(val));
+	up_read(&zram->init_lock);
+
+	/*
+	 * No sync cancel here: the work re-checks bg_recompress_ms under
+	 * the init_lock and will not re-arm itself once it is cleared.
+	 */
+	if (!val)
+		cancel_delayed_work(&zram->recomp_work);
+
+	return len;
+}
+#else
+static void zram_start_bg_recomp(struct zram *zram) { }
+static void zram_stop_bg_recomp(struct zram *zram) { }
 #endif
 
 /*
@@ -2087,6 +2203,12 @@ static void zram_destroy_comps(struct zram *zram)
 
 static void zram_reset_device(struct zram *zram)
 {
+	/*
+	 * The work takes the init_lock for reading, so it must be stopped
+	 * before the lock is taken for writing.
+	 */
+	zram_stop_bg_recomp(zram);
+
 	down_write(&zram->init_lock);
 
 	zram->limit_pages = 0;
@@ -2155,6 +2277,8 @@ static ssize_t disksize_store(struct device *dev,
 	set_capacity_and_notify(zram->disk, zram->disksize >> SECTOR_SHIFT);
 	up_write(&zram->init_lock);
 
+	zram_start_bg_recomp(zram);
+
 	return len;
 
 out_free_comps:
@@ -2245,6 +2369,7 @@ static DEVICE_ATTR_RW(writeback_limit_enable);
 #ifdef CONFIG_ZRAM_MULTI_COMP
 static DEVICE_ATTR_RW(recomp_algorithm);
 static DEVICE_ATTR_WO(recompress);
+static DEVICE_ATTR_RW(bg_recompress_ms);
 #endif
 
 static struct attribute *zram_disk_attrs[] = {
@@ -2272,6 +2397,7 @@ static struct attribute *zram_disk_attrs[] = {
 #ifdef CONFIG_ZRAM_MULTI_COMP
 	&dev_attr_recomp_algorithm.attr,
 	&dev_attr_recompress.attr,
+	&dev_attr_bg_recompress_ms.attr,
 #endif
 	NULL,
 };
@@ -2300,6 +2426,9 @@ static int zram_add(void)
 #ifdef CONFIG_ZRAM_WRITEBACK
 	spin_lock_init(&zram->wb_limit_lock);
 #endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	INIT_DELAYED_WORK(&zram->recomp_work, zram_bg_recomp_workfn);
+#endif
 
 	/* gendisk structure */
 	zram->disk = blk_alloc_disk(NUMA_NO_NODE);
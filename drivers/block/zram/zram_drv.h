@@ -16,6 +16,7 @@
 #define _ZRAM_DRV_H_
 
 #include <linux/rwsem.h>
+#include <linux/workqueue.h>
 #include <linux/zsmalloc.h>
 #include <linux/crypto.h>
 
@@ -124,6 +125,13 @@ struct zram {
 	u64 disksize;	/* bytes */
 	const char *comp_algs[ZRAM_MAX_COMPS];
 	s8 num_active_comps;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	/* background recompression of cold and huge objects */
+	struct delayed_work recomp_work;
+	unsigned long recomp_cursor;
+	/* background recompression scan interval, 0 disables it */
+	unsigned int bg_recompress_ms;
+#endif
 	/*
 	 * zram is claimed so open request will be failed
 	 */
@@ -10,8 +10,10 @@
 
 #include <linux/cpu.h>
 #include <linux/cpuidle.h>
+#include <linux/ktime.h>
 #include <linux/mutex.h>
 #include <linux/module.h>
+#include <linux/percpu.h>
 #include <linux/pm_qos.h>
 
 #include "cpuidle.h"
@@ -102,18 +104,73 @@ int cpuidle_register_governor(struct cpuidle_governor *gov)
 	return ret;
 }
 
+/*
+ * Per-CPU latency hints published by subsystems that know what is about
+ * to run on a CPU (io_uring SQPOLL, NAPI busy polling, ...).  A hint
+ * constrains idle-state depth like a PM QoS request would, but it is
+ * cheap enough to refresh from hot paths and lapses on its own, so a
+ * publisher that stops polling cannot leave a stale cap behind.
+ */
+struct cpuidle_latency_hint {
+	s64 latency_ns;
+	u64 expires;
+};
+
+static DEFINE_PER_CPU(struct cpuidle_latency_hint, cpuidle_latency_hint);
+
+/**
+ * cpuidle_cpu_latency_hint - Publish a transient latency hint for a CPU.
+ * @cpu: CPU the hint applies to.
+ * @latency_ns: Wakeup latency the CPU should be able to honor.
+ * @timeout_ns: Time after which the hint lapses.
+ *
+ * Hints are advisory and lock-free; concurrent publishers race benignly
+ * with the last writer winning, which at worst costs one suboptimal
+ * idle-state decision.
+ */
+void cpuidle_cpu_latency_hint(unsigned int cpu, s64 latency_ns, u64 timeout_ns)
+{
+	struct cpuidle_latency_hint *hint = &per_cpu(cpuidle_latency_hint, cpu);
+
+	WRITE_ONCE(hint->latency_ns, latency_ns);
+	WRITE_ONCE(hint->expires, ktime_get_ns() + timeout_ns);
+}
+EXPORT_SYMBOL_GPL(cpuidle_cpu_latency_hint);
+
+/**
+ * cpuidle_cpu_latency_hint_clear - Drop any latency hint for a CPU.
+ * @cpu: Target CPU
+ */
+void cpuidle_cpu_latency_hint_clear(unsigned int cpu)
+{
+	WRITE_ONCE(per_cpu(cpuidle_latency_hint, cpu).expires, 0);
+}
+EXPORT_SYMBOL_GPL(cpuidle_cpu_latency_hint_clear);
+
 /**
  * cpuidle_governor_latency_req - Compute a latency constraint for CPU
  * @cpu: Target CPU
  */
 s64 cpuidle_governor_latency_req(unsigned int cpu)
 {
+	struct cpuidle_latency_hint *hint = &per_cpu(cpuidle_latency_hint, cpu);
 	struct device *device = get_cpu_device(cpu);
 	int device_req = dev_pm_qos_raw_resume_latency(device);
 	int global_req = cpu_latency_qos_limit();
+	u64 expires = READ_ONCE(hint->expires);
+	s64 ret;
 
 	if (device_req > global_req)
 		device_req = global_req;
 
-	return (s64)device_req * NSEC_PER_USEC;
+	ret = (s64)device_req * NSEC_PER_USEC;
+
+	if (expires && ktime_get_ns() < expires) {
+		s64 hint_ns = READ_ONCE(hint->latency_ns);
+
+		if (hint_ns < ret)
+			ret = hint_ns;
+	}
+
+	return ret;
 }
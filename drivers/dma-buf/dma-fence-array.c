@@ -10,11 +10,20 @@
  */
 
 #include <linux/export.h>
+#include <linux/irq_work.h>
 #include <linux/slab.h>
 #include <linux/dma-fence-array.h>
 
 #define PENDING_ERROR 1
 
+/*
+ * Arrays whose last fence signaled are collected here and signaled in one
+ * deferred batch: only the first array added to an empty list raises the
+ * irq_work, so bursts of arrays completing back-to-back (e.g. a frame
+ * graph draining at vblank) cost a single wakeup instead of one each.
+ */
+static LLIST_HEAD(dma_fence_array_signal_list);
+
 static const char *dma_fence_array_get_driver_name(struct dma_fence *fence)
 {
 	return "dma_fence_array";
@@ -44,14 +53,20 @@ static void dma_fence_array_clear_pending_error(struct dma_fence_array *array)
 
 static void irq_dma_fence_array_work(struct irq_work *wrk)
 {
-	struct dma_fence_array *array = container_of(wrk, typeof(*array), work);
+	struct llist_node *pending;
+	struct dma_fence_array *array, *tmp;
 
-	dma_fence_array_clear_pending_error(array);
+	pending = llist_del_all(&dma_fence_array_signal_list);
+	llist_for_each_entry_safe(array, tmp, pending, signal_node) {
+		dma_fence_array_clear_pending_error(array);
 
-	dma_fence_signal(&array->base);
-	dma_fence_put(&array->base);
+		dma_fence_signal(&array->base);
+		dma_fence_put(&array->base);
+	}
 }
 
+static DEFINE_IRQ_WORK(dma_fence_array_irq_work, irq_dma_fence_array_work);
+
 static void dma_fence_array_cb_func(struct dma_fence *f,
 				    struct dma_fence_cb *cb)
 {
@@ -61,10 +76,13 @@ static void dma_fence_array_cb_func(struct dma_fence *f,
 
 	dma_fence_array_set_pending_error(array, f->error);
 
-	if (atomic_dec_and_test(&array->num_pending))
-		irq_work_queue(&array->work);
-	else
+	if (atomic_dec_and_test(&array->num_pending)) {
+		if (llist_add(&array->signal_node,
+			      &dma_fence_array_signal_list))
+			irq_work_queue(&dma_fence_array_irq_work);
+	} else {
 		dma_fence_put(&array->base);
+	}
 }
 
 static bool dma_fence_array_enable_signaling(struct dma_fence *fence)
@@ -170,7 +188,6 @@ struct dma_fence_array *dma_fence_array_create(int num_fences,
 	spin_lock_init(&array->lock);
 	dma_fence_init(&array->base, &dma_fence_array_ops, &array->lock,
 		       context, seqno);
-	init_irq_work(&array->work, irq_dma_fence_array_work);
 
 	array->num_fences = num_fences;
 	atomic_set(&array->num_pending, signal_on_any ? 1 : num_fences);
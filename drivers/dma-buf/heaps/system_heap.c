@@ -19,10 +19,13 @@
 #include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/scatterlist.h>
+#include <linux/shrinker.h>
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 
 static struct dma_heap *sys_heap;
+static struct dma_heap *sys_pooled_heap;
 
 struct system_heap_buffer {
 	struct dma_heap *heap;
@@ -32,6 +35,7 @@ struct system_heap_buffer {
 	struct sg_table sg_table;
 	int vmap_cnt;
 	void *vaddr;
+	bool pooled;
 };
 
 struct dma_heap_attachment {
@@ -56,6 +60,121 @@ static gfp_t order_flags[] = {HIGH_ORDER_GFP, MID_ORDER_GFP, LOW_ORDER_GFP};
 static const unsigned int orders[] = {8, 4, 0};
 #define NUM_ORDERS ARRAY_SIZE(orders)
 
+/*
+ * Per-order caches of free pages backing the "system-pooled" heap. Pages
+ * released by a pooled buffer are queued for deferred free: a worker zeroes
+ * them off the release path and parks them in the matching pool, so a
+ * steady-state allocation is a plain list pop of an already zeroed page.
+ * A shrinker returns pooled pages to the system under memory pressure.
+ */
+struct system_heap_pool {
+	struct list_head items;
+	int count;		/* in base pages, for the shrinker */
+	spinlock_t lock;
+};
+
+static struct system_heap_pool pools[NUM_ORDERS];
+static LIST_HEAD(deferred_pages);
+static DEFINE_SPINLOCK(deferred_lock);
+
+static int order_to_index(unsigned int order)
+{
+	int i;
+
+	for (i = 0; i < NUM_ORDERS; i++)
+		if (order == orders[i])
+			return i;
+	BUG();
+	return -1;
+}
+
+static struct page *system_heap_pool_fetch(int i)
+{
+	struct system_heap_pool *pool = &pools[i];
+	struct page *page;
+
+	spin_lock(&pool->lock);
+	page = list_first_entry_or_null(&pool->items, struct page, lru);
+	if (page) {
+		list_del(&page->lru);
+		pool->count -= 1 << orders[i];
+	}
+	spin_unlock(&pool->lock);
+
+	return page;
+}
+
+static void system_heap_deferred_free(struct work_struct *work)
+{
+	struct system_heap_pool *pool;
+	struct page *page;
+	unsigned int order;
+	int i;
+
+	for (;;) {
+		spin_lock(&deferred_lock);
+		page = list_first_entry_or_null(&deferred_pages, struct page,
+						lru);
+		if (page)
+			list_del(&page->lru);
+		spin_unlock(&deferred_lock);
+		if (!page)
+			break;
+
+		/* zero here so the allocation path doesn't have to */
+		order = compound_order(page);
+		for (i = 0; i < (1 << order); i++)
+			clear_highpage(page + i);
+
+		pool = &pools[order_to_index(order)];
+		spin_lock(&pool->lock);
+		list_add(&page->lru, &pool->items);
+		pool->count += 1 << order;
+		spin_unlock(&pool->lock);
+	}
+}
+
+static DECLARE_WORK(deferred_free_work, system_heap_deferred_free);
+
+static unsigned long system_heap_pool_count(struct shrinker *shrinker,
+					    struct shrink_control *sc)
+{
+	unsigned long count = 0;
+	int i;
+
+	for (i = 0; i < NUM_ORDERS; i++)
+		count += READ_ONCE(pools[i].count);
+
+	return count;
+}
+
+static unsigned long system_heap_pool_scan(struct shrinker *shrinker,
+					   struct shrink_control *sc)
+{
+	unsigned long freed = 0;
+	struct page *page;
+	int i;
+
+	/* drain the large-order pools first to free memory quickly */
+	for (i = 0; i < NUM_ORDERS; i++) {
+		while (freed < sc->nr_to_scan) {
+			page = system_heap_pool_fetch(i);
+			if (!page)
+				break;
+			__free_pages(page, orders[i]);
+			freed += 1 << orders[i];
+		}
+	}
+
+	return freed ? freed : SHRINK_STOP;
+}
+
+static struct shrinker pool_shrinker = {
+	.count_objects = system_heap_pool_count,
+	.scan_objects = system_heap_pool_scan,
+	.seeks = DEFAULT_SEEKS,
+};
+
 static struct sg_table *dup_sg_table(struct sg_table *table)
 {
 	struct sg_table *new_table;
@@ -293,10 +412,18 @@ static void system_heap_dma_buf_release(struct dma_buf *dmabuf)
 	int i;
 
 	table = &buffer->sg_table;
-	for_each_sgtable_sg(table, sg, i) {
-		struct page *page = sg_page(sg);
-
-		__free_pages(page, compound_order(page));
+	if (buffer->pooled) {
+		spin_lock(&deferred_lock);
+		for_each_sgtable_sg(table, sg, i)
+			list_add(&sg_page(sg)->lru, &deferred_pages);
+		spin_unlock(&deferred_lock);
+		schedule_work(&deferred_free_work);
+	} else {
+		for_each_sgtable_sg(table, sg, i) {
+			struct page *page = sg_page(sg);
+
+			__free_pages(page, compound_order(page));
+		}
 	}
 	sg_free_table(table);
 	kfree(buffer);
@@ -316,7 +443,8 @@ static const struct dma_buf_ops system_heap_buf_ops = {
 };
 
 static struct page *alloc_largest_available(unsigned long size,
-					    unsigned int max_order)
+					    unsigned int max_order,
+					    bool pooled)
 {
 	struct page *page;
 	int i;
@@ -327,6 +455,13 @@ static struct page *alloc_largest_available(unsigned long size,
 		if (max_order < orders[i])
 			continue;
 
+		/* pooled pages were zeroed when they were parked */
+		if (pooled) {
+			page = system_heap_pool_fetch(i);
+			if (page)
+				return page;
+		}
+
 		page = alloc_pages(order_flags[i], orders[i]);
 		if (!page)
 			continue;
@@ -335,10 +470,11 @@ static struct page *alloc_largest_available(unsigned long size,
 	return NULL;
 }
 
-static struct dma_buf *system_heap_allocate(struct dma_heap *heap,
-					    unsigned long len,
-					    unsigned long fd_flags,
-					    unsigned long heap_flags)
+static struct dma_buf *__system_heap_allocate(struct dma_heap *heap,
+					      unsigned long len,
+					      unsigned long fd_flags,
+					      unsigned long heap_flags,
+					      bool pooled)
 {
 	struct system_heap_buffer *buffer;
 	DEFINE_DMA_BUF_EXPORT_INFO(exp_info);
@@ -359,6 +495,7 @@ static struct dma_buf *system_heap_allocate(struct dma_heap *heap,
 	mutex_init(&buffer->lock);
 	buffer->heap = heap;
 	buffer->len = len;
+	buffer->pooled = pooled;
 
 	INIT_LIST_HEAD(&pages);
 	i = 0;
@@ -372,7 +509,8 @@ static struct dma_buf *system_heap_allocate(struct dma_heap *heap,
 			goto free_buffer;
 		}
 
-		page = alloc_largest_available(size_remaining, max_order);
+		page = alloc_largest_available(size_remaining, max_order,
+					       pooled);
 		if (!page)
 			goto free_buffer;
 
@@ -421,13 +559,34 @@ free_buffer:
 	return ERR_PTR(ret);
 }
 
+static struct dma_buf *system_heap_allocate(struct dma_heap *heap,
+					    unsigned long len,
+					    unsigned long fd_flags,
+					    unsigned long heap_flags)
+{
+	return __system_heap_allocate(heap, len, fd_flags, heap_flags, false);
+}
+
+static struct dma_buf *system_pooled_heap_allocate(struct dma_heap *heap,
+						   unsigned long len,
+						   unsigned long fd_flags,
+						   unsigned long heap_flags)
+{
+	return __system_heap_allocate(heap, len, fd_flags, heap_flags, true);
+}
+
 static const struct dma_heap_ops system_heap_ops = {
 	.allocate = system_heap_allocate,
 };
 
+static const struct dma_heap_ops system_pooled_heap_ops = {
+	.allocate = system_pooled_heap_allocate,
+};
+
 static int system_heap_create(void)
 {
 	struct dma_heap_export_info exp_info;
+	int i, ret;
 
 	exp_info.name = "system";
 	exp_info.ops = &system_heap_ops;
@@ -437,6 +596,25 @@ static int system_heap_create(void)
 	if (IS_ERR(sys_heap))
 		return PTR_ERR(sys_heap);
 
+	for (i = 0; i < NUM_ORDERS; i++) {
+		INIT_LIST_HEAD(&pools[i].items);
+		spin_lock_init(&pools[i].lock);
+	}
+
+	ret = register_shrinker(&pool_shrinker, "dma-buf-system-heap-pool");
+	if (ret)
+		return ret;
+
+	exp_info.name = "system-pooled";
+	exp_info.ops = &system_pooled_heap_ops;
+	exp_info.priv = NULL;
+
+	sys_pooled_heap = dma_heap_add(&exp_info);
+	if (IS_ERR(sys_pooled_heap)) {
+		unregister_shrinker(&pool_shrinker);
+		return PTR_ERR(sys_pooled_heap);
+	}
+
 	return 0;
 }
 module_init(system_heap_create);
@@ -350,6 +350,111 @@ out:
 	return ret;
 }
 
+struct sync_file_wait_multi {
+	wait_queue_head_t wq;
+	atomic_t pending;
+};
+
+struct sync_file_wait_cb {
+	struct dma_fence_cb cb;
+	struct sync_file_wait_multi *wait;
+};
+
+static void sync_file_wait_multi_cb_func(struct dma_fence *f,
+					 struct dma_fence_cb *cb)
+{
+	struct sync_file_wait_cb *wait_cb =
+		container_of(cb, struct sync_file_wait_cb, cb);
+
+	if (atomic_dec_and_test(&wait_cb->wait->pending))
+		wake_up(&wait_cb->wait->wq);
+}
+
+#define SYNC_FILE_WAIT_MULTI_MAX 4096
+
+static long sync_file_ioctl_wait_multi(struct sync_file *sync_file,
+				       unsigned long arg)
+{
+	struct sync_wait_multi_data data;
+	struct sync_file_wait_multi wait;
+	struct sync_file_wait_cb *cbs = NULL;
+	struct dma_fence **fences = NULL;
+	unsigned int i, num_fences;
+	signed long timeout;
+	long ret = 0;
+	s32 *fds;
+
+	if (copy_from_user(&data, (void __user *)arg, sizeof(data)))
+		return -EFAULT;
+
+	if (data.flags || data.pad || !data.num_fds ||
+	    data.num_fds > SYNC_FILE_WAIT_MULTI_MAX)
+		return -EINVAL;
+
+	num_fences = data.num_fds;
+	fds = memdup_user(u64_to_user_ptr(data.fds),
+			  num_fences * sizeof(*fds));
+	if (IS_ERR(fds))
+		return PTR_ERR(fds);
+
+	fences = kcalloc(num_fences, sizeof(*fences), GFP_KERNEL);
+	cbs = kcalloc(num_fences, sizeof(*cbs), GFP_KERNEL);
+	if (!fences || !cbs) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < num_fences; i++) {
+		fences[i] = sync_file_get_fence(fds[i]);
+		if (!fences[i]) {
+			ret = -ENOENT;
+			goto out;
+		}
+	}
+
+	init_waitqueue_head(&wait.wq);
+	/*
+	 * Hold one extra count so a callback firing while we are still
+	 * adding the others can't declare the wait complete early.
+	 */
+	atomic_set(&wait.pending, num_fences + 1);
+
+	for (i = 0; i < num_fences; i++) {
+		cbs[i].wait = &wait;
+		if (dma_fence_add_callback(fences[i], &cbs[i].cb,
+					   sync_file_wait_multi_cb_func))
+			atomic_dec(&wait.pending);
+	}
+
+	timeout = data.timeout_ns < 0 ? MAX_SCHEDULE_TIMEOUT :
+			nsecs_to_jiffies(data.timeout_ns);
+
+	if (atomic_dec_and_test(&wait.pending))
+		timeout = 1;
+	else
+		timeout = wait_event_interruptible_timeout(wait.wq,
+				!atomic_read(&wait.pending), timeout);
+
+	for (i = 0; i < num_fences; i++)
+		dma_fence_remove_callback(fences[i], &cbs[i].cb);
+
+	if (timeout == 0)
+		ret = -ETIME;
+	else if (timeout < 0)
+		ret = timeout;
+
+out:
+	if (fences) {
+		for (i = 0; i < num_fences; i++)
+			dma_fence_put(fences[i]);
+	}
+	kfree(cbs);
+	kfree(fences);
+	kfree(fds);
+
+	return ret;
+}
+
 static long sync_file_ioctl(struct file *file, unsigned int cmd,
 			    unsigned long arg)
 {
@@ -362,6 +467,9 @@ static long sync_file_ioctl(struct file *file, unsigned int cmd,
 	case SYNC_IOC_FILE_INFO:
 		return sync_file_ioctl_fence_info(sync_file, arg);
 
+	case SYNC_IOC_WAIT_MULTI:
+		return sync_file_ioctl_wait_multi(sync_file, arg);
+
 	default:
 		return -ENOTTY;
 	}
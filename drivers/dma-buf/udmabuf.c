@@ -137,13 +137,11 @@ static void release_udmabuf(struct dma_buf *buf)
 {
 	struct udmabuf *ubuf = buf->priv;
 	struct device *dev = ubuf->device->this_device;
-	pgoff_t pg;
 
 	if (ubuf->sg)
 		put_sg_table(dev, ubuf->sg, DMA_BIDIRECTIONAL);
 
-	for (pg = 0; pg < ubuf->pagecount; pg++)
-		put_page(ubuf->pages[pg]);
+	release_pages(ubuf->pages, ubuf->pagecount);
 	kfree(ubuf->pages);
 	kfree(ubuf);
 }
@@ -207,8 +205,9 @@ static long udmabuf_create(struct miscdevice *device,
 	struct udmabuf *ubuf;
 	struct dma_buf *buf;
 	pgoff_t pgoff, pgcnt, pgidx, pgbuf = 0, pglimit;
+	pgoff_t subpgoff, maxsubpgs, chunk, j;
 	struct page *page, *hpage = NULL;
-	pgoff_t subpgoff, maxsubpgs;
+	struct folio *folio;
 	struct hstate *hpstate;
 	int seals, ret = -EINVAL;
 	u32 i, flags;
@@ -263,41 +262,57 @@ static long udmabuf_create(struct miscdevice *device,
 				    ~huge_page_mask(hpstate)) >> PAGE_SHIFT;
 			maxsubpgs = huge_page_size(hpstate) >> PAGE_SHIFT;
 		}
-		for (pgidx = 0; pgidx < pgcnt; pgidx++) {
+		/*
+		 * Populate folio-at-a-time: one page cache lookup and one
+		 * batched reference grab cover all the subpages of a THP or
+		 * hugetlb folio, and keeping the subpages physically
+		 * contiguous in the pages array lets the sg_table coalesce
+		 * them into large segments the IOMMU can map with big pages.
+		 */
+		for (pgidx = 0; pgidx < pgcnt; pgidx += chunk) {
 			if (is_file_hugepages(memfd)) {
+				hpage = find_get_page_flags(mapping, pgoff,
+							    FGP_ACCESSED);
 				if (!hpage) {
-					hpage = find_get_page_flags(mapping, pgoff,
-								    FGP_ACCESSED);
-					if (!hpage) {
-						ret = -EINVAL;
-						goto err;
-					}
+					ret = -EINVAL;
+					goto err;
 				}
-				page = hpage + subpgoff;
-				get_page(page);
-				subpgoff++;
+				chunk = min(pgcnt - pgidx,
+					    maxsubpgs - subpgoff);
+				/*
+				 * One reference per stored subpage; the
+				 * lookup reference is dropped below.
+				 */
+				page_ref_add(hpage, chunk);
+				for (j = 0; j < chunk; j++)
+					ubuf->pages[pgbuf++] =
+						hpage + subpgoff + j;
+				put_page(hpage);
+				hpage = NULL;
+				subpgoff += chunk;
 				if (subpgoff == maxsubpgs) {
-					put_page(hpage);
-					hpage = NULL;
 					subpgoff = 0;
 					pgoff++;
 				}
 			} else {
-				page = shmem_read_mapping_page(mapping,
-							       pgoff + pgidx);
-				if (IS_ERR(page)) {
-					ret = PTR_ERR(page);
+				folio = shmem_read_folio(mapping,
+							 pgoff + pgidx);
+				if (IS_ERR(folio)) {
+					ret = PTR_ERR(folio);
 					goto err;
 				}
+				page = folio_file_page(folio, pgoff + pgidx);
+				chunk = min(pgcnt - pgidx,
+					    folio_nr_pages(folio) -
+					    folio_page_idx(folio, page));
+				/* the read reference covers the first page */
+				folio_ref_add(folio, chunk - 1);
+				for (j = 0; j < chunk; j++)
+					ubuf->pages[pgbuf++] = page + j;
 			}
-			ubuf->pages[pgbuf++] = page;
 		}
 		fput(memfd);
 		memfd = NULL;
-		if (hpage) {
-			put_page(hpage);
-			hpage = NULL;
-		}
 	}
 
 	exp_info.ops  = &udmabuf_ops;
@@ -318,8 +333,7 @@ static long udmabuf_create(struct miscdevice *device,
 	return dma_buf_fd(buf, flags);
 
 err:
-	while (pgbuf > 0)
-		put_page(ubuf->pages[--pgbuf]);
+	release_pages(ubuf->pages, pgbuf);
 	if (memfd)
 		fput(memfd);
 	kfree(ubuf->pages);
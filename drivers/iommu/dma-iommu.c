@@ -59,6 +59,10 @@ struct iommu_dma_cookie {
 			struct timer_list	fq_timer;
 			/* 1 when timer is active, 0 when not */
 			atomic_t		fq_timer_on;
+			/* Number of open unmap batches deferring to the fq */
+			atomic_t		fq_batch;
+			/* Attr-deferred unmaps left before a forced flush */
+			atomic_t		fq_defer_budget;
 		};
 		/* Trivial linear page allocator for IOMMU_DMA_MSI_COOKIE */
 		dma_addr_t		msi_iova;
@@ -89,6 +93,12 @@ early_param("iommu.forcedac", iommu_dma_forcedac_setup);
 /* Timeout (in ms) after which entries are flushed from the queue */
 #define IOVA_FQ_TIMEOUT	10
 
+/* Staleness bound (in ms) for unmaps deferred on an otherwise strict domain */
+#define IOVA_FQ_DEFER_TIMEOUT	1
+
+/* Attr-deferred unmaps allowed to accumulate before forcing a flush */
+#define IOVA_FQ_DEFER_BUDGET	1024
+
 /* Flush queue entry for deferred flushing */
 struct iova_fq_entry {
 	unsigned long iova_pfn;
@@ -250,6 +260,7 @@ int iommu_dma_init_fq(struct iommu_domain *domain)
 
 	atomic64_set(&cookie->fq_flush_start_cnt,  0);
 	atomic64_set(&cookie->fq_flush_finish_cnt, 0);
+	atomic_set(&cookie->fq_defer_budget, IOVA_FQ_DEFER_BUDGET);
 
 	queue = alloc_percpu(struct iova_fq);
 	if (!queue) {
@@ -674,8 +685,8 @@ static void iommu_dma_free_iova(struct iommu_dma_cookie *cookie,
 				size >> iova_shift(iovad));
 }
 
-static void __iommu_dma_unmap(struct device *dev, dma_addr_t dma_addr,
-		size_t size)
+static void __iommu_dma_unmap_attrs(struct device *dev, dma_addr_t dma_addr,
+		size_t size, unsigned long attrs)
 {
 	struct iommu_domain *domain = iommu_get_dma_domain(dev);
 	struct iommu_dma_cookie *cookie = domain->iova_cookie;
@@ -687,7 +698,16 @@ static void __iommu_dma_unmap(struct device *dev, dma_addr_t dma_addr,
 	dma_addr -= iova_off;
 	size = iova_align(iovad, size + iova_off);
 	iommu_iotlb_gather_init(&iotlb_gather);
-	iotlb_gather.queued = READ_ONCE(cookie->fq_domain);
+	/*
+	 * Defer the invalidation whenever the domain runs in flush-queue mode,
+	 * while an unmap batch holds the queue open on a strict domain, or
+	 * when the caller marked this particular mapping as tolerating a
+	 * bounded invalidation window.
+	 */
+	iotlb_gather.queued = READ_ONCE(cookie->fq_domain) &&
+			      (domain->type == IOMMU_DOMAIN_DMA_FQ ||
+			       atomic_read(&cookie->fq_batch) ||
+			       (attrs & DMA_ATTR_DEFERRED_INVALIDATE));
 
 	unmapped = iommu_unmap_fast(domain, dma_addr, size, &iotlb_gather);
 	WARN_ON(unmapped != size);
@@ -695,6 +715,80 @@ static void __iommu_dma_unmap(struct device *dev, dma_addr_t dma_addr,
 	if (!iotlb_gather.queued)
 		iommu_iotlb_sync(domain, &iotlb_gather);
 	iommu_dma_free_iova(cookie, dma_addr, size, &iotlb_gather);
+
+	/*
+	 * Attr-deferred unmaps on a strict domain carry a hard staleness
+	 * bound: force a flush once the budget is spent, and otherwise pull
+	 * the queue timer in to the deferral timeout.
+	 */
+	if (iotlb_gather.queued && domain->type != IOMMU_DOMAIN_DMA_FQ &&
+	    (attrs & DMA_ATTR_DEFERRED_INVALIDATE)) {
+		if (atomic_dec_return(&cookie->fq_defer_budget) <= 0) {
+			atomic_set(&cookie->fq_defer_budget,
+				   IOVA_FQ_DEFER_BUDGET);
+			fq_flush_iotlb(cookie);
+		} else {
+			timer_reduce(&cookie->fq_timer, jiffies +
+				     msecs_to_jiffies(IOVA_FQ_DEFER_TIMEOUT));
+		}
+	}
+}
+
+static void __iommu_dma_unmap(struct device *dev, dma_addr_t dma_addr,
+		size_t size)
+{
+	__iommu_dma_unmap_attrs(dev, dma_addr, size, 0);
+}
+
+static void iommu_dma_unmap_batch_begin(struct device *dev)
+{
+	struct iommu_domain *domain = iommu_get_dma_domain(dev);
+	struct iommu_dma_cookie *cookie = domain->iova_cookie;
+
+	if (cookie->type != IOMMU_DMA_IOVA_COOKIE)
+		return;
+
+	/*
+	 * Strict domains have no flush queue by default; bring one up the
+	 * first time a batch is opened. iommu_dma_init_fq() is otherwise
+	 * only called with the group mutex held, so serialise against
+	 * ourselves with the cookie mutex (which means opening the first
+	 * batch may sleep).
+	 */
+	if (!READ_ONCE(cookie->fq_domain)) {
+		mutex_lock(&cookie->mutex);
+		iommu_dma_init_fq(domain);
+		mutex_unlock(&cookie->mutex);
+		/* No queue, nothing to defer to - unmaps stay synchronous */
+		if (!READ_ONCE(cookie->fq_domain))
+			return;
+	}
+
+	atomic_inc(&cookie->fq_batch);
+}
+
+static void iommu_dma_unmap_batch_end(struct device *dev)
+{
+	struct iommu_domain *domain = iommu_get_dma_domain(dev);
+	struct iommu_dma_cookie *cookie = domain->iova_cookie;
+	int cpu;
+
+	if (cookie->type != IOMMU_DMA_IOVA_COOKIE ||
+	    !READ_ONCE(cookie->fq_domain))
+		return;
+
+	atomic_dec(&cookie->fq_batch);
+
+	/* One invalidation covers every unmap queued during the batch */
+	fq_flush_iotlb(cookie);
+	for_each_possible_cpu(cpu) {
+		struct iova_fq *fq = per_cpu_ptr(cookie->fq, cpu);
+		unsigned long flags;
+
+		spin_lock_irqsave(&fq->lock, flags);
+		fq_ring_free(cookie, fq);
+		spin_unlock_irqrestore(&fq->lock, flags);
+	}
 }
 
 static dma_addr_t __iommu_dma_map(struct device *dev, phys_addr_t phys,
@@ -1049,7 +1143,7 @@ static void iommu_dma_unmap_page(struct device *dev, dma_addr_t dma_handle,
 	if (!(attrs & DMA_ATTR_SKIP_CPU_SYNC) && !dev_is_dma_coherent(dev))
 		arch_sync_dma_for_cpu(phys, size, dir);
 
-	__iommu_dma_unmap(dev, dma_handle, size);
+	__iommu_dma_unmap_attrs(dev, dma_handle, size, attrs);
 
 	if (unlikely(is_swiotlb_buffer(dev, phys)))
 		swiotlb_tbl_unmap_single(dev, phys, size, dir, attrs);
@@ -1355,7 +1449,7 @@ static void iommu_dma_unmap_sg(struct device *dev, struct scatterlist *sg,
 	}
 
 	if (end)
-		__iommu_dma_unmap(dev, start, end - start);
+		__iommu_dma_unmap_attrs(dev, start, end - start, attrs);
 }
 
 static dma_addr_t iommu_dma_map_resource(struct device *dev, phys_addr_t phys,
@@ -1369,7 +1463,7 @@ static dma_addr_t iommu_dma_map_resource(struct device *dev, phys_addr_t phys,
 static void iommu_dma_unmap_resource(struct device *dev, dma_addr_t handle,
 		size_t size, enum dma_data_direction dir, unsigned long attrs)
 {
-	__iommu_dma_unmap(dev, handle, size);
+	__iommu_dma_unmap_attrs(dev, handle, size, attrs);
 }
 
 static void __iommu_dma_free(struct device *dev, size_t size, void *cpu_addr)
@@ -1572,6 +1666,8 @@ static const struct dma_map_ops iommu_dma_ops = {
 	.sync_sg_for_device	= iommu_dma_sync_sg_for_device,
 	.map_resource		= iommu_dma_map_resource,
 	.unmap_resource		= iommu_dma_unmap_resource,
+	.unmap_batch_begin	= iommu_dma_unmap_batch_begin,
+	.unmap_batch_end	= iommu_dma_unmap_batch_end,
 	.get_merge_boundary	= iommu_dma_get_merge_boundary,
 	.opt_mapping_size	= iommu_dma_opt_mapping_size,
 };
@@ -370,31 +370,51 @@ static int __arm_lpae_map(struct arm_lpae_io_pgtable *data, unsigned long iova,
 	if (WARN_ON(lvl >= ARM_LPAE_MAX_LEVELS - 1))
 		return -EINVAL;
 
-	/* Grab a pointer to the next level */
-	pte = READ_ONCE(*ptep);
-	if (!pte) {
-		cptep = __arm_lpae_alloc_pages(tblsz, gfp, cfg);
-		if (!cptep)
-			return -ENOMEM;
+	/*
+	 * Walk the remaining next-level tables laterally rather than
+	 * returning to the caller at every table boundary, so that a large
+	 * physically-contiguous run is installed in a single traversal.
+	 */
+	max_entries = ARM_LPAE_PTES_PER_TABLE(data) - map_idx_start;
+	for (num_entries = 0; num_entries < max_entries && pgcount;
+	     num_entries++, ptep++) {
+		size_t mapped_once = 0;
 
-		pte = arm_lpae_install_table(cptep, ptep, 0, data);
-		if (pte)
-			__arm_lpae_free_pages(cptep, tblsz, cfg);
-	} else if (!cfg->coherent_walk && !(pte & ARM_LPAE_PTE_SW_SYNC)) {
-		__arm_lpae_sync_pte(ptep, 1, cfg);
-	}
+		/* Grab a pointer to the next level */
+		pte = READ_ONCE(*ptep);
+		if (!pte) {
+			cptep = __arm_lpae_alloc_pages(tblsz, gfp, cfg);
+			if (!cptep)
+				return -ENOMEM;
+
+			pte = arm_lpae_install_table(cptep, ptep, 0, data);
+			if (pte)
+				__arm_lpae_free_pages(cptep, tblsz, cfg);
+		} else if (!cfg->coherent_walk && !(pte & ARM_LPAE_PTE_SW_SYNC)) {
+			__arm_lpae_sync_pte(ptep, 1, cfg);
+		}
 
-	if (pte && !iopte_leaf(pte, lvl, data->iop.fmt)) {
-		cptep = iopte_deref(pte, data);
-	} else if (pte) {
-		/* We require an unmap first */
-		WARN_ON(!selftest_running);
-		return -EEXIST;
+		if (pte && !iopte_leaf(pte, lvl, data->iop.fmt)) {
+			cptep = iopte_deref(pte, data);
+		} else if (pte) {
+			/* We require an unmap first */
+			WARN_ON(!selftest_running);
+			return -EEXIST;
+		}
+
+		/* Rinse, repeat */
+		ret = __arm_lpae_map(data, iova, paddr, size, pgcount, prot,
+				     lvl + 1, cptep, gfp, &mapped_once);
+		*mapped += mapped_once;
+		if (ret)
+			return ret;
+
+		pgcount -= mapped_once / size;
+		iova += mapped_once;
+		paddr += mapped_once;
 	}
 
-	/* Rinse, repeat */
-	return __arm_lpae_map(data, iova, paddr, size, pgcount, prot, lvl + 1,
-			      cptep, gfp, mapped);
+	return 0;
 }
 
 static arm_lpae_iopte arm_lpae_prot_to_pte(struct arm_lpae_io_pgtable *data,
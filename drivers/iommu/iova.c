@@ -15,7 +15,26 @@
 /* The anchor node sits above the top of the usable address space */
 #define IOVA_ANCHOR	~0UL
 
-#define IOVA_RANGE_CACHE_MAX_SIZE 6	/* log of max cached IOVA range size (in pages) */
+#define IOVA_RANGE_CACHE_DEFAULT_SIZE 6	/* log of max cached IOVA range size (in pages) */
+#define IOVA_RANGE_CACHE_MAX_SIZE 12	/* upper bound for the per-domain setting */
+
+/*
+ * As kmalloc's buffer size is fixed to power of 2, 127 is chosen to
+ * assure size of a default-depth 'iova_magazine' to be 1024 bytes, so
+ * that no memory will be wasted.
+ */
+#define IOVA_MAG_SIZE 127		/* default magazine depth */
+#define IOVA_MAG_MAX_SIZE 1023		/* upper bound for the per-domain setting */
+
+/* Ranges primed into the rcache per slow-path miss of a cacheable size */
+#define IOVA_REFILL_BATCH 8
+
+/* Update a per-cpu allocation statistic, if statistics are enabled */
+#define iova_stat_inc(iovad, field)					\
+do {									\
+	if ((iovad)->stats)						\
+		this_cpu_inc((iovad)->stats->field);			\
+} while (0)
 
 static bool iova_rcache_insert(struct iova_domain *iovad,
 			       unsigned long pfn,
@@ -23,12 +42,14 @@ static bool iova_rcache_insert(struct iova_domain *iovad,
 static unsigned long iova_rcache_get(struct iova_domain *iovad,
 				     unsigned long size,
 				     unsigned long limit_pfn);
+static void iova_rcache_refill(struct iova_domain *iovad, unsigned long size,
+			       unsigned long limit_pfn);
 static void free_cpu_cached_iovas(unsigned int cpu, struct iova_domain *iovad);
 static void free_iova_rcaches(struct iova_domain *iovad);
 
 unsigned long iova_rcache_range(void)
 {
-	return PAGE_SIZE << (IOVA_RANGE_CACHE_MAX_SIZE - 1);
+	return PAGE_SIZE << (IOVA_RANGE_CACHE_DEFAULT_SIZE - 1);
 }
 
 static int iova_cpuhp_dead(unsigned int cpu, struct hlist_node *node)
@@ -67,6 +88,8 @@ init_iova_domain(struct iova_domain *iovad, unsigned long granule,
 	iovad->start_pfn = start_pfn;
 	iovad->dma_32bit_pfn = 1UL << (32 - iova_shift(iovad));
 	iovad->max32_alloc_size = iovad->dma_32bit_pfn;
+	iovad->rcache_max_size = IOVA_RANGE_CACHE_DEFAULT_SIZE;
+	iovad->rcache_mag_size = IOVA_MAG_SIZE;
 	iovad->anchor.pfn_lo = iovad->anchor.pfn_hi = IOVA_ANCHOR;
 	rb_link_node(&iovad->anchor.node, NULL, &iovad->rbroot.rb_node);
 	rb_insert_color(&iovad->anchor.node, &iovad->rbroot);
@@ -175,25 +198,25 @@ iova_insert_rbtree(struct rb_root *root, struct iova *iova,
 	rb_insert_color(&iova->node, root);
 }
 
-static int __alloc_and_insert_iova_range(struct iova_domain *iovad,
+static int __alloc_and_insert_iova_range_locked(struct iova_domain *iovad,
 		unsigned long size, unsigned long limit_pfn,
 			struct iova *new, bool size_aligned)
 {
 	struct rb_node *curr, *prev;
 	struct iova *curr_iova;
-	unsigned long flags;
 	unsigned long new_pfn, retry_pfn;
 	unsigned long align_mask = ~0UL;
 	unsigned long high_pfn = limit_pfn, low_pfn = iovad->start_pfn;
 
+	assert_spin_locked(&iovad->iova_rbtree_lock);
+
 	if (size_aligned)
 		align_mask <<= fls_long(size - 1);
 
 	/* Walk the tree backwards */
-	spin_lock_irqsave(&iovad->iova_rbtree_lock, flags);
 	if (limit_pfn <= iovad->dma_32bit_pfn &&
 			size >= iovad->max32_alloc_size)
-		goto iova32_full;
+		return -ENOMEM;
 
 	curr = __get_cached_rbnode(iovad, limit_pfn);
 	curr_iova = to_iova(curr);
@@ -217,7 +240,7 @@ retry:
 			goto retry;
 		}
 		iovad->max32_alloc_size = size;
-		goto iova32_full;
+		return -ENOMEM;
 	}
 
 	/* pfn_lo will point to size aligned address if size_aligned is set */
@@ -228,12 +251,36 @@ retry:
 	iova_insert_rbtree(&iovad->rbroot, new, prev);
 	__cached_rbnode_insert_update(iovad, new);
 
-	spin_unlock_irqrestore(&iovad->iova_rbtree_lock, flags);
 	return 0;
+}
+
+/* Take the rbtree lock, counting acquisitions that had to spin */
+static unsigned long iova_rbtree_lock_stat(struct iova_domain *iovad)
+{
+	unsigned long flags;
+
+	if (!spin_trylock_irqsave(&iovad->iova_rbtree_lock, flags)) {
+		iova_stat_inc(iovad, rbtree_contended);
+		spin_lock_irqsave(&iovad->iova_rbtree_lock, flags);
+	}
 
-iova32_full:
+	return flags;
+}
+
+static int __alloc_and_insert_iova_range(struct iova_domain *iovad,
+		unsigned long size, unsigned long limit_pfn,
+			struct iova *new, bool size_aligned)
+{
+	unsigned long flags;
+	int ret;
+
+	flags = iova_rbtree_lock_stat(iovad);
+	iova_stat_inc(iovad, rbtree_allocs);
+	ret = __alloc_and_insert_iova_range_locked(iovad, size, limit_pfn,
+						   new, size_aligned);
 	spin_unlock_irqrestore(&iovad->iova_rbtree_lock, flags);
-	return -ENOMEM;
+
+	return ret;
 }
 
 static struct kmem_cache *iova_cache;
@@ -448,12 +495,16 @@ alloc_iova_fast(struct iova_domain *iovad, unsigned long size,
 	 * rounding up anything cacheable to make sure that can't happen. The
 	 * order of the unadjusted size will still match upon freeing.
 	 */
-	if (size < (1 << (IOVA_RANGE_CACHE_MAX_SIZE - 1)))
+	if (size < (1UL << (iovad->rcache_max_size - 1)))
 		size = roundup_pow_of_two(size);
 
 	iova_pfn = iova_rcache_get(iovad, size, limit_pfn + 1);
-	if (iova_pfn)
+	if (iova_pfn) {
+		iova_stat_inc(iovad, rcache_hits);
 		return iova_pfn;
+	}
+
+	iova_stat_inc(iovad, rcache_misses);
 
 retry:
 	new_iova = alloc_iova(iovad, size, limit_pfn, true);
@@ -471,6 +522,10 @@ retry:
 		goto retry;
 	}
 
+	/* Prime the rcache behind us so the next misses become hits */
+	if (order_base_2(size) < iovad->rcache_max_size)
+		iova_rcache_refill(iovad, size, limit_pfn + 1);
+
 	return new_iova->pfn_lo;
 }
 EXPORT_SYMBOL_GPL(alloc_iova_fast);
@@ -619,17 +674,11 @@ EXPORT_SYMBOL_GPL(reserve_iova);
  * dynamic size tuning described in the paper.
  */
 
-/*
- * As kmalloc's buffer size is fixed to power of 2, 127 is chosen to
- * assure size of 'iova_magazine' to be 1024 bytes, so that no memory
- * will be wasted.
- */
-#define IOVA_MAG_SIZE 127
 #define MAX_GLOBAL_MAGS 32	/* magazines per bin */
 
 struct iova_magazine {
 	unsigned long size;
-	unsigned long pfns[IOVA_MAG_SIZE];
+	unsigned long pfns[];
 };
 
 struct iova_cpu_rcache {
@@ -645,9 +694,11 @@ struct iova_rcache {
 	struct iova_cpu_rcache __percpu *cpu_rcaches;
 };
 
-static struct iova_magazine *iova_magazine_alloc(gfp_t flags)
+static struct iova_magazine *iova_magazine_alloc(struct iova_domain *iovad,
+						 gfp_t flags)
 {
-	return kzalloc(sizeof(struct iova_magazine), flags);
+	return kzalloc(sizeof(struct iova_magazine) +
+		       iovad->rcache_mag_size * sizeof(unsigned long), flags);
 }
 
 static void iova_magazine_free(struct iova_magazine *mag)
@@ -678,9 +729,10 @@ iova_magazine_free_pfns(struct iova_magazine *mag, struct iova_domain *iovad)
 	mag->size = 0;
 }
 
-static bool iova_magazine_full(struct iova_magazine *mag)
+static bool iova_magazine_full(struct iova_domain *iovad,
+			       struct iova_magazine *mag)
 {
-	return mag->size == IOVA_MAG_SIZE;
+	return mag->size == iovad->rcache_mag_size;
 }
 
 static bool iova_magazine_empty(struct iova_magazine *mag)
@@ -711,18 +763,76 @@ static void iova_magazine_push(struct iova_magazine *mag, unsigned long pfn)
 	mag->pfns[mag->size++] = pfn;
 }
 
+/**
+ * iova_domain_set_rcache_config - tune the rcache for a domain
+ * @iovad: - iova domain in question
+ * @max_order: - one more than the log of the largest cached size (in pages)
+ * @mag_size: - number of ranges held by each magazine
+ *
+ * Overrides the default rcache range and magazine depth for domains whose
+ * workload is known, e.g. a NIC whose rings use 64K buffers. Must be called
+ * after init_iova_domain() but before iova_domain_init_rcaches().
+ */
+int iova_domain_set_rcache_config(struct iova_domain *iovad,
+				  unsigned int max_order,
+				  unsigned int mag_size)
+{
+	if (WARN_ON(iovad->rcaches))
+		return -EBUSY;
+	if (!max_order || max_order > IOVA_RANGE_CACHE_MAX_SIZE ||
+	    !mag_size || mag_size > IOVA_MAG_MAX_SIZE)
+		return -EINVAL;
+
+	iovad->rcache_max_size = max_order;
+	iovad->rcache_mag_size = mag_size;
+	return 0;
+}
+EXPORT_SYMBOL_GPL(iova_domain_set_rcache_config);
+
+/**
+ * iova_domain_get_stats - read accumulated allocation statistics
+ * @iovad: - iova domain in question
+ * @stats: - filled with the sum of the per-cpu counters
+ */
+void iova_domain_get_stats(struct iova_domain *iovad,
+			   struct iova_domain_stats *stats)
+{
+	unsigned int cpu;
+
+	memset(stats, 0, sizeof(*stats));
+	if (!iovad->stats)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct iova_domain_stats *s = per_cpu_ptr(iovad->stats, cpu);
+
+		stats->rcache_hits += s->rcache_hits;
+		stats->rcache_misses += s->rcache_misses;
+		stats->depot_refills += s->depot_refills;
+		stats->rbtree_allocs += s->rbtree_allocs;
+		stats->rbtree_contended += s->rbtree_contended;
+	}
+}
+EXPORT_SYMBOL_GPL(iova_domain_get_stats);
+
 int iova_domain_init_rcaches(struct iova_domain *iovad)
 {
 	unsigned int cpu;
 	int i, ret;
 
-	iovad->rcaches = kcalloc(IOVA_RANGE_CACHE_MAX_SIZE,
+	iovad->rcaches = kcalloc(iovad->rcache_max_size,
 				 sizeof(struct iova_rcache),
 				 GFP_KERNEL);
 	if (!iovad->rcaches)
 		return -ENOMEM;
 
-	for (i = 0; i < IOVA_RANGE_CACHE_MAX_SIZE; ++i) {
+	iovad->stats = alloc_percpu(struct iova_domain_stats);
+	if (!iovad->stats) {
+		ret = -ENOMEM;
+		goto out_err;
+	}
+
+	for (i = 0; i < iovad->rcache_max_size; ++i) {
 		struct iova_cpu_rcache *cpu_rcache;
 		struct iova_rcache *rcache;
 
@@ -739,8 +849,10 @@ int iova_domain_init_rcaches(struct iova_domain *iovad)
 			cpu_rcache = per_cpu_ptr(rcache->cpu_rcaches, cpu);
 
 			spin_lock_init(&cpu_rcache->lock);
-			cpu_rcache->loaded = iova_magazine_alloc(GFP_KERNEL);
-			cpu_rcache->prev = iova_magazine_alloc(GFP_KERNEL);
+			cpu_rcache->loaded = iova_magazine_alloc(iovad,
+								 GFP_KERNEL);
+			cpu_rcache->prev = iova_magazine_alloc(iovad,
+							       GFP_KERNEL);
 			if (!cpu_rcache->loaded || !cpu_rcache->prev) {
 				ret = -ENOMEM;
 				goto out_err;
@@ -778,13 +890,14 @@ static bool __iova_rcache_insert(struct iova_domain *iovad,
 	cpu_rcache = raw_cpu_ptr(rcache->cpu_rcaches);
 	spin_lock_irqsave(&cpu_rcache->lock, flags);
 
-	if (!iova_magazine_full(cpu_rcache->loaded)) {
+	if (!iova_magazine_full(iovad, cpu_rcache->loaded)) {
 		can_insert = true;
-	} else if (!iova_magazine_full(cpu_rcache->prev)) {
+	} else if (!iova_magazine_full(iovad, cpu_rcache->prev)) {
 		swap(cpu_rcache->prev, cpu_rcache->loaded);
 		can_insert = true;
 	} else {
-		struct iova_magazine *new_mag = iova_magazine_alloc(GFP_ATOMIC);
+		struct iova_magazine *new_mag = iova_magazine_alloc(iovad,
+								    GFP_ATOMIC);
 
 		if (new_mag) {
 			spin_lock(&rcache->lock);
@@ -819,18 +932,62 @@ static bool iova_rcache_insert(struct iova_domain *iovad, unsigned long pfn,
 {
 	unsigned int log_size = order_base_2(size);
 
-	if (log_size >= IOVA_RANGE_CACHE_MAX_SIZE)
+	if (log_size >= iovad->rcache_max_size)
 		return false;
 
 	return __iova_rcache_insert(iovad, &iovad->rcaches[log_size], pfn);
 }
 
+/*
+ * A slow-path miss of a cacheable size means the caller is allocating
+ * faster than the rcache is being replenished. Allocate a small batch of
+ * additional ranges under a single rbtree lock hold and stash them in the
+ * rcache, so the rbtree walk is amortized over the next several requests.
+ */
+static void iova_rcache_refill(struct iova_domain *iovad, unsigned long size,
+			       unsigned long limit_pfn)
+{
+	struct iova *batch[IOVA_REFILL_BATCH];
+	unsigned int i, allocated, count;
+	unsigned long flags;
+
+	for (count = 0; count < IOVA_REFILL_BATCH; count++) {
+		batch[count] = alloc_iova_mem();
+		if (!batch[count])
+			break;
+	}
+
+	flags = iova_rbtree_lock_stat(iovad);
+	for (allocated = 0; allocated < count; allocated++) {
+		if (__alloc_and_insert_iova_range_locked(iovad, size,
+							 limit_pfn,
+							 batch[allocated],
+							 true))
+			break;
+		iova_stat_inc(iovad, rbtree_allocs);
+	}
+	spin_unlock_irqrestore(&iovad->iova_rbtree_lock, flags);
+
+	for (i = allocated; i < count; i++)
+		free_iova_mem(batch[i]);
+
+	/*
+	 * The cached ranges stay in the rbtree until the magazine holding
+	 * them is retired, exactly as with free_iova_fast().
+	 */
+	for (i = 0; i < allocated; i++) {
+		if (!iova_rcache_insert(iovad, batch[i]->pfn_lo, size))
+			free_iova(iovad, batch[i]->pfn_lo);
+	}
+}
+
 /*
  * Caller wants to allocate a new IOVA range from 'rcache'.  If we can
  * satisfy the request, return a matching non-NULL range and remove
  * it from the 'rcache'.
  */
-static unsigned long __iova_rcache_get(struct iova_rcache *rcache,
+static unsigned long __iova_rcache_get(struct iova_domain *iovad,
+				       struct iova_rcache *rcache,
 				       unsigned long limit_pfn)
 {
 	struct iova_cpu_rcache *cpu_rcache;
@@ -852,6 +1009,7 @@ static unsigned long __iova_rcache_get(struct iova_rcache *rcache,
 			iova_magazine_free(cpu_rcache->loaded);
 			cpu_rcache->loaded = rcache->depot[--rcache->depot_size];
 			has_pfn = true;
+			iova_stat_inc(iovad, depot_refills);
 		}
 		spin_unlock(&rcache->lock);
 	}
@@ -875,10 +1033,11 @@ static unsigned long iova_rcache_get(struct iova_domain *iovad,
 {
 	unsigned int log_size = order_base_2(size);
 
-	if (log_size >= IOVA_RANGE_CACHE_MAX_SIZE)
+	if (log_size >= iovad->rcache_max_size)
 		return 0;
 
-	return __iova_rcache_get(&iovad->rcaches[log_size], limit_pfn - size);
+	return __iova_rcache_get(iovad, &iovad->rcaches[log_size],
+				 limit_pfn - size);
 }
 
 /*
@@ -891,7 +1050,7 @@ static void free_iova_rcaches(struct iova_domain *iovad)
 	unsigned int cpu;
 	int i, j;
 
-	for (i = 0; i < IOVA_RANGE_CACHE_MAX_SIZE; ++i) {
+	for (i = 0; i < iovad->rcache_max_size; ++i) {
 		rcache = &iovad->rcaches[i];
 		if (!rcache->cpu_rcaches)
 			break;
@@ -905,6 +1064,8 @@ static void free_iova_rcaches(struct iova_domain *iovad)
 			iova_magazine_free(rcache->depot[j]);
 	}
 
+	free_percpu(iovad->stats);
+	iovad->stats = NULL;
 	kfree(iovad->rcaches);
 	iovad->rcaches = NULL;
 }
@@ -919,7 +1080,7 @@ static void free_cpu_cached_iovas(unsigned int cpu, struct iova_domain *iovad)
 	unsigned long flags;
 	int i;
 
-	for (i = 0; i < IOVA_RANGE_CACHE_MAX_SIZE; ++i) {
+	for (i = 0; i < iovad->rcache_max_size; ++i) {
 		rcache = &iovad->rcaches[i];
 		cpu_rcache = per_cpu_ptr(rcache->cpu_rcaches, cpu);
 		spin_lock_irqsave(&cpu_rcache->lock, flags);
@@ -938,7 +1099,7 @@ static void free_global_cached_iovas(struct iova_domain *iovad)
 	unsigned long flags;
 	int i, j;
 
-	for (i = 0; i < IOVA_RANGE_CACHE_MAX_SIZE; ++i) {
+	for (i = 0; i < iovad->rcache_max_size; ++i) {
 		rcache = &iovad->rcaches[i];
 		spin_lock_irqsave(&rcache->lock, flags);
 		for (j = 0; j < rcache->depot_size; ++j) {
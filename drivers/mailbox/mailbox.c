@@ -54,6 +54,7 @@ static void msg_submit(struct mbox_chan *chan)
 {
 	unsigned count, idx;
 	unsigned long flags;
+	bool prepared = false;
 	void *data;
 	int err = -EBUSY;
 
@@ -69,9 +70,40 @@ static void msg_submit(struct mbox_chan *chan)
 	else
 		idx += MBOX_TX_QUEUE_LEN - count;
 
+	/*
+	 * Hand the whole backlog to a burst-capable controller in one go;
+	 * it accepts a prefix and drains it autonomously, signalling TXDone
+	 * once after the last accepted message.  Controllers without ring
+	 * support, and burst submissions the controller rejects outright,
+	 * take the single-message path below.
+	 */
+	if (chan->mbox->ops->send_burst && count > 1) {
+		unsigned int i;
+		int sent;
+
+		for (i = 0; i < count; i++) {
+			chan->burst_msgs[i] =
+				chan->msg_data[(idx + i) % MBOX_TX_QUEUE_LEN];
+			if (chan->cl->tx_prepare)
+				chan->cl->tx_prepare(chan->cl,
+						     chan->burst_msgs[i]);
+		}
+		prepared = true;
+
+		sent = chan->mbox->ops->send_burst(chan, chan->burst_msgs,
+						   count);
+		if (sent > 0) {
+			chan->burst_count = sent;
+			chan->active_req = chan->burst_msgs[sent - 1];
+			chan->msg_count -= sent;
+			err = 0;
+			goto exit;
+		}
+	}
+
 	data = chan->msg_data[idx];
 
-	if (chan->cl->tx_prepare)
+	if (chan->cl->tx_prepare && !prepared)
 		chan->cl->tx_prepare(chan->cl, data);
 	/* Try to submit a message to the MBOX controller */
 	err = chan->mbox->ops->send_data(chan, data);
@@ -92,12 +124,18 @@ exit:
 
 static void tx_tick(struct mbox_chan *chan, int r)
 {
+	void *burst[MBOX_TX_QUEUE_LEN];
+	unsigned int nburst, i;
 	unsigned long flags;
 	void *mssg;
 
 	spin_lock_irqsave(&chan->lock, flags);
 	mssg = chan->active_req;
 	chan->active_req = NULL;
+	nburst = chan->burst_count;
+	chan->burst_count = 0;
+	if (nburst > 1)
+		memcpy(burst, chan->burst_msgs, nburst * sizeof(void *));
 	spin_unlock_irqrestore(&chan->lock, flags);
 
 	/* Submit next message */
@@ -106,9 +144,14 @@ static void tx_tick(struct mbox_chan *chan, int r)
 	if (!mssg)
 		return;
 
-	/* Notify the client */
-	if (chan->cl->tx_done)
-		chan->cl->tx_done(chan->cl, mssg, r);
+	/* Notify the client, once per message of a completed burst */
+	if (chan->cl->tx_done) {
+		if (nburst > 1)
+			for (i = 0; i < nburst; i++)
+				chan->cl->tx_done(chan->cl, burst[i], r);
+		else
+			chan->cl->tx_done(chan->cl, mssg, r);
+	}
 
 	if (r != -ETIME && chan->cl->tx_block)
 		complete(&chan->tx_complete);
@@ -382,6 +425,7 @@ struct mbox_chan *mbox_request_channel(struct mbox_client *cl, int index)
 	chan->msg_free = 0;
 	chan->msg_count = 0;
 	chan->active_req = NULL;
+	chan->burst_count = 0;
 	chan->cl = cl;
 	init_completion(&chan->tx_complete);
 
@@ -455,6 +499,7 @@ void mbox_free_channel(struct mbox_chan *chan)
 	spin_lock_irqsave(&chan->lock, flags);
 	chan->cl = NULL;
 	chan->active_req = NULL;
+	chan->burst_count = 0;
 	if (chan->txdone_method == TXDONE_BY_ACK)
 		chan->txdone_method = TXDONE_BY_POLL;
 
@@ -31,6 +31,7 @@
 #define TBNET_LOGOUT_TIMEOUT	1000
 
 #define TBNET_RING_SIZE		256
+#define TBNET_RX_BATCH		16
 #define TBNET_LOGIN_RETRIES	60
 #define TBNET_LOGOUT_RETRIES	10
 #define TBNET_E2E		BIT(0)
@@ -804,6 +805,8 @@ static int tbnet_poll(struct napi_struct *napi, int budget)
 	struct tbnet *net = container_of(napi, struct tbnet, napi);
 	unsigned int cleaned_count = tbnet_available_buffers(&net->rx_ring);
 	struct device *dma_dev = tb_ring_dma_device(net->rx_ring.ring);
+	struct ring_frame *frames[TBNET_RX_BATCH];
+	unsigned int nframes = 0, fidx = 0;
 	unsigned int rx_packets = 0;
 
 	while (rx_packets < budget) {
@@ -825,9 +828,20 @@ static int tbnet_poll(struct napi_struct *napi, int budget)
 			cleaned_count = 0;
 		}
 
-		frame = tb_ring_poll(net->rx_ring.ring);
-		if (!frame)
-			break;
+		/*
+		 * Pull completed frames off the ring a batch at a time so
+		 * the ring lock is taken once per batch instead of once
+		 * per frame.
+		 */
+		if (fidx == nframes) {
+			nframes = tb_ring_poll_batch(net->rx_ring.ring, frames,
+					min_t(unsigned int, TBNET_RX_BATCH,
+					      budget - rx_packets));
+			fidx = 0;
+			if (!nframes)
+				break;
+		}
+		frame = frames[fidx++];
 
 		dma_unmap_page(dma_dev, frame->buffer_phy,
 			       TBNET_RX_PAGE_SIZE, DMA_FROM_DEVICE);
@@ -890,6 +904,24 @@ static int tbnet_poll(struct napi_struct *napi, int budget)
 		}
 	}
 
+	/*
+	 * Drop any already-dequeued frames we bailed out on (skb
+	 * allocation failure); they cannot be returned to the ring.
+	 */
+	while (fidx < nframes) {
+		struct ring_frame *frame = frames[fidx++];
+		struct tbnet_frame *tf;
+
+		dma_unmap_page(dma_dev, frame->buffer_phy, TBNET_RX_PAGE_SIZE,
+			       DMA_FROM_DEVICE);
+		tf = container_of(frame, typeof(*tf), frame);
+		__free_pages(tf->page, TBNET_RX_PAGE_ORDER);
+		tf->page = NULL;
+		net->rx_ring.cons++;
+		cleaned_count++;
+		net->stats.rx_errors++;
+	}
+
 	net->stats.rx_packets += rx_packets;
 
 	if (cleaned_count)
@@ -12,6 +12,7 @@
 #include <linux/mutex.h>
 #include <linux/hdreg.h>
 #include <linux/sizes.h>
+#include <linux/hash.h>
 #include <linux/ndctl.h>
 #include <linux/fs.h>
 #include <linux/nd.h>
@@ -103,11 +104,85 @@ static int __btt_map_write(struct arena_info *arena, u32 lba, __le32 mapping,
 	return arena_write_bytes(arena, ns_off, &mapping, MAP_ENT_SIZE, flags);
 }
 
+/*
+ * In-memory cache of raw map entries, indexed by a premap LBA hash. The
+ * cache is refreshed whenever a map entry is read or written, and consulted
+ * only on the read path: btt_read_pg()'s verification read always goes to
+ * the media, so a stale cache entry costs one extra loop iteration there,
+ * never a wrong result.
+ */
+static void btt_map_cache_update(struct arena_info *arena, u32 lba,
+			u32 raw_mapping)
+{
+	if (arena->map_cache)
+		WRITE_ONCE(arena->map_cache[hash_32(lba, arena->map_cache_shift)],
+				((u64)lba << 32) | raw_mapping);
+}
+
+static bool btt_map_cache_lookup(struct arena_info *arena, u32 lba,
+			u32 *raw_mapping)
+{
+	u64 ent;
+
+	if (!arena->map_cache)
+		return false;
+
+	ent = READ_ONCE(arena->map_cache[hash_32(lba, arena->map_cache_shift)]);
+	if ((ent >> 32) != lba)
+		return false;
+
+	*raw_mapping = ent;
+	return true;
+}
+
+static int btt_map_decode(u32 lba, u32 raw_mapping, u32 *mapping,
+			int *trim, int *error)
+{
+	u32 postmap, ze, z_flag, e_flag;
+
+	z_flag = ent_z_flag(raw_mapping);
+	e_flag = ent_e_flag(raw_mapping);
+	ze = (z_flag << 1) + e_flag;
+	postmap = ent_lba(raw_mapping);
+
+	/* Reuse the {z,e}_flag variables for *trim and *error */
+	z_flag = 0;
+	e_flag = 0;
+
+	switch (ze) {
+	case 0:
+		/* Initial state. Return postmap = premap */
+		*mapping = lba;
+		break;
+	case 1:
+		*mapping = postmap;
+		e_flag = 1;
+		break;
+	case 2:
+		*mapping = postmap;
+		z_flag = 1;
+		break;
+	case 3:
+		*mapping = postmap;
+		break;
+	default:
+		return -EIO;
+	}
+
+	if (trim)
+		*trim = z_flag;
+	if (error)
+		*error = e_flag;
+
+	return 0;
+}
+
 static int btt_map_write(struct arena_info *arena, u32 lba, u32 mapping,
 			u32 z_flag, u32 e_flag, unsigned long rwb_flags)
 {
 	u32 ze;
 	__le32 mapping_le;
+	int ret;
 
 	/*
 	 * This 'mapping' is supposed to be just the LBA mapping, without
@@ -144,7 +219,10 @@ static int btt_map_write(struct arena_info *arena, u32 lba, u32 mapping,
 	}
 
 	mapping_le = cpu_to_le32(mapping);
-	return __btt_map_write(arena, lba, mapping_le, rwb_flags);
+	ret = __btt_map_write(arena, lba, mapping_le, rwb_flags);
+	if (!ret)
+		btt_map_cache_update(arena, lba, mapping);
+	return ret;
 }
 
 static int btt_map_read(struct arena_info *arena, u32 lba, u32 *mapping,
@@ -152,7 +230,7 @@ static int btt_map_read(struct arena_info *arena, u32 lba, u32 *mapping,
 {
 	int ret;
 	__le32 in;
-	u32 raw_mapping, postmap, ze, z_flag, e_flag;
+	u32 raw_mapping;
 	u64 ns_off = arena->mapoff + (lba * MAP_ENT_SIZE);
 
 	if (unlikely(lba >= arena->external_nlba))
@@ -165,42 +243,24 @@ static int btt_map_read(struct arena_info *arena, u32 lba, u32 *mapping,
 		return ret;
 
 	raw_mapping = le32_to_cpu(in);
+	btt_map_cache_update(arena, lba, raw_mapping);
 
-	z_flag = ent_z_flag(raw_mapping);
-	e_flag = ent_e_flag(raw_mapping);
-	ze = (z_flag << 1) + e_flag;
-	postmap = ent_lba(raw_mapping);
-
-	/* Reuse the {z,e}_flag variables for *trim and *error */
-	z_flag = 0;
-	e_flag = 0;
+	return btt_map_decode(lba, raw_mapping, mapping, trim, error);
+}
 
-	switch (ze) {
-	case 0:
-		/* Initial state. Return postmap = premap */
-		*mapping = lba;
-		break;
-	case 1:
-		*mapping = postmap;
-		e_flag = 1;
-		break;
-	case 2:
-		*mapping = postmap;
-		z_flag = 1;
-		break;
-	case 3:
-		*mapping = postmap;
-		break;
-	default:
-		return -EIO;
-	}
+/*
+ * Like btt_map_read(), but served from the map cache on a hit. Only safe
+ * where a slightly stale entry is tolerable.
+ */
+static int btt_map_read_cached(struct arena_info *arena, u32 lba, u32 *mapping,
+			int *trim, int *error, unsigned long rwb_flags)
+{
+	u32 raw_mapping;
 
-	if (trim)
-		*trim = z_flag;
-	if (error)
-		*error = e_flag;
+	if (btt_map_cache_lookup(arena, lba, &raw_mapping))
+		return btt_map_decode(lba, raw_mapping, mapping, trim, error);
 
-	return ret;
+	return btt_map_read(arena, lba, mapping, trim, error, rwb_flags);
 }
 
 static int btt_log_group_read(struct arena_info *arena, u32 lane,
@@ -742,6 +802,22 @@ static int btt_maplocks_init(struct arena_info *arena)
 	return 0;
 }
 
+static int btt_map_cache_init(struct arena_info *arena)
+{
+	u32 nents = min_t(u32, roundup_pow_of_two(arena->external_nlba),
+			1U << BTT_MAP_CACHE_SHIFT);
+
+	arena->map_cache = kvmalloc_array(nents, sizeof(u64), GFP_KERNEL);
+	if (!arena->map_cache)
+		return -ENOMEM;
+
+	/* an all-ones premap lba tag can never match a valid external lba */
+	memset(arena->map_cache, 0xff, nents * sizeof(u64));
+	arena->map_cache_shift = ilog2(nents);
+
+	return 0;
+}
+
 static struct arena_info *alloc_arena(struct btt *btt, size_t size,
 				size_t start, size_t arena_off)
 {
@@ -808,6 +884,7 @@ static void free_arenas(struct btt *btt)
 		kfree(arena->rtt);
 		kfree(arena->map_locks);
 		kfree(arena->freelist);
+		kvfree(arena->map_cache);
 		debugfs_remove_recursive(arena->debugfs_dir);
 		kfree(arena);
 	}
@@ -905,6 +982,10 @@ static int discover_arenas(struct btt *btt)
 		if (ret)
 			goto out;
 
+		ret = btt_map_cache_init(arena);
+		if (ret)
+			goto out;
+
 		list_add_tail(&arena->list, &btt->arena_list);
 
 		remaining -= arena->size;
@@ -1044,6 +1125,10 @@ static int btt_meta_init(struct btt *btt)
 		ret = btt_maplocks_init(arena);
 		if (ret)
 			goto unlock;
+
+		ret = btt_map_cache_init(arena);
+		if (ret)
+			goto unlock;
 	}
 
 	btt->init_state = INIT_READY;
@@ -1212,8 +1297,8 @@ static int btt_read_pg(struct btt *btt, struct bio_integrity_payload *bip,
 
 		cur_len = min(btt->sector_size, len);
 
-		ret = btt_map_read(arena, premap, &postmap, &t_flag, &e_flag,
-				NVDIMM_IO_ATOMIC);
+		ret = btt_map_read_cached(arena, premap, &postmap, &t_flag,
+				&e_flag, NVDIMM_IO_ATOMIC);
 		if (ret)
 			goto out_lane;
 
@@ -1239,7 +1324,9 @@ static int btt_read_pg(struct btt *btt, struct bio_integrity_payload *bip,
 			arena->rtt[lane] = RTT_VALID | postmap;
 			/*
 			 * Barrier to make sure this write is not reordered
-			 * to do the verification map_read before the RTT store
+			 * to do the verification map_read before the RTT store.
+			 * The verification read must go to the media - a map
+			 * cache hit here would defeat the RTT protocol.
 			 */
 			barrier();
 
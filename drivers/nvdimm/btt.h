@@ -26,6 +26,7 @@
 #define RTT_INVALID 0
 #define BTT_PG_SIZE 4096
 #define BTT_DEFAULT_NFREE ND_MAX_LANES
+#define BTT_MAP_CACHE_SHIFT 15
 #define LOG_SEQ_INIT 1
 
 #define IB_FLAG_ERROR 0x00000001
@@ -186,6 +187,8 @@ struct arena_info {
 	/* Pointers to other in-memory structures for this arena */
 	struct free_entry *freelist;
 	u32 *rtt;
+	u64 *map_cache;
+	u32 map_cache_shift;
 	struct aligned_lock *map_locks;
 	struct nd_btt *nd_btt;
 	struct list_head list;
@@ -367,6 +367,7 @@ unsigned sizeof_namespace_label(struct nvdimm_drvdata *ndd);
 
 struct nd_percpu_lane {
 	int count;
+	unsigned int lane;	/* lane held by this cpu while count > 0 */
 	spinlock_t lock;
 };
 
@@ -421,6 +422,9 @@ struct nd_region {
 	struct badblocks bb;
 	struct nd_interleave_set *nd_set;
 	struct nd_percpu_lane __percpu *lane;
+	/* serialization and coalescing of generic flush hint-write cycles */
+	spinlock_t flush_lock;
+	unsigned long flush_gen;
 	int (*flush)(struct nd_region *nd_region, struct bio *bio);
 	struct nd_mapping mapping[];
 };
@@ -214,16 +214,38 @@ static void pmem_submit_bio(struct bio *bio)
 	do_acct = blk_queue_io_stat(bio->bi_bdev->bd_disk->queue);
 	if (do_acct)
 		start = bio_start_io_acct(bio);
-	bio_for_each_segment(bvec, bio, iter) {
-		if (op_is_write(bio_op(bio)))
-			rc = pmem_do_write(pmem, bvec.bv_page, bvec.bv_offset,
-				iter.bi_sector, bvec.bv_len);
-		else
-			rc = pmem_do_read(pmem, bvec.bv_page, bvec.bv_offset,
-				iter.bi_sector, bvec.bv_len);
-		if (rc) {
-			bio->bi_status = rc;
-			break;
+	if (op_is_write(bio_op(bio)) && bio->bi_iter.bi_size &&
+	    !is_bad_pmem(&pmem->bb, bio->bi_iter.bi_sector,
+			 bio->bi_iter.bi_size)) {
+		/*
+		 * Fast path: a bio targets one contiguous pmem extent, so
+		 * when the whole range is clean the segments can be copied
+		 * back to back without per-segment badblock lookups and
+		 * offset translations.
+		 */
+		void *pmem_addr = pmem->virt_addr +
+			to_offset(pmem, bio->bi_iter.bi_sector);
+
+		bio_for_each_segment(bvec, bio, iter) {
+			flush_dcache_page(bvec.bv_page);
+			write_pmem(pmem_addr, bvec.bv_page, bvec.bv_offset,
+					bvec.bv_len);
+			pmem_addr += bvec.bv_len;
+		}
+	} else {
+		bio_for_each_segment(bvec, bio, iter) {
+			if (op_is_write(bio_op(bio)))
+				rc = pmem_do_write(pmem, bvec.bv_page,
+					bvec.bv_offset, iter.bi_sector,
+					bvec.bv_len);
+			else
+				rc = pmem_do_read(pmem, bvec.bv_page,
+					bvec.bv_offset, iter.bi_sector,
+					bvec.bv_len);
+			if (rc) {
+				bio->bi_status = rc;
+				break;
+			}
 		}
 	}
 	if (do_acct)
@@ -923,10 +923,10 @@ void nd_region_advance_seeds(struct nd_region *nd_region, struct device *dev)
  *
  * A lane correlates to a BLK-data-window and/or a log slot in the BTT.
  * We optimize for the common case where there are 256 lanes, one
- * per-cpu.  For larger systems we need to lock to share lanes.  For now
- * this implementation assumes the cost of maintaining an allocator for
- * free lanes is on the order of the lock hold time, so it implements a
- * static lane = cpu % num_lanes mapping.
+ * per-cpu.  For larger systems we need to lock to share lanes.  A cpu's
+ * home lane (cpu % num_lanes) is tried first, and if it is busy we steal
+ * the first idle lane found by a trylock sweep before falling back to
+ * blocking on the home lane.
  *
  * In the case of a BTT instance on top of a BLK namespace a lane may be
  * acquired recursively.  We lock on the first instance.
@@ -941,12 +941,26 @@ unsigned int nd_region_acquire_lane(struct nd_region *nd_region)
 	cpu = get_cpu();
 	if (nd_region->num_lanes < nr_cpu_ids) {
 		struct nd_percpu_lane *ndl_lock, *ndl_count;
+		unsigned int first;
 
-		lane = cpu % nd_region->num_lanes;
 		ndl_count = per_cpu_ptr(nd_region->lane, cpu);
+		if (ndl_count->count++ > 0)
+			return ndl_count->lane;
+
+		first = lane = cpu % nd_region->num_lanes;
+		do {
+			ndl_lock = per_cpu_ptr(nd_region->lane, lane);
+			if (spin_trylock(&ndl_lock->lock))
+				goto done;
+			if (++lane == nd_region->num_lanes)
+				lane = 0;
+		} while (lane != first);
+
+		/* all lanes busy, wait for our home lane */
 		ndl_lock = per_cpu_ptr(nd_region->lane, lane);
-		if (ndl_count->count++ == 0)
-			spin_lock(&ndl_lock->lock);
+		spin_lock(&ndl_lock->lock);
+ done:
+		ndl_count->lane = lane;
 	} else
 		lane = cpu;
 
@@ -1069,6 +1083,7 @@ static struct nd_region *nd_region_create(struct nvdimm_bus *nvdimm_bus,
 	nd_region->ro = ro;
 	nd_region->numa_node = ndr_desc->numa_node;
 	nd_region->target_node = ndr_desc->target_node;
+	spin_lock_init(&nd_region->flush_lock);
 	ida_init(&nd_region->ns_ida);
 	ida_init(&nd_region->btt_ida);
 	ida_init(&nd_region->pfn_ida);
@@ -1146,6 +1161,7 @@ int nvdimm_flush(struct nd_region *nd_region, struct bio *bio)
 int generic_nvdimm_flush(struct nd_region *nd_region)
 {
 	struct nd_region_data *ndrd = dev_get_drvdata(&nd_region->dev);
+	unsigned long gen;
 	int i, idx;
 
 	/*
@@ -1163,11 +1179,28 @@ int generic_nvdimm_flush(struct nd_region *nd_region)
 	 * wmb() ensures ordering for the NVDIMM flush write.
 	 */
 	pmem_wmb();
+
+	gen = READ_ONCE(nd_region->flush_gen);
+	spin_lock(&nd_region->flush_lock);
+	/*
+	 * Hint-write cycles run under flush_lock and bump flush_gen on
+	 * completion, so a cycle that began after the pmem_wmb() above also
+	 * covers this caller and makes its own cycle redundant. The earliest
+	 * such cycle to complete is flush_gen + 2: cycle flush_gen + 1 may
+	 * already have been in flight when the generation was sampled.
+	 */
+	if (READ_ONCE(nd_region->flush_gen) - gen >= 2)
+		goto out_unlock;
+
 	for (i = 0; i < nd_region->ndr_mappings; i++)
 		if (ndrd_get_flush_wpq(ndrd, i, 0))
 			writeq(1, ndrd_get_flush_wpq(ndrd, i, idx));
 	wmb();
 
+	WRITE_ONCE(nd_region->flush_gen, nd_region->flush_gen + 1);
+out_unlock:
+	spin_unlock(&nd_region->flush_lock);
+
 	return 0;
 }
 EXPORT_SYMBOL_GPL(nvdimm_flush);
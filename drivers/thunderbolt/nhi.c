@@ -350,6 +350,53 @@ unlock:
 }
 EXPORT_SYMBOL_GPL(tb_ring_poll);
 
+/**
+ * tb_ring_poll_batch() - Poll a batch of completed frames from the ring
+ * @ring: Ring to poll
+ * @frames: Array the completed frames are returned in
+ * @nframes: Size of @frames
+ *
+ * Like tb_ring_poll() but dequeues up to @nframes completed frames
+ * under a single acquisition of the ring lock, so sustained transfers
+ * do not pay per-frame locking overhead. Returns the number of frames
+ * placed in @frames.
+ */
+unsigned int tb_ring_poll_batch(struct tb_ring *ring,
+				struct ring_frame **frames,
+				unsigned int nframes)
+{
+	unsigned int polled = 0;
+	unsigned long flags;
+
+	spin_lock_irqsave(&ring->lock, flags);
+	if (!ring->running)
+		goto unlock;
+
+	while (polled < nframes && !ring_empty(ring) &&
+	       ring->descriptors[ring->tail].flags & RING_DESC_COMPLETED) {
+		struct ring_frame *frame;
+
+		frame = list_first_entry(&ring->in_flight, typeof(*frame),
+					 list);
+		list_del_init(&frame->list);
+
+		if (!ring->is_tx) {
+			frame->size = ring->descriptors[ring->tail].length;
+			frame->eof = ring->descriptors[ring->tail].eof;
+			frame->sof = ring->descriptors[ring->tail].sof;
+			frame->flags = ring->descriptors[ring->tail].flags;
+		}
+
+		ring->tail = (ring->tail + 1) % ring->size;
+		frames[polled++] = frame;
+	}
+
+unlock:
+	spin_unlock_irqrestore(&ring->lock, flags);
+	return polled;
+}
+EXPORT_SYMBOL_GPL(tb_ring_poll_batch);
+
 static void __ring_interrupt_mask(struct tb_ring *ring, bool mask)
 {
 	int idx = ring_interrupt_index(ring);
@@ -996,10 +1043,20 @@ static int nhi_poweroff_noirq(struct device *dev)
 	return __nhi_suspend_noirq(dev, wakeup);
 }
 
+/*
+ * Interrupt moderation interval in microseconds. The default matches
+ * what the hardware people recommend; sustained bulk transfers may
+ * benefit from a longer interval at the cost of added latency.
+ */
+static unsigned int int_throttling_rate_us = 128;
+module_param(int_throttling_rate_us, uint, 0444);
+MODULE_PARM_DESC(int_throttling_rate_us,
+		 "interrupt moderation interval in usecs (default: 128)");
+
 static void nhi_enable_int_throttling(struct tb_nhi *nhi)
 {
 	/* Throttling is specified in 256ns increments */
-	u32 throttle = DIV_ROUND_UP(128 * NSEC_PER_USEC, 256);
+	u32 throttle = DIV_ROUND_UP(int_throttling_rate_us * NSEC_PER_USEC, 256);
 	unsigned int i;
 
 	/*
@@ -43,6 +43,7 @@
 #include <linux/io.h>
 #include <linux/delay.h>
 #include <linux/hardirq.h>
+#include <linux/hash.h>
 #include <linux/workqueue.h>
 #include <linux/ratelimit.h>
 #include <linux/moduleparam.h>
@@ -1009,6 +1010,197 @@ void gnttab_page_cache_shrink(struct gnttab_page_cache *cache, unsigned int num)
 }
 EXPORT_SYMBOL_GPL(gnttab_page_cache_shrink);
 
+#define GNTTAB_MAP_CACHE_BUCKETS	256
+#define GNTTAB_MAP_CACHE_REVOKE_BATCH	32
+
+struct gnttab_map_cache_entry {
+	struct hlist_node	node;
+	struct list_head	lru;
+	domid_t			dom;
+	grant_ref_t		ref;
+	grant_handle_t		handle;
+	struct page		*page;
+};
+
+static unsigned int gnttab_map_cache_hash(domid_t dom, grant_ref_t ref)
+{
+	return hash_32((u32)ref ^ ((u32)dom << 16),
+		       ilog2(GNTTAB_MAP_CACHE_BUCKETS));
+}
+
+/* Revoke a batch of cached mappings with a single unmap hypercall. */
+static void gnttab_map_cache_revoke(struct gnttab_map_cache *cache,
+				    struct gnttab_map_cache_entry **entries,
+				    unsigned int count)
+{
+	struct gnttab_unmap_grant_ref unmap_ops[GNTTAB_MAP_CACHE_REVOKE_BATCH];
+	struct page *pages[GNTTAB_MAP_CACHE_REVOKE_BATCH];
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		unsigned long addr = (unsigned long)pfn_to_kaddr(
+					page_to_pfn(entries[i]->page));
+
+		gnttab_set_unmap_op(&unmap_ops[i], addr, GNTMAP_host_map,
+				    entries[i]->handle);
+		pages[i] = entries[i]->page;
+		kfree(entries[i]);
+	}
+
+	/* On failure leak the pages rather than reuse still-mapped frames. */
+	if (WARN_ON(gnttab_unmap_refs(unmap_ops, NULL, pages, count)))
+		return;
+
+	if (cache->page_cache)
+		gnttab_page_cache_put(cache->page_cache, pages, count);
+	else
+		gnttab_free_pages(count, pages);
+}
+
+static void gnttab_map_cache_revoke_work(struct work_struct *work)
+{
+	struct gnttab_map_cache *cache = container_of(work,
+						      struct gnttab_map_cache,
+						      revoke_work.work);
+	struct gnttab_map_cache_entry *batch[GNTTAB_MAP_CACHE_REVOKE_BATCH];
+	unsigned long flags;
+	unsigned int n;
+
+	do {
+		n = 0;
+		spin_lock_irqsave(&cache->lock, flags);
+		while (cache->num_entries > cache->max_entries &&
+		       n < GNTTAB_MAP_CACHE_REVOKE_BATCH) {
+			struct gnttab_map_cache_entry *entry =
+				list_last_entry(&cache->lru,
+						struct gnttab_map_cache_entry,
+						lru);
+
+			list_del(&entry->lru);
+			hlist_del(&entry->node);
+			cache->num_entries--;
+			batch[n++] = entry;
+		}
+		spin_unlock_irqrestore(&cache->lock, flags);
+
+		if (n)
+			gnttab_map_cache_revoke(cache, batch, n);
+	} while (n == GNTTAB_MAP_CACHE_REVOKE_BATCH);
+}
+
+int gnttab_map_cache_init(struct gnttab_map_cache *cache,
+			  struct gnttab_page_cache *page_cache,
+			  unsigned int max_entries)
+{
+	cache->buckets = kcalloc(GNTTAB_MAP_CACHE_BUCKETS,
+				 sizeof(*cache->buckets), GFP_KERNEL);
+	if (!cache->buckets)
+		return -ENOMEM;
+
+	spin_lock_init(&cache->lock);
+	INIT_LIST_HEAD(&cache->lru);
+	cache->num_entries = 0;
+	cache->max_entries = max_entries;
+	cache->page_cache = page_cache;
+	INIT_DELAYED_WORK(&cache->revoke_work, gnttab_map_cache_revoke_work);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(gnttab_map_cache_init);
+
+/*
+ * Look up a live mapping of (dom, ref).  On a hit the mapping is handed
+ * to the caller without any hypercall; the caller owns it until it is
+ * returned via gnttab_map_cache_put().
+ */
+bool gnttab_map_cache_get(struct gnttab_map_cache *cache, domid_t dom,
+			  grant_ref_t ref, struct page **page,
+			  grant_handle_t *handle)
+{
+	struct gnttab_map_cache_entry *entry;
+	unsigned long flags;
+
+	spin_lock_irqsave(&cache->lock, flags);
+
+	hlist_for_each_entry(entry,
+			     &cache->buckets[gnttab_map_cache_hash(dom, ref)],
+			     node) {
+		if (entry->dom != dom || entry->ref != ref)
+			continue;
+
+		hlist_del(&entry->node);
+		list_del(&entry->lru);
+		cache->num_entries--;
+		spin_unlock_irqrestore(&cache->lock, flags);
+
+		*page = entry->page;
+		*handle = entry->handle;
+		kfree(entry);
+		return true;
+	}
+
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+	return false;
+}
+EXPORT_SYMBOL_GPL(gnttab_map_cache_get);
+
+/*
+ * Park a mapping obtained from gnttab_map_refs() (or from a previous
+ * cache hit) instead of unmapping it.  Revocation of surplus mappings
+ * happens from the background worker in bulk hypercalls.
+ */
+void gnttab_map_cache_put(struct gnttab_map_cache *cache, domid_t dom,
+			  grant_ref_t ref, struct page *page,
+			  grant_handle_t handle)
+{
+	struct gnttab_map_cache_entry *entry;
+	unsigned long flags;
+	bool over;
+
+	entry = kmalloc(sizeof(*entry), GFP_ATOMIC);
+	if (!entry) {
+		struct gnttab_unmap_grant_ref unmap_op;
+
+		gnttab_set_unmap_op(&unmap_op,
+				    (unsigned long)pfn_to_kaddr(page_to_pfn(page)),
+				    GNTMAP_host_map, handle);
+		if (WARN_ON(gnttab_unmap_refs(&unmap_op, NULL, &page, 1)))
+			return;
+		if (cache->page_cache)
+			gnttab_page_cache_put(cache->page_cache, &page, 1);
+		else
+			gnttab_free_pages(1, &page);
+		return;
+	}
+
+	entry->dom = dom;
+	entry->ref = ref;
+	entry->handle = handle;
+	entry->page = page;
+
+	spin_lock_irqsave(&cache->lock, flags);
+	hlist_add_head(&entry->node,
+		       &cache->buckets[gnttab_map_cache_hash(dom, ref)]);
+	list_add(&entry->lru, &cache->lru);
+	over = ++cache->num_entries > cache->max_entries;
+	spin_unlock_irqrestore(&cache->lock, flags);
+
+	if (over)
+		schedule_delayed_work(&cache->revoke_work, 0);
+}
+EXPORT_SYMBOL_GPL(gnttab_map_cache_put);
+
+void gnttab_map_cache_destroy(struct gnttab_map_cache *cache)
+{
+	cancel_delayed_work_sync(&cache->revoke_work);
+	cache->max_entries = 0;
+	gnttab_map_cache_revoke_work(&cache->revoke_work.work);
+	kfree(cache->buckets);
+	cache->buckets = NULL;
+}
+EXPORT_SYMBOL_GPL(gnttab_map_cache_destroy);
+
 void gnttab_pages_clear_private(int nr_pages, struct page **pages)
 {
 	int i;
@@ -21,6 +21,7 @@ static struct dentry *afs_lookup(struct inode *dir, struct dentry *dentry,
 				 unsigned int flags);
 static int afs_dir_open(struct inode *inode, struct file *file);
 static int afs_readdir(struct file *file, struct dir_context *ctx);
+static void afs_dir_prefetch_statuses(struct inode *dir, struct key *key);
 static int afs_d_revalidate(struct dentry *dentry, unsigned int flags);
 static int afs_d_delete(const struct dentry *dentry);
 static void afs_d_iput(struct dentry *dentry, struct inode *inode);
@@ -28,6 +29,8 @@ static bool afs_lookup_one_filldir(struct dir_context *ctx, const char *name, in
 				  loff_t fpos, u64 ino, unsigned dtype);
 static bool afs_lookup_filldir(struct dir_context *ctx, const char *name, int nlen,
 			      loff_t fpos, u64 ino, unsigned dtype);
+static bool afs_prefetch_filldir(struct dir_context *ctx, const char *name, int nlen,
+				 loff_t fpos, u64 ino, unsigned dtype);
 static int afs_create(struct mnt_idmap *idmap, struct inode *dir,
 		      struct dentry *dentry, umode_t mode, bool excl);
 static int afs_mkdir(struct mnt_idmap *idmap, struct inode *dir,
@@ -474,7 +477,8 @@ static int afs_dir_iterate_block(struct afs_vnode *dvnode,
 		if (!dir_emit(ctx, dire->u.name, nlen,
 			      ntohl(dire->u.vnode),
 			      (ctx->actor == afs_lookup_filldir ||
-			       ctx->actor == afs_lookup_one_filldir)?
+			       ctx->actor == afs_lookup_one_filldir ||
+			       ctx->actor == afs_prefetch_filldir) ?
 			      ntohl(dire->u.unique) : DT_UNKNOWN)) {
 			_leave(" = 0 [full]");
 			return 0;
@@ -560,6 +564,13 @@ static int afs_readdir(struct file *file, struct dir_context *ctx)
 {
 	afs_dataversion_t dir_version;
 
+	/* Warm up the statuses of the entries before handing out the first
+	 * batch of names so that an "ls -l" needn't fetch them one at a
+	 * time afterwards.
+	 */
+	if (ctx->pos == 0)
+		afs_dir_prefetch_statuses(file_inode(file), afs_file_key(file));
+
 	return afs_dir_iterate(file_inode(file), ctx, afs_file_key(file),
 			       &dir_version);
 }
@@ -775,6 +786,104 @@ static bool afs_server_supports_ibulk(struct afs_vnode *dvnode)
 	return ret;
 }
 
+/*
+ * Collect the FIDs of directory entries for status prefetching.
+ * - afs_dir_iterate_block() passes the FID uniquifier through dtype
+ */
+static bool afs_prefetch_filldir(struct dir_context *ctx, const char *name,
+				 int nlen, loff_t fpos, u64 ino, unsigned dtype)
+{
+	struct afs_lookup_cookie *cookie =
+		container_of(ctx, struct afs_lookup_cookie, ctx);
+
+	if ((nlen == 1 && name[0] == '.') ||
+	    (nlen == 2 && name[0] == '.' && name[1] == '.'))
+		return true;
+
+	cookie->fids[cookie->nr_fids].vnode	= ino;
+	cookie->fids[cookie->nr_fids].unique	= dtype;
+	cookie->nr_fids++;
+	return cookie->nr_fids < ARRAY_SIZE(cookie->fids);
+}
+
+/*
+ * Prefetch the statuses of a slew of directory entries with a single
+ * FS.InlineBulkStatus call and populate their inodes, so that a getdents
+ * followed by a stat of each entry (the "ls -l" pattern) doesn't pay one
+ * FetchStatus round trip per entry.  This is best effort; on any failure
+ * the statuses just get fetched individually as before.
+ */
+static void afs_dir_prefetch_statuses(struct inode *dir, struct key *key)
+{
+	struct afs_lookup_cookie *cookie;
+	struct afs_vnode_param *vp;
+	struct afs_operation *op;
+	struct afs_vnode *dvnode = AFS_FS_I(dir), *vnode;
+	struct inode *ti;
+	afs_dataversion_t data_version = READ_ONCE(dvnode->status.data_version);
+	int ret, i;
+
+	if (!afs_server_supports_ibulk(dvnode))
+		return;
+
+	cookie = kzalloc(sizeof(struct afs_lookup_cookie), GFP_KERNEL);
+	if (!cookie)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(cookie->fids); i++)
+		cookie->fids[i].vid = dvnode->fid.vid;
+	cookie->ctx.actor = afs_prefetch_filldir;
+	cookie->nr_fids = 2; /* slot 0 is saved for the directory and slot 1
+			      * carries its FID, as in lookup */
+	cookie->fids[1] = dvnode->fid;
+
+	ret = afs_dir_iterate(dir, &cookie->ctx, key, &data_version);
+	if (ret < 0 || cookie->nr_fids <= 2)
+		goto out;
+
+	op = afs_alloc_operation(key, dvnode->volume);
+	if (IS_ERR(op))
+		goto out;
+
+	afs_op_set_vnode(op, 0, dvnode);
+	afs_op_set_fid(op, 1, &cookie->fids[1]);
+
+	op->nr_files = cookie->nr_fids;
+	op->more_files = kvcalloc(op->nr_files - 2,
+				  sizeof(struct afs_vnode_param), GFP_KERNEL);
+	if (!op->more_files) {
+		op->error = -ENOMEM;
+		afs_put_operation(op);
+		goto out;
+	}
+
+	for (i = 2; i < op->nr_files; i++) {
+		vp = &op->more_files[i - 2];
+		vp->fid = cookie->fids[i];
+
+		/* Find any inodes that already exist and get their
+		 * callback counters.
+		 */
+		ti = ilookup5_nowait(dir->i_sb, vp->fid.vnode,
+				     afs_ilookup5_test_by_fid, &vp->fid);
+		if (!IS_ERR_OR_NULL(ti)) {
+			vnode = AFS_FS_I(ti);
+			vp->dv_before = vnode->status.data_version;
+			vp->cb_break_before = afs_calc_vnode_cb_break(vnode);
+			vp->vnode = vnode;
+			vp->put_vnode = true;
+			vp->speculative = true; /* vnode not locked */
+		}
+	}
+
+	op->ops = &afs_inline_bulk_status_operation;
+	afs_begin_vnode_operation(op);
+	afs_wait_for_operation(op);
+	afs_put_operation(op);
+out:
+	kfree(cookie);
+}
+
 /*
  * Do a lookup in a directory.  We make use of bulk lookup to query a slew of
  * files in one go and create inodes for them.  The inode of the file we were
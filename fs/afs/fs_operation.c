@@ -180,6 +180,7 @@ void afs_wait_for_operation(struct afs_operation *op)
 
 	while (afs_select_fileserver(op)) {
 		op->cb_s_break = op->server->cb_s_break;
+		atomic_inc(&op->server->nr_inflight);
 		if (test_bit(AFS_SERVER_FL_IS_YFS, &op->server->flags) &&
 		    op->ops->issue_yfs_rpc)
 			op->ops->issue_yfs_rpc(op);
@@ -190,6 +191,7 @@ void afs_wait_for_operation(struct afs_operation *op)
 
 		if (op->call)
 			op->error = afs_wait_for_call_to_complete(op->call, &op->ac);
+		atomic_dec(&op->server->nr_inflight);
 	}
 
 	switch (op->error) {
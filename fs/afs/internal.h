@@ -519,6 +519,7 @@ struct afs_server {
 #define AFS_SERVER_FL_HAS_FS64	19		/* Fileserver supports FS.{Fetch,Store}Data64 */
 	refcount_t		ref;		/* Object refcount */
 	atomic_t		active;		/* Active user count */
+	atomic_t		nr_inflight;	/* Number of calls in progress */
 	u32			addr_version;	/* Address list version */
 	unsigned int		rtt;		/* Server's current RTT in uS */
 	unsigned int		debug_id;	/* Debugging ID for traces */
@@ -344,13 +344,21 @@ pick_server:
 	rtt = U32_MAX;
 	for (i = 0; i < op->server_list->nr_servers; i++) {
 		struct afs_server *s = op->server_list->servers[i].server;
+		u64 est;
 
 		if (!test_bit(i, &op->untried) ||
 		    !test_bit(AFS_SERVER_FL_RESPONDING, &s->flags))
 			continue;
-		if (s->probe.rtt < rtt) {
+
+		/* Penalise servers that already have calls outstanding so
+		 * that a deep queue on the nearest server doesn't starve an
+		 * otherwise usable one.
+		 */
+		est = s->probe.rtt;
+		est += est * atomic_read(&s->nr_inflight) / 2;
+		if (est < rtt) {
 			op->index = i;
-			rtt = s->probe.rtt;
+			rtt = min_t(u64, est, U32_MAX);
 		}
 	}
 
@@ -230,6 +230,7 @@ static struct afs_server *afs_alloc_server(struct afs_cell *cell,
 
 	refcount_set(&server->ref, 1);
 	atomic_set(&server->active, 1);
+	atomic_set(&server->nr_inflight, 0);
 	server->debug_id = atomic_inc_return(&afs_server_debug_id);
 	RCU_INIT_POINTER(server->addresses, alist);
 	server->addr_version = alist->version;
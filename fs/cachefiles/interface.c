@@ -338,6 +338,7 @@ static void cachefiles_clean_up_object(struct cachefiles_object *object,
 
 	cachefiles_unmark_inode_in_use(object, object->file);
 	if (object->file) {
+		cachefiles_trim_prealloc(object, object->file);
 		fput(object->file);
 		object->file = NULL;
 	}
@@ -404,6 +405,7 @@ static bool cachefiles_invalidate_cookie(struct fscache_cookie *cookie)
 	old_file = object->file;
 	object->file = new_file;
 	object->content_info = CACHEFILES_CONTENT_NO_DATA;
+	object->prealloc_end = 0;
 	set_bit(CACHEFILES_OBJECT_USING_TMPFILE, &object->flags);
 	set_bit(FSCACHE_COOKIE_NEEDS_UPDATE, &object->cookie->flags);
 
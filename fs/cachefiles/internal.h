@@ -56,10 +56,12 @@ struct cachefiles_object {
 	int				debug_id;
 	spinlock_t			lock;
 	refcount_t			ref;
+	loff_t				prealloc_end;	/* End of span preallocated for writes */
 	u8				d_name_len;	/* Length of filename */
 	enum cachefiles_content		content_info:8;	/* Info about content presence */
 	unsigned long			flags;
 #define CACHEFILES_OBJECT_USING_TMPFILE	0		/* Have an unlinked tmpfile */
+#define CACHEFILES_OBJECT_NO_PREALLOC	1		/* Backing fs lacks fallocate support */
 #ifdef CONFIG_CACHEFILES_ONDEMAND
 	int				ondemand_id;
 #endif
@@ -241,6 +243,8 @@ extern int __cachefiles_write(struct cachefiles_object *object,
 			      struct iov_iter *iter,
 			      netfs_io_terminated_t term_func,
 			      void *term_func_priv);
+extern void cachefiles_trim_prealloc(struct cachefiles_object *object,
+				     struct file *file);
 
 /*
  * key.c
@@ -274,6 +274,80 @@ static void cachefiles_write_complete(struct kiocb *iocb, long ret)
 	cachefiles_put_kiocb(ki);
 }
 
+/*
+ * Amount of backing space preallocated ahead of cache-fill writes so that
+ * streams of small writes land in a few large extents instead of having the
+ * backing filesystem allocate block by block.
+ */
+#define CACHEFILES_PREALLOC_CHUNK	(2 * 1024 * 1024)
+
+/*
+ * Make sure the span this write lands in is preallocated.  This is best
+ * effort: on failure the write itself will allocate (or report the real
+ * error), and a backing filesystem without fallocate support is only asked
+ * once.
+ */
+static void cachefiles_prealloc_for_write(struct cachefiles_object *object,
+					  struct file *file,
+					  loff_t start, size_t len)
+{
+	loff_t end = start + len, new_end;
+	unsigned int old_nofs;
+	int ret;
+
+	if (test_bit(CACHEFILES_OBJECT_NO_PREALLOC, &object->flags))
+		return;
+
+	spin_lock(&object->lock);
+	if (end <= object->prealloc_end) {
+		spin_unlock(&object->lock);
+		return;
+	}
+	new_end = round_up(end, CACHEFILES_PREALLOC_CHUNK);
+	spin_unlock(&object->lock);
+
+	old_nofs = memalloc_nofs_save();
+	ret = vfs_fallocate(file, FALLOC_FL_KEEP_SIZE, start, new_end - start);
+	memalloc_nofs_restore(old_nofs);
+	if (ret < 0) {
+		if (ret == -EOPNOTSUPP)
+			set_bit(CACHEFILES_OBJECT_NO_PREALLOC, &object->flags);
+		return;
+	}
+
+	spin_lock(&object->lock);
+	if (new_end > object->prealloc_end)
+		object->prealloc_end = new_end;
+	spin_unlock(&object->lock);
+}
+
+/*
+ * Return preallocated space beyond the data we actually stored, so unused
+ * write batching headroom doesn't count against the cache's disk budget.
+ */
+void cachefiles_trim_prealloc(struct cachefiles_object *object,
+			      struct file *file)
+{
+	struct cachefiles_cache *cache = object->volume->cache;
+	loff_t start, end;
+	int ret;
+
+	spin_lock(&object->lock);
+	end = object->prealloc_end;
+	object->prealloc_end = 0;
+	spin_unlock(&object->lock);
+
+	start = round_up(i_size_read(file_inode(file)), 1 << cache->bshift);
+	if (end <= start)
+		return;
+
+	ret = vfs_fallocate(file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			    start, end - start);
+	if (ret < 0 && ret != -EOPNOTSUPP)
+		trace_cachefiles_io_error(object, file_inode(file), ret,
+					  cachefiles_trace_fallocate_error);
+}
+
 /*
  * Initiate a write to the cache.
  */
@@ -298,6 +372,8 @@ int __cachefiles_write(struct cachefiles_object *object,
 	       file, file_inode(file)->i_ino, start_pos, len,
 	       i_size_read(file_inode(file)));
 
+	cachefiles_prealloc_for_write(object, file, start_pos, len);
+
 	ki = kzalloc(sizeof(struct cachefiles_kiocb), GFP_KERNEL);
 	if (!ki) {
 		if (term_func)
@@ -197,6 +197,21 @@ static void ceph_netfs_expand_readahead(struct netfs_io_request *rreq)
 
 	/* Now, round up the length to the next block */
 	rreq->len = roundup(rreq->len, lo->stripe_unit);
+
+	/*
+	 * If the window already spans more than one stripe unit, grow it
+	 * to whole stripe periods.  The subrequests are clamped at object
+	 * boundaries and issued asynchronously, so a window covering every
+	 * object of the stripe fans the reads out over distinct OSDs
+	 * instead of queueing behind whichever one holds the first unit.
+	 */
+	if (lo->stripe_count > 1 && rreq->len > lo->stripe_unit) {
+		u32 period = lo->stripe_unit * lo->stripe_count;
+
+		blockno = div_u64_rem(rreq->start, period, &blockoff);
+		rreq->start = blockno * period;
+		rreq->len = roundup(rreq->len + blockoff, period);
+	}
 }
 
 static bool ceph_netfs_clamp_length(struct netfs_io_subrequest *subreq)
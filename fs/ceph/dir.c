@@ -1101,6 +1101,7 @@ static void ceph_async_unlink_cb(struct ceph_mds_client *mdsc,
 	spin_lock(&fsc->async_unlink_conflict_lock);
 	hash_del_rcu(&di->hnode);
 	spin_unlock(&fsc->async_unlink_conflict_lock);
+	atomic_dec(&fsc->nr_async_unlinks);
 
 	spin_lock(&dentry->d_lock);
 	di->flags &= ~CEPH_DENTRY_ASYNC_UNLINK;
@@ -1233,6 +1234,7 @@ retry:
 		hash_add_rcu(fsc->async_unlink_conflict, &di->hnode,
 			     dentry->d_name.hash);
 		spin_unlock(&fsc->async_unlink_conflict_lock);
+		atomic_inc(&fsc->nr_async_unlinks);
 
 		err = ceph_mdsc_submit_request(mdsc, dir, req);
 		if (!err) {
@@ -1246,6 +1248,7 @@ retry:
 			spin_lock(&fsc->async_unlink_conflict_lock);
 			hash_del_rcu(&di->hnode);
 			spin_unlock(&fsc->async_unlink_conflict_lock);
+			atomic_dec(&fsc->nr_async_unlinks);
 
 			spin_lock(&dentry->d_lock);
 			di->flags &= ~CEPH_DENTRY_ASYNC_UNLINK;
@@ -685,6 +685,15 @@ int ceph_wait_on_conflict_unlink(struct dentry *dentry)
 	u32 hash = dentry->d_name.hash;
 	int err;
 
+	/*
+	 * A conflicting unlink of the same name is always submitted before
+	 * the create starts (the parent's i_rwsem orders them), so if no
+	 * async unlinks are in flight at all there is nothing to scan for.
+	 * This keeps create bursts off the conflict hash entirely.
+	 */
+	if (likely(!atomic_read(&fsc->nr_async_unlinks)))
+		return 0;
+
 	dname.name = dentry->d_name.name;
 	dname.len = dentry->d_name.len;
 
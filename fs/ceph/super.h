@@ -140,6 +140,7 @@ struct ceph_fs_client {
 
 	DECLARE_HASHTABLE(async_unlink_conflict, CEPH_ASYNC_CREATE_CONFLICT_BITS);
 	spinlock_t async_unlink_conflict_lock;
+	atomic_t nr_async_unlinks;	/* entries in async_unlink_conflict */
 
 #ifdef CONFIG_DEBUG_FS
 	struct dentry *debugfs_dentry_lru, *debugfs_caps;
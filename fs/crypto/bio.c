@@ -11,6 +11,7 @@
 #include <linux/module.h>
 #include <linux/bio.h>
 #include <linux/namei.h>
+#include <crypto/skcipher.h>
 #include "fscrypt_private.h"
 
 /**
@@ -116,6 +117,7 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 	const unsigned int blocks_per_page_bits = PAGE_SHIFT - blockbits;
 	const unsigned int blocks_per_page = 1 << blocks_per_page_bits;
 	struct page *pages[16]; /* write up to 16 pages at a time */
+	struct skcipher_request *req;
 	unsigned int nr_pages;
 	unsigned int i;
 	unsigned int offset;
@@ -150,6 +152,13 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 	if (WARN_ON(nr_pages <= 0))
 		return -EINVAL;
 
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_enc_key.tfm,
+				     GFP_NOFS);
+	if (!req) {
+		err = -ENOMEM;
+		goto out_free_pages;
+	}
+
 	/* This always succeeds since __GFP_DIRECT_RECLAIM is set. */
 	bio = bio_alloc(inode->i_sb->s_bdev, nr_pages, REQ_OP_WRITE, GFP_NOFS);
 
@@ -159,9 +168,11 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 		i = 0;
 		offset = 0;
 		do {
-			err = fscrypt_crypt_block(inode, FS_ENCRYPT, lblk,
-						  ZERO_PAGE(0), pages[i],
-						  blocksize, offset, GFP_NOFS);
+			err = fscrypt_crypt_block_with_req(inode, FS_ENCRYPT,
+							   lblk, req,
+							   ZERO_PAGE(0),
+							   pages[i], blocksize,
+							   offset);
 			if (err)
 				goto out;
 			lblk++;
@@ -186,6 +197,8 @@ int fscrypt_zeroout_range(const struct inode *inode, pgoff_t lblk,
 	err = 0;
 out:
 	bio_put(bio);
+	skcipher_request_free(req);
+out_free_pages:
 	for (i = 0; i < nr_pages; i++)
 		fscrypt_free_bounce_page(pages[i]);
 	return err;
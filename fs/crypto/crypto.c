@@ -97,18 +97,22 @@ void fscrypt_generate_iv(union fscrypt_iv *iv, u64 lblk_num,
 	iv->lblk_num = cpu_to_le64(lblk_num);
 }
 
-/* Encrypt or decrypt a single filesystem block of file contents */
-int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
-			u64 lblk_num, struct page *src_page,
-			struct page *dest_page, unsigned int len,
-			unsigned int offs, gfp_t gfp_flags)
+/*
+ * Encrypt or decrypt a single filesystem block of file contents, using a
+ * request the caller has already allocated.  This allows callers that
+ * process many blocks to reuse one request rather than allocating and
+ * freeing one per block.
+ */
+int fscrypt_crypt_block_with_req(const struct inode *inode,
+				 fscrypt_direction_t rw, u64 lblk_num,
+				 struct skcipher_request *req,
+				 struct page *src_page,
+				 struct page *dest_page, unsigned int len,
+				 unsigned int offs)
 {
 	union fscrypt_iv iv;
-	struct skcipher_request *req = NULL;
 	DECLARE_CRYPTO_WAIT(wait);
 	struct scatterlist dst, src;
-	struct fscrypt_info *ci = inode->i_crypt_info;
-	struct crypto_skcipher *tfm = ci->ci_enc_key.tfm;
 	int res = 0;
 
 	if (WARN_ON_ONCE(len <= 0))
@@ -116,11 +120,7 @@ int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 	if (WARN_ON_ONCE(len % FSCRYPT_CONTENTS_ALIGNMENT != 0))
 		return -EINVAL;
 
-	fscrypt_generate_iv(&iv, lblk_num, ci);
-
-	req = skcipher_request_alloc(tfm, gfp_flags);
-	if (!req)
-		return -ENOMEM;
+	fscrypt_generate_iv(&iv, lblk_num, inode->i_crypt_info);
 
 	skcipher_request_set_callback(
 		req, CRYPTO_TFM_REQ_MAY_BACKLOG | CRYPTO_TFM_REQ_MAY_SLEEP,
@@ -135,7 +135,6 @@ int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 		res = crypto_wait_req(crypto_skcipher_decrypt(req), &wait);
 	else
 		res = crypto_wait_req(crypto_skcipher_encrypt(req), &wait);
-	skcipher_request_free(req);
 	if (res) {
 		fscrypt_err(inode, "%scryption failed for block %llu: %d",
 			    (rw == FS_DECRYPT ? "De" : "En"), lblk_num, res);
@@ -144,6 +143,26 @@ int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 	return 0;
 }
 
+/* Encrypt or decrypt a single filesystem block of file contents */
+int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
+			u64 lblk_num, struct page *src_page,
+			struct page *dest_page, unsigned int len,
+			unsigned int offs, gfp_t gfp_flags)
+{
+	struct crypto_skcipher *tfm = inode->i_crypt_info->ci_enc_key.tfm;
+	struct skcipher_request *req;
+	int res;
+
+	req = skcipher_request_alloc(tfm, gfp_flags);
+	if (!req)
+		return -ENOMEM;
+
+	res = fscrypt_crypt_block_with_req(inode, rw, lblk_num, req, src_page,
+					   dest_page, len, offs);
+	skcipher_request_free(req);
+	return res;
+}
+
 /**
  * fscrypt_encrypt_pagecache_blocks() - Encrypt filesystem blocks from a
  *					pagecache page
@@ -181,6 +200,7 @@ struct page *fscrypt_encrypt_pagecache_blocks(struct page *page,
 	struct page *ciphertext_page;
 	u64 lblk_num = ((u64)page->index << (PAGE_SHIFT - blockbits)) +
 		       (offs >> blockbits);
+	struct skcipher_request *req;
 	unsigned int i;
 	int err;
 
@@ -194,15 +214,24 @@ struct page *fscrypt_encrypt_pagecache_blocks(struct page *page,
 	if (!ciphertext_page)
 		return ERR_PTR(-ENOMEM);
 
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_enc_key.tfm,
+				     gfp_flags);
+	if (!req) {
+		fscrypt_free_bounce_page(ciphertext_page);
+		return ERR_PTR(-ENOMEM);
+	}
+
 	for (i = offs; i < offs + len; i += blocksize, lblk_num++) {
-		err = fscrypt_crypt_block(inode, FS_ENCRYPT, lblk_num,
-					  page, ciphertext_page,
-					  blocksize, i, gfp_flags);
+		err = fscrypt_crypt_block_with_req(inode, FS_ENCRYPT, lblk_num,
+						   req, page, ciphertext_page,
+						   blocksize, i);
 		if (err) {
+			skcipher_request_free(req);
 			fscrypt_free_bounce_page(ciphertext_page);
 			return ERR_PTR(err);
 		}
 	}
+	skcipher_request_free(req);
 	SetPagePrivate(ciphertext_page);
 	set_page_private(ciphertext_page, (unsigned long)page);
 	return ciphertext_page;
@@ -259,8 +288,9 @@ int fscrypt_decrypt_pagecache_blocks(struct folio *folio, size_t len,
 	const unsigned int blocksize = 1 << blockbits;
 	u64 lblk_num = ((u64)folio->index << (PAGE_SHIFT - blockbits)) +
 		       (offs >> blockbits);
+	struct skcipher_request *req;
 	size_t i;
-	int err;
+	int err = 0;
 
 	if (WARN_ON_ONCE(!folio_test_locked(folio)))
 		return -EINVAL;
@@ -268,16 +298,22 @@ int fscrypt_decrypt_pagecache_blocks(struct folio *folio, size_t len,
 	if (WARN_ON_ONCE(len <= 0 || !IS_ALIGNED(len | offs, blocksize)))
 		return -EINVAL;
 
+	req = skcipher_request_alloc(inode->i_crypt_info->ci_enc_key.tfm,
+				     GFP_NOFS);
+	if (!req)
+		return -ENOMEM;
+
 	for (i = offs; i < offs + len; i += blocksize, lblk_num++) {
 		struct page *page = folio_page(folio, i >> PAGE_SHIFT);
 
-		err = fscrypt_crypt_block(inode, FS_DECRYPT, lblk_num, page,
-					  page, blocksize, i & ~PAGE_MASK,
-					  GFP_NOFS);
+		err = fscrypt_crypt_block_with_req(inode, FS_DECRYPT, lblk_num,
+						   req, page, page, blocksize,
+						   i & ~PAGE_MASK);
 		if (err)
-			return err;
+			break;
 	}
-	return 0;
+	skcipher_request_free(req);
+	return err;
 }
 EXPORT_SYMBOL(fscrypt_decrypt_pagecache_blocks);
 
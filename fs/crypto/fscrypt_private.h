@@ -16,6 +16,8 @@
 #include <crypto/hash.h>
 #include <linux/blk-crypto.h>
 
+struct skcipher_request;
+
 #define CONST_STRLEN(str)	(sizeof(str) - 1)
 
 #define FSCRYPT_FILE_NONCE_SIZE	16
@@ -265,6 +267,12 @@ typedef enum {
 /* crypto.c */
 extern struct kmem_cache *fscrypt_info_cachep;
 int fscrypt_initialize(unsigned int cop_flags);
+int fscrypt_crypt_block_with_req(const struct inode *inode,
+				 fscrypt_direction_t rw, u64 lblk_num,
+				 struct skcipher_request *req,
+				 struct page *src_page,
+				 struct page *dest_page, unsigned int len,
+				 unsigned int offs);
 int fscrypt_crypt_block(const struct inode *inode, fscrypt_direction_t rw,
 			u64 lblk_num, struct page *src_page,
 			struct page *dest_page, unsigned int len,
@@ -34,6 +34,7 @@
 #include <linux/jhash.h>
 #include <linux/miscdevice.h>
 #include <linux/mutex.h>
+#include <linux/seqlock.h>
 #include <linux/idr.h>
 #include <linux/ratelimit.h>
 #include <linux/uaccess.h>
@@ -105,6 +106,7 @@ struct dlm_rsbtable {
 	struct rb_root		keep;
 	struct rb_root		toss;
 	spinlock_t		lock;
+	seqcount_spinlock_t	keep_seq; /* written around keep updates */
 	uint32_t		flags;
 };
 
@@ -330,6 +332,7 @@ struct dlm_rsb {
 
 	char			*res_lvbptr;
 	char			res_name[DLM_RESNAME_MAXLEN+1];
+	struct rcu_head		res_rcu;
 };
 
 /* dlm_master_lookup() flags */
@@ -91,6 +91,7 @@ static int receive_extralen(struct dlm_message *ms);
 static void do_purge(struct dlm_ls *ls, int nodeid, int pid);
 static void del_timeout(struct dlm_lkb *lkb);
 static void toss_rsb(struct kref *kref);
+static void kill_rsb(struct kref *kref);
 
 /*
  * Lock compatibilty matrix - thanks Steve
@@ -474,6 +475,42 @@ int dlm_search_rsb_tree(struct rb_root *tree, const void *name, int len,
 	return 0;
 }
 
+/*
+ * Lockless variant of dlm_search_rsb_tree() for the fast path in
+ * find_rsb().  The result is only trusted after the caller revalidates
+ * the bucket seqcount, so the walk may race with rotations; read the
+ * child pointers once each and give up if the walk doesn't terminate
+ * within a plausible tree depth.
+ */
+static int dlm_search_rsb_tree_lockless(struct rb_root *tree,
+					const void *name, int len,
+					struct dlm_rsb **r_ret)
+{
+	struct rb_node *node = READ_ONCE(tree->rb_node);
+	struct dlm_rsb *r;
+	int bound = 64;
+	int rc;
+
+	while (node) {
+		if (!bound--)
+			return -EBADR;
+		r = rb_entry(node, struct dlm_rsb, res_hashnode);
+		rc = rsb_cmp(r, name, len);
+		if (rc < 0)
+			node = READ_ONCE(node->rb_left);
+		else if (rc > 0)
+			node = READ_ONCE(node->rb_right);
+		else
+			goto found;
+	}
+	*r_ret = NULL;
+	return -EBADR;
+
+ found:
+	*r_ret = r;
+	return 0;
+}
+
 static int rsb_insert(struct dlm_rsb *rsb, struct rb_root *tree)
 {
 	struct rb_node **newn = &tree->rb_node;
@@ -651,8 +688,10 @@ static int find_rsb_dir(struct dlm_ls *ls, const void *name, int len,
 		r->res_first_lkid = 0;
 	}
 
+	write_seqcount_begin(&ls->ls_rsbtbl[b].keep_seq);
 	rb_erase(&r->res_hashnode, &ls->ls_rsbtbl[b].toss);
 	error = rsb_insert(r, &ls->ls_rsbtbl[b].keep);
+	write_seqcount_end(&ls->ls_rsbtbl[b].keep_seq);
 	goto out_unlock;
 
 
@@ -713,7 +752,9 @@ static int find_rsb_dir(struct dlm_ls *ls, const void *name, int len,
 	}
 
  out_add:
+	write_seqcount_begin(&ls->ls_rsbtbl[b].keep_seq);
 	error = rsb_insert(r, &ls->ls_rsbtbl[b].keep);
+	write_seqcount_end(&ls->ls_rsbtbl[b].keep_seq);
  out_unlock:
 	spin_unlock(&ls->ls_rsbtbl[b].lock);
  out:
@@ -786,8 +827,10 @@ static int find_rsb_nodir(struct dlm_ls *ls, const void *name, int len,
 		r->res_nodeid = 0;
 	}
 
+	write_seqcount_begin(&ls->ls_rsbtbl[b].keep_seq);
 	rb_erase(&r->res_hashnode, &ls->ls_rsbtbl[b].toss);
 	error = rsb_insert(r, &ls->ls_rsbtbl[b].keep);
+	write_seqcount_end(&ls->ls_rsbtbl[b].keep_seq);
 	goto out_unlock;
 
 
@@ -811,7 +854,9 @@ static int find_rsb_nodir(struct dlm_ls *ls, const void *name, int len,
 	r->res_nodeid = (dir_nodeid == our_nodeid) ? 0 : dir_nodeid;
 	kref_init(&r->res_ref);
 
+	write_seqcount_begin(&ls->ls_rsbtbl[b].keep_seq);
 	error = rsb_insert(r, &ls->ls_rsbtbl[b].keep);
+	write_seqcount_end(&ls->ls_rsbtbl[b].keep_seq);
  out_unlock:
 	spin_unlock(&ls->ls_rsbtbl[b].lock);
  out:
@@ -819,6 +864,60 @@ static int find_rsb_nodir(struct dlm_ls *ls, const void *name, int len,
 	return error;
 }
 
+/*
+ * An rsb found active in the keep tree is simply referenced and returned,
+ * for local and remote requests alike.  Do that search without the bucket
+ * lock: walk the tree under the bucket seqcount, take a reference, and
+ * revalidate.  Repeat requests on hot resources then neither serialize
+ * on the bucket lock nor involve the resource directory, since the rsb
+ * caches the master.  Any race falls back to the locked slow path.
+ */
+static int find_rsb_keep_fast(struct dlm_ls *ls, const void *name, int len,
+			      uint32_t b, struct dlm_rsb **r_ret)
+{
+	struct dlm_rsb *r, *tmp;
+	unsigned int seq;
+	int error;
+
+	rcu_read_lock();
+	seq = read_seqcount_begin(&ls->ls_rsbtbl[b].keep_seq);
+	error = dlm_search_rsb_tree_lockless(&ls->ls_rsbtbl[b].keep, name,
+					     len, &r);
+	if (error || !kref_get_unless_zero(&r->res_ref)) {
+		rcu_read_unlock();
+		return -EBADR;
+	}
+	rcu_read_unlock();
+
+	if (!read_seqcount_retry(&ls->ls_rsbtbl[b].keep_seq, seq)) {
+		*r_ret = r;
+		return 0;
+	}
+
+	/*
+	 * The keep tree changed during the walk; check under the lock
+	 * whether r is still active.  If it was tossed meanwhile we hold
+	 * an unaccounted reference on it, which must not go through
+	 * toss_rsb() again - drop it the way the shrink path does.
+	 */
+	spin_lock(&ls->ls_rsbtbl[b].lock);
+	error = dlm_search_rsb_tree(&ls->ls_rsbtbl[b].keep, name, len, &tmp);
+	if (!error && tmp == r) {
+		spin_unlock(&ls->ls_rsbtbl[b].lock);
+		*r_ret = r;
+		return 0;
+	}
+
+	if (kref_put(&r->res_ref, kill_rsb)) {
+		rb_erase(&r->res_hashnode, &ls->ls_rsbtbl[b].toss);
+		spin_unlock(&ls->ls_rsbtbl[b].lock);
+		dlm_free_rsb(r);
+	} else {
+		spin_unlock(&ls->ls_rsbtbl[b].lock);
+	}
+	return -EBADR;
+}
+
 static int find_rsb(struct dlm_ls *ls, const void *name, int len,
 		    int from_nodeid, unsigned int flags,
 		    struct dlm_rsb **r_ret)
@@ -832,6 +931,9 @@ static int find_rsb(struct dlm_ls *ls, const void *name, int len,
 	hash = jhash(name, len, 0);
 	b = hash & (ls->ls_rsbtbl_size - 1);
 
+	if (!find_rsb_keep_fast(ls, name, len, b, r_ret))
+		return 0;
+
 	dir_nodeid = dlm_hash2nodeid(ls, hash);
 
 	if (dlm_no_directory(ls))
@@ -1148,8 +1250,10 @@ static void toss_rsb(struct kref *kref)
 
 	DLM_ASSERT(list_empty(&r->res_root_list), dlm_print_rsb(r););
 	kref_init(&r->res_ref);
+	write_seqcount_begin(&ls->ls_rsbtbl[r->res_bucket].keep_seq);
 	rb_erase(&r->res_hashnode, &ls->ls_rsbtbl[r->res_bucket].keep);
 	rsb_insert(r, &ls->ls_rsbtbl[r->res_bucket].toss);
+	write_seqcount_end(&ls->ls_rsbtbl[r->res_bucket].keep_seq);
 	r->res_toss_time = jiffies;
 	ls->ls_rsbtbl[r->res_bucket].flags |= DLM_RTF_SHRINK;
 	if (r->res_lvbptr) {
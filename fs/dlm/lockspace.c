@@ -521,6 +521,8 @@ static int new_lockspace(const char *name, const char *cluster,
 		ls->ls_rsbtbl[i].keep.rb_node = NULL;
 		ls->ls_rsbtbl[i].toss.rb_node = NULL;
 		spin_lock_init(&ls->ls_rsbtbl[i].lock);
+		seqcount_spinlock_init(&ls->ls_rsbtbl[i].keep_seq,
+				       &ls->ls_rsbtbl[i].lock);
 	}
 
 	for (i = 0; i < DLM_REMOVE_NAMES_MAX; i++) {
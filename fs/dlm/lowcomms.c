@@ -1394,7 +1394,7 @@ int dlm_lowcomms_resend_msg(struct dlm_msg *msg)
 /* Send a message */
 static int send_to_sock(struct connection *con)
 {
-	const int msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+	int msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
 	struct writequeue_entry *e;
 	int len, offset, ret;
 
@@ -1409,6 +1409,19 @@ static int send_to_sock(struct connection *con)
 	len = e->len;
 	offset = e->offset;
 	WARN_ON_ONCE(len == 0 && e->users == 0);
+
+	/* if another fully committed entry follows we will send it right
+	 * after this one, tell the transport so it can coalesce both into
+	 * one larger frame instead of flushing each entry as its own
+	 * segment. Entries still having users are being filled and may
+	 * not be ready for a while, don't delay for those.
+	 */
+	if (!list_is_last(&e->list, &con->writequeue)) {
+		struct writequeue_entry *next = list_next_entry(e, list);
+
+		if (!next->users && next->len)
+			msg_flags |= MSG_MORE;
+	}
 	spin_unlock_bh(&con->writequeue_lock);
 
 	ret = kernel_sendpage(con->sock, e->page, offset, len,
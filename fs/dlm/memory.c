@@ -72,6 +72,7 @@ out:
 
 void dlm_memory_exit(void)
 {
+	rcu_barrier();
 	kmem_cache_destroy(writequeue_cache);
 	kmem_cache_destroy(mhandle_cache);
 	kmem_cache_destroy(msg_cache);
@@ -101,11 +102,19 @@ struct dlm_rsb *dlm_allocate_rsb(struct dlm_ls *ls)
 	return r;
 }
 
+static void free_rsb_rcu(struct rcu_head *head)
+{
+	struct dlm_rsb *r = container_of(head, struct dlm_rsb, res_rcu);
+
+	kmem_cache_free(rsb_cache, r);
+}
+
 void dlm_free_rsb(struct dlm_rsb *r)
 {
 	if (r->res_lvbptr)
 		dlm_free_lvb(r->res_lvbptr);
-	kmem_cache_free(rsb_cache, r);
+	/* lockless rsb lookups may still be walking to this rsb */
+	call_rcu(&r->res_rcu, free_rsb_rcu);
 }
 
 struct dlm_lkb *dlm_allocate_lkb(struct dlm_ls *ls)
@@ -260,25 +260,50 @@ int virt_to_scatterlist(const void *addr, int size, struct scatterlist *sg,
 	return i;
 }
 
+/*
+ * lower_offset_for_page
+ *
+ * Convert an eCryptfs page index into a lower byte offset
+ */
+static loff_t lower_offset_for_page(struct ecryptfs_crypt_stat *crypt_stat,
+				    struct page *page)
+{
+	return ecryptfs_lower_header_size(crypt_stat) +
+	       ((loff_t)page->index << PAGE_SHIFT);
+}
+
 /**
- * crypt_scatterlist
- * @crypt_stat: Pointer to the crypt_stat struct to initialize.
- * @dst_sg: Destination of the data after performing the crypto operation
- * @src_sg: Data to be encrypted or decrypted
- * @size: Length of data
- * @iv: IV to use
+ * crypt_page
+ * @crypt_stat: crypt_stat containing cryptographic context for the
+ *              encryption operation
+ * @dst_page: The page to write the result into
+ * @src_page: The page to read from
  * @op: ENCRYPT or DECRYPT to indicate the desired operation
  *
- * Returns the number of bytes encrypted or decrypted; negative value on error
+ * Encrypts or decrypts one page of data, extent by extent.  The IV
+ * series for the page is derived up front, the key is set and the
+ * cipher request allocated once, and the request (along with its
+ * completion) is then reused for every extent.  Each extent carries
+ * its own IV, so a multi-extent page cannot be handed to the cipher
+ * as a single scatterlist; with the default 4K extent size the extent
+ * loop runs exactly once per page.
+ *
+ * Return zero on success; non-zero otherwise
  */
-static int crypt_scatterlist(struct ecryptfs_crypt_stat *crypt_stat,
-			     struct scatterlist *dst_sg,
-			     struct scatterlist *src_sg, int size,
-			     unsigned char *iv, int op)
+static int crypt_page(struct ecryptfs_crypt_stat *crypt_stat,
+		      struct page *dst_page,
+		      struct page *src_page, int op)
 {
+	pgoff_t page_index = op == ENCRYPT ? src_page->index : dst_page->index;
+	size_t extent_size = crypt_stat->extent_size;
+	unsigned long num_extents = PAGE_SIZE / extent_size;
+	loff_t extent_base = ((loff_t)page_index) * num_extents;
+	char (*extent_ivs)[ECRYPTFS_MAX_IV_BYTES];
 	struct skcipher_request *req = NULL;
 	DECLARE_CRYPTO_WAIT(ecr);
-	int rc = 0;
+	struct scatterlist src_sg, dst_sg;
+	unsigned long extent_offset;
+	int rc;
 
 	if (unlikely(ecryptfs_verbosity > 0)) {
 		ecryptfs_printk(KERN_DEBUG, "Key size [%zd]; key:\n",
@@ -287,6 +312,22 @@ static int crypt_scatterlist(struct ecryptfs_crypt_stat *crypt_stat,
 				  crypt_stat->key_size);
 	}
 
+	extent_ivs = kmalloc_array(num_extents, ECRYPTFS_MAX_IV_BYTES,
+				   GFP_NOFS);
+	if (!extent_ivs)
+		return -ENOMEM;
+	for (extent_offset = 0; extent_offset < num_extents; extent_offset++) {
+		rc = ecryptfs_derive_iv(extent_ivs[extent_offset], crypt_stat,
+					(extent_base + extent_offset));
+		if (rc) {
+			ecryptfs_printk(KERN_ERR, "Error attempting to derive "
+				"IV for extent [0x%.16llx]; rc = [%d]\n",
+				(unsigned long long)(extent_base
+						     + extent_offset), rc);
+			goto out;
+		}
+	}
+
 	mutex_lock(&crypt_stat->cs_tfm_mutex);
 	req = skcipher_request_alloc(crypt_stat->tfm, GFP_NOFS);
 	if (!req) {
@@ -313,80 +354,33 @@ static int crypt_scatterlist(struct ecryptfs_crypt_stat *crypt_stat,
 		crypt_stat->flags |= ECRYPTFS_KEY_SET;
 	}
 	mutex_unlock(&crypt_stat->cs_tfm_mutex);
-	skcipher_request_set_crypt(req, src_sg, dst_sg, size, iv);
-	rc = op == ENCRYPT ? crypto_skcipher_encrypt(req) :
-			     crypto_skcipher_decrypt(req);
-	rc = crypto_wait_req(rc, &ecr);
-out:
-	skcipher_request_free(req);
-	return rc;
-}
 
-/*
- * lower_offset_for_page
- *
- * Convert an eCryptfs page index into a lower byte offset
- */
-static loff_t lower_offset_for_page(struct ecryptfs_crypt_stat *crypt_stat,
-				    struct page *page)
-{
-	return ecryptfs_lower_header_size(crypt_stat) +
-	       ((loff_t)page->index << PAGE_SHIFT);
-}
-
-/**
- * crypt_extent
- * @crypt_stat: crypt_stat containing cryptographic context for the
- *              encryption operation
- * @dst_page: The page to write the result into
- * @src_page: The page to read from
- * @extent_offset: Page extent offset for use in generating IV
- * @op: ENCRYPT or DECRYPT to indicate the desired operation
- *
- * Encrypts or decrypts one extent of data.
- *
- * Return zero on success; non-zero otherwise
- */
-static int crypt_extent(struct ecryptfs_crypt_stat *crypt_stat,
-			struct page *dst_page,
-			struct page *src_page,
-			unsigned long extent_offset, int op)
-{
-	pgoff_t page_index = op == ENCRYPT ? src_page->index : dst_page->index;
-	loff_t extent_base;
-	char extent_iv[ECRYPTFS_MAX_IV_BYTES];
-	struct scatterlist src_sg, dst_sg;
-	size_t extent_size = crypt_stat->extent_size;
-	int rc;
-
-	extent_base = (((loff_t)page_index) * (PAGE_SIZE / extent_size));
-	rc = ecryptfs_derive_iv(extent_iv, crypt_stat,
-				(extent_base + extent_offset));
-	if (rc) {
-		ecryptfs_printk(KERN_ERR, "Error attempting to derive IV for "
-			"extent [0x%.16llx]; rc = [%d]\n",
-			(unsigned long long)(extent_base + extent_offset), rc);
-		goto out;
-	}
-
-	sg_init_table(&src_sg, 1);
-	sg_init_table(&dst_sg, 1);
-
-	sg_set_page(&src_sg, src_page, extent_size,
-		    extent_offset * extent_size);
-	sg_set_page(&dst_sg, dst_page, extent_size,
-		    extent_offset * extent_size);
-
-	rc = crypt_scatterlist(crypt_stat, &dst_sg, &src_sg, extent_size,
-			       extent_iv, op);
-	if (rc < 0) {
-		printk(KERN_ERR "%s: Error attempting to crypt page with "
-		       "page_index = [%ld], extent_offset = [%ld]; "
-		       "rc = [%d]\n", __func__, page_index, extent_offset, rc);
-		goto out;
+	for (extent_offset = 0; extent_offset < num_extents; extent_offset++) {
+		sg_init_table(&src_sg, 1);
+		sg_init_table(&dst_sg, 1);
+
+		sg_set_page(&src_sg, src_page, extent_size,
+			    extent_offset * extent_size);
+		sg_set_page(&dst_sg, dst_page, extent_size,
+			    extent_offset * extent_size);
+
+		skcipher_request_set_crypt(req, &src_sg, &dst_sg, extent_size,
+					   extent_ivs[extent_offset]);
+		rc = op == ENCRYPT ? crypto_skcipher_encrypt(req) :
+				     crypto_skcipher_decrypt(req);
+		rc = crypto_wait_req(rc, &ecr);
+		if (rc < 0) {
+			printk(KERN_ERR "%s: Error attempting to crypt page "
+			       "with page_index = [%ld], extent_offset = "
+			       "[%ld]; rc = [%d]\n", __func__, page_index,
+			       extent_offset, rc);
+			goto out;
+		}
 	}
 	rc = 0;
 out:
+	skcipher_request_free(req);
+	kfree(extent_ivs);
 	return rc;
 }
 
@@ -412,7 +406,6 @@ int ecryptfs_encrypt_page(struct page *page)
 	struct ecryptfs_crypt_stat *crypt_stat;
 	char *enc_extent_virt;
 	struct page *enc_extent_page = NULL;
-	loff_t extent_offset;
 	loff_t lower_offset;
 	int rc = 0;
 
@@ -428,16 +421,11 @@ int ecryptfs_encrypt_page(struct page *page)
 		goto out;
 	}
 
-	for (extent_offset = 0;
-	     extent_offset < (PAGE_SIZE / crypt_stat->extent_size);
-	     extent_offset++) {
-		rc = crypt_extent(crypt_stat, enc_extent_page, page,
-				  extent_offset, ENCRYPT);
-		if (rc) {
-			printk(KERN_ERR "%s: Error encrypting extent; "
-			       "rc = [%d]\n", __func__, rc);
-			goto out;
-		}
+	rc = crypt_page(crypt_stat, enc_extent_page, page, ENCRYPT);
+	if (rc) {
+		printk(KERN_ERR "%s: Error encrypting page; rc = [%d]\n",
+		       __func__, rc);
+		goto out;
 	}
 
 	lower_offset = lower_offset_for_page(crypt_stat, page);
@@ -480,7 +468,6 @@ int ecryptfs_decrypt_page(struct page *page)
 	struct inode *ecryptfs_inode;
 	struct ecryptfs_crypt_stat *crypt_stat;
 	char *page_virt;
-	unsigned long extent_offset;
 	loff_t lower_offset;
 	int rc = 0;
 
@@ -501,16 +488,11 @@ int ecryptfs_decrypt_page(struct page *page)
 		goto out;
 	}
 
-	for (extent_offset = 0;
-	     extent_offset < (PAGE_SIZE / crypt_stat->extent_size);
-	     extent_offset++) {
-		rc = crypt_extent(crypt_stat, page, page,
-				  extent_offset, DECRYPT);
-		if (rc) {
-			printk(KERN_ERR "%s: Error decrypting extent; "
-			       "rc = [%d]\n", __func__, rc);
-			goto out;
-		}
+	rc = crypt_page(crypt_stat, page, page, DECRYPT);
+	if (rc) {
+		printk(KERN_ERR "%s: Error decrypting page; rc = [%d]\n",
+		       __func__, rc);
+		goto out;
 	}
 out:
 	return rc;
@@ -184,6 +184,54 @@ static int erofs_fscache_meta_read_folio(struct file *data, struct folio *folio)
 	return ret;
 }
 
+/*
+ * Unlike data reads, metadata reads were issued folio by folio, so every
+ * cache miss turned into a single-page on-demand request to the daemon.
+ * Batch a whole readahead window into one backend request instead; the
+ * metadata mapping is a direct image of the blob, so the backend offset
+ * equals the readahead position.
+ */
+static void erofs_fscache_meta_readahead(struct readahead_control *rac)
+{
+	struct erofs_fscache *ctx = rac->mapping->host->i_private;
+	struct erofs_fscache_request *req;
+	int ret;
+
+	if (!readahead_count(rac))
+		return;
+
+	req = erofs_fscache_req_alloc(rac->mapping,
+			readahead_pos(rac), readahead_length(rac));
+	if (IS_ERR(req))
+		return;
+
+	/* The request completion will drop refs on the folios. */
+	while (readahead_folio(rac))
+		;
+
+	ret = erofs_fscache_read_folios_async(ctx->cookie, req,
+			req->start, req->len);
+	if (ret)
+		req->error = ret;
+	erofs_fscache_req_put(req);
+}
+
+/* metadata readahead window issued once at mount to warm the blob up */
+#define EROFS_FSCACHE_META_PREFETCH_PAGES	(SZ_2M / PAGE_SIZE)
+
+void erofs_fscache_meta_prefetch(struct super_block *sb)
+{
+	struct erofs_fscache *ctx = EROFS_SB(sb)->s_fscache;
+	DEFINE_READAHEAD(ractl, NULL, NULL, ctx->inode->i_mapping, 0);
+
+	/*
+	 * The compressed indexes and inode metadata sit at the front of the
+	 * primary blob; pulling them in with one large request at mount time
+	 * avoids a flood of small on-demand requests during image warmup.
+	 */
+	page_cache_ra_unbounded(&ractl, EROFS_FSCACHE_META_PREFETCH_PAGES, 0);
+}
+
 static int erofs_fscache_data_read_slice(struct erofs_fscache_request *primary)
 {
 	struct address_space *mapping = primary->mapping;
@@ -310,6 +358,7 @@ static void erofs_fscache_readahead(struct readahead_control *rac)
 
 static const struct address_space_operations erofs_fscache_meta_aops = {
 	.read_folio = erofs_fscache_meta_read_folio,
+	.readahead = erofs_fscache_meta_readahead,
 };
 
 const struct address_space_operations erofs_fscache_access_aops = {
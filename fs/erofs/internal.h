@@ -132,6 +132,11 @@ struct erofs_sb_info {
 	/* pseudo inode to manage cached pages */
 	struct inode *managed_cache;
 
+	/* LRU of recently decompressed pcluster outputs */
+	struct mutex dcache_mutex;
+	struct list_head dcache_lru;
+	unsigned long dcache_bytes;
+
 	struct erofs_sb_lz4_info lz4;
 	struct inode *packed_inode;
 #endif	/* CONFIG_EROFS_FS_ZIP */
@@ -144,6 +149,8 @@ struct erofs_sb_info {
 	u32 meta_blkaddr;
 #ifdef CONFIG_EROFS_FS_XATTR
 	u32 xattr_blkaddr;
+	/* lazily-built fingerprints of shared xattrs, keyed by xattr id */
+	struct xarray shared_xattr_fps;
 #endif
 	u16 device_id_mask;	/* valid bits of device id to be used */
 
@@ -518,6 +525,7 @@ void z_erofs_exit_zip_subsystem(void);
 int erofs_try_to_free_all_cached_pages(struct erofs_sb_info *sbi,
 				       struct erofs_workgroup *egrp);
 int erofs_try_to_free_cached_page(struct page *page);
+void z_erofs_dcache_drop(struct erofs_sb_info *sbi);
 int z_erofs_load_lz4_config(struct super_block *sb,
 			    struct erofs_super_block *dsb,
 			    struct z_erofs_lz4_cfgs *lz4, int len);
@@ -567,6 +575,7 @@ static inline int z_erofs_load_lzma_config(struct super_block *sb,
 #ifdef CONFIG_EROFS_FS_ONDEMAND
 int erofs_fscache_register_fs(struct super_block *sb);
 void erofs_fscache_unregister_fs(struct super_block *sb);
+void erofs_fscache_meta_prefetch(struct super_block *sb);
 
 struct erofs_fscache *erofs_fscache_register_cookie(struct super_block *sb,
 					char *name, unsigned int flags);
@@ -577,6 +586,7 @@ static inline int erofs_fscache_register_fs(struct super_block *sb)
 	return -EOPNOTSUPP;
 }
 static inline void erofs_fscache_unregister_fs(struct super_block *sb) {}
+static inline void erofs_fscache_meta_prefetch(struct super_block *sb) {}
 
 static inline
 struct erofs_fscache *erofs_fscache_register_cookie(struct super_block *sb,
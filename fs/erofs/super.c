@@ -725,6 +725,7 @@ static int erofs_fc_fill_super(struct super_block *sb, struct fs_context *fc)
 		return -ENOMEM;
 
 	sb->s_fs_info = sbi;
+	erofs_xattr_fp_init(sbi);
 	sbi->opt = ctx->opt;
 	sbi->devs = ctx->devs;
 	ctx->devs = NULL;
@@ -744,6 +745,8 @@ static int erofs_fc_fill_super(struct super_block *sb, struct fs_context *fc)
 		err = super_setup_bdi(sb);
 		if (err)
 			return err;
+
+		erofs_fscache_meta_prefetch(sb);
 	} else {
 		if (!sb_set_blocksize(sb, EROFS_BLKSIZ)) {
 			erofs_err(sb, "failed to set erofs blksize");
@@ -779,6 +782,8 @@ static int erofs_fc_fill_super(struct super_block *sb, struct fs_context *fc)
 
 #ifdef CONFIG_EROFS_FS_ZIP
 	xa_init(&sbi->managed_pslots);
+	mutex_init(&sbi->dcache_mutex);
+	INIT_LIST_HEAD(&sbi->dcache_lru);
 #endif
 
 	/* get the root inode */
@@ -944,6 +949,7 @@ static void erofs_kill_sb(struct super_block *sb)
 	if (!sbi)
 		return;
 
+	erofs_xattr_fp_cleanup(sbi);
 	erofs_free_dev_context(sbi->devs);
 	fs_put_dax(sbi->dax_dev, NULL);
 	erofs_fscache_unregister_fs(sb);
@@ -963,11 +969,13 @@ static void erofs_put_super(struct super_block *sb)
 	erofs_unregister_sysfs(sb);
 	erofs_shrinker_unregister(sb);
 #ifdef CONFIG_EROFS_FS_ZIP
+	z_erofs_dcache_drop(sbi);
 	iput(sbi->managed_cache);
 	sbi->managed_cache = NULL;
 	iput(sbi->packed_inode);
 	sbi->packed_inode = NULL;
 #endif
+	erofs_xattr_fp_cleanup(sbi);
 	erofs_free_dev_context(sbi->devs);
 	sbi->devs = NULL;
 	erofs_fscache_unregister_fs(sb);
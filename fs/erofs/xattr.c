@@ -5,6 +5,7 @@
  * Copyright (C) 2021-2022, Alibaba Cloud
  */
 #include <linux/security.h>
+#include <linux/crc32c.h>
 #include "xattr.h"
 
 struct xattr_iter {
@@ -348,19 +349,134 @@ static int inline_getxattr(struct inode *inode, struct getxattr_iter *it)
 	return ret ? ret : it->buffer_size;
 }
 
+/*
+ * Shared xattrs are immutable, so their name index, name length and a
+ * crc32c of the name can be recorded once per superblock and reused to
+ * reject non-matching entries without touching the metadata blocks again.
+ * Security stacks issue several getxattr calls per open, mostly for names
+ * that are absent, and previously each of them re-walked every shared
+ * xattr block.  A crc match still runs the exact on-disk comparison.
+ */
+struct erofs_shared_xattr_fp {
+	u8 index;
+	u8 name_len;
+	u32 name_crc;
+};
+
+struct xattr_fp_iter {
+	struct xattr_iter it;
+	struct erofs_shared_xattr_fp fp;
+};
+
+static int xattr_fp_entry(struct xattr_iter *_it,
+			  struct erofs_xattr_entry *entry)
+{
+	struct xattr_fp_iter *it = container_of(_it, struct xattr_fp_iter, it);
+
+	it->fp.index = entry->e_name_index;
+	it->fp.name_len = entry->e_name_len;
+	it->fp.name_crc = ~0;
+	return 0;
+}
+
+static int xattr_fp_name(struct xattr_iter *_it, unsigned int processed,
+			 char *buf, unsigned int len)
+{
+	struct xattr_fp_iter *it = container_of(_it, struct xattr_fp_iter, it);
+
+	it->fp.name_crc = crc32c(it->fp.name_crc, buf, len);
+	return 0;
+}
+
+static int xattr_fp_skipvalue(struct xattr_iter *_it, unsigned int value_sz)
+{
+	return 1;	/* the name is all we need, skip the value */
+}
+
+static const struct xattr_iter_handlers fp_xattr_handlers = {
+	.entry = xattr_fp_entry,
+	.name = xattr_fp_name,
+	.alloc_buffer = xattr_fp_skipvalue,
+};
+
+static struct erofs_shared_xattr_fp *
+erofs_xattr_fp_lookup(struct super_block *sb, unsigned int xattr_id)
+{
+	struct erofs_sb_info *const sbi = EROFS_SB(sb);
+	struct erofs_shared_xattr_fp *fp, *old;
+	struct xattr_fp_iter it;
+	int ret;
+
+	fp = xa_load(&sbi->shared_xattr_fps, xattr_id);
+	if (fp)
+		return fp;
+
+	it.it.sb = sb;
+	it.it.buf = __EROFS_BUF_INITIALIZER;
+	it.it.blkaddr = xattrblock_addr(sbi, xattr_id);
+	it.it.ofs = xattrblock_offset(sbi, xattr_id);
+	it.it.kaddr = erofs_read_metabuf(&it.it.buf, sb, it.it.blkaddr,
+					 EROFS_KMAP);
+	if (IS_ERR(it.it.kaddr))
+		return ERR_CAST(it.it.kaddr);
+
+	ret = xattr_foreach(&it.it, &fp_xattr_handlers, NULL);
+	erofs_put_metabuf(&it.it.buf);
+	if (ret)
+		return ERR_PTR(ret);
+
+	fp = kmalloc(sizeof(*fp), GFP_KERNEL);
+	if (!fp)
+		return ERR_PTR(-ENOMEM);
+	*fp = it.fp;
+
+	old = xa_cmpxchg(&sbi->shared_xattr_fps, xattr_id, NULL, fp,
+			 GFP_KERNEL);
+	if (old) {
+		kfree(fp);
+		if (xa_is_err(old))
+			return ERR_PTR(xa_err(old));
+		fp = old;
+	}
+	return fp;
+}
+
+void erofs_xattr_fp_init(struct erofs_sb_info *sbi)
+{
+	xa_init(&sbi->shared_xattr_fps);
+}
+
+void erofs_xattr_fp_cleanup(struct erofs_sb_info *sbi)
+{
+	struct erofs_shared_xattr_fp *fp;
+	unsigned long xattr_id;
+
+	xa_for_each(&sbi->shared_xattr_fps, xattr_id, fp)
+		kfree(fp);
+	xa_destroy(&sbi->shared_xattr_fps);
+}
+
 static int shared_getxattr(struct inode *inode, struct getxattr_iter *it)
 {
 	struct erofs_inode *const vi = EROFS_I(inode);
 	struct super_block *const sb = inode->i_sb;
 	struct erofs_sb_info *const sbi = EROFS_SB(sb);
+	u32 name_crc = crc32c(~0, it->name.name, it->name.len);
 	unsigned int i;
 	int ret = -ENOATTR;
 
 	for (i = 0; i < vi->xattr_shared_count; ++i) {
-		erofs_blk_t blkaddr =
-			xattrblock_addr(sbi, vi->xattr_shared_xattrs[i]);
+		unsigned int xattr_id = vi->xattr_shared_xattrs[i];
+		struct erofs_shared_xattr_fp *fp;
+		erofs_blk_t blkaddr = xattrblock_addr(sbi, xattr_id);
 
-		it->it.ofs = xattrblock_offset(sbi, vi->xattr_shared_xattrs[i]);
+		fp = erofs_xattr_fp_lookup(sb, xattr_id);
+		if (!IS_ERR(fp) && (fp->index != it->index ||
+				    fp->name_len != it->name.len ||
+				    fp->name_crc != name_crc))
+			continue;
+
+		it->it.ofs = xattrblock_offset(sbi, xattr_id);
 		it->it.kaddr = erofs_read_metabuf(&it->it.buf, sb, blkaddr,
 						  EROFS_KMAP);
 		if (IS_ERR(it->it.kaddr))
@@ -65,6 +65,8 @@ extern const struct xattr_handler *erofs_xattr_handlers[];
 
 int erofs_getxattr(struct inode *, int, const char *, void *, size_t);
 ssize_t erofs_listxattr(struct dentry *, char *, size_t);
+void erofs_xattr_fp_init(struct erofs_sb_info *sbi);
+void erofs_xattr_fp_cleanup(struct erofs_sb_info *sbi);
 #else
 static inline int erofs_getxattr(struct inode *inode, int index,
 				 const char *name, void *buffer,
@@ -75,6 +77,8 @@ static inline int erofs_getxattr(struct inode *inode, int index,
 
 #define erofs_listxattr (NULL)
 #define erofs_xattr_handlers (NULL)
+static inline void erofs_xattr_fp_init(struct erofs_sb_info *sbi) {}
+static inline void erofs_xattr_fp_cleanup(struct erofs_sb_info *sbi) {}
 #endif	/* !CONFIG_EROFS_FS_XATTR */
 
 #ifdef CONFIG_EROFS_FS_POSIX_ACL
@@ -1282,6 +1282,140 @@ static int z_erofs_parse_in_bvecs(struct z_erofs_decompress_backend *be,
 	return 0;
 }
 
+/*
+ * Per-superblock LRU of recently decompressed pcluster outputs, keyed by
+ * the physical block address of the pcluster.  Only final folios land in
+ * the page cache, so random reads revisiting the same pcluster (or two
+ * files sharing dedupped compressed extents) would otherwise re-run the
+ * decompressor for every access.
+ */
+#define Z_EROFS_DCACHE_MAX_BYTES	(4UL << 20)
+#define Z_EROFS_DCACHE_ENTRY_MAX	(1UL << 20)
+
+struct z_erofs_dcache_entry {
+	struct list_head lru;
+	pgoff_t blkaddr;
+	unsigned int length;
+	unsigned short pageofs_out;
+	u8 data[];
+};
+
+void z_erofs_dcache_drop(struct erofs_sb_info *sbi)
+{
+	struct z_erofs_dcache_entry *entry, *n;
+
+	mutex_lock(&sbi->dcache_mutex);
+	list_for_each_entry_safe(entry, n, &sbi->dcache_lru, lru) {
+		list_del(&entry->lru);
+		kvfree(entry);
+	}
+	sbi->dcache_bytes = 0;
+	mutex_unlock(&sbi->dcache_mutex);
+}
+
+static bool z_erofs_dcache_usable(struct z_erofs_pcluster *pcl)
+{
+	return !z_erofs_is_inline_pcluster(pcl) && !pcl->partial &&
+		pcl->length && pcl->length <= Z_EROFS_DCACHE_ENTRY_MAX;
+}
+
+/* copy a cached decompressed stream from/to the attached output pages */
+static void z_erofs_dcache_transfer(struct z_erofs_decompress_backend *be,
+				    struct z_erofs_dcache_entry *entry,
+				    bool to_pages)
+{
+	struct z_erofs_pcluster *pcl = be->pcl;
+	unsigned int i, from, pgofs, len;
+	u8 *vaddr;
+
+	for (i = 0; i < be->nr_pages; ++i) {
+		struct page *page = be->decompressed_pages[i];
+
+		if (!page)
+			continue;
+		pgofs = i ? 0 : pcl->pageofs_out;
+		from = i ? i * PAGE_SIZE - pcl->pageofs_out : 0;
+		len = min_t(unsigned int, PAGE_SIZE - pgofs,
+			    pcl->length - from);
+
+		vaddr = kmap_local_page(page);
+		if (to_pages)
+			memcpy(vaddr + pgofs, entry->data + from, len);
+		else
+			memcpy(entry->data + from, vaddr + pgofs, len);
+		kunmap_local(vaddr);
+	}
+}
+
+static bool z_erofs_dcache_lookup(struct z_erofs_decompress_backend *be)
+{
+	struct erofs_sb_info *const sbi = EROFS_SB(be->sb);
+	struct z_erofs_pcluster *pcl = be->pcl;
+	struct z_erofs_dcache_entry *entry;
+
+	if (!z_erofs_dcache_usable(pcl))
+		return false;
+
+	mutex_lock(&sbi->dcache_mutex);
+	list_for_each_entry(entry, &sbi->dcache_lru, lru) {
+		if (entry->blkaddr == pcl->obj.index &&
+		    entry->length == pcl->length &&
+		    entry->pageofs_out == pcl->pageofs_out) {
+			z_erofs_dcache_transfer(be, entry, true);
+			list_move(&entry->lru, &sbi->dcache_lru);
+			mutex_unlock(&sbi->dcache_mutex);
+			return true;
+		}
+	}
+	mutex_unlock(&sbi->dcache_mutex);
+	return false;
+}
+
+static void z_erofs_dcache_insert(struct z_erofs_decompress_backend *be)
+{
+	struct erofs_sb_info *const sbi = EROFS_SB(be->sb);
+	struct z_erofs_pcluster *pcl = be->pcl;
+	struct z_erofs_dcache_entry *entry, *victim;
+	unsigned int i;
+
+	if (!z_erofs_dcache_usable(pcl))
+		return;
+
+	/* all output pages must be attached to snapshot the full stream */
+	for (i = 0; i < be->nr_pages; ++i)
+		if (!be->decompressed_pages[i])
+			return;
+
+	entry = kvmalloc(struct_size(entry, data, pcl->length),
+			 GFP_KERNEL | __GFP_NOWARN);
+	if (!entry)
+		return;
+	entry->blkaddr = pcl->obj.index;
+	entry->length = pcl->length;
+	entry->pageofs_out = pcl->pageofs_out;
+	z_erofs_dcache_transfer(be, entry, false);
+
+	mutex_lock(&sbi->dcache_mutex);
+	/* don't duplicate entries if two readers raced on this pcluster */
+	list_for_each_entry(victim, &sbi->dcache_lru, lru) {
+		if (victim->blkaddr == entry->blkaddr) {
+			mutex_unlock(&sbi->dcache_mutex);
+			kvfree(entry);
+			return;
+		}
+	}
+	sbi->dcache_bytes += pcl->length;
+	list_add(&entry->lru, &sbi->dcache_lru);
+	while (sbi->dcache_bytes > Z_EROFS_DCACHE_MAX_BYTES) {
+		victim = list_last_entry(&sbi->dcache_lru,
+					 struct z_erofs_dcache_entry, lru);
+		list_del(&victim->lru);
+		sbi->dcache_bytes -= victim->length;
+		kvfree(victim);
+	}
+	mutex_unlock(&sbi->dcache_mutex);
+}
+
 static int z_erofs_decompress_pcluster(struct z_erofs_decompress_backend *be,
 				       int err)
 {
@@ -1331,6 +1465,11 @@ static int z_erofs_decompress_pcluster(struct z_erofs_decompress_backend *be,
 	else
 		inputsize = pclusterpages * PAGE_SIZE;
 
+	if (z_erofs_dcache_lookup(be)) {
+		err = 0;
+		goto out;
+	}
+
 	err = z_erofs_decompress(&(struct z_erofs_decompress_req) {
 					.sb = be->sb,
 					.in = be->compressed_pages,
@@ -1344,6 +1483,8 @@ static int z_erofs_decompress_pcluster(struct z_erofs_decompress_backend *be,
 					.partial_decoding = pcl->partial,
 					.fillgaps = pcl->multibases,
 				 }, be->pagepool);
+	if (!err)
+		z_erofs_dcache_insert(be);
 
 out:
 	/* must handle all compressed pages before actual file pages */
@@ -1423,6 +1564,63 @@ static void z_erofs_decompress_queue(const struct z_erofs_decompressqueue *io,
 	}
 }
 
+#ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
+static void z_erofs_decompressqueue_kthread_work(struct kthread_work *work);
+
+/*
+ * Hand all but the first pcluster of a background queue over to the next
+ * online CPU's worker, so a single large readahead fans its decompression
+ * out instead of serializing on one kthread.  Each worker splits at most
+ * once before decompressing its own head pcluster, which bounds the
+ * fan-out by the number of online CPUs and keeps the chain walking cost
+ * unchanged.  Failure here is harmless: the caller just decompresses the
+ * whole chain itself as before.
+ */
+static void z_erofs_fan_out_queue(struct z_erofs_decompressqueue *io)
+{
+	struct z_erofs_pcluster *pcl =
+		container_of(io->head, struct z_erofs_pcluster, next);
+	z_erofs_next_pcluster_t rest = READ_ONCE(pcl->next);
+	struct z_erofs_decompressqueue *fq;
+	struct kthread_worker *worker;
+	unsigned int cpu;
+
+	if (rest == Z_EROFS_PCLUSTER_TAIL_CLOSED)
+		return;
+
+	cpu = cpumask_next(raw_smp_processor_id(), cpu_online_mask);
+	if (cpu >= nr_cpu_ids)
+		cpu = cpumask_first(cpu_online_mask);
+	if (cpu == raw_smp_processor_id())
+		return;
+
+	fq = kvzalloc(sizeof(*fq), GFP_NOIO | __GFP_NOWARN);
+	if (!fq)
+		return;
+
+	rcu_read_lock();
+	worker = rcu_dereference(z_erofs_pcpu_workers[cpu]);
+	if (!worker) {
+		rcu_read_unlock();
+		kvfree(fq);
+		return;
+	}
+	fq->sb = io->sb;
+	fq->eio = io->eio;
+	fq->sync = false;
+	fq->head = rest;
+	kthread_init_work(&fq->u.kthread_work,
+			  z_erofs_decompressqueue_kthread_work);
+	kthread_queue_work(worker, &fq->u.kthread_work);
+	rcu_read_unlock();
+
+	/* the chain is closed, so only this context can detach the rest */
+	WRITE_ONCE(pcl->next, Z_EROFS_PCLUSTER_TAIL_CLOSED);
+}
+#else
+static inline void z_erofs_fan_out_queue(struct z_erofs_decompressqueue *io) {}
+#endif
+
 static void z_erofs_decompressqueue_work(struct work_struct *work)
 {
 	struct z_erofs_decompressqueue *bgq =
@@ -1430,6 +1628,7 @@ static void z_erofs_decompressqueue_work(struct work_struct *work)
 	struct page *pagepool = NULL;
 
 	DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL_CLOSED);
+	z_erofs_fan_out_queue(bgq);
 	z_erofs_decompress_queue(bgq, &pagepool);
 	erofs_release_pages(&pagepool);
 	kvfree(bgq);
@@ -10,22 +10,6 @@
 #include "exfat_raw.h"
 #include "exfat_fs.h"
 
-static const unsigned char free_bit[] = {
-	0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2,/*  0 ~  19*/
-	0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 5, 0, 1, 0, 2, 0, 1, 0, 3,/* 20 ~  39*/
-	0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2,/* 40 ~  59*/
-	0, 1, 0, 6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4,/* 60 ~  79*/
-	0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 5, 0, 1, 0, 2,/* 80 ~  99*/
-	0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2, 0, 1, 0, 3,/*100 ~ 119*/
-	0, 1, 0, 2, 0, 1, 0, 7, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2,/*120 ~ 139*/
-	0, 1, 0, 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 5,/*140 ~ 159*/
-	0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2,/*160 ~ 179*/
-	0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 6, 0, 1, 0, 2, 0, 1, 0, 3,/*180 ~ 199*/
-	0, 1, 0, 2, 0, 1, 0, 4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2,/*200 ~ 219*/
-	0, 1, 0, 5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4,/*220 ~ 239*/
-	0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0                /*240 ~ 254*/
-};
-
 static const unsigned char used_bit[] = {
 	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3,/*  0 ~  19*/
 	2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4,/* 20 ~  39*/
@@ -198,41 +182,36 @@ void exfat_clear_bitmap(struct inode *inode, unsigned int clu, bool sync)
  */
 unsigned int exfat_find_free_bitmap(struct super_block *sb, unsigned int clu)
 {
-	unsigned int i, map_i, map_b, ent_idx;
-	unsigned int clu_base, clu_free;
-	unsigned char k, clu_mask;
+	unsigned int i, map_i, ent_idx, bit, clu_free;
 	struct exfat_sb_info *sbi = EXFAT_SB(sb);
 
 	WARN_ON(clu < EXFAT_FIRST_CLUSTER);
 	ent_idx = CLUSTER_TO_BITMAP_ENT(clu);
-	clu_base = BITMAP_ENT_TO_CLUSTER(ent_idx & ~(BITS_PER_BYTE_MASK));
-	clu_mask = IGNORED_BITS_REMAINED(clu, clu_base);
 
 	map_i = BITMAP_OFFSET_SECTOR_INDEX(sb, ent_idx);
-	map_b = BITMAP_OFFSET_BYTE_IN_SECTOR(sb, ent_idx);
-
-	for (i = EXFAT_FIRST_CLUSTER; i < sbi->num_clusters;
-	     i += BITS_PER_BYTE) {
-		k = *(sbi->vol_amap[map_i]->b_data + map_b);
-		if (clu_mask > 0) {
-			k |= clu_mask;
-			clu_mask = 0;
-		}
-		if (k < 0xFF) {
-			clu_free = clu_base + free_bit[k];
+	bit = BITMAP_OFFSET_BIT_IN_SECTOR(sb, ent_idx);
+
+	/*
+	 * Scan each bitmap sector a word at a time.  The starting sector is
+	 * visited twice so that the entries before the hint are also covered
+	 * after wrapping around.
+	 */
+	for (i = 0; i <= sbi->map_sectors; i++) {
+		bit = find_next_zero_bit_le(sbi->vol_amap[map_i]->b_data,
+					    BITS_PER_SECTOR(sb), bit);
+		if (bit < BITS_PER_SECTOR(sb)) {
+			clu_free = BITMAP_ENT_TO_CLUSTER(
+					map_i * BITS_PER_SECTOR(sb) + bit);
 			if (clu_free < sbi->num_clusters)
 				return clu_free;
+			/*
+			 * Free bits past the end of the cluster heap in the
+			 * last sector are invalid, wrap around.
+			 */
 		}
-		clu_base += BITS_PER_BYTE;
-
-		if (++map_b >= sb->s_blocksize ||
-		    clu_base >= sbi->num_clusters) {
-			if (++map_i >= sbi->map_sectors) {
-				clu_base = EXFAT_FIRST_CLUSTER;
-				map_i = 0;
-			}
-			map_b = 0;
-		}
+		if (++map_i >= sbi->map_sectors)
+			map_i = 0;
+		bit = 0;
 	}
 
 	return EXFAT_EOF_CLUSTER;
@@ -199,6 +199,7 @@ static void __fat_cache_inval_inode(struct inode *inode)
 	i->cache_valid_id++;
 	if (i->cache_valid_id == FAT_CACHE_VALID)
 		i->cache_valid_id++;
+	i->i_last_dclus = 0;
 }
 
 void fat_cache_inval_inode(struct inode *inode)
@@ -208,6 +209,24 @@ void fat_cache_inval_inode(struct inode *inode)
 	spin_unlock(&MSDOS_I(inode)->cache_lru_lock);
 }
 
+/*
+ * Remember the last cluster of the chain, so that appending does not have
+ * to re-walk the FAT.  Like fat_cache_add(), the update is thrown away if
+ * the cache was invalidated while the chain was being walked.
+ */
+void fat_cache_save_last(struct inode *inode, unsigned int id,
+			 int fclus, int dclus)
+{
+	struct msdos_inode_info *i = MSDOS_I(inode);
+
+	spin_lock(&i->cache_lru_lock);
+	if (id == FAT_CACHE_VALID || id == i->cache_valid_id) {
+		i->i_last_fclus = fclus;
+		i->i_last_dclus = dclus;
+	}
+	spin_unlock(&i->cache_lru_lock);
+}
+
 static inline int cache_contiguous(struct fat_cache_id *cid, int dclus)
 {
 	cid->nr_contig++;
@@ -244,6 +263,20 @@ int fat_get_cluster(struct inode *inode, int cluster, int *fclus, int *dclus)
 	if (cluster == 0)
 		return 0;
 
+	/* Looking for the last cluster? The saved hint avoids the walk. */
+	if (cluster == FAT_ENT_EOF) {
+		struct msdos_inode_info *i = MSDOS_I(inode);
+
+		spin_lock(&i->cache_lru_lock);
+		if (i->i_last_dclus) {
+			*fclus = i->i_last_fclus;
+			*dclus = i->i_last_dclus;
+			spin_unlock(&i->cache_lru_lock);
+			return FAT_ENT_EOF;
+		}
+		spin_unlock(&i->cache_lru_lock);
+	}
+
 	if (fat_cache_lookup(inode, cluster, &cid, fclus, dclus) < 0) {
 		/*
 		 * dummy, always not contiguous
@@ -274,6 +307,7 @@ int fat_get_cluster(struct inode *inode, int cluster, int *fclus, int *dclus)
 			goto out;
 		} else if (nr == FAT_ENT_EOF) {
 			fat_cache_add(inode, &cid);
+			fat_cache_save_last(inode, cid.id, *fclus, *dclus);
 			goto out;
 		}
 		(*fclus)++;
@@ -116,6 +116,10 @@ struct msdos_inode_info {
 	/* for avoiding the race between fat_free() and fat_get_cluster() */
 	unsigned int cache_valid_id;
 
+	/* last cluster of the chain, for O_APPEND; i_last_dclus 0 if unknown */
+	int i_last_fclus;
+	int i_last_dclus;
+
 	/* NOTE: mmu_private is 64bits, so must hold ->i_mutex to access */
 	loff_t mmu_private;	/* physically allocated size */
 
@@ -313,6 +317,8 @@ static inline void fatwchar_to16(__u8 *dst, const wchar_t *src, size_t len)
 
 /* fat/cache.c */
 extern void fat_cache_inval_inode(struct inode *inode);
+extern void fat_cache_save_last(struct inode *inode, unsigned int id,
+				int fclus, int dclus);
 extern int fat_get_cluster(struct inode *inode, int cluster,
 			   int *fclus, int *dclus);
 extern int fat_get_mapped_cluster(struct inode *inode, sector_t sector,
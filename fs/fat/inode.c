@@ -751,6 +751,8 @@ static struct inode *fat_alloc_inode(struct super_block *sb)
 	ei->mmu_private = 0;
 	ei->i_start = 0;
 	ei->i_logstart = 0;
+	ei->i_last_fclus = 0;
+	ei->i_last_dclus = 0;
 	ei->i_attrs = 0;
 	ei->i_pos = 0;
 	ei->i_crtime.tv_sec = 0;
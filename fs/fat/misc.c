@@ -138,11 +138,6 @@ int fat_chain_add(struct inode *inode, int new_dclus, int nr_cluster)
 		}
 		if (ret < 0)
 			return ret;
-		/*
-		 * FIXME:Although we can add this cache, fat_cache_add() is
-		 * assuming to be called after linear search with fat_cache_id.
-		 */
-//		fat_cache_add(inode, new_fclus, new_dclus);
 	} else {
 		MSDOS_I(inode)->i_start = new_dclus;
 		MSDOS_I(inode)->i_logstart = new_dclus;
@@ -157,6 +152,16 @@ int fat_chain_add(struct inode *inode, int new_dclus, int nr_cluster)
 		} else
 			mark_inode_dirty(inode);
 	}
+	/*
+	 * The tail of the chain moved.  Remember it for the next append;
+	 * when more than one cluster was linked only the first new cluster
+	 * is known here, so the hint has to be dropped instead.
+	 */
+	if (nr_cluster == 1)
+		fat_cache_save_last(inode, FAT_CACHE_VALID,
+				    new_fclus, new_dclus);
+	else
+		fat_cache_save_last(inode, FAT_CACHE_VALID, 0, 0);
 	if (new_fclus != (inode->i_blocks >> (sbi->cluster_bits - 9))) {
 		fat_fs_error(sb, "clusters badly computed (%d != %llu)",
 			     new_fclus,
@@ -393,6 +393,37 @@ static void fscache_wait_on_collision(struct fscache_cookie *candidate,
 	}
 }
 
+/*
+ * Look for a cookie that collides with the candidate in its hash bucket.  The
+ * caller must hold the bucket lock.
+ */
+static struct fscache_cookie *fscache_hash_lookup_locked(
+	struct hlist_bl_head *h,
+	struct fscache_cookie *candidate)
+{
+	struct fscache_cookie *cursor;
+	struct hlist_bl_node *p;
+
+	hlist_bl_for_each_entry(cursor, p, h, hash_link) {
+		if (fscache_cookie_same(candidate, cursor))
+			return cursor;
+	}
+	return NULL;
+}
+
+/*
+ * Insert a cookie into its hash bucket.  The caller must hold the bucket lock
+ * and have checked for collisions.
+ */
+static void fscache_hash_insert_locked(struct fscache_cookie *candidate,
+				       struct hlist_bl_head *h)
+{
+	fscache_get_volume(candidate->volume, fscache_volume_get_cookie);
+	atomic_inc(&candidate->volume->n_cookies);
+	hlist_bl_add_head(&candidate->hash_link, h);
+	set_bit(FSCACHE_COOKIE_IS_HASHED, &candidate->flags);
+}
+
 /*
  * Attempt to insert the new cookie into the hash.  If there's a collision, we
  * wait for the old cookie to complete if it's being relinquished and an error
@@ -402,27 +433,21 @@ static bool fscache_hash_cookie(struct fscache_cookie *candidate)
 {
 	struct fscache_cookie *cursor, *wait_for = NULL;
 	struct hlist_bl_head *h;
-	struct hlist_bl_node *p;
 	unsigned int bucket;
 
 	bucket = candidate->key_hash & (ARRAY_SIZE(fscache_cookie_hash) - 1);
 	h = &fscache_cookie_hash[bucket];
 
 	hlist_bl_lock(h);
-	hlist_bl_for_each_entry(cursor, p, h, hash_link) {
-		if (fscache_cookie_same(candidate, cursor)) {
-			if (!test_bit(FSCACHE_COOKIE_RELINQUISHED, &cursor->flags))
-				goto collision;
-			wait_for = fscache_get_cookie(cursor,
-						      fscache_cookie_get_hash_collision);
-			break;
-		}
+	cursor = fscache_hash_lookup_locked(h, candidate);
+	if (cursor) {
+		if (!test_bit(FSCACHE_COOKIE_RELINQUISHED, &cursor->flags))
+			goto collision;
+		wait_for = fscache_get_cookie(cursor,
+					      fscache_cookie_get_hash_collision);
 	}
 
-	fscache_get_volume(candidate->volume, fscache_volume_get_cookie);
-	atomic_inc(&candidate->volume->n_cookies);
-	hlist_bl_add_head(&candidate->hash_link, h);
-	set_bit(FSCACHE_COOKIE_IS_HASHED, &candidate->flags);
+	fscache_hash_insert_locked(candidate, h);
 	hlist_bl_unlock(h);
 
 	if (wait_for) {
@@ -489,6 +514,135 @@ struct fscache_cookie *__fscache_acquire_cookie(
 }
 EXPORT_SYMBOL(__fscache_acquire_cookie);
 
+/*
+ * Request a batch of cookies within one volume.  Allocation is done for all
+ * the descriptors first and then the candidates are inserted into the hash,
+ * with each bucket lock being taken once per run of candidates that hash to
+ * the same bucket rather than once per cookie.
+ *
+ * As with single acquisition, we never let on to the netfs about errors; a
+ * descriptor that can't be satisfied just gets a NULL cookie pointer.
+ */
+unsigned int __fscache_acquire_cookies(struct fscache_volume *volume,
+				       u8 advice,
+				       struct fscache_cookie_desc *descs,
+				       unsigned int nr)
+{
+	struct fscache_cookie *candidate, *cursor;
+	struct fscache_cookie_desc *desc;
+	struct hlist_bl_head *h;
+	LIST_HEAD(discards);
+	unsigned int i, j, bucket, nr_ok = 0;
+
+	_enter("V=%x,%u", volume->debug_id, nr);
+
+	/* Allocate a candidate cookie for each valid descriptor. */
+	for (i = 0; i < nr; i++) {
+		const void *aux_data;
+		size_t aux_data_len;
+
+		desc = &descs[i];
+		desc->cookie = NULL;
+
+		if (!desc->index_key || !desc->index_key_len ||
+		    desc->index_key_len > 255 || desc->aux_data_len > 255)
+			continue;
+		aux_data = desc->aux_data;
+		aux_data_len = desc->aux_data_len;
+		if (!aux_data || !aux_data_len) {
+			aux_data = NULL;
+			aux_data_len = 0;
+		}
+
+		fscache_stat(&fscache_n_acquires);
+
+		desc->cookie = fscache_alloc_cookie(volume, advice,
+						    desc->index_key,
+						    desc->index_key_len,
+						    aux_data, aux_data_len,
+						    desc->object_size);
+		if (!desc->cookie)
+			fscache_stat(&fscache_n_acquires_oom);
+	}
+
+	/* Insert the candidates into the hash, taking each bucket lock once
+	 * for all the candidates that hash to that bucket.  Candidates that
+	 * collide with a cookie still being relinquished are left unhashed
+	 * here and passed to the waiting slow path below.
+	 */
+	for (i = 0; i < nr; i++) {
+		candidate = descs[i].cookie;
+		if (!candidate ||
+		    test_bit(FSCACHE_COOKIE_IS_HASHED, &candidate->flags))
+			continue;
+
+		bucket = candidate->key_hash & (ARRAY_SIZE(fscache_cookie_hash) - 1);
+		h = &fscache_cookie_hash[bucket];
+
+		hlist_bl_lock(h);
+		for (j = i; j < nr; j++) {
+			candidate = descs[j].cookie;
+			if (!candidate ||
+			    test_bit(FSCACHE_COOKIE_IS_HASHED, &candidate->flags) ||
+			    (candidate->key_hash &
+			     (ARRAY_SIZE(fscache_cookie_hash) - 1)) != bucket)
+				continue;
+
+			cursor = fscache_hash_lookup_locked(h, candidate);
+			if (!cursor) {
+				fscache_hash_insert_locked(candidate, h);
+				continue;
+			}
+			if (test_bit(FSCACHE_COOKIE_RELINQUISHED, &cursor->flags))
+				continue;
+
+			trace_fscache_cookie(cursor->debug_id,
+					     refcount_read(&cursor->ref),
+					     fscache_cookie_collision);
+			pr_err("Duplicate cookie detected\n");
+			fscache_print_cookie(cursor, 'O');
+			fscache_print_cookie(candidate, 'N');
+			descs[j].cookie = NULL;
+			list_add_tail(&candidate->commit_link, &discards);
+		}
+		hlist_bl_unlock(h);
+	}
+
+	while (!list_empty(&discards)) {
+		candidate = list_first_entry(&discards, struct fscache_cookie,
+					     commit_link);
+		list_del_init(&candidate->commit_link);
+		fscache_see_cookie(candidate, fscache_cookie_discard);
+		fscache_free_cookie(candidate);
+	}
+
+	for (i = 0; i < nr; i++) {
+		desc = &descs[i];
+		candidate = desc->cookie;
+		if (!candidate)
+			continue;
+
+		/* Candidates that hit a cookie being relinquished take the
+		 * ordinary path, which waits for the old cookie to go away.
+		 */
+		if (!test_bit(FSCACHE_COOKIE_IS_HASHED, &candidate->flags) &&
+		    !fscache_hash_cookie(candidate)) {
+			fscache_see_cookie(candidate, fscache_cookie_discard);
+			fscache_free_cookie(candidate);
+			desc->cookie = NULL;
+			continue;
+		}
+
+		trace_fscache_acquire(candidate);
+		fscache_stat(&fscache_n_acquires_ok);
+		nr_ok++;
+	}
+
+	_leave(" = %u", nr_ok);
+	return nr_ok;
+}
+EXPORT_SYMBOL(__fscache_acquire_cookies);
+
 /*
  * Prepare a cache object to be written to.
  */
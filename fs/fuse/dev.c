@@ -194,8 +194,7 @@ EXPORT_SYMBOL_GPL(fuse_len_args);
 
 u64 fuse_get_unique(struct fuse_iqueue *fiq)
 {
-	fiq->reqctr += FUSE_REQ_ID_STEP;
-	return fiq->reqctr;
+	return atomic64_add_return(FUSE_REQ_ID_STEP, &fiq->reqctr);
 }
 EXPORT_SYMBOL_GPL(fuse_get_unique);
 
@@ -233,6 +232,85 @@ __releases(fiq->lock)
 	fiq->ops->wake_pending_and_unlock(fiq);
 }
 
+/*
+ * Enqueue a request on this CPU's shard without taking fiq->lock.
+ * Returns false if the connection is being aborted, in which case the
+ * caller handles the request as on a disconnected queue.
+ *
+ * Pairs with fuse_abort_conn(): the abort side clears ->connected and
+ * then takes every shard lock to sweep stragglers, so a request added
+ * after ->connected was observed set under the shard lock is guaranteed
+ * to be picked up by that sweep.
+ */
+static bool queue_request_sharded(struct fuse_iqueue *fiq,
+				  struct fuse_req *req)
+{
+	struct fuse_iqueue_shard *shard;
+
+	req->in.h.len = sizeof(struct fuse_in_header) +
+		fuse_len_args(req->args->in_numargs,
+			      (struct fuse_arg *) req->args->in_args);
+	shard = get_cpu_ptr(fiq->shards);
+	spin_lock(&shard->lock);
+	if (!READ_ONCE(fiq->connected)) {
+		spin_unlock(&shard->lock);
+		put_cpu_ptr(fiq->shards);
+		return false;
+	}
+	req->shard = shard;
+	list_add_tail(&req->list, &shard->pending);
+	spin_unlock(&shard->lock);
+	put_cpu_ptr(fiq->shards);
+
+	wake_up(&fiq->waitq);
+	kill_fasync(&fiq->fasync, SIGIO, POLL_IN);
+	return true;
+}
+
+/*
+ * Fetch one pending request, preferring this CPU's shard and stealing
+ * from the other shards otherwise.  May return NULL if another reader
+ * (or a bailing waiter) got there first.
+ */
+static struct fuse_req *fuse_dequeue_sharded(struct fuse_iqueue *fiq)
+{
+	int cpu;
+
+	for_each_cpu_wrap(cpu, cpu_possible_mask, raw_smp_processor_id()) {
+		struct fuse_iqueue_shard *shard = per_cpu_ptr(fiq->shards, cpu);
+		struct fuse_req *req;
+
+		if (list_empty_careful(&shard->pending))
+			continue;
+		spin_lock(&shard->lock);
+		if (list_empty(&shard->pending)) {
+			spin_unlock(&shard->lock);
+			continue;
+		}
+		req = list_entry(shard->pending.next, struct fuse_req, list);
+		clear_bit(FR_PENDING, &req->flags);
+		list_del_init(&req->list);
+		req->shard = NULL;
+		spin_unlock(&shard->lock);
+		return req;
+	}
+	return NULL;
+}
+
+static bool fuse_shards_pending(struct fuse_iqueue *fiq)
+{
+	int cpu;
+
+	if (!fiq->shards)
+		return false;
+	for_each_possible_cpu(cpu) {
+		if (!list_empty_careful(&per_cpu_ptr(fiq->shards,
+						     cpu)->pending))
+			return true;
+	}
+	return false;
+}
+
 void fuse_queue_forget(struct fuse_conn *fc, struct fuse_forget_link *forget,
 		       u64 nodeid, u64 nlookup)
 {
@@ -263,8 +341,10 @@ static void flush_bg_queue(struct fuse_conn *fc)
 		req = list_first_entry(&fc->bg_queue, struct fuse_req, list);
 		list_del(&req->list);
 		fc->active_background++;
-		spin_lock(&fiq->lock);
 		req->in.h.unique = fuse_get_unique(fiq);
+		if (fiq->shards && queue_request_sharded(fiq, req))
+			continue;
+		spin_lock(&fiq->lock);
 		queue_request_and_unlock(fiq, req);
 	}
 }
@@ -388,16 +468,37 @@ static void request_wait_answer(struct fuse_req *req)
 		if (!err)
 			return;
 
-		spin_lock(&fiq->lock);
-		/* Request is not yet in userspace, bail out */
-		if (test_bit(FR_PENDING, &req->flags)) {
-			list_del(&req->list);
+		if (fiq->shards) {
+			struct fuse_iqueue_shard *shard = req->shard;
+			bool intr = false;
+
+			if (shard) {
+				spin_lock(&shard->lock);
+				/* Request is not yet in userspace, bail out */
+				if (test_bit(FR_PENDING, &req->flags)) {
+					list_del(&req->list);
+					req->shard = NULL;
+					intr = true;
+				}
+				spin_unlock(&shard->lock);
+			}
+			if (intr) {
+				__fuse_put_request(req);
+				req->out.h.error = -EINTR;
+				return;
+			}
+		} else {
+			spin_lock(&fiq->lock);
+			/* Request is not yet in userspace, bail out */
+			if (test_bit(FR_PENDING, &req->flags)) {
+				list_del(&req->list);
+				spin_unlock(&fiq->lock);
+				__fuse_put_request(req);
+				req->out.h.error = -EINTR;
+				return;
+			}
 			spin_unlock(&fiq->lock);
-			__fuse_put_request(req);
-			req->out.h.error = -EINTR;
-			return;
 		}
-		spin_unlock(&fiq->lock);
 	}
 
 	/*
@@ -412,6 +513,22 @@ static void __fuse_request_send(struct fuse_req *req)
 	struct fuse_iqueue *fiq = &req->fm->fc->iq;
 
 	BUG_ON(test_bit(FR_BACKGROUND, &req->flags));
+	if (fiq->shards) {
+		req->in.h.unique = fuse_get_unique(fiq);
+		/* acquire extra reference, since request is still needed
+		   after fuse_request_end() */
+		__fuse_get_request(req);
+		if (!queue_request_sharded(fiq, req)) {
+			__fuse_put_request(req);
+			req->out.h.error = -ENOTCONN;
+			return;
+		}
+
+		request_wait_answer(req);
+		/* Pairs with smp_wmb() in fuse_request_end() */
+		smp_rmb();
+		return;
+	}
 	spin_lock(&fiq->lock);
 	if (!fiq->connected) {
 		spin_unlock(&fiq->lock);
@@ -592,6 +709,14 @@ static int fuse_simple_notify_reply(struct fuse_mount *fm,
 
 	fuse_args_to_req(req, args);
 
+	if (fiq->shards) {
+		if (!queue_request_sharded(fiq, req)) {
+			err = -ENODEV;
+			fuse_put_request(req);
+		}
+		return err;
+	}
+
 	spin_lock(&fiq->lock);
 	if (fiq->connected) {
 		queue_request_and_unlock(fiq, req);
@@ -1035,7 +1160,7 @@ static int forget_pending(struct fuse_iqueue *fiq)
 static int request_pending(struct fuse_iqueue *fiq)
 {
 	return !list_empty(&fiq->pending) || !list_empty(&fiq->interrupts) ||
-		forget_pending(fiq);
+		forget_pending(fiq) || fuse_shards_pending(fiq);
 }
 
 /*
@@ -1265,10 +1390,18 @@ static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
 			fiq->forget_batch = 16;
 	}
 
-	req = list_entry(fiq->pending.next, struct fuse_req, list);
-	clear_bit(FR_PENDING, &req->flags);
-	list_del_init(&req->list);
-	spin_unlock(&fiq->lock);
+	if (fiq->shards && list_empty(&fiq->pending)) {
+		req = fuse_dequeue_sharded(fiq);
+		spin_unlock(&fiq->lock);
+		/* another reader or a bailing waiter beat us to it */
+		if (!req)
+			goto restart;
+	} else {
+		req = list_entry(fiq->pending.next, struct fuse_req, list);
+		clear_bit(FR_PENDING, &req->flags);
+		list_del_init(&req->list);
+		spin_unlock(&fiq->lock);
+	}
 
 	args = req->args;
 	reqsize = req->in.h.len;
@@ -2171,6 +2304,24 @@ void fuse_abort_conn(struct fuse_conn *fc)
 		list_for_each_entry(req, &fiq->pending, list)
 			clear_bit(FR_PENDING, &req->flags);
 		list_splice_tail_init(&fiq->pending, &to_end);
+		if (fiq->shards) {
+			int cpu;
+
+			for_each_possible_cpu(cpu) {
+				struct fuse_iqueue_shard *shard =
+					per_cpu_ptr(fiq->shards, cpu);
+
+				spin_lock(&shard->lock);
+				list_for_each_entry(req, &shard->pending,
+						    list) {
+					clear_bit(FR_PENDING, &req->flags);
+					req->shard = NULL;
+				}
+				list_splice_tail_init(&shard->pending,
+						      &to_end);
+				spin_unlock(&shard->lock);
+			}
+		}
 		while (forget_pending(fiq))
 			kfree(fuse_dequeue_forget(fiq, 1, NULL));
 		wake_up_all(&fiq->waitq);
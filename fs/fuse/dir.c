@@ -193,6 +193,139 @@ static void fuse_lookup_init(struct fuse_conn *fc, struct fuse_args *args,
 	args->out_args[0].value = outarg;
 }
 
+/* Maximum number of names revalidated by one FUSE_BATCH_LOOKUP request */
+#define FUSE_BATCH_LOOKUP_MAX 32
+
+/*
+ * Apply one FUSE_BATCH_LOOKUP reply entry to the corresponding dentry.
+ *
+ * Unlike FUSE_LOOKUP, a reply entry does not add to the lookup count of
+ * the node, so nothing needs to be forgotten here.  Zero nodeid means
+ * the name does not exist; the entry timeouts then apply to the negative
+ * dentry, same as for a negative FUSE_LOOKUP reply.  Anything that does
+ * not exactly match the cached state is left for the regular lookup path
+ * to sort out.
+ */
+static void fuse_batch_revalidate_one(struct dentry *entry,
+				      struct fuse_entry_out *o,
+				      u64 attr_version)
+{
+	struct inode *inode = d_inode(entry);
+
+	if (!o->nodeid) {
+		if (inode)
+			fuse_invalidate_entry(entry);
+		else
+			fuse_change_entry_timeout(entry, o);
+		return;
+	}
+	if (!inode || invalid_nodeid(o->nodeid) || fuse_invalid_attr(&o->attr))
+		return;
+	if (o->nodeid != get_node_id(inode) ||
+	    (bool) IS_AUTOMOUNT(inode) != (bool) (o->attr.flags & FUSE_ATTR_SUBMOUNT) ||
+	    fuse_stale_inode(inode, o->generation, &o->attr)) {
+		fuse_invalidate_entry(entry);
+		return;
+	}
+
+	forget_all_cached_acls(inode);
+	fuse_change_attributes(inode, &o->attr, entry_attr_timeout(o),
+			       attr_version);
+	fuse_change_entry_timeout(entry, o);
+}
+
+/*
+ * Refresh all cached children of @parent whose entry timeout has expired
+ * with a single FUSE_BATCH_LOOKUP request.
+ *
+ * This is a best effort cache refresh: failure just leaves the timeouts
+ * expired, and each dentry then falls back to an individual FUSE_LOOKUP
+ * on its next revalidation.
+ */
+static void fuse_batch_revalidate(struct dentry *parent)
+{
+	struct inode *dir = d_inode(parent);
+	struct fuse_mount *fm = get_fuse_mount(dir);
+	struct dentry *dents[FUSE_BATCH_LOOKUP_MAX];
+	struct fuse_batch_lookup_in inarg;
+	struct fuse_entry_out *outarg;
+	struct dentry *child;
+	char *names;
+	unsigned int num = 0;
+	unsigned int nvalid, i;
+	unsigned int len = 0;
+	u64 attr_version;
+	u64 now = get_jiffies_64();
+	FUSE_ARGS(args);
+	ssize_t ret;
+
+	names = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	outarg = kmalloc_array(FUSE_BATCH_LOOKUP_MAX, sizeof(*outarg),
+			       GFP_KERNEL);
+	if (!names || !outarg)
+		goto out_free;
+
+	spin_lock(&parent->d_lock);
+	list_for_each_entry(child, &parent->d_subdirs, d_child) {
+		if (num == FUSE_BATCH_LOOKUP_MAX)
+			break;
+
+		spin_lock_nested(&child->d_lock, DENTRY_D_LOCK_NESTED);
+		/*
+		 * The name is copied under d_lock, so a concurrent rename
+		 * cannot change it under us.
+		 */
+		if (!d_unhashed(child) && !d_in_lookup(child) &&
+		    time_before64(fuse_dentry_time(child), now) &&
+		    len + child->d_name.len + 1 <= PAGE_SIZE) {
+			memcpy(names + len, child->d_name.name,
+			       child->d_name.len);
+			len += child->d_name.len;
+			names[len++] = '\0';
+			dents[num++] = dget_dlock(child);
+		}
+		spin_unlock(&child->d_lock);
+	}
+	spin_unlock(&parent->d_lock);
+
+	if (num < 2)
+		goto out_put;
+
+	attr_version = fuse_get_attr_version(fm->fc);
+
+	memset(&inarg, 0, sizeof(inarg));
+	inarg.count = num;
+	args.opcode = FUSE_BATCH_LOOKUP;
+	args.nodeid = get_node_id(dir);
+	args.in_numargs = 2;
+	args.in_args[0].size = sizeof(inarg);
+	args.in_args[0].value = &inarg;
+	args.in_args[1].size = len;
+	args.in_args[1].value = names;
+	args.out_argvar = true;
+	args.out_numargs = 1;
+	args.out_args[0].size = num * sizeof(struct fuse_entry_out);
+	args.out_args[0].value = outarg;
+	ret = fuse_simple_request(fm, &args);
+	if (ret < 0) {
+		if (ret == -ENOSYS)
+			fm->fc->no_batch_lookup = 1;
+		goto out_put;
+	}
+
+	/* The filesystem may answer fewer entries than were asked for */
+	nvalid = min_t(unsigned int, num, ret / sizeof(struct fuse_entry_out));
+	for (i = 0; i < nvalid; i++)
+		fuse_batch_revalidate_one(dents[i], &outarg[i], attr_version);
+
+out_put:
+	for (i = 0; i < num; i++)
+		dput(dents[i]);
+out_free:
+	kfree(outarg);
+	kfree(names);
+}
+
 /*
  * Check whether the dentry is still valid
  *
@@ -230,6 +363,24 @@ static int fuse_dentry_revalidate(struct dentry *entry, unsigned int flags)
 
 		fm = get_fuse_mount(inode);
 
+		/*
+		 * Refreshing all expired siblings in one exchange typically
+		 * revalidates this dentry as a side effect and saves the
+		 * per-name round trips on the rest of the path walks.
+		 */
+		if (!fm->fc->no_batch_lookup &&
+		    !(flags & (LOOKUP_EXCL | LOOKUP_REVAL |
+			       LOOKUP_RENAME_TARGET))) {
+			parent = dget_parent(entry);
+			fuse_batch_revalidate(parent);
+			dput(parent);
+			if (!time_before64(fuse_dentry_time(entry),
+					   get_jiffies_64())) {
+				ret = 1;
+				goto out;
+			}
+		}
+
 		forget = fuse_alloc_forget();
 		ret = -ENOMEM;
 		if (!forget)
@@ -369,6 +369,9 @@ struct fuse_req {
 	/** Used to wake up the task waiting for completion of request*/
 	wait_queue_head_t waitq;
 
+	/** Input queue shard this request is pending on, if any */
+	struct fuse_iqueue_shard *shard;
+
 #if IS_ENABLED(CONFIG_VIRTIO_FS)
 	/** virtio-fs's physically contiguous buffer for in and out args */
 	void *argbuf;
@@ -416,6 +419,15 @@ struct fuse_iqueue_ops {
 /** /dev/fuse input queue operations */
 extern const struct fuse_iqueue_ops fuse_dev_fiq_ops;
 
+/*
+ * Per-CPU shard of the input queue's pending list, so request submission
+ * and daemon fetch don't all serialize on fiq->lock.
+ */
+struct fuse_iqueue_shard {
+	spinlock_t lock;
+	struct list_head pending;
+} ____cacheline_aligned_in_smp;
+
 struct fuse_iqueue {
 	/** Connection established */
 	unsigned connected;
@@ -426,12 +438,19 @@ struct fuse_iqueue {
 	/** Readers of the connection are waiting on this */
 	wait_queue_head_t waitq;
 
-	/** The next unique request id */
-	u64 reqctr;
+	/** The next unique request id (atomic, no fiq->lock needed) */
+	atomic64_t reqctr;
 
 	/** The list of pending requests */
 	struct list_head pending;
 
+	/**
+	 * Per-CPU pending shards, used instead of the pending list above
+	 * for the /dev/fuse transport; NULL if unavailable or unsupported
+	 * by the transport.
+	 */
+	struct fuse_iqueue_shard __percpu *shards;
+
 	/** Pending interrupts */
 	struct list_head interrupts;
 
@@ -644,6 +663,11 @@ struct fuse_conn {
 	/** write-back cache policy (default is write-through) */
 	unsigned writeback_cache:1;
 
+	/** send writeback data from the page cache itself instead of
+	    copying into temporary pages (server promised not to stall
+	    WRITE requests indefinitely) */
+	unsigned stable_writes:1;
+
 	/** allow parallel lookups and readdir (default is serialized) */
 	unsigned parallel_dirops:1;
 
@@ -675,6 +699,9 @@ struct fuse_conn {
 	/** Is opendir/releasedir not implemented by fs? */
 	unsigned no_opendir:1;
 
+	/** Is batched lookup revalidation not implemented by fs? */
+	unsigned no_batch_lookup:1;
+
 	/** Is fsync not implemented by fs? */
 	unsigned no_fsync:1;
 
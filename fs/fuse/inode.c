@@ -812,6 +812,27 @@ static void fuse_iqueue_init(struct fuse_iqueue *fiq,
 	fiq->connected = 1;
 	fiq->ops = ops;
 	fiq->priv = priv;
+
+	/*
+	 * Only the /dev/fuse transport fetches from the shards; other
+	 * transports (e.g. virtiofs) consume fiq->pending directly from
+	 * their wake_pending_and_unlock callbacks.  Allocation failure
+	 * just keeps the single-list slow path.
+	 */
+	if (ops == &fuse_dev_fiq_ops) {
+		int cpu;
+
+		fiq->shards = alloc_percpu(struct fuse_iqueue_shard);
+		if (fiq->shards) {
+			for_each_possible_cpu(cpu) {
+				struct fuse_iqueue_shard *shard =
+					per_cpu_ptr(fiq->shards, cpu);
+
+				spin_lock_init(&shard->lock);
+				INIT_LIST_HEAD(&shard->pending);
+			}
+		}
+	}
 }
 
 static void fuse_pqueue_init(struct fuse_pqueue *fpq)
@@ -871,6 +892,7 @@ void fuse_conn_put(struct fuse_conn *fc)
 			fuse_dax_conn_free(fc);
 		if (fiq->ops->release)
 			fiq->ops->release(fiq);
+		free_percpu(fiq->shards);
 		put_pid_ns(fc->pid_ns);
 		put_user_ns(fc->user_ns);
 		bucket = rcu_dereference_protected(fc->curr_bucket, 1);
@@ -1172,6 +1194,8 @@ static void process_init_reply(struct fuse_mount *fm, struct fuse_args *args,
 				fc->async_dio = 1;
 			if (flags & FUSE_WRITEBACK_CACHE)
 				fc->writeback_cache = 1;
+			if (flags & FUSE_STABLE_WRITES)
+				fc->stable_writes = 1;
 			if (flags & FUSE_PARALLEL_DIROPS)
 				fc->parallel_dirops = 1;
 			if (flags & FUSE_HANDLE_KILLPRIV)
@@ -1254,7 +1278,8 @@ void fuse_send_init(struct fuse_mount *fm)
 		FUSE_ABORT_ERROR | FUSE_MAX_PAGES | FUSE_CACHE_SYMLINKS |
 		FUSE_NO_OPENDIR_SUPPORT | FUSE_EXPLICIT_INVAL_DATA |
 		FUSE_HANDLE_KILLPRIV_V2 | FUSE_SETXATTR_EXT | FUSE_INIT_EXT |
-		FUSE_SECURITY_CTX | FUSE_CREATE_SUPP_GROUP;
+		FUSE_SECURITY_CTX | FUSE_CREATE_SUPP_GROUP |
+		FUSE_STABLE_WRITES;
 #ifdef CONFIG_FUSE_DAX
 	if (fm->fc->dax)
 		flags |= FUSE_MAP_ALIGNMENT;
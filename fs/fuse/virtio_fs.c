@@ -6,6 +6,7 @@
 
 #include <linux/fs.h>
 #include <linux/dax.h>
+#include <linux/interrupt.h>
 #include <linux/pci.h>
 #include <linux/pfn_t.h>
 #include <linux/memremap.h>
@@ -61,6 +62,7 @@ struct virtio_fs {
 	struct virtio_fs_vq *vqs;
 	unsigned int nvqs;               /* number of virtqueues */
 	unsigned int num_request_queues; /* number of request queues */
+	unsigned int *mq_map;            /* index = cpu id, value = request vq id */
 	struct dax_device *dax_dev;
 
 	/* DAX memory window where file contents are mapped */
@@ -165,6 +167,7 @@ static void release_virtio_fs_obj(struct kref *ref)
 {
 	struct virtio_fs *vfs = container_of(ref, struct virtio_fs, refcount);
 
+	kfree(vfs->mq_map);
 	kfree(vfs->vqs);
 	kfree(vfs);
 }
@@ -679,12 +682,50 @@ static void virtio_fs_init_vq(struct virtio_fs_vq *fsvq, char *name,
 	}
 }
 
+/*
+ * Map each CPU to a request virtqueue so that submissions spread across
+ * all queues instead of funneling through the first one.  Use the
+ * transport's interrupt affinities when available, otherwise spread the
+ * CPUs round-robin.
+ */
+static void virtio_fs_map_queues(struct virtio_device *vdev,
+				 struct virtio_fs *fs)
+{
+	const struct cpumask *mask;
+	unsigned int q, cpu;
+
+	if (!vdev->config->get_vq_affinity)
+		goto fallback;
+
+	for (q = 0; q < fs->num_request_queues; q++) {
+		mask = vdev->config->get_vq_affinity(vdev, VQ_REQUEST + q);
+		if (!mask)
+			goto fallback;
+
+		for_each_cpu(cpu, mask)
+			fs->mq_map[cpu] = VQ_REQUEST + q;
+	}
+
+	return;
+fallback:
+	q = 0;
+	for_each_possible_cpu(cpu) {
+		fs->mq_map[cpu] = VQ_REQUEST + q;
+		q = (q + 1) % fs->num_request_queues;
+	}
+}
+
 /* Initialize virtqueues */
 static int virtio_fs_setup_vqs(struct virtio_device *vdev,
 			       struct virtio_fs *fs)
 {
 	struct virtqueue **vqs;
 	vq_callback_t **callbacks;
+	/* Specify pre_vectors to ensure that the queues before the
+	 * request queues (e.g. hiprio) don't claim any of the CPUs in the
+	 * multiqueue mapping below.
+	 */
+	struct irq_affinity desc = { .pre_vectors = VQ_REQUEST };
 	const char **names;
 	unsigned int i;
 	int ret = 0;
@@ -699,6 +740,13 @@ static int virtio_fs_setup_vqs(struct virtio_device *vdev,
 	if (!fs->vqs)
 		return -ENOMEM;
 
+	fs->mq_map = kcalloc_node(nr_cpu_ids, sizeof(*fs->mq_map), GFP_KERNEL,
+				  dev_to_node(&vdev->dev));
+	if (!fs->mq_map) {
+		kfree(fs->vqs);
+		return -ENOMEM;
+	}
+
 	vqs = kmalloc_array(fs->nvqs, sizeof(vqs[VQ_HIPRIO]), GFP_KERNEL);
 	callbacks = kmalloc_array(fs->nvqs, sizeof(callbacks[VQ_HIPRIO]),
 					GFP_KERNEL);
@@ -723,20 +771,24 @@ static int virtio_fs_setup_vqs(struct virtio_device *vdev,
 		names[i] = fs->vqs[i].name;
 	}
 
-	ret = virtio_find_vqs(vdev, fs->nvqs, vqs, callbacks, names, NULL);
+	ret = virtio_find_vqs(vdev, fs->nvqs, vqs, callbacks, names, &desc);
 	if (ret < 0)
 		goto out;
 
 	for (i = 0; i < fs->nvqs; i++)
 		fs->vqs[i].vq = vqs[i];
 
+	virtio_fs_map_queues(vdev, fs);
+
 	virtio_fs_start_all_queues(fs);
 out:
 	kfree(names);
 	kfree(callbacks);
 	kfree(vqs);
-	if (ret)
+	if (ret) {
 		kfree(fs->vqs);
+		kfree(fs->mq_map);
+	}
 	return ret;
 }
 
@@ -895,6 +947,7 @@ static int virtio_fs_probe(struct virtio_device *vdev)
 out_vqs:
 	virtio_reset_device(vdev);
 	virtio_fs_cleanup_vqs(vdev);
+	kfree(fs->mq_map);
 	kfree(fs->vqs);
 
 out:
@@ -1223,7 +1276,7 @@ out:
 static void virtio_fs_wake_pending_and_unlock(struct fuse_iqueue *fiq)
 __releases(fiq->lock)
 {
-	unsigned int queue_id = VQ_REQUEST; /* TODO multiqueue */
+	unsigned int queue_id;
 	struct virtio_fs *fs;
 	struct fuse_req *req;
 	struct virtio_fs_vq *fsvq;
@@ -1237,14 +1290,35 @@ __releases(fiq->lock)
 	spin_unlock(&fiq->lock);
 
 	fs = fiq->priv;
+	queue_id = fs->mq_map[raw_smp_processor_id()];
 
-	pr_debug("%s: opcode %u unique %#llx nodeid %#llx in.len %u out.len %u\n",
+	pr_debug("%s: opcode %u unique %#llx nodeid %#llx in.len %u out.len %u queue_id %u\n",
 		  __func__, req->in.h.opcode, req->in.h.unique,
 		 req->in.h.nodeid, req->in.h.len,
-		 fuse_len_args(req->args->out_numargs, req->args->out_args));
+		 fuse_len_args(req->args->out_numargs, req->args->out_args),
+		 queue_id);
 
 	fsvq = &fs->vqs[queue_id];
 	ret = virtio_fs_enqueue_req(fsvq, req, false);
+	if (ret == -ENOSPC && fs->num_request_queues > 1) {
+		unsigned int id;
+
+		/*
+		 * The mapped queue is full; before falling back to the
+		 * dispatch worker, try to steal a slot on the other
+		 * request queues.  Requests are not bound to a queue
+		 * until they are enqueued, so completion still happens
+		 * on whichever queue accepted the request.
+		 */
+		for (id = VQ_REQUEST; id < fs->nvqs; id++) {
+			if (id == queue_id)
+				continue;
+			fsvq = &fs->vqs[id];
+			ret = virtio_fs_enqueue_req(fsvq, req, false);
+			if (ret != -ENOSPC)
+				break;
+		}
+	}
 	if (ret < 0) {
 		if (ret == -ENOMEM || ret == -ENOSPC) {
 			/*
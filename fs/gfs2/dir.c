@@ -65,6 +65,7 @@
 #include "incore.h"
 #include "dir.h"
 #include "glock.h"
+#include "glops.h"
 #include "inode.h"
 #include "meta_io.h"
 #include "quota.h"
@@ -74,6 +75,7 @@
 #include "util.h"
 
 #define MAX_RA_BLOCKS 32 /* max read-ahead blocks */
+#define MAX_LOCK_AHEAD 32 /* max inode glocks prefetched per readdir buffer */
 
 #define gfs2_disk_hash2offset(h) (((u64)(h)) >> 1)
 #define gfs2_dir_offset2hash(p) ((u32)(((u64)(p)) << 1))
@@ -1265,9 +1267,11 @@ static int do_filldir_main(struct gfs2_inode *dip, struct dir_context *ctx,
 			   u32 sort_start, int *copied)
 {
 	const struct gfs2_dirent *dent, *dent_next;
+	struct gfs2_sbd *sdp = GFS2_SB(&dip->i_inode);
 	u64 off, off_next;
 	unsigned int x, y;
 	int run = 0;
+	int prefetched = 0;
 
 	if (sort_start < entries)
 		sort(&darr[sort_start], entries - sort_start,
@@ -1306,6 +1310,17 @@ static int do_filldir_main(struct gfs2_inode *dip, struct dir_context *ctx,
 				be16_to_cpu(dent->de_type)))
 			return 1;
 
+		/* A readdir is nearly always followed by a stat of each
+		   entry, so fetch the inode glocks ahead in shared mode
+		   to spare those stats a DLM round trip each. */
+		if (prefetched < MAX_LOCK_AHEAD &&
+		    be64_to_cpu(dent->de_inum.no_addr) != dip->i_no_addr) {
+			gfs2_glock_prefetch_num(sdp,
+					be64_to_cpu(dent->de_inum.no_addr),
+					&gfs2_inode_glops);
+			prefetched++;
+		}
+
 		*copied = 1;
 	}
 
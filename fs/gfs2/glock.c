@@ -1237,6 +1237,68 @@ out:
 	return ret;
 }
 
+struct gfs2_prefetch_work {
+	struct work_struct pw_work;
+	struct gfs2_glock *pw_gl;
+};
+
+static void glock_prefetch_func(struct work_struct *work)
+{
+	struct gfs2_prefetch_work *pw = container_of(work, struct gfs2_prefetch_work,
+						     pw_work);
+	struct gfs2_glock *gl = pw->pw_gl;
+	struct gfs2_holder gh;
+	int error;
+
+	error = gfs2_glock_nq_init(gl, LM_ST_SHARED, LM_FLAG_TRY | GL_SKIP, &gh);
+	if (error == 0)
+		gfs2_glock_dq_uninit(&gh);
+	gfs2_glock_put(gl);
+	kfree(pw);
+}
+
+/**
+ * gfs2_glock_prefetch_num - speculatively acquire a glock in shared mode
+ * @sdp: The GFS2 superblock
+ * @number: the lock number
+ * @glops: The glock_operations to use
+ *
+ * Ask the DLM for @number in shared mode from a worker so that the caller
+ * never waits on the round trip.  The holder is dropped as soon as the
+ * lock is granted; the glock itself then stays cached in LM_ST_SHARED
+ * until another node wants it or the shrinker reclaims it, so a following
+ * gfs2_glock_nq() on it is satisfied without leaving the node.  This is
+ * purely best effort: any failure just means the lock gets acquired on
+ * demand as before.
+ */
+void gfs2_glock_prefetch_num(struct gfs2_sbd *sdp, u64 number,
+			     const struct gfs2_glock_operations *glops)
+{
+	struct gfs2_prefetch_work *pw;
+	struct gfs2_glock *gl;
+	int error;
+
+	error = gfs2_glock_get(sdp, number, glops, CREATE, &gl);
+	if (error)
+		return;
+
+	/* still cached from an earlier acquire, nothing to fetch ahead */
+	if (gl->gl_state != LM_ST_UNLOCKED) {
+		gfs2_glock_put(gl);
+		return;
+	}
+
+	pw = kmalloc(sizeof(*pw), GFP_NOFS);
+	if (!pw) {
+		gfs2_glock_put(gl);
+		return;
+	}
+
+	INIT_WORK(&pw->pw_work, glock_prefetch_func);
+	pw->pw_gl = gl; /* takes over the gfs2_glock_get() reference */
+	queue_work(sdp->sd_delete_wq, &pw->pw_work);
+}
+
 /**
  * __gfs2_holder_init - initialize a struct gfs2_holder in the default way
  * @gl: the glock
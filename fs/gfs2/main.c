@@ -17,6 +17,7 @@
 #include <linux/rculist_bl.h>
 #include <linux/atomic.h>
 #include <linux/mempool.h>
+#include <linux/bio.h>
 
 #include "gfs2.h"
 #include "incore.h"
@@ -171,6 +172,11 @@ static int __init init_gfs2_fs(void)
 	if (!gfs2_page_pool)
 		goto fail_mempool;
 
+	error = bioset_init(&gfs2_log_bio_set, BIO_POOL_SIZE, 0,
+			    BIOSET_NEED_BVECS);
+	if (error)
+		goto fail_bio_set;
+
 	gfs2_register_debugfs();
 	error = register_filesystem(&gfs2_fs_type);
 	if (error)
@@ -188,6 +194,8 @@ static int __init init_gfs2_fs(void)
 fail_fs2:
 	unregister_filesystem(&gfs2_fs_type);
 fail_fs1:
+	bioset_exit(&gfs2_log_bio_set);
+fail_bio_set:
 	mempool_destroy(gfs2_page_pool);
 fail_mempool:
 	destroy_workqueue(gfs2_freeze_wq);
@@ -241,6 +249,7 @@ static void __exit exit_gfs2_fs(void)
 
 	rcu_barrier();
 
+	bioset_exit(&gfs2_log_bio_set);
 	mempool_destroy(gfs2_page_pool);
 	kmem_cache_destroy(gfs2_trans_cachep);
 	kmem_cache_destroy(gfs2_qadata_cachep);
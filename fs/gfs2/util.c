@@ -10,6 +10,7 @@
 #include <linux/completion.h>
 #include <linux/buffer_head.h>
 #include <linux/crc32.h>
+#include <linux/bio.h>
 #include <linux/gfs2_ondisk.h>
 #include <linux/delay.h>
 #include <linux/uaccess.h>
@@ -34,6 +35,7 @@ struct kmem_cache *gfs2_quotad_cachep __read_mostly;
 struct kmem_cache *gfs2_qadata_cachep __read_mostly;
 struct kmem_cache *gfs2_trans_cachep __read_mostly;
 mempool_t *gfs2_page_pool __read_mostly;
+struct bio_set gfs2_log_bio_set;
 
 void gfs2_assert_i(struct gfs2_sbd *sdp)
 {
@@ -175,7 +175,7 @@ int hfsplus_attr_exists(struct inode *inode, const char *name)
 	if (!HFSPLUS_SB(sb)->attr_tree)
 		return 0;
 
-	err = hfs_find_init(HFSPLUS_SB(sb)->attr_tree, &fd);
+	err = hfs_find_init_shared(HFSPLUS_SB(sb)->attr_tree, &fd);
 	if (err)
 		return 0;
 
@@ -12,12 +12,15 @@
 #include <linux/slab.h>
 #include "hfsplus_fs.h"
 
-int hfs_find_init(struct hfs_btree *tree, struct hfs_find_data *fd)
+static int __hfs_find_init(struct hfs_btree *tree, struct hfs_find_data *fd,
+			   bool shared)
 {
+	int subclass;
 	void *ptr;
 
 	fd->tree = tree;
 	fd->bnode = NULL;
+	fd->shared = shared;
 	ptr = kmalloc(tree->max_key_len * 2 + 4, GFP_KERNEL);
 	if (!ptr)
 		return -ENOMEM;
@@ -27,27 +30,49 @@ int hfs_find_init(struct hfs_btree *tree, struct hfs_find_data *fd)
 		tree->cnid, __builtin_return_address(0));
 	switch (tree->cnid) {
 	case HFSPLUS_CAT_CNID:
-		mutex_lock_nested(&tree->tree_lock, CATALOG_BTREE_MUTEX);
+		subclass = CATALOG_BTREE_MUTEX;
 		break;
 	case HFSPLUS_EXT_CNID:
-		mutex_lock_nested(&tree->tree_lock, EXTENTS_BTREE_MUTEX);
+		subclass = EXTENTS_BTREE_MUTEX;
 		break;
 	case HFSPLUS_ATTR_CNID:
-		mutex_lock_nested(&tree->tree_lock, ATTR_BTREE_MUTEX);
+		subclass = ATTR_BTREE_MUTEX;
 		break;
 	default:
 		BUG();
 	}
+	if (shared)
+		down_read_nested(&tree->tree_lock, subclass);
+	else
+		down_write_nested(&tree->tree_lock, subclass);
 	return 0;
 }
 
+int hfs_find_init(struct hfs_btree *tree, struct hfs_find_data *fd)
+{
+	return __hfs_find_init(tree, fd, false);
+}
+
+/*
+ * Take the tree lock shared.  The caller may only traverse the tree
+ * and read records; anything that inserts, removes or writes through
+ * fd->bnode needs hfs_find_init() and the lock exclusive.
+ */
+int hfs_find_init_shared(struct hfs_btree *tree, struct hfs_find_data *fd)
+{
+	return __hfs_find_init(tree, fd, true);
+}
+
 void hfs_find_exit(struct hfs_find_data *fd)
 {
 	hfs_bnode_put(fd->bnode);
 	kfree(fd->search_key);
 	hfs_dbg(BNODE_REFS, "find_exit: %d (%p)\n",
 		fd->tree->cnid, __builtin_return_address(0));
-	mutex_unlock(&fd->tree->tree_lock);
+	if (fd->shared)
+		up_read(&fd->tree->tree_lock);
+	else
+		up_write(&fd->tree->tree_lock);
 	fd->tree = NULL;
 }
 
@@ -190,6 +215,10 @@ int hfs_brec_find(struct hfs_find_data *fd, search_strategy_t do_key_compare)
 			goto invalid;
 		if (bnode->type != (--height ? HFS_NODE_INDEX : HFS_NODE_LEAF))
 			goto invalid;
+		/*
+		 * The path from the root is unique, so concurrent shared
+		 * lookups passing through this node store the same value.
+		 */
 		bnode->parent = parent;
 
 		res = __hfs_brec_find(bnode, fd, do_key_compare);
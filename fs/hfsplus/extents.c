@@ -343,7 +343,7 @@ static int hfsplus_free_extents(struct super_block *sb,
 	int err = 0;
 
 	/* Mapping the allocation file may lock the extent tree */
-	WARN_ON(mutex_is_locked(&HFSPLUS_SB(sb)->ext_tree->tree_lock));
+	WARN_ON(rwsem_is_locked(&HFSPLUS_SB(sb)->ext_tree->tree_lock));
 
 	hfsplus_dump_extent(extent);
 	for (i = 0; i < 8; extent++, i++) {
@@ -426,11 +426,11 @@ int hfsplus_free_fork(struct super_block *sb, u32 cnid,
 		start = be32_to_cpu(fd.key->ext.start_block);
 		hfs_brec_remove(&fd);
 
-		mutex_unlock(&fd.tree->tree_lock);
+		up_write(&fd.tree->tree_lock);
 		hfsplus_free_extents(sb, ext_entry, total_blocks - start,
 				     total_blocks);
 		total_blocks = start;
-		mutex_lock(&fd.tree->tree_lock);
+		down_write(&fd.tree->tree_lock);
 	} while (total_blocks > blocks);
 	hfs_find_exit(&fd);
 
@@ -587,12 +587,12 @@ void hfsplus_file_truncate(struct inode *inode)
 	}
 	while (1) {
 		if (alloc_cnt == hip->first_blocks) {
-			mutex_unlock(&fd.tree->tree_lock);
+			up_write(&fd.tree->tree_lock);
 			hfsplus_free_extents(sb, hip->first_extents,
 					     alloc_cnt, alloc_cnt - blk_cnt);
 			hfsplus_dump_extent(hip->first_extents);
 			hip->first_blocks = blk_cnt;
-			mutex_lock(&fd.tree->tree_lock);
+			down_write(&fd.tree->tree_lock);
 			break;
 		}
 		res = __hfsplus_ext_cache_extent(&fd, inode, alloc_cnt);
@@ -602,11 +602,11 @@ void hfsplus_file_truncate(struct inode *inode)
 		start = hip->cached_start;
 		if (blk_cnt <= start)
 			hfs_brec_remove(&fd);
-		mutex_unlock(&fd.tree->tree_lock);
+		up_write(&fd.tree->tree_lock);
 		hfsplus_free_extents(sb, hip->cached_extents,
 				     alloc_cnt - start, alloc_cnt - blk_cnt);
 		hfsplus_dump_extent(hip->cached_extents);
-		mutex_lock(&fd.tree->tree_lock);
+		down_write(&fd.tree->tree_lock);
 		if (blk_cnt > start) {
 			hip->extent_state |= HFSPLUS_EXT_DIRTY;
 			break;
@@ -19,6 +19,7 @@
 
 #include <linux/fs.h>
 #include <linux/mutex.h>
+#include <linux/rwsem.h>
 #include <linux/buffer_head.h>
 #include <linux/blkdev.h>
 #include "hfsplus_raw.h"
@@ -89,7 +90,12 @@ struct hfs_btree {
 	unsigned int max_key_len;
 	unsigned int depth;
 
-	struct mutex tree_lock;
+	/*
+	 * Taken shared by read-only lookups (lookup, readdir, getxattr)
+	 * and exclusive by anything that modifies the tree or writes
+	 * through an fd.bnode.
+	 */
+	struct rw_semaphore tree_lock;
 
 	unsigned int pages_per_bnode;
 	spinlock_t hash_lock;
@@ -289,6 +295,7 @@ struct hfs_find_data {
 	/* filled by find */
 	struct hfs_btree *tree;
 	struct hfs_bnode *bnode;
+	bool shared;		/* tree_lock held shared */
 	/* filled by findrec */
 	int record;
 	int keyoffset, keylength;
@@ -421,6 +428,7 @@ int hfs_brec_remove(struct hfs_find_data *fd);
 
 /* bfind.c */
 int hfs_find_init(struct hfs_btree *tree, struct hfs_find_data *fd);
+int hfs_find_init_shared(struct hfs_btree *tree, struct hfs_find_data *fd);
 void hfs_find_exit(struct hfs_find_data *fd);
 int hfs_find_1st_rec_by_cnid(struct hfs_bnode *bnode, struct hfs_find_data *fd,
 			     int *begin, int *end, int *cur_rec);
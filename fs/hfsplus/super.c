@@ -77,7 +77,8 @@ struct inode *hfsplus_iget(struct super_block *sb, unsigned long ino)
 
 	if (inode->i_ino >= HFSPLUS_FIRSTUSER_CNID ||
 	    inode->i_ino == HFSPLUS_ROOT_CNID) {
-		err = hfs_find_init(HFSPLUS_SB(inode->i_sb)->cat_tree, &fd);
+		err = hfs_find_init_shared(HFSPLUS_SB(inode->i_sb)->cat_tree,
+					   &fd);
 		if (!err) {
 			err = hfsplus_find_cat(inode->i_sb, inode->i_ino, &fd);
 			if (!err)
@@ -8,6 +8,7 @@
 #include <linux/fs.h>
 #include <linux/iomap.h>
 #include <linux/pagemap.h>
+#include <linux/pagevec.h>
 #include <linux/uio.h>
 #include <linux/buffer_head.h>
 #include <linux/dax.h>
@@ -168,8 +169,23 @@ static void iomap_set_range_uptodate(struct folio *folio,
 		folio_mark_uptodate(folio);
 }
 
+/*
+ * Read bios are allocated out of this pool so that their completion can be
+ * punted to process context without a separate allocation.
+ */
+static struct bio_set iomap_read_bioset;
+static struct workqueue_struct *iomap_read_wq;
+
+struct iomap_read_ioend {
+	struct work_struct	work;	/* completion work (punted bios) */
+	struct bio		bio;	/* must be last */
+};
+
+/* Punt completions spanning more than this many bio segments to a worker */
+#define IOMAP_READ_PUNT_SEGS	8
+
 static void iomap_finish_folio_read(struct folio *folio, size_t offset,
-		size_t len, int error)
+		size_t len, int error, struct folio_batch *fbatch)
 {
 	struct iomap_page *iop = to_iomap_page(folio);
 
@@ -180,20 +196,68 @@ static void iomap_finish_folio_read(struct folio *folio, size_t offset,
 		iomap_set_range_uptodate(folio, iop, offset, len);
 	}
 
-	if (!iop || atomic_sub_and_test(len, &iop->read_bytes_pending))
-		folio_unlock(folio);
+	if (!iop || atomic_sub_and_test(len, &iop->read_bytes_pending)) {
+		if (!folio_batch_add(fbatch, folio)) {
+			unsigned int i;
+
+			for (i = 0; i < folio_batch_count(fbatch); i++)
+				folio_unlock(fbatch->folios[i]);
+			folio_batch_reinit(fbatch);
+			folio_batch_add(fbatch, folio);
+		}
+	}
 }
 
-static void iomap_read_end_io(struct bio *bio)
+static void iomap_read_finish_bio(struct bio *bio)
 {
 	int error = blk_status_to_errno(bio->bi_status);
+	struct folio_batch fbatch;
 	struct folio_iter fi;
+	unsigned int i;
 
+	/*
+	 * Mark all ranges uptodate first and unlock the completed folios in
+	 * one go at the end, so waiters are woken in bulk instead of
+	 * interleaved with the per-folio completion bookkeeping.  No
+	 * references are held on the batched folios; their locks keep them
+	 * stable until they are unlocked here.
+	 */
+	folio_batch_init(&fbatch);
 	bio_for_each_folio_all(fi, bio)
-		iomap_finish_folio_read(fi.folio, fi.offset, fi.length, error);
+		iomap_finish_folio_read(fi.folio, fi.offset, fi.length, error,
+					&fbatch);
+	for (i = 0; i < folio_batch_count(&fbatch); i++)
+		folio_unlock(fbatch.folios[i]);
 	bio_put(bio);
 }
 
+static void iomap_read_work(struct work_struct *work)
+{
+	struct iomap_read_ioend *ioend =
+		container_of(work, struct iomap_read_ioend, work);
+
+	iomap_read_finish_bio(&ioend->bio);
+}
+
+static void iomap_read_end_io(struct bio *bio)
+{
+	struct iomap_read_ioend *ioend =
+		container_of(bio, struct iomap_read_ioend, bio);
+
+	/*
+	 * Large completions are punted out of the softirq to a per-CPU
+	 * worker, keeping interrupt-off time bounded regardless of the
+	 * readahead window.  Small (typically synchronous) reads complete
+	 * inline to avoid the context switch latency.
+	 */
+	if (bio->bi_vcnt > IOMAP_READ_PUNT_SEGS) {
+		INIT_WORK(&ioend->work, iomap_read_work);
+		queue_work(iomap_read_wq, &ioend->work);
+	} else {
+		iomap_read_finish_bio(bio);
+	}
+}
+
 struct iomap_readpage_ctx {
 	struct folio		*cur_folio;
 	bool			cur_folio_in_bio;
@@ -297,16 +361,18 @@ static loff_t iomap_readpage_iter(const struct iomap_iter *iter,
 
 		if (ctx->rac) /* same as readahead_gfp_mask */
 			gfp |= __GFP_NORETRY | __GFP_NOWARN;
-		ctx->bio = bio_alloc(iomap->bdev, bio_max_segs(nr_vecs),
-				     REQ_OP_READ, gfp);
+		ctx->bio = bio_alloc_bioset(iomap->bdev, bio_max_segs(nr_vecs),
+					    REQ_OP_READ, gfp,
+					    &iomap_read_bioset);
 		/*
 		 * If the bio_alloc fails, try it again for a single page to
 		 * avoid having to deal with partial page reads.  This emulates
 		 * what do_mpage_read_folio does.
 		 */
 		if (!ctx->bio) {
-			ctx->bio = bio_alloc(iomap->bdev, 1, REQ_OP_READ,
-					     orig_gfp);
+			ctx->bio = bio_alloc_bioset(iomap->bdev, 1,
+						    REQ_OP_READ, orig_gfp,
+						    &iomap_read_bioset);
 		}
 		if (ctx->rac)
 			ctx->bio->bi_opf |= REQ_RAHEAD;
@@ -1814,20 +1880,56 @@ iomap_writepages(struct address_space *mapping, struct writeback_control *wbc,
 		struct iomap_writepage_ctx *wpc,
 		const struct iomap_writeback_ops *ops)
 {
+	struct blk_plug		plug;
 	int			ret;
 
+	/*
+	 * Plug the whole pass so the bios of all ioends built here are held
+	 * back and sorted and merged by sector in the block layer before
+	 * dispatch, instead of being sent off one by one as the page cache
+	 * walk finds extent boundaries.  The background writeback thread
+	 * plugs around whole inode batches already; this covers the direct
+	 * reclaim and fsync entry points, where storms of small-file fsyncs
+	 * otherwise hit the device as many tiny interleaved writes.
+	 */
+	blk_start_plug(&plug);
 	wpc->ops = ops;
 	ret = write_cache_pages(mapping, wbc, iomap_do_writepage, wpc);
-	if (!wpc->ioend)
-		return ret;
-	return iomap_submit_ioend(wpc, wpc->ioend, ret);
+	if (wpc->ioend)
+		ret = iomap_submit_ioend(wpc, wpc->ioend, ret);
+	blk_finish_plug(&plug);
+	return ret;
 }
 EXPORT_SYMBOL_GPL(iomap_writepages);
 
 static int __init iomap_init(void)
 {
-	return bioset_init(&iomap_ioend_bioset, 4 * (PAGE_SIZE / SECTOR_SIZE),
-			   offsetof(struct iomap_ioend, io_inline_bio),
-			   BIOSET_NEED_BVECS);
+	int ret;
+
+	ret = bioset_init(&iomap_read_bioset, 4 * (PAGE_SIZE / SECTOR_SIZE),
+			  offsetof(struct iomap_read_ioend, bio),
+			  BIOSET_NEED_BVECS);
+	if (ret)
+		return ret;
+
+	iomap_read_wq = alloc_workqueue("iomap-read", WQ_HIGHPRI, 0);
+	if (!iomap_read_wq) {
+		ret = -ENOMEM;
+		goto out_bioset;
+	}
+
+	ret = bioset_init(&iomap_ioend_bioset, 4 * (PAGE_SIZE / SECTOR_SIZE),
+			  offsetof(struct iomap_ioend, io_inline_bio),
+			  BIOSET_NEED_BVECS);
+	if (ret)
+		goto out_wq;
+
+	return 0;
+
+out_wq:
+	destroy_workqueue(iomap_read_wq);
+out_bioset:
+	bioset_exit(&iomap_read_bioset);
+	return ret;
 }
 fs_initcall(iomap_init);
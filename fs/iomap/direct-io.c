@@ -20,6 +20,7 @@
  * Private flags for iomap_dio, must not overlap with the public ones in
  * iomap.h:
  */
+#define IOMAP_DIO_SUBBLOCK_RMW	(1 << 27)
 #define IOMAP_DIO_WRITE_FUA	(1 << 28)
 #define IOMAP_DIO_NEED_SYNC	(1 << 29)
 #define IOMAP_DIO_WRITE		(1 << 30)
@@ -229,6 +230,84 @@ static inline blk_opf_t iomap_dio_bio_opflags(struct iomap_dio *dio,
 	return opflags;
 }
 
+/*
+ * Service a write that is not aligned to the device logical block size by
+ * reading the containing block into a bounce page, merging in the new data
+ * and writing the block back, all synchronously.  At most one logical
+ * block is consumed per call; the remainder of the request comes back
+ * through the regular aligned path on the next iteration.
+ *
+ * Overlapping sub-block writers are serialized by the exclusive inode
+ * lock that callers opting into IOMAP_DIO_SUBBLOCK must hold for writes.
+ */
+static loff_t iomap_dio_subblock_iter(const struct iomap_iter *iter,
+		struct iomap_dio *dio)
+{
+	const struct iomap *iomap = &iter->iomap;
+	unsigned int lbs = bdev_logical_block_size(iomap->bdev);
+	loff_t pos = iter->pos;
+	loff_t blk_pos = round_down(pos, lbs);
+	size_t off = pos - blk_pos;
+	size_t len = min_t(loff_t, iomap_length(iter), lbs - off);
+	struct bio_vec bvec;
+	struct page *page;
+	struct bio bio;
+	int ret;
+
+	/*
+	 * Only plain overwrites of allocated blocks can be emulated: holes,
+	 * unwritten extents and shared blocks would need post-I/O extent
+	 * conversion at block granularity, which a partial block write
+	 * cannot provide.
+	 */
+	if (iomap->type != IOMAP_MAPPED ||
+	    (iomap->flags & (IOMAP_F_SHARED | IOMAP_F_NEW)))
+		return -EINVAL;
+
+	if (iter->flags & IOMAP_NOWAIT)
+		return -EAGAIN;
+
+	if (WARN_ON_ONCE(lbs > PAGE_SIZE))
+		return -EINVAL;
+
+	WARN_ON_ONCE(!rwsem_is_locked(&iter->inode->i_rwsem));
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	bio_init(&bio, iomap->bdev, &bvec, 1, REQ_OP_READ);
+	bio.bi_iter.bi_sector = iomap_sector(iomap, blk_pos);
+	__bio_add_page(&bio, page, lbs, 0);
+	ret = submit_bio_wait(&bio);
+	if (ret)
+		goto out_free;
+
+	if (copy_from_iter(page_address(page) + off, len,
+			   dio->submit.iter) != len) {
+		ret = -EFAULT;
+		goto out_free;
+	}
+
+	bio_init(&bio, iomap->bdev, &bvec, 1,
+		 REQ_OP_WRITE | REQ_SYNC | REQ_IDLE);
+	bio.bi_iter.bi_sector = iomap_sector(iomap, blk_pos);
+	__bio_add_page(&bio, page, lbs, 0);
+	ret = submit_bio_wait(&bio);
+	if (ret)
+		goto out_free;
+
+	/* This was not a pure data overwrite from the device's view */
+	dio->flags &= ~IOMAP_DIO_WRITE_FUA;
+
+	task_io_account_write(len);
+	dio->size += len;
+
+out_free:
+	__free_page(page);
+	return ret ?: len;
+}
+
 static loff_t iomap_dio_bio_iter(const struct iomap_iter *iter,
 		struct iomap_dio *dio)
 {
@@ -246,8 +325,11 @@ static loff_t iomap_dio_bio_iter(const struct iomap_iter *iter,
 	size_t orig_count;
 
 	if ((pos | length) & (bdev_logical_block_size(iomap->bdev) - 1) ||
-	    !bdev_iter_is_aligned(iomap->bdev, dio->submit.iter))
+	    !bdev_iter_is_aligned(iomap->bdev, dio->submit.iter)) {
+		if (dio->flags & IOMAP_DIO_SUBBLOCK_RMW)
+			return iomap_dio_subblock_iter(iter, dio);
 		return -EINVAL;
+	}
 
 	if (iomap->type == IOMAP_UNWRITTEN) {
 		dio->flags |= IOMAP_DIO_UNWRITTEN;
@@ -531,6 +613,8 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	} else {
 		iomi.flags |= IOMAP_WRITE;
 		dio->flags |= IOMAP_DIO_WRITE;
+		if (dio_flags & IOMAP_DIO_SUBBLOCK)
+			dio->flags |= IOMAP_DIO_SUBBLOCK_RMW;
 
 		if (iocb->ki_flags & IOCB_NOWAIT) {
 			if (filemap_range_has_page(mapping, iomi.pos, end)) {
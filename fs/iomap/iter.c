@@ -44,6 +44,87 @@ static inline int iomap_iter_advance(struct iomap_iter *iter)
 	return 1;
 }
 
+void iomap_extent_cache_init(struct iomap_extent_cache *cache)
+{
+	spin_lock_init(&cache->lock);
+	cache->valid = false;
+}
+EXPORT_SYMBOL_GPL(iomap_extent_cache_init);
+
+void iomap_extent_cache_invalidate(struct iomap_extent_cache *cache)
+{
+	spin_lock(&cache->lock);
+	cache->valid = false;
+	spin_unlock(&cache->lock);
+}
+EXPORT_SYMBOL_GPL(iomap_extent_cache_invalidate);
+
+/*
+ * The cache can only serve iterations that neither modify the mapping nor
+ * need an ->iomap_end call to balance the skipped ->iomap_begin.
+ */
+static inline struct iomap_extent_cache *
+iomap_iter_extent_cache(const struct iomap_iter *iter,
+		const struct iomap_ops *ops)
+{
+	if (!ops->get_extent_cache || ops->iomap_end)
+		return NULL;
+	if (iter->flags & (IOMAP_WRITE | IOMAP_ZERO | IOMAP_UNSHARE))
+		return NULL;
+	return ops->get_extent_cache(iter->inode);
+}
+
+static bool iomap_iter_cache_lookup(struct iomap_iter *iter,
+		struct iomap_extent_cache *cache)
+{
+	bool hit = false;
+
+	spin_lock(&cache->lock);
+	if (cache->valid && cache->iomap.offset <= iter->pos &&
+	    iter->pos < cache->iomap.offset + cache->iomap.length) {
+		iter->iomap = cache->iomap;
+		hit = true;
+	}
+	spin_unlock(&cache->lock);
+
+	if (!hit)
+		return false;
+
+	/*
+	 * The extent may have changed since the mapping was cached; check
+	 * the validity cookie before using it and remap on failure.  Only
+	 * mappings with an .iomap_valid operation are ever stored, so the
+	 * callback is guaranteed to be there.
+	 */
+	if (!iter->iomap.folio_ops->iomap_valid(iter->inode, &iter->iomap)) {
+		iomap_extent_cache_invalidate(cache);
+		memset(&iter->iomap, 0, sizeof(iter->iomap));
+		return false;
+	}
+	return true;
+}
+
+static void iomap_iter_cache_store(struct iomap_iter *iter,
+		struct iomap_extent_cache *cache)
+{
+	/*
+	 * Without a validity cookie a cached mapping could never be trusted
+	 * again, and inline mappings point into filesystem-private buffers
+	 * whose lifetime ends with the iteration.  Source maps only show up
+	 * for sharing/CoW cases which are excluded from caching anyway.
+	 */
+	if (!iter->iomap.folio_ops || !iter->iomap.folio_ops->iomap_valid)
+		return;
+	if (iter->iomap.type == IOMAP_INLINE ||
+	    iter->srcmap.type != IOMAP_HOLE)
+		return;
+
+	spin_lock(&cache->lock);
+	cache->iomap = iter->iomap;
+	cache->valid = true;
+	spin_unlock(&cache->lock);
+}
+
 static inline void iomap_iter_done(struct iomap_iter *iter)
 {
 	WARN_ON_ONCE(iter->iomap.offset > iter->pos);
@@ -73,6 +154,7 @@ static inline void iomap_iter_done(struct iomap_iter *iter)
  */
 int iomap_iter(struct iomap_iter *iter, const struct iomap_ops *ops)
 {
+	struct iomap_extent_cache *cache;
 	int ret;
 
 	if (iter->iomap.length && ops->iomap_end) {
@@ -88,10 +170,17 @@ int iomap_iter(struct iomap_iter *iter, const struct iomap_ops *ops)
 	if (ret <= 0)
 		return ret;
 
+	cache = iomap_iter_extent_cache(iter, ops);
+	if (cache && iomap_iter_cache_lookup(iter, cache))
+		goto done;
+
 	ret = ops->iomap_begin(iter->inode, iter->pos, iter->len, iter->flags,
 			       &iter->iomap, &iter->srcmap);
 	if (ret < 0)
 		return ret;
+	if (cache)
+		iomap_iter_cache_store(iter, cache);
+done:
 	iomap_iter_done(iter);
 	return 1;
 }
@@ -111,12 +111,14 @@ int jffs2_scan_medium(struct jffs2_sb_info *c)
 		jffs2_dbg(1, "MTD point failed %d\n", ret);
 #endif
 	if (!flashbuf) {
-		/* For NAND it's quicker to read a whole eraseblock at a time,
-		   apparently */
-		if (jffs2_cleanmarker_oob(c))
-			try_size = c->sector_size;
-		else
-			try_size = PAGE_SIZE;
+		/*
+		 * Reading a whole eraseblock at a time is quicker on any
+		 * flash type: it saves one read call per node otherwise
+		 * spanning the buffer boundary, and lets a summary-less
+		 * scan walk each block out of a single read.  The helper
+		 * falls back to smaller allocations when memory is tight.
+		 */
+		try_size = c->sector_size;
 
 		jffs2_dbg(1, "Trying to allocate readbuf of %zu "
 			  "bytes\n", try_size);
@@ -36,12 +36,74 @@ void ksmbd_conn_free(struct ksmbd_conn *conn)
 	list_del(&conn->conns_list);
 	write_unlock(&conn_list_lock);
 
+	while (conn->nr_payload_bufs)
+		kvfree(conn->payload_buf[--conn->nr_payload_bufs]);
 	xa_destroy(&conn->sessions);
 	kvfree(conn->request_buf);
 	kfree(conn->preauth_info);
 	kfree(conn);
 }
 
+/**
+ * ksmbd_conn_get_payload_buf() - get a large I/O payload buffer
+ * @conn:	connection instance
+ * @size:	payload byte count needed
+ * @pooled:	set when the buffer belongs to the connection's pool
+ *
+ * Large reads and writes churn a multi-megabyte allocation per request.
+ * Cache a few buffers of the negotiated maximum I/O size per connection
+ * and hand them out for any payload that fits; the caller must return a
+ * pooled buffer with ksmbd_conn_put_payload_buf().  Pooled buffers are
+ * not zeroed, callers send out no more than they filled in.
+ *
+ * Return:	buffer on success, otherwise NULL
+ */
+void *ksmbd_conn_get_payload_buf(struct ksmbd_conn *conn, size_t size,
+				 bool *pooled)
+{
+	void *buf = NULL;
+
+	spin_lock(&conn->payload_buf_lock);
+	if (!conn->payload_buf_size)
+		conn->payload_buf_size = max(conn->vals->max_read_size,
+					     conn->vals->max_write_size);
+	if (size <= conn->payload_buf_size) {
+		if (conn->nr_payload_bufs)
+			buf = conn->payload_buf[--conn->nr_payload_bufs];
+		size = conn->payload_buf_size;
+		*pooled = true;
+	} else {
+		*pooled = false;
+	}
+	spin_unlock(&conn->payload_buf_lock);
+
+	if (!buf)
+		buf = kvmalloc(size, GFP_KERNEL);
+	if (!buf)
+		*pooled = false;
+	return buf;
+}
+
+/**
+ * ksmbd_conn_put_payload_buf() - release a large I/O payload buffer
+ * @conn:	connection instance
+ * @buf:	buffer from ksmbd_conn_get_payload_buf(), may be NULL
+ * @pooled:	pooled flag returned by ksmbd_conn_get_payload_buf()
+ */
+void ksmbd_conn_put_payload_buf(struct ksmbd_conn *conn, void *buf,
+				bool pooled)
+{
+	if (buf && pooled) {
+		spin_lock(&conn->payload_buf_lock);
+		if (conn->nr_payload_bufs < KSMBD_PAYLOAD_BUF_POOL_SIZE) {
+			conn->payload_buf[conn->nr_payload_bufs++] = buf;
+			buf = NULL;
+		}
+		spin_unlock(&conn->payload_buf_lock);
+	}
+	kvfree(buf);
+}
+
 /**
  * ksmbd_conn_alloc() - initialize a new connection instance
  *
@@ -78,6 +140,7 @@ struct ksmbd_conn *ksmbd_conn_alloc(void)
 	INIT_LIST_HEAD(&conn->async_requests);
 	spin_lock_init(&conn->request_lock);
 	spin_lock_init(&conn->credits_lock);
+	spin_lock_init(&conn->payload_buf_lock);
 	ida_init(&conn->async_ida);
 	xa_init(&conn->sessions);
 
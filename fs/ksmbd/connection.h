@@ -21,6 +21,8 @@
 
 #define KSMBD_SOCKET_BACKLOG		16
 
+#define KSMBD_PAYLOAD_BUF_POOL_SIZE	4
+
 enum {
 	KSMBD_SESS_NEW = 0,
 	KSMBD_SESS_GOOD,
@@ -97,6 +99,12 @@ struct ksmbd_conn {
 	/* Identifier for async message */
 	struct ida			async_ida;
 
+	/* Cache of large I/O payload buffers */
+	spinlock_t			payload_buf_lock;
+	void				*payload_buf[KSMBD_PAYLOAD_BUF_POOL_SIZE];
+	unsigned int			nr_payload_bufs;
+	size_t				payload_buf_size;
+
 	__le16				cipher_type;
 	__le16				compress_algorithm;
 	bool				posix_ext_supported;
@@ -147,6 +155,10 @@ void ksmbd_conn_wait_idle(struct ksmbd_conn *conn);
 struct ksmbd_conn *ksmbd_conn_alloc(void);
 void ksmbd_conn_free(struct ksmbd_conn *conn);
 bool ksmbd_conn_lookup_dialect(struct ksmbd_conn *c);
+void *ksmbd_conn_get_payload_buf(struct ksmbd_conn *conn, size_t size,
+				 bool *pooled);
+void ksmbd_conn_put_payload_buf(struct ksmbd_conn *conn, void *buf,
+				bool pooled);
 int ksmbd_conn_write(struct ksmbd_work *work);
 int ksmbd_conn_rdma_read(struct ksmbd_conn *conn,
 			 void *buf, unsigned int buflen,
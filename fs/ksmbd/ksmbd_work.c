@@ -36,7 +36,11 @@ void ksmbd_free_work_struct(struct ksmbd_work *work)
 	WARN_ON(work->saved_cred != NULL);
 
 	kvfree(work->response_buf);
-	kvfree(work->aux_payload_buf);
+	if (work->pooled_payload)
+		ksmbd_conn_put_payload_buf(work->conn, work->aux_payload_buf,
+					   true);
+	else
+		kvfree(work->aux_payload_buf);
 	kfree(work->tr_buf);
 	kvfree(work->request_buf);
 	if (work->async_id)
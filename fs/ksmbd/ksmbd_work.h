@@ -70,6 +70,8 @@ struct ksmbd_work {
 	/* Is this SYNC or ASYNC ksmbd_work */
 	bool                            synchronous:1;
 	bool                            need_invalidate_rkey:1;
+	/* aux_payload_buf belongs to conn's payload buffer pool */
+	bool                            pooled_payload:1;
 
 	unsigned int                    remote_key;
 	/* cancel works */
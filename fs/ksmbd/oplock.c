@@ -5,6 +5,8 @@
  */
 
 #include <linux/moduleparam.h>
+#include <linux/hashtable.h>
+#include <linux/jhash.h>
 
 #include "glob.h"
 #include "oplock.h"
@@ -16,9 +18,30 @@
 #include "mgmt/share_config.h"
 #include "mgmt/tree_connect.h"
 
-static LIST_HEAD(lease_table_list);
+#define LEASE_TABLE_HASH_BITS	6
+
+static DEFINE_HASHTABLE(lease_table_hash, LEASE_TABLE_HASH_BITS);
 static DEFINE_RWLOCK(lease_list_lock);
 
+static u32 lb_hash(char *client_guid)
+{
+	return jhash(client_guid, SMB2_CLIENT_GUID_SIZE, 0);
+}
+
+/* find the client's lease table, caller must hold lease_list_lock */
+static struct lease_table *lb_lookup(char *client_guid)
+{
+	struct lease_table *lb;
+
+	hash_for_each_possible(lease_table_hash, lb, l_entry,
+			       lb_hash(client_guid)) {
+		if (!memcmp(lb->client_guid, client_guid,
+			    SMB2_CLIENT_GUID_SIZE))
+			return lb;
+	}
+	return NULL;
+}
+
 /**
  * alloc_opinfo() - allocate a new opinfo object for oplock info
  * @work:	smb work
@@ -85,7 +108,7 @@ static void lease_del_list(struct oplock_info *opinfo)
 static void lb_add(struct lease_table *lb)
 {
 	write_lock(&lease_list_lock);
-	list_add(&lb->l_entry, &lease_table_list);
+	hash_add(lease_table_hash, &lb->l_entry, lb_hash(lb->client_guid));
 	write_unlock(&lease_list_lock);
 }
 
@@ -713,7 +736,13 @@ static int smb2_oplock_break_noti(struct oplock_info *opinfo)
 
 		wait_for_break_ack(opinfo);
 	} else {
-		__smb2_oplock_break_noti(&work->work);
+		/*
+		 * No ack is expected and the break state is snapshotted in
+		 * br_info, so send the notification from the workqueue
+		 * instead of stalling this request on the socket write.
+		 */
+		INIT_WORK(&work->work, __smb2_oplock_break_noti);
+		ksmbd_queue_work(work);
 		if (opinfo->level == SMB2_OPLOCK_LEVEL_II)
 			opinfo->level = SMB2_OPLOCK_LEVEL_NONE;
 	}
@@ -837,7 +866,11 @@ static int smb2_lease_break_noti(struct oplock_info *opinfo)
 		ksmbd_queue_work(work);
 		wait_for_break_ack(opinfo);
 	} else {
-		__smb2_lease_break_noti(&work->work);
+		/* as above, no-ack notifications don't need to be sent
+		 * synchronously
+		 */
+		INIT_WORK(&work->work, __smb2_lease_break_noti);
+		ksmbd_queue_work(work);
 		if (opinfo->o_lease->new_state == SMB2_LEASE_NONE_LE) {
 			opinfo->level = SMB2_OPLOCK_LEVEL_NONE;
 			opinfo->o_lease->state = SMB2_LEASE_NONE_LE;
@@ -935,32 +968,46 @@ static int oplock_break(struct oplock_info *brk_opinfo, int req_op_level)
 	return err;
 }
 
-void destroy_lease_table(struct ksmbd_conn *conn)
+static void lb_destroy(struct lease_table *lb)
 {
-	struct lease_table *lb, *lbtmp;
 	struct oplock_info *opinfo;
 
+again:
+	rcu_read_lock();
+	list_for_each_entry_rcu(opinfo, &lb->lease_list,
+				lease_entry) {
+		rcu_read_unlock();
+		lease_del_list(opinfo);
+		goto again;
+	}
+	rcu_read_unlock();
+	hash_del(&lb->l_entry);
+	kfree(lb);
+}
+
+void destroy_lease_table(struct ksmbd_conn *conn)
+{
+	struct lease_table *lb;
+	struct hlist_node *tmp;
+	int bkt;
+
 	write_lock(&lease_list_lock);
-	if (list_empty(&lease_table_list)) {
+	if (hash_empty(lease_table_hash)) {
 		write_unlock(&lease_list_lock);
 		return;
 	}
 
-	list_for_each_entry_safe(lb, lbtmp, &lease_table_list, l_entry) {
-		if (conn && memcmp(lb->client_guid, conn->ClientGUID,
-				   SMB2_CLIENT_GUID_SIZE))
-			continue;
-again:
-		rcu_read_lock();
-		list_for_each_entry_rcu(opinfo, &lb->lease_list,
-					lease_entry) {
-			rcu_read_unlock();
-			lease_del_list(opinfo);
-			goto again;
+	if (conn) {
+		hash_for_each_possible_safe(lease_table_hash, lb, tmp,
+					    l_entry,
+					    lb_hash(conn->ClientGUID)) {
+			if (!memcmp(lb->client_guid, conn->ClientGUID,
+				    SMB2_CLIENT_GUID_SIZE))
+				lb_destroy(lb);
 		}
-		rcu_read_unlock();
-		list_del(&lb->l_entry);
-		kfree(lb);
+	} else {
+		hash_for_each_safe(lease_table_hash, bkt, tmp, lb, l_entry)
+			lb_destroy(lb);
 	}
 	write_unlock(&lease_list_lock);
 }
@@ -976,21 +1023,12 @@ int find_same_lease_key(struct ksmbd_session *sess, struct ksmbd_inode *ci,
 		return err;
 
 	read_lock(&lease_list_lock);
-	if (list_empty(&lease_table_list)) {
+	lb = lb_lookup(sess->ClientGUID);
+	if (!lb) {
 		read_unlock(&lease_list_lock);
 		return 0;
 	}
 
-	list_for_each_entry(lb, &lease_table_list, l_entry) {
-		if (!memcmp(lb->client_guid, sess->ClientGUID,
-			    SMB2_CLIENT_GUID_SIZE))
-			goto found;
-	}
-	read_unlock(&lease_list_lock);
-
-	return 0;
-
-found:
 	rcu_read_lock();
 	list_for_each_entry_rcu(opinfo, &lb->lease_list, lease_entry) {
 		if (!atomic_inc_not_zero(&opinfo->refcount))
@@ -1036,14 +1074,12 @@ static int add_lease_global_list(struct oplock_info *opinfo)
 	struct lease_table *lb;
 
 	read_lock(&lease_list_lock);
-	list_for_each_entry(lb, &lease_table_list, l_entry) {
-		if (!memcmp(lb->client_guid, opinfo->conn->ClientGUID,
-			    SMB2_CLIENT_GUID_SIZE)) {
-			opinfo->o_lease->l_lb = lb;
-			lease_add_list(opinfo);
-			read_unlock(&lease_list_lock);
-			return 0;
-		}
+	lb = lb_lookup(opinfo->conn->ClientGUID);
+	if (lb) {
+		opinfo->o_lease->l_lb = lb;
+		lease_add_list(opinfo);
+		read_unlock(&lease_list_lock);
+		return 0;
 	}
 	read_unlock(&lease_list_lock);
 
@@ -1163,6 +1199,21 @@ int smb_grant_oplock(struct ksmbd_work *work, int req_op_level, u64 pid,
 		goto op_break_not_needed;
 	}
 
+	/*
+	 * An open that only wants read caching doesn't have to wait for a
+	 * pending break ack: the previous lease is already on its way to
+	 * a read-caching (or weaker) state, which covers the request.
+	 */
+	if (prev_op_has_lease &&
+	    prev_opinfo->op_state == OPLOCK_ACK_WAIT &&
+	    atomic_read(&prev_opinfo->breaking_cnt) &&
+	    (prev_opinfo->o_lease->new_state & SMB2_LEASE_READ_CACHING_LE) &&
+	    (!lctx || !(lctx->req_state & (SMB2_LEASE_WRITE_CACHING_LE |
+					   SMB2_LEASE_HANDLE_CACHING_LE)))) {
+		opinfo_put(prev_opinfo);
+		goto op_break_not_needed;
+	}
+
 	list_add(&work->interim_entry, &prev_opinfo->interim_list);
 	err = oplock_break(prev_opinfo, SMB2_OPLOCK_LEVEL_II);
 	opinfo_put(prev_opinfo);
@@ -1677,16 +1728,12 @@ struct oplock_info *lookup_lease_in_table(struct ksmbd_conn *conn,
 	int ret;
 
 	read_lock(&lease_list_lock);
-	list_for_each_entry(lt, &lease_table_list, l_entry) {
-		if (!memcmp(lt->client_guid, conn->ClientGUID,
-			    SMB2_CLIENT_GUID_SIZE))
-			goto found;
+	lt = lb_lookup(conn->ClientGUID);
+	if (!lt) {
+		read_unlock(&lease_list_lock);
+		return NULL;
 	}
 
-	read_unlock(&lease_list_lock);
-	return NULL;
-
-found:
 	rcu_read_lock();
 	list_for_each_entry_rcu(opinfo, &lt->lease_list, lease_entry) {
 		if (!atomic_inc_not_zero(&opinfo->refcount))
@@ -40,7 +40,7 @@ struct lease_ctx_info {
 struct lease_table {
 	char			client_guid[SMB2_CLIENT_GUID_SIZE];
 	struct list_head	lease_list;
-	struct list_head	l_entry;
+	struct hlist_node	l_entry;
 	spinlock_t		lb_lock;
 };
 
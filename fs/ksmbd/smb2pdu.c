@@ -6276,7 +6276,8 @@ int smb2_read(struct ksmbd_work *work)
 	ksmbd_debug(SMB, "filename %pD, offset %lld, len %zu\n",
 		    fp->filp, offset, length);
 
-	work->aux_payload_buf = kvmalloc(length, GFP_KERNEL | __GFP_ZERO);
+	work->aux_payload_buf = ksmbd_conn_get_payload_buf(conn, length,
+							   &work->pooled_payload);
 	if (!work->aux_payload_buf) {
 		err = -ENOMEM;
 		goto out;
@@ -6289,8 +6290,10 @@ int smb2_read(struct ksmbd_work *work)
 	}
 
 	if ((nbytes == 0 && length != 0) || nbytes < mincount) {
-		kvfree(work->aux_payload_buf);
+		ksmbd_conn_put_payload_buf(conn, work->aux_payload_buf,
+					   work->pooled_payload);
 		work->aux_payload_buf = NULL;
+		work->pooled_payload = false;
 		rsp->hdr.Status = STATUS_END_OF_FILE;
 		smb2_set_err_rsp(work);
 		ksmbd_fd_put(work, fp);
@@ -6305,8 +6308,10 @@ int smb2_read(struct ksmbd_work *work)
 		remain_bytes = smb2_read_rdma_channel(work, req,
 						      work->aux_payload_buf,
 						      nbytes);
-		kvfree(work->aux_payload_buf);
+		ksmbd_conn_put_payload_buf(conn, work->aux_payload_buf,
+					   work->pooled_payload);
 		work->aux_payload_buf = NULL;
+		work->pooled_payload = false;
 
 		nbytes = 0;
 		if (remain_bytes < 0) {
@@ -1360,7 +1360,7 @@ static int smb_direct_rdma_xmit(struct smb_direct_transport *t,
 				bool is_read)
 {
 	struct smb_direct_rdma_rw_msg *msg, *next_msg;
-	int i, ret;
+	int i, ret, nr_msgs = 0;
 	DECLARE_COMPLETION_ONSTACK(completion);
 	struct ib_send_wr *first_wr;
 	LIST_HEAD(msg_list);
@@ -1442,6 +1442,7 @@ static int smb_direct_rdma_xmit(struct smb_direct_transport *t,
 		}
 
 		list_add_tail(&msg->list, &msg_list);
+		nr_msgs++;
 		desc_buf += desc_buf_len;
 	}
 
@@ -1458,9 +1459,22 @@ static int smb_direct_rdma_xmit(struct smb_direct_transport *t,
 		goto out;
 	}
 
-	msg = list_last_entry(&msg_list, struct smb_direct_rdma_rw_msg, list);
-	wait_for_completion(&completion);
-	ret = msg->status;
+	/*
+	 * All descriptors stream in flight as one chain.  Each rdma_rw ctx
+	 * signals the shared completion on its own, so consume one
+	 * completion per descriptor instead of returning (and freeing the
+	 * contexts) when the first one finishes.
+	 */
+	for (i = 0; i < nr_msgs; i++)
+		wait_for_completion(&completion);
+
+	ret = 0;
+	list_for_each_entry(msg, &msg_list, list) {
+		if (msg->status) {
+			ret = msg->status;
+			break;
+		}
+	}
 out:
 	list_for_each_entry_safe(msg, next_msg, &msg_list, list) {
 		list_del(&msg->list);
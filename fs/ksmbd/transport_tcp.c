@@ -5,6 +5,7 @@
  */
 
 #include <linux/freezer.h>
+#include <linux/cpumask.h>
 
 #include "smb_common.h"
 #include "server.h"
@@ -171,6 +172,36 @@ static unsigned short ksmbd_tcp_get_port(const struct sockaddr *sa)
 	return 0;
 }
 
+/**
+ * ksmbd_tcp_bind_rss_cpu() - pin a conn thread to the flow's RSS cpu
+ * @t:		tcp transport instance
+ * @handler:	conn thread, created but not yet running
+ *
+ * Pin the handler to the CPU the NIC's RSS steering delivers this flow
+ * to, so request processing and the work items queued from it (which run
+ * on the local CPU) stay aligned with the softirq processing of the
+ * channel.  Channels of a multichannel session hash to different RSS
+ * queues and therefore spread across cores.  If the steering CPU is
+ * unknown, spread handlers round-robin across online CPUs instead.
+ */
+static void ksmbd_tcp_bind_rss_cpu(struct tcp_transport *t,
+				   struct task_struct *handler)
+{
+	static atomic_t conn_rr;
+	int cpu = READ_ONCE(t->sock->sk->sk_incoming_cpu);
+
+	if (cpu < 0 || cpu >= nr_cpu_ids || !cpu_online(cpu)) {
+		unsigned int n;
+
+		n = atomic_inc_return(&conn_rr) % num_online_cpus();
+		for_each_online_cpu(cpu)
+			if (n-- == 0)
+				break;
+	}
+
+	set_cpus_allowed_ptr(handler, cpumask_of(cpu));
+}
+
 /**
  * ksmbd_tcp_new_connection() - create a new tcp session on mount
  * @client_sk:	socket associated with new connection
@@ -199,16 +230,20 @@ static int ksmbd_tcp_new_connection(struct socket *client_sk)
 		goto out_error;
 	}
 
-	KSMBD_TRANS(t)->handler = kthread_run(ksmbd_conn_handler_loop,
-					      KSMBD_TRANS(t)->conn,
-					      "ksmbd:%u",
-					      ksmbd_tcp_get_port(csin));
+	KSMBD_TRANS(t)->handler = kthread_create(ksmbd_conn_handler_loop,
+						 KSMBD_TRANS(t)->conn,
+						 "ksmbd:%u",
+						 ksmbd_tcp_get_port(csin));
 	if (IS_ERR(KSMBD_TRANS(t)->handler)) {
 		pr_err("cannot start conn thread\n");
 		rc = PTR_ERR(KSMBD_TRANS(t)->handler);
 		free_transport(t);
+		return rc;
 	}
-	return rc;
+
+	ksmbd_tcp_bind_rss_cpu(t, KSMBD_TRANS(t)->handler);
+	wake_up_process(KSMBD_TRANS(t)->handler);
+	return 0;
 
 out_error:
 	free_transport(t);
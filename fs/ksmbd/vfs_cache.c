@@ -300,6 +300,14 @@ static void __ksmbd_remove_fd(struct ksmbd_file_table *ft, struct ksmbd_file *fp
 	write_unlock(&ft->lock);
 }
 
+static void free_ksmbd_filp_rcu(struct rcu_head *rcu_head)
+{
+	struct ksmbd_file *fp = container_of(rcu_head, struct ksmbd_file,
+					     rcu_head);
+
+	kmem_cache_free(filp_cache, fp);
+}
+
 static void __ksmbd_close_fd(struct ksmbd_file_table *ft, struct ksmbd_file *fp)
 {
 	struct file *filp;
@@ -331,7 +339,8 @@ static void __ksmbd_close_fd(struct ksmbd_file_table *ft, struct ksmbd_file *fp)
 
 	if (ksmbd_stream_fd(fp))
 		kfree(fp->stream.name);
-	kmem_cache_free(filp_cache, fp);
+	/* lockless lookups may still be walking the idr to this fp */
+	call_rcu(&fp->rcu_head, free_ksmbd_filp_rcu);
 }
 
 static struct ksmbd_file *ksmbd_fp_get(struct ksmbd_file *fp)
@@ -341,6 +350,12 @@ static struct ksmbd_file *ksmbd_fp_get(struct ksmbd_file *fp)
 	return fp;
 }
 
+/*
+ * Lookups take no table lock, so concurrent reads and writes on the
+ * channels of a multichannel session don't serialize on the session
+ * file table.  The fp is freed by RCU, and a zero refcount (the fp is
+ * being torn down) fails the lookup.
+ */
 static struct ksmbd_file *__ksmbd_lookup_fd(struct ksmbd_file_table *ft,
 					    u64 id)
 {
@@ -349,11 +364,11 @@ static struct ksmbd_file *__ksmbd_lookup_fd(struct ksmbd_file_table *ft,
 	if (!has_file_id(id))
 		return NULL;
 
-	read_lock(&ft->lock);
+	rcu_read_lock();
 	fp = idr_find(ft->idr, id);
 	if (fp)
 		fp = ksmbd_fp_get(fp);
-	read_unlock(&ft->lock);
+	rcu_read_unlock();
 	return fp;
 }
 
@@ -385,7 +400,7 @@ int ksmbd_close_fd(struct ksmbd_work *work, u64 id)
 		return 0;
 
 	ft = &work->sess->file_table;
-	read_lock(&ft->lock);
+	rcu_read_lock();
 	fp = idr_find(ft->idr, id);
 	if (fp) {
 		set_close_state_blocked_works(fp);
@@ -393,7 +408,7 @@ int ksmbd_close_fd(struct ksmbd_work *work, u64 id)
 		if (!atomic_dec_and_test(&fp->refcount))
 			fp = NULL;
 	}
-	read_unlock(&ft->lock);
+	rcu_read_unlock();
 
 	if (!fp)
 		return -EINVAL;
@@ -705,5 +720,6 @@ out:
 
 void ksmbd_exit_file_cache(void)
 {
+	rcu_barrier();
 	kmem_cache_destroy(filp_cache);
 }
@@ -98,6 +98,7 @@ struct ksmbd_file {
 	/* if ls is happening on directory, below is valid*/
 	struct ksmbd_readdir_data	readdir_data;
 	int				dot_dotdot[2];
+	struct rcu_head			rcu_head;
 };
 
 static inline void set_ctx_actor(struct dir_context *ctx,
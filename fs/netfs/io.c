@@ -444,7 +444,7 @@ out:
 	u = atomic_dec_return(&rreq->nr_outstanding);
 	if (u == 0)
 		netfs_rreq_terminated(rreq, was_async);
-	else if (u == 1)
+	else if (u == 1 || rreq->io_window)
 		wake_up_var(&rreq->nr_outstanding);
 
 	netfs_put_subrequest(subreq, was_async, netfs_sreq_trace_put_terminated);
@@ -554,6 +554,14 @@ static bool netfs_rreq_submit_slice(struct netfs_io_request *rreq,
 	subreq->start		= rreq->start + rreq->submitted;
 	subreq->len		= rreq->len   - rreq->submitted;
 
+	/*
+	 * Apply the configured slice size, if any, before the cache and the
+	 * netfs clamp the subset further.  Smaller slices mean more
+	 * subrequests in flight at once on high-BDP links.
+	 */
+	if (rreq->io_slice_size && subreq->len > rreq->io_slice_size)
+		subreq->len = rreq->io_slice_size;
+
 	_debug("slice %llx,%zx,%zx", subreq->start, subreq->len, rreq->submitted);
 	list_add_tail(&subreq->rreq_link, &rreq->subrequests);
 
@@ -625,6 +633,17 @@ int netfs_begin_read(struct netfs_io_request *rreq, bool sync)
 	 */
 	atomic_set(&rreq->nr_outstanding, 1);
 	do {
+		/*
+		 * If the netfs configured an issue window, don't run further
+		 * ahead of completion than that many subrequests.  Note that
+		 * nr_outstanding includes our base count of 1.  Completions
+		 * are assembled out of order as they come in regardless.
+		 */
+		if (rreq->io_window)
+			wait_var_event(&rreq->nr_outstanding,
+				       atomic_read(&rreq->nr_outstanding) <=
+				       rreq->io_window);
+
 		if (!netfs_rreq_submit_slice(rreq, &debug_index))
 			break;
 
@@ -33,6 +33,8 @@ struct netfs_io_request *netfs_alloc_request(struct address_space *mapping,
 	rreq->mapping	= mapping;
 	rreq->inode	= inode;
 	rreq->i_size	= i_size_read(inode);
+	rreq->io_slice_size = ctx->io_slice_size;
+	rreq->io_window	= ctx->io_window;
 	rreq->debug_id	= atomic_inc_return(&debug_ids);
 	INIT_LIST_HEAD(&rreq->subrequests);
 	refcount_set(&rreq->ref, 1);
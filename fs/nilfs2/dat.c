@@ -15,6 +15,7 @@
 #include "mdt.h"
 #include "alloc.h"
 #include "dat.h"
+#include "sufile.h"
 
 
 #define NILFS_CNO_MIN	((__u64)1)
@@ -214,6 +215,12 @@ void nilfs_dat_commit_end(struct inode *dat, struct nilfs_palloc_req *req,
 	blocknr = le64_to_cpu(entry->de_blocknr);
 	kunmap_atomic(kaddr);
 
+	if (dead && blocknr != 0) {
+		struct the_nilfs *nilfs = dat->i_sb->s_fs_info;
+
+		nilfs_sufile_dec_nlive_blks(nilfs->ns_sufile, blocknr);
+	}
+
 	if (blocknr == 0)
 		nilfs_dat_commit_free(dat, req);
 	else
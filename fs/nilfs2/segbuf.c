@@ -13,6 +13,7 @@
 #include <linux/crc32.h>
 #include <linux/backing-dev.h>
 #include <linux/slab.h>
+#include <linux/workqueue.h>
 #include "page.h"
 #include "segbuf.h"
 
@@ -305,21 +306,70 @@ int nilfs_wait_on_logs(struct list_head *logs)
 	return ret;
 }
 
+static void nilfs_segbuf_fill_in_crcs(struct nilfs_segment_buffer *segbuf,
+				      u32 seed)
+{
+	if (segbuf->sb_super_root)
+		nilfs_segbuf_fill_in_super_root_crc(segbuf, seed);
+	nilfs_segbuf_fill_in_segsum_crc(segbuf, seed);
+	nilfs_segbuf_fill_in_data_crc(segbuf, seed);
+}
+
+struct nilfs_segbuf_crc_work {
+	struct work_struct work;
+	struct nilfs_segment_buffer *segbuf;
+	u32 seed;
+};
+
+static void nilfs_segbuf_crc_workfn(struct work_struct *work)
+{
+	struct nilfs_segbuf_crc_work *cw =
+		container_of(work, struct nilfs_segbuf_crc_work, work);
+
+	nilfs_segbuf_fill_in_crcs(cw->segbuf, cw->seed);
+}
+
 /**
  * nilfs_add_checksums_on_logs - add checksums on the logs
  * @logs: list of segment buffers storing target logs
  * @seed: checksum seed value
+ *
+ * Each log is checksummed independently, so when a construction has
+ * produced several logs the crc computation is spread over the online
+ * cpus instead of running on the segment constructor thread alone.
+ * The submission order of the logs is not affected.
  */
 void nilfs_add_checksums_on_logs(struct list_head *logs, u32 seed)
 {
 	struct nilfs_segment_buffer *segbuf;
+	struct nilfs_segbuf_crc_work *works;
+	unsigned int nlogs = 0, i;
 
-	list_for_each_entry(segbuf, logs, sb_list) {
-		if (segbuf->sb_super_root)
-			nilfs_segbuf_fill_in_super_root_crc(segbuf, seed);
-		nilfs_segbuf_fill_in_segsum_crc(segbuf, seed);
-		nilfs_segbuf_fill_in_data_crc(segbuf, seed);
+	list_for_each_entry(segbuf, logs, sb_list)
+		nlogs++;
+
+	if (nlogs > 1) {
+		works = kcalloc(nlogs, sizeof(*works), GFP_NOIO);
+		if (works) {
+			i = 0;
+			list_for_each_entry(segbuf, logs, sb_list) {
+				works[i].segbuf = segbuf;
+				works[i].seed = seed;
+				INIT_WORK(&works[i].work,
+					  nilfs_segbuf_crc_workfn);
+				queue_work(system_unbound_wq, &works[i].work);
+				i++;
+			}
+			for (i = 0; i < nlogs; i++)
+				flush_work(&works[i].work);
+			kfree(works);
+			return;
+		}
+		/* fall back to checksumming on this cpu */
 	}
+
+	list_for_each_entry(segbuf, logs, sb_list)
+		nilfs_segbuf_fill_in_crcs(segbuf, seed);
 }
 
 /*
@@ -37,6 +37,19 @@ static inline struct nilfs_sufile_info *NILFS_SUI(struct inode *sufile)
 	return (struct nilfs_sufile_info *)NILFS_MDT(sufile);
 }
 
+/*
+ * The live block estimates are only written from log writer context, so
+ * plain READ_ONCE/WRITE_ONCE accesses are sufficient for them.
+ */
+static __u32 *nilfs_sufile_nlive_blks_ptr(struct inode *sufile, __u64 segnum)
+{
+	struct the_nilfs *nilfs = sufile->i_sb->s_fs_info;
+
+	if (!nilfs->ns_nlive_blks || segnum >= nilfs->ns_nlive_nsegs)
+		return NULL;
+	return &nilfs->ns_nlive_blks[segnum];
+}
+
 static inline unsigned long
 nilfs_sufile_segment_usages_per_block(const struct inode *sufile)
 {
@@ -430,8 +443,13 @@ void nilfs_sufile_do_scrap(struct inode *sufile, __u64 segnum,
 {
 	struct nilfs_segment_usage *su;
 	void *kaddr;
+	__u32 *p;
 	int clean, dirty;
 
+	p = nilfs_sufile_nlive_blks_ptr(sufile, segnum);
+	if (p)
+		WRITE_ONCE(*p, 0);
+
 	kaddr = kmap_atomic(su_bh->b_page);
 	su = nilfs_sufile_block_get_segment_usage(sufile, segnum, su_bh, kaddr);
 	if (su->su_flags == cpu_to_le32(BIT(NILFS_SEGMENT_USAGE_DIRTY)) &&
@@ -461,8 +479,13 @@ void nilfs_sufile_do_free(struct inode *sufile, __u64 segnum,
 {
 	struct nilfs_segment_usage *su;
 	void *kaddr;
+	__u32 *p;
 	int sudirty;
 
+	p = nilfs_sufile_nlive_blks_ptr(sufile, segnum);
+	if (p)
+		WRITE_ONCE(*p, 0);
+
 	kaddr = kmap_atomic(su_bh->b_page);
 	su = nilfs_sufile_block_get_segment_usage(sufile, segnum, su_bh, kaddr);
 	if (nilfs_segment_usage_clean(su)) {
@@ -527,6 +550,7 @@ int nilfs_sufile_set_segment_usage(struct inode *sufile, __u64 segnum,
 	struct buffer_head *bh;
 	struct nilfs_segment_usage *su;
 	void *kaddr;
+	__u32 *p;
 	int ret;
 
 	down_write(&NILFS_MDT(sufile)->mi_sem);
@@ -542,6 +566,10 @@ int nilfs_sufile_set_segment_usage(struct inode *sufile, __u64 segnum,
 	su->su_nblocks = cpu_to_le32(nblocks);
 	kunmap_atomic(kaddr);
 
+	p = nilfs_sufile_nlive_blks_ptr(sufile, segnum);
+	if (p)
+		WRITE_ONCE(*p, nblocks);
+
 	mark_buffer_dirty(bh);
 	nilfs_mdt_mark_dirty(sufile);
 	brelse(bh);
@@ -551,6 +579,30 @@ int nilfs_sufile_set_segment_usage(struct inode *sufile, __u64 segnum,
 	return ret;
 }
 
+/**
+ * nilfs_sufile_dec_nlive_blks - count the death of a block in a segment
+ * @sufile: inode of segment usage file
+ * @blocknr: disk block number of the dead block
+ *
+ * Called when the end of a block's lifetime is committed to the DAT, so
+ * that the live block estimate of the segment holding the block shrinks
+ * accordingly.  Segments whose estimate is still
+ * %NILFS_SUFILE_NLIVE_UNKNOWN (written before this mount) are left alone.
+ */
+void nilfs_sufile_dec_nlive_blks(struct inode *sufile, sector_t blocknr)
+{
+	struct the_nilfs *nilfs = sufile->i_sb->s_fs_info;
+	__u32 *p, n;
+
+	p = nilfs_sufile_nlive_blks_ptr(sufile,
+				nilfs_get_segnum_of_block(nilfs, blocknr));
+	if (p) {
+		n = READ_ONCE(*p);
+		if (n != NILFS_SUFILE_NLIVE_UNKNOWN && n > 0)
+			WRITE_ONCE(*p, n - 1);
+	}
+}
+
 /**
  * nilfs_sufile_get_stat - get segment usage statistics
  * @sufile: inode of segment usage file
@@ -824,6 +876,7 @@ ssize_t nilfs_sufile_get_suinfo(struct inode *sufile, __u64 segnum, void *buf,
 	struct the_nilfs *nilfs = sufile->i_sb->s_fs_info;
 	void *kaddr;
 	unsigned long nsegs, segusages_per_block;
+	__u32 *p, nlive;
 	ssize_t n;
 	int ret, i, j;
 
@@ -861,6 +914,18 @@ ssize_t nilfs_sufile_get_suinfo(struct inode *sufile, __u64 segnum, void *buf,
 			if (nilfs_segment_is_active(nilfs, segnum + j))
 				si->sui_flags |=
 					BIT(NILFS_SEGMENT_USAGE_ACTIVE);
+			/*
+			 * Blocks known to have died since the segment was
+			 * written don't count; this steers the cleaner to
+			 * the segments with the least data left to migrate
+			 * without it having to scan them.
+			 */
+			p = nilfs_sufile_nlive_blks_ptr(sufile, segnum + j);
+			if (p && nilfs_segment_usage_dirty(su)) {
+				nlive = READ_ONCE(*p);
+				if (nlive < si->sui_nblocks)
+					si->sui_nblocks = nlive;
+			}
 		}
 		kunmap_atomic(kaddr);
 		brelse(su_bh);
@@ -14,6 +14,9 @@
 #include <linux/buffer_head.h>
 #include "mdt.h"
 
+/* live block estimate of a segment that has not been tracked yet */
+#define NILFS_SUFILE_NLIVE_UNKNOWN	(~(__u32)0)
+
 
 static inline unsigned long nilfs_sufile_get_nsegments(struct inode *sufile)
 {
@@ -27,6 +30,7 @@ int nilfs_sufile_alloc(struct inode *, __u64 *);
 int nilfs_sufile_mark_dirty(struct inode *sufile, __u64 segnum);
 int nilfs_sufile_set_segment_usage(struct inode *sufile, __u64 segnum,
 				   unsigned long nblocks, time64_t modtime);
+void nilfs_sufile_dec_nlive_blks(struct inode *sufile, sector_t blocknr);
 int nilfs_sufile_get_stat(struct inode *, struct nilfs_sustat *);
 ssize_t nilfs_sufile_get_suinfo(struct inode *, __u64, void *, unsigned int,
 				size_t);
@@ -91,6 +91,7 @@ void destroy_nilfs(struct the_nilfs *nilfs)
 		brelse(nilfs->ns_sbh[0]);
 		brelse(nilfs->ns_sbh[1]);
 	}
+	kvfree(nilfs->ns_nlive_blks);
 	kfree(nilfs);
 }
 
@@ -357,6 +358,21 @@ int load_nilfs(struct the_nilfs *nilfs, struct super_block *sb)
 	nilfs_info(sb, "recovery complete");
 
  skip_recovery:
+	/*
+	 * Best effort: without the estimates the cleaner simply sees the
+	 * unmodified segment usage data, as before.  Entries start out as
+	 * NILFS_SUFILE_NLIVE_UNKNOWN so that segments written before the
+	 * mount are not misreported as empty.
+	 */
+	nilfs->ns_nlive_blks = kvmalloc_array(nilfs->ns_nsegments,
+					      sizeof(*nilfs->ns_nlive_blks),
+					      GFP_KERNEL);
+	if (nilfs->ns_nlive_blks) {
+		memset(nilfs->ns_nlive_blks, 0xff, nilfs->ns_nsegments *
+		       sizeof(*nilfs->ns_nlive_blks));
+		nilfs->ns_nlive_nsegs = nilfs->ns_nsegments;
+	}
+
 	nilfs_clear_recovery_info(&ri);
 	sb->s_flags = s_flags;
 	return 0;
@@ -65,6 +65,8 @@ enum {
  * @ns_dat: DAT file inode
  * @ns_cpfile: checkpoint file inode
  * @ns_sufile: segusage file inode
+ * @ns_nlive_blks: in-memory live block estimates per segment
+ * @ns_nlive_nsegs: number of entries in ns_nlive_blks
  * @ns_cptree: rb-tree of all mounted checkpoints (nilfs_root)
  * @ns_cptree_lock: lock protecting @ns_cptree
  * @ns_dirty_files: list of dirty files
@@ -149,6 +151,13 @@ struct the_nilfs {
 	struct inode	       *ns_cpfile;
 	struct inode	       *ns_sufile;
 
+	/*
+	 * Live block estimates, indexed by segment number and updated by
+	 * the log writer; NULL when they could not be allocated.
+	 */
+	__u32		       *ns_nlive_blks;
+	unsigned long		ns_nlive_nsegs;
+
 	/* Checkpoint tree */
 	struct rb_root		ns_cptree;
 	spinlock_t		ns_cptree_lock;
@@ -662,6 +662,16 @@ void fnd_clear(struct ntfs_fnd *fnd)
 		if (!n)
 			continue;
 
+		/*
+		 * Offer the deepest node to the single slot cache, the
+		 * next lookup in this directory is likely to want it.
+		 */
+		if (fnd->indx && i == fnd->level - 1 &&
+		    !cmpxchg(&fnd->indx->cache_node, NULL, n)) {
+			fnd->nodes[i] = NULL;
+			continue;
+		}
+
 		put_indx_node(n);
 		fnd->nodes[i] = NULL;
 	}
@@ -856,6 +866,7 @@ static inline struct NTFS_DE *hdr_delete_de(struct INDEX_HDR *hdr,
 
 void indx_clear(struct ntfs_index *indx)
 {
+	put_indx_node(xchg(&indx->cache_node, NULL));
 	run_close(&indx->alloc_run);
 	run_close(&indx->bitmap_run);
 }
@@ -1003,6 +1014,9 @@ static int indx_write(struct ntfs_index *indx, struct ntfs_inode *ni,
 {
 	struct INDEX_BUFFER *ib = node->index;
 
+	/* The content changes, drop the cached copy of this block. */
+	put_indx_node(xchg(&indx->cache_node, NULL));
+
 	return ntfs_write_bh(ni->mi.sbi, &ib->rhdr, &node->nb, sync);
 }
 
@@ -1025,11 +1039,22 @@ int indx_read(struct ntfs_index *indx, struct ntfs_inode *ni, CLST vbn,
 	struct indx_node *in = *node;
 	const struct INDEX_NAMES *name;
 
+	if (!in) {
+		/* Check the single slot cache first. */
+		in = xchg(&indx->cache_node, NULL);
+		if (in && in->index &&
+		    le64_to_cpu(in->index->vbn) == vbn) {
+			*node = in;
+			return 0;
+		}
+	}
+
 	if (!in) {
 		in = kzalloc(sizeof(struct indx_node), GFP_NOFS);
 		if (!in)
 			return -ENOMEM;
 	} else {
+		/* Reuse the caller's or the cached node's allocations. */
 		nb_put(&in->nb);
 	}
 
@@ -1097,10 +1122,8 @@ out:
 	if (ib != in->index)
 		kfree(ib);
 
-	if (*node != in) {
-		nb_put(&in->nb);
-		kfree(in);
-	}
+	if (*node != in)
+		put_indx_node(in);
 
 	return err;
 }
@@ -1125,6 +1148,8 @@ int indx_find(struct ntfs_index *indx, struct ntfs_inode *ni,
 		return -EINVAL;
 	}
 
+	fnd->indx = indx;
+
 	/* Check cache. */
 	e = fnd->level ? fnd->de[fnd->level - 1] : fnd->root_de;
 	if (e && !de_is_last(e) &&
@@ -1179,6 +1204,8 @@ int indx_find_sort(struct ntfs_index *indx, struct ntfs_inode *ni,
 	size_t iter = 0;
 	int level = fnd->level;
 
+	fnd->indx = indx;
+
 	if (!*entry) {
 		/* Start find. */
 		e = hdr_first_de(&root->ihdr);
@@ -1292,6 +1319,8 @@ int indx_find_raw(struct ntfs_index *indx, struct ntfs_inode *ni,
 	CLST next_vbn;
 	u32 record_size = ni->mi.sbi->record_size;
 
+	fnd->indx = indx;
+
 	/* Use non sorted algorithm. */
 	if (!*entry) {
 		/* This is the first call. */
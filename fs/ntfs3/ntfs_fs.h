@@ -188,6 +188,14 @@ struct ntfs_index {
 	/* read/write access to 'bitmap_run'/'alloc_run' while ntfs_readdir */
 	struct rw_semaphore run_lock;
 
+	/*
+	 * Single slot cache of the most recently used index block.  Users
+	 * take exclusive ownership of the node with xchg() and may donate
+	 * it back when done; indx_write() drops it before modifications
+	 * hit the disk.
+	 */
+	struct indx_node *cache_node;
+
 	/*TODO: Remove 'cmp'. */
 	NTFS_CMP_FUNC cmp;
 
@@ -406,6 +414,8 @@ struct ntfs_fnd {
 	struct indx_node *nodes[20];
 	struct NTFS_DE *de[20];
 	struct NTFS_DE *root_de;
+	/* Set by indx_find() so that fnd_clear() can recycle nodes. */
+	struct ntfs_index *indx;
 };
 
 enum REPARSE_SIGN {
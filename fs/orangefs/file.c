@@ -279,6 +279,163 @@ out:
 	return ret;
 }
 
+struct orangefs_read_slot {
+	struct orangefs_kernel_op_s *op;
+	int buffer_index;
+	size_t len;
+	long timeout;
+};
+
+static int orangefs_post_read_slot(struct inode *inode,
+		struct orangefs_read_slot *slot, loff_t offset,
+		struct file *file)
+{
+	struct orangefs_kernel_op_s *new_op = slot->op;
+
+	new_op->upcall.req.io.readahead_size = inode->i_size;
+	new_op->upcall.req.io.io_type = ORANGEFS_IO_READ;
+	new_op->upcall.req.io.refn = ORANGEFS_I(inode)->refn;
+	new_op->uses_shared_memory = 1;
+	new_op->upcall.req.io.buf_index = slot->buffer_index;
+	new_op->upcall.req.io.count = slot->len;
+	new_op->upcall.req.io.offset = offset;
+	/* see the f_mode comment in wait_for_direct_io() */
+	if (file && file->f_mode & FMODE_READ)
+		new_op->upcall.uid = 0;
+
+	slot->timeout = orangefs_post_operation(new_op,
+	    get_interruptible_flag(inode));
+	if (slot->timeout < 0)
+		return slot->timeout;
+	return 0;
+}
+
+/*
+ * Read a contiguous range through several shared-memory slots at once,
+ * so that the client-core fills later slots while earlier ones are
+ * copied out to the page cache.  The first slot is acquired the
+ * blocking way, as in wait_for_direct_io(); extra slots are only taken
+ * when immediately free so that one stream can neither starve other
+ * I/O nor deadlock on a client configured with a single buffer.
+ */
+ssize_t orangefs_pipelined_read(struct inode *inode, loff_t offset,
+	struct iov_iter *iter, size_t total_size, struct file *file)
+{
+	struct orangefs_read_slot pipe[ORANGEFS_READ_PIPELINE_DEPTH];
+	int slot_size = orangefs_bufmap_size_query();
+	int head = 0, tail = 0, inflight = 0;
+	size_t remaining = total_size;
+	ssize_t done = 0;
+	ssize_t ret = 0;
+	bool eof = false;
+
+	if (slot_size <= 0)
+		return -EIO;
+
+	while (remaining || inflight) {
+		struct orangefs_read_slot *slot;
+		size_t amt;
+		ssize_t r;
+
+		/* Stage 1: keep the pipeline full. */
+		while (!ret && !eof && remaining &&
+		       inflight < ORANGEFS_READ_PIPELINE_DEPTH) {
+			slot = &pipe[head];
+			slot->len = min_t(size_t, remaining, slot_size);
+			slot->buffer_index = inflight ?
+				orangefs_bufmap_get_nonblocking() :
+				orangefs_bufmap_get();
+			if (slot->buffer_index < 0) {
+				if (inflight && slot->buffer_index == -EAGAIN)
+					break;
+				ret = slot->buffer_index;
+				break;
+			}
+			slot->op = op_alloc(ORANGEFS_VFS_OP_FILE_IO);
+			if (!slot->op) {
+				orangefs_bufmap_put(slot->buffer_index);
+				ret = -ENOMEM;
+				break;
+			}
+			r = orangefs_post_read_slot(inode, slot, offset, file);
+			if (r < 0) {
+				orangefs_bufmap_put(slot->buffer_index);
+				op_release(slot->op);
+				ret = r;
+				break;
+			}
+			offset += slot->len;
+			remaining -= slot->len;
+			head = (head + 1) % ORANGEFS_READ_PIPELINE_DEPTH;
+			inflight++;
+		}
+		if (!inflight)
+			break;
+
+		/* Stage 2: reap the oldest slot and copy it out. */
+		slot = &pipe[tail];
+		r = orangefs_wait_operation(slot->op, "file_read",
+		    slot->timeout, get_interruptible_flag(inode));
+		while (r == -EAGAIN && op_state_purged(slot->op) && !ret) {
+			/*
+			 * The client restarted and wiped the shared
+			 * memory area; move the op to a fresh slot and
+			 * re-post it.
+			 */
+			orangefs_bufmap_put(slot->buffer_index);
+			slot->buffer_index = orangefs_bufmap_get();
+			if (slot->buffer_index < 0) {
+				r = slot->buffer_index;
+				slot->buffer_index = -1;
+				break;
+			}
+			slot->op->upcall.req.io.buf_index = slot->buffer_index;
+			slot->timeout = orangefs_post_operation(slot->op,
+			    get_interruptible_flag(inode));
+			if (slot->timeout < 0) {
+				r = slot->timeout;
+				break;
+			}
+			r = orangefs_wait_operation(slot->op, "file_read",
+			    slot->timeout, get_interruptible_flag(inode));
+		}
+
+		if (r < 0) {
+			if (!ret)
+				ret = r;
+		} else if (!ret && !eof) {
+			amt = slot->op->downcall.resp.io.amt_complete;
+			if (amt) {
+				r = orangefs_bufmap_copy_to_iovec(iter,
+				    slot->buffer_index, amt);
+				if (r < 0)
+					ret = r;
+				else
+					done += amt;
+			}
+			/*
+			 * A short read means end of file; whatever the
+			 * later slots return lies beyond it.
+			 */
+			if (amt < slot->len)
+				eof = true;
+		}
+
+		/* Retire the slot. */
+		if (r < 0 && orangefs_cancel_op_in_progress(slot->op)) {
+			/* the cancel owns the op and its slot now */
+		} else {
+			if (slot->buffer_index >= 0)
+				orangefs_bufmap_put(slot->buffer_index);
+			op_release(slot->op);
+		}
+		tail = (tail + 1) % ORANGEFS_READ_PIPELINE_DEPTH;
+		inflight--;
+	}
+
+	return ret ? ret : done;
+}
+
 int orangefs_revalidate_mapping(struct inode *inode)
 {
 	struct orangefs_inode_s *orangefs_inode = ORANGEFS_I(inode);
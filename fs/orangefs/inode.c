@@ -251,9 +251,11 @@ static void orangefs_readahead(struct readahead_control *rac)
 
 	loff_t bytes_remaining = inode->i_size - readahead_pos(rac);
 	loff_t pages_remaining = bytes_remaining / PAGE_SIZE;
+	loff_t pipeline_len = (loff_t)ORANGEFS_READ_PIPELINE_DEPTH *
+		(orangefs_bufmap_size_query() ?: 4194304);
 
-	if (pages_remaining >= 1024)
-		new_len = 4194304;
+	if (bytes_remaining >= pipeline_len)
+		new_len = pipeline_len;
 	else if (pages_remaining > readahead_count(rac))
 		new_len = bytes_remaining;
 
@@ -266,11 +268,10 @@ static void orangefs_readahead(struct readahead_control *rac)
 	iov_iter_xarray(&iter, ITER_DEST, i_pages, offset, readahead_length(rac));
 
 	/* read in the pages. */
-	if ((ret = wait_for_direct_io(ORANGEFS_IO_READ, inode,
-			&offset, &iter, readahead_length(rac),
-			inode->i_size, NULL, NULL, rac->file)) < 0)
+	if ((ret = orangefs_pipelined_read(inode, offset, &iter,
+			readahead_length(rac), rac->file)) < 0)
 		gossip_debug(GOSSIP_FILE_DEBUG,
-			"%s: wait_for_direct_io failed. \n", __func__);
+			"%s: orangefs_pipelined_read failed. \n", __func__);
 	else
 		ret = 0;
 
@@ -136,6 +136,21 @@ static int get(struct slot_map *m)
 	return res;
 }
 
+static int get_nonblocking(struct slot_map *m)
+{
+	int res;
+	spin_lock(&m->q.lock);
+	if (m->c <= 0) {
+		res = -EAGAIN;
+	} else {
+		m->c--;
+		res = find_first_zero_bit(m->map, m->count);
+		__set_bit(res, m->map);
+	}
+	spin_unlock(&m->q.lock);
+	return res;
+}
+
 /* used to describe mapped buffers */
 struct orangefs_bufmap_desc {
 	void __user *uaddr;		/* user space address pointer */
@@ -444,6 +459,19 @@ int orangefs_bufmap_get(void)
 	return get(&rw_map);
 }
 
+/*
+ * orangefs_bufmap_get_nonblocking()
+ *
+ * gets a free mapped buffer descriptor if one is immediately
+ * available
+ *
+ * returns slot on success, -EAGAIN if all slots are busy
+ */
+int orangefs_bufmap_get_nonblocking(void)
+{
+	return get_nonblocking(&rw_map);
+}
+
 /*
  * orangefs_bufmap_put()
  *
@@ -20,6 +20,8 @@ void orangefs_bufmap_run_down(void);
 
 int orangefs_bufmap_get(void);
 
+int orangefs_bufmap_get_nonblocking(void);
+
 void orangefs_bufmap_put(int buffer_index);
 
 int orangefs_readdir_index_get(void);
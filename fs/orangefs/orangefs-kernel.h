@@ -403,6 +403,12 @@ ssize_t wait_for_direct_io(enum ORANGEFS_io_type, struct inode *, loff_t *,
 ssize_t do_readv_writev(enum ORANGEFS_io_type, struct file *, loff_t *,
     struct iov_iter *);
 
+/* max shared-memory slots one read may keep in flight */
+#define ORANGEFS_READ_PIPELINE_DEPTH 2
+
+ssize_t orangefs_pipelined_read(struct inode *, loff_t, struct iov_iter *,
+    size_t, struct file *);
+
 /*
  * defined in orangefs-utils.c
  */
@@ -468,6 +474,13 @@ int service_operation(struct orangefs_kernel_op_s *op,
 		      const char *op_name,
 		      int flags);
 
+long orangefs_post_operation(struct orangefs_kernel_op_s *op, int flags);
+
+int orangefs_wait_operation(struct orangefs_kernel_op_s *op,
+			    const char *op_name,
+			    long timeout,
+			    int flags);
+
 #define get_interruptible_flag(inode) \
 	((ORANGEFS_SB(inode->i_sb)->flags & ORANGEFS_OPT_INTR) ? \
 		ORANGEFS_OP_INTERRUPTIBLE : 0)
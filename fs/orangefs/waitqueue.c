@@ -53,36 +53,22 @@ void purge_waiting_ops(void)
 }
 
 /*
- * submits a ORANGEFS operation and waits for it to complete
- *
- * Note op->downcall.status will contain the status of the operation (in
- * errno format), whether provided by pvfs2-client or a result of failure to
- * service the operation.  If the caller wishes to distinguish, then
- * op->state can be checked to see if it was serviced or not.
+ * Post an operation on the request queue for the client-core to pick
+ * up, without waiting for the downcall.  Pair with
+ * orangefs_wait_operation(); most callers want service_operation()
+ * instead.
  *
- * Returns contents of op->downcall.status for convenience
+ * Returns the timeout to pass to orangefs_wait_operation(), or -errno
+ * if the request mutex could not be taken.
  */
-int service_operation(struct orangefs_kernel_op_s *op,
-		      const char *op_name,
-		      int flags)
+long orangefs_post_operation(struct orangefs_kernel_op_s *op, int flags)
 {
 	long timeout = MAX_SCHEDULE_TIMEOUT;
 	int ret = 0;
 
-	DEFINE_WAIT(wait_entry);
-
 	op->upcall.tgid = current->tgid;
 	op->upcall.pid = current->pid;
-
-retry_servicing:
 	op->downcall.status = 0;
-	gossip_debug(GOSSIP_WAIT_DEBUG,
-		     "%s: %s op:%p: process:%s: pid:%d:\n",
-		     __func__,
-		     op_name,
-		     op,
-		     current->comm,
-		     current->pid);
 
 	/*
 	 * If ORANGEFS_OP_NO_MUTEX was set in flags, we need to avoid
@@ -102,7 +88,7 @@ retry_servicing:
 		if (ret < 0) {
 			op->downcall.status = ret;
 			gossip_debug(GOSSIP_WAIT_DEBUG,
-				     "%s: service_operation interrupted.\n",
+				     "%s: interrupted.\n",
 				     __func__);
 			return ret;
 		}
@@ -143,6 +129,23 @@ retry_servicing:
 	if (!(flags & ORANGEFS_OP_NO_MUTEX))
 		mutex_unlock(&orangefs_request_mutex);
 
+	return timeout;
+}
+
+/*
+ * Wait for the downcall matching a posted operation and collect its
+ * status (in errno format).  On failure the op has been removed from
+ * whichever list it was on.  -EAGAIN means the op was purged and
+ * should be re-posted; I/O ops must be returned to their caller for
+ * that so the shared buffer can be repopulated.
+ */
+int orangefs_wait_operation(struct orangefs_kernel_op_s *op,
+			    const char *op_name,
+			    long timeout,
+			    int flags)
+{
+	int ret;
+
 	ret = wait_for_matching_downcall(op, timeout, flags);
 	gossip_debug(GOSSIP_WAIT_DEBUG,
 		     "%s: wait_for_matching_downcall returned %d for %p\n",
@@ -155,8 +158,7 @@ retry_servicing:
 		spin_unlock(&op->lock);
 		op->downcall.status =
 		    orangefs_normalize_to_errno(op->downcall.status);
-		ret = op->downcall.status;
-		goto out;
+		return op->downcall.status;
 	}
 
 	/* failed to get matching downcall */
@@ -173,27 +175,69 @@ retry_servicing:
 	orangefs_clean_up_interrupted_operation(op);
 
 	op->downcall.status = ret;
-	/* retry if operation has not been serviced and if requested */
 	if (ret == -EAGAIN) {
 		op->attempts++;
-		timeout = op_timeout_secs * HZ;
 		gossip_debug(GOSSIP_WAIT_DEBUG,
 			     "orangefs: tag %llu (%s)"
 			     " -- operation to be retried (%d attempt)\n",
 			     llu(op->tag),
 			     op_name,
 			     op->attempts);
+	}
+	return ret;
+}
 
-		/*
-		 * io ops (ops that use the shared memory buffer) have
-		 * to be returned to their caller for a retry. Other ops
-		 * can just be recycled here.
-		 */
-		if (!op->uses_shared_memory)
-			goto retry_servicing;
+/*
+ * submits a ORANGEFS operation and waits for it to complete
+ *
+ * Note op->downcall.status will contain the status of the operation (in
+ * errno format), whether provided by pvfs2-client or a result of failure to
+ * service the operation.  If the caller wishes to distinguish, then
+ * op->state can be checked to see if it was serviced or not.
+ *
+ * Returns contents of op->downcall.status for convenience
+ */
+int service_operation(struct orangefs_kernel_op_s *op,
+		      const char *op_name,
+		      int flags)
+{
+	bool retried = false;
+	long timeout;
+	int ret;
+
+retry_servicing:
+	gossip_debug(GOSSIP_WAIT_DEBUG,
+		     "%s: %s op:%p: process:%s: pid:%d:\n",
+		     __func__,
+		     op_name,
+		     op,
+		     current->comm,
+		     current->pid);
+
+	timeout = orangefs_post_operation(op, flags);
+	if (timeout < 0) {
+		gossip_debug(GOSSIP_WAIT_DEBUG,
+			     "%s: service_operation interrupted.\n",
+			     __func__);
+		return timeout;
+	}
+	/* don't wait forever for an operation that is being retried */
+	if (retried && timeout > op_timeout_secs * HZ)
+		timeout = op_timeout_secs * HZ;
+
+	ret = orangefs_wait_operation(op, op_name, timeout, flags);
+
+	/*
+	 * retry if operation has not been serviced and if requested.
+	 * io ops (ops that use the shared memory buffer) have to be
+	 * returned to their caller for a retry. Other ops can just be
+	 * recycled here.
+	 */
+	if (ret == -EAGAIN && !op->uses_shared_memory) {
+		retried = true;
+		goto retry_servicing;
 	}
 
-out:
 	gossip_debug(GOSSIP_WAIT_DEBUG,
 		     "%s: %s returning: %d for %p.\n",
 		     __func__,
@@ -21,7 +21,7 @@
 #include <linux/exportfs.h>
 #include "overlayfs.h"
 
-#define OVL_COPY_UP_CHUNK_SIZE (1 << 20)
+#define OVL_COPY_UP_CHUNK_SIZE (1 << 22)
 
 static int ovl_ccup_set(const char *buf, const struct kernel_param *param)
 {
@@ -304,13 +304,25 @@ static int ovl_copy_up_file(struct ovl_fs *ofs, struct dentry *dentry,
 			}
 		}
 
-		bytes = do_splice_direct(old_file, &old_pos,
-					 new_file, &new_pos,
-					 this_len, SPLICE_F_MOVE);
+		/*
+		 * Prefer copy_file_range() so that filesystems which can
+		 * clone or offload the copy (e.g. server side copy on NFS)
+		 * get a chance to do so for each chunk.  Fall back to plain
+		 * splice when the filesystems cannot copy between them.
+		 */
+		bytes = vfs_copy_file_range(old_file, old_pos, new_file,
+					    new_pos, this_len, 0);
+		if (bytes == -EOPNOTSUPP || bytes == -EXDEV)
+			bytes = vfs_copy_file_range(old_file, old_pos,
+						    new_file, new_pos,
+						    this_len,
+						    COPY_FILE_SPLICE);
 		if (bytes <= 0) {
 			error = bytes;
 			break;
 		}
+		old_pos += bytes;
+		new_pos += bytes;
 		WARN_ON(old_pos != new_pos);
 
 		len -= bytes;
@@ -225,6 +225,11 @@ void ovl_cache_free(struct list_head *list)
 	INIT_LIST_HEAD(list);
 }
 
+/*
+ * Free the cache attached to the inode.  This is called on inode eviction
+ * and for the non-refcounted impure cache; any merged dir cache found here
+ * holds only the inode's reference since eviction implies no open files.
+ */
 void ovl_dir_cache_free(struct inode *inode)
 {
 	struct ovl_dir_cache *cache = ovl_dir_cache(inode);
@@ -242,9 +247,6 @@ static void ovl_cache_put(struct ovl_dir_file *od, struct inode *inode)
 	WARN_ON(cache->refcount <= 0);
 	cache->refcount--;
 	if (!cache->refcount) {
-		if (ovl_dir_cache(inode) == cache)
-			ovl_set_dir_cache(inode, NULL);
-
 		ovl_cache_free(&cache->entries);
 		kfree(cache);
 	}
@@ -402,13 +404,26 @@ static struct ovl_dir_cache *ovl_cache_get(struct dentry *dentry)
 		cache->refcount++;
 		return cache;
 	}
-	ovl_set_dir_cache(d_inode(dentry), NULL);
+	if (cache) {
+		/*
+		 * The cache is stale.  Drop the reference held by the inode;
+		 * open directory files may still hold references of their own.
+		 */
+		ovl_set_dir_cache(inode, NULL);
+		WARN_ON(cache->refcount <= 0);
+		cache->refcount--;
+		if (!cache->refcount) {
+			ovl_cache_free(&cache->entries);
+			kfree(cache);
+		}
+	}
 
 	cache = kzalloc(sizeof(struct ovl_dir_cache), GFP_KERNEL);
 	if (!cache)
 		return ERR_PTR(-ENOMEM);
 
-	cache->refcount = 1;
+	/* One reference for the inode and one for the caller */
+	cache->refcount = 2;
 	INIT_LIST_HEAD(&cache->entries);
 	cache->root = RB_ROOT;
 
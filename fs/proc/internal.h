@@ -171,6 +171,11 @@ extern struct inode *proc_pid_make_inode(struct super_block *, struct task_struc
 extern void pid_update_inode(struct task_struct *, struct inode *);
 extern int pid_delete_dentry(const struct dentry *);
 extern int proc_pid_readdir(struct file *, struct dir_context *);
+struct tgid_iter {
+	unsigned int tgid;
+	struct task_struct *task;
+};
+extern struct tgid_iter next_tgid(struct pid_namespace *ns, struct tgid_iter iter);
 struct dentry *proc_pid_lookup(struct dentry *, unsigned int);
 extern loff_t mem_lseek(struct file *, loff_t, int);
 
@@ -291,6 +296,7 @@ struct proc_maps_private {
 	struct mm_struct *mm;
 #ifdef CONFIG_MMU
 	struct vma_iterator iter;
+	struct smaps_rollup_cache *rollup_cache;	/* smaps_rollup only */
 #endif
 #ifdef CONFIG_NUMA
 	struct mempolicy *task_mempolicy;
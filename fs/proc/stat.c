@@ -3,11 +3,15 @@
 #include <linux/fs.h>
 #include <linux/init.h>
 #include <linux/interrupt.h>
+#include <linux/jiffies.h>
 #include <linux/kernel_stat.h>
+#include <linux/mutex.h>
 #include <linux/proc_fs.h>
+#include <linux/rcupdate.h>
 #include <linux/sched.h>
 #include <linux/sched/stat.h>
 #include <linux/seq_file.h>
+#include <linux/seqlock.h>
 #include <linux/slab.h>
 #include <linux/time.h>
 #include <linux/time_namespace.h>
@@ -80,6 +84,40 @@ static u64 get_iowait_time(struct kernel_cpustat *kcs, int cpu)
 
 #endif
 
+/*
+ * Shared snapshot of the cross-CPU sums shown in /proc/stat.  Summing
+ * kstat over every possible CPU on each read is real cache-miss traffic
+ * on large machines with many pollers, so readers normally consume a
+ * snapshot that is refreshed at most once per STAT_SNAP_MAX_AGE.  Opening
+ * the file with O_SYNC bypasses the snapshot for callers that need exact
+ * freshness.  The per-CPU "cpuN" lines are always read live; they touch
+ * each CPU's data only once regardless.
+ */
+#define STAT_SNAP_MAX_AGE	(HZ / 10)
+
+struct stat_snapshot {
+	unsigned long	jiffies;	/* time of refresh, 0 if never */
+	u64		user, nice, system, idle, iowait;
+	u64		irq, softirq, steal, guest, guest_nice;
+	u64		sum;		/* total interrupts */
+	u64		sum_softirq;
+	unsigned int	per_softirq_sums[NR_SOFTIRQS];
+	u64		ctxt;
+	unsigned int	procs_running;
+	unsigned int	procs_blocked;
+};
+
+struct stat_irqs_snap {
+	struct rcu_head	rcu;
+	unsigned int	nr;
+	u64		counts[];
+};
+
+static struct stat_snapshot stat_snap;
+static DEFINE_SEQLOCK(stat_snap_seqlock);
+static DEFINE_MUTEX(stat_snap_refresh_mutex);
+static struct stat_irqs_snap __rcu *stat_irqs;
+
 static void show_irq_gap(struct seq_file *p, unsigned int gap)
 {
 	static const char zeros[] = " 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0";
@@ -93,34 +131,36 @@ static void show_irq_gap(struct seq_file *p, unsigned int gap)
 	}
 }
 
-static void show_all_irqs(struct seq_file *p)
+/*
+ * Print the interrupt counts, either live from kstat or from a snapshot
+ * taken by stat_snapshot_refresh().
+ */
+static void show_all_irqs(struct seq_file *p, const struct stat_irqs_snap *snap)
 {
 	unsigned int i, next = 0;
 
 	for_each_active_irq(i) {
+		u64 cnt;
+
+		if (snap)
+			cnt = i < snap->nr ? snap->counts[i] : 0;
+		else
+			cnt = kstat_irqs_usr(i);
 		show_irq_gap(p, i - next);
-		seq_put_decimal_ull(p, " ", kstat_irqs_usr(i));
+		seq_put_decimal_ull(p, " ", cnt);
 		next = i + 1;
 	}
 	show_irq_gap(p, nr_irqs - next);
 }
 
-static int show_stat(struct seq_file *p, void *v)
+/*
+ * Gather all the cross-CPU sums that /proc/stat reports.
+ */
+static void stat_collect(struct stat_snapshot *snap)
 {
 	int i, j;
-	u64 user, nice, system, idle, iowait, irq, softirq, steal;
-	u64 guest, guest_nice;
-	u64 sum = 0;
-	u64 sum_softirq = 0;
-	unsigned int per_softirq_sums[NR_SOFTIRQS] = {0};
-	struct timespec64 boottime;
 
-	user = nice = system = idle = iowait =
-		irq = softirq = steal = 0;
-	guest = guest_nice = 0;
-	getboottime64(&boottime);
-	/* shift boot timestamp according to the timens offset */
-	timens_sub_boottime(&boottime);
+	memset(snap, 0, sizeof(*snap));
 
 	for_each_possible_cpu(i) {
 		struct kernel_cpustat kcpustat;
@@ -128,38 +168,128 @@ static int show_stat(struct seq_file *p, void *v)
 
 		kcpustat_cpu_fetch(&kcpustat, i);
 
-		user		+= cpustat[CPUTIME_USER];
-		nice		+= cpustat[CPUTIME_NICE];
-		system		+= cpustat[CPUTIME_SYSTEM];
-		idle		+= get_idle_time(&kcpustat, i);
-		iowait		+= get_iowait_time(&kcpustat, i);
-		irq		+= cpustat[CPUTIME_IRQ];
-		softirq		+= cpustat[CPUTIME_SOFTIRQ];
-		steal		+= cpustat[CPUTIME_STEAL];
-		guest		+= cpustat[CPUTIME_GUEST];
-		guest_nice	+= cpustat[CPUTIME_GUEST_NICE];
-		sum		+= kstat_cpu_irqs_sum(i);
-		sum		+= arch_irq_stat_cpu(i);
+		snap->user	+= cpustat[CPUTIME_USER];
+		snap->nice	+= cpustat[CPUTIME_NICE];
+		snap->system	+= cpustat[CPUTIME_SYSTEM];
+		snap->idle	+= get_idle_time(&kcpustat, i);
+		snap->iowait	+= get_iowait_time(&kcpustat, i);
+		snap->irq	+= cpustat[CPUTIME_IRQ];
+		snap->softirq	+= cpustat[CPUTIME_SOFTIRQ];
+		snap->steal	+= cpustat[CPUTIME_STEAL];
+		snap->guest	+= cpustat[CPUTIME_GUEST];
+		snap->guest_nice += cpustat[CPUTIME_GUEST_NICE];
+		snap->sum	+= kstat_cpu_irqs_sum(i);
+		snap->sum	+= arch_irq_stat_cpu(i);
 
 		for (j = 0; j < NR_SOFTIRQS; j++) {
 			unsigned int softirq_stat = kstat_softirqs_cpu(j, i);
 
-			per_softirq_sums[j] += softirq_stat;
-			sum_softirq += softirq_stat;
+			snap->per_softirq_sums[j] += softirq_stat;
+			snap->sum_softirq += softirq_stat;
+		}
+	}
+	snap->sum += arch_irq_stat();
+
+	snap->ctxt = nr_context_switches();
+	snap->procs_running = nr_running();
+	snap->procs_blocked = nr_iowait();
+}
+
+/*
+ * Refresh the shared snapshot if it is older than STAT_SNAP_MAX_AGE.  The
+ * scalar sums are published under a seqlock; the interrupt counts are
+ * published as an RCU pointer so that readers never see a half-updated or
+ * freed array.  If the interrupt array can't be (re)allocated, readers fall
+ * back to summing the interrupt counts live.
+ */
+static void stat_snapshot_refresh(void)
+{
+	struct stat_snapshot snap;
+	struct stat_irqs_snap *irqs, *old;
+	unsigned int i;
+
+	mutex_lock(&stat_snap_refresh_mutex);
+	if (stat_snap.jiffies &&
+	    time_before(jiffies, stat_snap.jiffies + STAT_SNAP_MAX_AGE))
+		goto out;
+
+	irqs = kvmalloc(struct_size(irqs, counts, nr_irqs), GFP_KERNEL);
+	if (irqs) {
+		irqs->nr = nr_irqs;
+		memset(irqs->counts, 0, array_size(irqs->nr, sizeof(u64)));
+	}
+
+	stat_collect(&snap);
+	snap.jiffies = jiffies;
+	if (irqs) {
+		for_each_active_irq(i) {
+			if (i < irqs->nr)
+				irqs->counts[i] = kstat_irqs_usr(i);
 		}
 	}
-	sum += arch_irq_stat();
-
-	seq_put_decimal_ull(p, "cpu  ", nsec_to_clock_t(user));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(nice));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(system));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(idle));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(iowait));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(irq));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(softirq));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(steal));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(guest));
-	seq_put_decimal_ull(p, " ", nsec_to_clock_t(guest_nice));
+
+	write_seqlock(&stat_snap_seqlock);
+	stat_snap = snap;
+	write_sequnlock(&stat_snap_seqlock);
+
+	if (irqs) {
+		old = rcu_replace_pointer(stat_irqs, irqs,
+				lockdep_is_held(&stat_snap_refresh_mutex));
+		if (old)
+			kvfree_rcu(old, rcu);
+	}
+out:
+	mutex_unlock(&stat_snap_refresh_mutex);
+}
+
+static void stat_snapshot_read(struct stat_snapshot *snap)
+{
+	unsigned int seq;
+
+	do {
+		seq = read_seqbegin(&stat_snap_seqlock);
+		*snap = stat_snap;
+	} while (read_seqretry(&stat_snap_seqlock, seq));
+}
+
+static void stat_snapshot_get(struct stat_snapshot *snap)
+{
+	stat_snapshot_read(snap);
+	if (!snap->jiffies ||
+	    !time_before(jiffies, snap->jiffies + STAT_SNAP_MAX_AGE)) {
+		stat_snapshot_refresh();
+		stat_snapshot_read(snap);
+	}
+}
+
+static int show_stat(struct seq_file *p, void *v)
+{
+	bool exact = p->private;
+	struct stat_snapshot snap;
+	u64 user, nice, system, idle, iowait, irq, softirq, steal;
+	u64 guest, guest_nice;
+	struct timespec64 boottime;
+	int i;
+
+	getboottime64(&boottime);
+	/* shift boot timestamp according to the timens offset */
+	timens_sub_boottime(&boottime);
+
+	if (exact)
+		stat_collect(&snap);
+	else
+		stat_snapshot_get(&snap);
+
+	seq_put_decimal_ull(p, "cpu  ", nsec_to_clock_t(snap.user));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.nice));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.system));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.idle));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.iowait));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.irq));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.softirq));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.steal));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.guest));
+	seq_put_decimal_ull(p, " ", nsec_to_clock_t(snap.guest_nice));
 	seq_putc(p, '\n');
 
 	for_each_online_cpu(i) {
@@ -192,9 +322,15 @@ static int show_stat(struct seq_file *p, void *v)
 		seq_put_decimal_ull(p, " ", nsec_to_clock_t(guest_nice));
 		seq_putc(p, '\n');
 	}
-	seq_put_decimal_ull(p, "intr ", (unsigned long long)sum);
-
-	show_all_irqs(p);
+	seq_put_decimal_ull(p, "intr ", (unsigned long long)snap.sum);
+
+	if (exact) {
+		show_all_irqs(p, NULL);
+	} else {
+		rcu_read_lock();
+		show_all_irqs(p, rcu_dereference(stat_irqs));
+		rcu_read_unlock();
+	}
 
 	seq_printf(p,
 		"\nctxt %llu\n"
@@ -202,16 +338,16 @@ static int show_stat(struct seq_file *p, void *v)
 		"processes %lu\n"
 		"procs_running %u\n"
 		"procs_blocked %u\n",
-		nr_context_switches(),
+		snap.ctxt,
 		(unsigned long long)boottime.tv_sec,
 		total_forks,
-		nr_running(),
-		nr_iowait());
+		snap.procs_running,
+		snap.procs_blocked);
 
-	seq_put_decimal_ull(p, "softirq ", (unsigned long long)sum_softirq);
+	seq_put_decimal_ull(p, "softirq ", (unsigned long long)snap.sum_softirq);
 
 	for (i = 0; i < NR_SOFTIRQS; i++)
-		seq_put_decimal_ull(p, " ", per_softirq_sums[i]);
+		seq_put_decimal_ull(p, " ", snap.per_softirq_sums[i]);
 	seq_putc(p, '\n');
 
 	return 0;
@@ -223,7 +359,9 @@ static int stat_open(struct inode *inode, struct file *file)
 
 	/* minimum size to display an interrupt count : 2 bytes */
 	size += 2 * nr_irqs;
-	return single_open_size(file, show_stat, NULL, size);
+	return single_open_size(file, show_stat,
+				(void *)(unsigned long)(file->f_flags & O_SYNC),
+				size);
 }
 
 static const struct proc_ops stat_proc_ops = {
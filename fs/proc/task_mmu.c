@@ -882,6 +882,243 @@ static int show_smap(struct seq_file *m, void *v)
 	return 0;
 }
 
+#ifdef CONFIG_MEM_SOFT_DIRTY
+/*
+ * Incremental mode for smaps_rollup.  A full rollup walks the page tables
+ * of every VMA on every read, which on huge address spaces costs hundreds
+ * of milliseconds with mmap_lock held for read.  Writing "incremental" to
+ * an open smaps_rollup file makes it cache the per-VMA statistics and, on
+ * subsequent reads, re-gather only VMAs that have been touched since the
+ * last soft-dirty clear: a VMA is reused from the cache if its extent is
+ * unchanged, VM_SOFTDIRTY is clear and a scan finds no soft-dirty entries.
+ * The revalidation scan only reads page tables and bails at the first
+ * dirty entry, so it is much cheaper than the full gather, which inspects
+ * every mapped page.
+ *
+ * Intended use is clear_refs(4) once, then periodic reads.  Clearing
+ * soft-dirty again discards the state the cache relies on, which is
+ * detected via mm->soft_dirty_clear_gen and forces a full rebuild.  Note
+ * that events that change the statistics without dirtying anything (page
+ * reclaim, MADV_DONTNEED from another thread) are only reflected once the
+ * affected range is dirtied or the cache is rebuilt.
+ */
+struct smaps_rollup_entry {
+	unsigned long start;
+	unsigned long end;
+	struct mem_size_stats mss;
+};
+
+struct smaps_rollup_cache {
+	unsigned long gen;	/* mm->soft_dirty_clear_gen at build time */
+	unsigned int nr;
+	struct smaps_rollup_entry *entries;	/* sorted by start */
+};
+
+static void mss_add(struct mem_size_stats *dst,
+		    const struct mem_size_stats *src)
+{
+	dst->resident		+= src->resident;
+	dst->shared_clean	+= src->shared_clean;
+	dst->shared_dirty	+= src->shared_dirty;
+	dst->private_clean	+= src->private_clean;
+	dst->private_dirty	+= src->private_dirty;
+	dst->referenced		+= src->referenced;
+	dst->anonymous		+= src->anonymous;
+	dst->lazyfree		+= src->lazyfree;
+	dst->anonymous_thp	+= src->anonymous_thp;
+	dst->shmem_thp		+= src->shmem_thp;
+	dst->file_thp		+= src->file_thp;
+	dst->swap		+= src->swap;
+	dst->shared_hugetlb	+= src->shared_hugetlb;
+	dst->private_hugetlb	+= src->private_hugetlb;
+	dst->pss		+= src->pss;
+	dst->pss_anon		+= src->pss_anon;
+	dst->pss_file		+= src->pss_file;
+	dst->pss_shmem		+= src->pss_shmem;
+	dst->pss_dirty		+= src->pss_dirty;
+	dst->pss_locked		+= src->pss_locked;
+	dst->swap_pss		+= src->swap_pss;
+}
+
+static int smaps_softdirty_pmd_entry(pmd_t *pmd, unsigned long addr,
+				     unsigned long end, struct mm_walk *walk)
+{
+	struct vm_area_struct *vma = walk->vma;
+	bool *dirty = walk->private;
+	pte_t *start_pte, *pte;
+	spinlock_t *ptl;
+
+	ptl = pmd_trans_huge_lock(pmd, vma);
+	if (ptl) {
+		if (pmd_present(*pmd) ? pmd_soft_dirty(*pmd)
+				      : pmd_swp_soft_dirty(*pmd))
+			*dirty = true;
+		spin_unlock(ptl);
+		goto out;
+	}
+
+	if (pmd_trans_unstable(pmd))
+		goto out;
+
+	start_pte = pte_offset_map_lock(vma->vm_mm, pmd, addr, &ptl);
+	for (pte = start_pte; addr != end; pte++, addr += PAGE_SIZE) {
+		pte_t ptent = *pte;
+
+		if (pte_present(ptent) ? pte_soft_dirty(ptent)
+		    : (is_swap_pte(ptent) && pte_swp_soft_dirty(ptent))) {
+			*dirty = true;
+			break;
+		}
+	}
+	pte_unmap_unlock(start_pte, ptl);
+out:
+	cond_resched();
+	/* A positive return value stops the walk. */
+	return *dirty;
+}
+
+static const struct mm_walk_ops smaps_softdirty_walk_ops = {
+	.pmd_entry	= smaps_softdirty_pmd_entry,
+};
+
+/*
+ * Decide whether the vma may have been touched since the last soft-dirty
+ * clear.  Hugetlb vmas don't carry soft-dirty state, so always re-gather
+ * them.
+ */
+static bool smap_vma_softdirty(struct vm_area_struct *vma)
+{
+	bool dirty = false;
+
+	if (vma->vm_flags & VM_SOFTDIRTY)
+		return true;
+	if (is_vm_hugetlb_page(vma))
+		return true;
+	walk_page_vma(vma, &smaps_softdirty_walk_ops, &dirty);
+	return dirty;
+}
+
+/* mmap_lock is held for read; it is not dropped on contention here. */
+static int smap_gather_rollup_cached(struct proc_maps_private *priv,
+				     struct mm_struct *mm,
+				     struct mem_size_stats *mss,
+				     unsigned long *vma_start,
+				     unsigned long *last_vma_end)
+{
+	struct smaps_rollup_cache *cache = priv->rollup_cache;
+	struct smaps_rollup_entry *old = cache->entries, *new;
+	unsigned long gen = mm->soft_dirty_clear_gen;
+	unsigned int nr_old = cache->nr, oi = 0, ni = 0;
+	struct vm_area_struct *vma;
+	VMA_ITERATOR(vmi, mm, 0);
+
+	new = kvmalloc_array(mm->map_count, sizeof(*new),
+			     GFP_KERNEL_ACCOUNT);
+	if (!new)
+		return -ENOMEM;
+
+	/*
+	 * A soft-dirty clear since the cache was built wiped the bits the
+	 * revalidation relies on, so nothing can be reused.
+	 */
+	if (gen != cache->gen)
+		nr_old = 0;
+
+	for_each_vma(vmi, vma) {
+		struct smaps_rollup_entry *ne = &new[ni++];
+		struct smaps_rollup_entry *oe = NULL;
+
+		if (!*last_vma_end)
+			*vma_start = vma->vm_start;
+
+		while (oi < nr_old && old[oi].start < vma->vm_start)
+			oi++;
+		if (oi < nr_old && old[oi].start == vma->vm_start &&
+		    old[oi].end == vma->vm_end)
+			oe = &old[oi];
+
+		if (oe && !smap_vma_softdirty(vma)) {
+			ne->mss = oe->mss;
+		} else {
+			memset(&ne->mss, 0, sizeof(ne->mss));
+			smap_gather_stats(vma, &ne->mss, 0);
+		}
+		ne->start = vma->vm_start;
+		ne->end = vma->vm_end;
+		mss_add(mss, &ne->mss);
+		*last_vma_end = vma->vm_end;
+	}
+
+	cache->gen = gen;
+	cache->nr = ni;
+	cache->entries = new;
+	kvfree(old);
+	return 0;
+}
+
+static void smaps_rollup_cache_free(struct proc_maps_private *priv)
+{
+	if (priv->rollup_cache) {
+		kvfree(priv->rollup_cache->entries);
+		kfree(priv->rollup_cache);
+		priv->rollup_cache = NULL;
+	}
+}
+
+static ssize_t smaps_rollup_write(struct file *file, const char __user *buf,
+				  size_t count, loff_t *ppos)
+{
+	struct seq_file *seq = file->private_data;
+	struct proc_maps_private *priv = seq->private;
+	char buffer[16];
+	char *mode;
+	ssize_t ret = count;
+
+	memset(buffer, 0, sizeof(buffer));
+	if (count > sizeof(buffer) - 1)
+		return -EINVAL;
+	if (copy_from_user(buffer, buf, count))
+		return -EFAULT;
+	mode = strstrip(buffer);
+
+	mutex_lock(&seq->lock);
+	if (!strcmp(mode, "incremental")) {
+		if (!priv->rollup_cache) {
+			priv->rollup_cache = kzalloc(sizeof(*priv->rollup_cache),
+						     GFP_KERNEL_ACCOUNT);
+			if (!priv->rollup_cache)
+				ret = -ENOMEM;
+		}
+	} else if (!strcmp(mode, "full")) {
+		smaps_rollup_cache_free(priv);
+	} else {
+		ret = -EINVAL;
+	}
+	mutex_unlock(&seq->lock);
+
+	return ret;
+}
+#else /* !CONFIG_MEM_SOFT_DIRTY */
+static inline int smap_gather_rollup_cached(struct proc_maps_private *priv,
+					    struct mm_struct *mm,
+					    struct mem_size_stats *mss,
+					    unsigned long *vma_start,
+					    unsigned long *last_vma_end)
+{
+	return -EOPNOTSUPP;
+}
+
+static inline void smaps_rollup_cache_free(struct proc_maps_private *priv)
+{
+}
+
+static ssize_t smaps_rollup_write(struct file *file, const char __user *buf,
+				  size_t count, loff_t *ppos)
+{
+	return -EOPNOTSUPP;
+}
+#endif /* CONFIG_MEM_SOFT_DIRTY */
+
 static int show_smaps_rollup(struct seq_file *m, void *v)
 {
 	struct proc_maps_private *priv = m->private;
@@ -908,6 +1145,18 @@ static int show_smaps_rollup(struct seq_file *m, void *v)
 		goto out_put_mm;
 
 	hold_task_mempolicy(priv);
+
+	if (priv->rollup_cache) {
+		ret = smap_gather_rollup_cached(priv, mm, &mss,
+						&vma_start, &last_vma_end);
+		if (ret) {
+			release_task_mempolicy(priv);
+			mmap_read_unlock(mm);
+			goto out_put_mm;
+		}
+		goto empty_set;
+	}
+
 	vma = vma_next(&vmi);
 
 	if (unlikely(!vma))
@@ -1048,6 +1297,7 @@ static int smaps_rollup_release(struct inode *inode, struct file *file)
 	struct seq_file *seq = file->private_data;
 	struct proc_maps_private *priv = seq->private;
 
+	smaps_rollup_cache_free(priv);
 	if (priv->mm)
 		mmdrop(priv->mm);
 
@@ -1065,6 +1315,7 @@ const struct file_operations proc_pid_smaps_operations = {
 const struct file_operations proc_pid_smaps_rollup_operations = {
 	.open		= smaps_rollup_open,
 	.read		= seq_read,
+	.write		= smaps_rollup_write,
 	.llseek		= seq_lseek,
 	.release	= smaps_rollup_release,
 };
@@ -1296,6 +1547,7 @@ static ssize_t clear_refs_write(struct file *file, const char __user *buf,
 		}
 
 		if (type == CLEAR_REFS_SOFT_DIRTY) {
+			mm->soft_dirty_clear_gen++;
 			for_each_vma(vmi, vma) {
 				if (!(vma->vm_flags & VM_SOFTDIRTY))
 					continue;
@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * /proc/task_stats - packed binary statistics for all thread groups.
+ *
+ * Monitoring agents that sample every process used to open and parse
+ * /proc/pid/stat and /proc/pid/status for each task in turn; the open/
+ * read/close cycle and the text formatting dominate at tens of thousands
+ * of tasks.  This file yields the commonly sampled fields for every
+ * thread group as fixed-size binary records, so one read() returns
+ * thousands of tasks.  Writing a PROC_TASK_STATS_* mask to the open file
+ * restricts which field groups are collected.
+ */
+#include <linux/cred.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/jiffies.h>
+#include <linux/mm.h>
+#include <linux/pid_namespace.h>
+#include <linux/proc_fs.h>
+#include <linux/sched/cputime.h>
+#include <linux/sched/mm.h>
+#include <linux/sched/signal.h>
+#include <linux/sched/task.h>
+#include <linux/seq_file.h>
+#include <linux/time_namespace.h>
+#include <linux/uidgid.h>
+#include <uapi/linux/proc_task_stats.h>
+#include "internal.h"
+
+struct proc_task_stats_private {
+	struct pid_namespace *ns;
+	u64 mask;
+	struct tgid_iter iter;
+};
+
+static void *task_stats_start(struct seq_file *m, loff_t *pos)
+{
+	struct proc_task_stats_private *priv = m->private;
+
+	priv->iter.tgid = *pos;
+	priv->iter.task = NULL;
+	priv->iter = next_tgid(priv->ns, priv->iter);
+	if (!priv->iter.task)
+		return NULL;
+	*pos = priv->iter.tgid;
+	return &priv->iter;
+}
+
+static void *task_stats_next(struct seq_file *m, void *v, loff_t *pos)
+{
+	struct proc_task_stats_private *priv = m->private;
+
+	priv->iter.tgid += 1;
+	priv->iter = next_tgid(priv->ns, priv->iter);
+	*pos = priv->iter.tgid;
+	return priv->iter.task ? &priv->iter : NULL;
+}
+
+static void task_stats_stop(struct seq_file *m, void *v)
+{
+	struct proc_task_stats_private *priv = m->private;
+
+	if (priv->iter.task) {
+		put_task_struct(priv->iter.task);
+		priv->iter.task = NULL;
+	}
+}
+
+static int task_stats_show(struct seq_file *m, void *v)
+{
+	struct proc_task_stats_private *priv = m->private;
+	struct tgid_iter *iter = v;
+	struct task_struct *task = iter->task;
+	struct pid_namespace *ns = priv->ns;
+	struct proc_task_stats rec;
+	unsigned long flags;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.record_len = sizeof(rec);
+	rec.pid = iter->tgid;
+	rec.fields = priv->mask;
+
+	if (priv->mask & PROC_TASK_STATS_BASIC) {
+		rec.state = task_state_to_char(task);
+		rec.flags = task->flags;
+		rec.start_time = nsec_to_clock_t(
+			timens_add_boottime_ns(task->start_boottime));
+	}
+
+	if ((priv->mask & (PROC_TASK_STATS_BASIC | PROC_TASK_STATS_CPU |
+			   PROC_TASK_STATS_MEM)) &&
+	    lock_task_sighand(task, &flags)) {
+		struct signal_struct *sig = task->signal;
+
+		if (priv->mask & PROC_TASK_STATS_BASIC) {
+			rec.num_threads = get_nr_threads(task);
+			rec.ppid = task_tgid_nr_ns(task->real_parent, ns);
+			rec.pgid = task_pgrp_nr_ns(task, ns);
+			rec.sid = task_session_nr_ns(task, ns);
+		}
+		if (priv->mask & PROC_TASK_STATS_CPU) {
+			u64 utime, stime;
+
+			thread_group_cputime_adjusted(task, &utime, &stime);
+			rec.utime = nsec_to_clock_t(utime);
+			rec.stime = nsec_to_clock_t(stime);
+			rec.cutime = nsec_to_clock_t(sig->cutime);
+			rec.cstime = nsec_to_clock_t(sig->cstime);
+		}
+		if (priv->mask & PROC_TASK_STATS_MEM) {
+			struct task_struct *t = task;
+
+			rec.min_flt = sig->min_flt;
+			rec.maj_flt = sig->maj_flt;
+			do {
+				rec.min_flt += t->min_flt;
+				rec.maj_flt += t->maj_flt;
+			} while_each_thread(task, t);
+			rec.rsslim = READ_ONCE(sig->rlim[RLIMIT_RSS].rlim_cur);
+		}
+		unlock_task_sighand(task, &flags);
+	}
+
+	if (priv->mask & PROC_TASK_STATS_CPU) {
+		rec.priority = task_prio(task);
+		rec.nice = task_nice(task);
+	}
+
+	if (priv->mask & PROC_TASK_STATS_MEM) {
+		struct mm_struct *mm = get_task_mm(task);
+
+		if (mm) {
+			rec.vsize = task_vsize(mm);
+			rec.rss = get_mm_rss(mm);
+			mmput(mm);
+		}
+	}
+
+	if (priv->mask & PROC_TASK_STATS_CREDS) {
+		struct user_namespace *user_ns = seq_user_ns(m);
+		const struct cred *cred = get_task_cred(task);
+
+		rec.uid = from_kuid_munged(user_ns, cred->uid);
+		rec.euid = from_kuid_munged(user_ns, cred->euid);
+		rec.suid = from_kuid_munged(user_ns, cred->suid);
+		rec.fsuid = from_kuid_munged(user_ns, cred->fsuid);
+		rec.gid = from_kgid_munged(user_ns, cred->gid);
+		rec.egid = from_kgid_munged(user_ns, cred->egid);
+		rec.sgid = from_kgid_munged(user_ns, cred->sgid);
+		rec.fsgid = from_kgid_munged(user_ns, cred->fsgid);
+		put_cred(cred);
+	}
+
+	seq_write(m, &rec, sizeof(rec));
+	return 0;
+}
+
+static const struct seq_operations task_stats_ops = {
+	.start	= task_stats_start,
+	.next	= task_stats_next,
+	.stop	= task_stats_stop,
+	.show	= task_stats_show,
+};
+
+static int task_stats_open(struct inode *inode, struct file *file)
+{
+	struct proc_task_stats_private *priv;
+
+	priv = __seq_open_private(file, &task_stats_ops, sizeof(*priv));
+	if (!priv)
+		return -ENOMEM;
+	priv->ns = proc_pid_ns(inode->i_sb);
+	priv->mask = PROC_TASK_STATS_ALL;
+	return 0;
+}
+
+/*
+ * Restrict the field groups collected per record so that samplers that
+ * don't need e.g. the adjusted group cputimes don't pay for them.
+ */
+static ssize_t task_stats_write(struct file *file, const char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	struct seq_file *m = file->private_data;
+	struct proc_task_stats_private *priv = m->private;
+	u64 mask;
+	int ret;
+
+	ret = kstrtou64_from_user(buf, count, 0, &mask);
+	if (ret < 0)
+		return ret;
+	if (mask & ~(u64)PROC_TASK_STATS_ALL)
+		return -EINVAL;
+	priv->mask = mask;
+	return count;
+}
+
+static const struct proc_ops task_stats_proc_ops = {
+	.proc_open	= task_stats_open,
+	.proc_read	= seq_read,
+	.proc_write	= task_stats_write,
+	.proc_lseek	= seq_lseek,
+	.proc_release	= seq_release_private,
+};
+
+static int __init proc_task_stats_init(void)
+{
+	proc_create("task_stats", 0400, NULL, &task_stats_proc_ops);
+	return 0;
+}
+fs_initcall(proc_task_stats_init);
@@ -578,7 +578,8 @@ fail:
 static int ramoops_init_prz(const char *name,
 			    struct device *dev, struct ramoops_context *cxt,
 			    struct persistent_ram_zone **prz,
-			    phys_addr_t *paddr, size_t sz, u32 sig)
+			    phys_addr_t *paddr, size_t sz, u32 sig,
+			    u32 flags)
 {
 	char *label;
 
@@ -594,7 +595,8 @@ static int ramoops_init_prz(const char *name,
 
 	label = kasprintf(GFP_KERNEL, "ramoops:%s", name);
 	*prz = persistent_ram_new(*paddr, sz, sig, &cxt->ecc_info,
-				  cxt->memtype, PRZ_FLAG_ZAP_OLD, label);
+				  cxt->memtype, PRZ_FLAG_ZAP_OLD | flags,
+				  label);
 	kfree(label);
 	if (IS_ERR(*prz)) {
 		int err = PTR_ERR(*prz);
@@ -787,12 +789,16 @@ static int ramoops_probe(struct platform_device *pdev)
 		goto fail_init;
 
 	err = ramoops_init_prz("console", dev, cxt, &cxt->cprz, &paddr,
-			       cxt->console_size, 0);
+			       cxt->console_size, 0, 0);
 	if (err)
 		goto fail_init;
 
+	/*
+	 * pmsg is never written on the panic path, so its ECC updates can
+	 * be batched and deferred to keep userspace logging cheap.
+	 */
 	err = ramoops_init_prz("pmsg", dev, cxt, &cxt->mprz, &paddr,
-				cxt->pmsg_size, 0);
+				cxt->pmsg_size, 0, PRZ_FLAG_ECC_ASYNC);
 	if (err)
 		goto fail_init;
 
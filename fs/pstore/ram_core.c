@@ -157,6 +157,67 @@ static void persistent_ram_update_header_ecc(struct persistent_ram_zone *prz)
 				  prz->par_header);
 }
 
+/*
+ * Fold a freshly written byte range into the dirty range covered by the
+ * next run of ecc_work.  Sequential writes extend the pending range; a
+ * discontiguous write simply widens it to the whole zone rather than
+ * tracking multiple ranges.
+ */
+static void notrace persistent_ram_ecc_dirty(struct persistent_ram_zone *prz,
+	unsigned int start, unsigned int count)
+{
+	unsigned long flags;
+
+	if (!prz->ecc_info.ecc_size)
+		return;
+
+	raw_spin_lock_irqsave(&prz->buffer_lock, flags);
+	if (!prz->ecc_dirty_count) {
+		prz->ecc_dirty_start = start;
+		prz->ecc_dirty_count = count;
+	} else if ((prz->ecc_dirty_start + prz->ecc_dirty_count) %
+		   prz->buffer_size == start) {
+		prz->ecc_dirty_count = min(prz->ecc_dirty_count + count,
+					   prz->buffer_size);
+	} else {
+		prz->ecc_dirty_start = 0;
+		prz->ecc_dirty_count = prz->buffer_size;
+	}
+	raw_spin_unlock_irqrestore(&prz->buffer_lock, flags);
+
+	schedule_work(&prz->ecc_work);
+}
+
+static void persistent_ram_ecc_work(struct work_struct *work)
+{
+	struct persistent_ram_zone *prz =
+		container_of(work, struct persistent_ram_zone, ecc_work);
+	unsigned int start;
+	size_t count;
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&prz->buffer_lock, flags);
+	start = prz->ecc_dirty_start;
+	count = prz->ecc_dirty_count;
+	prz->ecc_dirty_count = 0;
+	raw_spin_unlock_irqrestore(&prz->buffer_lock, flags);
+
+	if (!count)
+		return;
+
+	if (count >= prz->buffer_size) {
+		persistent_ram_update_ecc(prz, 0, prz->buffer_size);
+	} else if (start + count > prz->buffer_size) {
+		persistent_ram_update_ecc(prz, start,
+					  prz->buffer_size - start);
+		persistent_ram_update_ecc(prz, 0,
+					  start + count - prz->buffer_size);
+	} else {
+		persistent_ram_update_ecc(prz, start, count);
+	}
+	persistent_ram_update_header_ecc(prz);
+}
+
 static void persistent_ram_ecc_old(struct persistent_ram_zone *prz)
 {
 	struct persistent_ram_buffer *buffer = prz->buffer;
@@ -277,7 +338,10 @@ static void notrace persistent_ram_update(struct persistent_ram_zone *prz,
 {
 	struct persistent_ram_buffer *buffer = prz->buffer;
 	memcpy_toio(buffer->data + start, s, count);
-	persistent_ram_update_ecc(prz, start, count);
+	if (prz->flags & PRZ_FLAG_ECC_ASYNC)
+		persistent_ram_ecc_dirty(prz, start, count);
+	else
+		persistent_ram_update_ecc(prz, start, count);
 }
 
 static int notrace persistent_ram_update_user(struct persistent_ram_zone *prz,
@@ -286,7 +350,10 @@ static int notrace persistent_ram_update_user(struct persistent_ram_zone *prz,
 	struct persistent_ram_buffer *buffer = prz->buffer;
 	int ret = unlikely(copy_from_user(buffer->data + start, s, count)) ?
 		-EFAULT : 0;
-	persistent_ram_update_ecc(prz, start, count);
+	if (prz->flags & PRZ_FLAG_ECC_ASYNC)
+		persistent_ram_ecc_dirty(prz, start, count);
+	else
+		persistent_ram_update_ecc(prz, start, count);
 	return ret;
 }
 
@@ -338,7 +405,9 @@ int notrace persistent_ram_write(struct persistent_ram_zone *prz,
 	}
 	persistent_ram_update(prz, s, start, c);
 
-	persistent_ram_update_header_ecc(prz);
+	/* For async-ECC zones the header parity is refreshed by ecc_work. */
+	if (!(prz->flags & PRZ_FLAG_ECC_ASYNC))
+		persistent_ram_update_header_ecc(prz);
 
 	return count;
 }
@@ -368,7 +437,8 @@ int notrace persistent_ram_write_user(struct persistent_ram_zone *prz,
 	if (likely(!ret))
 		ret = persistent_ram_update_user(prz, s, start, c);
 
-	persistent_ram_update_header_ecc(prz);
+	if (!(prz->flags & PRZ_FLAG_ECC_ASYNC))
+		persistent_ram_update_header_ecc(prz);
 
 	return unlikely(ret) ? ret : count;
 }
@@ -559,6 +629,9 @@ void persistent_ram_free(struct persistent_ram_zone **_prz)
 	if (!prz)
 		return;
 
+	/* Settle any deferred parity updates before tearing down the map. */
+	flush_work(&prz->ecc_work);
+
 	if (prz->vaddr) {
 		if (pfn_valid(prz->paddr >> PAGE_SHIFT)) {
 			/* We must vunmap() at page-granularity. */
@@ -597,9 +670,17 @@ struct persistent_ram_zone *persistent_ram_new(phys_addr_t start, size_t size,
 
 	/* Initialize general buffer state. */
 	raw_spin_lock_init(&prz->buffer_lock);
+	INIT_WORK(&prz->ecc_work, persistent_ram_ecc_work);
 	prz->flags = flags;
 	prz->label = kstrdup(label, GFP_KERNEL);
 
+	/* The dirty-range bookkeeping relies on the buffer lock. */
+	if ((flags & PRZ_FLAG_ECC_ASYNC) && (flags & PRZ_FLAG_NO_LOCK)) {
+		pr_err("async ECC requires a locked zone\n");
+		ret = -EINVAL;
+		goto err;
+	}
+
 	ret = persistent_ram_buffer_map(start, size, prz, memtype);
 	if (ret)
 		goto err;
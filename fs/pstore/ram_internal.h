@@ -6,6 +6,7 @@
  */
 
 #include <linux/pstore_ram.h>
+#include <linux/workqueue.h>
 
 /*
  * Choose whether access to the RAM zone requires locking or not.  If a zone
@@ -18,6 +19,15 @@
  * getting wiped after its contents get copied out after boot.
  */
 #define PRZ_FLAG_ZAP_OLD	BIT(1)
+/*
+ * Defer ECC updates to a workqueue instead of recomputing parity on every
+ * write.  Data copies remain synchronous; only the parity lags, so a crash
+ * can leave the most recently written blocks without valid ECC.  Only
+ * suitable for zones that are never written on the panic path (pmsg), and
+ * incompatible with PRZ_FLAG_NO_LOCK since the dirty range is tracked
+ * under @buffer_lock.
+ */
+#define PRZ_FLAG_ECC_ASYNC	BIT(2)
 
 /**
  * struct persistent_ram_zone - Details of a persistent RAM zone (PRZ)
@@ -49,6 +59,13 @@
  *	ECC uncorrectable bytes accounting since boot
  * @ecc_info:
  *	ECC configuration details
+ * @ecc_work:
+ *	deferred parity update for PRZ_FLAG_ECC_ASYNC zones
+ * @ecc_dirty_start:
+ *	offset of the first byte whose parity is stale
+ * @ecc_dirty_count:
+ *	bytes (circular, may wrap) awaiting a parity update; both fields
+ *	are protected by @buffer_lock
  *
  * @old_log:
  *	saved copy of @buffer->data prior to most recent wipe
@@ -74,6 +91,9 @@ struct persistent_ram_zone {
 	int corrected_bytes;
 	int bad_blocks;
 	struct persistent_ram_ecc_info ecc_info;
+	struct work_struct ecc_work;
+	unsigned int ecc_dirty_start;
+	size_t ecc_dirty_count;
 
 	char *old_log;
 	size_t old_log_size;
@@ -39,12 +39,25 @@
 #include <linux/spinlock.h>
 #include <linux/wait.h>
 #include <linux/pagemap.h>
+#include <linux/hash.h>
+#include <linux/cpumask.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
 #include "squashfs.h"
 #include "page_actor.h"
 
+/*
+ * Select the shard responsible for a block address.
+ */
+static struct squashfs_cache_shard *squashfs_cache_shard(
+	struct squashfs_cache *cache, u64 block)
+{
+	if (cache->nr_shards == 1)
+		return &cache->shard[0];
+	return &cache->shard[(u32)hash_64(block, 32) % cache->nr_shards];
+}
+
 /*
  * Look-up block in cache, and increment usage count.  If not in cache, read
  * and decompress it from disk.
@@ -52,31 +65,32 @@
 struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 	struct squashfs_cache *cache, u64 block, int length)
 {
+	struct squashfs_cache_shard *shard = squashfs_cache_shard(cache, block);
 	int i, n;
 	struct squashfs_cache_entry *entry;
 
-	spin_lock(&cache->lock);
+	spin_lock(&shard->lock);
 
 	while (1) {
-		for (i = cache->curr_blk, n = 0; n < cache->entries; n++) {
-			if (cache->entry[i].block == block) {
-				cache->curr_blk = i;
+		for (i = shard->curr_blk, n = 0; n < shard->entries; n++) {
+			if (shard->entry[i].block == block) {
+				shard->curr_blk = i;
 				break;
 			}
-			i = (i + 1) % cache->entries;
+			i = (i + 1) % shard->entries;
 		}
 
-		if (n == cache->entries) {
+		if (n == shard->entries) {
 			/*
 			 * Block not in cache, if all cache entries are used
 			 * go to sleep waiting for one to become available.
 			 */
-			if (cache->unused == 0) {
-				cache->num_waiters++;
-				spin_unlock(&cache->lock);
-				wait_event(cache->wait_queue, cache->unused);
-				spin_lock(&cache->lock);
-				cache->num_waiters--;
+			if (shard->unused == 0) {
+				shard->num_waiters++;
+				spin_unlock(&shard->lock);
+				wait_event(shard->wait_queue, shard->unused);
+				spin_lock(&shard->lock);
+				shard->num_waiters--;
 				continue;
 			}
 
@@ -85,32 +99,33 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 			 * round-robin strategy is used to choose the entry to
 			 * be evicted from the cache.
 			 */
-			i = cache->next_blk;
-			for (n = 0; n < cache->entries; n++) {
-				if (cache->entry[i].refcount == 0)
+			i = shard->next_blk;
+			for (n = 0; n < shard->entries; n++) {
+				if (shard->entry[i].refcount == 0)
 					break;
-				i = (i + 1) % cache->entries;
+				i = (i + 1) % shard->entries;
 			}
 
-			cache->next_blk = (i + 1) % cache->entries;
-			entry = &cache->entry[i];
+			shard->next_blk = (i + 1) % shard->entries;
+			entry = &shard->entry[i];
 
 			/*
 			 * Initialise chosen cache entry, and fill it in from
 			 * disk.
 			 */
-			cache->unused--;
+			atomic_inc(&cache->misses);
+			shard->unused--;
 			entry->block = block;
 			entry->refcount = 1;
 			entry->pending = 1;
 			entry->num_waiters = 0;
 			entry->error = 0;
-			spin_unlock(&cache->lock);
+			spin_unlock(&shard->lock);
 
 			entry->length = squashfs_read_data(sb, block, length,
 				&entry->next_index, entry->actor);
 
-			spin_lock(&cache->lock);
+			spin_lock(&shard->lock);
 
 			if (entry->length < 0)
 				entry->error = entry->length;
@@ -123,10 +138,10 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 			 * waiting for it to become available.
 			 */
 			if (entry->num_waiters) {
-				spin_unlock(&cache->lock);
+				spin_unlock(&shard->lock);
 				wake_up_all(&entry->wait_queue);
 			} else
-				spin_unlock(&cache->lock);
+				spin_unlock(&shard->lock);
 
 			goto out;
 		}
@@ -137,9 +152,10 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 		 * previously unused there's one less cache entry available
 		 * for reuse.
 		 */
-		entry = &cache->entry[i];
+		atomic_inc(&cache->hits);
+		entry = &shard->entry[i];
 		if (entry->refcount == 0)
-			cache->unused--;
+			shard->unused--;
 		entry->refcount++;
 
 		/*
@@ -148,10 +164,10 @@ struct squashfs_cache_entry *squashfs_cache_get(struct super_block *sb,
 		 */
 		if (entry->pending) {
 			entry->num_waiters++;
-			spin_unlock(&cache->lock);
+			spin_unlock(&shard->lock);
 			wait_event(entry->wait_queue, !entry->pending);
 		} else
-			spin_unlock(&cache->lock);
+			spin_unlock(&shard->lock);
 
 		goto out;
 	}
@@ -172,23 +188,23 @@ out:
  */
 void squashfs_cache_put(struct squashfs_cache_entry *entry)
 {
-	struct squashfs_cache *cache = entry->cache;
+	struct squashfs_cache_shard *shard = entry->shard;
 
-	spin_lock(&cache->lock);
+	spin_lock(&shard->lock);
 	entry->refcount--;
 	if (entry->refcount == 0) {
-		cache->unused++;
+		shard->unused++;
 		/*
 		 * If there's any processes waiting for a block to become
 		 * available, wake one up.
 		 */
-		if (cache->num_waiters) {
-			spin_unlock(&cache->lock);
-			wake_up(&cache->wait_queue);
+		if (shard->num_waiters) {
+			spin_unlock(&shard->lock);
+			wake_up(&shard->wait_queue);
 			return;
 		}
 	}
-	spin_unlock(&cache->lock);
+	spin_unlock(&shard->lock);
 }
 
 /*
@@ -196,34 +212,63 @@ void squashfs_cache_put(struct squashfs_cache_entry *entry)
  */
 void squashfs_cache_delete(struct squashfs_cache *cache)
 {
-	int i, j;
+	int i, j, n;
 
 	if (cache == NULL)
 		return;
 
-	for (i = 0; i < cache->entries; i++) {
-		if (cache->entry[i].data) {
-			for (j = 0; j < cache->pages; j++)
-				kfree(cache->entry[i].data[j]);
-			kfree(cache->entry[i].data);
+	for (n = 0; n < cache->nr_shards; n++) {
+		struct squashfs_cache_shard *shard = &cache->shard[n];
+
+		if (shard->entry == NULL)
+			continue;
+
+		for (i = 0; i < shard->entries; i++) {
+			if (shard->entry[i].data) {
+				for (j = 0; j < cache->pages; j++)
+					kfree(shard->entry[i].data[j]);
+				kfree(shard->entry[i].data);
+			}
+			kfree(shard->entry[i].actor);
 		}
-		kfree(cache->entry[i].actor);
+
+		kfree(shard->entry);
 	}
 
-	kfree(cache->entry);
+	kfree(cache->shard);
 	kfree(cache);
 }
 
 
+/*
+ * Scale a cache's entry count with the parallelism of the machine.  The
+ * result is never less than the traditional base value, and is capped both
+ * by max and by limit, which callers derive from the image itself (e.g.
+ * the number of fragments) so small images don't get oversized caches.
+ */
+int squashfs_cache_scale_entries(int base, int max, long long limit)
+{
+	int entries = max_t(int, base, num_online_cpus());
+
+	entries = min(entries, max);
+	if (limit && limit < entries)
+		entries = limit;
+	return max(entries, 1);
+}
+
+
 /*
  * Initialise cache allocating the specified number of entries, each of
  * size block_size.  To avoid vmalloc fragmentation issues each entry
  * is allocated as a sequence of kmalloced PAGE_SIZE buffers.
+ *
+ * The entries are spread over one shard per CPU (at most one entry per
+ * shard) so that lookups of different blocks contend on different locks.
  */
 struct squashfs_cache *squashfs_cache_init(char *name, int entries,
 	int block_size)
 {
-	int i, j;
+	int i, j, n, spread;
 	struct squashfs_cache *cache = kzalloc(sizeof(*cache), GFP_KERNEL);
 
 	if (cache == NULL) {
@@ -231,49 +276,73 @@ struct squashfs_cache *squashfs_cache_init(char *name, int entries,
 		return NULL;
 	}
 
-	cache->entry = kcalloc(entries, sizeof(*(cache->entry)), GFP_KERNEL);
-	if (cache->entry == NULL) {
-		ERROR("Failed to allocate %s cache\n", name);
-		goto cleanup;
-	}
-
-	cache->curr_blk = 0;
-	cache->next_blk = 0;
-	cache->unused = entries;
 	cache->entries = entries;
+	cache->nr_shards = clamp(num_online_cpus(), 1, entries);
 	cache->block_size = block_size;
 	cache->pages = block_size >> PAGE_SHIFT;
 	cache->pages = cache->pages ? cache->pages : 1;
 	cache->name = name;
-	cache->num_waiters = 0;
-	spin_lock_init(&cache->lock);
-	init_waitqueue_head(&cache->wait_queue);
-
-	for (i = 0; i < entries; i++) {
-		struct squashfs_cache_entry *entry = &cache->entry[i];
-
-		init_waitqueue_head(&cache->entry[i].wait_queue);
-		entry->cache = cache;
-		entry->block = SQUASHFS_INVALID_BLK;
-		entry->data = kcalloc(cache->pages, sizeof(void *), GFP_KERNEL);
-		if (entry->data == NULL) {
-			ERROR("Failed to allocate %s cache entry\n", name);
+	atomic_set(&cache->hits, 0);
+	atomic_set(&cache->misses, 0);
+
+	cache->shard = kcalloc(cache->nr_shards, sizeof(*cache->shard),
+			       GFP_KERNEL);
+	if (cache->shard == NULL) {
+		ERROR("Failed to allocate %s cache\n", name);
+		goto cleanup;
+	}
+
+	spread = entries;
+	for (n = 0; n < cache->nr_shards; n++) {
+		struct squashfs_cache_shard *shard = &cache->shard[n];
+
+		shard->cache = cache;
+		shard->entries = DIV_ROUND_UP(spread, cache->nr_shards - n);
+		spread -= shard->entries;
+		shard->curr_blk = 0;
+		shard->next_blk = 0;
+		shard->unused = shard->entries;
+		shard->num_waiters = 0;
+		spin_lock_init(&shard->lock);
+		init_waitqueue_head(&shard->wait_queue);
+
+		shard->entry = kcalloc(shard->entries, sizeof(*shard->entry),
+				       GFP_KERNEL);
+		if (shard->entry == NULL) {
+			ERROR("Failed to allocate %s cache\n", name);
 			goto cleanup;
 		}
 
-		for (j = 0; j < cache->pages; j++) {
-			entry->data[j] = kmalloc(PAGE_SIZE, GFP_KERNEL);
-			if (entry->data[j] == NULL) {
-				ERROR("Failed to allocate %s buffer\n", name);
+		for (i = 0; i < shard->entries; i++) {
+			struct squashfs_cache_entry *entry = &shard->entry[i];
+
+			init_waitqueue_head(&entry->wait_queue);
+			entry->shard = shard;
+			entry->block = SQUASHFS_INVALID_BLK;
+			entry->data = kcalloc(cache->pages, sizeof(void *),
+					      GFP_KERNEL);
+			if (entry->data == NULL) {
+				ERROR("Failed to allocate %s cache entry\n",
+				      name);
 				goto cleanup;
 			}
-		}
 
-		entry->actor = squashfs_page_actor_init(entry->data,
-						cache->pages, 0);
-		if (entry->actor == NULL) {
-			ERROR("Failed to allocate %s cache entry\n", name);
-			goto cleanup;
+			for (j = 0; j < cache->pages; j++) {
+				entry->data[j] = kmalloc(PAGE_SIZE, GFP_KERNEL);
+				if (entry->data[j] == NULL) {
+					ERROR("Failed to allocate %s buffer\n",
+					      name);
+					goto cleanup;
+				}
+			}
+
+			entry->actor = squashfs_page_actor_init(entry->data,
+							cache->pages, 0);
+			if (entry->actor == NULL) {
+				ERROR("Failed to allocate %s cache entry\n",
+				      name);
+				goto cleanup;
+			}
 		}
 	}
 
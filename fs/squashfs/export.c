@@ -27,12 +27,85 @@
 #include <linux/dcache.h>
 #include <linux/exportfs.h>
 #include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/shrinker.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
 #include "squashfs_fs_i.h"
 #include "squashfs.h"
 
+/*
+ * Repeated export lookups (NFS filehandle decode, overlayfs lower layer
+ * origin lookups) each pay a metadata block decompress to read a single
+ * eight byte entry from the inode lookup table.  To avoid this the
+ * decompressed lookup blocks are cached, populated lazily on first use,
+ * giving O(1) array access for subsequent lookups of any inode in the
+ * same block.  A registered shrinker releases cached blocks under memory
+ * pressure; lookups then simply fall back to reading the metadata again.
+ */
+struct squashfs_export_index {
+	spinlock_t		lock;
+	unsigned int		nr_chunks;
+	unsigned int		nr_cached;
+	__le64			**chunk;
+	struct shrinker		shrinker;
+};
+
+/*
+ * Decompress lookup block blk in its entirety and cache it, returning the
+ * entry at byte offset within it.  Falls back to the caller's slow path
+ * on allocation failure.
+ */
+static int squashfs_export_index_lookup(struct super_block *sb, int blk,
+	int offset, __le64 *inode)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	struct squashfs_export_index *index = msblk->export_index;
+	unsigned int bytes;
+	__le64 *chunk;
+	u64 start;
+	int zero = 0, err;
+
+	spin_lock(&index->lock);
+	chunk = index->chunk[blk];
+	if (chunk) {
+		*inode = chunk[offset / sizeof(__le64)];
+		spin_unlock(&index->lock);
+		return 0;
+	}
+	spin_unlock(&index->lock);
+
+	bytes = min_t(unsigned int, SQUASHFS_METADATA_SIZE,
+		SQUASHFS_LOOKUP_BYTES(msblk->inodes) -
+		blk * SQUASHFS_METADATA_SIZE);
+
+	chunk = kmalloc(bytes, GFP_KERNEL);
+	if (chunk == NULL)
+		return -ENOMEM;
+
+	start = le64_to_cpu(msblk->inode_lookup_table[blk]);
+
+	err = squashfs_read_metadata(sb, chunk, &start, &zero, bytes);
+	if (err < 0) {
+		kfree(chunk);
+		return err;
+	}
+
+	spin_lock(&index->lock);
+	if (index->chunk[blk] == NULL) {
+		index->chunk[blk] = chunk;
+		index->nr_cached++;
+		chunk = NULL;
+	}
+	*inode = index->chunk[blk][offset / sizeof(__le64)];
+	spin_unlock(&index->lock);
+
+	/* lost the race to populate the block */
+	kfree(chunk);
+	return 0;
+}
+
 /*
  * Look-up inode number (ino) in table, returning the inode location.
  */
@@ -50,12 +123,17 @@ static long long squashfs_inode_lookup(struct super_block *sb, int ino_num)
 	if (ino_num == 0 || (ino_num - 1) >= msblk->inodes)
 		return -EINVAL;
 
+	if (msblk->export_index &&
+	    squashfs_export_index_lookup(sb, blk, offset, &ino) == 0)
+		goto found;
+
 	start = le64_to_cpu(msblk->inode_lookup_table[blk]);
 
 	err = squashfs_read_metadata(sb, &ino, &start, &offset, sizeof(ino));
 	if (err < 0)
 		return err;
 
+found:
 	TRACE("squashfs_inode_lookup, inode = 0x%llx\n",
 		(u64) le64_to_cpu(ino));
 
@@ -172,6 +250,95 @@ __le64 *squashfs_read_inode_lookup_table(struct super_block *sb,
 }
 
 
+static unsigned long squashfs_export_index_count(struct shrinker *shrink,
+	struct shrink_control *sc)
+{
+	struct squashfs_export_index *index = container_of(shrink,
+		struct squashfs_export_index, shrinker);
+
+	return index->nr_cached ? : SHRINK_EMPTY;
+}
+
+
+static unsigned long squashfs_export_index_scan(struct shrinker *shrink,
+	struct shrink_control *sc)
+{
+	struct squashfs_export_index *index = container_of(shrink,
+		struct squashfs_export_index, shrinker);
+	unsigned long freed = 0;
+	unsigned int n;
+
+	spin_lock(&index->lock);
+	for (n = 0; n < index->nr_chunks && freed < sc->nr_to_scan; n++) {
+		if (index->chunk[n] == NULL)
+			continue;
+		kfree(index->chunk[n]);
+		index->chunk[n] = NULL;
+		index->nr_cached--;
+		freed++;
+	}
+	spin_unlock(&index->lock);
+
+	return freed;
+}
+
+
+/*
+ * Set up the lazily populated lookup block cache.  The cache is an
+ * optimisation only, failure here is not fatal and simply leaves export
+ * lookups on the uncached path.
+ */
+void squashfs_export_index_init(struct super_block *sb)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	struct squashfs_export_index *index;
+
+	index = kzalloc(sizeof(*index), GFP_KERNEL);
+	if (index == NULL)
+		return;
+
+	index->nr_chunks = SQUASHFS_LOOKUP_BLOCKS(msblk->inodes);
+	index->chunk = kcalloc(index->nr_chunks, sizeof(*index->chunk),
+		GFP_KERNEL);
+	if (index->chunk == NULL) {
+		kfree(index);
+		return;
+	}
+
+	spin_lock_init(&index->lock);
+	index->shrinker.count_objects = squashfs_export_index_count;
+	index->shrinker.scan_objects = squashfs_export_index_scan;
+	index->shrinker.seeks = DEFAULT_SEEKS;
+
+	if (register_shrinker(&index->shrinker, "squashfs-export:%s",
+			sb->s_id)) {
+		kfree(index->chunk);
+		kfree(index);
+		return;
+	}
+
+	msblk->export_index = index;
+}
+
+
+void squashfs_export_index_destroy(struct squashfs_sb_info *msblk)
+{
+	struct squashfs_export_index *index = msblk->export_index;
+	unsigned int n;
+
+	if (index == NULL)
+		return;
+
+	unregister_shrinker(&index->shrinker);
+
+	for (n = 0; n < index->nr_chunks; n++)
+		kfree(index->chunk[n]);
+	kfree(index->chunk);
+	kfree(index);
+	msblk->export_index = NULL;
+}
+
+
 const struct export_operations squashfs_export_ops = {
 	.fh_to_dentry = squashfs_fh_to_dentry,
 	.fh_to_parent = squashfs_fh_to_parent,
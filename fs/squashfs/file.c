@@ -34,6 +34,8 @@
 #include <linux/string.h>
 #include <linux/pagemap.h>
 #include <linux/mutex.h>
+#include <linux/workqueue.h>
+#include <linux/wait_bit.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -533,6 +535,111 @@ out:
 	return error;
 }
 
+/*
+ * Readahead datablocks are read and decompressed from worker context, one
+ * work item per datablock, so that the read for one block is issued while
+ * earlier blocks are still decompressing and the decompressions themselves
+ * spread over the available CPUs (the percpu and multi decompressor
+ * backends run their streams concurrently; the single backend serialises
+ * on its mutex as before).  The issuing thread waits for all of its works
+ * before returning, so the pages, the inode and the superblock are pinned
+ * for the whole pipeline.
+ */
+struct squashfs_ra_ctx {
+	struct super_block *sb;
+	atomic_t pending;
+};
+
+struct squashfs_ra_work {
+	struct work_struct work;
+	struct squashfs_ra_ctx *ctx;
+	struct page **pages;
+	unsigned int nr_pages;
+	u64 block;
+	int bsize;
+	unsigned int expected;
+	bool file_end_block;
+};
+
+static void squashfs_readahead_block_work(struct work_struct *work)
+{
+	struct squashfs_ra_work *w = container_of(work,
+					struct squashfs_ra_work, work);
+	struct squashfs_ra_ctx *ctx = w->ctx;
+	struct squashfs_sb_info *msblk = ctx->sb->s_fs_info;
+	struct squashfs_page_actor *actor;
+	struct page *last_page;
+	int i, res;
+
+	actor = squashfs_page_actor_init_special(msblk, w->pages, w->nr_pages,
+						 w->expected);
+	if (!actor)
+		goto out_pages;
+
+	res = squashfs_read_data(ctx->sb, w->block, w->bsize, NULL, actor);
+
+	last_page = squashfs_page_actor_free(actor);
+
+	if (res == w->expected) {
+		int bytes;
+
+		/* Last page (if present) may have trailing bytes not filled */
+		bytes = res % PAGE_SIZE;
+		if (w->file_end_block && bytes && last_page)
+			memzero_page(last_page, bytes, PAGE_SIZE - bytes);
+
+		for (i = 0; i < w->nr_pages; i++) {
+			flush_dcache_page(w->pages[i]);
+			SetPageUptodate(w->pages[i]);
+		}
+	}
+
+out_pages:
+	for (i = 0; i < w->nr_pages; i++) {
+		unlock_page(w->pages[i]);
+		put_page(w->pages[i]);
+	}
+	kfree(w->pages);
+	kfree(w);
+	if (atomic_dec_and_test(&ctx->pending))
+		wake_up_var(&ctx->pending);
+}
+
+static int squashfs_readahead_submit(struct squashfs_ra_ctx *ctx,
+	struct page **pages, unsigned int nr_pages, u64 block, int bsize,
+	unsigned int expected, bool file_end_block)
+{
+	struct squashfs_ra_work *w;
+
+	w = kmalloc(sizeof(*w), GFP_KERNEL);
+	if (!w)
+		return -ENOMEM;
+
+	w->pages = kmemdup(pages, nr_pages * sizeof(struct page *),
+			   GFP_KERNEL);
+	if (!w->pages) {
+		kfree(w);
+		return -ENOMEM;
+	}
+
+	w->ctx = ctx;
+	w->nr_pages = nr_pages;
+	w->block = block;
+	w->bsize = bsize;
+	w->expected = expected;
+	w->file_end_block = file_end_block;
+
+	atomic_inc(&ctx->pending);
+	INIT_WORK(&w->work, squashfs_readahead_block_work);
+	queue_work(system_unbound_wq, &w->work);
+	return 0;
+}
+
+static void squashfs_readahead_wait(struct squashfs_ra_ctx *ctx)
+{
+	wait_var_event(&ctx->pending, atomic_read(&ctx->pending) == 0);
+}
+
 static void squashfs_readahead(struct readahead_control *ractl)
 {
 	struct inode *inode = ractl->mapping->host;
@@ -541,7 +648,10 @@ static void squashfs_readahead(struct readahead_control *ractl)
 	unsigned short shift = msblk->block_log - PAGE_SHIFT;
 	loff_t start = readahead_pos(ractl) & ~mask;
 	size_t len = readahead_length(ractl) + readahead_pos(ractl) - start;
-	struct squashfs_page_actor *actor;
+	struct squashfs_ra_ctx ctx = {
+		.sb = inode->i_sb,
+		.pending = ATOMIC_INIT(0),
+	};
 	unsigned int nr_pages = 0;
 	struct page **pages;
 	int i, file_end = i_size_read(inode) >> msblk->block_log;
@@ -558,7 +668,6 @@ static void squashfs_readahead(struct readahead_control *ractl)
 		int res, bsize;
 		u64 block = 0;
 		unsigned int expected;
-		struct page *last_page;
 
 		expected = start >> msblk->block_log == file_end ?
 			   (i_size_read(inode) & (msblk->block_size - 1)) :
@@ -591,37 +700,15 @@ static void squashfs_readahead(struct readahead_control *ractl)
 		if (bsize == 0)
 			goto skip_pages;
 
-		actor = squashfs_page_actor_init_special(msblk, pages, nr_pages,
-							 expected);
-		if (!actor)
+		res = squashfs_readahead_submit(&ctx, pages, nr_pages, block,
+						bsize, expected,
+						index == file_end);
+		if (res)
 			goto skip_pages;
-
-		res = squashfs_read_data(inode->i_sb, block, bsize, NULL, actor);
-
-		last_page = squashfs_page_actor_free(actor);
-
-		if (res == expected) {
-			int bytes;
-
-			/* Last page (if present) may have trailing bytes not filled */
-			bytes = res % PAGE_SIZE;
-			if (index == file_end && bytes && last_page)
-				memzero_page(last_page, bytes,
-					     PAGE_SIZE - bytes);
-
-			for (i = 0; i < nr_pages; i++) {
-				flush_dcache_page(pages[i]);
-				SetPageUptodate(pages[i]);
-			}
-		}
-
-		for (i = 0; i < nr_pages; i++) {
-			unlock_page(pages[i]);
-			put_page(pages[i]);
-		}
 	}
 
 	kfree(pages);
+	squashfs_readahead_wait(&ctx);
 	return;
 
 skip_pages:
@@ -630,6 +717,7 @@ skip_pages:
 		put_page(pages[i]);
 	}
 	kfree(pages);
+	squashfs_readahead_wait(&ctx);
 }
 
 const struct address_space_operations squashfs_aops = {
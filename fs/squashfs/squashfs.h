@@ -20,6 +20,7 @@ extern int squashfs_read_data(struct super_block *, u64, int, u64 *,
 
 /* cache.c */
 extern struct squashfs_cache *squashfs_cache_init(char *, int, int);
+extern int squashfs_cache_scale_entries(int, int, long long);
 extern void squashfs_cache_delete(struct squashfs_cache *);
 extern struct squashfs_cache_entry *squashfs_cache_get(struct super_block *,
 				struct squashfs_cache *, u64, int);
@@ -60,6 +61,8 @@ extern const struct squashfs_decompressor_thread_ops squashfs_decompressor_percp
 /* export.c */
 extern __le64 *squashfs_read_inode_lookup_table(struct super_block *, u64, u64,
 				unsigned int);
+extern void squashfs_export_index_init(struct super_block *);
+extern void squashfs_export_index_destroy(struct squashfs_sb_info *);
 
 /* fragment.c */
 extern int squashfs_frag_lookup(struct super_block *, unsigned int, u64 *);
@@ -12,18 +12,32 @@
 
 #include "squashfs_fs.h"
 
-struct squashfs_cache {
-	char			*name;
+/*
+ * The cache is divided into independently locked shards, selected by a
+ * hash of the block address, so that concurrent lookups of different
+ * blocks don't serialise on a single lock.
+ */
+struct squashfs_cache_shard {
 	int			entries;
 	int			curr_blk;
 	int			next_blk;
 	int			num_waiters;
 	int			unused;
-	int			block_size;
-	int			pages;
 	spinlock_t		lock;
 	wait_queue_head_t	wait_queue;
 	struct squashfs_cache_entry *entry;
+	struct squashfs_cache	*cache;
+};
+
+struct squashfs_cache {
+	char			*name;
+	int			entries;	/* total across all shards */
+	int			nr_shards;
+	int			block_size;
+	int			pages;
+	atomic_t		hits;
+	atomic_t		misses;
+	struct squashfs_cache_shard *shard;
 };
 
 struct squashfs_cache_entry {
@@ -35,7 +49,7 @@ struct squashfs_cache_entry {
 	int			error;
 	int			num_waiters;
 	wait_queue_head_t	wait_queue;
-	struct squashfs_cache	*cache;
+	struct squashfs_cache_shard *shard;
 	void			**data;
 	struct squashfs_page_actor	*actor;
 };
@@ -55,6 +69,7 @@ struct squashfs_sb_info {
 	struct meta_index			*meta_index;
 	void					*stream;
 	__le64					*inode_lookup_table;
+	struct squashfs_export_index		*export_index;
 	u64					inode_table;
 	u64					directory_table;
 	u64					xattr_table;
@@ -68,5 +83,6 @@ struct squashfs_sb_info {
 	bool					panic_on_errors;
 	const struct squashfs_decompressor_thread_ops *thread_ops;
 	int					max_thread_num;
+	struct dentry				*debugfs_dir;
 };
 #endif
@@ -29,6 +29,7 @@
 #include <linux/module.h>
 #include <linux/magic.h>
 #include <linux/xattr.h>
+#include <linux/debugfs.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -38,6 +39,34 @@
 #include "xattr.h"
 
 static struct file_system_type squashfs_fs_type;
+
+/* Root of the per-mount cache statistics exported via debugfs */
+static struct dentry *squashfs_debugfs_root;
+
+/*
+ * Export hit/miss counters for the metadata and fragment caches under
+ * debugfs/squashfs/<device>/.
+ */
+static void squashfs_debugfs_init(struct super_block *sb)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+
+	msblk->debugfs_dir = debugfs_create_dir(sb->s_id,
+						squashfs_debugfs_root);
+
+	debugfs_create_atomic_t("metadata_hits", 0444, msblk->debugfs_dir,
+				&msblk->block_cache->hits);
+	debugfs_create_atomic_t("metadata_misses", 0444, msblk->debugfs_dir,
+				&msblk->block_cache->misses);
+	if (msblk->fragment_cache) {
+		debugfs_create_atomic_t("fragment_hits", 0444,
+					msblk->debugfs_dir,
+					&msblk->fragment_cache->hits);
+		debugfs_create_atomic_t("fragment_misses", 0444,
+					msblk->debugfs_dir,
+					&msblk->fragment_cache->misses);
+	}
+}
 static const struct super_operations squashfs_super_ops;
 
 enum Opt_errors {
@@ -317,7 +346,9 @@ static int squashfs_fill_super(struct super_block *sb, struct fs_context *fc)
 	err = -ENOMEM;
 
 	msblk->block_cache = squashfs_cache_init("metadata",
-			SQUASHFS_CACHED_BLKS, SQUASHFS_METADATA_SIZE);
+			squashfs_cache_scale_entries(SQUASHFS_CACHED_BLKS, 64,
+				msblk->bytes_used / SQUASHFS_METADATA_SIZE),
+			SQUASHFS_METADATA_SIZE);
 	if (msblk->block_cache == NULL)
 		goto failed_mount;
 
@@ -385,6 +416,7 @@ allocate_id_index_table:
 	next_table = le64_to_cpu(msblk->inode_lookup_table[0]);
 
 	sb->s_export_op = &squashfs_export_ops;
+	squashfs_export_index_init(sb);
 
 handle_fragments:
 	fragments = msblk->fragments;
@@ -392,7 +424,8 @@ handle_fragments:
 		goto check_directory_table;
 
 	msblk->fragment_cache = squashfs_cache_init("fragment",
-		SQUASHFS_CACHED_FRAGMENTS, msblk->block_size);
+		squashfs_cache_scale_entries(SQUASHFS_CACHED_FRAGMENTS, 32,
+			fragments), msblk->block_size);
 	if (msblk->fragment_cache == NULL) {
 		err = -ENOMEM;
 		goto failed_mount;
@@ -444,6 +477,8 @@ check_directory_table:
 		goto failed_mount;
 	}
 
+	squashfs_debugfs_init(sb);
+
 	TRACE("Leaving squashfs_fill_super\n");
 	kfree(sblk);
 	return 0;
@@ -455,6 +490,7 @@ failed_mount:
 	squashfs_cache_delete(msblk->fragment_cache);
 	squashfs_cache_delete(msblk->read_page);
 	msblk->thread_ops->destroy(msblk);
+	squashfs_export_index_destroy(msblk);
 	kfree(msblk->inode_lookup_table);
 	kfree(msblk->fragment_index);
 	kfree(msblk->id_table);
@@ -569,6 +605,7 @@ static void squashfs_put_super(struct super_block *sb)
 {
 	if (sb->s_fs_info) {
 		struct squashfs_sb_info *sbi = sb->s_fs_info;
+		debugfs_remove_recursive(sbi->debugfs_dir);
 		squashfs_cache_delete(sbi->block_cache);
 		squashfs_cache_delete(sbi->fragment_cache);
 		squashfs_cache_delete(sbi->read_page);
@@ -576,6 +613,7 @@ static void squashfs_put_super(struct super_block *sb)
 		kfree(sbi->id_table);
 		kfree(sbi->fragment_index);
 		kfree(sbi->meta_index);
+		squashfs_export_index_destroy(sbi);
 		kfree(sbi->inode_lookup_table);
 		kfree(sbi->xattr_id_table);
 		kfree(sb->s_fs_info);
@@ -629,6 +667,8 @@ static int __init init_squashfs_fs(void)
 		return err;
 	}
 
+	squashfs_debugfs_root = debugfs_create_dir("squashfs", NULL);
+
 	pr_info("version 4.0 (2009/01/31) Phillip Lougher\n");
 
 	return 0;
@@ -637,6 +677,7 @@ static int __init init_squashfs_fs(void)
 
 static void __exit exit_squashfs_fs(void)
 {
+	debugfs_remove_recursive(squashfs_debugfs_root);
 	unregister_filesystem(&squashfs_fs_type);
 	destroy_inodecache();
 }
@@ -869,8 +869,20 @@ static int inode_getblk(struct inode *inode, struct udf_map_rq *map)
 	if ((laarr[c].extLength >> 30) == (EXT_NOT_RECORDED_ALLOCATED >> 30))
 		newblocknum = laarr[c].extLocation.logicalBlockNum + offset;
 	else { /* otherwise, allocate a new block */
-		if (iinfo->i_next_alloc_block == map->lblk)
+		if (iinfo->i_next_alloc_block == map->lblk) {
 			goal = iinfo->i_next_alloc_goal;
+			/*
+			 * A sequential write has used up its preallocation;
+			 * widen the window for the next one so that long
+			 * streaming writes hit the allocator less often and
+			 * get more contiguous extents.
+			 */
+			iinfo->i_prealloc_blocks =
+				min_t(__u32, iinfo->i_prealloc_blocks * 2,
+				      UDF_MAX_PREALLOC_BLOCKS);
+		} else {
+			iinfo->i_prealloc_blocks = UDF_DEFAULT_PREALLOC_BLOCKS;
+		}
 
 		if (!goal) {
 			if (!(goal = pgoal)) /* XXX: what was intended here? */
@@ -996,6 +1008,9 @@ static void udf_prealloc_extents(struct inode *inode, int c, int lastblock,
 				 struct kernel_long_ad *laarr,
 				 int *endnum)
 {
+	struct udf_inode_info *iinfo = UDF_I(inode);
+	int prealloc_len = iinfo->i_prealloc_blocks ?:
+					UDF_DEFAULT_PREALLOC_BLOCKS;
 	int start, length = 0, currlength = 0, i;
 
 	if (*endnum >= (c + 1)) {
@@ -1019,7 +1034,7 @@ static void udf_prealloc_extents(struct inode *inode, int c, int lastblock,
 	for (i = start + 1; i <= *endnum; i++) {
 		if (i == *endnum) {
 			if (lastblock)
-				length += UDF_DEFAULT_PREALLOC_BLOCKS;
+				length += prealloc_len;
 		} else if ((laarr[i].extLength >> 30) ==
 				(EXT_NOT_RECORDED_NOT_ALLOCATED >> 30)) {
 			length += (((laarr[i].extLength &
@@ -1037,9 +1052,8 @@ static void udf_prealloc_extents(struct inode *inode, int c, int lastblock,
 			  inode->i_sb->s_blocksize_bits);
 		int numalloc = udf_prealloc_blocks(inode->i_sb, inode,
 				laarr[start].extLocation.partitionReferenceNum,
-				next, (UDF_DEFAULT_PREALLOC_BLOCKS > length ?
-				length : UDF_DEFAULT_PREALLOC_BLOCKS) -
-				currlength);
+				next, (prealloc_len > length ?
+				length : prealloc_len) - currlength);
 		if (numalloc) 	{
 			if (start == (c + 1))
 				laarr[start].extLength +=
@@ -1082,7 +1096,7 @@ static void udf_prealloc_extents(struct inode *inode, int c, int lastblock,
 					(*endnum)--;
 				}
 			}
-			UDF_I(inode)->i_lenExtents +=
+			iinfo->i_lenExtents +=
 				numalloc << inode->i_sb->s_blocksize_bits;
 		}
 	}
@@ -1428,6 +1442,7 @@ reread:
 	iinfo->i_lenAlloc = 0;
 	iinfo->i_next_alloc_block = 0;
 	iinfo->i_next_alloc_goal = 0;
+	iinfo->i_prealloc_blocks = UDF_DEFAULT_PREALLOC_BLOCKS;
 	if (fe->descTag.tagIdent == cpu_to_le16(TAG_IDENT_EFE)) {
 		iinfo->i_efe = 1;
 		iinfo->i_use = 0;
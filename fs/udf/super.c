@@ -152,6 +152,7 @@ static struct inode *udf_alloc_inode(struct super_block *sb)
 	ei->i_lenStreams = 0;
 	ei->i_next_alloc_block = 0;
 	ei->i_next_alloc_goal = 0;
+	ei->i_prealloc_blocks = UDF_DEFAULT_PREALLOC_BLOCKS;
 	ei->i_strat4096 = 0;
 	ei->i_streamdir = 0;
 	ei->i_hidden = 0;
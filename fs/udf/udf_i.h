@@ -37,6 +37,8 @@ struct udf_inode_info {
 	__u64			i_lenExtents;
 	__u32			i_next_alloc_block;
 	__u32			i_next_alloc_goal;
+	/* Preallocation window for sequential writes (in blocks) */
+	__u32			i_prealloc_blocks;
 	__u32			i_checkpoint;
 	__u32			i_extraPerms;
 	unsigned		i_alloc_type : 3;
@@ -17,6 +17,7 @@
 #include "udf_i.h"
 
 #define UDF_DEFAULT_PREALLOC_BLOCKS	8
+#define UDF_MAX_PREALLOC_BLOCKS		512
 
 extern __printf(3, 4) void _udf_err(struct super_block *sb,
 		const char *function, const char *fmt, ...);
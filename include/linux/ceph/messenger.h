@@ -467,6 +467,7 @@ struct ceph_connection {
 
 	struct delayed_work work;	    /* send|recv work */
 	unsigned long       delay;          /* current delay interval */
+	int sched_cpu;  /* cpu of the last submitter, -1 if none */
 
 	union {
 		struct ceph_connection_v1_info v1;
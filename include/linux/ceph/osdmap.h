@@ -167,6 +167,8 @@ struct ceph_pg_mapping {
 	};
 };
 
+struct ceph_pg_cache_entry;
+
 struct ceph_osdmap {
 	struct ceph_fsid fsid;
 	u32 epoch;
@@ -196,6 +198,10 @@ struct ceph_osdmap {
 	struct crush_map *crush;
 
 	struct workspace_manager crush_wsm;
+
+	/* cache of recently computed placements, see osdmap.c */
+	struct ceph_pg_cache_entry *pg_cache;
+	u32 pg_cache_gen;
 };
 
 static inline bool ceph_osd_exists(struct ceph_osdmap *map, int osd)
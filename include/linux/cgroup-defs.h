@@ -477,6 +477,22 @@ struct cgroup {
 	struct cgroup_rstat_cpu __percpu *rstat_cpu;
 	struct list_head rstat_css_list;
 
+	/*
+	 * Linkage for the ongoing rstat flush round and the time (jiffies)
+	 * the last flush of this subtree completed.  Both are protected by
+	 * cgroup_rstat_lock.
+	 */
+	struct cgroup *rstat_flush_next;
+	unsigned long rstat_last_flush;
+
+	/*
+	 * If set, a background worker periodically flushes this cgroup's
+	 * subtree so readers of its aggregates rarely need to walk the
+	 * rstat tree.  Toggled through "cgroup.stat_watch".
+	 */
+	bool rstat_watch;
+	struct delayed_work rstat_watch_work;
+
 	/* cgroup basic resource statistics */
 	struct cgroup_base_stat last_bstat;
 	struct cgroup_base_stat bstat;
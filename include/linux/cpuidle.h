@@ -200,6 +200,9 @@ extern void cpuidle_disable_device(struct cpuidle_device *dev);
 extern int cpuidle_play_dead(void);
 
 extern struct cpuidle_driver *cpuidle_get_cpu_driver(struct cpuidle_device *dev);
+extern void cpuidle_cpu_latency_hint(unsigned int cpu, s64 latency_ns,
+				     u64 timeout_ns);
+extern void cpuidle_cpu_latency_hint_clear(unsigned int cpu);
 static inline struct cpuidle_device *cpuidle_get_device(void)
 {return __this_cpu_read(cpuidle_devices); }
 #else
@@ -240,6 +243,9 @@ static inline void cpuidle_disable_device(struct cpuidle_device *dev) { }
 static inline int cpuidle_play_dead(void) {return -ENODEV; }
 static inline struct cpuidle_driver *cpuidle_get_cpu_driver(
 	struct cpuidle_device *dev) {return NULL; }
+static inline void cpuidle_cpu_latency_hint(unsigned int cpu, s64 latency_ns,
+					    u64 timeout_ns) { }
+static inline void cpuidle_cpu_latency_hint_clear(unsigned int cpu) { }
 static inline struct cpuidle_device *cpuidle_get_device(void) {return NULL; }
 #endif
 
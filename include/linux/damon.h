@@ -8,6 +8,7 @@
 #ifndef _DAMON_H_
 #define _DAMON_H_
 
+#include <linux/atomic.h>
 #include <linux/memcontrol.h>
 #include <linux/mutex.h>
 #include <linux/time64.h>
@@ -55,8 +56,10 @@ struct damon_region {
 	struct list_head list;
 
 	unsigned int age;
-/* private: Internal value for age calculation. */
+/* private: Internal values for age calculation and adaptive sampling. */
 	unsigned int last_nr_accesses;
+	unsigned int sample_skips;
+	bool last_sampled_young;
 };
 
 /**
@@ -316,6 +319,10 @@ struct damos {
 	struct list_head filters;
 	struct damos_stat stat;
 	struct list_head list;
+/* private: feedback counters of the background action executor */
+	atomic_long_t bg_sz_applied;
+	atomic_long_t bg_nr_applied;
+	atomic64_t bg_charged_ns;
 };
 
 /**
@@ -633,6 +640,12 @@ int damon_stop(struct damon_ctx **ctxs, int nr_ctxs);
 int damon_set_region_biggest_system_ram_default(struct damon_target *t,
 				unsigned long *start, unsigned long *end);
 
+#ifdef CONFIG_DAMON_STREAM
+void damon_stream_report(struct damon_ctx *c);
+#else
+static inline void damon_stream_report(struct damon_ctx *c) { }
+#endif
+
 #endif	/* CONFIG_DAMON */
 
 #endif	/* _DAMON_H */
@@ -69,6 +69,9 @@ struct fwnode_handle;
  * @lock_key:	Lock class key for use by the lock validator
  * @need_parent_lock:	When probing or removing a device on this bus, the
  *			device core should lock the device's parent.
+ * @sync_probe:	Opt this bus out of parallel probing: devices on it are
+ *		probed synchronously even when asynchronous probing is the
+ *		system-wide default.
  *
  * A bus is a channel between the processor and one or more devices. For the
  * purposes of the device model, all devices are connected via a bus, even if
@@ -110,6 +113,7 @@ struct bus_type {
 	const struct iommu_ops *iommu_ops;
 
 	bool need_parent_lock;
+	bool sync_probe;
 };
 
 extern int __must_check bus_register(struct bus_type *bus);
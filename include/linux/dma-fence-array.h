@@ -13,7 +13,7 @@
 #define __LINUX_DMA_FENCE_ARRAY_H
 
 #include <linux/dma-fence.h>
-#include <linux/irq_work.h>
+#include <linux/llist.h>
 
 /**
  * struct dma_fence_array_cb - callback helper for fence array
@@ -32,7 +32,7 @@ struct dma_fence_array_cb {
  * @num_fences: number of fences in the array
  * @num_pending: fences in the array still pending
  * @fences: array of the fences
- * @work: internal irq_work function
+ * @signal_node: entry on the shared deferred-signal list
  */
 struct dma_fence_array {
 	struct dma_fence base;
@@ -42,7 +42,7 @@ struct dma_fence_array {
 	atomic_t num_pending;
 	struct dma_fence **fences;
 
-	struct irq_work work;
+	struct llist_node signal_node;
 };
 
 /**
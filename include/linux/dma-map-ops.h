@@ -65,6 +65,8 @@ struct dma_map_ops {
 	void (*unmap_resource)(struct device *dev, dma_addr_t dma_handle,
 			size_t size, enum dma_data_direction dir,
 			unsigned long attrs);
+	void (*unmap_batch_begin)(struct device *dev);
+	void (*unmap_batch_end)(struct device *dev);
 	void (*sync_single_for_cpu)(struct device *dev, dma_addr_t dma_handle,
 			size_t size, enum dma_data_direction dir);
 	void (*sync_single_for_device)(struct device *dev,
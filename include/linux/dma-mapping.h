@@ -61,6 +61,17 @@
  */
 #define DMA_ATTR_PRIVILEGED		(1UL << 9)
 
+/*
+ * DMA_ATTR_DEFERRED_INVALIDATE: the caller tolerates a bounded window in
+ * which the device may still translate this mapping after it is unmapped.
+ * On a strict-mode IOMMU domain the unmap then defers its IOTLB
+ * invalidation to the flush queue instead of flushing synchronously,
+ * while unmaps without this attribute stay strict. Only honoured once the
+ * domain has a flush queue (flush-queue mode, or a prior unmap batch);
+ * otherwise the unmap remains synchronous.
+ */
+#define DMA_ATTR_DEFERRED_INVALIDATE	(1UL << 10)
+
 /*
  * A dma_addr_t can hold any valid DMA or bus address for the platform.  It can
  * be given to a device to use as a DMA source or target.  It is specific to a
@@ -116,6 +127,8 @@ dma_addr_t dma_map_resource(struct device *dev, phys_addr_t phys_addr,
 		size_t size, enum dma_data_direction dir, unsigned long attrs);
 void dma_unmap_resource(struct device *dev, dma_addr_t addr, size_t size,
 		enum dma_data_direction dir, unsigned long attrs);
+void dma_unmap_batch_begin(struct device *dev);
+void dma_unmap_batch_end(struct device *dev);
 void dma_sync_single_for_cpu(struct device *dev, dma_addr_t addr, size_t size,
 		enum dma_data_direction dir);
 void dma_sync_single_for_device(struct device *dev, dma_addr_t addr,
@@ -193,6 +206,12 @@ static inline void dma_unmap_resource(struct device *dev, dma_addr_t addr,
 		size_t size, enum dma_data_direction dir, unsigned long attrs)
 {
 }
+static inline void dma_unmap_batch_begin(struct device *dev)
+{
+}
+static inline void dma_unmap_batch_end(struct device *dev)
+{
+}
 static inline void dma_sync_single_for_cpu(struct device *dev, dma_addr_t addr,
 		size_t size, enum dma_data_direction dir)
 {
@@ -147,6 +147,19 @@ struct fscache_cookie {
 	};
 };
 
+/*
+ * Descriptor for one cookie in a batched acquisition.  The cookie pointer is
+ * filled in on return (or set to NULL if that cookie couldn't be acquired).
+ */
+struct fscache_cookie_desc {
+	const void		*index_key;	/* Index key for the cookie */
+	size_t			index_key_len;	/* Size of the index key */
+	const void		*aux_data;	/* Auxiliary data (or NULL) */
+	size_t			aux_data_len;	/* Size of the auxiliary data */
+	loff_t			object_size;	/* Initial size of object */
+	struct fscache_cookie	*cookie;	/* Result of the acquisition */
+};
+
 /*
  * slow-path functions for when there is actually caching available, and the
  * netfs does actually have a valid token
@@ -164,6 +177,9 @@ extern struct fscache_cookie *__fscache_acquire_cookie(
 	const void *, size_t,
 	const void *, size_t,
 	loff_t);
+extern unsigned int __fscache_acquire_cookies(struct fscache_volume *, u8,
+					      struct fscache_cookie_desc *,
+					      unsigned int);
 extern void __fscache_use_cookie(struct fscache_cookie *, bool);
 extern void __fscache_unuse_cookie(struct fscache_cookie *, const void *, const loff_t *);
 extern void __fscache_relinquish_cookie(struct fscache_cookie *, bool);
@@ -256,6 +272,37 @@ struct fscache_cookie *fscache_acquire_cookie(struct fscache_volume *volume,
 					object_size);
 }
 
+/**
+ * fscache_acquire_cookies - Acquire a batch of cookies in one volume
+ * @volume: The volume in which to locate/create these cookies
+ * @advice: Advice flags (FSCACHE_COOKIE_ADV_*)
+ * @descs: Table of cookie descriptors to process
+ * @nr: The number of descriptors in the table
+ *
+ * Acquire cookies to represent a batch of data files within the given cache
+ * volume.  Each descriptor's cookie pointer is set to the cookie acquired for
+ * it, or to NULL if that cookie couldn't be acquired.  This amortises the
+ * hash table locking over the batch and so is preferable to repeated calls to
+ * fscache_acquire_cookie() when opening many files at once.
+ *
+ * Returns the number of cookies acquired.
+ */
+static inline
+unsigned int fscache_acquire_cookies(struct fscache_volume *volume,
+				     u8 advice,
+				     struct fscache_cookie_desc *descs,
+				     unsigned int nr)
+{
+	unsigned int i;
+
+	if (!fscache_volume_valid(volume)) {
+		for (i = 0; i < nr; i++)
+			descs[i].cookie = NULL;
+		return 0;
+	}
+	return __fscache_acquire_cookies(volume, advice, descs, nr);
+}
+
 /**
  * fscache_use_cookie - Request usage of cookie attached to an object
  * @cookie: The cookie representing the cache object
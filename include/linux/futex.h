@@ -90,4 +90,29 @@ static inline long do_futex(u32 __user *uaddr, int op, u32 val,
 }
 #endif
 
+/*
+ * Commands for futex_hash_ctl(), the backend of prctl(PR_FUTEX_HASH).
+ */
+enum futex_hash_ctl_cmd {
+	FUTEX_HASH_SET_SLOTS,
+	FUTEX_HASH_GET_SLOTS,
+};
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+/* Set up and tear down the private futex hash of an mm. */
+void futex_mm_init(struct mm_struct *mm);
+void futex_hash_free(struct mm_struct *mm);
+
+long futex_hash_ctl(enum futex_hash_ctl_cmd cmd, unsigned long slots);
+#else
+static inline void futex_mm_init(struct mm_struct *mm) { }
+static inline void futex_hash_free(struct mm_struct *mm) { }
+
+static inline long futex_hash_ctl(enum futex_hash_ctl_cmd cmd,
+				  unsigned long slots)
+{
+	return -EINVAL;
+}
+#endif
+
 #endif
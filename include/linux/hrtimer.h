@@ -144,6 +144,15 @@ struct hrtimer_sleeper {
 # define __hrtimer_clock_base_align
 #endif
 
+/*
+ * Each clock base spreads its timers over a small set of timerqueue
+ * shards, keyed by a hash of the expiry time. Enqueue and dequeue still
+ * run under the cpu_base lock, but operate on smaller trees, and the
+ * next expiring timer is computed by merging the shard heads.
+ */
+#define HRTIMER_QUEUE_SHARD_BITS	2
+#define HRTIMER_QUEUE_SHARDS		(1 << HRTIMER_QUEUE_SHARD_BITS)
+
 /**
  * struct hrtimer_clock_base - the timer base for a specific clock
  * @cpu_base:		per cpu clock base
@@ -152,7 +161,7 @@ struct hrtimer_sleeper {
  * @clockid:		clock id for per_cpu support
  * @seq:		seqcount around __run_hrtimer
  * @running:		pointer to the currently running hrtimer
- * @active:		red black tree root node for the active timers
+ * @active:		red black tree root nodes for the active timer shards
  * @get_time:		function to retrieve the current time of the clock
  * @offset:		offset of this clock to the monotonic base
  */
@@ -162,7 +171,7 @@ struct hrtimer_clock_base {
 	clockid_t		clockid;
 	seqcount_raw_spinlock_t	seq;
 	struct hrtimer		*running;
-	struct timerqueue_head	active;
+	struct timerqueue_head	active[HRTIMER_QUEUE_SHARDS];
 	ktime_t			(*get_time)(void);
 	ktime_t			offset;
 } __hrtimer_clock_base_align;
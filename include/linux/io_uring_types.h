@@ -21,6 +21,8 @@ struct io_wq_work {
 	unsigned flags;
 	/* place it here instead of io_kiocb as it fills padding and saves 4B */
 	int cancel_seq;
+	/* NUMA node owning the data this work operates on, or NUMA_NO_NODE */
+	int numa_node;
 };
 
 struct io_fixed_file {
@@ -256,6 +258,7 @@ struct io_ring_ctx {
 		struct list_head	cq_overflow_list;
 		struct io_alloc_cache	apoll_cache;
 		struct io_alloc_cache	netmsg_cache;
+		struct io_alloc_cache	rw_cache;
 	} ____cacheline_aligned_in_smp;
 
 	/* IRQ completion list, under ->completion_lock */
@@ -324,6 +327,13 @@ struct io_ring_ctx {
 	struct wait_queue_head		poll_wq;
 	struct io_restriction		restrictions;
 
+	/*
+	 * Optional per-opcode issue accounting, allocated on first enable
+	 * and kept until ring teardown. See io_register_opcode_stats().
+	 */
+	struct io_opcode_stat		*opcode_stats;
+	bool				opcode_stats_enabled;
+
 	/* slow path rsrc auxilary data, used by update/register */
 	struct io_rsrc_node		*rsrc_backup_node;
 	struct io_mapped_ubuf		*dummy_ubuf;
@@ -193,8 +193,32 @@ struct iomap_ops {
 	 */
 	int (*iomap_end)(struct inode *inode, loff_t pos, loff_t length,
 			ssize_t written, unsigned flags, struct iomap *iomap);
+
+	/*
+	 * Optionally return the inode's extent mapping cache.  When set,
+	 * read-only iterations that land inside the cached mapping skip the
+	 * ->iomap_begin call entirely.  Only mappings carrying an
+	 * .iomap_valid folio operation are cached, as the validity cookie is
+	 * what protects reuse against concurrent extent changes; stale
+	 * entries are dropped and remapped.  Must not be combined with
+	 * ->iomap_end.
+	 */
+	struct iomap_extent_cache *(*get_extent_cache)(struct inode *inode);
+};
+
+/*
+ * Single entry extent mapping cache, typically embedded in the filesystem's
+ * inode and hooked up via iomap_ops->get_extent_cache.
+ */
+struct iomap_extent_cache {
+	spinlock_t		lock;
+	bool			valid;
+	struct iomap		iomap;
 };
 
+void iomap_extent_cache_init(struct iomap_extent_cache *cache);
+void iomap_extent_cache_invalidate(struct iomap_extent_cache *cache);
+
 /**
  * struct iomap_iter - Iterate through a range of a file
  * @inode: Set at the start of the iteration and should not change.
@@ -383,6 +407,16 @@ struct iomap_dio_ops {
  */
 #define IOMAP_DIO_NOSYNC		(1 << 3)
 
+/*
+ * Emulate writes that are not aligned to the device logical block size by
+ * a bounce buffer read-modify-write of the containing blocks instead of
+ * failing them with -EINVAL.  Only plain overwrites of allocated blocks
+ * can be emulated; anything else still falls back to the caller.  The
+ * caller must hold the inode lock exclusively to keep overlapping
+ * sub-block writers serialized.
+ */
+#define IOMAP_DIO_SUBBLOCK		(1 << 4)
+
 ssize_t iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 		const struct iomap_ops *ops, const struct iomap_dio_ops *dops,
 		unsigned int dio_flags, void *private, size_t done_before);
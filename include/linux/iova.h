@@ -24,6 +24,15 @@ struct iova {
 
 struct iova_rcache;
 
+/* per-cpu allocation and contention counters for a domain */
+struct iova_domain_stats {
+	u64	rcache_hits;	/* allocations served by the rcache */
+	u64	rcache_misses;	/* allocations that fell through to the rbtree */
+	u64	depot_refills;	/* cpu magazines reloaded from the depot */
+	u64	rbtree_allocs;	/* ranges carved out under iova_rbtree_lock */
+	u64	rbtree_contended; /* rbtree lock acquisitions that had to spin */
+};
+
 /* holds all the iova translations for a domain */
 struct iova_domain {
 	spinlock_t	iova_rbtree_lock; /* Lock to protect update of rbtree */
@@ -37,6 +46,9 @@ struct iova_domain {
 	struct iova	anchor;		/* rbtree lookup anchor */
 
 	struct iova_rcache	*rcaches;
+	unsigned int	rcache_max_size; /* log of max cached size (in pages) */
+	unsigned int	rcache_mag_size; /* ranges per rcache magazine */
+	struct iova_domain_stats __percpu *stats;
 	struct hlist_node	cpuhp_dead;
 };
 
@@ -95,6 +107,11 @@ struct iova *reserve_iova(struct iova_domain *iovad, unsigned long pfn_lo,
 void init_iova_domain(struct iova_domain *iovad, unsigned long granule,
 	unsigned long start_pfn);
 int iova_domain_init_rcaches(struct iova_domain *iovad);
+int iova_domain_set_rcache_config(struct iova_domain *iovad,
+				  unsigned int max_order,
+				  unsigned int mag_size);
+void iova_domain_get_stats(struct iova_domain *iovad,
+			   struct iova_domain_stats *stats);
 struct iova *find_iova(struct iova_domain *iovad, unsigned long pfn);
 void put_iova_domain(struct iova_domain *iovad);
 #else
@@ -150,6 +167,18 @@ static inline void init_iova_domain(struct iova_domain *iovad,
 {
 }
 
+static inline int iova_domain_set_rcache_config(struct iova_domain *iovad,
+						unsigned int max_order,
+						unsigned int mag_size)
+{
+	return -ENOTSUPP;
+}
+
+static inline void iova_domain_get_stats(struct iova_domain *iovad,
+					 struct iova_domain_stats *stats)
+{
+}
+
 static inline struct iova *find_iova(struct iova_domain *iovad,
 				     unsigned long pfn)
 {
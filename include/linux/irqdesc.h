@@ -17,10 +17,23 @@ struct irq_desc;
 struct irq_domain;
 struct pt_regs;
 
+#ifdef CONFIG_IRQ_REBALANCE
+/**
+ * struct irq_rebal_cpu - per CPU handler time accounting for rebalancing
+ * @ns:		handler nanoseconds consumed on this CPU
+ * @seen:	snapshot of @ns taken by the last rebalancing pass
+ */
+struct irq_rebal_cpu {
+	u64		ns;
+	u64		seen;
+};
+#endif
+
 /**
  * struct irq_desc - interrupt descriptor
  * @irq_common_data:	per irq and chip data passed down to chip functions
  * @kstat_irqs:		irq stats per cpu
+ * @rebal_stat:		per cpu handler time accounting for load rebalancing
  * @handle_irq:		highlevel irq-events handler
  * @action:		the irq action chain
  * @status_use_accessors: status information
@@ -56,6 +69,9 @@ struct irq_desc {
 	struct irq_common_data	irq_common_data;
 	struct irq_data		irq_data;
 	unsigned int __percpu	*kstat_irqs;
+#ifdef CONFIG_IRQ_REBALANCE
+	struct irq_rebal_cpu __percpu *rebal_stat;
+#endif
 	irq_flow_handler_t	handle_irq;
 	struct irqaction	*action;	/* IRQ action list */
 	unsigned int		status_use_accessors;
@@ -2,6 +2,7 @@
 #ifndef _LINUX_KASAN_H
 #define _LINUX_KASAN_H
 
+#include <linux/atomic.h>
 #include <linux/bug.h>
 #include <linux/kasan-enabled.h>
 #include <linux/kernel.h>
@@ -292,6 +293,8 @@ static inline void kasan_unpoison_task_stack(struct task_struct *task) {}
 struct kasan_cache {
 	int alloc_meta_offset;
 	int free_meta_offset;
+	/* Size of the objects of this cache held in the quarantine. */
+	atomic_long_t quarantine_bytes;
 };
 
 size_t kasan_metadata_size(struct kmem_cache *cache, bool in_object);
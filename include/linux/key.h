@@ -104,6 +104,7 @@ struct key_owner;
 struct key_tag;
 struct keyring_list;
 struct keyring_name;
+struct keyring_ncache;
 
 struct key_tag {
 	struct rcu_head		rcu;
@@ -263,6 +264,7 @@ struct key {
 			/* Keyring bits */
 			struct list_head name_link;
 			struct assoc_array keys;
+			struct keyring_ncache *ncache;	/* lookup fast-index */
 		};
 	};
 
@@ -2,6 +2,7 @@
 #define KVM_DIRTY_RING_H
 
 #include <linux/kvm.h>
+#include <linux/spinlock.h>
 
 /**
  * kvm_dirty_ring: KVM internal dirty ring structure
@@ -17,6 +18,8 @@
  *               to allow userspace to harvest all the dirty pages
  * @dirty_gfns:  the array to keep the dirty gfns
  * @index:       index of this dirty ring
+ * @reset_lock:  serializes consumers of the ring (the per-VM reset ioctl
+ *               against the vcpu's in-kernel soft-full harvest)
  */
 struct kvm_dirty_ring {
 	u32 dirty_index;
@@ -25,6 +28,7 @@ struct kvm_dirty_ring {
 	u32 soft_limit;
 	struct kvm_dirty_gfn *dirty_gfns;
 	int index;
+	spinlock_t reset_lock;
 };
 
 #ifndef CONFIG_HAVE_KVM_DIRTY_RING
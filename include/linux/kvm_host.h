@@ -734,9 +734,13 @@ struct kvm {
 	unsigned long mn_active_invalidate_count;
 	struct rcuwait mn_memslots_update_rcuwait;
 
-	/* For management / invalidation of gfn_to_pfn_caches */
+	/*
+	 * For management / invalidation of gfn_to_pfn_caches, indexed by
+	 * the uhva range each active cache maps so that mmu_notifier
+	 * events only walk the caches overlapping the invalidated range.
+	 */
 	spinlock_t gpc_lock;
-	struct list_head gpc_list;
+	struct rb_root_cached gpc_itree;
 
 	/*
 	 * created_vcpus is protected by kvm->lock, and is incremented
@@ -1291,7 +1295,7 @@ void kvm_gpc_init(struct gfn_to_pfn_cache *gpc, struct kvm *kvm,
  *		   -EINVAL for a mapping which would cross a page boundary.
  *		   -EFAULT for an untranslatable guest physical address.
  *
- * This primes a gfn_to_pfn_cache and links it into the @gpc->kvm's list for
+ * This primes a gfn_to_pfn_cache and indexes it in @gpc->kvm's interval tree for
  * invalidations to be processed.  Callers are required to use kvm_gpc_check()
  * to ensure that the cache is valid before accessing the target page.
  */
@@ -1866,6 +1870,7 @@ ssize_t kvm_stats_read(char *id, const struct kvm_stats_header *header,
 		       const struct _kvm_stats_desc *desc,
 		       void *stats, size_t size_stats,
 		       char __user *user_buffer, size_t size, loff_t *offset);
+int kvm_vm_create_stats_stream_fd(struct kvm *kvm);
 
 /**
  * kvm_stats_linear_hist_update() - Update bucket value for linear histogram
@@ -19,6 +19,7 @@ struct kvm_memslots;
 enum kvm_mr_change;
 
 #include <linux/bits.h>
+#include <linux/interval_tree.h>
 #include <linux/mutex.h>
 #include <linux/types.h>
 #include <linux/spinlock_types.h>
@@ -69,7 +70,7 @@ struct gfn_to_pfn_cache {
 	struct kvm_memory_slot *memslot;
 	struct kvm *kvm;
 	struct kvm_vcpu *vcpu;
-	struct list_head list;
+	struct interval_tree_node node;
 	rwlock_t lock;
 	struct mutex refresh_lock;
 	void *khva;
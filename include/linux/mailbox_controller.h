@@ -42,9 +42,19 @@ struct mbox_chan;
  *		  Used only if txdone_poll:=true && txdone_irq:=false
  * @peek_data: Atomic check for any received data. Return true if controller
  *		  has some data to push to the client. False otherwise.
+ * @send_burst: Optional. The API hands the controller up to @count queued
+ *		  messages, oldest first, in atomic context. The controller
+ *		  accepts a prefix of the array, drains it autonomously, and
+ *		  returns how many messages it took (or a -ve errno to fall
+ *		  back to single-message @send_data). TXDone must be signalled
+ *		  once, after the last accepted message has gone out; the API
+ *		  then runs the client's tx_done callback for every message of
+ *		  the burst. It must not sleep.
  */
 struct mbox_chan_ops {
 	int (*send_data)(struct mbox_chan *chan, void *data);
+	int (*send_burst)(struct mbox_chan *chan, void **data,
+			  unsigned int count);
 	int (*flush)(struct mbox_chan *chan, unsigned long timeout);
 	int (*startup)(struct mbox_chan *chan);
 	void (*shutdown)(struct mbox_chan *chan);
@@ -112,6 +122,8 @@ struct mbox_controller {
  * @msg_count:		No. of mssg currently queued
  * @msg_free:		Index of next available mssg slot
  * @msg_data:		Hook for data packet
+ * @burst_count:	No. of messages in the burst currently in flight
+ * @burst_msgs:		Messages of the in-flight burst, oldest first
  * @lock:		Serialise access to the channel
  * @con_priv:		Hook for controller driver to attach private data
  */
@@ -123,6 +135,8 @@ struct mbox_chan {
 	void *active_req;
 	unsigned msg_count, msg_free;
 	void *msg_data[MBOX_TX_QUEUE_LEN];
+	unsigned burst_count;
+	void *burst_msgs[MBOX_TX_QUEUE_LEN];
 	spinlock_t lock; /* Serialise access to the channel */
 	void *con_priv;
 };
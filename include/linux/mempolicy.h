@@ -126,6 +126,8 @@ struct shared_policy {
 
 int vma_dup_policy(struct vm_area_struct *src, struct vm_area_struct *dst);
 void mpol_shared_policy_init(struct shared_policy *sp, struct mempolicy *mpol);
+struct mempolicy *mpol_create(unsigned short mode, unsigned short flags,
+				const nodemask_t *nodes);
 int mpol_set_shared_policy(struct shared_policy *info,
 				struct vm_area_struct *vma,
 				struct mempolicy *new);
@@ -212,6 +214,18 @@ static inline void mpol_shared_policy_init(struct shared_policy *sp,
 {
 }
 
+static inline struct mempolicy *mpol_create(unsigned short mode,
+		unsigned short flags, const nodemask_t *nodes)
+{
+	return ERR_PTR(-EOPNOTSUPP);
+}
+
+static inline int mpol_set_shared_policy(struct shared_policy *info,
+		struct vm_area_struct *vma, struct mempolicy *new)
+{
+	return -EOPNOTSUPP;
+}
+
 static inline void mpol_free_shared_policy(struct shared_policy *p)
 {
 }
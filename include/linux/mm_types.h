@@ -11,6 +11,7 @@
 #include <linux/rbtree.h>
 #include <linux/maple_tree.h>
 #include <linux/rwsem.h>
+#include <linux/mutex.h>
 #include <linux/completion.h>
 #include <linux/cpumask.h>
 #include <linux/uprobes.h>
@@ -550,6 +551,24 @@ struct vm_area_struct {
 	struct vm_userfaultfd_ctx vm_userfaultfd_ctx;
 } __randomize_layout;
 
+#ifdef CONFIG_ARCH_WANT_BATCHED_UNMAP_TLB_FLUSH
+/*
+ * Accumulation of pending ranged TLB flushes for one mm.  Only the task
+ * that owns the batch defers its own flushes into it, so the range fields
+ * are only ever accessed by the owner; see flush_tlb_batch_begin().
+ */
+struct tlb_flush_batch {
+	struct task_struct *owner;	/* task batching its flushes, or NULL */
+	int		depth;		/* nesting of batch sections */
+	unsigned long	start;		/* union of the deferred ranges */
+	unsigned long	end;
+	unsigned int	stride_shift;
+	bool		freed_tables;
+	unsigned int	deferred;	/* flushes absorbed into the batch */
+};
+#endif
+
+struct futex_private_hash;
 struct kioctx_table;
 struct mm_struct {
 	struct {
@@ -674,10 +693,28 @@ struct mm_struct {
 
 		unsigned long flags; /* Must use atomic bitops to access */
 
+		/*
+		 * Incremented under mmap_lock whenever the soft-dirty bits
+		 * of this mm are cleared via /proc/pid/clear_refs, so that
+		 * samplers relying on accumulated soft-dirty state can tell
+		 * it has been discarded.
+		 */
+		unsigned long soft_dirty_clear_gen;
+
 #ifdef CONFIG_AIO
 		spinlock_t			ioctx_lock;
 		struct kioctx_table __rcu	*ioctx_table;
 #endif
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+		/*
+		 * Optional per-process futex hash, replacing the global
+		 * hash for PROCESS_PRIVATE futexes of this mm. Replaced
+		 * on resize under futex_hash_lock, read under RCU; see
+		 * futex_hash() in kernel/futex/core.c.
+		 */
+		struct mutex			futex_hash_lock;
+		struct futex_private_hash __rcu	*futex_phash;
+#endif
 #ifdef CONFIG_MEMCG
 		/*
 		 * "owner" points to a task that is regarded as the canonical
@@ -724,6 +761,8 @@ struct mm_struct {
 #ifdef CONFIG_ARCH_WANT_BATCHED_UNMAP_TLB_FLUSH
 		/* See flush_tlb_batched_pending() */
 		atomic_t tlb_flush_batched;
+		/* Deferred ranged flushes; see flush_tlb_batch_begin() */
+		struct tlb_flush_batch tlb_batch;
 #endif
 		struct uprobes_state uprobes_state;
 #ifdef CONFIG_PREEMPT_RT
@@ -25,6 +25,14 @@ int module_frob_arch_sections(Elf_Ehdr *hdr,
 /* Additional bytes needed by arch in front of individual sections */
 unsigned int arch_mod_section_prepend(struct module *mod, unsigned int section);
 
+/*
+ * Arches whose apply_relocate()/apply_relocate_add() perform plain stores
+ * into the target section without global side effects (no PLT or
+ * trampoline emission) may return true to let the loader apply
+ * independent relocation sections concurrently.
+ */
+bool module_arch_parallel_relocs(void);
+
 /* Allocator used for allocating struct module, core sections and init
    sections.  Returns NULL on failure. */
 void *module_alloc(unsigned long size);
@@ -65,6 +65,7 @@ struct mutex {
 	raw_spinlock_t		wait_lock;
 #ifdef CONFIG_MUTEX_SPIN_ON_OWNER
 	struct optimistic_spin_queue osq; /* Spinner MCS lock */
+	int			spin_ns; /* spin budget, see mutex_set_spin_ns() */
 #endif
 	struct list_head	wait_list;
 #ifdef CONFIG_DEBUG_MUTEXES
@@ -170,6 +171,27 @@ do {							\
 } while (0)
 #endif /* CONFIG_PREEMPT_RT */
 
+#if defined(CONFIG_MUTEX_SPIN_ON_OWNER) && !defined(CONFIG_PREEMPT_RT)
+/**
+ * mutex_set_spin_ns - tune the optimistic spin policy of a mutex
+ * @lock: the mutex to tune
+ * @ns: maximum time to spin waiting for the owner, in nanoseconds;
+ *	0 restores the default policy (spin for as long as the owner is
+ *	running), a negative value disables optimistic spinning
+ *
+ * Most mutexes are best left with the default policy, but for locks with
+ * long or highly variable hold times the cycles burned spinning can exceed
+ * the cost of sleeping.  The budget bounds each spin episode, not the
+ * acquisition as a whole.
+ */
+static inline void mutex_set_spin_ns(struct mutex *lock, int ns)
+{
+	WRITE_ONCE(lock->spin_ns, ns);
+}
+#else
+static inline void mutex_set_spin_ns(struct mutex *lock, int ns) { }
+#endif
+
 /*
  * See kernel/locking/mutex.c for detailed documentation of these APIs.
  * Also see Documentation/locking/mutex-design.rst.
@@ -129,6 +129,8 @@ struct netfs_inode {
 	struct fscache_cookie	*cache;
 #endif
 	loff_t			remote_i_size;	/* Size of the remote file */
+	unsigned int		io_slice_size;	/* Preferred subrequest size (0: netfs decides) */
+	unsigned int		io_window;	/* Max subrequests in flight (0: unlimited) */
 };
 
 /*
@@ -184,6 +186,8 @@ struct netfs_io_request {
 	unsigned int		debug_id;
 	atomic_t		nr_outstanding;	/* Number of ops in progress */
 	atomic_t		nr_copy_ops;	/* Number of copy-to-cache ops in progress */
+	unsigned int		io_slice_size;	/* Preferred subrequest size (0: netfs decides) */
+	unsigned int		io_window;	/* Max subrequests in flight (0: unlimited) */
 	size_t			submitted;	/* Amount submitted for I/O so far */
 	size_t			len;		/* Length of the request */
 	short			error;		/* 0 or error that occurred */
@@ -330,6 +334,8 @@ static inline void netfs_inode_init(struct netfs_inode *ctx,
 {
 	ctx->ops = ops;
 	ctx->remote_i_size = i_size_read(&ctx->inode);
+	ctx->io_slice_size = 0;
+	ctx->io_window = 0;
 #if IS_ENABLED(CONFIG_FSCACHE)
 	ctx->cache = NULL;
 #endif
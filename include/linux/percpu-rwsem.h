@@ -15,6 +15,8 @@ struct percpu_rw_semaphore {
 	struct rcuwait		writer;
 	wait_queue_head_t	waiters;
 	atomic_t		block;
+	/* keep readers off the rcu_sync fast path; see percpu_rwsem_set_fast_writer() */
+	bool			fast_writer;
 #ifdef CONFIG_DEBUG_LOCK_ALLOC
 	struct lockdep_map	dep_map;
 #endif
@@ -44,6 +46,16 @@ is_static struct percpu_rw_semaphore name = {				\
 
 extern bool __percpu_down_read(struct percpu_rw_semaphore *, bool);
 
+/*
+ * When sem->fast_writer is set, readers must always take the slow
+ * (memory barrier based) path so that writers never need to wait for
+ * an RCU grace period; see percpu_rwsem_set_fast_writer().
+ */
+static inline bool percpu_rwsem_reader_fast(struct percpu_rw_semaphore *sem)
+{
+	return rcu_sync_is_idle(&sem->rss) && !sem->fast_writer;
+}
+
 static inline void percpu_down_read(struct percpu_rw_semaphore *sem)
 {
 	might_sleep();
@@ -59,7 +71,7 @@ static inline void percpu_down_read(struct percpu_rw_semaphore *sem)
 	 * and that once the synchronize_rcu() is done, the writer will see
 	 * anything we did within this RCU-sched read-size critical section.
 	 */
-	if (likely(rcu_sync_is_idle(&sem->rss)))
+	if (likely(percpu_rwsem_reader_fast(sem)))
 		this_cpu_inc(*sem->read_count);
 	else
 		__percpu_down_read(sem, false); /* Unconditional memory barrier */
@@ -78,7 +90,7 @@ static inline bool percpu_down_read_trylock(struct percpu_rw_semaphore *sem)
 	/*
 	 * Same as in percpu_down_read().
 	 */
-	if (likely(rcu_sync_is_idle(&sem->rss)))
+	if (likely(percpu_rwsem_reader_fast(sem)))
 		this_cpu_inc(*sem->read_count);
 	else
 		ret = __percpu_down_read(sem, true); /* Unconditional memory barrier */
@@ -102,7 +114,7 @@ static inline void percpu_up_read(struct percpu_rw_semaphore *sem)
 	/*
 	 * Same as in percpu_down_read().
 	 */
-	if (likely(rcu_sync_is_idle(&sem->rss))) {
+	if (likely(percpu_rwsem_reader_fast(sem))) {
 		this_cpu_dec(*sem->read_count);
 	} else {
 		/*
@@ -133,6 +145,8 @@ static inline bool percpu_is_write_locked(struct percpu_rw_semaphore *sem)
 extern int __percpu_init_rwsem(struct percpu_rw_semaphore *,
 				const char *, struct lock_class_key *);
 
+extern void percpu_rwsem_set_fast_writer(struct percpu_rw_semaphore *);
+
 extern void percpu_free_rwsem(struct percpu_rw_semaphore *);
 
 #define percpu_init_rwsem(sem)					\
@@ -123,6 +123,10 @@ struct posix_cputimer_base {
  * @expiry_active:	Timer expiry is active. Used for
  *			process wide timers to avoid multiple
  *			task trying to handle expiry concurrently
+ * @recheck:		Jiffies value before which the process wide expiry
+ *			compare in the tick fast path cannot trip, so the
+ *			group cputime sample can be skipped. 0 means no
+ *			horizon is cached. Only used in signal_struct.
  *
  * Used in task_struct and signal_struct
  */
@@ -130,6 +134,7 @@ struct posix_cputimers {
 	struct posix_cputimer_base	bases[CPUCLOCK_MAX];
 	unsigned int			timers_active;
 	unsigned int			expiry_active;
+	unsigned long			recheck;
 };
 
 /**
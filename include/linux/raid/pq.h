@@ -67,6 +67,13 @@ extern const char raid6_empty_zero_page[PAGE_SIZE];
 #define CONFIG_RAID6_PQ_BENCHMARK 1
 #endif /* __KERNEL__ */
 
+/*
+ * Maximum number of stripes a batch routine processes per SIMD unit
+ * section (kernel_fpu_begin/end on x86), to bound the preemption-off
+ * region while still amortizing the save/restore cost.
+ */
+#define RAID6_BATCH_STRIPES_PER_FPU	8
+
 /* Routine choices */
 struct raid6_calls {
 	void (*gen_syndrome)(int, size_t, void **);
@@ -74,6 +81,8 @@ struct raid6_calls {
 	int  (*valid)(void);	/* Returns 1 if this routine set is usable */
 	const char *name;	/* Name of this routine set */
 	int priority;		/* Relative priority ranking if non-zero */
+	/* Optional: syndromes of many stripes per SIMD unit section */
+	void (*gen_syndrome_batch)(int, size_t, void ***, int);
 };
 
 /* Selected algorithm */
@@ -115,6 +124,9 @@ struct raid6_recov_calls {
 	int  (*valid)(void);
 	const char *name;
 	int priority;
+	/* Optional: recover many stripes with the same failed disks */
+	void (*data2_batch)(int, size_t, int, int, void ***, int);
+	void (*datap_batch)(int, size_t, int, void ***, int);
 };
 
 extern const struct raid6_recov_calls raid6_recov_intx1;
@@ -134,6 +146,14 @@ extern const struct raid6_calls * const raid6_algos[];
 extern const struct raid6_recov_calls *const raid6_recov_algos[];
 int raid6_select_algo(void);
 
+/*
+ * Batch interface: pipeline the stripes in @stripes (an array of
+ * @nstripes pointer tables laid out like the single-stripe calls)
+ * through the selected kernel back to back.
+ */
+void raid6_gen_syndrome_batch(int disks, size_t bytes, void ***stripes,
+			      int nstripes);
+
 /* Return values from chk_syndrome */
 #define RAID6_OK	0
 #define RAID6_P_BAD	1
@@ -153,6 +173,10 @@ extern void (*raid6_2data_recov)(int disks, size_t bytes, int faila, int failb,
 		       void **ptrs);
 extern void (*raid6_datap_recov)(int disks, size_t bytes, int faila,
 			void **ptrs);
+extern void (*raid6_2data_recov_batch)(int disks, size_t bytes, int faila,
+			int failb, void ***stripes, int nstripes);
+extern void (*raid6_datap_recov_batch)(int disks, size_t bytes, int faila,
+			void ***stripes, int nstripes);
 void raid6_dual_recov(int disks, size_t bytes, int faila, int failb,
 		      void **ptrs);
 
@@ -90,6 +90,11 @@ static inline void synchronize_rcu_expedited(void)
 	synchronize_rcu();
 }
 
+static inline void synchronize_rcu_within(unsigned long timeout)
+{
+	synchronize_rcu();
+}
+
 /*
  * Add one more declaration of kvfree() here. It is
  * not so straight forward to just include <linux/mm.h>
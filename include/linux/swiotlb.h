@@ -109,6 +109,10 @@ static inline bool is_swiotlb_buffer(struct device *dev, phys_addr_t paddr)
 {
 	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
 
+	if (mem && paddr >= mem->start && paddr < mem->end)
+		return true;
+
+	mem = READ_ONCE(dev->dma_io_tlb_ovfl);
 	return mem && paddr >= mem->start && paddr < mem->end;
 }
 
@@ -121,6 +125,7 @@ static inline bool is_swiotlb_force_bounce(struct device *dev)
 
 void swiotlb_init(bool addressing_limited, unsigned int flags);
 void __init swiotlb_exit(void);
+void swiotlb_dev_exit(struct device *dev);
 size_t swiotlb_max_mapping_size(struct device *dev);
 bool is_swiotlb_active(struct device *dev);
 void __init swiotlb_adjust_size(unsigned long size);
@@ -139,6 +144,9 @@ static inline bool is_swiotlb_force_bounce(struct device *dev)
 static inline void swiotlb_exit(void)
 {
 }
+static inline void swiotlb_dev_exit(struct device *dev)
+{
+}
 static inline size_t swiotlb_max_mapping_size(struct device *dev)
 {
 	return SIZE_MAX;
@@ -55,6 +55,7 @@ struct timezone;
 struct tms;
 struct utimbuf;
 struct mq_attr;
+struct mq_msgvec;
 struct compat_stat;
 struct old_timeval32;
 struct robust_list_head;
@@ -625,6 +626,8 @@ asmlinkage long sys_set_robust_list(struct robust_list_head __user *head,
 asmlinkage long sys_futex_waitv(struct futex_waitv *waiters,
 				unsigned int nr_futexes, unsigned int flags,
 				struct __kernel_timespec __user *timeout, clockid_t clockid);
+asmlinkage long sys_futex_wake_multi(struct futex_waitv *wakers,
+				     unsigned int nr_futexes, unsigned int flags);
 
 /* kernel/hrtimer.c */
 asmlinkage long sys_nanosleep(struct __kernel_timespec __user *rqtp,
@@ -796,6 +799,8 @@ asmlinkage long sys_mq_open(const char __user *name, int oflag, umode_t mode, st
 asmlinkage long sys_mq_unlink(const char __user *name);
 asmlinkage long sys_mq_timedsend(mqd_t mqdes, const char __user *msg_ptr, size_t msg_len, unsigned int msg_prio, const struct __kernel_timespec __user *abs_timeout);
 asmlinkage long sys_mq_timedreceive(mqd_t mqdes, char __user *msg_ptr, size_t msg_len, unsigned int __user *msg_prio, const struct __kernel_timespec __user *abs_timeout);
+asmlinkage long sys_mq_timedsendv(mqd_t mqdes, const struct mq_msgvec __user *vec, unsigned int vlen, const struct __kernel_timespec __user *abs_timeout);
+asmlinkage long sys_mq_timedreceivev(mqd_t mqdes, struct mq_msgvec __user *vec, unsigned int vlen, const struct __kernel_timespec __user *abs_timeout);
 asmlinkage long sys_mq_notify(mqd_t mqdes, const struct sigevent __user *notification);
 asmlinkage long sys_mq_getsetattr(mqd_t mqdes, const struct mq_attr __user *mqstat, struct mq_attr __user *omqstat);
 asmlinkage long sys_mq_timedreceive_time32(mqd_t mqdes,
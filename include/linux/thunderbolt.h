@@ -647,6 +647,9 @@ static inline int tb_ring_tx(struct tb_ring *ring, struct ring_frame *frame)
 
 /* Used only when the ring is in polling mode */
 struct ring_frame *tb_ring_poll(struct tb_ring *ring);
+unsigned int tb_ring_poll_batch(struct tb_ring *ring,
+				struct ring_frame **frames,
+				unsigned int nframes);
 void tb_ring_poll_complete(struct tb_ring *ring);
 
 /**
@@ -337,6 +337,45 @@ ww_mutex_lock_slow_interruptible(struct ww_mutex *lock,
 
 extern void ww_mutex_unlock(struct ww_mutex *lock);
 
+/**
+ * ww_mutex_lock_batch - acquire a set of w/w mutexes
+ * @locks: array of w/w mutexes to acquire, sorted in place by address
+ * @count: number of entries in @locks
+ * @ctx: w/w acquire context
+ *
+ * Acquires every mutex in @locks. The array is first sorted by lock
+ * address, so transactions assembled through this function acquire the
+ * locks they share in the same order and never wound each other; the
+ * wound/wait machinery comes into play only against lockers outside the
+ * batch API. On a die case the batch releases everything it holds, waits
+ * for the contended lock and retries, exactly as the hand-written
+ * acquire loops described in Documentation/locking/ww-mutex-design.rst.
+ *
+ * The locks in @locks must be distinct and not already held in @ctx.
+ * Returns 0 on success; on failure no lock in @locks is held.
+ *
+ * Every mutex acquired with this function must be released with
+ * ww_mutex_unlock.
+ */
+extern int __must_check ww_mutex_lock_batch(struct ww_mutex **locks,
+					    unsigned int count,
+					    struct ww_acquire_ctx *ctx);
+
+/**
+ * ww_mutex_lock_batch_interruptible - acquire a set of w/w mutexes,
+ *				       interruptible
+ * @locks: array of w/w mutexes to acquire, sorted in place by address
+ * @count: number of entries in @locks
+ * @ctx: w/w acquire context
+ *
+ * Interruptible variant of ww_mutex_lock_batch(): if a signal arrives
+ * while waiting for one of the locks, all locks acquired so far are
+ * released and -EINTR is returned.
+ */
+extern int __must_check
+ww_mutex_lock_batch_interruptible(struct ww_mutex **locks, unsigned int count,
+				  struct ww_acquire_ctx *ctx);
+
 extern int __must_check ww_mutex_trylock(struct ww_mutex *lock,
 					 struct ww_acquire_ctx *ctx);
 
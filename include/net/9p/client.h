@@ -86,7 +86,8 @@ struct p9_req_t {
 
 /**
  * struct p9_client - per client instance state
- * @lock: protect @fids and @reqs
+ * @lock: protect @fids
+ * @reqs_lock: protect @reqs
  * @msize: maximum data size negotiated by protocol
  * @proto_version: 9P protocol version to use
  * @trans_mod: module API instantiated with this client
@@ -98,9 +99,13 @@ struct p9_req_t {
  *
  * The client structure is used to keep track of various per-client
  * state that has been instantiated.
+ * Tag allocation and removal happen for every RPC, so @reqs has its
+ * own lock to keep the request hot path from contending with fid
+ * management.
  */
 struct p9_client {
 	spinlock_t lock;
+	spinlock_t reqs_lock;
 	unsigned int msize;
 	unsigned char proto_version;
 	struct p9_trans_module *trans_mod;
@@ -16,6 +16,7 @@
 #include <linux/bitops.h>
 #include <linux/pm_qos.h>
 #include <linux/refcount.h>
+#include <linux/hrtimer.h>
 
 #define snd_pcm_substream_chip(substream) ((substream)->private_data)
 #define snd_pcm_chip(pcm) ((pcm)->private_data)
@@ -444,6 +445,21 @@ struct snd_pcm_group {		/* keep linked substreams */
 	refcount_t refs;
 };
 
+/*
+ * A period group drives the period bookkeeping of many rate-synchronous
+ * substreams from one shared hrtimer.  Intended for virtual and loopback
+ * cards that run hundreds of streams off the same sample clock: all
+ * members are processed in a single tick per period instead of taking
+ * one timer interrupt and one wakeup pass per stream.
+ */
+struct snd_pcm_period_group {
+	spinlock_t lock;		/* protects the substreams list */
+	struct list_head substreams;
+	struct hrtimer timer;
+	ktime_t period;
+	bool running;
+};
+
 struct pid;
 
 struct snd_pcm_substream {
@@ -471,6 +487,9 @@ struct snd_pcm_substream {
 	struct list_head link_list;	/* linked list member */
 	struct snd_pcm_group self_group;	/* fake group for non linked substream (with substream lock inside) */
 	struct snd_pcm_group *group;		/* pointer to current group */
+	/* -- period-elapsed grouping -- */
+	struct list_head period_group_link;	/* member of a period group */
+	struct snd_pcm_period_group *period_group; /* current period group or NULL */
 	/* -- assigned files -- */
 	int ref_count;
 	atomic_t mmap_count;
@@ -1138,6 +1157,14 @@ int snd_pcm_lib_ioctl(struct snd_pcm_substream *substream,
 		      unsigned int cmd, void *arg);                      
 void snd_pcm_period_elapsed_under_stream_lock(struct snd_pcm_substream *substream);
 void snd_pcm_period_elapsed(struct snd_pcm_substream *substream);
+void snd_pcm_period_group_init(struct snd_pcm_period_group *group);
+int snd_pcm_period_group_add(struct snd_pcm_period_group *group,
+			     struct snd_pcm_substream *substream);
+void snd_pcm_period_group_remove(struct snd_pcm_period_group *group,
+				 struct snd_pcm_substream *substream);
+int snd_pcm_period_group_start(struct snd_pcm_period_group *group,
+			       ktime_t period);
+void snd_pcm_period_group_stop(struct snd_pcm_period_group *group);
 snd_pcm_sframes_t __snd_pcm_lib_xfer(struct snd_pcm_substream *substream,
 				     void *buf, bool interleaved,
 				     snd_pcm_uframes_t frames, bool in_kernel);
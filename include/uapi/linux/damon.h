@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+/*
+ * Binary record formats of the DAMON access pattern stream
+ * (/dev/damon_stream).
+ *
+ * The stream is a sequence of records.  Every aggregation interval of a
+ * running monitoring context produces one aggregation record, followed for
+ * each monitoring target by the region records of the target (if region
+ * streaming is enabled) and one histogram record summarizing the target.
+ * All records start with a common 16 bit type field, so readers can skip
+ * record types they do not know.
+ */
+#ifndef _UAPI_LINUX_DAMON_H
+#define _UAPI_LINUX_DAMON_H
+
+#include <linux/types.h>
+
+#define DAMON_STREAM_REC_AGGR		0
+#define DAMON_STREAM_REC_REGION		1
+#define DAMON_STREAM_REC_HIST		2
+
+/* Number of access frequency bins of a histogram record */
+#define DAMON_STREAM_HIST_BINS		8
+
+/* Start of an aggregation interval report */
+struct damon_stream_aggr {
+	__u16 type;		/* DAMON_STREAM_REC_AGGR */
+	__u16 nr_targets;
+	__u32 pad;
+	__u64 time_ns;		/* CLOCK_MONOTONIC timestamp */
+};
+
+/* One monitoring target region */
+struct damon_stream_region {
+	__u16 type;		/* DAMON_STREAM_REC_REGION */
+	__u16 target_idx;
+	__u32 nr_accesses;
+	__u64 start;
+	__u64 end;
+	__u32 age;
+	__u32 pad;
+};
+
+/*
+ * Access frequency histogram of one monitoring target.  Regions are
+ * binned by their access frequency relative to the maximum possible
+ * number of access samples of the aggregation interval, so bin 0 holds
+ * the idle regions and the last bin the hottest ones.
+ */
+struct damon_stream_hist {
+	__u16 type;		/* DAMON_STREAM_REC_HIST */
+	__u16 target_idx;
+	__u32 pad;
+	__u64 nr_regions[DAMON_STREAM_HIST_BINS];
+	__u64 sz_regions[DAMON_STREAM_HIST_BINS];
+};
+
+#endif /* _UAPI_LINUX_DAMON_H */
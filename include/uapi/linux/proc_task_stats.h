@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+/*
+ * Binary per-task statistics records as read from /proc/task_stats.
+ *
+ * Each read returns a sequence of fixed-size records, one per thread group
+ * visible in the reader's pid namespace.  Which field groups are filled in is
+ * controlled by writing a PROC_TASK_STATS_* mask in decimal or hex to the
+ * open file; unrequested fields read as zero.  record_len allows new fields
+ * to be appended to the record without breaking old readers.
+ */
+#ifndef _UAPI_LINUX_PROC_TASK_STATS_H
+#define _UAPI_LINUX_PROC_TASK_STATS_H
+
+#include <linux/types.h>
+
+#define PROC_TASK_STATS_BASIC	0x0001	/* ppid..start_time */
+#define PROC_TASK_STATS_CPU	0x0002	/* utime..nice */
+#define PROC_TASK_STATS_MEM	0x0004	/* vsize..maj_flt */
+#define PROC_TASK_STATS_CREDS	0x0008	/* uid..fsgid */
+#define PROC_TASK_STATS_ALL	0x000f
+
+struct proc_task_stats {
+	__u32	record_len;	/* Size of this record in bytes */
+	__u32	pid;		/* Thread group id; always filled in */
+	__u64	fields;		/* Mask of PROC_TASK_STATS_* filled in */
+	/* PROC_TASK_STATS_BASIC */
+	__u32	ppid;
+	__u32	pgid;
+	__u32	sid;
+	__u32	state;		/* Same character as in /proc/pid/stat */
+	__u64	flags;		/* PF_* flags */
+	__u32	num_threads;
+	__u32	__reserved;
+	__u64	start_time;	/* Start time since boot in clock ticks */
+	/* PROC_TASK_STATS_CPU; times in clock ticks, group totals */
+	__u64	utime;
+	__u64	stime;
+	__u64	cutime;
+	__u64	cstime;
+	__s32	priority;
+	__s32	nice;
+	/* PROC_TASK_STATS_MEM */
+	__u64	vsize;		/* Virtual memory size in bytes */
+	__u64	rss;		/* Resident set size in pages */
+	__u64	rsslim;		/* RLIMIT_RSS current limit */
+	__u64	min_flt;	/* Group minor fault total */
+	__u64	maj_flt;	/* Group major fault total */
+	/* PROC_TASK_STATS_CREDS */
+	__u32	uid;
+	__u32	euid;
+	__u32	suid;
+	__u32	fsuid;
+	__u32	gid;
+	__u32	egid;
+	__u32	sgid;
+	__u32	fsgid;
+};
+
+#endif /* _UAPI_LINUX_PROC_TASK_STATS_H */
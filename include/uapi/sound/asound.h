@@ -142,7 +142,7 @@ struct snd_hwdep_dsp_image {
  *                                                                           *
  *****************************************************************************/
 
-#define SNDRV_PCM_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 15)
+#define SNDRV_PCM_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 16)
 
 typedef unsigned long snd_pcm_uframes_t;
 typedef signed long snd_pcm_sframes_t;
@@ -692,6 +692,21 @@ enum {
 #define SNDRV_PCM_IOCTL_LINK		_IOW('A', 0x60, int)
 #define SNDRV_PCM_IOCTL_UNLINK		_IO('A', 0x61)
 
+/* entry of a bulk appl_ptr commit; one per PCM file descriptor */
+struct snd_pcm_bulk_commit_entry {
+	__s32 fd;		/* PCM file descriptor */
+	__u32 reserved;		/* must be zero */
+	__s64 frames;		/* in: frames to forward, out: result or -errno */
+};
+
+struct snd_pcm_bulk_commit {
+	__u32 count;		/* number of entries that follow */
+	__u32 reserved;		/* must be zero */
+	struct snd_pcm_bulk_commit_entry entries[];
+};
+
+#define SNDRV_PCM_IOCTL_FORWARD_BULK	_IOWR('A', 0x62, struct snd_pcm_bulk_commit)
+
 /*****************************************************************************
  *                                                                           *
  *                            MIDI v1.0 interface                            *
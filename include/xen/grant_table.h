@@ -231,6 +231,35 @@ void gnttab_page_cache_put(struct gnttab_page_cache *cache, struct page **page,
 void gnttab_page_cache_shrink(struct gnttab_page_cache *cache,
 			      unsigned int num);
 
+/*
+ * Lazy-revocation cache for grant mappings.  Mappings released through
+ * gnttab_map_cache_put() are kept alive keyed by (domid, grant ref) so
+ * that a remap of the same grant is served without any hypercall;
+ * surplus mappings are revoked in bulk by a background worker.  Pages
+ * backing revoked mappings are returned to the associated
+ * gnttab_page_cache.
+ */
+struct gnttab_map_cache {
+	spinlock_t		lock;
+	struct hlist_head	*buckets;
+	struct list_head	lru;
+	unsigned int		num_entries;
+	unsigned int		max_entries;
+	struct gnttab_page_cache *page_cache;
+	struct delayed_work	revoke_work;
+};
+
+int gnttab_map_cache_init(struct gnttab_map_cache *cache,
+			  struct gnttab_page_cache *page_cache,
+			  unsigned int max_entries);
+void gnttab_map_cache_destroy(struct gnttab_map_cache *cache);
+bool gnttab_map_cache_get(struct gnttab_map_cache *cache, domid_t dom,
+			  grant_ref_t ref, struct page **page,
+			  grant_handle_t *handle);
+void gnttab_map_cache_put(struct gnttab_map_cache *cache, domid_t dom,
+			  grant_ref_t ref, struct page *page,
+			  grant_handle_t handle);
+
 #ifdef CONFIG_XEN_GRANT_DMA_ALLOC
 struct gnttab_dma_alloc_args {
 	/* Device for which DMA memory will be/was allocated. */
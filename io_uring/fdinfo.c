@@ -144,6 +144,24 @@ static __cold void __io_uring_show_fdinfo(struct io_ring_ctx *ctx,
 
 	seq_printf(m, "SqThread:\t%d\n", sq ? task_pid_nr(sq->thread) : -1);
 	seq_printf(m, "SqThreadCpu:\t%d\n", sq ? task_cpu(sq->thread) : -1);
+	if (sq) {
+		seq_puts(m, "SqArrivalHist:");
+		for (i = 0; i < IO_SQ_ARRIVAL_BUCKETS; i++)
+			seq_printf(m, "\t%llu", sq->arrival_hist[i]);
+		seq_putc(m, '\n');
+	}
+	if (ctx->opcode_stats) {
+		seq_puts(m, "OpStats:\n");
+		for (i = 0; i < IORING_OP_LAST; i++) {
+			u64 count = atomic64_read(&ctx->opcode_stats[i].count);
+			u64 nsec = atomic64_read(&ctx->opcode_stats[i].nsec);
+
+			if (!count)
+				continue;
+			seq_printf(m, "\t%s:\tcount=%llu\tnsec=%llu\n",
+				   io_uring_get_opcode(i), count, nsec);
+		}
+	}
 	seq_printf(m, "UserFiles:\t%u\n", ctx->nr_user_files);
 	for (i = 0; has_lock && i < ctx->nr_user_files; i++) {
 		struct file *f = io_file_from_index(&ctx->file_table, i);
@@ -90,7 +90,7 @@ static int io_install_fixed_file(struct io_ring_ctx *ctx, struct file *file,
 					    ctx->rsrc_node, old_file);
 		if (ret)
 			goto err;
-		file_slot->file_ptr = 0;
+		io_fixed_file_clear(file_slot);
 		io_file_bitmap_clear(&ctx->file_table, slot_index);
 		needs_switch = true;
 	}
@@ -170,7 +170,7 @@ int io_fixed_fd_remove(struct io_ring_ctx *ctx, unsigned int offset)
 	if (ret)
 		return ret;
 
-	file_slot->file_ptr = 0;
+	io_fixed_file_clear(file_slot);
 	io_file_bitmap_clear(&ctx->file_table, offset);
 	io_rsrc_node_switch(ctx, ctx->file_data);
 	return 0;
@@ -57,7 +57,13 @@ static inline void io_fixed_file_set(struct io_fixed_file *file_slot,
 	unsigned long file_ptr = (unsigned long) file;
 
 	file_ptr |= io_file_get_flags(file);
-	file_slot->file_ptr = file_ptr;
+	/* paired with READ_ONCE() in the lockless lookup fast path */
+	WRITE_ONCE(file_slot->file_ptr, file_ptr);
+}
+
+static inline void io_fixed_file_clear(struct io_fixed_file *file_slot)
+{
+	WRITE_ONCE(file_slot->file_ptr, 0);
 }
 
 static inline void io_reset_alloc_hint(struct io_ring_ctx *ctx)
@@ -15,6 +15,7 @@
 #include <linux/cpu.h>
 #include <linux/task_work.h>
 #include <linux/audit.h>
+#include <linux/blkdev.h>
 #include <uapi/linux/io_uring.h>
 
 #include "io-wq.h"
@@ -542,7 +543,16 @@ static void io_worker_handle_work(struct io_worker *worker)
 	struct io_wqe *wqe = worker->wqe;
 	struct io_wq *wq = wqe->wq;
 	bool do_kill = test_bit(IO_WQ_BIT_EXIT, &wq->state);
+	struct blk_plug plug;
 
+	/*
+	 * Hashed work runs as a chain of requests against the same file, so
+	 * adjacent buffered writes to one inode execute back to back in this
+	 * worker. Plug across the whole batch so any block I/O they kick off,
+	 * directly or via dirty throttling, is submitted in one go. The plug
+	 * is flushed automatically if the worker blocks.
+	 */
+	blk_start_plug(&plug);
 	do {
 		struct io_wq_work *work;
 
@@ -608,6 +618,7 @@ static void io_worker_handle_work(struct io_worker *worker)
 			}
 		} while (work);
 	} while (1);
+	blk_finish_plug(&plug);
 }
 
 static int io_wqe_worker(void *data)
@@ -961,9 +972,17 @@ static void io_wqe_enqueue(struct io_wqe *wqe, struct io_wq_work *work)
 
 void io_wq_enqueue(struct io_wq *wq, struct io_wq_work *work)
 {
-	struct io_wqe *wqe = wq->wqes[numa_node_id()];
+	int node = work->numa_node;
+
+	/*
+	 * Prefer the node owning the data the work targets, if the submitter
+	 * recorded one. Fall back to the local node, which is also where
+	 * workers for this wqe have historically been created.
+	 */
+	if (node == NUMA_NO_NODE || unlikely(!node_online(node)))
+		node = numa_node_id();
 
-	io_wqe_enqueue(wqe, work);
+	io_wqe_enqueue(wq->wqes[node], work);
 }
 
 /*
@@ -91,6 +91,7 @@
 #include "cancel.h"
 #include "net.h"
 #include "notif.h"
+#include "rw.h"
 
 #include "timeout.h"
 #include "poll.h"
@@ -311,6 +312,7 @@ static __cold struct io_ring_ctx *io_ring_ctx_alloc(struct io_uring_params *p)
 	INIT_LIST_HEAD(&ctx->io_buffers_cache);
 	io_alloc_cache_init(&ctx->apoll_cache);
 	io_alloc_cache_init(&ctx->netmsg_cache);
+	io_alloc_cache_init(&ctx->rw_cache);
 	init_completion(&ctx->ref_comp);
 	xa_init_flags(&ctx->personalities, XA_FLAGS_ALLOC1);
 	mutex_init(&ctx->uring_lock);
@@ -418,9 +420,20 @@ static void io_prep_async_work(struct io_kiocb *req)
 	req->work.list.next = NULL;
 	req->work.flags = 0;
 	req->work.cancel_seq = atomic_read(&ctx->cancel_seq);
+	req->work.numa_node = NUMA_NO_NODE;
 	if (req->flags & REQ_F_FORCE_ASYNC)
 		req->work.flags |= IO_WQ_WORK_CONCURRENT;
 
+	/*
+	 * If the request operates on a registered buffer, punt it to the node
+	 * that holds the buffer pages. Workers there execute node-local and
+	 * avoid pulling the data across the interconnect.
+	 */
+	if ((req->opcode == IORING_OP_READ_FIXED ||
+	     req->opcode == IORING_OP_WRITE_FIXED) &&
+	    req->imu && req->imu->nr_bvecs)
+		req->work.numa_node = page_to_nid(req->imu->bvec[0].bv_page);
+
 	if (req->file && !io_req_ffs_set(req))
 		req->flags |= io_file_get_flags(req->file) << REQ_F_SUPPORT_NOWAIT_BIT;
 
@@ -1904,7 +1917,17 @@ static int io_issue_sqe(struct io_kiocb *req, unsigned int issue_flags)
 	if (!def->audit_skip)
 		audit_uring_entry(req->opcode);
 
-	ret = def->issue(req, issue_flags);
+	if (unlikely(req->ctx->opcode_stats_enabled)) {
+		struct io_opcode_stat *stat = &req->ctx->opcode_stats[req->opcode];
+		u64 start = ktime_get_ns();
+
+		ret = def->issue(req, issue_flags);
+
+		atomic64_inc(&stat->count);
+		atomic64_add(ktime_get_ns() - start, &stat->nsec);
+	} else {
+		ret = def->issue(req, issue_flags);
+	}
 
 	if (!def->audit_skip)
 		audit_uring_exit(!ret, ret);
@@ -2014,6 +2037,24 @@ inline struct file *io_file_get_fixed(struct io_kiocb *req, int fd,
 	struct file *file = NULL;
 	unsigned long file_ptr;
 
+	/*
+	 * If submission already charged the rsrc node for this request, the
+	 * table can't be freed and any file unregistered since then can't be
+	 * put until our node reference drops, so the slot can be read without
+	 * the ring lock. This is the common path for punted fixed-file I/O.
+	 */
+	if (req->rsrc_node) {
+		if (unlikely((unsigned int)fd >= ctx->nr_user_files))
+			return NULL;
+		fd = array_index_nospec(fd, ctx->nr_user_files);
+		file_ptr = READ_ONCE(io_fixed_file_slot(&ctx->file_table, fd)->file_ptr);
+		file = (struct file *) (file_ptr & FFS_MASK);
+		file_ptr &= ~FFS_MASK;
+		/* mask in overlapping REQ_F and FFS bits */
+		req->flags |= (file_ptr << REQ_F_SUPPORT_NOWAIT_BIT);
+		return file;
+	}
+
 	io_ring_submit_lock(ctx, issue_flags);
 
 	if (unlikely((unsigned int)fd >= ctx->nr_user_files))
@@ -2220,6 +2261,16 @@ static int io_init_req(struct io_ring_ctx *ctx, struct io_kiocb *req,
 
 		req->cqe.fd = READ_ONCE(sqe->fd);
 
+		/*
+		 * Charge the current rsrc node up front for fixed files.
+		 * Nodes are recycled strictly in order, so holding a
+		 * reference here keeps any file unregistered later alive
+		 * until this request drops it. That makes the deferred slot
+		 * lookup in io_file_get_fixed() safe without the ring lock.
+		 */
+		if ((req->flags & REQ_F_FIXED_FILE) && ctx->file_data)
+			io_req_set_rsrc_node(req, ctx, 0);
+
 		/*
 		 * Plug now if we have more than 2 IO left after this, and the
 		 * target is potentially a read/write to block based storage.
@@ -2789,6 +2840,7 @@ static __cold void io_ring_ctx_free(struct io_ring_ctx *ctx)
 	io_eventfd_unregister(ctx);
 	io_alloc_cache_free(&ctx->apoll_cache, io_apoll_cache_free);
 	io_alloc_cache_free(&ctx->netmsg_cache, io_netmsg_cache_free);
+	io_alloc_cache_free(&ctx->rw_cache, io_rw_cache_free);
 	mutex_unlock(&ctx->uring_lock);
 	io_destroy_buffers(ctx);
 	if (ctx->sq_creds)
@@ -2827,6 +2879,7 @@ static __cold void io_ring_ctx_free(struct io_ring_ctx *ctx)
 	io_req_caches_free(ctx);
 	if (ctx->hash_map)
 		io_wq_put_hash(ctx->hash_map);
+	kfree(ctx->opcode_stats);
 	kfree(ctx->cancel_table.hbs);
 	kfree(ctx->cancel_table_locked.hbs);
 	kfree(ctx->dummy_ubuf);
@@ -4134,6 +4187,24 @@ err:
 	return ret;
 }
 
+static __cold int io_register_opcode_stats(struct io_ring_ctx *ctx, bool enable)
+{
+	if (enable && !ctx->opcode_stats) {
+		ctx->opcode_stats = kcalloc(IORING_OP_LAST,
+					    sizeof(*ctx->opcode_stats),
+					    GFP_KERNEL_ACCOUNT);
+		if (!ctx->opcode_stats)
+			return -ENOMEM;
+	}
+	/*
+	 * The array is kept around until ring teardown so that unlocked
+	 * issue paths never race with it being freed. Disabling only stops
+	 * the accounting, re-enabling continues on the same counters.
+	 */
+	ctx->opcode_stats_enabled = enable;
+	return 0;
+}
+
 static int __io_uring_register(struct io_ring_ctx *ctx, unsigned opcode,
 			       void __user *arg, unsigned nr_args)
 	__releases(ctx->uring_lock)
@@ -4292,6 +4363,12 @@ static int __io_uring_register(struct io_ring_ctx *ctx, unsigned opcode,
 			break;
 		ret = io_register_file_alloc_range(ctx, arg);
 		break;
+	case IORING_REGISTER_OPCODE_STATS:
+		ret = -EINVAL;
+		if (arg)
+			break;
+		ret = io_register_opcode_stats(ctx, nr_args != 0);
+		break;
 	default:
 		ret = -EINVAL;
 		break;
@@ -27,6 +27,12 @@ enum {
 	IOU_STOP_MULTISHOT	= -ECANCELED,
 };
 
+/* per-opcode issue count and time, see IORING_REGISTER_OPCODE_STATS */
+struct io_opcode_stat {
+	atomic64_t	count;
+	atomic64_t	nsec;
+};
+
 struct io_uring_cqe *__io_get_cqe(struct io_ring_ctx *ctx, bool overflow);
 bool io_req_cqe_overflow(struct io_kiocb *req);
 int io_run_task_work_sig(struct io_ring_ctx *ctx);
@@ -83,7 +83,13 @@ static int io_msg_exec_remote(struct io_kiocb *req, task_work_func_t func)
 		return -EOWNERDEAD;
 
 	init_task_work(&msg->tw, func);
-	if (task_work_add(ctx->submitter_task, &msg->tw, TWA_SIGNAL))
+	/*
+	 * Use the target ring's own notification method. Rings set up with
+	 * IORING_SETUP_TASKRUN_FLAG (the norm for thread-per-core setups,
+	 * which are the heavy msg_ring users) then pick messages up in batch
+	 * on their next ring transition instead of eating an IPI per message.
+	 */
+	if (task_work_add(ctx->submitter_task, &msg->tw, ctx->notify_method))
 		return -EOWNERDEAD;
 
 	return IOU_ISSUE_SKIP_COMPLETE;
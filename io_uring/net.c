@@ -554,7 +554,8 @@ int io_recvmsg_prep_async(struct io_kiocb *req)
 	return ret;
 }
 
-#define RECVMSG_FLAGS (IORING_RECVSEND_POLL_FIRST | IORING_RECV_MULTISHOT)
+#define RECVMSG_FLAGS (IORING_RECVSEND_POLL_FIRST | IORING_RECV_MULTISHOT | \
+			IORING_RECVSEND_FIXED_BUF)
 
 int io_recvmsg_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 {
@@ -591,6 +592,27 @@ int io_recvmsg_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 		 */
 		sr->buf_group = req->buf_index;
 	}
+	if (sr->flags & IORING_RECVSEND_FIXED_BUF) {
+		struct io_ring_ctx *ctx = req->ctx;
+		unsigned idx;
+
+		/*
+		 * Receive into a registered buffer skips the per-IO import
+		 * and pinning. Only the non-vectored variant makes sense
+		 * here, and the buffer is picked at prep time so the flag
+		 * can't be combined with provided buffer selection.
+		 */
+		if (req->opcode != IORING_OP_RECV)
+			return -EINVAL;
+		if (req->flags & (REQ_F_BUFFER_SELECT | REQ_F_APOLL_MULTISHOT))
+			return -EINVAL;
+		idx = READ_ONCE(sqe->buf_index);
+		if (unlikely(idx >= ctx->nr_user_bufs))
+			return -EFAULT;
+		idx = array_index_nospec(idx, ctx->nr_user_bufs);
+		req->imu = READ_ONCE(ctx->user_bufs[idx]);
+		io_req_set_rsrc_node(req, ctx, 0);
+	}
 
 #ifdef CONFIG_COMPAT
 	if (req->ctx->compat)
@@ -870,7 +892,11 @@ retry_multishot:
 		sr->buf = buf;
 	}
 
-	ret = import_ubuf(ITER_DEST, sr->buf, len, &msg.msg_iter);
+	if (sr->flags & IORING_RECVSEND_FIXED_BUF)
+		ret = io_import_fixed(ITER_DEST, &msg.msg_iter, req->imu,
+				      (u64)(uintptr_t)sr->buf, len);
+	else
+		ret = import_ubuf(ITER_DEST, sr->buf, len, &msg.msg_iter);
 	if (unlikely(ret))
 		goto out_free;
 
@@ -129,6 +129,47 @@ void io_readv_writev_cleanup(struct io_kiocb *req)
 	kfree(io->free_iovec);
 }
 
+static void io_rw_recycle(struct io_kiocb *req, unsigned int issue_flags)
+{
+	struct io_async_rw *io = req->async_data;
+
+	if (!req_has_async_data(req) || issue_flags & IO_URING_F_UNLOCKED)
+		return;
+
+	if (io->free_iovec) {
+		kfree(io->free_iovec);
+		req->flags &= ~REQ_F_NEED_CLEANUP;
+	}
+	/* Let normal cleanup path reap it if we fail adding to the cache */
+	if (io_alloc_cache_put(&req->ctx->rw_cache, &io->cache)) {
+		req->async_data = NULL;
+		req->flags &= ~REQ_F_ASYNC_DATA;
+	}
+}
+
+static struct io_async_rw *io_rw_alloc_async(struct io_kiocb *req,
+					     unsigned int issue_flags)
+{
+	struct io_ring_ctx *ctx = req->ctx;
+	struct io_cache_entry *entry;
+	struct io_async_rw *iorw;
+
+	if (!(issue_flags & IO_URING_F_UNLOCKED)) {
+		entry = io_alloc_cache_get(&ctx->rw_cache);
+		if (entry) {
+			iorw = container_of(entry, struct io_async_rw, cache);
+			iorw->free_iovec = NULL;
+			req->flags |= REQ_F_ASYNC_DATA;
+			req->async_data = iorw;
+			return iorw;
+		}
+	}
+
+	if (!io_alloc_async_data(req))
+		return req->async_data;
+	return NULL;
+}
+
 static inline void io_rw_done(struct kiocb *kiocb, ssize_t ret)
 {
 	switch (ret) {
@@ -343,6 +384,7 @@ static int kiocb_done(struct io_kiocb *req, ssize_t ret,
 			io_req_io_end(req);
 			io_req_set_res(req, final_ret,
 				       io_put_kbuf(req, issue_flags));
+			io_rw_recycle(req, issue_flags);
 			return IOU_OK;
 		}
 	} else {
@@ -517,14 +559,15 @@ static void io_req_map_rw(struct io_kiocb *req, const struct iovec *iovec,
 }
 
 static int io_setup_async_rw(struct io_kiocb *req, const struct iovec *iovec,
-			     struct io_rw_state *s, bool force)
+			     struct io_rw_state *s, bool force,
+			     unsigned int issue_flags)
 {
 	if (!force && !io_cold_defs[req->opcode].prep_async)
 		return 0;
 	if (!req_has_async_data(req)) {
 		struct io_async_rw *iorw;
 
-		if (io_alloc_async_data(req)) {
+		if (!io_rw_alloc_async(req, issue_flags)) {
 			kfree(iovec);
 			return -ENOMEM;
 		}
@@ -702,7 +745,7 @@ static int io_rw_init_file(struct io_kiocb *req, fmode_t mode)
 	return 0;
 }
 
-int io_read(struct io_kiocb *req, unsigned int issue_flags)
+static int __io_read(struct io_kiocb *req, unsigned int issue_flags)
 {
 	struct io_rw *rw = io_kiocb_to_cmd(req, struct io_rw);
 	struct io_rw_state __s, *s = &__s;
@@ -749,7 +792,7 @@ int io_read(struct io_kiocb *req, unsigned int issue_flags)
 	if (force_nonblock) {
 		/* If the file doesn't support async, just async punt */
 		if (unlikely(!io_file_supports_nowait(req))) {
-			ret = io_setup_async_rw(req, iovec, s, true);
+			ret = io_setup_async_rw(req, iovec, s, true, issue_flags);
 			return ret ?: -EAGAIN;
 		}
 		kiocb->ki_flags |= IOCB_NOWAIT;
@@ -797,7 +840,7 @@ int io_read(struct io_kiocb *req, unsigned int issue_flags)
 	 */
 	iov_iter_restore(&s->iter, &s->iter_state);
 
-	ret2 = io_setup_async_rw(req, iovec, s, true);
+	ret2 = io_setup_async_rw(req, iovec, s, true, issue_flags);
 	iovec = NULL;
 	if (ret2) {
 		ret = ret > 0 ? ret : ret2;
@@ -847,7 +890,110 @@ done:
 	/* it's faster to check here then delegate to kfree */
 	if (iovec)
 		kfree(iovec);
-	return kiocb_done(req, ret, issue_flags);
+	return ret;
+}
+
+int io_read(struct io_kiocb *req, unsigned int issue_flags)
+{
+	int ret;
+
+	ret = __io_read(req, issue_flags);
+	if (ret >= 0)
+		return kiocb_done(req, ret, issue_flags);
+
+	return ret;
+}
+
+int io_read_mshot_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
+{
+	struct io_rw *rw = io_kiocb_to_cmd(req, struct io_rw);
+	int ret;
+
+	ret = io_prep_rw(req, sqe);
+	if (unlikely(ret))
+		return ret;
+
+	/*
+	 * The buffer ring supplies both address and length, the SQE must
+	 * leave them unset.
+	 */
+	if (!(req->flags & REQ_F_BUFFER_SELECT))
+		return -EINVAL;
+	if (rw->addr || rw->len)
+		return -EINVAL;
+
+	req->flags |= REQ_F_APOLL_MULTISHOT;
+	return 0;
+}
+
+/*
+ * Cap how many provided buffers a single multishot issue may consume
+ * inline, so that a long run of cached data can't starve other work.
+ */
+#define IO_READ_MSHOT_BUDGET	32
+
+int io_read_mshot(struct io_kiocb *req, unsigned int issue_flags)
+{
+	struct io_rw *rw = io_kiocb_to_cmd(req, struct io_rw);
+	u16 buf_group = req->buf_index;
+	unsigned int cflags = 0;
+	int nr_bufs = 0;
+	int ret;
+
+	/*
+	 * Pollable files re-arm through poll like multishot receive does.
+	 * Regular files can't, but they still batch one CQE per consumed
+	 * buffer for as long as data is readily available.
+	 */
+	if (!file_can_poll(req->file) && !(req->flags & REQ_F_ISREG))
+		return -EBADFD;
+
+again:
+	ret = __io_read(req, issue_flags);
+
+	/*
+	 * If we get -EAGAIN on a pollable file, recycle the buffer and let
+	 * normal poll handling re-arm the read. Anything else terminates
+	 * the multishot and completes with the result so far.
+	 */
+	if (ret == -EAGAIN && file_can_poll(req->file)) {
+		io_kbuf_recycle(req, issue_flags);
+		return -EAGAIN;
+	}
+
+	if (ret > 0) {
+		cflags = io_put_kbuf(req, issue_flags);
+		/* re-select from the same buffer group on the next round */
+		req->buf_index = buf_group;
+		rw->len = 0;
+
+		if (io_aux_cqe(req->ctx, issue_flags & IO_URING_F_COMPLETE_DEFER,
+			       req->cqe.user_data, ret,
+			       cflags | IORING_CQE_F_MORE, true)) {
+			if (req->flags & REQ_F_ISREG) {
+				if (++nr_bufs < IO_READ_MSHOT_BUDGET)
+					goto again;
+				/* rearm via the terminating CQE */
+				ret = -EAGAIN;
+			} else {
+				if (issue_flags & IO_URING_F_MULTISHOT)
+					return IOU_ISSUE_SKIP_COMPLETE;
+				return -EAGAIN;
+			}
+		}
+	} else {
+		/* drop a buffer selected for a read that didn't complete */
+		io_kbuf_recycle(req, issue_flags);
+	}
+
+	/*
+	 * An error, EOF, exhausted budget, or CQ overflow terminates the
+	 * multishot request.
+	 */
+	io_req_set_res(req, ret, cflags);
+	if (issue_flags & IO_URING_F_MULTISHOT)
+		return IOU_ISSUE_SKIP_COMPLETE;
+	return IOU_OK;
 }
 
 int io_write(struct io_kiocb *req, unsigned int issue_flags)
@@ -955,7 +1101,7 @@ int io_write(struct io_kiocb *req, unsigned int issue_flags)
 			 * the bytes already written.
 			 */
 			iov_iter_save_state(&s->iter, &s->iter_state);
-			ret = io_setup_async_rw(req, iovec, s, true);
+			ret = io_setup_async_rw(req, iovec, s, true, issue_flags);
 
 			io = req->async_data;
 			if (io)
@@ -970,7 +1116,7 @@ done:
 	} else {
 copy_iov:
 		iov_iter_restore(&s->iter, &s->iter_state);
-		ret = io_setup_async_rw(req, iovec, s, false);
+		ret = io_setup_async_rw(req, iovec, s, false, issue_flags);
 		if (!ret) {
 			if (kiocb->ki_flags & IOCB_WRITE)
 				kiocb_end_write(req);
@@ -1082,3 +1228,8 @@ int io_do_iopoll(struct io_ring_ctx *ctx, bool force_nonspin)
 	io_free_batch_list(ctx, pos);
 	return nr_events;
 }
+
+void io_rw_cache_free(struct io_cache_entry *entry)
+{
+	kfree(container_of(entry, struct io_async_rw, cache));
+}
@@ -2,6 +2,8 @@
 
 #include <linux/pagemap.h>
 
+#include "alloc_cache.h"
+
 struct io_rw_state {
 	struct iov_iter			iter;
 	struct iov_iter_state		iter_state;
@@ -9,7 +11,10 @@ struct io_rw_state {
 };
 
 struct io_async_rw {
-	struct io_rw_state		s;
+	union {
+		struct io_rw_state	s;
+		struct io_cache_entry	cache;
+	};
 	const struct iovec		*free_iovec;
 	size_t				bytes_done;
 	struct wait_page_queue		wpq;
@@ -17,8 +22,11 @@ struct io_async_rw {
 
 int io_prep_rw(struct io_kiocb *req, const struct io_uring_sqe *sqe);
 int io_read(struct io_kiocb *req, unsigned int issue_flags);
+int io_read_mshot_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe);
+int io_read_mshot(struct io_kiocb *req, unsigned int issue_flags);
 int io_readv_prep_async(struct io_kiocb *req);
 int io_write(struct io_kiocb *req, unsigned int issue_flags);
 int io_writev_prep_async(struct io_kiocb *req);
 void io_readv_writev_cleanup(struct io_kiocb *req);
 void io_rw_fail(struct io_kiocb *req);
+void io_rw_cache_free(struct io_cache_entry *entry);
@@ -9,6 +9,7 @@
 #include <linux/mm.h>
 #include <linux/slab.h>
 #include <linux/audit.h>
+#include <linux/cpuidle.h>
 #include <linux/security.h>
 #include <linux/io_uring.h>
 
@@ -19,6 +20,9 @@
 
 #define IORING_SQPOLL_CAP_ENTRIES_VALUE 8
 
+/* Wakeup latency the CPU of a busy pinned SQPOLL thread should honor. */
+#define IORING_SQPOLL_LATENCY_HINT_NS	(10 * NSEC_PER_USEC)
+
 enum {
 	IO_SQ_THREAD_SHOULD_STOP = 0,
 	IO_SQ_THREAD_SHOULD_PARK,
@@ -152,6 +156,7 @@ static struct io_sq_data *io_get_sq_data(struct io_uring_params *p,
 
 	atomic_set(&sqd->park_pending, 0);
 	refcount_set(&sqd->refs, 1);
+	sqd->last_arrival = jiffies;
 	INIT_LIST_HEAD(&sqd->ctx_list);
 	mutex_init(&sqd->lock);
 	init_waitqueue_head(&sqd->wait);
@@ -202,6 +207,40 @@ static int __io_sq_thread(struct io_ring_ctx *ctx, bool cap_entries)
 	return ret;
 }
 
+/*
+ * Record that the thread found work this iteration and note how long the
+ * ring had been quiet before it. A fresh burst resets the idle backoff so
+ * we return to full busy-polling while submissions keep arriving.
+ */
+static void io_sqd_note_arrival(struct io_sq_data *sqd)
+{
+	unsigned long now = jiffies;
+	unsigned long delta = now - sqd->last_arrival;
+	unsigned bucket = delta ? ilog2(delta) : 0;
+
+	if (bucket >= IO_SQ_ARRIVAL_BUCKETS)
+		bucket = IO_SQ_ARRIVAL_BUCKETS - 1;
+	sqd->arrival_hist[bucket]++;
+	sqd->last_arrival = now;
+	sqd->idle_shift = 0;
+}
+
+/*
+ * Each idle timeout that expires without any work halves the next spin
+ * period, so a quiet ring quickly degrades from busy-poll through a short
+ * hybrid poll down to purely wakeup-driven operation.
+ */
+static inline unsigned io_sqd_effective_idle(struct io_sq_data *sqd)
+{
+	return max_t(unsigned, sqd->sq_thread_idle >> sqd->idle_shift, 1);
+}
+
+static void io_sqd_backoff_idle(struct io_sq_data *sqd)
+{
+	if (sqd->idle_shift < fls(sqd->sq_thread_idle))
+		sqd->idle_shift++;
+}
+
 static bool io_sqd_handle_event(struct io_sq_data *sqd)
 {
 	bool did_sig = false;
@@ -241,7 +280,7 @@ static int io_sq_thread(void *data)
 		if (io_sqd_events_pending(sqd) || signal_pending(current)) {
 			if (io_sqd_handle_event(sqd))
 				break;
-			timeout = jiffies + sqd->sq_thread_idle;
+			timeout = jiffies + io_sqd_effective_idle(sqd);
 		}
 
 		cap_entries = !list_is_singular(&sqd->ctx_list);
@@ -256,10 +295,23 @@ static int io_sq_thread(void *data)
 
 		if (sqt_spin || !time_after(jiffies, timeout)) {
 			cond_resched();
-			if (sqt_spin)
-				timeout = jiffies + sqd->sq_thread_idle;
+			if (sqt_spin) {
+				io_sqd_note_arrival(sqd);
+				timeout = jiffies + io_sqd_effective_idle(sqd);
+				/*
+				 * Keep the pinned CPU out of deep idle states
+				 * while work keeps arriving; the hint expires
+				 * with the spin window, so a quiet ring stops
+				 * constraining cpuidle on its own.
+				 */
+				if (sqd->sq_cpu != -1)
+					cpuidle_cpu_latency_hint(sqd->sq_cpu,
+						IORING_SQPOLL_LATENCY_HINT_NS,
+						jiffies_to_nsecs(io_sqd_effective_idle(sqd)));
+			}
 			continue;
 		}
+		io_sqd_backoff_idle(sqd);
 
 		prepare_to_wait(&sqd->wait, &wait, TASK_INTERRUPTIBLE);
 		if (!io_sqd_events_pending(sqd) && !task_work_pending(current)) {
@@ -297,7 +349,7 @@ static int io_sq_thread(void *data)
 		}
 
 		finish_wait(&sqd->wait, &wait);
-		timeout = jiffies + sqd->sq_thread_idle;
+		timeout = jiffies + io_sqd_effective_idle(sqd);
 	}
 
 	io_uring_cancel_generic(true, sqd);
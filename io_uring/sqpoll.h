@@ -1,5 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0
 
+/* log2 buckets of submission inter-arrival time, in jiffies */
+#define IO_SQ_ARRIVAL_BUCKETS	8
+
 struct io_sq_data {
 	refcount_t		refs;
 	atomic_t		park_pending;
@@ -16,6 +19,15 @@ struct io_sq_data {
 	pid_t			task_pid;
 	pid_t			task_tgid;
 
+	/*
+	 * Adaptive idle state, only touched by the SQPOLL thread itself.
+	 * arrival_hist counts submission bursts by inter-arrival time and
+	 * idle_shift scales sq_thread_idle down while the ring stays quiet.
+	 */
+	u64			arrival_hist[IO_SQ_ARRIVAL_BUCKETS];
+	unsigned long		last_arrival;
+	unsigned		idle_shift;
+
 	unsigned long		state;
 	struct completion	exited;
 };
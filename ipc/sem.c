@@ -122,6 +122,7 @@ struct sem_array {
 	int			sem_nsems;	/* no. of semaphores in array */
 	int			complex_count;	/* pending complex operations */
 	unsigned int		use_global_lock;/* >0: global lock required */
+	atomic_t		lockless_ops;	/* in-flight lockless semops */
 
 	struct sem		sems[];
 } __randomize_layout;
@@ -238,6 +239,19 @@ static int sysvipc_sem_proc_show(struct seq_file *s, void *it);
  * happen immediately after calling wake_q_add. As wake_q_add_safe() is called
  * when holding sem_lock(), no further barriers are required.
  *
+ * 4) sem_array.lockless_ops: (SEM_BARRIER_3)
+ * Uncontended single-semaphore alter operations may run without sem_lock(),
+ * updating semval with cmpxchg().  Such an operation announces itself by
+ * incrementing lockless_ops (followed by a full barrier) and then backs off
+ * unless the per-semaphore lock is free, use_global_lock is zero and no
+ * waiter is queued.  Every path that acquires sem_lock() in turn waits for
+ * lockless_ops to drain (with full barriers around the read) before touching
+ * any semaphore state.  Thus a lockless update and a locked critical section
+ * never run concurrently: one of the two always observes the other's
+ * announcement.  Waiters queue up under sem_lock(), so a lockless op that
+ * finds the pending lists empty cannot steal a wakeup: any later enqueue
+ * drains lockless_ops first and then re-reads semval.
+ *
  * See also ipc/mqueue.c for more details on the covered races.
  */
 
@@ -329,6 +343,19 @@ static void sem_rcu_free(struct rcu_head *head)
 	kvfree(sma);
 }
 
+/*
+ * Wait for in-flight lockless operations to complete.  Must be called
+ * after acquiring the per-semaphore lock, or after setting
+ * use_global_lock while holding sem_perm.lock; see SEM_BARRIER_3.
+ */
+static void sem_lockless_drain(struct sem_array *sma)
+{
+	smp_mb();
+	while (atomic_read(&sma->lockless_ops))
+		cpu_relax();
+	smp_mb();
+}
+
 /*
  * Enter the mode suitable for non-simple operations:
  * Caller must own sem_perm.lock.
@@ -354,6 +381,12 @@ static void complexmode_enter(struct sem_array *sma)
 		spin_lock(&sem->lock);
 		spin_unlock(&sem->lock);
 	}
+
+	/*
+	 * Lockless ops started after this point observe use_global_lock
+	 * and back off; wait out any that are already in flight.
+	 */
+	sem_lockless_drain(sma);
 }
 
 /*
@@ -425,6 +458,7 @@ static inline int sem_lock(struct sem_array *sma, struct sembuf *sops,
 		/* see SEM_BARRIER_1 for purpose/pairing */
 		if (!smp_load_acquire(&sma->use_global_lock)) {
 			/* fast path successful! */
+			sem_lockless_drain(sma);
 			return sops->sem_num;
 		}
 		spin_unlock(&sem->lock);
@@ -446,6 +480,7 @@ static inline int sem_lock(struct sem_array *sma, struct sembuf *sops,
 		spin_lock(&sem->lock);
 
 		ipc_unlock_object(&sma->sem_perm);
+		sem_lockless_drain(sma);
 		return sops->sem_num;
 	} else {
 		/*
@@ -564,6 +599,7 @@ static int newary(struct ipc_namespace *ns, struct ipc_params *params)
 
 	sma->complex_count = 0;
 	sma->use_global_lock = USE_GLOBAL_LOCK_HYSTERESIS;
+	atomic_set(&sma->lockless_ops, 0);
 	INIT_LIST_HEAD(&sma->pending_alter);
 	INIT_LIST_HEAD(&sma->pending_const);
 	INIT_LIST_HEAD(&sma->list_id);
@@ -1982,6 +2018,93 @@ out:
 	return un;
 }
 
+/**
+ * sem_lockless_semop - attempt a simple alter operation without sem_lock()
+ * @sma: semaphore array
+ * @sop: the single operation to perform
+ *
+ * Perform an uncontended single-semaphore alter operation by updating
+ * semval with cmpxchg() instead of taking the (per-semaphore or global)
+ * lock.  The fast path backs off to the locked slow path whenever a
+ * locked critical section, a queued waiter or a complex operation is
+ * around, and whenever the operation would block - only operations that
+ * can complete immediately are handled here.  See SEM_BARRIER_3 for how
+ * this is kept mutually exclusive with sem_lock() critical sections.
+ *
+ * The caller must hold the RCU read lock and must have performed the
+ * permission and security checks.
+ *
+ * Return: 0 on success, 1 if the caller must fall back to the slow path.
+ */
+static int sem_lockless_semop(struct sem_array *sma, struct sembuf *sop)
+{
+	struct pid *pid;
+	struct sem *curr;
+	int idx, val, newval;
+	int ret = 1;
+
+	if (sop->sem_op == 0 || (sop->sem_flg & SEM_UNDO))
+		return 1;
+
+	idx = array_index_nospec(sop->sem_num, sma->sem_nsems);
+	curr = &sma->sems[idx];
+
+	/*
+	 * Lock holders may busy-wait on lockless_ops, so the window the
+	 * counter is held open for must not include preemption.
+	 */
+	preempt_disable();
+	atomic_inc(&sma->lockless_ops);
+	/* see SEM_BARRIER_3 for purpose/pairing */
+	smp_mb__after_atomic();
+
+	if (READ_ONCE(sma->use_global_lock) || sma->complex_count ||
+	    spin_is_locked(&curr->lock) ||
+	    !ipc_valid_object(&sma->sem_perm))
+		goto out;
+
+	/*
+	 * curr->lock was observed free.  The last critical section for
+	 * this semaphore ended with a releasing unlock, so after the
+	 * read barrier the pending lists read below are at least as
+	 * recent as that critical section; any later critical section
+	 * drains lockless_ops and cannot overlap with us.
+	 */
+	smp_rmb();
+
+	if (!list_empty(&curr->pending_alter) ||
+	    !list_empty(&curr->pending_const))
+		goto out;
+
+	val = READ_ONCE(curr->semval);
+	newval = val + sop->sem_op;
+	/* Let the slow path sort out blocking ops and range errors. */
+	if (newval < 0 || newval > SEMVMX)
+		goto out;
+
+	if (cmpxchg(&curr->semval, val, newval) != val)
+		goto out;
+
+	/*
+	 * Unlike ipc_update_pid(), this must cope with a concurrent
+	 * lockless update of sempid; locked updates are excluded by
+	 * the lockless_ops drain.
+	 */
+	pid = task_tgid(current);
+	if (READ_ONCE(curr->sempid) != pid)
+		put_pid(xchg(&curr->sempid, get_pid(pid)));
+
+	WRITE_ONCE(curr->sem_otime, ktime_get_real_seconds());
+
+	ret = 0;
+out:
+	/* Order the semval update before the decrement, see SEM_BARRIER_3 */
+	smp_mb__before_atomic();
+	atomic_dec(&sma->lockless_ops);
+	preempt_enable();
+	return ret;
+}
+
 long __do_semtimedop(int semid, struct sembuf *sops,
 		unsigned nsops, const struct timespec64 *timeout,
 		struct ipc_namespace *ns)
@@ -2071,6 +2194,12 @@ long __do_semtimedop(int semid, struct sembuf *sops,
 		goto out;
 	}
 
+	if (nsops == 1 && alter && !un && !sem_lockless_semop(sma, sops)) {
+		rcu_read_unlock();
+		error = 0;
+		goto out;
+	}
+
 	error = -EIDRM;
 	locknum = sem_lock(sma, sops, nsops);
 	/*
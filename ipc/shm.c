@@ -44,6 +44,8 @@
 #include <linux/mount.h>
 #include <linux/ipc_namespace.h>
 #include <linux/rhashtable.h>
+#include <linux/mempolicy.h>
+#include <linux/khugepaged.h>
 
 #include <linux/uaccess.h>
 
@@ -62,6 +64,13 @@ struct shmid_kernel /* private to the kernel */
 	struct pid		*shm_lprid;
 	struct ucounts		*mlock_ucounts;
 
+	/*
+	 * Segment opted in to transparent hugepage promotion via
+	 * shmctl(SHM_HUGEPAGE).  Sampled at attach time; only affects
+	 * mappings created after the flag is set.
+	 */
+	bool			shm_hugepage;
+
 	/*
 	 * The task created the shm object, for
 	 * task_lock(shp->shm_creator)
@@ -85,6 +94,7 @@ struct shm_file_data {
 	struct ipc_namespace *ns;
 	struct file *file;
 	const struct vm_operations_struct *vm_ops;
+	bool hugepage;
 };
 
 #define shm_file_data(file) (*((struct shm_file_data **)&(file)->private_data))
@@ -613,6 +623,10 @@ static int shm_mmap(struct file *file, struct vm_area_struct *vma)
 	WARN_ON(!sfd->vm_ops->fault);
 #endif
 	vma->vm_ops = &shm_vm_ops;
+	if (sfd->hugepage) {
+		vm_flags_set(vma, VM_HUGEPAGE);
+		khugepaged_enter_vma(vma, vma->vm_flags);
+	}
 	return 0;
 }
 
@@ -1242,6 +1256,241 @@ out_unlock1:
 	return err;
 }
 
+/*
+ * Look up a segment for one of the NUMA/hugepage subcommands and check
+ * that the caller may modify it: owner, creator or CAP_SYS_ADMIN in the
+ * namespace.  On success the segment is returned locked, with the rcu
+ * read lock held.
+ */
+static struct shmid_kernel *shm_obtain_object_modify(struct ipc_namespace *ns,
+						     int shmid, int cmd)
+{
+	struct shmid_kernel *shp;
+	int err;
+
+	rcu_read_lock();
+	shp = shm_obtain_object_check(ns, shmid);
+	if (IS_ERR(shp))
+		goto out_unlock;
+
+	audit_ipc_obj(&(shp->shm_perm));
+	err = security_shm_shmctl(&shp->shm_perm, cmd);
+	if (err) {
+		shp = ERR_PTR(err);
+		goto out_unlock;
+	}
+
+	ipc_lock_object(&shp->shm_perm);
+
+	/* check if shm_destroy() is tearing down shp */
+	if (!ipc_valid_object(&shp->shm_perm)) {
+		shp = ERR_PTR(-EIDRM);
+		goto out_unlock0;
+	}
+
+	if (!ns_capable(ns->user_ns, CAP_SYS_ADMIN)) {
+		kuid_t euid = current_euid();
+
+		if (!uid_eq(euid, shp->shm_perm.uid) &&
+		    !uid_eq(euid, shp->shm_perm.cuid)) {
+			shp = ERR_PTR(-EPERM);
+			goto out_unlock0;
+		}
+	}
+	return shp;
+
+out_unlock0:
+	ipc_unlock_object(&shp->shm_perm);
+out_unlock:
+	rcu_read_unlock();
+	return shp;
+}
+
+/*
+ * SHM_SET_POLICY: install a NUMA memory policy covering the whole
+ * segment.  The policy lives in the shared_policy tree of the backing
+ * shmem inode, so it applies to every current and future attach and is
+ * consulted at fault time, exactly like mbind() on an individual
+ * mapping would be.  struct shm_numa_policy is defined in
+ * <uapi/linux/shm.h>:
+ *
+ *	struct shm_numa_policy {
+ *		__s32 mode;		// MPOL_* mode
+ *		__u32 flags;		// reserved, must be 0
+ *		__u64 nodemask;		// nodes, one bit per node
+ *	};
+ */
+static int shmctl_set_policy(struct ipc_namespace *ns, int shmid,
+			     void __user *buf)
+{
+	struct shm_numa_policy p;
+	struct vm_area_struct pvma;
+	struct shmid_kernel *shp;
+	struct mempolicy *new;
+	struct file *shm_file;
+	nodemask_t nodes;
+	int err;
+
+	if (copy_from_user(&p, buf, sizeof(p)))
+		return -EFAULT;
+	if (p.flags)
+		return -EINVAL;
+	if (p.mode < 0 || p.mode >= MPOL_MAX)
+		return -EINVAL;
+	if (BITS_PER_LONG < 64 && (p.nodemask >> MAX_NUMNODES))
+		return -EINVAL;
+
+	nodes_clear(nodes);
+	bitmap_from_arr64(nodes_addr(nodes), &p.nodemask,
+			  min_t(unsigned int, 64, MAX_NUMNODES));
+
+	new = mpol_create(p.mode, 0, &nodes);
+	if (IS_ERR(new))
+		return PTR_ERR(new);
+
+	shp = shm_obtain_object_modify(ns, shmid, SHM_SET_POLICY);
+	if (IS_ERR(shp)) {
+		mpol_put(new);
+		return PTR_ERR(shp);
+	}
+
+	shm_file = shp->shm_file;
+	if (is_file_hugepages(shm_file)) {
+		ipc_unlock_object(&shp->shm_perm);
+		rcu_read_unlock();
+		mpol_put(new);
+		return -EOPNOTSUPP;
+	}
+
+	/*
+	 * mpol_set_shared_policy() allocates and may sleep; pin the file
+	 * and drop the ipc lock first, as SHM_UNLOCK does.
+	 */
+	get_file(shm_file);
+	ipc_unlock_object(&shp->shm_perm);
+	rcu_read_unlock();
+
+	/*
+	 * The shared policy tree is indexed by pgoff; build a pseudo vma
+	 * spanning the whole segment, as shmem does for its own faults.
+	 */
+	vma_init(&pvma, NULL);
+	pvma.vm_pgoff = 0;
+	pvma.vm_start = 0;
+	pvma.vm_end = PAGE_ALIGN(i_size_read(file_inode(shm_file)));
+
+	err = mpol_set_shared_policy(&SHMEM_I(file_inode(shm_file))->policy,
+				     &pvma, new);
+	fput(shm_file);
+	mpol_put(new);
+	return err;
+}
+
+/*
+ * SHM_HUGEPAGE/SHM_NOHUGEPAGE: opt the segment in to (or out of)
+ * transparent hugepage collapse.  New attaches get VM_HUGEPAGE and are
+ * registered with khugepaged, which promotes eligible ranges in the
+ * background; existing mappings are left alone.
+ */
+static int shmctl_hugepage(struct ipc_namespace *ns, int shmid, int cmd)
+{
+	struct shmid_kernel *shp;
+	int err = 0;
+
+	shp = shm_obtain_object_modify(ns, shmid, cmd);
+	if (IS_ERR(shp))
+		return PTR_ERR(shp);
+
+	if (is_file_hugepages(shp->shm_file))
+		err = -EOPNOTSUPP;
+	else
+		WRITE_ONCE(shp->shm_hugepage, cmd == SHM_HUGEPAGE);
+
+	ipc_unlock_object(&shp->shm_perm);
+	rcu_read_unlock();
+	return err;
+}
+
+/*
+ * SHM_HUGE_STAT: report how much of the segment is currently backed by
+ * large folios.  struct shm_hugepage_info is defined in
+ * <uapi/linux/shm.h>:
+ *
+ *	struct shm_hugepage_info {
+ *		__u64 shm_segsz;	// segment size in bytes
+ *		__u64 huge_bytes;	// bytes backed by large folios
+ *	};
+ */
+static int shmctl_huge_stat(struct ipc_namespace *ns, int shmid,
+			    void __user *buf)
+{
+	struct shm_hugepage_info info;
+	struct shmid_kernel *shp;
+	struct address_space *mapping;
+	struct file *shm_file;
+	struct folio *folio;
+	pgoff_t last;
+	int err = 0;
+
+	rcu_read_lock();
+	shp = shm_obtain_object_check(ns, shmid);
+	if (IS_ERR(shp)) {
+		rcu_read_unlock();
+		return PTR_ERR(shp);
+	}
+
+	audit_ipc_obj(&(shp->shm_perm));
+
+	if (ipcperms(ns, &shp->shm_perm, S_IRUGO)) {
+		rcu_read_unlock();
+		return -EACCES;
+	}
+
+	err = security_shm_shmctl(&shp->shm_perm, SHM_HUGE_STAT);
+	if (err) {
+		rcu_read_unlock();
+		return err;
+	}
+
+	ipc_lock_object(&shp->shm_perm);
+
+	if (!ipc_valid_object(&shp->shm_perm)) {
+		ipc_unlock_object(&shp->shm_perm);
+		rcu_read_unlock();
+		return -EIDRM;
+	}
+
+	memset(&info, 0, sizeof(info));
+	info.shm_segsz = shp->shm_segsz;
+	shm_file = get_file(shp->shm_file);
+	ipc_unlock_object(&shp->shm_perm);
+	rcu_read_unlock();
+
+	mapping = shm_file->f_mapping;
+	last = (i_size_read(file_inode(shm_file)) - 1) >> PAGE_SHIFT;
+
+	{
+		XA_STATE(xas, &mapping->i_pages, 0);
+
+		rcu_read_lock();
+		xas_for_each(&xas, folio, last) {
+			if (xas_retry(&xas, folio))
+				continue;
+			if (xa_is_value(folio))
+				continue;
+			if (folio_test_large(folio))
+				info.huge_bytes += folio_size(folio);
+		}
+		rcu_read_unlock();
+	}
+
+	fput(shm_file);
+
+	if (copy_to_user(buf, &info, sizeof(info)))
+		return -EFAULT;
+	return 0;
+}
+
 static long ksys_shmctl(int shmid, int cmd, struct shmid_ds __user *buf, int version)
 {
 	int err;
@@ -1291,6 +1540,13 @@ static long ksys_shmctl(int shmid, int cmd, struct shmid_ds __user *buf, int ver
 	case SHM_LOCK:
 	case SHM_UNLOCK:
 		return shmctl_do_lock(ns, shmid, cmd);
+	case SHM_SET_POLICY:
+		return shmctl_set_policy(ns, shmid, buf);
+	case SHM_HUGEPAGE:
+	case SHM_NOHUGEPAGE:
+		return shmctl_hugepage(ns, shmid, cmd);
+	case SHM_HUGE_STAT:
+		return shmctl_huge_stat(ns, shmid, buf);
 	default:
 		return -EINVAL;
 	}
@@ -1486,6 +1742,15 @@ static long compat_ksys_shmctl(int shmid, int cmd, void __user *uptr, int versio
 	case SHM_LOCK:
 	case SHM_UNLOCK:
 		return shmctl_do_lock(ns, shmid, cmd);
+	case SHM_SET_POLICY:
+		/* fixed-width layout, no compat translation needed */
+		return shmctl_set_policy(ns, shmid, uptr);
+	case SHM_HUGEPAGE:
+	case SHM_NOHUGEPAGE:
+		return shmctl_hugepage(ns, shmid, cmd);
+	case SHM_HUGE_STAT:
+		/* fixed-width layout, no compat translation needed */
+		return shmctl_huge_stat(ns, shmid, uptr);
 	default:
 		return -EINVAL;
 	}
@@ -1642,6 +1907,7 @@ long do_shmat(int shmid, char __user *shmaddr, int shmflg,
 	sfd->ns = get_ipc_ns(ns);
 	sfd->file = base;
 	sfd->vm_ops = NULL;
+	sfd->hugepage = READ_ONCE(shp->shm_hugepage);
 	file->private_data = sfd;
 
 	err = security_mmap_file(file, prot, flags);
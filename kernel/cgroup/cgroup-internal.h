@@ -271,6 +271,7 @@ int cgroup_task_count(const struct cgroup *cgrp);
  */
 int cgroup_rstat_init(struct cgroup *cgrp);
 void cgroup_rstat_exit(struct cgroup *cgrp);
+void cgroup_rstat_watch_set(struct cgroup *cgrp, bool watch);
 void cgroup_rstat_boot(void);
 void cgroup_base_stat_cputime_show(struct seq_file *seq);
 
@@ -3924,6 +3924,40 @@ static ssize_t cgroup_freeze_write(struct kernfs_open_file *of,
 	return nbytes;
 }
 
+static int cgroup_stat_watch_show(struct seq_file *seq, void *v)
+{
+	struct cgroup *cgrp = seq_css(seq)->cgroup;
+
+	seq_printf(seq, "%d\n", cgrp->rstat_watch);
+
+	return 0;
+}
+
+static ssize_t cgroup_stat_watch_write(struct kernfs_open_file *of,
+				       char *buf, size_t nbytes, loff_t off)
+{
+	struct cgroup *cgrp;
+	ssize_t ret;
+	int watch;
+
+	ret = kstrtoint(strstrip(buf), 0, &watch);
+	if (ret)
+		return ret;
+
+	if (watch < 0 || watch > 1)
+		return -ERANGE;
+
+	cgrp = cgroup_kn_lock_live(of->kn, false);
+	if (!cgrp)
+		return -ENOENT;
+
+	cgroup_rstat_watch_set(cgrp, watch);
+
+	cgroup_kn_unlock(of->kn);
+
+	return nbytes;
+}
+
 static void __cgroup_kill(struct cgroup *cgrp)
 {
 	struct css_task_iter it;
@@ -5254,6 +5288,11 @@ static struct cftype cgroup_base_files[] = {
 		.flags = CFTYPE_NOT_ON_ROOT,
 		.write = cgroup_kill_write,
 	},
+	{
+		.name = "cgroup.stat_watch",
+		.seq_show = cgroup_stat_watch_show,
+		.write = cgroup_stat_watch_write,
+	},
 	{
 		.name = "cpu.stat",
 		.seq_show = cpu_stat_show,
@@ -10,6 +10,9 @@
 static DEFINE_SPINLOCK(cgroup_rstat_lock);
 static DEFINE_PER_CPU(raw_spinlock_t, cgroup_rstat_cpu_lock);
 
+/* background refresh period for watchpoint cgroups */
+#define CGROUP_RSTAT_WATCH_AGE		(HZ / 2)
+
 static void cgroup_base_stat_flush(struct cgroup *cgrp, int cpu);
 
 static struct cgroup_rstat_cpu *cgroup_rstat_cpu(struct cgroup *cgrp, int cpu)
@@ -145,6 +148,47 @@ static struct cgroup *cgroup_rstat_cpu_pop_updated(struct cgroup *pos,
 	return pos;
 }
 
+/**
+ * cgroup_rstat_updated_list - build a list of updated cgroups to be flushed
+ * @root: root of the subtree to flush
+ * @cpu: target cpu
+ *
+ * Dismantles @cpu's updated tree under the matching cgroup_rstat_cpu_lock
+ * and returns the cgroups linked through ->rstat_flush_next, children
+ * before parents, terminated by %NULL.  The actual flushing then happens
+ * without the per-cpu lock, so stat updaters on @cpu only ever wait for
+ * the unlinking, never behind the flush of a whole subtree.
+ */
+static struct cgroup *cgroup_rstat_updated_list(struct cgroup *root, int cpu)
+{
+	raw_spinlock_t *cpu_lock = per_cpu_ptr(&cgroup_rstat_cpu_lock, cpu);
+	struct cgroup *head = NULL, *tail = NULL;
+	struct cgroup *pos = NULL;
+	unsigned long flags;
+
+	/*
+	 * The _irqsave() is needed because cgroup_rstat_lock is
+	 * spinlock_t which is a sleeping lock on PREEMPT_RT. Acquiring
+	 * this lock with the _irq() suffix only disables interrupts on
+	 * a non-PREEMPT_RT kernel. The raw_spinlock_t below disables
+	 * interrupts on both configurations. The _irqsave() ensures
+	 * that interrupts are always disabled and later restored.
+	 */
+	raw_spin_lock_irqsave(cpu_lock, flags);
+	while ((pos = cgroup_rstat_cpu_pop_updated(pos, root, cpu))) {
+		if (tail)
+			tail->rstat_flush_next = pos;
+		else
+			head = pos;
+		tail = pos;
+	}
+	if (tail)
+		tail->rstat_flush_next = NULL;
+	raw_spin_unlock_irqrestore(cpu_lock, flags);
+
+	return head;
+}
+
 /*
  * A hook for bpf stat collectors to attach to and flush their stats.
  * Together with providing bpf kfuncs for cgroup_rstat_updated() and
@@ -179,21 +223,9 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 	lockdep_assert_held(&cgroup_rstat_lock);
 
 	for_each_possible_cpu(cpu) {
-		raw_spinlock_t *cpu_lock = per_cpu_ptr(&cgroup_rstat_cpu_lock,
-						       cpu);
-		struct cgroup *pos = NULL;
-		unsigned long flags;
+		struct cgroup *pos = cgroup_rstat_updated_list(cgrp, cpu);
 
-		/*
-		 * The _irqsave() is needed because cgroup_rstat_lock is
-		 * spinlock_t which is a sleeping lock on PREEMPT_RT. Acquiring
-		 * this lock with the _irq() suffix only disables interrupts on
-		 * a non-PREEMPT_RT kernel. The raw_spinlock_t below disables
-		 * interrupts on both configurations. The _irqsave() ensures
-		 * that interrupts are always disabled and later restored.
-		 */
-		raw_spin_lock_irqsave(cpu_lock, flags);
-		while ((pos = cgroup_rstat_cpu_pop_updated(pos, cgrp, cpu))) {
+		for (; pos; pos = pos->rstat_flush_next) {
 			struct cgroup_subsys_state *css;
 
 			cgroup_base_stat_flush(pos, cpu);
@@ -205,7 +237,6 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 				css->ss->css_rstat_flush(css, cpu);
 			rcu_read_unlock();
 		}
-		raw_spin_unlock_irqrestore(cpu_lock, flags);
 
 		/* if @may_sleep, play nice and yield if necessary */
 		if (may_sleep && (need_resched() ||
@@ -216,6 +247,8 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp, bool may_sleep)
 			spin_lock_irq(&cgroup_rstat_lock);
 		}
 	}
+
+	WRITE_ONCE(cgrp->rstat_last_flush, jiffies);
 }
 
 /**
@@ -240,6 +273,27 @@ __bpf_kfunc void cgroup_rstat_flush(struct cgroup *cgrp)
 	spin_unlock_irq(&cgroup_rstat_lock);
 }
 
+/**
+ * cgroup_rstat_flush_ratelimited - flush stats in @cgrp's subtree unless fresh
+ * @cgrp: target cgroup
+ * @max_age: staleness budget in jiffies
+ *
+ * Skip the flush entirely if @cgrp's subtree finished a flush within the
+ * last @max_age jiffies.  Readers which tolerate slightly stale statistics
+ * avoid taking the global rstat lock on a recently flushed hierarchy; a
+ * zero @max_age degenerates to cgroup_rstat_flush().
+ *
+ * Returns %true if a flush was performed.
+ */
+bool cgroup_rstat_flush_ratelimited(struct cgroup *cgrp, unsigned long max_age)
+{
+	if (time_before(jiffies, READ_ONCE(cgrp->rstat_last_flush) + max_age))
+		return false;
+
+	cgroup_rstat_flush(cgrp);
+	return true;
+}
+
 /**
  * cgroup_rstat_flush_irqsafe - irqsafe version of cgroup_rstat_flush()
  * @cgrp: target cgroup
@@ -272,6 +326,23 @@ void cgroup_rstat_flush_hold(struct cgroup *cgrp)
 	cgroup_rstat_flush_locked(cgrp, true);
 }
 
+/*
+ * Like cgroup_rstat_flush_hold() but trusts the cached aggregates of a
+ * watchpoint cgroup.  The watch worker keeps those no older than one
+ * refresh period; reads within twice that skip the flush walk entirely.
+ */
+static void cgroup_rstat_fresh_hold(struct cgroup *cgrp)
+	__acquires(&cgroup_rstat_lock)
+{
+	might_sleep();
+	spin_lock_irq(&cgroup_rstat_lock);
+
+	if (!READ_ONCE(cgrp->rstat_watch) ||
+	    time_after_eq(jiffies, READ_ONCE(cgrp->rstat_last_flush) +
+			  2 * CGROUP_RSTAT_WATCH_AGE))
+		cgroup_rstat_flush_locked(cgrp, true);
+}
+
 /**
  * cgroup_rstat_flush_release - release cgroup_rstat_flush_hold()
  */
@@ -281,6 +352,41 @@ void cgroup_rstat_flush_release(void)
 	spin_unlock_irq(&cgroup_rstat_lock);
 }
 
+static void cgroup_rstat_watch_workfn(struct work_struct *work)
+{
+	struct cgroup *cgrp = container_of(to_delayed_work(work),
+					   struct cgroup, rstat_watch_work);
+
+	cgroup_rstat_flush(cgrp);
+
+	if (READ_ONCE(cgrp->rstat_watch))
+		schedule_delayed_work(&cgrp->rstat_watch_work,
+				      CGROUP_RSTAT_WATCH_AGE);
+}
+
+/**
+ * cgroup_rstat_watch_set - designate @cgrp an aggregate watchpoint
+ * @cgrp: target cgroup
+ * @watch: whether to watch @cgrp
+ *
+ * While watched, a background worker flushes @cgrp's subtree every
+ * CGROUP_RSTAT_WATCH_AGE so the cached aggregates stay fresh and readers
+ * can use them without walking the rstat tree.  Frequent stat reads at
+ * the watchpoint become independent of the number of descendants.
+ */
+void cgroup_rstat_watch_set(struct cgroup *cgrp, bool watch)
+{
+	if (cgrp->rstat_watch == watch)
+		return;
+
+	WRITE_ONCE(cgrp->rstat_watch, watch);
+	if (watch)
+		schedule_delayed_work(&cgrp->rstat_watch_work,
+				      CGROUP_RSTAT_WATCH_AGE);
+	else
+		cancel_delayed_work_sync(&cgrp->rstat_watch_work);
+}
+
 int cgroup_rstat_init(struct cgroup *cgrp)
 {
 	int cpu;
@@ -292,6 +398,10 @@ int cgroup_rstat_init(struct cgroup *cgrp)
 			return -ENOMEM;
 	}
 
+	/* a new cgroup has nothing to flush */
+	cgrp->rstat_last_flush = jiffies;
+	INIT_DELAYED_WORK(&cgrp->rstat_watch_work, cgroup_rstat_watch_workfn);
+
 	/* ->updated_children list is self terminated */
 	for_each_possible_cpu(cpu) {
 		struct cgroup_rstat_cpu *rstatc = cgroup_rstat_cpu(cgrp, cpu);
@@ -307,6 +417,7 @@ void cgroup_rstat_exit(struct cgroup *cgrp)
 {
 	int cpu;
 
+	cgroup_rstat_watch_set(cgrp, false);
 	cgroup_rstat_flush(cgrp);
 
 	/* sanity check */
@@ -497,7 +608,7 @@ void cgroup_base_stat_cputime_show(struct seq_file *seq)
 #endif
 
 	if (cgroup_parent(cgrp)) {
-		cgroup_rstat_flush_hold(cgrp);
+		cgroup_rstat_fresh_hold(cgrp);
 		usage = cgrp->bstat.cputime.sum_exec_runtime;
 		cputime_adjust(&cgrp->bstat.cputime, &cgrp->prev_cputime,
 			       &utime, &stime);
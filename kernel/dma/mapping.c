@@ -325,6 +325,43 @@ void dma_unmap_resource(struct device *dev, dma_addr_t addr, size_t size,
 }
 EXPORT_SYMBOL(dma_unmap_resource);
 
+/**
+ * dma_unmap_batch_begin - open an unmap batch for @dev
+ * @dev: device the mappings belong to
+ *
+ * Unmaps issued between dma_unmap_batch_begin() and dma_unmap_batch_end()
+ * may have their address-translation invalidations deferred and coalesced
+ * into a single flush at batch end.  Until then the unmapped addresses may
+ * still be accessible to the device, so this must only be used when the
+ * caller can tolerate that window (as with the deferred-invalidation IOMMU
+ * modes).  Implementations that cannot defer simply keep unmaps synchronous.
+ */
+void dma_unmap_batch_begin(struct device *dev)
+{
+	const struct dma_map_ops *ops = get_dma_ops(dev);
+
+	if (!dma_map_direct(dev, ops) && ops->unmap_batch_begin)
+		ops->unmap_batch_begin(dev);
+}
+EXPORT_SYMBOL(dma_unmap_batch_begin);
+
+/**
+ * dma_unmap_batch_end - close an unmap batch for @dev
+ * @dev: device the mappings belong to
+ *
+ * Performs the single deferred invalidation covering every unmap issued
+ * since the matching dma_unmap_batch_begin() and releases their address
+ * ranges for reuse.
+ */
+void dma_unmap_batch_end(struct device *dev)
+{
+	const struct dma_map_ops *ops = get_dma_ops(dev);
+
+	if (!dma_map_direct(dev, ops) && ops->unmap_batch_end)
+		ops->unmap_batch_end(dev);
+}
+EXPORT_SYMBOL(dma_unmap_batch_end);
+
 void dma_sync_single_for_cpu(struct device *dev, dma_addr_t addr, size_t size,
 		enum dma_data_direction dir)
 {
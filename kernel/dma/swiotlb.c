@@ -37,6 +37,7 @@
 #include <linux/pfn.h>
 #include <linux/scatterlist.h>
 #include <linux/set_memory.h>
+#include <linux/slab.h>
 #include <linux/spinlock.h>
 #include <linux/string.h>
 #include <linux/swiotlb.h>
@@ -45,7 +46,6 @@
 #include <linux/of.h>
 #include <linux/of_fdt.h>
 #include <linux/of_reserved_mem.h>
-#include <linux/slab.h>
 #endif
 
 #define CREATE_TRACE_POINTS
@@ -513,13 +513,27 @@ static unsigned int swiotlb_align_offset(struct device *dev, u64 addr)
 	return addr & dma_get_min_align_mask(dev) & (IO_TLB_SIZE - 1);
 }
 
+/*
+ * Return the pool which @tlb_addr was allocated from, either the pool the
+ * device normally maps from or its private overflow pool.
+ */
+static struct io_tlb_mem *swiotlb_find_mem(struct device *dev,
+					   phys_addr_t tlb_addr)
+{
+	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+
+	if (tlb_addr >= mem->start && tlb_addr < mem->end)
+		return mem;
+	return READ_ONCE(dev->dma_io_tlb_ovfl);
+}
+
 /*
  * Bounce: copy the swiotlb buffer from or back to the original dma location
  */
 static void swiotlb_bounce(struct device *dev, phys_addr_t tlb_addr, size_t size,
 			   enum dma_data_direction dir)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+	struct io_tlb_mem *mem = swiotlb_find_mem(dev, tlb_addr);
 	int index = (tlb_addr - mem->start) >> IO_TLB_SHIFT;
 	phys_addr_t orig_addr = mem->slots[index].orig_addr;
 	size_t alloc_size = mem->slots[index].alloc_size;
@@ -612,11 +626,10 @@ static unsigned int wrap_area_index(struct io_tlb_mem *mem, unsigned int index)
  * Find a suitable number of IO TLB entries size that will fit this request and
  * allocate a buffer from that IO TLB pool.
  */
-static int swiotlb_do_find_slots(struct device *dev, int area_index,
-		phys_addr_t orig_addr, size_t alloc_size,
+static int swiotlb_do_find_slots(struct device *dev, struct io_tlb_mem *mem,
+		int area_index, phys_addr_t orig_addr, size_t alloc_size,
 		unsigned int alloc_align_mask)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
 	struct io_tlb_area *area = mem->areas + area_index;
 	unsigned long boundary_mask = dma_get_seg_boundary(dev);
 	dma_addr_t tbl_dma_addr =
@@ -705,16 +718,16 @@ found:
 	return slot_index;
 }
 
-static int swiotlb_find_slots(struct device *dev, phys_addr_t orig_addr,
-		size_t alloc_size, unsigned int alloc_align_mask)
+static int swiotlb_find_slots(struct device *dev, struct io_tlb_mem *mem,
+		phys_addr_t orig_addr, size_t alloc_size,
+		unsigned int alloc_align_mask)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
 	int start = raw_smp_processor_id() & (mem->nareas - 1);
 	int i = start, index;
 
 	do {
-		index = swiotlb_do_find_slots(dev, i, orig_addr, alloc_size,
-					      alloc_align_mask);
+		index = swiotlb_do_find_slots(dev, mem, i, orig_addr,
+					      alloc_size, alloc_align_mask);
 		if (index >= 0)
 			return index;
 		if (++i >= mem->nareas)
@@ -734,6 +747,119 @@ static unsigned long mem_used(struct io_tlb_mem *mem)
 	return used;
 }
 
+/* Size of a dynamically allocated per-device overflow pool */
+#define IO_TLB_OVFL_SIZE	min(4UL << 20, PAGE_SIZE << (MAX_ORDER - 1))
+
+static void swiotlb_free_ovfl(struct io_tlb_mem *mem)
+{
+	free_pages((unsigned long)phys_to_virt(mem->start),
+		   get_order(mem->nslabs << IO_TLB_SHIFT));
+	kfree(mem->areas);
+	kfree(mem->slots);
+	kfree(mem);
+}
+
+/*
+ * Return the device's overflow pool, allocating it NUMA-local to the device
+ * on first starvation of the shared pool.  Runs in atomic context, so all
+ * allocations are opportunistic; returns %NULL if memory is tight, in which
+ * case the mapping fails the same way it always has.
+ */
+static struct io_tlb_mem *swiotlb_get_ovfl(struct device *dev)
+{
+	unsigned long nslabs = IO_TLB_OVFL_SIZE >> IO_TLB_SHIFT;
+	size_t bytes = nslabs << IO_TLB_SHIFT;
+	int node = dev_to_node(dev);
+	unsigned int nareas;
+	struct io_tlb_mem *mem;
+	struct page *page;
+
+	mem = READ_ONCE(dev->dma_io_tlb_ovfl);
+	if (mem)
+		return mem;
+
+	/* Only the shared pool is backed by overflow pools */
+	if (dev->dma_io_tlb_mem != &io_tlb_default_mem)
+		return NULL;
+
+	/*
+	 * Late pool creation cannot change the memory encryption attributes
+	 * of the buffer from atomic context; leave encrypted setups to the
+	 * statically sized pool.
+	 */
+	if (cc_platform_has(CC_ATTR_MEM_ENCRYPT) || swiotlb_unencrypted_base)
+		return NULL;
+
+	mem = kzalloc(sizeof(*mem), GFP_NOWAIT | __GFP_NOWARN);
+	if (!mem)
+		return NULL;
+
+	mem->slots = kcalloc_node(nslabs, sizeof(*mem->slots),
+				  GFP_NOWAIT | __GFP_NOWARN, node);
+	if (!mem->slots)
+		goto free_mem;
+
+	nareas = rounddown_pow_of_two(min_t(unsigned long,
+			roundup_pow_of_two(num_possible_cpus()),
+			nslabs / IO_TLB_SEGSIZE));
+	mem->areas = kcalloc_node(nareas, sizeof(*mem->areas),
+				  GFP_NOWAIT | __GFP_NOWARN, node);
+	if (!mem->areas)
+		goto free_slots;
+
+	page = alloc_pages_node(node, GFP_NOWAIT | __GFP_NOWARN,
+				get_order(bytes));
+	if (!page)
+		goto free_areas;
+
+	/* the pool is useless if the device cannot address it */
+	if (!dma_capable(dev, phys_to_dma_unencrypted(dev, page_to_phys(page)),
+			 bytes, true)) {
+		__free_pages(page, get_order(bytes));
+		goto free_areas;
+	}
+
+	swiotlb_init_io_tlb_mem(mem, page_to_phys(page), nslabs, 0, true,
+				nareas);
+
+	/* publish; whoever loses the race frees their copy */
+	if (cmpxchg(&dev->dma_io_tlb_ovfl, NULL, mem)) {
+		swiotlb_free_ovfl(mem);
+		return dev->dma_io_tlb_ovfl;
+	}
+
+	dev_info(dev, "allocated %zu KiB swiotlb overflow pool on node %d\n",
+		 bytes >> 10, node);
+	return mem;
+
+free_areas:
+	kfree(mem->areas);
+free_slots:
+	kfree(mem->slots);
+free_mem:
+	kfree(mem);
+	return NULL;
+}
+
+/**
+ * swiotlb_dev_exit - tear down @dev's swiotlb state
+ * @dev: device being released
+ *
+ * Frees the overflow pool, if one was ever created.  All bounce buffers
+ * must have been unmapped by now.
+ */
+void swiotlb_dev_exit(struct device *dev)
+{
+	struct io_tlb_mem *mem = dev->dma_io_tlb_ovfl;
+
+	if (!mem)
+		return;
+
+	dev->dma_io_tlb_ovfl = NULL;
+	WARN_ON_ONCE(mem_used(mem));
+	swiotlb_free_ovfl(mem);
+}
+
 phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 		size_t mapping_size, size_t alloc_size,
 		unsigned int alloc_align_mask, enum dma_data_direction dir,
@@ -760,8 +886,18 @@ phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 		return (phys_addr_t)DMA_MAPPING_ERROR;
 	}
 
-	index = swiotlb_find_slots(dev, orig_addr,
+	index = swiotlb_find_slots(dev, mem, orig_addr,
 				   alloc_size + offset, alloc_align_mask);
+	if (index == -1) {
+		struct io_tlb_mem *ovfl = swiotlb_get_ovfl(dev);
+
+		if (ovfl) {
+			index = swiotlb_find_slots(dev, ovfl, orig_addr,
+					alloc_size + offset, alloc_align_mask);
+			if (index != -1)
+				mem = ovfl;
+		}
+	}
 	if (index == -1) {
 		if (!(attrs & DMA_ATTR_NO_WARN))
 			dev_warn_ratelimited(dev,
@@ -791,7 +927,7 @@ phys_addr_t swiotlb_tbl_map_single(struct device *dev, phys_addr_t orig_addr,
 
 static void swiotlb_release_slots(struct device *dev, phys_addr_t tlb_addr)
 {
-	struct io_tlb_mem *mem = dev->dma_io_tlb_mem;
+	struct io_tlb_mem *mem = swiotlb_find_mem(dev, tlb_addr);
 	unsigned long flags;
 	unsigned int offset = swiotlb_align_offset(dev, tlb_addr);
 	int index = (tlb_addr - offset - mem->start) >> IO_TLB_SHIFT;
@@ -968,7 +1104,7 @@ struct page *swiotlb_alloc(struct device *dev, size_t size)
 	if (!mem)
 		return NULL;
 
-	index = swiotlb_find_slots(dev, 0, size, 0);
+	index = swiotlb_find_slots(dev, mem, 0, size, 0);
 	if (index == -1)
 		return NULL;
 
@@ -19,8 +19,24 @@ struct callchain_cpus_entries {
 	struct perf_callchain_entry	*cpu_entries[];
 };
 
+/*
+ * One recently unwound user callchain is kept per CPU. Consecutive samples
+ * that interrupt the same task at the same user IP/SP - common when a hot
+ * loop or blocking call dominates - replay the previous walk instead of
+ * paging through the whole user stack again.
+ */
+struct callchain_user_cache {
+	struct task_struct		*task;	/* match key only, never dereferenced */
+	u64				ip;
+	u64				sp;
+	int				busy;	/* excludes nested users on this CPU */
+	unsigned int			nr;
+	u64				ips[];
+};
+
 int sysctl_perf_event_max_stack __read_mostly = PERF_MAX_STACK_DEPTH;
 int sysctl_perf_event_max_contexts_per_stack __read_mostly = PERF_MAX_CONTEXTS_PER_STACK;
+int sysctl_perf_event_callchain_cache __read_mostly;
 
 static inline size_t perf_callchain_entry__sizeof(void)
 {
@@ -29,6 +45,12 @@ static inline size_t perf_callchain_entry__sizeof(void)
 				 sysctl_perf_event_max_contexts_per_stack));
 }
 
+static inline size_t callchain_user_cache__sizeof(void)
+{
+	return sizeof(struct callchain_user_cache) +
+	       sizeof(u64) * sysctl_perf_event_max_stack;
+}
+
 static DEFINE_PER_CPU(int, callchain_recursion[PERF_NR_CONTEXTS]);
 static atomic_t nr_callchain_events;
 static DEFINE_MUTEX(callchain_mutex);
@@ -84,13 +106,25 @@ static int alloc_callchain_buffers(void)
 	if (!entries)
 		return -ENOMEM;
 
-	size = perf_callchain_entry__sizeof() * PERF_NR_CONTEXTS;
+	/*
+	 * The user callchain cache lives behind the per-context entries of
+	 * each CPU's buffer.
+	 */
+	size = perf_callchain_entry__sizeof() * PERF_NR_CONTEXTS +
+	       callchain_user_cache__sizeof();
 
 	for_each_possible_cpu(cpu) {
+		struct callchain_user_cache *cache;
+
 		entries->cpu_entries[cpu] = kmalloc_node(size, GFP_KERNEL,
 							 cpu_to_node(cpu));
 		if (!entries->cpu_entries[cpu])
 			goto fail;
+
+		cache = (void *)entries->cpu_entries[cpu] +
+			perf_callchain_entry__sizeof() * PERF_NR_CONTEXTS;
+		cache->task = NULL;
+		cache->busy = 0;
 	}
 
 	rcu_assign_pointer(callchain_cpus_entries, entries);
@@ -176,6 +210,88 @@ put_callchain_entry(int rctx)
 	put_recursion_context(this_cpu_ptr(callchain_recursion), rctx);
 }
 
+static struct callchain_user_cache *get_callchain_user_cache(void)
+{
+	struct callchain_cpus_entries *entries;
+
+	entries = rcu_dereference(callchain_cpus_entries);
+	if (!entries)
+		return NULL;
+
+	return ((void *)entries->cpu_entries[smp_processor_id()]) +
+	       perf_callchain_entry__sizeof() * PERF_NR_CONTEXTS;
+}
+
+/*
+ * Replay the cached user callchain if @regs matches the previous user unwind
+ * on this CPU, otherwise walk the stack and cache the result. Matching on
+ * task/IP/SP is a heuristic: a stack can in principle be rewritten between
+ * two samples interrupting the same spot, in which case a stale chain is
+ * emitted. Sampling profiles tolerate that; a task that hasn't moved mostly
+ * hasn't changed its stack either.
+ *
+ * Returns true if @ctx holds the user callchain, false if the caller should
+ * unwind itself.
+ */
+static bool perf_callchain_user_cached(struct perf_callchain_entry_ctx *ctx,
+				       struct pt_regs *regs)
+{
+	u64 ip = instruction_pointer(regs);
+	u64 sp = user_stack_pointer(regs);
+	struct callchain_user_cache *cache;
+	unsigned int start, nr;
+	bool hit;
+
+	if (!READ_ONCE(sysctl_perf_event_callchain_cache))
+		return false;
+
+	cache = get_callchain_user_cache();
+	if (!cache || READ_ONCE(cache->busy))
+		return false;
+
+	/*
+	 * Interrupts and NMIs nest on this CPU; whoever finds the cache busy
+	 * above simply unwinds without it.
+	 */
+	WRITE_ONCE(cache->busy, 1);
+	barrier();
+
+	hit = cache->task == current && cache->ip == ip && cache->sp == sp;
+	if (hit) {
+		nr = cache->nr;
+		if (!ctx->contexts_maxed && ctx->nr < ctx->max_stack) {
+			nr = min_t(unsigned int, nr, ctx->max_stack - ctx->nr);
+			memcpy(&ctx->entry->ip[ctx->entry->nr], cache->ips,
+			       nr * sizeof(u64));
+			ctx->entry->nr += nr;
+			ctx->nr += nr;
+		}
+		goto out;
+	}
+
+	start = ctx->entry->nr;
+	perf_callchain_user(ctx, regs);
+
+	/*
+	 * Cache only complete walks; a chain truncated by this event's depth
+	 * limit must not serve a later sample with a deeper one.
+	 */
+	if (ctx->nr < ctx->max_stack) {
+		cache->task = current;
+		cache->ip = ip;
+		cache->sp = sp;
+		cache->nr = ctx->entry->nr - start;
+		memcpy(cache->ips, &ctx->entry->ip[start],
+		       cache->nr * sizeof(u64));
+	}
+
+out:
+	barrier();
+	WRITE_ONCE(cache->busy, 0);
+
+	return true;
+}
+
 struct perf_callchain_entry *
 get_perf_callchain(struct pt_regs *regs, u32 init_nr, bool kernel, bool user,
 		   u32 max_stack, bool crosstask, bool add_mark)
@@ -215,7 +331,8 @@ get_perf_callchain(struct pt_regs *regs, u32 init_nr, bool kernel, bool user,
 			if (add_mark)
 				perf_callchain_store_context(&ctx, PERF_CONTEXT_USER);
 
-			perf_callchain_user(&ctx, regs);
+			if (!perf_callchain_user_cached(&ctx, regs))
+				perf_callchain_user(&ctx, regs);
 		}
 	}
 
@@ -420,6 +420,13 @@ int sysctl_perf_event_paranoid __read_mostly = 2;
 /* Minimum for 512 kiB + 1 user control page */
 int sysctl_perf_event_mlock __read_mostly = 512 + (PAGE_SIZE / 1024); /* 'free' kiB per user */
 
+/*
+ * Multiplexing rotation policy:
+ *   0 - rotate one flexible group per rotation interval
+ *   1 - rotate the whole active flexible set per rotation interval
+ */
+int sysctl_perf_event_rotate_all __read_mostly;
+
 /*
  * max perf event sample rate
  */
@@ -4178,6 +4185,39 @@ static void rotate_ctx(struct perf_event_context *ctx, struct perf_event *event)
 	perf_event_groups_insert(&ctx->flexible_groups, event);
 }
 
+/*
+ * Move every active flexible group of @pmu_ctx to the tail of the @ctx's
+ * eligible events, so the next reschedule brings in a disjoint set. With N
+ * flexible groups competing for k counters this cycles through all of them
+ * in N/k rotations instead of N, at the cost of reprogramming every counter
+ * on each rotation.
+ *
+ * Must run before the flexible groups are scheduled out, which empties the
+ * active list. Returns false if nothing was moved, in which case the caller
+ * falls back to single group rotation.
+ */
+static bool rotate_ctx_all(struct perf_event_pmu_context *pmu_ctx)
+{
+	struct perf_event_context *ctx = pmu_ctx->ctx;
+	struct perf_event *event;
+	bool rotated = false;
+
+	if (ctx->rotate_disable)
+		return false;
+
+	list_for_each_entry(event, &pmu_ctx->flexible_active, active_list) {
+		/* Siblings move with their group leader. */
+		if (event->group_leader != event)
+			continue;
+
+		perf_event_groups_delete(&ctx->flexible_groups, event);
+		perf_event_groups_insert(&ctx->flexible_groups, event);
+		rotated = true;
+	}
+
+	return rotated;
+}
+
 /* pick an event from the flexible_groups to rotate */
 static inline struct perf_event *
 ctx_event_to_rotate(struct perf_event_pmu_context *pmu_ctx)
@@ -4234,6 +4274,7 @@ static bool perf_rotate_context(struct perf_cpu_pmu_context *cpc)
 	struct perf_cpu_context *cpuctx = this_cpu_ptr(&perf_cpu_context);
 	struct perf_event_pmu_context *cpu_epc, *task_epc = NULL;
 	struct perf_event *cpu_event = NULL, *task_event = NULL;
+	bool cpu_batched = false, task_batched = false;
 	int cpu_rotate, task_rotate;
 	struct pmu *pmu;
 
@@ -4260,6 +4301,13 @@ static bool perf_rotate_context(struct perf_cpu_pmu_context *cpc)
 	if (cpu_rotate)
 		cpu_event = ctx_event_to_rotate(cpu_epc);
 
+	if (READ_ONCE(sysctl_perf_event_rotate_all)) {
+		if (task_event)
+			task_batched = rotate_ctx_all(task_epc);
+		if (cpu_event)
+			cpu_batched = rotate_ctx_all(cpu_epc);
+	}
+
 	/*
 	 * As per the order given at ctx_resched() first 'pop' task flexible
 	 * and then, if needed CPU flexible.
@@ -4272,11 +4320,12 @@ static bool perf_rotate_context(struct perf_cpu_pmu_context *cpc)
 	if (cpu_event) {
 		update_context_time(&cpuctx->ctx);
 		__pmu_ctx_sched_out(cpu_epc, EVENT_FLEXIBLE);
-		rotate_ctx(&cpuctx->ctx, cpu_event);
+		if (!cpu_batched)
+			rotate_ctx(&cpuctx->ctx, cpu_event);
 		__pmu_ctx_sched_in(&cpuctx->ctx, pmu);
 	}
 
-	if (task_event)
+	if (task_event && !task_batched)
 		rotate_ctx(task_epc->ctx, task_event);
 
 	if (task_event || (task_epc && cpu_event))
@@ -191,15 +191,28 @@ __perf_output_begin(struct perf_output_handle *handle,
 
 	perf_output_get_handle(handle);
 
-	do {
+	if (rb->overwrite) {
+		/*
+		 * In overwrite mode there is no space check against
+		 * ->data_tail, so the reservation cannot fail and a plain
+		 * atomic advance suffices. Unlike the cmpxchg loop below this
+		 * never retries, which matters when NMI, IRQ and task context
+		 * writers nest on one CPU under heavy sampling.
+		 */
+		if (!backward) {
+			head = local_add_return(size, &rb->head);
+			offset = head - size;
+		} else {
+			head = local_sub_return(size, &rb->head);
+			offset = head + size;
+		}
+	} else do {
 		tail = READ_ONCE(rb->user_page->data_tail);
 		offset = head = local_read(&rb->head);
-		if (!rb->overwrite) {
-			if (unlikely(!ring_buffer_has_space(head, tail,
-							    perf_data_size(rb),
-							    size, backward)))
-				goto fail;
-		}
+		if (unlikely(!ring_buffer_has_space(head, tail,
+						    perf_data_size(rb),
+						    size, backward)))
+			goto fail;
 
 		/*
 		 * The above forms a control dependency barrier separating the
@@ -225,8 +238,9 @@ __perf_output_begin(struct perf_output_handle *handle,
 	}
 
 	/*
-	 * We rely on the implied barrier() by local_cmpxchg() to ensure
-	 * none of the data stores below can be lifted up by the compiler.
+	 * We rely on the implied barrier() by local_cmpxchg() and
+	 * local_add_return() to ensure none of the data stores below can be
+	 * lifted up by the compiler.
 	 */
 
 	if (unlikely(head - local_read(&rb->wakeup) > rb->watermark))
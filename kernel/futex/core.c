@@ -37,6 +37,7 @@
 #include <linux/memblock.h>
 #include <linux/fault-inject.h>
 #include <linux/slab.h>
+#include <linux/wait_bit.h>
 
 #include "futex.h"
 #include "../locking/rtmutex_common.h"
@@ -105,21 +106,340 @@ late_initcall(fail_futex_debugfs);
 
 #endif /* CONFIG_FAIL_FUTEX */
 
+static void futex_hash_bucket_init(struct futex_hash_bucket *hb,
+				   struct futex_private_hash *fph)
+{
+	atomic_set(&hb->waiters, 0);
+	plist_head_init(&hb->chain);
+	spin_lock_init(&hb->lock);
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	hb->priv = fph;
+#endif
+}
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+
+/*
+ * Optional per-mm futex hash, replacing the global hash for the
+ * PROCESS_PRIVATE futexes of processes which opted in via
+ * prctl(PR_FUTEX_HASH). Buckets of such a hash are only ever shared by
+ * futexes of one process, so unrelated processes no longer collide on
+ * the same bucket locks.
+ *
+ * Lifetime is managed with a reference count. futex_hash() takes a
+ * reference which pins the backing storage of the returned bucket and
+ * the operation drops it with futex_hash_put() once it stopped looking
+ * at the bucket. One additional reference is held by the mm itself.
+ *
+ * A replacement (resize) retires the current hash: it fails new
+ * futex_hash() lookups, drops the mm reference and waits for the
+ * remaining users to drain. Once drained it moves all queued waiters
+ * over to the buckets of the replacement hash and only then publishes
+ * it. A waker therefore either still operates on the old hash - and
+ * finds the waiters there - or operates on the new hash after the
+ * rehash moved them; waiters are never lost. Waiters themselves do not
+ * hold a reference while blocked: futex_unqueue() copes with
+ * q->lock_ptr changing underneath them, exactly as it already does for
+ * requeueing.
+ */
+struct futex_private_hash {
+	atomic_t		users;
+	unsigned int		hash_mask;
+	struct rcu_head		rcu;
+	bool			custom;
+	bool			retired;
+	atomic_t		queued;
+	struct futex_hash_bucket queues[];
+};
+
+/* Initial size of an auto-sized private hash, must be a power of two. */
+#define FUTEX_PRIVATE_HASH_MIN	16
+
+static inline bool futex_key_is_private(union futex_key *key)
+{
+	/*
+	 * Relies on get_futex_key() to set either bit for shared
+	 * futexes -- see comment with union futex_key.
+	 */
+	return !(key->both.offset & (FUT_OFF_INODE | FUT_OFF_MMSHARED));
+}
+
+static bool futex_private_hash_get(struct futex_private_hash *fph)
+{
+	if (READ_ONCE(fph->retired))
+		return false;
+	return atomic_inc_not_zero(&fph->users);
+}
+
+void futex_private_hash_put(struct futex_private_hash *fph)
+{
+	if (atomic_dec_and_test(&fph->users))
+		wake_up_var(&fph->users);
+}
+
+static inline void futex_hb_queued_inc(struct futex_hash_bucket *hb)
+{
+	if (hb->priv)
+		atomic_inc(&hb->priv->queued);
+}
+
+static inline void futex_hb_queued_dec(struct futex_hash_bucket *hb)
+{
+	if (hb->priv)
+		atomic_dec(&hb->priv->queued);
+}
+
+#else /* CONFIG_FUTEX_PRIVATE_HASH */
+
+static inline void futex_hb_queued_inc(struct futex_hash_bucket *hb) { }
+static inline void futex_hb_queued_dec(struct futex_hash_bucket *hb) { }
+
+#endif /* CONFIG_FUTEX_PRIVATE_HASH */
+
 /**
- * futex_hash - Return the hash bucket in the global hash
+ * __futex_hash - Return the hash bucket for a futex key
  * @key:	Pointer to the futex key for which the hash is calculated
+ * @fph:	Private hash to use for private keys, or NULL for the
+ *		global hash. The caller must hold a reference on it.
  *
- * We hash on the keys returned from get_futex_key (see below) and return the
- * corresponding hash bucket in the global hash.
+ * We hash on the keys returned from get_futex_key (see below) and return
+ * the corresponding hash bucket. Shared keys always hash into the global
+ * hash, regardless of @fph.
  */
-struct futex_hash_bucket *futex_hash(union futex_key *key)
+struct futex_hash_bucket *__futex_hash(union futex_key *key,
+				       struct futex_private_hash *fph)
 {
 	u32 hash = jhash2((u32 *)key, offsetof(typeof(*key), both.offset) / 4,
 			  key->both.offset);
 
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	if (fph && futex_key_is_private(key))
+		return &fph->queues[hash & fph->hash_mask];
+#endif
 	return &futex_queues[hash & (futex_hashsize - 1)];
 }
 
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+/**
+ * futex_private_hash - Acquire a reference on the current private hash
+ *
+ * Returns the private hash of current's mm with a reference held, or
+ * NULL if the process did not opt in. Drop the reference with
+ * futex_private_hash_put() once no bucket of the hash is accessed
+ * anymore.
+ */
+struct futex_private_hash *futex_private_hash(void)
+{
+	struct mm_struct *mm = current->mm;
+	struct futex_private_hash *fph;
+
+	for (;;) {
+		rcu_read_lock();
+		fph = rcu_dereference(mm->futex_phash);
+		if (!fph || futex_private_hash_get(fph)) {
+			rcu_read_unlock();
+			return fph;
+		}
+		rcu_read_unlock();
+		/*
+		 * The hash is retired and a replacement is about to be
+		 * installed. futex_hash_lock is held across the rehash,
+		 * so once it can be acquired the new hash is published.
+		 */
+		mutex_lock(&mm->futex_hash_lock);
+		mutex_unlock(&mm->futex_hash_lock);
+	}
+}
+#endif
+
+/**
+ * futex_hash - Return the hash bucket for a futex key
+ * @key:	Pointer to the futex key for which the hash is calculated
+ *
+ * Like __futex_hash(), but resolves the private hash of current's mm
+ * itself. For a private key of a process which opted in, a reference is
+ * taken on the private hash which pins the returned bucket; drop it with
+ * futex_hash_put() once the bucket is no longer accessed.
+ */
+struct futex_hash_bucket *futex_hash(union futex_key *key)
+{
+	struct futex_private_hash *fph = NULL;
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	if (futex_key_is_private(key))
+		fph = futex_private_hash();
+#endif
+	return __futex_hash(key, fph);
+}
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+
+/*
+ * Move all queued waiters of a drained private hash over to the buckets
+ * of its replacement. Concurrent futex_unqueue() (timeout, signal) is
+ * serialized by the bucket locks and detects the changed q->lock_ptr.
+ */
+static void futex_rehash_private(struct futex_private_hash *old,
+				 struct futex_private_hash *new)
+{
+	struct futex_hash_bucket *hb_old, *hb_new;
+	struct futex_q *this, *tmp;
+	unsigned int i;
+
+	for (i = 0; i <= old->hash_mask; i++) {
+		hb_old = &old->queues[i];
+
+		spin_lock(&hb_old->lock);
+		plist_for_each_entry_safe(this, tmp, &hb_old->chain, list) {
+			hb_new = __futex_hash(&this->key, new);
+
+			spin_lock_nested(&hb_new->lock, SINGLE_DEPTH_NESTING);
+			plist_del(&this->list, &hb_old->chain);
+			futex_hb_waiters_dec(hb_old);
+			futex_hb_queued_dec(hb_old);
+			futex_hb_waiters_inc(hb_new);
+			futex_hb_queued_inc(hb_new);
+			plist_add(&this->list, &hb_new->chain);
+			this->lock_ptr = &hb_new->lock;
+			spin_unlock(&hb_new->lock);
+		}
+		spin_unlock(&hb_old->lock);
+	}
+}
+
+static int futex_hash_allocate(struct mm_struct *mm, unsigned int slots,
+			       bool custom)
+{
+	struct futex_private_hash *fph, *old;
+	unsigned int i;
+
+	slots = clamp_t(unsigned int, slots, 2, futex_hashsize);
+
+	fph = kvzalloc(struct_size(fph, queues, slots), GFP_KERNEL_ACCOUNT);
+	if (!fph)
+		return -ENOMEM;
+
+	atomic_set(&fph->users, 1);
+	fph->hash_mask = slots - 1;
+	fph->custom = custom;
+	for (i = 0; i < slots; i++)
+		futex_hash_bucket_init(&fph->queues[i], fph);
+
+	mutex_lock(&mm->futex_hash_lock);
+	old = rcu_dereference_protected(mm->futex_phash,
+					lockdep_is_held(&mm->futex_hash_lock));
+	if (old) {
+		/*
+		 * Auto-resizing only ever grows the hash and does not
+		 * replace a user-sized hash behind the user's back.
+		 */
+		if (!custom && (old->custom || slots <= old->hash_mask + 1)) {
+			mutex_unlock(&mm->futex_hash_lock);
+			kvfree(fph);
+			return 0;
+		}
+
+		WRITE_ONCE(old->retired, true);
+		/* Drop the mm reference and wait for the users to drain. */
+		futex_private_hash_put(old);
+		wait_var_event(&old->users, !atomic_read(&old->users));
+
+		futex_rehash_private(old, fph);
+	}
+	rcu_assign_pointer(mm->futex_phash, fph);
+	mutex_unlock(&mm->futex_hash_lock);
+
+	if (old)
+		kvfree_rcu(old, rcu);
+	return 0;
+}
+
+/*
+ * Grow an auto-sized private hash once the number of queued waiters
+ * exceeds the number of buckets. Called from futex_q_lock() before any
+ * locks are taken, so allocating and rehashing may sleep.
+ */
+static void futex_hash_autogrow(union futex_key *key)
+{
+	struct futex_private_hash *fph;
+	unsigned int slots = 0;
+
+	if (!futex_key_is_private(key))
+		return;
+
+	rcu_read_lock();
+	fph = rcu_dereference(current->mm->futex_phash);
+	if (fph && !fph->custom && !READ_ONCE(fph->retired) &&
+	    atomic_read(&fph->queued) > fph->hash_mask)
+		slots = (fph->hash_mask + 1) * 2;
+	rcu_read_unlock();
+
+	if (slots)
+		futex_hash_allocate(current->mm, slots, false);
+}
+
+/*
+ * The backend of prctl(PR_FUTEX_HASH). PR_FUTEX_HASH_SET_SLOTS with 0
+ * slots installs an auto-sized private hash, a non-zero power of two
+ * fixes the hash to that many buckets.
+ */
+long futex_hash_ctl(enum futex_hash_ctl_cmd cmd, unsigned long slots)
+{
+	struct mm_struct *mm = current->mm;
+	struct futex_private_hash *fph;
+	long ret;
+
+	switch (cmd) {
+	case FUTEX_HASH_SET_SLOTS:
+		if (slots > futex_hashsize)
+			return -EINVAL;
+		if (slots && !is_power_of_2(slots))
+			return -EINVAL;
+		ret = futex_hash_allocate(mm, slots ? : FUTEX_PRIVATE_HASH_MIN,
+					  slots != 0);
+		break;
+	case FUTEX_HASH_GET_SLOTS:
+		ret = 0;
+		rcu_read_lock();
+		fph = rcu_dereference(mm->futex_phash);
+		if (fph)
+			ret = fph->hash_mask + 1;
+		rcu_read_unlock();
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+	return ret;
+}
+
+void futex_mm_init(struct mm_struct *mm)
+{
+	mutex_init(&mm->futex_hash_lock);
+	RCU_INIT_POINTER(mm->futex_phash, NULL);
+}
+
+void futex_hash_free(struct mm_struct *mm)
+{
+	struct futex_private_hash *fph;
+
+	/*
+	 * The last user of the mm is gone, so only the mm reference can
+	 * be left.
+	 */
+	fph = rcu_dereference_raw(mm->futex_phash);
+	if (fph) {
+		WARN_ON_ONCE(atomic_read(&fph->users) != 1);
+		kvfree(fph);
+	}
+}
+
+#else /* CONFIG_FUTEX_PRIVATE_HASH */
+
+static inline void futex_hash_autogrow(union futex_key *key) { }
+
+#endif /* CONFIG_FUTEX_PRIVATE_HASH */
+
 
 /**
  * futex_setup_timer - set up the sleeping hrtimer.
@@ -507,6 +827,7 @@ void __futex_unqueue(struct futex_q *q)
 	hb = container_of(q->lock_ptr, struct futex_hash_bucket, lock);
 	plist_del(&q->list, &hb->chain);
 	futex_hb_waiters_dec(hb);
+	futex_hb_queued_dec(hb);
 }
 
 /* The key must be already stored in q->key. */
@@ -515,6 +836,8 @@ struct futex_hash_bucket *futex_q_lock(struct futex_q *q)
 {
 	struct futex_hash_bucket *hb;
 
+	futex_hash_autogrow(&q->key);
+
 	hb = futex_hash(&q->key);
 
 	/*
@@ -538,6 +861,7 @@ void futex_q_unlock(struct futex_hash_bucket *hb)
 {
 	spin_unlock(&hb->lock);
 	futex_hb_waiters_dec(hb);
+	futex_hash_put(hb);
 }
 
 void __futex_queue(struct futex_q *q, struct futex_hash_bucket *hb)
@@ -556,6 +880,7 @@ void __futex_queue(struct futex_q *q, struct futex_hash_bucket *hb)
 
 	plist_node_init(&q->list, prio);
 	plist_add(&q->list, &hb->chain);
+	futex_hb_queued_inc(hb);
 	q->task = current;
 }
 
@@ -581,7 +906,12 @@ retry:
 	 * q->lock_ptr can change between this read and the following spin_lock.
 	 * Use READ_ONCE to forbid the compiler from reloading q->lock_ptr and
 	 * optimizing lock_ptr out of the logic below.
+	 *
+	 * The RCU read section keeps a retired private hash, into which
+	 * lock_ptr may still point, alive until the re-check below
+	 * succeeded; see futex_rehash_private().
 	 */
+	rcu_read_lock();
 	lock_ptr = READ_ONCE(q->lock_ptr);
 	if (lock_ptr != NULL) {
 		spin_lock(lock_ptr);
@@ -600,6 +930,7 @@ retry:
 		 */
 		if (unlikely(lock_ptr != q->lock_ptr)) {
 			spin_unlock(lock_ptr);
+			rcu_read_unlock();
 			goto retry;
 		}
 		__futex_unqueue(q);
@@ -609,10 +940,34 @@ retry:
 		spin_unlock(lock_ptr);
 		ret = 1;
 	}
+	rcu_read_unlock();
 
 	return ret;
 }
 
+/**
+ * futex_q_lockptr_lock() - Lock the bucket lock the futex_q is queued on
+ * @q:	The futex_q whose bucket lock to acquire
+ *
+ * Unlike a plain spin_lock(q->lock_ptr), this copes with q->lock_ptr
+ * changing underneath us when the futex_q is moved to another bucket by
+ * a private hash rehash, following the same scheme as futex_unqueue().
+ */
+void futex_q_lockptr_lock(struct futex_q *q)
+{
+	spinlock_t *lock_ptr;
+
+	rcu_read_lock();
+	for (;;) {
+		lock_ptr = READ_ONCE(q->lock_ptr);
+		spin_lock(lock_ptr);
+		if (likely(lock_ptr == q->lock_ptr))
+			break;
+		spin_unlock(lock_ptr);
+	}
+	rcu_read_unlock();
+}
+
 /*
  * PI futexes can not be requeued and must remove themselves from the
  * hash bucket. The hash bucket lock (i.e. lock_ptr) is held.
@@ -957,7 +1312,6 @@ static void exit_pi_state_list(struct task_struct *curr)
 		next = head->next;
 		pi_state = list_entry(next, struct futex_pi_state, list);
 		key = pi_state->key;
-		hb = futex_hash(&key);
 
 		/*
 		 * We can race against put_pi_state() removing itself from the
@@ -977,6 +1331,11 @@ static void exit_pi_state_list(struct task_struct *curr)
 		}
 		raw_spin_unlock_irq(&curr->pi_lock);
 
+		/*
+		 * The hash lookup can block on a retired private hash,
+		 * hence it must not be done with curr->pi_lock held.
+		 */
+		hb = futex_hash(&key);
 		spin_lock(&hb->lock);
 		raw_spin_lock_irq(&pi_state->pi_mutex.wait_lock);
 		raw_spin_lock(&curr->pi_lock);
@@ -988,6 +1347,7 @@ static void exit_pi_state_list(struct task_struct *curr)
 			/* retain curr->pi_lock for the loop invariant */
 			raw_spin_unlock(&pi_state->pi_mutex.wait_lock);
 			spin_unlock(&hb->lock);
+			futex_hash_put(hb);
 			put_pi_state(pi_state);
 			continue;
 		}
@@ -1000,6 +1360,7 @@ static void exit_pi_state_list(struct task_struct *curr)
 		raw_spin_unlock(&curr->pi_lock);
 		raw_spin_unlock_irq(&pi_state->pi_mutex.wait_lock);
 		spin_unlock(&hb->lock);
+		futex_hash_put(hb);
 
 		rt_mutex_futex_unlock(&pi_state->pi_mutex);
 		put_pi_state(pi_state);
@@ -1138,11 +1499,8 @@ static int __init futex_init(void)
 					       futex_hashsize, futex_hashsize);
 	futex_hashsize = 1UL << futex_shift;
 
-	for (i = 0; i < futex_hashsize; i++) {
-		atomic_set(&futex_queues[i].waiters, 0);
-		plist_head_init(&futex_queues[i].chain);
-		spin_lock_init(&futex_queues[i].lock);
-	}
+	for (i = 0; i < futex_hashsize; i++)
+		futex_hash_bucket_init(&futex_queues[i], NULL);
 
 	return 0;
 }
@@ -37,6 +37,8 @@ static inline bool should_fail_futex(bool fshared)
 }
 #endif
 
+struct futex_private_hash;
+
 /*
  * Hash buckets are shared by all the futex_keys that hash to the same
  * location.  Each key may have multiple futex_q structures, one for each task
@@ -46,6 +48,9 @@ struct futex_hash_bucket {
 	atomic_t waiters;
 	spinlock_t lock;
 	struct plist_head chain;
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	struct futex_private_hash *priv;
+#endif
 } ____cacheline_aligned_in_smp;
 
 /*
@@ -124,6 +129,30 @@ futex_setup_timer(ktime_t *time, struct hrtimer_sleeper *timeout,
 		  int flags, u64 range_ns);
 
 extern struct futex_hash_bucket *futex_hash(union futex_key *key);
+extern struct futex_hash_bucket *__futex_hash(union futex_key *key,
+					      struct futex_private_hash *fph);
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+extern struct futex_private_hash *futex_private_hash(void);
+extern void futex_private_hash_put(struct futex_private_hash *fph);
+
+/*
+ * Drop the reference on the private hash which futex_hash() took to keep
+ * the bucket's backing storage alive. A NOP for buckets of the global hash.
+ */
+static inline void futex_hash_put(struct futex_hash_bucket *hb)
+{
+	if (hb->priv)
+		futex_private_hash_put(hb->priv);
+}
+#else
+static inline struct futex_private_hash *futex_private_hash(void)
+{
+	return NULL;
+}
+static inline void futex_private_hash_put(struct futex_private_hash *fph) { }
+static inline void futex_hash_put(struct futex_hash_bucket *hb) { }
+#endif
 
 /**
  * futex_match - Check whether two futex keys are equal
@@ -154,6 +183,7 @@ extern struct futex_q *futex_top_waiter(struct futex_hash_bucket *hb, union fute
 extern void __futex_unqueue(struct futex_q *q);
 extern void __futex_queue(struct futex_q *q, struct futex_hash_bucket *hb);
 extern int futex_unqueue(struct futex_q *q);
+extern void futex_q_lockptr_lock(struct futex_q *q);
 
 /**
  * futex_queue() - Enqueue the futex_q on the futex_hash_bucket
@@ -282,6 +312,8 @@ struct futex_vector {
 extern int futex_wait_multiple(struct futex_vector *vs, unsigned int count,
 			       struct hrtimer_sleeper *to);
 
+extern int futex_wake_multiple(struct futex_vector *vs, unsigned int count);
+
 extern int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset);
 
 extern int futex_wake_op(u32 __user *uaddr1, unsigned int flags,
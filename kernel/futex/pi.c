@@ -994,6 +994,12 @@ retry_private:
 	 * Only actually queue now that the atomic ops are done:
 	 */
 	__futex_queue(&q, hb);
+	/*
+	 * From here on the futex_q is found through q.lock_ptr, which a
+	 * private hash rehash keeps up to date; the bucket needs no more
+	 * pinning.
+	 */
+	futex_hash_put(hb);
 
 	if (trylock) {
 		ret = rt_mutex_futex_trylock(&q.pi_state->pi_mutex);
@@ -1039,7 +1045,7 @@ retry_private:
 	ret = rt_mutex_wait_proxy_lock(&q.pi_state->pi_mutex, to, &rt_waiter);
 
 cleanup:
-	spin_lock(q.lock_ptr);
+	futex_q_lockptr_lock(&q);
 	/*
 	 * If we failed to acquire the lock (deadlock/signal/timeout), we must
 	 * first acquire the hb->lock before removing the lock from the
@@ -1157,6 +1163,7 @@ retry:
 		 */
 		raw_spin_lock_irq(&pi_state->pi_mutex.wait_lock);
 		spin_unlock(&hb->lock);
+		futex_hash_put(hb);
 
 		/* drops pi_state->pi_mutex.wait_lock */
 		ret = wake_futex_pi(uaddr, uval, pi_state);
@@ -1196,6 +1203,7 @@ retry:
 	 */
 	if ((ret = futex_cmpxchg_value_locked(&curval, uaddr, uval, 0))) {
 		spin_unlock(&hb->lock);
+		futex_hash_put(hb);
 		switch (ret) {
 		case -EFAULT:
 			goto pi_faulted;
@@ -1216,6 +1224,7 @@ retry:
 
 out_unlock:
 	spin_unlock(&hb->lock);
+	futex_hash_put(hb);
 	return ret;
 
 pi_retry:
@@ -457,11 +457,13 @@ retry_private:
 
 			ret = get_user(curval, uaddr1);
 			if (ret)
-				return ret;
+				goto out_put;
 
 			if (!(flags & FLAGS_SHARED))
 				goto retry_private;
 
+			futex_hash_put(hb2);
+			futex_hash_put(hb1);
 			goto retry;
 		}
 		if (curval != *cmpval) {
@@ -540,6 +542,8 @@ retry_private:
 		case -EFAULT:
 			double_unlock_hb(hb1, hb2);
 			futex_hb_waiters_dec(hb2);
+			futex_hash_put(hb2);
+			futex_hash_put(hb1);
 			ret = fault_in_user_writeable(uaddr2);
 			if (!ret)
 				goto retry;
@@ -554,6 +558,8 @@ retry_private:
 			 */
 			double_unlock_hb(hb1, hb2);
 			futex_hb_waiters_dec(hb2);
+			futex_hash_put(hb2);
+			futex_hash_put(hb1);
 			/*
 			 * Handle the case where the owner is in the middle of
 			 * exiting. Wait for the exit to complete otherwise
@@ -673,6 +679,9 @@ out_unlock:
 	double_unlock_hb(hb1, hb2);
 	wake_up_q(&wake_q);
 	futex_hb_waiters_dec(hb2);
+out_put:
+	futex_hash_put(hb2);
+	futex_hash_put(hb1);
 	return ret ? ret : task_count;
 }
 
@@ -707,8 +716,7 @@ int handle_early_requeue_pi_wakeup(struct futex_hash_bucket *hb,
 	 * We were woken prior to requeue by a timeout or a signal.
 	 * Unqueue the futex_q and determine which it was.
 	 */
-	plist_del(&q->list, &hb->chain);
-	futex_hb_waiters_dec(hb);
+	__futex_unqueue(q);
 
 	/* Handle spurious wakeups gracefully */
 	ret = -EWOULDBLOCK;
@@ -820,8 +828,13 @@ int futex_wait_requeue_pi(u32 __user *uaddr, unsigned int flags,
 
 	switch (futex_requeue_pi_wakeup_sync(&q)) {
 	case Q_REQUEUE_PI_IGNORE:
-		/* The waiter is still on uaddr1 */
-		spin_lock(&hb->lock);
+		/*
+		 * The waiter is still on uaddr1. Re-evaluate the bucket
+		 * from q.lock_ptr instead of reusing @hb, as a private
+		 * hash rehash may have moved the futex_q meanwhile.
+		 */
+		futex_q_lockptr_lock(&q);
+		hb = container_of(q.lock_ptr, struct futex_hash_bucket, lock);
 		ret = handle_early_requeue_pi_wakeup(hb, &q, to);
 		spin_unlock(&hb->lock);
 		break;
@@ -829,7 +842,7 @@ int futex_wait_requeue_pi(u32 __user *uaddr, unsigned int flags,
 	case Q_REQUEUE_PI_LOCKED:
 		/* The requeue acquired the lock */
 		if (q.pi_state && (q.pi_state->owner != current)) {
-			spin_lock(q.lock_ptr);
+			futex_q_lockptr_lock(&q);
 			ret = fixup_pi_owner(uaddr2, &q, true);
 			/*
 			 * Drop the reference to the pi state which the
@@ -851,7 +864,7 @@ int futex_wait_requeue_pi(u32 __user *uaddr, unsigned int flags,
 		ret = rt_mutex_wait_proxy_lock(pi_mutex, to, &rt_waiter);
 
 		/* Current is not longer pi_blocked_on */
-		spin_lock(q.lock_ptr);
+		futex_q_lockptr_lock(&q);
 		if (ret && !rt_mutex_cleanup_proxy_lock(pi_mutex, &rt_waiter))
 			ret = 0;
 
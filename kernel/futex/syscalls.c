@@ -305,6 +305,61 @@ destroy_timer:
 	return ret;
 }
 
+/**
+ * sys_futex_wake_multi - Wake waiters on a list of futexes
+ * @wakers:     List of futexes to wake
+ * @nr_futexes: Length of the list
+ * @flags:      Reserved, must be 0
+ *
+ * Given an array of `struct futex_waitv`, wake up to ->val waiters on
+ * each uaddr. This batches what would otherwise be one futex_wake() call
+ * per address: futexes hashing into the same bucket are processed under
+ * a single bucket lock acquisition and all woken tasks are handed to the
+ * scheduler in one go. ->val carries the number of waiters to wake for
+ * that futex instead of the expected value; flags for private futexes,
+ * sizes, etc. are used on the individual flags of each entry like for
+ * futex_waitv().
+ *
+ * Returns the total number of woken waiters, which may be smaller than
+ * requested, or an error. On error no waiter has been woken unless the
+ * error is -EINVAL reporting a PI futex waiter on one of the addresses.
+ */
+SYSCALL_DEFINE3(futex_wake_multi, struct futex_waitv __user *, wakers,
+		unsigned int, nr_futexes, unsigned int, flags)
+{
+	struct futex_vector *futexv;
+	int ret;
+
+	/* This syscall supports no flags for now */
+	if (flags)
+		return -EINVAL;
+
+	if (!nr_futexes || nr_futexes > FUTEX_WAITV_MAX || !wakers)
+		return -EINVAL;
+
+	futexv = kcalloc(nr_futexes, sizeof(*futexv), GFP_KERNEL);
+	if (!futexv)
+		return -ENOMEM;
+
+	ret = futex_parse_waitv(futexv, wakers, nr_futexes);
+	if (!ret) {
+		unsigned int i;
+
+		/* ->val carries the number of waiters to wake here */
+		for (i = 0; i < nr_futexes; i++) {
+			if (futexv[i].w.val > INT_MAX) {
+				ret = -EINVAL;
+				break;
+			}
+		}
+	}
+	if (!ret)
+		ret = futex_wake_multiple(futexv, nr_futexes);
+
+	kfree(futexv);
+	return ret;
+}
+
 #ifdef CONFIG_COMPAT
 COMPAT_SYSCALL_DEFINE2(set_robust_list,
 		struct compat_robust_list_head __user *, head,
@@ -158,8 +158,10 @@ int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
 	hb = futex_hash(&key);
 
 	/* Make sure we really have tasks to wakeup */
-	if (!futex_hb_waiters_pending(hb))
+	if (!futex_hb_waiters_pending(hb)) {
+		futex_hash_put(hb);
 		return ret;
+	}
 
 	spin_lock(&hb->lock);
 
@@ -181,6 +183,7 @@ int futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
 	}
 
 	spin_unlock(&hb->lock);
+	futex_hash_put(hb);
 	wake_up_q(&wake_q);
 	return ret;
 }
@@ -268,18 +271,20 @@ retry_private:
 			 * an MMU, but we might get them from range checking
 			 */
 			ret = op_ret;
-			return ret;
+			goto out_put;
 		}
 
 		if (op_ret == -EFAULT) {
 			ret = fault_in_user_writeable(uaddr2);
 			if (ret)
-				return ret;
+				goto out_put;
 		}
 
 		cond_resched();
 		if (!(flags & FLAGS_SHARED))
 			goto retry_private;
+		futex_hash_put(hb2);
+		futex_hash_put(hb1);
 		goto retry;
 	}
 
@@ -314,9 +319,118 @@ retry_private:
 out_unlock:
 	double_unlock_hb(hb1, hb2);
 	wake_up_q(&wake_q);
+out_put:
+	futex_hash_put(hb2);
+	futex_hash_put(hb1);
 	return ret;
 }
 
+/**
+ * futex_wake_multiple - Wake waiters on a list of distinct futexes
+ * @vs:		List of futexes to wake, ->w.val is the number of waiters
+ *		to wake per futex
+ * @count:	Length of the list
+ *
+ * The wake side counterpart of futex_wait_multiple(): instead of one
+ * futex_wake() call per address - each of which hashes the key and locks
+ * a hash bucket - resolve all buckets up front, take each bucket lock
+ * once for all futexes hashing into it and hand the combined list of
+ * woken tasks to wake_up_q() in a single pass.
+ *
+ * Return:
+ *  - >=0 - Total number of woken waiters
+ *  -  <0 - On error
+ */
+int futex_wake_multiple(struct futex_vector *vs, unsigned int count)
+{
+	DECLARE_BITMAP(done, FUTEX_WAITV_MAX);
+	struct futex_private_hash *fph;
+	struct futex_hash_bucket **hbs;
+	DEFINE_WAKE_Q(wake_q);
+	int ret = 0, nwoken = 0;
+	unsigned int i, j;
+
+	bitmap_zero(done, FUTEX_WAITV_MAX);
+
+	hbs = kcalloc(count, sizeof(*hbs), GFP_KERNEL);
+	if (!hbs)
+		return -ENOMEM;
+
+	for (i = 0; i < count; i++) {
+		ret = get_futex_key(u64_to_user_ptr(vs[i].w.uaddr),
+				    !(vs[i].w.flags & FUTEX_PRIVATE_FLAG),
+				    &vs[i].q.key, FUTEX_READ);
+		if (ret)
+			goto out_free;
+	}
+
+	/*
+	 * One reference on the private hash covers all private buckets.
+	 * Taking it once up front also makes sure a concurrent resize
+	 * cannot block a later lookup while earlier buckets are pinned.
+	 */
+	fph = futex_private_hash();
+	for (i = 0; i < count; i++)
+		hbs[i] = __futex_hash(&vs[i].q.key, fph);
+
+	for (i = 0; i < count; i++) {
+		struct futex_hash_bucket *hb = hbs[i];
+
+		if (test_bit(i, done))
+			continue;
+
+		/*
+		 * As in futex_wake(), buckets without pending waiters can
+		 * be skipped without taking the bucket lock; the barrier
+		 * in futex_hb_waiters_pending() holds per bucket.
+		 */
+		if (!futex_hb_waiters_pending(hb)) {
+			for (j = i + 1; j < count; j++)
+				if (hbs[j] == hb)
+					set_bit(j, done);
+			continue;
+		}
+
+		spin_lock(&hb->lock);
+		for (j = i; j < count; j++) {
+			struct futex_q *this, *next;
+			int woken = 0;
+
+			if (hbs[j] != hb || test_bit(j, done))
+				continue;
+			set_bit(j, done);
+
+			plist_for_each_entry_safe(this, next, &hb->chain, list) {
+				if (!futex_match(&this->key, &vs[j].q.key))
+					continue;
+
+				if (this->pi_state || this->rt_waiter) {
+					ret = -EINVAL;
+					break;
+				}
+
+				futex_wake_mark(&wake_q, this);
+				if (++woken >= (int)vs[j].w.val)
+					break;
+			}
+			nwoken += woken;
+			if (ret)
+				break;
+		}
+		spin_unlock(&hb->lock);
+		if (ret)
+			break;
+	}
+
+	wake_up_q(&wake_q);
+
+	if (fph)
+		futex_private_hash_put(fph);
+out_free:
+	kfree(hbs);
+	return ret ? ret : nwoken;
+}
+
 static long futex_wait_restart(struct restart_block *restart);
 
 /**
@@ -336,6 +450,11 @@ void futex_wait_queue(struct futex_hash_bucket *hb, struct futex_q *q,
 	 */
 	set_current_state(TASK_INTERRUPTIBLE|TASK_FREEZABLE);
 	futex_queue(q, hb);
+	/*
+	 * The queued futex_q is found through q->lock_ptr from here on, so
+	 * the bucket - and with it a private hash - needs no more pinning.
+	 */
+	futex_hash_put(hb);
 
 	/* Arm the timer */
 	if (timeout)
@@ -447,6 +566,7 @@ retry:
 			 * be unlocked.
 			 */
 			futex_queue(q, hb);
+			futex_hash_put(hb);
 			continue;
 		}
 
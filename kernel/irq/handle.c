@@ -133,6 +133,18 @@ void __irq_wake_thread(struct irq_desc *desc, struct irqaction *action)
 	 */
 	atomic_inc(&desc->threads_active);
 
+	/*
+	 * If the thread is in its IRQF_THREAD_POLL polling phase it picks
+	 * up IRQTF_RUNTHREAD on its own, so the wakeup can be spared.
+	 * test_and_set_bit() above implies a full barrier, which orders
+	 * the IRQTF_RUNTHREAD store against the IRQTF_POLLING load and
+	 * pairs with the barrier in irq_thread_poll(): either this code
+	 * observes IRQTF_POLLING cleared and issues the wakeup or the
+	 * thread observes IRQTF_RUNTHREAD before going back to sleep.
+	 */
+	if (test_bit(IRQTF_POLLING, &action->thread_flags))
+		return;
+
 	wake_up_process(action->thread);
 }
 
@@ -189,8 +201,11 @@ irqreturn_t __handle_irq_event_percpu(struct irq_desc *desc)
 irqreturn_t handle_irq_event_percpu(struct irq_desc *desc)
 {
 	irqreturn_t retval;
+	u64 ts;
 
+	ts = irq_rebalance_ts();
 	retval = __handle_irq_event_percpu(desc);
+	irq_rebalance_account(desc, ts);
 
 	add_interrupt_randomness(desc->irq_data.irq);
 
@@ -30,6 +30,7 @@ extern struct irqaction chained_action;
  * IRQTF_AFFINITY  - irq thread is requested to adjust affinity
  * IRQTF_FORCED_THREAD  - irq action is force threaded
  * IRQTF_READY     - signals that irq thread is ready
+ * IRQTF_POLLING   - irq thread is polling for work, no wakeup required
  */
 enum {
 	IRQTF_RUNTHREAD,
@@ -37,6 +38,7 @@ enum {
 	IRQTF_AFFINITY,
 	IRQTF_FORCED_THREAD,
 	IRQTF_READY,
+	IRQTF_POLLING,
 };
 
 /*
@@ -394,6 +396,42 @@ static inline void irq_setup_timings(struct irq_desc *desc,
 static inline void record_irq_time(struct irq_desc *desc) {}
 #endif /* CONFIG_IRQ_TIMINGS */
 
+#ifdef CONFIG_IRQ_REBALANCE
+DECLARE_STATIC_KEY_FALSE(irq_rebalance_enabled);
+
+/*
+ * Like record_irq_time() these helpers are always inlined so the static
+ * key branch acts at the call site and the disabled case costs nothing
+ * in the hot path.
+ */
+static __always_inline u64 irq_rebalance_ts(void)
+{
+	if (!static_branch_unlikely(&irq_rebalance_enabled))
+		return 0;
+
+	return local_clock();
+}
+
+static __always_inline void irq_rebalance_account(struct irq_desc *desc, u64 ts)
+{
+	struct irq_rebal_cpu __percpu *stat;
+
+	if (!static_branch_unlikely(&irq_rebalance_enabled) || !ts)
+		return;
+
+	/* Published by the rebalancing worker once it notices this irq */
+	stat = READ_ONCE(desc->rebal_stat);
+	if (stat)
+		this_cpu_ptr(stat)->ns += local_clock() - ts;
+}
+
+int irq_steer_managed_affinity(struct irq_desc *desc,
+			       const struct cpumask *dest);
+#else
+static inline u64 irq_rebalance_ts(void) { return 0; }
+static inline void irq_rebalance_account(struct irq_desc *desc, u64 ts) {}
+#endif /* CONFIG_IRQ_REBALANCE */
+
 
 #ifdef CONFIG_GENERIC_IRQ_CHIP
 void irq_init_generic_chip(struct irq_chip_generic *gc, const char *name,
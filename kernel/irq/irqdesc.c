@@ -431,6 +431,9 @@ static void irq_kobj_release(struct kobject *kobj)
 
 	free_masks(desc);
 	free_percpu(desc->kstat_irqs);
+#ifdef CONFIG_IRQ_REBALANCE
+	free_percpu(desc->rebal_stat);
+#endif
 	kfree(desc);
 }
 
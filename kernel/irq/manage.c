@@ -16,6 +16,7 @@
 #include <linux/irqdomain.h>
 #include <linux/slab.h>
 #include <linux/sched.h>
+#include <linux/sched/clock.h>
 #include <linux/sched/rt.h>
 #include <linux/sched/task.h>
 #include <linux/sched/isolation.h>
@@ -287,6 +288,51 @@ int irq_do_set_affinity(struct irq_data *data, const struct cpumask *mask,
 	return ret;
 }
 
+#ifdef CONFIG_IRQ_REBALANCE
+/**
+ * irq_steer_managed_affinity - Redirect a managed interrupt within its spread mask
+ * @desc:	Interrupt descriptor to steer
+ * @dest:	Destination CPUs, must be a subset of the managed spread mask
+ *
+ * Programs the interrupt chip with @dest while keeping the managed
+ * spread mask in the descriptor intact, so CPU hotplug and descriptor
+ * teardown keep operating on the original constraints. Used by the
+ * rebalancing engine to move vectors off overloaded CPUs.
+ *
+ * Return: 0 on success, negative error code otherwise.
+ */
+int irq_steer_managed_affinity(struct irq_desc *desc,
+			       const struct cpumask *dest)
+{
+	struct irq_data *data = irq_desc_get_irq_data(desc);
+	cpumask_var_t managed;
+	unsigned long flags;
+	int ret = -EINVAL;
+
+	if (!alloc_cpumask_var(&managed, GFP_KERNEL))
+		return -ENOMEM;
+
+	raw_spin_lock_irqsave(&desc->lock, flags);
+	if (!irqd_affinity_is_managed(data) || !irqd_is_started(data) ||
+	    !cpumask_subset(dest, desc->irq_common_data.affinity) ||
+	    !cpumask_intersects(dest, cpu_online_mask))
+		goto out_unlock;
+
+	/*
+	 * irq_do_set_affinity() copies the programmed mask into the
+	 * descriptor, which for managed interrupts holds the spread
+	 * mask. Save and restore it so the constraint survives.
+	 */
+	cpumask_copy(managed, desc->irq_common_data.affinity);
+	ret = irq_do_set_affinity(data, dest, false);
+	cpumask_copy(desc->irq_common_data.affinity, managed);
+out_unlock:
+	raw_spin_unlock_irqrestore(&desc->lock, flags);
+	free_cpumask_var(managed);
+	return ret;
+}
+#endif
+
 #ifdef CONFIG_GENERIC_PENDING_IRQ
 static inline int irq_set_affinity_pending(struct irq_data *data,
 					   const struct cpumask *dest)
@@ -1258,6 +1304,80 @@ static void irq_wake_secondary(struct irq_desc *desc, struct irqaction *action)
 	raw_spin_unlock_irq(&desc->lock);
 }
 
+/*
+ * Knobs for IRQF_THREAD_POLL: how long the thread polls the line after
+ * handling an interrupt before going back to sleep and how many handler
+ * invocations a single polling phase may consume.
+ */
+static unsigned long irqthread_poll_us __read_mostly = 50;
+core_param(irqthread_poll_us, irqthread_poll_us, ulong, 0644);
+
+static unsigned int irqthread_poll_budget __read_mostly = 64;
+core_param(irqthread_poll_budget, irqthread_poll_budget, uint, 0644);
+
+/*
+ * NAPI style polling phase for IRQF_THREAD_POLL actions.
+ *
+ * For high rate interrupt sources the wake_up_process() in hard irq
+ * context and the subsequent schedule in/out of the thread can cost more
+ * than the threaded handler itself. After handling an interrupt the
+ * thread therefore announces itself with IRQTF_POLLING, which makes
+ * __irq_wake_thread() skip the wakeup, and picks up IRQTF_RUNTHREAD on
+ * its own until the poll window lapses without new work or the budget is
+ * exhausted. The window restarts after each handled interrupt so a busy
+ * line is serviced back to back without going through the scheduler.
+ */
+static void irq_thread_poll(struct irq_desc *desc, struct irqaction *action,
+			    irqreturn_t (*handler_fn)(struct irq_desc *desc,
+						      struct irqaction *action))
+{
+	unsigned int budget = READ_ONCE(irqthread_poll_budget);
+	u64 window = READ_ONCE(irqthread_poll_us) * NSEC_PER_USEC;
+	u64 start;
+
+	if (!window || !budget)
+		return;
+
+repoll:
+	set_bit(IRQTF_POLLING, &action->thread_flags);
+	/* Order the flag store against the IRQTF_RUNTHREAD checks below */
+	smp_mb__after_atomic();
+
+	start = local_clock();
+	while (!kthread_should_stop() && local_clock() - start < window) {
+		irqreturn_t action_ret;
+
+		if (!test_and_clear_bit(IRQTF_RUNTHREAD,
+					&action->thread_flags)) {
+			cpu_relax();
+			continue;
+		}
+
+		action_ret = handler_fn(desc, action);
+		if (action_ret == IRQ_WAKE_THREAD)
+			irq_wake_secondary(desc, action);
+		wake_threads_waitq(desc);
+
+		if (!--budget)
+			break;
+		start = local_clock();
+	}
+
+	clear_bit(IRQTF_POLLING, &action->thread_flags);
+	/*
+	 * Pairs with the barrier implied by test_and_set_bit() in
+	 * __irq_wake_thread(). Either the hard irq handler observes
+	 * IRQTF_POLLING cleared and issues the wakeup or the recheck
+	 * below observes IRQTF_RUNTHREAD and polls another round. An
+	 * interrupt which slips in after the recheck is caught by the
+	 * IRQTF_RUNTHREAD test in irq_wait_for_interrupt().
+	 */
+	smp_mb__after_atomic();
+	if (budget && !kthread_should_stop() &&
+	    test_bit(IRQTF_RUNTHREAD, &action->thread_flags))
+		goto repoll;
+}
+
 /*
  * Internal function to notify that a interrupt thread is ready.
  */
@@ -1319,6 +1439,9 @@ static int irq_thread(void *data)
 			irq_wake_secondary(desc, action);
 
 		wake_threads_waitq(desc);
+
+		if (action->flags & IRQF_THREAD_POLL)
+			irq_thread_poll(desc, action, handler_fn);
 	}
 
 	/*
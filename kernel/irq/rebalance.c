@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Load based rebalancing of managed interrupt affinities.
+ *
+ * irq_create_affinity_masks() spreads queue vectors over the machine
+ * once at allocation time without any runtime feedback, so CPUs that
+ * end up servicing vectors of several multi-queue devices stay
+ * overloaded forever. This engine periodically accounts the CPU time
+ * consumed by interrupt handlers (hooked into handle_irq_event_percpu()
+ * in the same static key style as the irq timings infrastructure) and
+ * steers the hottest managed vector of an overloaded CPU to the least
+ * loaded CPU inside its spread mask.
+ */
+#include <linux/cpu.h>
+#include <linux/interrupt.h>
+#include <linux/irq.h>
+#include <linux/math64.h>
+#include <linux/moduleparam.h>
+#include <linux/percpu.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+
+#include "internals.h"
+
+DEFINE_STATIC_KEY_FALSE(irq_rebalance_enabled);
+
+/* Interval between rebalancing passes */
+static unsigned int interval_ms = 2000;
+module_param(interval_ms, uint, 0644);
+
+/*
+ * A CPU is considered overloaded when its accumulated handler time
+ * exceeds this percentage of the online average.
+ */
+static unsigned int overload_pct = 150;
+module_param(overload_pct, uint, 0644);
+
+static void irq_rebalance_work_fn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(irq_rebalance_work, irq_rebalance_work_fn);
+
+struct rebal_cpu_state {
+	u64			load;
+	u64			hot_delta;
+	struct irq_desc		*hot;
+};
+
+/*
+ * Collect the handler time consumed per CPU since the previous pass and
+ * remember the hottest steerable vector of each CPU. Descriptors are
+ * only accounted once the worker has published their statistics
+ * storage, so the first pass after an interrupt shows up merely starts
+ * its accounting.
+ */
+static void irq_rebalance_collect(struct rebal_cpu_state *st)
+{
+	struct irq_desc *desc;
+	unsigned int irq;
+	int cpu;
+
+	for_each_irq_desc(irq, desc) {
+		struct irq_rebal_cpu __percpu *stat = desc->rebal_stat;
+		bool movable;
+
+		if (!stat) {
+			if (!desc->action)
+				continue;
+			stat = alloc_percpu(struct irq_rebal_cpu);
+			if (!stat)
+				continue;
+			/* Publish for irq_rebalance_account() */
+			smp_store_release(&desc->rebal_stat, stat);
+			continue;
+		}
+
+		movable = irqd_affinity_is_managed(&desc->irq_data) &&
+			  cpumask_weight_and(desc->irq_common_data.affinity,
+					     cpu_online_mask) > 1;
+
+		for_each_online_cpu(cpu) {
+			struct irq_rebal_cpu *rc = per_cpu_ptr(stat, cpu);
+			u64 ns = READ_ONCE(rc->ns);
+			u64 delta = ns - rc->seen;
+
+			rc->seen = ns;
+			if (!delta)
+				continue;
+			st[cpu].load += delta;
+			if (movable && delta > st[cpu].hot_delta) {
+				st[cpu].hot_delta = delta;
+				st[cpu].hot = desc;
+			}
+		}
+	}
+}
+
+static void irq_rebalance_work_fn(struct work_struct *work)
+{
+	struct rebal_cpu_state *st;
+	u64 total = 0, thresh;
+	int cpu, tcpu;
+
+	st = kcalloc(nr_cpu_ids, sizeof(*st), GFP_KERNEL);
+	if (!st)
+		goto out_rearm;
+
+	cpus_read_lock();
+	irq_lock_sparse();
+
+	irq_rebalance_collect(st);
+
+	for_each_online_cpu(cpu)
+		total += st[cpu].load;
+	if (!total)
+		goto out_unlock;
+
+	thresh = div_u64(div_u64(total, num_online_cpus()) * overload_pct, 100);
+
+	for_each_online_cpu(cpu) {
+		struct irq_desc *hot = st[cpu].hot;
+		u64 best = U64_MAX;
+		int target = -1;
+
+		if (!hot || st[cpu].load <= thresh)
+			continue;
+
+		for_each_cpu_and(tcpu, hot->irq_common_data.affinity,
+				 cpu_online_mask) {
+			if (tcpu == cpu)
+				continue;
+			if (st[tcpu].load < best) {
+				best = st[tcpu].load;
+				target = tcpu;
+			}
+		}
+
+		/* Only move when it cannot just overload the target */
+		if (target < 0 || best + st[cpu].hot_delta >= st[cpu].load)
+			continue;
+
+		irq_steer_managed_affinity(hot, cpumask_of(target));
+	}
+
+out_unlock:
+	irq_unlock_sparse();
+	cpus_read_unlock();
+	kfree(st);
+out_rearm:
+	if (static_branch_unlikely(&irq_rebalance_enabled))
+		schedule_delayed_work(&irq_rebalance_work,
+				      msecs_to_jiffies(interval_ms));
+}
+
+static DEFINE_MUTEX(irq_rebalance_mutex);
+
+static int irq_rebalance_set_enable(const char *val,
+				    const struct kernel_param *kp)
+{
+	bool enable;
+	int ret;
+
+	ret = kstrtobool(val, &enable);
+	if (ret)
+		return ret;
+
+	mutex_lock(&irq_rebalance_mutex);
+	if (enable && !static_key_enabled(&irq_rebalance_enabled)) {
+		static_branch_enable(&irq_rebalance_enabled);
+		schedule_delayed_work(&irq_rebalance_work,
+				      msecs_to_jiffies(interval_ms));
+	} else if (!enable && static_key_enabled(&irq_rebalance_enabled)) {
+		static_branch_disable(&irq_rebalance_enabled);
+		cancel_delayed_work_sync(&irq_rebalance_work);
+	}
+	mutex_unlock(&irq_rebalance_mutex);
+	return 0;
+}
+
+static int irq_rebalance_get_enable(char *buffer,
+				    const struct kernel_param *kp)
+{
+	return sprintf(buffer, "%d\n", static_key_enabled(&irq_rebalance_enabled));
+}
+
+static const struct kernel_param_ops irq_rebalance_enable_ops = {
+	.set = irq_rebalance_set_enable,
+	.get = irq_rebalance_get_enable,
+};
+module_param_cb(enable, &irq_rebalance_enable_ops, NULL, 0644);
@@ -47,8 +47,29 @@ LOCK_EVENT(lock_use_node2)	/* # of locking ops that use 2nd percpu node */
 LOCK_EVENT(lock_use_node3)	/* # of locking ops that use 3rd percpu node */
 LOCK_EVENT(lock_use_node4)	/* # of locking ops that use 4th percpu node */
 LOCK_EVENT(lock_no_node)	/* # of locking ops w/o using percpu node    */
+
+#ifdef CONFIG_NUMA
+/*
+ * Locking events for the CNA qspinlock slowpath
+ */
+LOCK_EVENT(lock_cna_intra_handoff) /* # of handoffs to a same-node waiter   */
+LOCK_EVENT(lock_cna_inter_handoff) /* # of handoffs to a remote-node waiter */
+LOCK_EVENT(lock_cna_defer)	/* # of waiters moved to secondary queue     */
+LOCK_EVENT(lock_cna_flush)	/* # of secondary queue splice-backs	     */
+#endif /* CONFIG_NUMA */
 #endif /* CONFIG_QUEUED_SPINLOCKS */
 
+/*
+ * Locking events for mutex
+ */
+LOCK_EVENT(mutex_optspin)	/* # of mutexes acquired by optimistic spin */
+LOCK_EVENT(mutex_spin_timeout)	/* # of spins ended by the spin budget	*/
+LOCK_EVENT(mutex_wait_lt8us)	/* # of slowpath waits below 8us	*/
+LOCK_EVENT(mutex_wait_lt64us)	/* # of slowpath waits below 64us	*/
+LOCK_EVENT(mutex_wait_lt512us)	/* # of slowpath waits below 512us	*/
+LOCK_EVENT(mutex_wait_lt4ms)	/* # of slowpath waits below 4ms	*/
+LOCK_EVENT(mutex_wait_long)	/* # of slowpath waits of 4ms or more	*/
+
 /*
  * Locking events for rwsem
  */
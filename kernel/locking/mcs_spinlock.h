@@ -40,9 +40,13 @@ do {									\
  * smp_store_release() provides a memory barrier to ensure all
  * operations in the critical section has been completed before
  * unlocking.
+ *
+ * The value of @val carries additional information from the lock
+ * holder to the next waiter (see qspinlock_cna.h); plain MCS
+ * handoffs pass 1.
  */
-#define arch_mcs_spin_unlock_contended(l)				\
-	smp_store_release((l), 1)
+#define arch_mcs_spin_unlock_contended(l, val)				\
+	smp_store_release((l), (val))
 #endif
 
 /*
@@ -24,17 +24,20 @@
 #include <linux/sched/rt.h>
 #include <linux/sched/wake_q.h>
 #include <linux/sched/debug.h>
+#include <linux/sched/clock.h>
 #include <linux/export.h>
 #include <linux/spinlock.h>
 #include <linux/interrupt.h>
 #include <linux/debug_locks.h>
 #include <linux/osq_lock.h>
+#include <linux/sort.h>
 
 #define CREATE_TRACE_POINTS
 #include <trace/events/lock.h>
 
 #ifndef CONFIG_PREEMPT_RT
 #include "mutex.h"
+#include "lock_events.h"
 
 #ifdef CONFIG_DEBUG_MUTEXES
 # define MUTEX_WARN_ON(cond) DEBUG_LOCKS_WARN_ON(cond)
@@ -50,6 +53,7 @@ __mutex_init(struct mutex *lock, const char *name, struct lock_class_key *key)
 	INIT_LIST_HEAD(&lock->wait_list);
 #ifdef CONFIG_MUTEX_SPIN_ON_OWNER
 	osq_lock_init(&lock->osq);
+	lock->spin_ns = 0;
 #endif
 
 	debug_mutex_init(lock, name, key);
@@ -352,10 +356,18 @@ static noinline
 bool mutex_spin_on_owner(struct mutex *lock, struct task_struct *owner,
 			 struct ww_acquire_ctx *ww_ctx, struct mutex_waiter *waiter)
 {
+	int budget = READ_ONCE(lock->spin_ns);
+	u64 deadline = 0;
 	bool ret = true;
 
 	lockdep_assert_preemption_disabled();
 
+	if (budget) {
+		if (budget < 0)
+			return false;
+		deadline = local_clock() + budget;
+	}
+
 	while (__mutex_owner(lock) == owner) {
 		/*
 		 * Ensure we emit the owner->on_cpu, dereference _after_
@@ -380,6 +392,12 @@ bool mutex_spin_on_owner(struct mutex *lock, struct task_struct *owner,
 			break;
 		}
 
+		if (deadline && local_clock() > deadline) {
+			lockevent_inc(mutex_spin_timeout);
+			ret = false;
+			break;
+		}
+
 		cpu_relax();
 	}
 
@@ -399,6 +417,10 @@ static inline int mutex_can_spin_on_owner(struct mutex *lock)
 	if (need_resched())
 		return 0;
 
+	/* Spinning may be disabled per-mutex, see mutex_set_spin_ns(). */
+	if (READ_ONCE(lock->spin_ns) < 0)
+		return 0;
+
 	/*
 	 * We already disabled preemption which is equal to the RCU read-side
 	 * crital section in optimistic spinning code. Thus the task_strcut
@@ -488,6 +510,7 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 	if (!waiter)
 		osq_unlock(&lock->osq);
 
+	lockevent_inc(mutex_optspin);
 	return true;
 
 
@@ -521,6 +544,37 @@ mutex_optimistic_spin(struct mutex *lock, struct ww_acquire_ctx *ww_ctx,
 }
 #endif
 
+#ifdef CONFIG_LOCK_EVENT_COUNTS
+/*
+ * Cheap histogram of slowpath wait times, exposed through the lock_events
+ * counters in debugfs.  Bucket boundaries grow by powers of eight so that
+ * five counters span sub-8us to multi-millisecond waits.
+ */
+static inline u64 mutex_wait_start(void)
+{
+	return local_clock();
+}
+
+static void mutex_wait_account(u64 start)
+{
+	u64 delta = local_clock() - start;
+
+	if (delta < 8 * NSEC_PER_USEC)
+		lockevent_inc(mutex_wait_lt8us);
+	else if (delta < 64 * NSEC_PER_USEC)
+		lockevent_inc(mutex_wait_lt64us);
+	else if (delta < 512 * NSEC_PER_USEC)
+		lockevent_inc(mutex_wait_lt512us);
+	else if (delta < 4 * NSEC_PER_MSEC)
+		lockevent_inc(mutex_wait_lt4ms);
+	else
+		lockevent_inc(mutex_wait_long);
+}
+#else
+static inline u64 mutex_wait_start(void) { return 0; }
+static inline void mutex_wait_account(u64 start) { }
+#endif
+
 static noinline void __sched __mutex_unlock_slowpath(struct mutex *lock, unsigned long ip);
 
 /**
@@ -572,6 +626,7 @@ __mutex_lock_common(struct mutex *lock, unsigned int state, unsigned int subclas
 {
 	struct mutex_waiter waiter;
 	struct ww_mutex *ww;
+	u64 wait_start;
 	int ret;
 
 	if (!use_ww_ctx)
@@ -647,6 +702,7 @@ __mutex_lock_common(struct mutex *lock, unsigned int state, unsigned int subclas
 
 	set_current_state(state);
 	trace_contention_begin(lock, LCB_F_MUTEX);
+	wait_start = mutex_wait_start();
 	for (;;) {
 		bool first;
 
@@ -701,6 +757,7 @@ __mutex_lock_common(struct mutex *lock, unsigned int state, unsigned int subclas
 	raw_spin_lock(&lock->wait_lock);
 acquired:
 	__set_current_state(TASK_RUNNING);
+	mutex_wait_account(wait_start);
 
 	if (ww_ctx) {
 		/*
@@ -1126,6 +1183,80 @@ EXPORT_SYMBOL(ww_mutex_lock_interruptible);
 #endif /* !CONFIG_DEBUG_LOCK_ALLOC */
 #endif /* !CONFIG_PREEMPT_RT */
 
+static int ww_mutex_addr_cmp(const void *a, const void *b)
+{
+	const struct ww_mutex *wa = *(const struct ww_mutex **)a;
+	const struct ww_mutex *wb = *(const struct ww_mutex **)b;
+
+	if (wa < wb)
+		return -1;
+	return wa > wb;
+}
+
+static int __ww_mutex_lock_batch(struct ww_mutex **locks, unsigned int count,
+				 struct ww_acquire_ctx *ctx, bool intr)
+{
+	unsigned int i, j, contended = count;
+	int ret;
+
+	/*
+	 * A consistent acquisition order makes backoff the exception
+	 * rather than the rule: batches only ever contend on the lock
+	 * they are both about to take next, so neither can hold what
+	 * the other still needs.
+	 */
+	sort(locks, count, sizeof(*locks), ww_mutex_addr_cmp, NULL);
+
+restart:
+	for (i = 0; i < count; i++) {
+		/* Slow-acquired on the previous pass, still held. */
+		if (i == contended)
+			continue;
+
+		ret = intr ? ww_mutex_lock_interruptible(locks[i], ctx) :
+			     ww_mutex_lock(locks[i], ctx);
+		if (likely(!ret))
+			continue;
+
+		/* Back off: drop every lock acquired so far. */
+		for (j = i; j--; )
+			ww_mutex_unlock(locks[j]);
+		if (contended > i && contended < count)
+			ww_mutex_unlock(locks[contended]);
+
+		if (ret != -EDEADLK)
+			return ret;
+
+		/* We got wounded; wait for the contended lock and retry. */
+		contended = i;
+		if (intr) {
+			ret = ww_mutex_lock_slow_interruptible(locks[i], ctx);
+			if (ret)
+				return ret;
+		} else {
+			ww_mutex_lock_slow(locks[i], ctx);
+		}
+		goto restart;
+	}
+
+	return 0;
+}
+
+int __sched ww_mutex_lock_batch(struct ww_mutex **locks, unsigned int count,
+				struct ww_acquire_ctx *ctx)
+{
+	return __ww_mutex_lock_batch(locks, count, ctx, false);
+}
+EXPORT_SYMBOL(ww_mutex_lock_batch);
+
+int __sched ww_mutex_lock_batch_interruptible(struct ww_mutex **locks,
+					      unsigned int count,
+					      struct ww_acquire_ctx *ctx)
+{
+	return __ww_mutex_lock_batch(locks, count, ctx, true);
+}
+EXPORT_SYMBOL(ww_mutex_lock_batch_interruptible);
+
 /**
  * atomic_dec_and_mutex_lock - return holding mutex if we dec to 0
  * @cnt: the atomic which we are to dec
@@ -22,6 +22,7 @@ int __percpu_init_rwsem(struct percpu_rw_semaphore *sem,
 	rcuwait_init(&sem->writer);
 	init_waitqueue_head(&sem->waiters);
 	atomic_set(&sem->block, 0);
+	sem->fast_writer = false;
 #ifdef CONFIG_DEBUG_LOCK_ALLOC
 	debug_check_no_locks_freed((void *)sem, sizeof(*sem));
 	lockdep_init_map(&sem->dep_map, name, key, 0);
@@ -198,6 +199,27 @@ bool percpu_is_read_locked(struct percpu_rw_semaphore *sem)
 }
 EXPORT_SYMBOL_GPL(percpu_is_read_locked);
 
+/**
+ * percpu_rwsem_set_fast_writer - bias @sem towards the writer side
+ * @sem: semaphore to re-bias, must not be in use yet
+ *
+ * Trade the per-cpu reader fast path for a cheap writer side: readers
+ * always take the memory-barrier based slow path, and in exchange
+ * percpu_down_write() no longer waits for an RCU grace period before
+ * checking the per-cpu reader counts.
+ *
+ * Intended for semaphores with frequent or latency-sensitive writers
+ * whose read side still benefits from per-cpu reader counts.  Must be
+ * called after initialization and before the semaphore is first used.
+ */
+void percpu_rwsem_set_fast_writer(struct percpu_rw_semaphore *sem)
+{
+	WARN_ON_ONCE(atomic_read(&sem->block) ||
+		     per_cpu_sum(*sem->read_count));
+	sem->fast_writer = true;
+}
+EXPORT_SYMBOL_GPL(percpu_rwsem_set_fast_writer);
+
 /*
  * Return true if the modular sum of the sem->read_count per-CPU variable is
  * zero.  If this sum is zero, then it is stable due to the fact that if any
@@ -227,8 +249,13 @@ void __sched percpu_down_write(struct percpu_rw_semaphore *sem)
 	rwsem_acquire(&sem->dep_map, 0, 0, _RET_IP_);
 	trace_contention_begin(sem, LCB_F_PERCPU | LCB_F_WRITE);
 
-	/* Notify readers to take the slow path. */
-	rcu_sync_enter(&sem->rss);
+	/*
+	 * Notify readers to take the slow path.  Fast-writer semaphores
+	 * keep their readers on the slow path permanently, so the
+	 * grace-period wait in rcu_sync_enter() is not needed.
+	 */
+	if (!sem->fast_writer)
+		rcu_sync_enter(&sem->rss);
 
 	/*
 	 * Try set sem->block; this provides writer-writer exclusion.
@@ -277,6 +304,7 @@ void percpu_up_write(struct percpu_rw_semaphore *sem)
 	 * reader fast path will be available again. Safe to use outside the
 	 * exclusive write lock because its counting.
 	 */
-	rcu_sync_exit(&sem->rss);
+	if (!sem->fast_writer)
+		rcu_sync_exit(&sem->rss);
 }
 EXPORT_SYMBOL_GPL(percpu_up_write);
@@ -72,16 +72,16 @@
 /*
  * On 64-bit architectures, the mcs_spinlock structure will be 16 bytes in
  * size and four of them will fit nicely in one 64-byte cacheline. For
- * pvqspinlock, however, we need more space for extra data. To accommodate
- * that, we insert two more long words to pad it up to 32 bytes. IOW, only
- * two of them can fit in a cacheline in this case. That is OK as it is rare
- * to have more than 2 levels of slowpath nesting in actual use. We don't
- * want to penalize pvqspinlocks to optimize for a rare case in native
- * qspinlocks.
+ * pvqspinlock and the CNA slowpath, however, we need more space for extra
+ * data. To accommodate that, we insert two more long words to pad it up to
+ * 32 bytes. IOW, only two of them can fit in a cacheline in this case. That
+ * is OK as it is rare to have more than 2 levels of slowpath nesting in
+ * actual use. We don't want to penalize pvqspinlocks to optimize for a rare
+ * case in native qspinlocks.
  */
 struct qnode {
 	struct mcs_spinlock mcs;
-#ifdef CONFIG_PARAVIRT_SPINLOCKS
+#if defined(CONFIG_PARAVIRT_SPINLOCKS) || defined(CONFIG_NUMA)
 	long reserved[2];
 #endif
 };
@@ -264,6 +264,51 @@ static __always_inline void set_locked(struct qspinlock *lock)
 	WRITE_ONCE(lock->locked, _Q_LOCKED_VAL);
 }
 
+/**
+ * __try_clear_tail - try to clear tail and grab the lock when this CPU is
+ *		      the last one in the queue
+ * @lock: Pointer to queued spinlock structure
+ * @val : Current value of the queued spinlock 32-bit word
+ * @node: Pointer to the MCS node of the lock holder
+ *
+ * n,0,0 -> 0,0,1
+ */
+static __always_inline bool __try_clear_tail(struct qspinlock *lock, u32 val,
+					     struct mcs_spinlock *node)
+{
+	return atomic_try_cmpxchg_relaxed(&lock->val, &val, _Q_LOCKED_VAL);
+}
+
+/**
+ * __mcs_lock_handoff - pass the MCS lock to the next waiter
+ * @node: Pointer to the MCS node of the lock holder
+ * @next: Pointer to the MCS node of the first waiter in the main queue
+ */
+static __always_inline void __mcs_lock_handoff(struct mcs_spinlock *node,
+					       struct mcs_spinlock *next)
+{
+	arch_mcs_spin_unlock_contended(&next->locked, 1);
+}
+
+static __always_inline void __cna_init_node(struct mcs_spinlock *node) { }
+static __always_inline void __cna_wait_head(struct qspinlock *lock,
+					    struct mcs_spinlock *node) { }
+
+#ifdef CONFIG_NUMA
+/*
+ * Compact NUMA-aware lock slowpath; off by default and selected with the
+ * "numa_spinlock=" boot parameter.
+ */
+#include "qspinlock_cna.h"
+
+#define try_clear_tail		cna_try_clear_tail
+#define mcs_lock_handoff	cna_lock_handoff
+#else
+#define cna_init_node		__cna_init_node
+#define cna_wait_head		__cna_wait_head
+#define try_clear_tail		__try_clear_tail
+#define mcs_lock_handoff	__mcs_lock_handoff
+#endif
 
 /*
  * Generate the native code for queued_spin_unlock_slowpath(); provide NOPs for
@@ -437,6 +482,7 @@ pv_queue:
 	node->locked = 0;
 	node->next = NULL;
 	pv_init_node(node);
+	cna_init_node(node);
 
 	/*
 	 * We touched a (possibly) cold cacheline in the per-cpu queue node;
@@ -511,6 +557,8 @@ pv_queue:
 	if ((val = pv_wait_head_or_lock(lock, node)))
 		goto locked;
 
+	cna_wait_head(lock, node);
+
 	val = atomic_cond_read_acquire(&lock->val, !(VAL & _Q_LOCKED_PENDING_MASK));
 
 locked:
@@ -536,7 +584,7 @@ locked:
 	 *       PENDING will make the uncontended transition fail.
 	 */
 	if ((val & _Q_TAIL_MASK) == tail) {
-		if (atomic_try_cmpxchg_relaxed(&lock->val, &val, _Q_LOCKED_VAL))
+		if (try_clear_tail(lock, val, node))
 			goto release; /* No contention */
 	}
 
@@ -553,7 +601,7 @@ locked:
 	if (!next)
 		next = smp_cond_load_relaxed(&node->next, (VAL));
 
-	arch_mcs_spin_unlock_contended(&next->locked);
+	mcs_lock_handoff(node, next);
 	pv_kick_node(lock, next);
 
 release:
@@ -580,6 +628,20 @@ EXPORT_SYMBOL(queued_spin_lock_slowpath);
 #undef pv_kick_node
 #undef pv_wait_head_or_lock
 
+/*
+ * The CNA queue ordering must not be used in the paravirt slowpath; it
+ * would defeat pv_wait_node()'s tracking of the queue order.
+ */
+#undef cna_init_node
+#undef cna_wait_head
+#undef try_clear_tail
+#undef mcs_lock_handoff
+
+#define cna_init_node		__cna_init_node
+#define cna_wait_head		__cna_wait_head
+#define try_clear_tail		__try_clear_tail
+#define mcs_lock_handoff	__mcs_lock_handoff
+
 #undef  queued_spin_lock_slowpath
 #define queued_spin_lock_slowpath	__pv_queued_spin_lock_slowpath
 
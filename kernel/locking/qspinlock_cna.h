@@ -0,0 +1,273 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _GEN_CNA_LOCK_SLOWPATH
+#define _GEN_CNA_LOCK_SLOWPATH
+
+#include <linux/topology.h>
+#include <linux/jump_label.h>
+
+/*
+ * Implement a NUMA-aware version of MCS (aka CNA, or compact NUMA-aware
+ * lock), included from qspinlock.c.
+ *
+ * In CNA, the queue head prefers to pass the lock to a waiter running on
+ * its own NUMA node: while spinning for the lock word it moves waiters
+ * from other nodes off the main queue onto a secondary queue, and passes
+ * that queue along with the lock.  Keeping consecutive lock holders on
+ * one node keeps the lock cacheline, and typically the data it protects,
+ * on that node across handoffs instead of bouncing it across the
+ * interconnect.  To keep waiters on remote nodes from starving, the
+ * preference is abandoned after a bounded number of consecutive
+ * intra-node handoffs, at which point the secondary queue is spliced
+ * back into the main queue ahead of all later arrivals.
+ *
+ * The secondary queue is circular (tail->next points back at the head)
+ * and is reachable through the queue head's ->locked field, which holds
+ * the encoded tail of the secondary queue; values > 1 are thereby
+ * distinguished from the plain MCS handoff value of 1.  Successive lock
+ * holders inherit the secondary queue through the handoff value, and the
+ * uncontended-exit path promotes it to be the new main queue when the
+ * main queue drains first.
+ *
+ * CNA is off by default and is selected with the "numa_spinlock=" boot
+ * parameter.  For details, see:
+ *
+ *   Dave Dice and Alex Kogan: Compact NUMA-aware Locks, EuroSys 2019.
+ */
+
+struct cna_node {
+	struct mcs_spinlock	mcs;
+	u16			numa_node;
+	u32			encoded_tail;	/* self */
+	u32			intra_count;
+};
+
+/*
+ * Bound on consecutive intra-node lock handoffs. Once reached, the
+ * secondary queue is spliced back into the main queue, so no waiter can
+ * be passed over more than CNA_INTRA_HANDOFF_LIMIT times in a row.
+ */
+#define CNA_INTRA_HANDOFF_LIMIT	(1 << 8)
+
+static DEFINE_STATIC_KEY_FALSE(cna_lock_key);
+
+static int numa_spinlock_mode;	/* 0 = off (default), 1 = on, 2 = auto */
+
+static int __init numa_spinlock_setup(char *str)
+{
+	if (!strcmp(str, "on"))
+		numa_spinlock_mode = 1;
+	else if (!strcmp(str, "auto"))
+		numa_spinlock_mode = 2;
+	else
+		numa_spinlock_mode = 0;
+
+	return 0;
+}
+early_param("numa_spinlock", numa_spinlock_setup);
+
+static int __init cna_init_nodes(void)
+{
+	unsigned int cpu;
+
+	if (numa_spinlock_mode == 0 ||
+	    (numa_spinlock_mode == 2 && nr_node_ids < 2))
+		return 0;
+
+	/* all CNA data must fit into the space reserved in struct qnode */
+	BUILD_BUG_ON(sizeof(struct cna_node) > sizeof(struct qnode));
+
+	for_each_possible_cpu(cpu) {
+		int idx;
+
+		for (idx = 0; idx < MAX_NODES; idx++) {
+			struct cna_node *cn = (struct cna_node *)
+				grab_mcs_node(per_cpu_ptr(&qnodes[0].mcs, cpu),
+					      idx);
+
+			cn->encoded_tail = encode_tail(cpu, idx);
+			/*
+			 * make sure @encoded_tail is not confused with other
+			 * valid values for @locked (0 or 1)
+			 */
+			WARN_ON(cn->encoded_tail <= 1);
+		}
+	}
+
+	/*
+	 * All ->encoded_tail values are published by the patching in
+	 * static_branch_enable() before any CPU can run the CNA hooks.
+	 */
+	static_branch_enable(&cna_lock_key);
+	pr_info("Enabling CNA spinlock\n");
+
+	return 0;
+}
+early_initcall(cna_init_nodes);
+
+static __always_inline void cna_init_node(struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+
+	if (!static_branch_unlikely(&cna_lock_key))
+		return;
+
+	cn->numa_node = numa_node_id();
+	cn->intra_count = 0;
+}
+
+/*
+ * cna_order_queue - check whether the next waiter in the main queue is on
+ * the same NUMA node as the lock holder; if not, and it has a known
+ * successor, move it onto the secondary queue.
+ *
+ * Returns true once ordering is complete, i.e. the first waiter in the
+ * main queue runs on our NUMA node; false if another pass may be needed.
+ */
+static bool cna_order_queue(struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+	struct mcs_spinlock *next = READ_ONCE(node->next);
+	struct mcs_spinlock *nnext;
+
+	if (!next)
+		return false;	/* successor is still linking in */
+
+	if (((struct cna_node *)next)->numa_node == cn->numa_node)
+		return true;
+
+	/*
+	 * The main-queue tail cannot be moved: the lock word points at it
+	 * and new waiters link in behind it.  Without a known successor,
+	 * leave @next where it is and try again.
+	 */
+	nnext = READ_ONCE(next->next);
+	if (!nnext)
+		return false;
+
+	/* Stick @next onto the tail of the circular secondary queue. */
+	if (node->locked <= 1) {
+		next->next = next;
+	} else {
+		struct mcs_spinlock *tail_2nd = decode_tail(node->locked);
+
+		next->next = tail_2nd->next;
+		tail_2nd->next = next;
+	}
+	node->locked = ((struct cna_node *)next)->encoded_tail;
+	node->next = nnext;
+
+	lockevent_inc(lock_cna_defer);
+	return false;
+}
+
+/*
+ * cna_wait_head - use the cycles the queue head spends waiting for the
+ * owner and pending bits to drain to sort same-node waiters to the front
+ * of the main queue.
+ */
+static void cna_wait_head(struct qspinlock *lock, struct mcs_spinlock *node)
+{
+	bool ordered = false;
+
+	if (!static_branch_unlikely(&cna_lock_key))
+		return;
+
+	/* Past the handoff limit, leave the queue in strict FIFO order. */
+	if (((struct cna_node *)node)->intra_count >= CNA_INTRA_HANDOFF_LIMIT)
+		return;
+
+	while (atomic_read(&lock->val) & _Q_LOCKED_PENDING_MASK) {
+		if (!ordered)
+			ordered = cna_order_queue(node);
+		else
+			cpu_relax();
+	}
+}
+
+/*
+ * cna_try_clear_tail - the main queue is empty; if the secondary queue is
+ * empty as well, behave like MCS.  Otherwise make the secondary queue the
+ * new main queue by pointing the lock's tail at its last node, grab the
+ * lock and pass MCS-head status to the secondary queue's first node.
+ */
+static inline bool cna_try_clear_tail(struct qspinlock *lock, u32 val,
+				      struct mcs_spinlock *node)
+{
+	struct mcs_spinlock *tail_2nd, *head_2nd;
+	u32 new;
+
+	if (!static_branch_unlikely(&cna_lock_key) || node->locked <= 1)
+		return __try_clear_tail(lock, val, node);
+
+	tail_2nd = decode_tail(node->locked);
+	head_2nd = tail_2nd->next;
+	new = ((struct cna_node *)tail_2nd)->encoded_tail | _Q_LOCKED_VAL;
+
+	if (atomic_try_cmpxchg_relaxed(&lock->val, &val, new)) {
+		/*
+		 * Break the secondary queue's circular link before waking
+		 * @head_2nd; the release in the handoff below orders this
+		 * against the new head's reads.  If the cmpxchg fails, a
+		 * new waiter has already linked in behind @tail_2nd and
+		 * owns ->next.
+		 */
+		cmpxchg_relaxed(&tail_2nd->next, head_2nd, NULL);
+		arch_mcs_spin_unlock_contended(&head_2nd->locked, 1);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * cna_lock_handoff - pass the lock to the first waiter in the main queue,
+ * together with the secondary queue if its NUMA node matches ours and the
+ * handoff limit has not been reached; otherwise splice the secondary
+ * queue back into the main queue ahead of all later arrivals and pass the
+ * lock to its first node.
+ */
+static inline void cna_lock_handoff(struct mcs_spinlock *node,
+				    struct mcs_spinlock *next)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+	u32 val = 1;
+
+	if (!static_branch_unlikely(&cna_lock_key)) {
+		__mcs_lock_handoff(node, next);
+		return;
+	}
+
+	if (node->locked > 1) {
+		struct cna_node *next_cn;
+
+		/* ->next may have been re-ordered by cna_order_queue() */
+		next = READ_ONCE(node->next);
+		next_cn = (struct cna_node *)next;
+
+		if (next_cn->numa_node == cn->numa_node &&
+		    cn->intra_count < CNA_INTRA_HANDOFF_LIMIT) {
+			/* Pass the secondary queue along with the lock. */
+			val = node->locked;
+			next_cn->intra_count = cn->intra_count + 1;
+		} else {
+			struct mcs_spinlock *tail_2nd =
+				decode_tail(node->locked);
+			struct mcs_spinlock *head_2nd = tail_2nd->next;
+
+			tail_2nd->next = next;
+			next = head_2nd;
+			lockevent_inc(lock_cna_flush);
+		}
+	}
+
+	lockevent_cond_inc(lock_cna_intra_handoff,
+			   ((struct cna_node *)next)->numa_node ==
+			   cn->numa_node);
+	lockevent_cond_inc(lock_cna_inter_handoff,
+			   ((struct cna_node *)next)->numa_node !=
+			   cn->numa_node);
+
+	arch_mcs_spin_unlock_contended(&next->locked, val);
+}
+
+#endif /* _GEN_CNA_LOCK_SLOWPATH */
@@ -215,6 +215,60 @@ static void test_abba_work(struct work_struct *work)
 	abba->result = err;
 }
 
+#define TEST_BATCH_NR 16
+
+static int test_batch(void)
+{
+	struct ww_mutex mutexes[TEST_BATCH_NR];
+	struct ww_mutex *order[TEST_BATCH_NR];
+	struct ww_acquire_ctx ctx;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < TEST_BATCH_NR; i++) {
+		ww_mutex_init(&mutexes[i], &ww_class);
+		order[i] = &mutexes[i];
+	}
+
+	/* Present the locks in random order; the batch sorts them itself. */
+	for (i = TEST_BATCH_NR - 1; i > 0; i--)
+		swap(order[i], order[get_random_u32_below(i + 1)]);
+
+	ww_acquire_init(&ctx, &ww_class);
+
+	ret = ww_mutex_lock_batch(order, TEST_BATCH_NR, &ctx);
+	if (ret) {
+		pr_err("%s: batch lock failed with %d!\n", __func__, ret);
+		goto out;
+	}
+
+	for (i = 0; i < TEST_BATCH_NR; i++) {
+		if (!ww_mutex_is_locked(&mutexes[i])) {
+			pr_err("%s: mutex %d not locked by batch!\n",
+			       __func__, i);
+			ret = -EINVAL;
+		}
+	}
+
+	ret = ww_mutex_lock(&mutexes[0], &ctx);
+	if (ret != -EALREADY) {
+		pr_err("%s: batched lock not owned by context!\n", __func__);
+		ret = -EINVAL;
+	} else {
+		ret = 0;
+	}
+
+	for (i = 0; i < TEST_BATCH_NR; i++)
+		ww_mutex_unlock(&mutexes[i]);
+
+out:
+	ww_acquire_fini(&ctx);
+	for (i = 0; i < TEST_BATCH_NR; i++)
+		ww_mutex_destroy(&mutexes[i]);
+
+	return ret;
+}
+
 static int test_abba(bool trylock, bool resolve)
 {
 	struct test_abba abba;
@@ -641,6 +695,10 @@ static int __init test_ww_mutex_init(void)
 	if (ret)
 		return ret;
 
+	ret = test_batch();
+	if (ret)
+		return ret;
+
 	for (i = 0; i < 4; i++) {
 		ret = test_abba(i & 1, i & 2);
 		if (ret)
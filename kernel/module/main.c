@@ -1065,10 +1065,45 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 	int err;
 
 	/*
+	 * Most undefined symbols resolve to the kernel proper. Those need
+	 * neither a module reference recorded nor the owner protected
+	 * against unload, so look them up with just preemption disabled,
+	 * which find_symbol() supports. This keeps module_mutex out of
+	 * the hot path and lets independent loads resolve their symbols
+	 * concurrently.
+	 */
+	preempt_disable();
+	if (find_symbol(&fsa) && !fsa.owner) {
+		preempt_enable();
+
+		if (fsa.license == GPL_ONLY)
+			mod->using_gplonly_symbols = true;
+
+		if (!check_version(info, name, mod, fsa.crc)) {
+			fsa.sym = ERR_PTR(-EINVAL);
+		} else {
+			err = verify_namespace_is_imported(info, fsa.sym, mod);
+			if (err)
+				fsa.sym = ERR_PTR(err);
+		}
+
+		strncpy(ownername, module_name(NULL), MODULE_NAME_LEN);
+		return fsa.sym;
+	}
+	preempt_enable();
+
+	/*
+	 * Unknown or owned by a module: retry under module_mutex, which
+	 * keeps the owner alive while the new usage is recorded.
+	 *
 	 * The module_mutex should not be a heavily contended lock;
 	 * if we get the occasional sleep here, we'll go an extra iteration
 	 * in the wait_event_interruptible(), which is harmless.
 	 */
+	fsa.owner = NULL;
+	fsa.crc = NULL;
+	fsa.sym = NULL;
+
 	sched_annotate_sleep();
 	mutex_lock(&module_mutex);
 	if (!find_symbol(&fsa))
@@ -1344,11 +1379,130 @@ static int simplify_symbols(struct module *mod, const struct load_info *info)
 	return ret;
 }
 
+/*
+ * Arch opt-in for applying relocation sections concurrently. Only safe
+ * when apply_relocate()/apply_relocate_add() are free of global side
+ * effects, i.e. perform plain stores into the target section and do not
+ * emit PLT entries or trampolines from shared state.
+ */
+bool __weak module_arch_parallel_relocs(void)
+{
+	return false;
+}
+
+/*
+ * A relocation section can be applied concurrently when it patches a
+ * valid allocated target section which no other relocation section
+ * touches. Livepatch sections are left to the serial loop; their symbol
+ * resolution is not prepared for running concurrently.
+ */
+static bool reloc_section_parallel(const struct load_info *info, unsigned int i)
+{
+	unsigned int infosec = info->sechdrs[i].sh_info, j;
+
+	if (infosec >= info->hdr->e_shnum)
+		return false;
+	if (!(info->sechdrs[infosec].sh_flags & SHF_ALLOC))
+		return false;
+	if (info->sechdrs[i].sh_flags & SHF_RELA_LIVEPATCH)
+		return false;
+	if (info->sechdrs[i].sh_type != SHT_REL &&
+	    info->sechdrs[i].sh_type != SHT_RELA)
+		return false;
+
+	/* Relocation sections sharing a target must stay ordered */
+	for (j = 1; j < info->hdr->e_shnum; j++) {
+		if (j == i || info->sechdrs[j].sh_info != infosec)
+			continue;
+		if (info->sechdrs[j].sh_type == SHT_REL ||
+		    info->sechdrs[j].sh_type == SHT_RELA)
+			return false;
+	}
+	return true;
+}
+
+struct apply_relocs_work {
+	struct work_struct work;
+	struct module *mod;
+	const struct load_info *info;
+	unsigned int relsec;
+	int ret;
+};
+
+static void apply_relocs_work_fn(struct work_struct *work)
+{
+	struct apply_relocs_work *arw;
+
+	arw = container_of(work, struct apply_relocs_work, work);
+	if (arw->info->sechdrs[arw->relsec].sh_type == SHT_REL)
+		arw->ret = apply_relocate(arw->info->sechdrs, arw->info->strtab,
+					  arw->info->index.sym, arw->relsec,
+					  arw->mod);
+	else
+		arw->ret = apply_relocate_add(arw->info->sechdrs,
+					      arw->info->strtab,
+					      arw->info->index.sym, arw->relsec,
+					      arw->mod);
+}
+
+/*
+ * Large modules carry one relocation section per target section and the
+ * biggest of them spend hundreds of milliseconds in this stage, so
+ * spread the independent sections over the unbound workqueue. Falls
+ * back to the serial loop when there is nothing to win or the scratch
+ * allocation fails.
+ */
+static int apply_relocations_parallel(struct module *mod,
+				      const struct load_info *info,
+				      struct apply_relocs_work *works)
+{
+	unsigned int i, nr = 0;
+	int err = 0;
+
+	for (i = 1; i < info->hdr->e_shnum; i++) {
+		struct apply_relocs_work *arw;
+
+		if (!reloc_section_parallel(info, i))
+			continue;
+
+		arw = &works[nr++];
+		INIT_WORK(&arw->work, apply_relocs_work_fn);
+		arw->mod = mod;
+		arw->info = info;
+		arw->relsec = i;
+		queue_work(system_unbound_wq, &arw->work);
+	}
+
+	for (i = 0; i < nr; i++) {
+		flush_work(&works[i].work);
+		if (works[i].ret < 0 && !err)
+			err = works[i].ret;
+	}
+	return err;
+}
+
 static int apply_relocations(struct module *mod, const struct load_info *info)
 {
-	unsigned int i;
+	struct apply_relocs_work *works = NULL;
+	unsigned int i, nr_parallel = 0;
 	int err = 0;
 
+	if (module_arch_parallel_relocs() && num_online_cpus() > 1) {
+		for (i = 1; i < info->hdr->e_shnum; i++)
+			if (reloc_section_parallel(info, i))
+				nr_parallel++;
+	}
+
+	if (nr_parallel > 1)
+		works = kcalloc(nr_parallel, sizeof(*works), GFP_KERNEL);
+
+	if (works) {
+		err = apply_relocations_parallel(mod, info, works);
+		kfree(works);
+		if (err < 0)
+			return err;
+	}
+
 	/* Now do relocations. */
 	for (i = 1; i < info->hdr->e_shnum; i++) {
 		unsigned int infosec = info->sechdrs[i].sh_info;
@@ -1361,6 +1515,10 @@ static int apply_relocations(struct module *mod, const struct load_info *info)
 		if (!(info->sechdrs[infosec].sh_flags & SHF_ALLOC))
 			continue;
 
+		/* Already applied above */
+		if (works && reloc_section_parallel(info, i))
+			continue;
+
 		if (info->sechdrs[i].sh_flags & SHF_RELA_LIVEPATCH)
 			err = klp_apply_section_relocs(mod, info->sechdrs,
 						       info->secstrings,
@@ -12,6 +12,7 @@
 #define pr_fmt(fmt) "PM: hibernation: " fmt
 
 #include <linux/export.h>
+#include <linux/moduleparam.h>
 #include <linux/suspend.h>
 #include <linux/reboot.h>
 #include <linux/string.h>
@@ -46,6 +47,16 @@ dev_t swsusp_resume_device;
 sector_t swsusp_resume_block;
 __visible int in_suspend __nosavedata;
 
+/*
+ * Compression algorithm to be used for the hibernation image, selectable
+ * via hibernate.compressor=. At resume time the algorithm recorded in
+ * the image header wins.
+ */
+static char hibernate_compressor[CRYPTO_MAX_ALG_NAME] =
+	CONFIG_HIBERNATION_DEF_COMPR;
+
+char hib_comp_algo[CRYPTO_MAX_ALG_NAME];
+
 enum {
 	HIBERNATION_INVALID,
 	HIBERNATION_PLATFORM,
@@ -725,6 +736,16 @@ int hibernate(void)
 		return -EPERM;
 	}
 
+	if (!nocompress) {
+		strscpy(hib_comp_algo, hibernate_compressor,
+			sizeof(hib_comp_algo));
+		if (crypto_has_comp(hib_comp_algo, 0, 0) != 1) {
+			pr_err("%s compression is not available\n",
+			       hib_comp_algo);
+			return -EOPNOTSUPP;
+		}
+	}
+
 	sleep_flags = lock_system_sleep();
 	/* The snapshot device should not be opened while we're running */
 	if (!hibernate_acquire()) {
@@ -759,10 +780,17 @@ int hibernate(void)
 
 		if (hibernation_mode == HIBERNATION_PLATFORM)
 			flags |= SF_PLATFORM_MODE;
-		if (nocompress)
+		if (nocompress) {
 			flags |= SF_NOCOMPRESS_MODE;
-		else
+		} else {
 		        flags |= SF_CRC32_MODE;
+			/*
+			 * The "boot" kernel learns the compressor from the
+			 * image header flags before it reads the image.
+			 */
+			if (!strcmp(hib_comp_algo, COMPRESSION_ALGO_ZSTD))
+				flags |= SF_COMPRESSION_ALG_ZSTD;
+		}
 
 		pm_pr_dbg("Writing hibernation image.\n");
 		error = swsusp_write(flags);
@@ -1356,3 +1384,8 @@ __setup("hibernate=", hibernate_setup);
 __setup("resumewait", resumewait_setup);
 __setup("resumedelay=", resumedelay_setup);
 __setup("nohibernate", nohibernate_setup);
+
+module_param_string(compressor, hibernate_compressor,
+		    sizeof(hibernate_compressor), 0644);
+MODULE_PARM_DESC(compressor,
+		 "Compression algorithm to be used with hibernation");
@@ -6,6 +6,7 @@
 #include <linux/compiler.h>
 #include <linux/cpu.h>
 #include <linux/cpuidle.h>
+#include <linux/crypto.h>
 
 struct swsusp_info {
 	struct new_utsname	uts;
@@ -18,6 +19,13 @@ struct swsusp_info {
 } __aligned(PAGE_SIZE);
 
 #ifdef CONFIG_HIBERNATION
+/* Compression algorithms supported for the hibernation image */
+#define COMPRESSION_ALGO_LZO	"lzo"
+#define COMPRESSION_ALGO_ZSTD	"zstd"
+
+/* Selected at suspend time, or from the image header at resume time */
+extern char hib_comp_algo[CRYPTO_MAX_ALG_NAME];
+
 /* kernel/power/snapshot.c */
 extern void __init hibernate_reserved_size_init(void);
 extern void __init hibernate_image_size_init(void);
@@ -171,6 +179,7 @@ extern int swsusp_swap_in_use(void);
 #define SF_NOCOMPRESS_MODE	2
 #define SF_CRC32_MODE	        4
 #define SF_HW_SIG		8
+#define SF_COMPRESSION_ALG_ZSTD	16
 
 /* kernel/power/hibernate.c */
 extern int swsusp_check(void);
@@ -1587,7 +1587,7 @@ static noinline_for_stack void rcu_gp_fqs_loop(void)
 		gf = RCU_GP_FLAG_OVLD;
 	ret = 0;
 	for (;;) {
-		if (rcu_state.cbovld) {
+		if (rcu_state.cbovld || atomic_read(&rcu_state.gp_urgency)) {
 			j = (j + 2) / 3;
 			if (j <= 0)
 				j = 1;
@@ -2079,7 +2079,7 @@ static void rcu_do_batch(struct rcu_data *rdp)
 	div = READ_ONCE(rcu_divisor);
 	div = div < 0 ? 7 : div > sizeof(long) * 8 - 2 ? sizeof(long) * 8 - 2 : div;
 	bl = max(rdp->blimit, pending >> div);
-	if (in_serving_softirq() && unlikely(bl > 100)) {
+	if (in_serving_softirq()) {
 		long rrn = READ_ONCE(rcu_resched_ns);
 
 		rrn = rrn < NSEC_PER_MSEC ? NSEC_PER_MSEC : rrn > NSEC_PER_SEC ? NSEC_PER_SEC : rrn;
@@ -3044,10 +3044,10 @@ schedule_delayed_monitor_work(struct kfree_rcu_cpu *krcp)
 	if (delayed_work_pending(&krcp->monitor_work)) {
 		delay_left = krcp->monitor_work.timer.expires - jiffies;
 		if (delay < delay_left)
-			mod_delayed_work(system_wq, &krcp->monitor_work, delay);
+			mod_delayed_work(system_unbound_wq, &krcp->monitor_work, delay);
 		return;
 	}
-	queue_delayed_work(system_wq, &krcp->monitor_work, delay);
+	queue_delayed_work(system_unbound_wq, &krcp->monitor_work, delay);
 }
 
 static void
@@ -3139,7 +3139,11 @@ static void kfree_rcu_monitor(struct work_struct *work)
 			// be that the work is in the pending state when
 			// channels have been detached following by each
 			// other.
-			queue_rcu_work(system_wq, &krwp->rcu_work);
+			// Use an unbound workqueue so that large drains are
+			// not serviced by the per-CPU worker of the CPU the
+			// objects were queued on: the scheduler may place
+			// the (NUMA-local) unbound worker on an idle CPU.
+			queue_rcu_work(system_unbound_wq, &krwp->rcu_work);
 		}
 	}
 
@@ -3508,6 +3512,47 @@ void synchronize_rcu(void)
 }
 EXPORT_SYMBOL_GPL(synchronize_rcu);
 
+/**
+ * synchronize_rcu_within - Wait for a grace period within a latency budget
+ * @timeout: Budget in jiffies before escalating to an expedited grace period
+ *
+ * Middle ground between synchronize_rcu() and synchronize_rcu_expedited():
+ * wait for a normal grace period, nudging the grace-period kthread into
+ * more frequent quiescent-state forcing while any budget-bound waiter is
+ * present, and fall back to an expedited grace period only if the normal
+ * one has not completed when the budget expires.  This keeps the IPIs of
+ * the expedited machinery in reserve for the cases that actually need
+ * them.
+ *
+ * A zero @timeout degenerates to synchronize_rcu_expedited().  Like
+ * synchronize_rcu(), this may not be invoked from within a read-side
+ * critical section or with interrupts disabled.
+ */
+void synchronize_rcu_within(unsigned long timeout)
+{
+	unsigned long deadline = jiffies + timeout;
+	unsigned long s;
+
+	if (!timeout) {
+		synchronize_rcu_expedited();
+		return;
+	}
+
+	s = start_poll_synchronize_rcu();
+
+	/* The grace-period kthread notices this on its next fqs round. */
+	atomic_inc(&rcu_state.gp_urgency);
+	while (!poll_state_synchronize_rcu(s) &&
+	       time_before(jiffies, deadline))
+		schedule_timeout_uninterruptible(1);
+	atomic_dec(&rcu_state.gp_urgency);
+
+	/* Budget exhausted, bring out the big hammer. */
+	if (!poll_state_synchronize_rcu(s))
+		synchronize_rcu_expedited();
+}
+EXPORT_SYMBOL_GPL(synchronize_rcu_within);
+
 /**
  * get_completed_synchronize_rcu_full - Return a full pre-completed polled state cookie
  * @rgosp: Place to put state cookie
@@ -213,6 +213,8 @@ module_param(max_cswd_read_retries, ulong, 0644);
 EXPORT_SYMBOL_GPL(max_cswd_read_retries);
 static int verify_n_cpus = 8;
 module_param(verify_n_cpus, int, 0644);
+static int verify_batch_cpus;
+module_param(verify_batch_cpus, int, 0644);
 
 enum wd_read_status {
 	WD_READ_SUCCESS,
@@ -332,30 +334,21 @@ static void clocksource_verify_one_cpu(void *csin)
 	csnow_mid = cs->read(cs);
 }
 
-void clocksource_verify_percpu(struct clocksource *cs)
+/* Serializes the verification machinery shared with the batched checks */
+static DEFINE_MUTEX(clocksource_verify_mutex);
+
+static void clocksource_verify_cpumask(struct clocksource *cs,
+				       const struct cpumask *cpus,
+				       int64_t *cs_nsec_min,
+				       int64_t *cs_nsec_max)
 {
-	int64_t cs_nsec, cs_nsec_max = 0, cs_nsec_min = LLONG_MAX;
 	u64 csnow_begin, csnow_end;
-	int cpu, testcpu;
+	int64_t cs_nsec;
 	s64 delta;
+	int cpu;
 
-	if (verify_n_cpus == 0)
-		return;
-	cpumask_clear(&cpus_ahead);
-	cpumask_clear(&cpus_behind);
-	cpus_read_lock();
-	preempt_disable();
-	clocksource_verify_choose_cpus();
-	if (cpumask_empty(&cpus_chosen)) {
-		preempt_enable();
-		cpus_read_unlock();
-		pr_warn("Not enough CPUs to check clocksource '%s'.\n", cs->name);
-		return;
-	}
-	testcpu = smp_processor_id();
-	pr_warn("Checking clocksource %s synchronization from CPU %d to CPUs %*pbl.\n", cs->name, testcpu, cpumask_pr_args(&cpus_chosen));
-	for_each_cpu(cpu, &cpus_chosen) {
-		if (cpu == testcpu)
+	for_each_cpu(cpu, cpus) {
+		if (cpu == smp_processor_id())
 			continue;
 		csnow_begin = cs->read(cs);
 		smp_call_function_single(cpu, clocksource_verify_one_cpu, cs, 1);
@@ -368,13 +361,16 @@ void clocksource_verify_percpu(struct clocksource *cs)
 			cpumask_set_cpu(cpu, &cpus_ahead);
 		delta = clocksource_delta(csnow_end, csnow_begin, cs->mask);
 		cs_nsec = clocksource_cyc2ns(delta, cs->mult, cs->shift);
-		if (cs_nsec > cs_nsec_max)
-			cs_nsec_max = cs_nsec;
-		if (cs_nsec < cs_nsec_min)
-			cs_nsec_min = cs_nsec;
+		if (cs_nsec > *cs_nsec_max)
+			*cs_nsec_max = cs_nsec;
+		if (cs_nsec < *cs_nsec_min)
+			*cs_nsec_min = cs_nsec;
 	}
-	preempt_enable();
-	cpus_read_unlock();
+}
+
+static void clocksource_verify_report(struct clocksource *cs, int testcpu,
+				      int64_t cs_nsec_min, int64_t cs_nsec_max)
+{
 	if (!cpumask_empty(&cpus_ahead))
 		pr_warn("        CPUs %*pbl ahead of CPU %d for clocksource %s.\n",
 			cpumask_pr_args(&cpus_ahead), testcpu, cs->name);
@@ -385,8 +381,84 @@ void clocksource_verify_percpu(struct clocksource *cs)
 		pr_warn("        CPU %d check durations %lldns - %lldns for clocksource %s.\n",
 			testcpu, cs_nsec_min, cs_nsec_max, cs->name);
 }
+
+void clocksource_verify_percpu(struct clocksource *cs)
+{
+	int64_t cs_nsec_max = 0, cs_nsec_min = LLONG_MAX;
+	int testcpu;
+
+	if (verify_n_cpus == 0)
+		return;
+	mutex_lock(&clocksource_verify_mutex);
+	cpumask_clear(&cpus_ahead);
+	cpumask_clear(&cpus_behind);
+	cpus_read_lock();
+	preempt_disable();
+	clocksource_verify_choose_cpus();
+	if (cpumask_empty(&cpus_chosen)) {
+		preempt_enable();
+		cpus_read_unlock();
+		mutex_unlock(&clocksource_verify_mutex);
+		pr_warn("Not enough CPUs to check clocksource '%s'.\n", cs->name);
+		return;
+	}
+	testcpu = smp_processor_id();
+	pr_warn("Checking clocksource %s synchronization from CPU %d to CPUs %*pbl.\n", cs->name, testcpu, cpumask_pr_args(&cpus_chosen));
+	clocksource_verify_cpumask(cs, &cpus_chosen, &cs_nsec_min, &cs_nsec_max);
+	preempt_enable();
+	cpus_read_unlock();
+	clocksource_verify_report(cs, testcpu, cs_nsec_min, cs_nsec_max);
+	mutex_unlock(&clocksource_verify_mutex);
+}
 EXPORT_SYMBOL_GPL(clocksource_verify_percpu);
 
+/*
+ * Batched background verification: check the next verify_batch_cpus
+ * online CPUs against the current clocksource, continuing where the
+ * previous batch stopped. Each watchdog interval does a bounded amount
+ * of work and coverage of the whole machine emerges across successive
+ * intervals, which keeps the cost acceptable on very large systems.
+ */
+static int verify_batch_rotor;
+
+static void clocksource_verify_batch_work_fn(struct work_struct *work)
+{
+	int64_t cs_nsec_max = 0, cs_nsec_min = LLONG_MAX;
+	struct clocksource *cs = curr_clocksource;
+	int cpu, i, testcpu, n = verify_batch_cpus;
+
+	if (!cs || !(cs->flags & CLOCK_SOURCE_VERIFY_PERCPU) || n <= 0)
+		return;
+
+	mutex_lock(&clocksource_verify_mutex);
+	cpumask_clear(&cpus_ahead);
+	cpumask_clear(&cpus_behind);
+	cpumask_clear(&cpus_chosen);
+	cpus_read_lock();
+	preempt_disable();
+
+	cpu = verify_batch_rotor;
+	for (i = 0; i < n; i++) {
+		cpu = cpumask_next(cpu, cpu_online_mask);
+		if (cpu >= nr_cpu_ids)
+			cpu = cpumask_first(cpu_online_mask);
+		/* Stop early when the batch wraps around the machine */
+		if (cpumask_test_cpu(cpu, &cpus_chosen))
+			break;
+		cpumask_set_cpu(cpu, &cpus_chosen);
+	}
+	verify_batch_rotor = cpu;
+	testcpu = smp_processor_id();
+	cpumask_clear_cpu(testcpu, &cpus_chosen);
+
+	clocksource_verify_cpumask(cs, &cpus_chosen, &cs_nsec_min, &cs_nsec_max);
+	preempt_enable();
+	cpus_read_unlock();
+	clocksource_verify_report(cs, testcpu, cs_nsec_min, cs_nsec_max);
+	mutex_unlock(&clocksource_verify_mutex);
+}
+static DECLARE_WORK(watchdog_verify_work, clocksource_verify_batch_work_fn);
+
 static inline void clocksource_reset_watchdog(void)
 {
 	struct clocksource *cs;
@@ -537,6 +609,15 @@ static void clocksource_watchdog(struct timer_list *unused)
 	if (reset_pending)
 		atomic_dec(&watchdog_reset_pending);
 
+	/*
+	 * Kick off the next bounded batch of cross-CPU synchronization
+	 * checks when the administrator asked for them.
+	 */
+	if (finished_booting && READ_ONCE(verify_batch_cpus) > 0 &&
+	    curr_clocksource &&
+	    (curr_clocksource->flags & CLOCK_SOURCE_VERIFY_PERCPU))
+		schedule_work(&watchdog_verify_work);
+
 	/*
 	 * Cycle through CPUs to check if the CPUs stay synchronized
 	 * to each other.
@@ -41,6 +41,7 @@
 #include <linux/timer.h>
 #include <linux/freezer.h>
 #include <linux/compat.h>
+#include <linux/hash.h>
 
 #include <linux/uaccess.h>
 
@@ -499,6 +500,44 @@ __next_base(struct hrtimer_cpu_base *cpu_base, unsigned int *active)
 #define for_each_active_base(base, cpu_base, active)	\
 	while ((base = __next_base((cpu_base), &(active))))
 
+/*
+ * The shard a timer lives in is a pure function of its expiry time, so
+ * enqueue and dequeue trivially agree on it: node.expires cannot change
+ * while the timer is queued.
+ */
+static inline struct timerqueue_head *
+hrtimer_shard(struct hrtimer_clock_base *base, struct hrtimer *timer)
+{
+	unsigned int idx;
+
+	idx = hash_64(hrtimer_get_expires_tv64(timer), HRTIMER_QUEUE_SHARD_BITS);
+	return &base->active[idx];
+}
+
+/*
+ * Merge the shard heads to find the next expiring timer of @base. If
+ * @exclude is queued on @base it is skipped; the result is then the
+ * earliest of the remaining timers, or NULL if @exclude was the only one.
+ */
+static struct timerqueue_node *
+hrtimer_base_getnext(struct hrtimer_clock_base *base,
+		     const struct hrtimer *exclude)
+{
+	struct timerqueue_node *next = NULL;
+	unsigned int i;
+
+	for (i = 0; i < HRTIMER_QUEUE_SHARDS; i++) {
+		struct timerqueue_node *cand;
+
+		cand = timerqueue_getnext(&base->active[i]);
+		if (cand && exclude && cand == &exclude->node)
+			cand = timerqueue_iterate_next(cand);
+		if (cand && (!next || cand->expires < next->expires))
+			next = cand;
+	}
+	return next;
+}
+
 static ktime_t __hrtimer_next_event_base(struct hrtimer_cpu_base *cpu_base,
 					 const struct hrtimer *exclude,
 					 unsigned int active,
@@ -511,16 +550,11 @@ static ktime_t __hrtimer_next_event_base(struct hrtimer_cpu_base *cpu_base,
 		struct timerqueue_node *next;
 		struct hrtimer *timer;
 
-		next = timerqueue_getnext(&base->active);
-		timer = container_of(next, struct hrtimer, node);
-		if (timer == exclude) {
-			/* Get to the next timer in the queue. */
-			next = timerqueue_iterate_next(next);
-			if (!next)
-				continue;
+		next = hrtimer_base_getnext(base, exclude);
+		if (!next)
+			continue;
 
-			timer = container_of(next, struct hrtimer, node);
-		}
+		timer = container_of(next, struct hrtimer, node);
 		expires = ktime_sub(hrtimer_get_expires(timer), base->offset);
 		if (expires < expires_next) {
 			expires_next = expires;
@@ -912,7 +946,7 @@ static bool update_needs_ipi(struct hrtimer_cpu_base *cpu_base,
 	for_each_active_base(base, cpu_base, active) {
 		struct timerqueue_node *next;
 
-		next = timerqueue_getnext(&base->active);
+		next = hrtimer_base_getnext(base, NULL);
 		expires = ktime_sub(next->expires, base->offset);
 		if (expires < cpu_base->expires_next)
 			return true;
@@ -1072,10 +1106,10 @@ EXPORT_SYMBOL_GPL(hrtimer_forward);
 /*
  * enqueue_hrtimer - internal function to (re)start a timer
  *
- * The timer is inserted in expiry order. Insertion into the
- * red black tree is O(log(n)). Must hold the base lock.
+ * The timer is inserted in expiry order into its expiry shard. Insertion
+ * into the red black tree is O(log(n)). Must hold the base lock.
  *
- * Returns 1 when the new timer is the leftmost timer in the tree.
+ * Returns 1 when the new timer is the first expiring timer of the base.
  */
 static int enqueue_hrtimer(struct hrtimer *timer,
 			   struct hrtimer_clock_base *base,
@@ -1088,7 +1122,9 @@ static int enqueue_hrtimer(struct hrtimer *timer,
 	/* Pairs with the lockless read in hrtimer_is_queued() */
 	WRITE_ONCE(timer->state, HRTIMER_STATE_ENQUEUED);
 
-	return timerqueue_add(&base->active, &timer->node);
+	if (!timerqueue_add(hrtimer_shard(base, timer), &timer->node))
+		return 0;
+	return hrtimer_base_getnext(base, NULL) == &timer->node;
 }
 
 /*
@@ -1113,7 +1149,8 @@ static void __remove_hrtimer(struct hrtimer *timer,
 	if (!(state & HRTIMER_STATE_ENQUEUED))
 		return;
 
-	if (!timerqueue_del(&base->active, &timer->node))
+	if (!timerqueue_del(hrtimer_shard(base, timer), &timer->node) &&
+	    !hrtimer_base_getnext(base, NULL))
 		cpu_base->active_bases &= ~(1 << base->index);
 
 	/*
@@ -1726,7 +1763,7 @@ static void __hrtimer_run_queues(struct hrtimer_cpu_base *cpu_base, ktime_t now,
 
 		basenow = ktime_add(now, base->offset);
 
-		while ((node = timerqueue_getnext(&base->active))) {
+		while ((node = hrtimer_base_getnext(base, NULL))) {
 			struct hrtimer *timer;
 
 			timer = container_of(node, struct hrtimer, node);
@@ -2162,14 +2199,15 @@ SYSCALL_DEFINE2(nanosleep_time32, struct old_timespec32 __user *, rqtp,
 int hrtimers_prepare_cpu(unsigned int cpu)
 {
 	struct hrtimer_cpu_base *cpu_base = &per_cpu(hrtimer_bases, cpu);
-	int i;
+	int i, j;
 
 	for (i = 0; i < HRTIMER_MAX_CLOCK_BASES; i++) {
 		struct hrtimer_clock_base *clock_b = &cpu_base->clock_base[i];
 
 		clock_b->cpu_base = cpu_base;
 		seqcount_raw_spinlock_init(&clock_b->seq, &cpu_base->lock);
-		timerqueue_init_head(&clock_b->active);
+		for (j = 0; j < HRTIMER_QUEUE_SHARDS; j++)
+			timerqueue_init_head(&clock_b->active[j]);
 	}
 
 	cpu_base->cpu = cpu;
@@ -2192,7 +2230,7 @@ static void migrate_hrtimer_list(struct hrtimer_clock_base *old_base,
 	struct hrtimer *timer;
 	struct timerqueue_node *node;
 
-	while ((node = timerqueue_getnext(&old_base->active))) {
+	while ((node = hrtimer_base_getnext(old_base, NULL))) {
 		timer = container_of(node, struct hrtimer, node);
 		BUG_ON(hrtimer_callback_running(timer));
 		debug_deactivate(timer);
@@ -436,6 +436,8 @@ static void trigger_base_recalc_expires(struct k_itimer *timer,
 	struct posix_cputimer_base *base = timer_base(timer, tsk);
 
 	base->nextevt = 0;
+	if (!CPUCLOCK_PERTHREAD(timer->it_clock))
+		WRITE_ONCE(tsk->signal->posix_cputimers.recheck, 0);
 }
 
 /*
@@ -571,10 +573,13 @@ static void arm_timer(struct k_itimer *timer, struct task_struct *p)
 	if (newexp < base->nextevt)
 		base->nextevt = newexp;
 
-	if (CPUCLOCK_PERTHREAD(timer->it_clock))
+	if (CPUCLOCK_PERTHREAD(timer->it_clock)) {
 		tick_dep_set_task(p, TICK_DEP_BIT_POSIX_TIMER);
-	else
+	} else {
+		/* Let the tick fast path resample the group clocks */
+		WRITE_ONCE(p->signal->posix_cputimers.recheck, 0);
 		tick_dep_set_signal(p, TICK_DEP_BIT_POSIX_TIMER);
+	}
 }
 
 /*
@@ -1100,6 +1105,48 @@ task_cputimers_expired(const u64 *samples, struct posix_cputimers *pct)
 	return false;
 }
 
+/*
+ * Group cputime advances by at most num_online_cpus() nanoseconds per
+ * nanosecond of wall time, so the slack between the current samples and
+ * the earliest cached expiry translates into a wall clock horizon before
+ * which the process wide compare in fastpath_timer_check() cannot trip.
+ * Cache that horizon so the common tick in thread-heavy processes gets
+ * away with one plain word read instead of sampling the shared group
+ * cputime atomics.
+ *
+ * The horizon is capped so that a stale update racing against a
+ * concurrent arm_timer() resetting it delays an expiry check by at most
+ * PROCESS_RECHECK_MAX ticks, which is in the same ballpark as the delays
+ * this lockless fast path tolerates anyway.
+ */
+#define PROCESS_RECHECK_MAX	(HZ / 10)
+
+static void update_process_recheck(struct posix_cputimers *pct,
+				   const u64 *samples)
+{
+	u64 slack = U64_MAX;
+	unsigned long delay;
+	int i;
+
+	for (i = 0; i < CPUCLOCK_MAX; i++) {
+		u64 nextevt = READ_ONCE(pct->bases[i].nextevt);
+
+		if (nextevt <= samples[i])
+			return;
+		if (nextevt != U64_MAX)
+			slack = min(slack, nextevt - samples[i]);
+	}
+
+	if (slack == U64_MAX)
+		return;
+
+	delay = min_t(unsigned long,
+		      nsecs_to_jiffies(div_u64(slack, num_online_cpus())),
+		      PROCESS_RECHECK_MAX);
+	if (delay)
+		WRITE_ONCE(pct->recheck, jiffies + delay);
+}
+
 /**
  * fastpath_timer_check - POSIX CPU timers fast path.
  *
@@ -1141,13 +1188,20 @@ static inline bool fastpath_timer_check(struct task_struct *tsk)
 	 * delays with signals actually getting sent are expected.
 	 */
 	if (READ_ONCE(pct->timers_active) && !READ_ONCE(pct->expiry_active)) {
-		u64 samples[CPUCLOCK_MAX];
+		unsigned long recheck = READ_ONCE(pct->recheck);
 
-		proc_sample_cputime_atomic(&sig->cputimer.cputime_atomic,
-					   samples);
+		/* No group timer can have expired before the cached horizon */
+		if (!recheck || !time_before(jiffies, recheck)) {
+			u64 samples[CPUCLOCK_MAX];
 
-		if (task_cputimers_expired(samples, pct))
-			return true;
+			proc_sample_cputime_atomic(&sig->cputimer.cputime_atomic,
+						   samples);
+
+			if (task_cputimers_expired(samples, pct))
+				return true;
+
+			update_process_recheck(pct, samples);
+		}
 	}
 
 	if (dl_task(tsk) && tsk->dl.dl_overrun)
@@ -1436,6 +1490,9 @@ void set_process_cpu_timer(struct task_struct *tsk, unsigned int clkid,
 	if (*newval < *nextevt)
 		*nextevt = *newval;
 
+	/* Let the tick fast path resample the group clocks */
+	WRITE_ONCE(tsk->signal->posix_cputimers.recheck, 0);
+
 	tick_dep_set_signal(tsk, TICK_DEP_BIT_POSIX_TIMER);
 }
 
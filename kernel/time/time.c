@@ -42,6 +42,7 @@
 
 #include <generated/timeconst.h>
 #include "timekeeping.h"
+#include "timekeeping_internal.h"
 
 /*
  * The timezone where the local system is located.  Used as a default by some
@@ -143,6 +144,8 @@ SYSCALL_DEFINE2(gettimeofday, struct __kernel_old_timeval __user *, tv,
 	if (likely(tv != NULL)) {
 		struct timespec64 ts;
 
+		tk_debug_count_slowpath_read(CLOCK_REALTIME);
+
 		ktime_get_real_ts64(&ts);
 		if (put_user(ts.tv_sec, &tv->tv_sec) ||
 		    put_user(ts.tv_nsec / 1000, &tv->tv_usec))
@@ -227,6 +230,8 @@ COMPAT_SYSCALL_DEFINE2(gettimeofday, struct old_timeval32 __user *, tv,
 	if (tv) {
 		struct timespec64 ts;
 
+		tk_debug_count_slowpath_read(CLOCK_REALTIME);
+
 		ktime_get_real_ts64(&ts);
 		if (put_user(ts.tv_sec, &tv->tv_sec) ||
 		    put_user(ts.tv_nsec / 1000, &tv->tv_usec))
@@ -43,6 +43,32 @@ static int __init tk_debug_sleep_time_init(void)
 }
 late_initcall(tk_debug_sleep_time_init);
 
+DEFINE_PER_CPU(unsigned long, tk_vdso_slowpath_reads);
+
+static int tk_debug_vdso_slowpath_show(struct seq_file *s, void *data)
+{
+	unsigned long count, total = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		count = per_cpu(tk_vdso_slowpath_reads, cpu);
+		total += count;
+		if (count)
+			seq_printf(s, "cpu%d %lu\n", cpu, count);
+	}
+	seq_printf(s, "total %lu\n", total);
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(tk_debug_vdso_slowpath);
+
+static int __init tk_debug_vdso_slowpath_init(void)
+{
+	debugfs_create_file("vdso_slowpath", 0444, NULL, NULL,
+			    &tk_debug_vdso_slowpath_fops);
+	return 0;
+}
+late_initcall(tk_debug_vdso_slowpath_init);
+
 void tk_debug_account_sleep_time(const struct timespec64 *t)
 {
 	/* Cap bin index so we don't overflow the array */
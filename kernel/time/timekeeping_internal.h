@@ -3,16 +3,35 @@
 #define _TIMEKEEPING_INTERNAL_H
 
 #include <linux/clocksource.h>
+#include <linux/percpu.h>
 #include <linux/spinlock.h>
 #include <linux/time.h>
+#include <vdso/datapage.h>
 
 /*
  * timekeeping debug functions
  */
 #ifdef CONFIG_DEBUG_FS
 extern void tk_debug_account_sleep_time(const struct timespec64 *t);
+
+DECLARE_PER_CPU(unsigned long, tk_vdso_slowpath_reads);
+
+/*
+ * Count syscall reads of clocks the vDSO can normally serve, so that
+ * workloads silently falling off the vDSO fast path show up in the
+ * vdso_slowpath debugfs file.
+ */
+static inline void tk_debug_count_slowpath_read(clockid_t which_clock)
+{
+	if ((unsigned int)which_clock < BITS_PER_LONG &&
+	    (BIT(which_clock) & (VDSO_HRES | VDSO_COARSE | VDSO_RAW)))
+		this_cpu_inc(tk_vdso_slowpath_reads);
+}
 #else
 #define tk_debug_account_sleep_time(x)
+static inline void tk_debug_count_slowpath_read(clockid_t which_clock)
+{
+}
 #endif
 
 #ifdef CONFIG_CLOCKSOURCE_VALIDATE_LAST_CYCLE
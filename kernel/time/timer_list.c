@@ -58,7 +58,7 @@ print_timer(struct seq_file *m, struct hrtimer *taddr, struct hrtimer *timer,
 
 static void
 print_active_timers(struct seq_file *m, struct hrtimer_clock_base *base,
-		    u64 now)
+		    unsigned int shard, u64 now)
 {
 	struct hrtimer *timer, tmp;
 	unsigned long next = 0, i;
@@ -72,7 +72,7 @@ next_one:
 
 	raw_spin_lock_irqsave(&base->cpu_base->lock, flags);
 
-	curr = timerqueue_getnext(&base->active);
+	curr = timerqueue_getnext(&base->active[shard]);
 	/*
 	 * Crude but we have to do this O(N*N) thing, because
 	 * we have to unlock the base when printing:
@@ -98,6 +98,8 @@ next_one:
 static void
 print_base(struct seq_file *m, struct hrtimer_clock_base *base, u64 now)
 {
+	unsigned int i;
+
 	SEQ_printf(m, "  .base:       %pK\n", base);
 	SEQ_printf(m, "  .index:      %d\n", base->index);
 
@@ -109,7 +111,9 @@ print_base(struct seq_file *m, struct hrtimer_clock_base *base, u64 now)
 		   (unsigned long long) ktime_to_ns(base->offset));
 #endif
 	SEQ_printf(m,   "active timers:\n");
-	print_active_timers(m, base, now + ktime_to_ns(base->offset));
+	/* Timers are sorted within a shard, not across shards */
+	for (i = 0; i < HRTIMER_QUEUE_SHARDS; i++)
+		print_active_timers(m, base, i, now + ktime_to_ns(base->offset));
 }
 
 static void print_cpu(struct seq_file *m, int cpu, u64 now)
@@ -26,6 +26,20 @@ EXPORT_SYMBOL(raid6_empty_zero_page);
 struct raid6_calls raid6_call;
 EXPORT_SYMBOL_GPL(raid6_call);
 
+void raid6_gen_syndrome_batch(int disks, size_t bytes, void ***stripes,
+			      int nstripes)
+{
+	int i;
+
+	if (raid6_call.gen_syndrome_batch) {
+		raid6_call.gen_syndrome_batch(disks, bytes, stripes, nstripes);
+		return;
+	}
+	for (i = 0; i < nstripes; i++)
+		raid6_call.gen_syndrome(disks, bytes, stripes[i]);
+}
+EXPORT_SYMBOL_GPL(raid6_gen_syndrome_batch);
+
 const struct raid6_calls * const raid6_algos[] = {
 #if defined(__i386__) && !defined(__arch_um__)
 #ifdef CONFIG_AS_AVX512
@@ -90,6 +104,31 @@ EXPORT_SYMBOL_GPL(raid6_2data_recov);
 void (*raid6_datap_recov)(int, size_t, int, void **);
 EXPORT_SYMBOL_GPL(raid6_datap_recov);
 
+void (*raid6_2data_recov_batch)(int, size_t, int, int, void ***, int);
+EXPORT_SYMBOL_GPL(raid6_2data_recov_batch);
+
+void (*raid6_datap_recov_batch)(int, size_t, int, void ***, int);
+EXPORT_SYMBOL_GPL(raid6_datap_recov_batch);
+
+/* Batch fallbacks for recovery routine sets without a batch kernel */
+static void raid6_2data_recov_loop(int disks, size_t bytes, int faila,
+				   int failb, void ***stripes, int nstripes)
+{
+	int i;
+
+	for (i = 0; i < nstripes; i++)
+		raid6_2data_recov(disks, bytes, faila, failb, stripes[i]);
+}
+
+static void raid6_datap_recov_loop(int disks, size_t bytes, int faila,
+				   void ***stripes, int nstripes)
+{
+	int i;
+
+	for (i = 0; i < nstripes; i++)
+		raid6_datap_recov(disks, bytes, faila, stripes[i]);
+}
+
 const struct raid6_recov_calls *const raid6_recov_algos[] = {
 #ifdef CONFIG_X86
 #ifdef CONFIG_AS_AVX512
@@ -132,6 +171,10 @@ static inline const struct raid6_recov_calls *raid6_choose_recov(void)
 	if (best) {
 		raid6_2data_recov = best->data2;
 		raid6_datap_recov = best->datap;
+		raid6_2data_recov_batch = best->data2_batch ?
+			best->data2_batch : raid6_2data_recov_loop;
+		raid6_datap_recov_batch = best->datap_batch ?
+			best->datap_batch : raid6_datap_recov_loop;
 
 		pr_info("raid6: using %s recovery algorithm\n", best->name);
 	} else
@@ -31,7 +31,8 @@ static int raid6_have_avx2(void)
 /*
  * Plain AVX2 implementation
  */
-static void raid6_avx21_gen_syndrome(int disks, size_t bytes, void **ptrs)
+static void raid6_avx21_gen_syndrome_inner(int disks, size_t bytes,
+					   void **ptrs)
 {
 	u8 **dptr = (u8 **)ptrs;
 	u8 *p, *q;
@@ -41,8 +42,6 @@ static void raid6_avx21_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	p = dptr[z0+1];		/* XOR parity */
 	q = dptr[z0+2];		/* RS syndrome */
 
-	kernel_fpu_begin();
-
 	asm volatile("vmovdqa %0,%%ymm0" : : "m" (raid6_avx2_constants.x1d[0]));
 	asm volatile("vpxor %ymm3,%ymm3,%ymm3");	/* Zero temp */
 
@@ -76,9 +75,32 @@ static void raid6_avx21_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	}
 
 	asm volatile("sfence" : : : "memory");
+}
+
+static void raid6_avx21_gen_syndrome(int disks, size_t bytes, void **ptrs)
+{
+	kernel_fpu_begin();
+	raid6_avx21_gen_syndrome_inner(disks, bytes, ptrs);
 	kernel_fpu_end();
 }
 
+static void raid6_avx21_gen_syndrome_batch(int disks, size_t bytes,
+					   void ***stripes, int nstripes)
+{
+	int i, j, n;
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_avx21_gen_syndrome_inner(disks, bytes,
+						       stripes[i + j]);
+		kernel_fpu_end();
+	}
+}
+
 static void raid6_avx21_xor_syndrome(int disks, int start, int stop,
 				     size_t bytes, void **ptrs)
 {
@@ -132,13 +154,15 @@ const struct raid6_calls raid6_avx2x1 = {
 	raid6_avx21_xor_syndrome,
 	raid6_have_avx2,
 	"avx2x1",
-	.priority = 2		/* Prefer AVX2 over priority 1 (SSE2 and others) */
+	.priority = 2,		/* Prefer AVX2 over priority 1 (SSE2 and others) */
+	.gen_syndrome_batch = raid6_avx21_gen_syndrome_batch,
 };
 
 /*
  * Unrolled-by-2 AVX2 implementation
  */
-static void raid6_avx22_gen_syndrome(int disks, size_t bytes, void **ptrs)
+static void raid6_avx22_gen_syndrome_inner(int disks, size_t bytes,
+					   void **ptrs)
 {
 	u8 **dptr = (u8 **)ptrs;
 	u8 *p, *q;
@@ -148,8 +172,6 @@ static void raid6_avx22_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	p = dptr[z0+1];		/* XOR parity */
 	q = dptr[z0+2];		/* RS syndrome */
 
-	kernel_fpu_begin();
-
 	asm volatile("vmovdqa %0,%%ymm0" : : "m" (raid6_avx2_constants.x1d[0]));
 	asm volatile("vpxor %ymm1,%ymm1,%ymm1"); /* Zero temp */
 
@@ -186,9 +208,32 @@ static void raid6_avx22_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	}
 
 	asm volatile("sfence" : : : "memory");
+}
+
+static void raid6_avx22_gen_syndrome(int disks, size_t bytes, void **ptrs)
+{
+	kernel_fpu_begin();
+	raid6_avx22_gen_syndrome_inner(disks, bytes, ptrs);
 	kernel_fpu_end();
 }
 
+static void raid6_avx22_gen_syndrome_batch(int disks, size_t bytes,
+					   void ***stripes, int nstripes)
+{
+	int i, j, n;
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_avx22_gen_syndrome_inner(disks, bytes,
+						       stripes[i + j]);
+		kernel_fpu_end();
+	}
+}
+
 static void raid6_avx22_xor_syndrome(int disks, int start, int stop,
 				     size_t bytes, void **ptrs)
 {
@@ -262,7 +307,8 @@ const struct raid6_calls raid6_avx2x2 = {
 	raid6_avx22_xor_syndrome,
 	raid6_have_avx2,
 	"avx2x2",
-	.priority = 2		/* Prefer AVX2 over priority 1 (SSE2 and others) */
+	.priority = 2,		/* Prefer AVX2 over priority 1 (SSE2 and others) */
+	.gen_syndrome_batch = raid6_avx22_gen_syndrome_batch,
 };
 
 #ifdef CONFIG_X86_64
@@ -270,7 +316,8 @@ const struct raid6_calls raid6_avx2x2 = {
 /*
  * Unrolled-by-4 AVX2 implementation
  */
-static void raid6_avx24_gen_syndrome(int disks, size_t bytes, void **ptrs)
+static void raid6_avx24_gen_syndrome_inner(int disks, size_t bytes,
+					   void **ptrs)
 {
 	u8 **dptr = (u8 **)ptrs;
 	u8 *p, *q;
@@ -280,8 +327,6 @@ static void raid6_avx24_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	p = dptr[z0+1];		/* XOR parity */
 	q = dptr[z0+2];		/* RS syndrome */
 
-	kernel_fpu_begin();
-
 	asm volatile("vmovdqa %0,%%ymm0" : : "m" (raid6_avx2_constants.x1d[0]));
 	asm volatile("vpxor %ymm1,%ymm1,%ymm1");	/* Zero temp */
 	asm volatile("vpxor %ymm2,%ymm2,%ymm2");	/* P[0] */
@@ -347,9 +392,32 @@ static void raid6_avx24_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	}
 
 	asm volatile("sfence" : : : "memory");
+}
+
+static void raid6_avx24_gen_syndrome(int disks, size_t bytes, void **ptrs)
+{
+	kernel_fpu_begin();
+	raid6_avx24_gen_syndrome_inner(disks, bytes, ptrs);
 	kernel_fpu_end();
 }
 
+static void raid6_avx24_gen_syndrome_batch(int disks, size_t bytes,
+					   void ***stripes, int nstripes)
+{
+	int i, j, n;
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_avx24_gen_syndrome_inner(disks, bytes,
+						       stripes[i + j]);
+		kernel_fpu_end();
+	}
+}
+
 static void raid6_avx24_xor_syndrome(int disks, int start, int stop,
 				     size_t bytes, void **ptrs)
 {
@@ -465,6 +533,7 @@ const struct raid6_calls raid6_avx2x4 = {
 	raid6_avx24_xor_syndrome,
 	raid6_have_avx2,
 	"avx2x4",
-	.priority = 2		/* Prefer AVX2 over priority 1 (SSE2 and others) */
+	.priority = 2,		/* Prefer AVX2 over priority 1 (SSE2 and others) */
+	.gen_syndrome_batch = raid6_avx24_gen_syndrome_batch,
 };
 #endif /* CONFIG_X86_64 */
@@ -41,7 +41,8 @@ static int raid6_have_avx512(void)
 		boot_cpu_has(X86_FEATURE_AVX512DQ);
 }
 
-static void raid6_avx5121_gen_syndrome(int disks, size_t bytes, void **ptrs)
+static void raid6_avx5121_gen_syndrome_inner(int disks, size_t bytes,
+					     void **ptrs)
 {
 	u8 **dptr = (u8 **)ptrs;
 	u8 *p, *q;
@@ -51,8 +52,6 @@ static void raid6_avx5121_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	p = dptr[z0+1];         /* XOR parity */
 	q = dptr[z0+2];         /* RS syndrome */
 
-	kernel_fpu_begin();
-
 	asm volatile("vmovdqa64 %0,%%zmm0\n\t"
 		     "vpxorq %%zmm1,%%zmm1,%%zmm1" /* Zero temp */
 		     :
@@ -95,9 +94,32 @@ static void raid6_avx5121_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	}
 
 	asm volatile("sfence" : : : "memory");
+}
+
+static void raid6_avx5121_gen_syndrome(int disks, size_t bytes, void **ptrs)
+{
+	kernel_fpu_begin();
+	raid6_avx5121_gen_syndrome_inner(disks, bytes, ptrs);
 	kernel_fpu_end();
 }
 
+static void raid6_avx5121_gen_syndrome_batch(int disks, size_t bytes,
+					     void ***stripes, int nstripes)
+{
+	int i, j, n;
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_avx5121_gen_syndrome_inner(disks, bytes,
+							 stripes[i + j]);
+		kernel_fpu_end();
+	}
+}
+
 static void raid6_avx5121_xor_syndrome(int disks, int start, int stop,
 				       size_t bytes, void **ptrs)
 {
@@ -162,13 +184,15 @@ const struct raid6_calls raid6_avx512x1 = {
 	raid6_avx5121_xor_syndrome,
 	raid6_have_avx512,
 	"avx512x1",
-	.priority = 2		/* Prefer AVX512 over priority 1 (SSE2 and others) */
+	.priority = 2,		/* Prefer AVX512 over priority 1 (SSE2 and others) */
+	.gen_syndrome_batch = raid6_avx5121_gen_syndrome_batch,
 };
 
 /*
  * Unrolled-by-2 AVX512 implementation
  */
-static void raid6_avx5122_gen_syndrome(int disks, size_t bytes, void **ptrs)
+static void raid6_avx5122_gen_syndrome_inner(int disks, size_t bytes,
+					     void **ptrs)
 {
 	u8 **dptr = (u8 **)ptrs;
 	u8 *p, *q;
@@ -178,8 +202,6 @@ static void raid6_avx5122_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	p = dptr[z0+1];         /* XOR parity */
 	q = dptr[z0+2];         /* RS syndrome */
 
-	kernel_fpu_begin();
-
 	asm volatile("vmovdqa64 %0,%%zmm0\n\t"
 		     "vpxorq %%zmm1,%%zmm1,%%zmm1" /* Zero temp */
 		     :
@@ -227,9 +249,32 @@ static void raid6_avx5122_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	}
 
 	asm volatile("sfence" : : : "memory");
+}
+
+static void raid6_avx5122_gen_syndrome(int disks, size_t bytes, void **ptrs)
+{
+	kernel_fpu_begin();
+	raid6_avx5122_gen_syndrome_inner(disks, bytes, ptrs);
 	kernel_fpu_end();
 }
 
+static void raid6_avx5122_gen_syndrome_batch(int disks, size_t bytes,
+					     void ***stripes, int nstripes)
+{
+	int i, j, n;
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_avx5122_gen_syndrome_inner(disks, bytes,
+							 stripes[i + j]);
+		kernel_fpu_end();
+	}
+}
+
 static void raid6_avx5122_xor_syndrome(int disks, int start, int stop,
 				       size_t bytes, void **ptrs)
 {
@@ -319,7 +364,8 @@ const struct raid6_calls raid6_avx512x2 = {
 	raid6_avx5122_xor_syndrome,
 	raid6_have_avx512,
 	"avx512x2",
-	.priority = 2		/* Prefer AVX512 over priority 1 (SSE2 and others) */
+	.priority = 2,		/* Prefer AVX512 over priority 1 (SSE2 and others) */
+	.gen_syndrome_batch = raid6_avx5122_gen_syndrome_batch,
 };
 
 #ifdef CONFIG_X86_64
@@ -327,7 +373,8 @@ const struct raid6_calls raid6_avx512x2 = {
 /*
  * Unrolled-by-4 AVX2 implementation
  */
-static void raid6_avx5124_gen_syndrome(int disks, size_t bytes, void **ptrs)
+static void raid6_avx5124_gen_syndrome_inner(int disks, size_t bytes,
+					     void **ptrs)
 {
 	u8 **dptr = (u8 **)ptrs;
 	u8 *p, *q;
@@ -337,8 +384,6 @@ static void raid6_avx5124_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	p = dptr[z0+1];         /* XOR parity */
 	q = dptr[z0+2];         /* RS syndrome */
 
-	kernel_fpu_begin();
-
 	asm volatile("vmovdqa64 %0,%%zmm0\n\t"
 		     "vpxorq %%zmm1,%%zmm1,%%zmm1\n\t"       /* Zero temp */
 		     "vpxorq %%zmm2,%%zmm2,%%zmm2\n\t"       /* P[0] */
@@ -417,9 +462,32 @@ static void raid6_avx5124_gen_syndrome(int disks, size_t bytes, void **ptrs)
 	}
 
 	asm volatile("sfence" : : : "memory");
+}
+
+static void raid6_avx5124_gen_syndrome(int disks, size_t bytes, void **ptrs)
+{
+	kernel_fpu_begin();
+	raid6_avx5124_gen_syndrome_inner(disks, bytes, ptrs);
 	kernel_fpu_end();
 }
 
+static void raid6_avx5124_gen_syndrome_batch(int disks, size_t bytes,
+					     void ***stripes, int nstripes)
+{
+	int i, j, n;
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_avx5124_gen_syndrome_inner(disks, bytes,
+							 stripes[i + j]);
+		kernel_fpu_end();
+	}
+}
+
 static void raid6_avx5124_xor_syndrome(int disks, int start, int stop,
 				       size_t bytes, void **ptrs)
 {
@@ -557,7 +625,8 @@ const struct raid6_calls raid6_avx512x4 = {
 	raid6_avx5124_xor_syndrome,
 	raid6_have_avx512,
 	"avx512x4",
-	.priority = 2		/* Prefer AVX512 over priority 1 (SSE2 and others) */
+	.priority = 2,		/* Prefer AVX512 over priority 1 (SSE2 and others) */
+	.gen_syndrome_batch = raid6_avx5124_gen_syndrome_batch,
 };
 #endif
 
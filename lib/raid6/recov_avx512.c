@@ -21,46 +21,17 @@ static int raid6_has_avx512(void)
 		boot_cpu_has(X86_FEATURE_AVX512DQ);
 }
 
-static void raid6_2data_recov_avx512(int disks, size_t bytes, int faila,
-				     int failb, void **ptrs)
+/*
+ * Multiply-fix loop for the two dead data pages, shared by the
+ * single-stripe and batched entry points; the caller owns the
+ * kernel_fpu section.
+ */
+static void raid6_2data_fix_avx512(size_t bytes, u8 *p, u8 *q, u8 *dp,
+				   u8 *dq, const u8 *pbmul, const u8 *qmul)
 {
-	u8 *p, *q, *dp, *dq;
-	const u8 *pbmul;	/* P multiplier table for B data */
-	const u8 *qmul;		/* Q multiplier table (for both) */
 	const u8 x0f = 0x0f;
 
-	p = (u8 *)ptrs[disks-2];
-	q = (u8 *)ptrs[disks-1];
-
-	/*
-	 * Compute syndrome with zero for the missing data pages
-	 * Use the dead data pages as temporary storage for
-	 * delta p and delta q
-	 */
-
-	dp = (u8 *)ptrs[faila];
-	ptrs[faila] = (void *)raid6_empty_zero_page;
-	ptrs[disks-2] = dp;
-	dq = (u8 *)ptrs[failb];
-	ptrs[failb] = (void *)raid6_empty_zero_page;
-	ptrs[disks-1] = dq;
-
-	raid6_call.gen_syndrome(disks, bytes, ptrs);
-
-	/* Restore pointer table */
-	ptrs[faila]   = dp;
-	ptrs[failb]   = dq;
-	ptrs[disks-2] = p;
-	ptrs[disks-1] = q;
-
-	/* Now, pick the proper data tables */
-	pbmul = raid6_vgfmul[raid6_gfexi[failb-faila]];
-	qmul  = raid6_vgfmul[raid6_gfinv[raid6_gfexp[faila] ^
-		raid6_gfexp[failb]]];
-
-	kernel_fpu_begin();
-
-	/* zmm0 = x0f[16] */
+	/* zmm7 = x0f[16] */
 	asm volatile("vpbroadcastb %0, %%zmm7" : : "m" (x0f));
 
 	while (bytes) {
@@ -220,39 +191,112 @@ static void raid6_2data_recov_avx512(int disks, size_t bytes, int faila,
 		dq += 64;
 #endif
 	}
-
-	kernel_fpu_end();
 }
 
-static void raid6_datap_recov_avx512(int disks, size_t bytes, int faila,
-				     void **ptrs)
+static void raid6_2data_recov_avx512(int disks, size_t bytes, int faila,
+				     int failb, void **ptrs)
 {
-	u8 *p, *q, *dq;
-	const u8 *qmul;		/* Q multiplier table */
-	const u8 x0f = 0x0f;
+	u8 *p, *q, *dp, *dq;
+	const u8 *pbmul;	/* P multiplier table for B data */
+	const u8 *qmul;		/* Q multiplier table (for both) */
 
 	p = (u8 *)ptrs[disks-2];
 	q = (u8 *)ptrs[disks-1];
 
 	/*
-	 * Compute syndrome with zero for the missing data page
-	 * Use the dead data page as temporary storage for delta q
+	 * Compute syndrome with zero for the missing data pages
+	 * Use the dead data pages as temporary storage for
+	 * delta p and delta q
 	 */
 
-	dq = (u8 *)ptrs[faila];
+	dp = (u8 *)ptrs[faila];
 	ptrs[faila] = (void *)raid6_empty_zero_page;
+	ptrs[disks-2] = dp;
+	dq = (u8 *)ptrs[failb];
+	ptrs[failb] = (void *)raid6_empty_zero_page;
 	ptrs[disks-1] = dq;
 
 	raid6_call.gen_syndrome(disks, bytes, ptrs);
 
 	/* Restore pointer table */
-	ptrs[faila]   = dq;
+	ptrs[faila]   = dp;
+	ptrs[failb]   = dq;
+	ptrs[disks-2] = p;
 	ptrs[disks-1] = q;
 
 	/* Now, pick the proper data tables */
-	qmul  = raid6_vgfmul[raid6_gfinv[raid6_gfexp[faila]]];
+	pbmul = raid6_vgfmul[raid6_gfexi[failb-faila]];
+	qmul  = raid6_vgfmul[raid6_gfinv[raid6_gfexp[faila] ^
+		raid6_gfexp[failb]]];
 
 	kernel_fpu_begin();
+	raid6_2data_fix_avx512(bytes, p, q, dp, dq, pbmul, qmul);
+	kernel_fpu_end();
+}
+
+static void raid6_2data_recov_avx512_batch(int disks, size_t bytes,
+					   int faila, int failb,
+					   void ***stripes, int nstripes)
+{
+	u8 *p[RAID6_BATCH_STRIPES_PER_FPU], *q[RAID6_BATCH_STRIPES_PER_FPU];
+	u8 *dp[RAID6_BATCH_STRIPES_PER_FPU], *dq[RAID6_BATCH_STRIPES_PER_FPU];
+	const u8 *pbmul;	/* P multiplier table for B data */
+	const u8 *qmul;		/* Q multiplier table (for both) */
+	int i, j, n;
+
+	/* The failed disks are common to all stripes of the batch */
+	pbmul = raid6_vgfmul[raid6_gfexi[failb-faila]];
+	qmul  = raid6_vgfmul[raid6_gfinv[raid6_gfexp[faila] ^
+		raid6_gfexp[failb]]];
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+
+		/* Syndromes of the chunk, with the dead pages zeroed */
+		for (j = 0; j < n; j++) {
+			void **ptrs = stripes[i + j];
+
+			p[j] = (u8 *)ptrs[disks-2];
+			q[j] = (u8 *)ptrs[disks-1];
+			dp[j] = (u8 *)ptrs[faila];
+			ptrs[faila] = (void *)raid6_empty_zero_page;
+			ptrs[disks-2] = dp[j];
+			dq[j] = (u8 *)ptrs[failb];
+			ptrs[failb] = (void *)raid6_empty_zero_page;
+			ptrs[disks-1] = dq[j];
+		}
+
+		raid6_gen_syndrome_batch(disks, bytes, &stripes[i], n);
+
+		/* Restore pointer tables */
+		for (j = 0; j < n; j++) {
+			void **ptrs = stripes[i + j];
+
+			ptrs[faila]   = dp[j];
+			ptrs[failb]   = dq[j];
+			ptrs[disks-2] = p[j];
+			ptrs[disks-1] = q[j];
+		}
+
+		/* One FPU section fixes the whole chunk */
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_2data_fix_avx512(bytes, p[j], q[j], dp[j],
+					       dq[j], pbmul, qmul);
+		kernel_fpu_end();
+	}
+}
+
+/*
+ * Multiply-fix loop for the dead data page, shared by the single-stripe
+ * and batched entry points; the caller owns the kernel_fpu section.
+ */
+static void raid6_datap_fix_avx512(size_t bytes, u8 *p, u8 *q, u8 *dq,
+				   const u8 *qmul)
+{
+	const u8 x0f = 0x0f;
 
 	asm volatile("vpbroadcastb %0, %%zmm7" : : "m" (x0f));
 
@@ -362,14 +406,93 @@ static void raid6_datap_recov_avx512(int disks, size_t bytes, int faila,
 		dq += 64;
 #endif
 	}
+}
+
+static void raid6_datap_recov_avx512(int disks, size_t bytes, int faila,
+				     void **ptrs)
+{
+	u8 *p, *q, *dq;
+	const u8 *qmul;		/* Q multiplier table */
 
+	p = (u8 *)ptrs[disks-2];
+	q = (u8 *)ptrs[disks-1];
+
+	/*
+	 * Compute syndrome with zero for the missing data page
+	 * Use the dead data page as temporary storage for delta q
+	 */
+
+	dq = (u8 *)ptrs[faila];
+	ptrs[faila] = (void *)raid6_empty_zero_page;
+	ptrs[disks-1] = dq;
+
+	raid6_call.gen_syndrome(disks, bytes, ptrs);
+
+	/* Restore pointer table */
+	ptrs[faila]   = dq;
+	ptrs[disks-1] = q;
+
+	/* Now, pick the proper data tables */
+	qmul  = raid6_vgfmul[raid6_gfinv[raid6_gfexp[faila]]];
+
+	kernel_fpu_begin();
+	raid6_datap_fix_avx512(bytes, p, q, dq, qmul);
 	kernel_fpu_end();
 }
 
+static void raid6_datap_recov_avx512_batch(int disks, size_t bytes,
+					   int faila, void ***stripes,
+					   int nstripes)
+{
+	u8 *p[RAID6_BATCH_STRIPES_PER_FPU], *q[RAID6_BATCH_STRIPES_PER_FPU];
+	u8 *dq[RAID6_BATCH_STRIPES_PER_FPU];
+	const u8 *qmul;		/* Q multiplier table */
+	int i, j, n;
+
+	/* The failed disk is common to all stripes of the batch */
+	qmul  = raid6_vgfmul[raid6_gfinv[raid6_gfexp[faila]]];
+
+	for (i = 0; i < nstripes; i += n) {
+		n = nstripes - i;
+		if (n > RAID6_BATCH_STRIPES_PER_FPU)
+			n = RAID6_BATCH_STRIPES_PER_FPU;
+
+		/* Syndromes of the chunk, with the dead page zeroed */
+		for (j = 0; j < n; j++) {
+			void **ptrs = stripes[i + j];
+
+			p[j] = (u8 *)ptrs[disks-2];
+			q[j] = (u8 *)ptrs[disks-1];
+			dq[j] = (u8 *)ptrs[faila];
+			ptrs[faila] = (void *)raid6_empty_zero_page;
+			ptrs[disks-1] = dq[j];
+		}
+
+		raid6_gen_syndrome_batch(disks, bytes, &stripes[i], n);
+
+		/* Restore pointer tables */
+		for (j = 0; j < n; j++) {
+			void **ptrs = stripes[i + j];
+
+			ptrs[faila]   = dq[j];
+			ptrs[disks-1] = q[j];
+		}
+
+		/* One FPU section fixes the whole chunk */
+		kernel_fpu_begin();
+		for (j = 0; j < n; j++)
+			raid6_datap_fix_avx512(bytes, p[j], q[j], dq[j],
+					       qmul);
+		kernel_fpu_end();
+	}
+}
+
 const struct raid6_recov_calls raid6_recov_avx512 = {
 	.data2 = raid6_2data_recov_avx512,
 	.datap = raid6_datap_recov_avx512,
 	.valid = raid6_has_avx512,
+	.data2_batch = raid6_2data_recov_avx512_batch,
+	.datap_batch = raid6_datap_recov_avx512_batch,
 #ifdef CONFIG_X86_64
 	.name = "avx512x2",
 #else
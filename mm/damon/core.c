@@ -6,13 +6,17 @@
  */
 
 #define pr_fmt(fmt) "damon: " fmt
+#define MODULE_PARAM_PREFIX "damon."
 
 #include <linux/damon.h>
 #include <linux/delay.h>
 #include <linux/kthread.h>
+#include <linux/math64.h>
 #include <linux/mm.h>
+#include <linux/moduleparam.h>
 #include <linux/slab.h>
 #include <linux/string.h>
+#include <linux/workqueue.h>
 
 #define CREATE_TRACE_POINTS
 #include <trace/events/damon.h>
@@ -132,6 +136,8 @@ struct damon_region *damon_new_region(unsigned long start, unsigned long end)
 
 	region->age = 0;
 	region->last_nr_accesses = 0;
+	region->sample_skips = 0;
+	region->last_sampled_young = false;
 
 	return region;
 }
@@ -324,6 +330,9 @@ struct damos *damon_new_scheme(struct damos_access_pattern *pattern,
 	INIT_LIST_HEAD(&scheme->filters);
 	scheme->stat = (struct damos_stat){};
 	INIT_LIST_HEAD(&scheme->list);
+	atomic_long_set(&scheme->bg_sz_applied, 0);
+	atomic_long_set(&scheme->bg_nr_applied, 0);
+	atomic64_set(&scheme->bg_charged_ns, 0);
 
 	scheme->quota = *(damos_quota_init_priv(quota));
 
@@ -348,10 +357,15 @@ static void damon_free_scheme(struct damos *s)
 	kfree(s);
 }
 
+static void damos_bg_drain(void);
+
 void damon_destroy_scheme(struct damos *s)
 {
 	struct damos_filter *f, *next;
 
+	/* Background workers might still reference the scheme */
+	damos_bg_drain();
+
 	damos_for_each_filter_safe(f, next, s)
 		damos_destroy_filter(f);
 	damon_del_scheme(s);
@@ -765,6 +779,9 @@ static void kdamond_reset_aggregated(struct damon_ctx *c)
 	struct damon_target *t;
 	unsigned int ti = 0;	/* target's index */
 
+	/* report the results to the binary stream before the reset */
+	damon_stream_report(c);
+
 	damon_for_each_target(t, c) {
 		struct damon_region *r;
 
@@ -865,6 +882,134 @@ static bool damos_skip_charged_region(struct damon_target *t,
 	return false;
 }
 
+/*
+ * DAMOS background action executor
+ *
+ * Applying an expensive action like pageout to a large region from the
+ * kdamond context stalls monitoring for the duration of the action.  When
+ * enabled via the damon.damos_bg_exec parameter, kdamond instead enqueues the
+ * action on an unbound workqueue, queued on the node holding the region for
+ * the physical address space operations, and continues with the next sampling
+ * interval.  The workers report the applied sizes and the consumed time back
+ * via the scheme's atomic feedback counters, which kdamond folds into the
+ * quota accounting and the statistics once per scheme application pass.
+ */
+static bool damos_bg_exec __read_mostly;
+module_param(damos_bg_exec, bool, 0600);
+
+/* Throughput limit for background actions in MiB/s.  Zero means no limit. */
+static unsigned long damos_bg_mbps __read_mostly;
+module_param(damos_bg_mbps, ulong, 0600);
+
+static struct workqueue_struct *damos_bg_wq __read_mostly;
+
+struct damos_bg_work {
+	struct work_struct work;
+	struct damon_ctx *ctx;
+	struct damon_target *t;
+	struct damos *s;
+	struct damon_addr_range ar;
+	unsigned int nr_accesses;
+	unsigned int age;
+};
+
+static void damos_bg_work_fn(struct work_struct *work)
+{
+	struct damos_bg_work *w = container_of(work, struct damos_bg_work,
+			work);
+	struct timespec64 begin, end;
+	struct damon_region *r;
+	unsigned long sz_applied;
+	u64 elapsed;
+
+	/*
+	 * The scheme might have split or merged the original region since the
+	 * work was queued, so apply the action on a detached copy.
+	 */
+	r = damon_new_region(w->ar.start, w->ar.end);
+	if (!r)
+		goto out;
+	r->nr_accesses = w->nr_accesses;
+	r->age = w->age;
+
+	ktime_get_coarse_ts64(&begin);
+	sz_applied = w->ctx->ops.apply_scheme(w->ctx, w->t, r, w->s);
+	ktime_get_coarse_ts64(&end);
+	elapsed = timespec64_to_ns(&end) - timespec64_to_ns(&begin);
+
+	if (sz_applied) {
+		atomic_long_inc(&w->s->bg_nr_applied);
+		atomic_long_add(sz_applied, &w->s->bg_sz_applied);
+	}
+	atomic64_add(elapsed, &w->s->bg_charged_ns);
+
+	damon_free_region(r);
+
+	if (damos_bg_mbps) {
+		u64 min_ns = div_u64((u64)(w->ar.end - w->ar.start) *
+				NSEC_PER_SEC, damos_bg_mbps << 20);
+
+		if (min_ns > elapsed)
+			fsleep(div_u64(min_ns - elapsed, NSEC_PER_USEC));
+	}
+out:
+	kfree(w);
+}
+
+/*
+ * Try to hand the action over to the background executor.  Returns false if
+ * the executor is disabled or unusable and the action should be applied
+ * synchronously as before.
+ */
+static bool damos_bg_queue(struct damon_ctx *c, struct damon_target *t,
+		struct damon_region *r, struct damos *s)
+{
+	struct damos_bg_work *w;
+	int nid = NUMA_NO_NODE;
+
+	if (!READ_ONCE(damos_bg_exec) || !damos_bg_wq)
+		return false;
+	if (s->action == DAMOS_STAT)
+		return false;
+
+	w = kmalloc(sizeof(*w), GFP_KERNEL);
+	if (!w)
+		return false;
+
+	INIT_WORK(&w->work, damos_bg_work_fn);
+	w->ctx = c;
+	w->t = t;
+	w->s = s;
+	w->ar = r->ar;
+	w->nr_accesses = r->nr_accesses;
+	w->age = r->age;
+
+	/* Keep the work close to the memory it operates on */
+	if (c->ops.id == DAMON_OPS_PADDR)
+		nid = pfn_to_nid(PHYS_PFN(r->ar.start));
+
+	queue_work_node(nid, damos_bg_wq, &w->work);
+	return true;
+}
+
+/*
+ * Wait until all queued background actions finished.  Must be called before
+ * contexts, targets or schemes that pending work could reference go away.
+ */
+static void damos_bg_drain(void)
+{
+	if (damos_bg_wq)
+		flush_workqueue(damos_bg_wq);
+}
+
+/* Fold the worker feedback into quota accounting and statistics */
+static void damos_bg_fold(struct damos *s)
+{
+	s->stat.sz_applied += atomic_long_xchg(&s->bg_sz_applied, 0);
+	s->stat.nr_applied += atomic_long_xchg(&s->bg_nr_applied, 0);
+	s->quota.total_charged_ns += atomic64_xchg(&s->bg_charged_ns, 0);
+}
+
 static void damos_update_stat(struct damos *s,
 		unsigned long sz_tried, unsigned long sz_applied)
 {
@@ -895,8 +1040,11 @@ static void damos_apply_scheme(struct damon_ctx *c, struct damon_target *t,
 		ktime_get_coarse_ts64(&begin);
 		if (c->callback.before_damos_apply)
 			err = c->callback.before_damos_apply(c, t, r, s);
-		if (!err)
-			sz_applied = c->ops.apply_scheme(c, t, r, s);
+		if (!err) {
+			/* sizes of deferred actions are reported via fold */
+			if (!damos_bg_queue(c, t, r, s))
+				sz_applied = c->ops.apply_scheme(c, t, r, s);
+		}
 		ktime_get_coarse_ts64(&end);
 		quota->total_charged_ns += timespec64_to_ns(&end) -
 			timespec64_to_ns(&begin);
@@ -1016,6 +1164,8 @@ static void kdamond_apply_schemes(struct damon_ctx *c)
 	struct damos *s;
 
 	damon_for_each_scheme(s, c) {
+		damos_bg_fold(s);
+
 		if (!s->wmarks.activated)
 			continue;
 
@@ -1355,6 +1505,9 @@ static int kdamond_fn(void *data)
 		}
 	}
 done:
+	/* No worker may reference the context after this point */
+	damos_bg_drain();
+
 	damon_for_each_target(t, ctx) {
 		damon_for_each_region_safe(r, next, t)
 			damon_destroy_region(r, t);
@@ -1460,6 +1613,12 @@ static int __init damon_init(void)
 		return -ENOMEM;
 	}
 
+	/* Not fatal; actions fall back to synchronous application */
+	damos_bg_wq = alloc_workqueue("damos_bg",
+			WQ_UNBOUND | WQ_MEM_RECLAIM, 0);
+	if (!damos_bg_wq)
+		pr_warn("creating the background executor workqueue fails\n");
+
 	return 0;
 }
 
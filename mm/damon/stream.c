@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * DAMON Binary Access Pattern Stream
+ *
+ * Exposes the aggregated monitoring results of running DAMON contexts as a
+ * stream of packed binary records on /dev/damon_stream, so that heavy users
+ * do not need to repeatedly walk and parse the text based sysfs interface.
+ * The record formats are defined in include/uapi/linux/damon.h.
+ *
+ * Records are produced only while a reader has the device open, and are
+ * dropped when the reader falls behind, so an idle or slow consumer cannot
+ * affect the monitoring itself.
+ */
+
+#define pr_fmt(fmt) "damon-stream: " fmt
+
+/* Use the same parameter namespace as the other builtin DAMON knobs */
+#define MODULE_PARAM_PREFIX "damon."
+
+#include <linux/damon.h>
+#include <linux/fs.h>
+#include <linux/kfifo.h>
+#include <linux/miscdevice.h>
+#include <linux/moduleparam.h>
+#include <linux/poll.h>
+#include <linux/spinlock.h>
+#include <linux/timekeeping.h>
+#include <linux/wait.h>
+
+#include <uapi/linux/damon.h>
+
+/*
+ * Stream the per-region records in addition to the per-target histogram
+ * summaries.  Users that subscribe to the aggregates only can turn this off
+ * to reduce the stream bandwidth.
+ */
+static bool stream_regions __read_mostly = true;
+module_param(stream_regions, bool, 0600);
+
+/*
+ * Size of the stream buffer in KiB.  Records produced while the buffer is
+ * full are dropped and counted by 'stream_overruns'.
+ */
+static unsigned int stream_kb __read_mostly = 1024;
+module_param(stream_kb, uint, 0400);
+
+/* Number of records dropped because the reader fell behind */
+static unsigned long stream_overruns;
+module_param(stream_overruns, ulong, 0400);
+
+static struct kfifo stream_fifo;
+/* Serializes the producers (kdamonds) and protects the fifo lifetime */
+static DEFINE_SPINLOCK(stream_lock);
+static DECLARE_WAIT_QUEUE_HEAD(stream_wait);
+/* Whether a reader has the device open.  Only one reader is allowed. */
+static unsigned long stream_open_mask;
+
+static void damon_stream_push(const void *rec, unsigned int len)
+{
+	spin_lock(&stream_lock);
+	if (test_bit(0, &stream_open_mask) &&
+			kfifo_avail(&stream_fifo) >= len)
+		kfifo_in(&stream_fifo, rec, len);
+	else
+		stream_overruns++;
+	spin_unlock(&stream_lock);
+}
+
+/*
+ * Report the aggregated monitoring results of @c to the stream.
+ *
+ * Called by the kdamond of @c once per aggregation interval, just before the
+ * aggregated access counters are reset.
+ */
+void damon_stream_report(struct damon_ctx *c)
+{
+	struct damon_stream_aggr ar = {};
+	struct damon_target *t;
+	unsigned long max_samples;
+	unsigned int ti = 0;
+
+	if (!test_bit(0, &stream_open_mask))
+		return;
+
+	damon_for_each_target(t, c)
+		ar.nr_targets++;
+	ar.type = DAMON_STREAM_REC_AGGR;
+	ar.time_ns = ktime_get_ns();
+	damon_stream_push(&ar, sizeof(ar));
+
+	max_samples = c->attrs.aggr_interval / c->attrs.sample_interval;
+	if (!max_samples)
+		max_samples = 1;
+
+	damon_for_each_target(t, c) {
+		struct damon_stream_hist hr = {};
+		struct damon_region *r;
+
+		hr.type = DAMON_STREAM_REC_HIST;
+		hr.target_idx = ti;
+		damon_for_each_region(r, t) {
+			unsigned int bin;
+
+			bin = min_t(unsigned long,
+					r->nr_accesses * DAMON_STREAM_HIST_BINS
+					/ max_samples,
+					DAMON_STREAM_HIST_BINS - 1);
+			hr.nr_regions[bin]++;
+			hr.sz_regions[bin] += damon_sz_region(r);
+
+			if (stream_regions) {
+				struct damon_stream_region rr = {
+					.type = DAMON_STREAM_REC_REGION,
+					.target_idx = ti,
+					.nr_accesses = r->nr_accesses,
+					.start = r->ar.start,
+					.end = r->ar.end,
+					.age = r->age,
+				};
+
+				damon_stream_push(&rr, sizeof(rr));
+			}
+		}
+		damon_stream_push(&hr, sizeof(hr));
+		ti++;
+	}
+	wake_up_interruptible(&stream_wait);
+}
+
+static int damon_stream_open(struct inode *inode, struct file *file)
+{
+	int err;
+
+	if (test_and_set_bit(0, &stream_open_mask))
+		return -EBUSY;
+
+	err = kfifo_alloc(&stream_fifo, stream_kb << 10, GFP_KERNEL);
+	if (err) {
+		clear_bit(0, &stream_open_mask);
+		return err;
+	}
+	return nonseekable_open(inode, file);
+}
+
+static int damon_stream_release(struct inode *inode, struct file *file)
+{
+	spin_lock(&stream_lock);
+	clear_bit(0, &stream_open_mask);
+	kfifo_free(&stream_fifo);
+	spin_unlock(&stream_lock);
+	return 0;
+}
+
+static ssize_t damon_stream_read(struct file *file, char __user *buf,
+		size_t count, loff_t *ppos)
+{
+	unsigned int copied;
+	int err;
+
+	if (kfifo_is_empty(&stream_fifo)) {
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		err = wait_event_interruptible(stream_wait,
+				!kfifo_is_empty(&stream_fifo));
+		if (err)
+			return err;
+	}
+
+	/*
+	 * The single reader consumes the fifo without holding stream_lock.
+	 * This is safe against the spinlock-serialized producers, as kfifo
+	 * supports one concurrent reader and writer locklessly.
+	 */
+	err = kfifo_to_user(&stream_fifo, buf, count, &copied);
+	return err ? err : copied;
+}
+
+static __poll_t damon_stream_poll(struct file *file, poll_table *wait)
+{
+	poll_wait(file, &stream_wait, wait);
+	if (!kfifo_is_empty(&stream_fifo))
+		return EPOLLIN | EPOLLRDNORM;
+	return 0;
+}
+
+static const struct file_operations damon_stream_fops = {
+	.owner = THIS_MODULE,
+	.open = damon_stream_open,
+	.release = damon_stream_release,
+	.read = damon_stream_read,
+	.poll = damon_stream_poll,
+	.llseek = noop_llseek,
+};
+
+static struct miscdevice damon_stream_dev = {
+	.minor = MISC_DYNAMIC_MINOR,
+	.name = "damon_stream",
+	.fops = &damon_stream_fops,
+};
+
+static int __init damon_stream_init(void)
+{
+	int err;
+
+	err = misc_register(&damon_stream_dev);
+	if (err)
+		pr_err("failed to register the stream device (%d)\n", err);
+	return err;
+}
+
+device_initcall(damon_stream_init);
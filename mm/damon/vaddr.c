@@ -11,6 +11,7 @@
 #include <linux/highmem.h>
 #include <linux/hugetlb.h>
 #include <linux/mmu_notifier.h>
+#include <linux/moduleparam.h>
 #include <linux/page_idle.h>
 #include <linux/pagewalk.h>
 #include <linux/sched/mm.h>
@@ -386,20 +387,35 @@ static const struct mm_walk_ops damon_mkold_ops = {
 	.hugetlb_entry = damon_mkold_hugetlb_entry,
 };
 
+/* Caller must hold the mmap read lock of @mm */
 static void damon_va_mkold(struct mm_struct *mm, unsigned long addr)
 {
-	mmap_read_lock(mm);
 	walk_page_range(mm, addr, addr + 1, &damon_mkold_ops, NULL);
-	mmap_read_unlock(mm);
 }
 
 /*
  * Functions for the access checking of the regions
  */
 
+/*
+ * When adaptive sampling is enabled, regions that keep a stable access
+ * frequency estimate (non-zero @age) are walked only on every Nth sampling
+ * pass, with N growing up to this bound as the region stays stable.  The
+ * skipped passes reuse the outcome of the last real sample, and the core
+ * resets @age as soon as the estimate changes, which brings the region back
+ * to per-pass sampling.
+ */
+static bool adaptive_sampling __read_mostly;
+module_param(adaptive_sampling, bool, 0600);
+
+#define DAMON_VA_MAX_SAMPLE_SKIPS	7
+
 static void __damon_va_prepare_access_check(struct mm_struct *mm,
 					struct damon_region *r)
 {
+	if (adaptive_sampling && r->sample_skips)
+		return;
+
 	r->sampling_addr = damon_rand(r->ar.start, r->ar.end);
 
 	damon_va_mkold(mm, r->sampling_addr);
@@ -415,8 +431,15 @@ static void damon_va_prepare_access_checks(struct damon_ctx *ctx)
 		mm = damon_get_mm(t);
 		if (!mm)
 			continue;
+		/*
+		 * Regions are address ordered, so taking the lock once per
+		 * target batches the page table walks of all its regions
+		 * into one ordered traversal of the address space.
+		 */
+		mmap_read_lock(mm);
 		damon_for_each_region(r, t)
 			__damon_va_prepare_access_check(mm, r);
+		mmap_read_unlock(mm);
 		mmput(mm);
 	}
 }
@@ -521,6 +544,7 @@ static const struct mm_walk_ops damon_young_ops = {
 	.hugetlb_entry = damon_young_hugetlb_entry,
 };
 
+/* Caller must hold the mmap read lock of @mm */
 static bool damon_va_young(struct mm_struct *mm, unsigned long addr,
 		unsigned long *folio_sz)
 {
@@ -529,9 +553,7 @@ static bool damon_va_young(struct mm_struct *mm, unsigned long addr,
 		.young = false,
 	};
 
-	mmap_read_lock(mm);
 	walk_page_range(mm, addr, addr + 1, &damon_young_ops, &arg);
-	mmap_read_unlock(mm);
 	return arg.young;
 }
 
@@ -548,12 +570,23 @@ static void __damon_va_check_access(struct mm_struct *mm,
 	static unsigned long last_folio_sz = PAGE_SIZE;
 	static bool last_accessed;
 
+	if (adaptive_sampling && r->sample_skips) {
+		/*
+		 * The prepare pass skipped the mkold walk for this region.
+		 * Extrapolate from the outcome of the last real sample.
+		 */
+		r->sample_skips--;
+		if (r->last_sampled_young)
+			r->nr_accesses++;
+		return;
+	}
+
 	/* If the region is in the last checked page, reuse the result */
 	if (same_target && (ALIGN_DOWN(last_addr, last_folio_sz) ==
 				ALIGN_DOWN(r->sampling_addr, last_folio_sz))) {
 		if (last_accessed)
 			r->nr_accesses++;
-		return;
+		goto update;
 	}
 
 	last_accessed = damon_va_young(mm, r->sampling_addr, &last_folio_sz);
@@ -561,6 +594,11 @@ static void __damon_va_check_access(struct mm_struct *mm,
 		r->nr_accesses++;
 
 	last_addr = r->sampling_addr;
+update:
+	r->last_sampled_young = last_accessed;
+	if (adaptive_sampling)
+		r->sample_skips = min_t(unsigned int, r->age,
+					DAMON_VA_MAX_SAMPLE_SKIPS);
 }
 
 static unsigned int damon_va_check_accesses(struct damon_ctx *ctx)
@@ -576,11 +614,14 @@ static unsigned int damon_va_check_accesses(struct damon_ctx *ctx)
 		if (!mm)
 			continue;
 		same_target = false;
+		/* One lock hold per target; see the prepare pass */
+		mmap_read_lock(mm);
 		damon_for_each_region(r, t) {
 			__damon_va_check_access(mm, r, same_target);
 			max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
 			same_target = true;
 		}
+		mmap_read_unlock(mm);
 		mmput(mm);
 	}
 
@@ -310,6 +310,17 @@ void * __must_check __kasan_slab_alloc(struct kmem_cache *cache,
 	if (is_kfence_address(object))
 		return (void *)object;
 
+	/*
+	 * If the allocation is not sampled for tagging, leave the object
+	 * untagged: reset its memory tags so that accesses through the
+	 * returned pointer go unchecked.
+	 */
+	if (unlikely(!kasan_sample_slab_alloc(cache))) {
+		object = kasan_reset_tag(object);
+		kasan_unpoison(object, cache->object_size, init);
+		return (void *)object;
+	}
+
 	/*
 	 * Generate and assign random tag for tag-based modes.
 	 * Tag is ignored in set_tag() for the generic mode.
@@ -8,11 +8,13 @@
 
 #define pr_fmt(fmt) "kasan: " fmt
 
+#include <linux/debugfs.h>
 #include <linux/init.h>
 #include <linux/kasan.h>
 #include <linux/kernel.h>
 #include <linux/memory.h>
 #include <linux/mm.h>
+#include <linux/seq_file.h>
 #include <linux/static_key.h>
 #include <linux/string.h>
 #include <linux/types.h>
@@ -77,6 +79,26 @@ unsigned int kasan_page_alloc_sample_order = PAGE_ALLOC_SAMPLE_ORDER_DEFAULT;
 
 DEFINE_PER_CPU(long, kasan_page_alloc_skip);
 
+#define SLAB_ALLOC_SAMPLE_DEFAULT	1
+#define SLAB_ALLOC_SAMPLE_SIZE_DEFAULT	1024
+
+/*
+ * Sampling interval of slab allocation tagging.
+ * Defaults to no sampling.
+ */
+unsigned long kasan_slab_alloc_sample = SLAB_ALLOC_SAMPLE_DEFAULT;
+
+/*
+ * Maximum object size of caches to be affected by sampling. Objects of at
+ * least this size allocate rarely and are always tagged; sampling applies
+ * only to the smaller, hotter caches whose tagging cost it is meant to cut.
+ */
+unsigned int kasan_slab_alloc_sample_size = SLAB_ALLOC_SAMPLE_SIZE_DEFAULT;
+
+DEFINE_PER_CPU(long, kasan_slab_alloc_skip);
+DEFINE_PER_CPU(unsigned long, kasan_slab_alloc_tagged);
+DEFINE_PER_CPU(unsigned long, kasan_slab_alloc_skipped);
+
 /* kasan=off/on */
 static int __init early_kasan_flag(char *arg)
 {
@@ -182,6 +204,48 @@ static int __init early_kasan_flag_page_alloc_sample_order(char *arg)
 }
 early_param("kasan.page_alloc.sample.order", early_kasan_flag_page_alloc_sample_order);
 
+/* kasan.slab_alloc.sample=<sampling interval> */
+static int __init early_kasan_flag_slab_alloc_sample(char *arg)
+{
+	int rv;
+
+	if (!arg)
+		return -EINVAL;
+
+	rv = kstrtoul(arg, 0, &kasan_slab_alloc_sample);
+	if (rv)
+		return rv;
+
+	if (!kasan_slab_alloc_sample || kasan_slab_alloc_sample > LONG_MAX) {
+		kasan_slab_alloc_sample = SLAB_ALLOC_SAMPLE_DEFAULT;
+		return -EINVAL;
+	}
+
+	return 0;
+}
+early_param("kasan.slab_alloc.sample", early_kasan_flag_slab_alloc_sample);
+
+/* kasan.slab_alloc.sample.size=<maximum object size> */
+static int __init early_kasan_flag_slab_alloc_sample_size(char *arg)
+{
+	int rv;
+
+	if (!arg)
+		return -EINVAL;
+
+	rv = kstrtouint(arg, 0, &kasan_slab_alloc_sample_size);
+	if (rv)
+		return rv;
+
+	if (kasan_slab_alloc_sample_size > INT_MAX) {
+		kasan_slab_alloc_sample_size = SLAB_ALLOC_SAMPLE_SIZE_DEFAULT;
+		return -EINVAL;
+	}
+
+	return 0;
+}
+early_param("kasan.slab_alloc.sample.size", early_kasan_flag_slab_alloc_sample_size);
+
 /*
  * kasan_init_hw_tags_cpu() is called for each CPU.
  * Not marked as __init as a CPU can be hot-plugged after boot.
@@ -373,6 +437,35 @@ void __kasan_poison_vmalloc(const void *start, unsigned long size)
 
 #endif
 
+static int slab_alloc_sample_show(struct seq_file *seq, void *v)
+{
+	unsigned long tagged = 0, skipped = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		tagged += per_cpu(kasan_slab_alloc_tagged, cpu);
+		skipped += per_cpu(kasan_slab_alloc_skipped, cpu);
+	}
+
+	seq_printf(seq, "tagged %lu\nskipped %lu\n", tagged, skipped);
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(slab_alloc_sample);
+
+static int __init kasan_hw_tags_debugfs_init(void)
+{
+	struct dentry *dir;
+
+	if (!kasan_enabled() || kasan_slab_alloc_sample == 1)
+		return 0;
+
+	dir = debugfs_create_dir("kasan", NULL);
+	debugfs_create_file("slab_alloc_sample", 0444, dir, NULL,
+			    &slab_alloc_sample_fops);
+	return 0;
+}
+late_initcall(kasan_hw_tags_debugfs_init);
+
 void kasan_enable_tagging(void)
 {
 	if (kasan_arg_mode == KASAN_ARG_MODE_ASYNC)
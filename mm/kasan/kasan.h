@@ -46,6 +46,12 @@ extern unsigned long kasan_page_alloc_sample;
 extern unsigned int kasan_page_alloc_sample_order;
 DECLARE_PER_CPU(long, kasan_page_alloc_skip);
 
+extern unsigned long kasan_slab_alloc_sample;
+extern unsigned int kasan_slab_alloc_sample_size;
+DECLARE_PER_CPU(long, kasan_slab_alloc_skip);
+DECLARE_PER_CPU(unsigned long, kasan_slab_alloc_tagged);
+DECLARE_PER_CPU(unsigned long, kasan_slab_alloc_skipped);
+
 static inline bool kasan_vmalloc_enabled(void)
 {
 	return static_branch_likely(&kasan_flag_vmalloc);
@@ -79,6 +85,28 @@ static inline bool kasan_sample_page_alloc(unsigned int order)
 	return false;
 }
 
+static inline bool kasan_sample_slab_alloc(struct kmem_cache *cache)
+{
+	/* Fast-path for when sampling is disabled. */
+	if (kasan_slab_alloc_sample == 1)
+		return true;
+
+	if (cache->object_size >= kasan_slab_alloc_sample_size) {
+		this_cpu_inc(kasan_slab_alloc_tagged);
+		return true;
+	}
+
+	if (this_cpu_dec_return(kasan_slab_alloc_skip) < 0) {
+		this_cpu_write(kasan_slab_alloc_skip,
+			       kasan_slab_alloc_sample - 1);
+		this_cpu_inc(kasan_slab_alloc_tagged);
+		return true;
+	}
+
+	this_cpu_inc(kasan_slab_alloc_skipped);
+	return false;
+}
+
 #else /* CONFIG_KASAN_HW_TAGS */
 
 static inline bool kasan_async_fault_possible(void)
@@ -96,6 +124,11 @@ static inline bool kasan_sample_page_alloc(unsigned int order)
 	return true;
 }
 
+static inline bool kasan_sample_slab_alloc(struct kmem_cache *cache)
+{
+	return true;
+}
+
 #endif /* CONFIG_KASAN_HW_TAGS */
 
 #ifdef CONFIG_KASAN_GENERIC
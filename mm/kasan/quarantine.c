@@ -20,6 +20,7 @@
 #include <linux/string.h>
 #include <linux/types.h>
 #include <linux/cpuhotplug.h>
+#include <linux/workqueue.h>
 
 #include "../slab.h"
 #include "kasan.h"
@@ -80,6 +81,28 @@ static void qlist_move_all(struct qlist_head *from, struct qlist_head *to)
 	qlist_init(from);
 }
 
+static struct kmem_cache *qlink_to_cache(struct qlist_node *qlink);
+
+/*
+ * Move up to @nr objects from the beginning of @from to @to, so that the
+ * caller can free them at a bounded cost.
+ */
+static void qlist_split(struct qlist_head *from, struct qlist_head *to,
+		size_t nr)
+{
+	while (nr-- && !qlist_empty(from)) {
+		struct qlist_node *qlink = from->head;
+		size_t size = qlink_to_cache(qlink)->size;
+
+		from->head = qlink->next;
+		if (!from->head)
+			from->tail = NULL;
+		from->bytes -= size;
+
+		qlist_put(to, qlink, size);
+	}
+}
+
 #define QUARANTINE_PERCPU_SIZE (1 << 20)
 #define QUARANTINE_BATCHES \
 	(1024 > 4 * CONFIG_NR_CPUS ? 1024 : 4 * CONFIG_NR_CPUS)
@@ -126,6 +149,40 @@ static unsigned long quarantine_batch_size;
  */
 #define QUARANTINE_FRACTION 32
 
+/*
+ * The fraction of the quarantine a single cache is allowed to occupy.  Objects
+ * of a cache that is over its quota are freed immediately instead of pushing
+ * objects of other caches out of the quarantine.
+ */
+#define QUARANTINE_CACHE_FRACTION 4
+
+/*
+ * Maximum number of objects a single kasan_quarantine_reduce() call frees from
+ * the allocation context, bounding the latency it adds there.  The rest of the
+ * work is left to the background drainer.
+ */
+#define QUARANTINE_DRAIN_BATCH 64
+
+/*
+ * The background drainer runs whenever the global queue grows beyond this
+ * percentage of its maximum size, keeping headroom so that allocations rarely
+ * have to reduce the quarantine themselves.
+ */
+#define QUARANTINE_LOW_WATERMARK 75
+
+static struct workqueue_struct *quarantine_wq;
+static void quarantine_drain_fn(struct work_struct *work);
+static DECLARE_WORK(quarantine_drain_work, quarantine_drain_fn);
+
+/*
+ * Whether the global queue is full enough for the background drainer to run.
+ */
+static bool quarantine_over_watermark(void)
+{
+	return READ_ONCE(quarantine_size) > READ_ONCE(quarantine_max_size) /
+		100 * QUARANTINE_LOW_WATERMARK;
+}
+
 static struct kmem_cache *qlink_to_cache(struct qlist_node *qlink)
 {
 	return virt_to_slab(qlink)->slab_cache;
@@ -166,6 +223,7 @@ static void qlink_free(struct qlist_node *qlink, struct kmem_cache *cache)
 	*(u8 *)kasan_mem_to_shadow(object) = KASAN_SLAB_FREE;
 
 	___cache_free(cache, object, _THIS_IP_);
+	atomic_long_sub(cache->size, &cache->kasan_info.quarantine_bytes);
 
 	if (IS_ENABLED(CONFIG_SLAB))
 		local_irq_restore(flags);
@@ -196,6 +254,7 @@ bool kasan_quarantine_put(struct kmem_cache *cache, void *object)
 	struct qlist_head *q;
 	struct qlist_head temp = QLIST_INIT;
 	struct kasan_free_meta *meta = kasan_get_free_meta(cache, object);
+	unsigned long cache_quota;
 
 	/*
 	 * If there's no metadata for this object, don't put it into
@@ -204,6 +263,17 @@ bool kasan_quarantine_put(struct kmem_cache *cache, void *object)
 	if (!meta)
 		return false;
 
+	/*
+	 * If the cache already occupies its share of the quarantine, free the
+	 * object right away instead of pushing objects of other caches out.
+	 */
+	cache_quota = READ_ONCE(quarantine_max_size) /
+		QUARANTINE_CACHE_FRACTION;
+	if (cache_quota &&
+	    atomic_long_read(&cache->kasan_info.quarantine_bytes) +
+	    cache->size > cache_quota)
+		return false;
+
 	/*
 	 * Note: irq must be disabled until after we move the batch to the
 	 * global quarantine. Otherwise kasan_quarantine_remove_cache() can
@@ -220,6 +290,7 @@ bool kasan_quarantine_put(struct kmem_cache *cache, void *object)
 		return false;
 	}
 	qlist_put(q, &meta->quarantine_link, cache->size);
+	atomic_long_add(cache->size, &cache->kasan_info.quarantine_bytes);
 	if (unlikely(q->bytes > QUARANTINE_PERCPU_SIZE)) {
 		qlist_move_all(q, &temp);
 
@@ -241,12 +312,51 @@ bool kasan_quarantine_put(struct kmem_cache *cache, void *object)
 
 	local_irq_restore(flags);
 
+	/* Keep headroom in the global queue so allocations rarely drain it. */
+	if (quarantine_wq && quarantine_over_watermark())
+		queue_work(quarantine_wq, &quarantine_drain_work);
+
 	return true;
 }
 
-void kasan_quarantine_reduce(void)
+/*
+ * Update quarantine size limits in case of hotplug. Allocate a fraction of
+ * the installed memory to quarantine minus per-cpu queue limits.  Must be
+ * called under quarantine_lock.
+ */
+static void quarantine_update_limits(void)
 {
 	size_t total_size, new_quarantine_size, percpu_quarantines;
+
+	total_size = (totalram_pages() << PAGE_SHIFT) /
+		QUARANTINE_FRACTION;
+	percpu_quarantines = QUARANTINE_PERCPU_SIZE * num_online_cpus();
+	new_quarantine_size = (total_size < percpu_quarantines) ?
+		0 : total_size - percpu_quarantines;
+	WRITE_ONCE(quarantine_max_size, new_quarantine_size);
+	/* Aim at consuming at most 1/2 of slots in quarantine. */
+	WRITE_ONCE(quarantine_batch_size, max((size_t)QUARANTINE_PERCPU_SIZE,
+		2 * total_size / QUARANTINE_BATCHES));
+}
+
+/*
+ * Take up to @nr objects out of the global queue into @to_free.  Must be
+ * called under quarantine_lock.
+ */
+static void quarantine_dequeue(struct qlist_head *to_free, size_t nr)
+{
+	qlist_split(&global_quarantine[quarantine_head], to_free, nr);
+	WRITE_ONCE(quarantine_size, quarantine_size - to_free->bytes);
+	if (qlist_empty(&global_quarantine[quarantine_head]) &&
+	    quarantine_head != quarantine_tail) {
+		quarantine_head++;
+		if (quarantine_head == QUARANTINE_BATCHES)
+			quarantine_head = 0;
+	}
+}
+
+void kasan_quarantine_reduce(void)
+{
 	unsigned long flags;
 	int srcu_idx;
 	struct qlist_head to_free = QLIST_INIT;
@@ -267,32 +377,56 @@ void kasan_quarantine_reduce(void)
 	srcu_idx = srcu_read_lock(&remove_cache_srcu);
 	raw_spin_lock_irqsave(&quarantine_lock, flags);
 
+	quarantine_update_limits();
+
 	/*
-	 * Update quarantine size in case of hotplug. Allocate a fraction of
-	 * the installed memory to quarantine minus per-cpu queue limits.
+	 * Free only a bounded number of objects from the allocation context;
+	 * the background drainer takes care of the rest.
 	 */
-	total_size = (totalram_pages() << PAGE_SHIFT) /
-		QUARANTINE_FRACTION;
-	percpu_quarantines = QUARANTINE_PERCPU_SIZE * num_online_cpus();
-	new_quarantine_size = (total_size < percpu_quarantines) ?
-		0 : total_size - percpu_quarantines;
-	WRITE_ONCE(quarantine_max_size, new_quarantine_size);
-	/* Aim at consuming at most 1/2 of slots in quarantine. */
-	WRITE_ONCE(quarantine_batch_size, max((size_t)QUARANTINE_PERCPU_SIZE,
-		2 * total_size / QUARANTINE_BATCHES));
-
-	if (likely(quarantine_size > quarantine_max_size)) {
-		qlist_move_all(&global_quarantine[quarantine_head], &to_free);
-		WRITE_ONCE(quarantine_size, quarantine_size - to_free.bytes);
-		quarantine_head++;
-		if (quarantine_head == QUARANTINE_BATCHES)
-			quarantine_head = 0;
-	}
+	if (likely(quarantine_size > quarantine_max_size))
+		quarantine_dequeue(&to_free, QUARANTINE_DRAIN_BATCH);
 
 	raw_spin_unlock_irqrestore(&quarantine_lock, flags);
 
 	qlist_free_all(&to_free, NULL);
 	srcu_read_unlock(&remove_cache_srcu, srcu_idx);
+
+	if (quarantine_wq && quarantine_over_watermark())
+		queue_work(quarantine_wq, &quarantine_drain_work);
+}
+
+/*
+ * The background drainer. Frees quarantined objects in small batches until
+ * the global queue is back under the low watermark. The srcu read lock is
+ * taken per batch, same as in kasan_quarantine_reduce(), so that
+ * kasan_quarantine_remove_cache() never waits for the whole drain.
+ */
+static void quarantine_drain_fn(struct work_struct *work)
+{
+	unsigned long flags;
+	int srcu_idx;
+
+	raw_spin_lock_irqsave(&quarantine_lock, flags);
+	quarantine_update_limits();
+	raw_spin_unlock_irqrestore(&quarantine_lock, flags);
+
+	while (quarantine_over_watermark()) {
+		struct qlist_head to_free = QLIST_INIT;
+
+		srcu_idx = srcu_read_lock(&remove_cache_srcu);
+		raw_spin_lock_irqsave(&quarantine_lock, flags);
+		quarantine_dequeue(&to_free, QUARANTINE_DRAIN_BATCH);
+		raw_spin_unlock_irqrestore(&quarantine_lock, flags);
+
+		if (qlist_empty(&to_free)) {
+			srcu_read_unlock(&remove_cache_srcu, srcu_idx);
+			break;
+		}
+
+		qlist_free_all(&to_free, NULL);
+		srcu_read_unlock(&remove_cache_srcu, srcu_idx);
+		cond_resched();
+	}
 }
 
 static void qlist_move_cache(struct qlist_head *from,
@@ -433,6 +567,17 @@ static int __init kasan_cpu_quarantine_init(void)
 				kasan_cpu_online, kasan_cpu_offline);
 	if (ret < 0)
 		pr_err("kasan cpu quarantine register failed [%d]\n", ret);
+
+	/*
+	 * The drainer frees memory, so let it run under memory pressure.
+	 * If the allocation fails, the bounded synchronous draining in
+	 * kasan_quarantine_reduce() still keeps the quarantine in check.
+	 */
+	quarantine_wq = alloc_workqueue("kasan_quarantine",
+				       WQ_UNBOUND | WQ_MEM_RECLAIM, 1);
+	if (!quarantine_wq)
+		pr_err("kasan quarantine drain workqueue allocation failed\n");
+
 	return ret;
 }
 late_initcall(kasan_cpu_quarantine_init);
@@ -99,6 +99,26 @@ module_param_cb(sample_interval, &sample_interval_param_ops, &kfence_sample_inte
 static unsigned long kfence_skip_covered_thresh __read_mostly = 75;
 module_param_named(skip_covered_thresh, kfence_skip_covered_thresh, ulong, 0644);
 
+/*
+ * Pool usage% a single cache may occupy before its allocations are skipped
+ * without consuming the allocation gate, leaving the sample to less covered
+ * caches. 0 disables the per-cache limit.
+ */
+static unsigned long kfence_cache_covered_thresh __read_mostly = 10;
+module_param_named(cache_covered_thresh, kfence_cache_covered_thresh, ulong, 0644);
+
+/*
+ * Bounds of the adaptive sample interval (ms). While both are set, the
+ * effective interval halves after a sample that covered a new allocation and
+ * doubles after a wasted one, clamped to [min, max]; sample_interval_min
+ * thereby bounds the maximum sampling overhead. Both default to 0, which
+ * keeps the interval fixed at sample_interval.
+ */
+static unsigned long kfence_sample_interval_min __read_mostly;
+module_param_named(sample_interval_min, kfence_sample_interval_min, ulong, 0644);
+static unsigned long kfence_sample_interval_max __read_mostly;
+module_param_named(sample_interval_max, kfence_sample_interval_max, ulong, 0644);
+
 /* If true, use a deferrable timer. */
 static bool kfence_deferrable __read_mostly = IS_ENABLED(CONFIG_KFENCE_DEFERRABLE);
 module_param_named(deferrable, kfence_deferrable, bool, 0444);
@@ -148,6 +168,18 @@ atomic_t kfence_allocation_gate = ATOMIC_INIT(1);
 #define ALLOC_COVERED_MASK	(ALLOC_COVERED_SIZE - 1)
 static atomic_t alloc_covered[ALLOC_COVERED_SIZE];
 
+/*
+ * A Counting Bloom filter of per-cache coverage: counts the pool objects
+ * currently allocated from each cache, so that caches already occupying much
+ * of the pool can be skipped before they consume the allocation gate.
+ */
+#define CACHE_COVERED_HNUM	2
+#define CACHE_COVERED_ORDER	6
+#define CACHE_COVERED_SIZE	(1 << CACHE_COVERED_ORDER)
+#define CACHE_COVERED_HNEXT(h)	hash_32(h, CACHE_COVERED_ORDER)
+#define CACHE_COVERED_MASK	(CACHE_COVERED_SIZE - 1)
+static atomic_t cache_covered[CACHE_COVERED_SIZE];
+
 /* Stack depth used to determine uniqueness of an allocation. */
 #define UNIQUE_ALLOC_STACK_DEPTH ((size_t)8)
 
@@ -167,6 +199,7 @@ enum kfence_counter_id {
 	KFENCE_COUNTER_SKIP_INCOMPAT,
 	KFENCE_COUNTER_SKIP_CAPACITY,
 	KFENCE_COUNTER_SKIP_COVERED,
+	KFENCE_COUNTER_SKIP_SATURATED,
 	KFENCE_COUNTER_COUNT,
 };
 static atomic_long_t counters[KFENCE_COUNTER_COUNT];
@@ -179,6 +212,7 @@ static const char *const counter_names[] = {
 	[KFENCE_COUNTER_SKIP_INCOMPAT]	= "skipped allocations (incompatible)",
 	[KFENCE_COUNTER_SKIP_CAPACITY]	= "skipped allocations (capacity)",
 	[KFENCE_COUNTER_SKIP_COVERED]	= "skipped allocations (covered)",
+	[KFENCE_COUNTER_SKIP_SATURATED]	= "skipped allocations (cache saturated)",
 };
 static_assert(ARRAY_SIZE(counter_names) == KFENCE_COUNTER_COUNT);
 
@@ -229,6 +263,45 @@ static bool alloc_covered_contains(u32 alloc_stack_hash)
 	return true;
 }
 
+/*
+ * Adds (or subtracts) count @val for allocations of @cache from Counting
+ * Bloom filter.
+ */
+static void cache_covered_add(struct kmem_cache *cache, int val)
+{
+	u32 h = hash_ptr(cache, 32);
+	int i;
+
+	for (i = 0; i < CACHE_COVERED_HNUM; i++) {
+		atomic_add(val, &cache_covered[h & CACHE_COVERED_MASK]);
+		h = CACHE_COVERED_HNEXT(h);
+	}
+}
+
+/*
+ * Returns true if @cache currently occupies more than cache_covered_thresh%
+ * of the pool; allocations from such caches are skipped in favor of caches
+ * with less coverage.
+ */
+static bool cache_covered_saturated(struct kmem_cache *cache)
+{
+	unsigned long thresh = (CONFIG_KFENCE_NUM_OBJECTS *
+				kfence_cache_covered_thresh) / 100;
+	u32 h = hash_ptr(cache, 32);
+	int i;
+
+	if (!thresh)
+		return false;
+
+	for (i = 0; i < CACHE_COVERED_HNUM; i++) {
+		if (atomic_read(&cache_covered[h & CACHE_COVERED_MASK]) <= thresh)
+			return false;
+		h = CACHE_COVERED_HNEXT(h);
+	}
+
+	return true;
+}
+
 static bool kfence_protect(unsigned long addr)
 {
 	return !KFENCE_WARN_ON(!kfence_protect_page(ALIGN_DOWN(addr, PAGE_SIZE), true));
@@ -423,6 +496,7 @@ static void *kfence_guarded_alloc(struct kmem_cache *cache, size_t size, gfp_t g
 	raw_spin_unlock_irqrestore(&meta->lock, flags);
 
 	alloc_covered_add(alloc_stack_hash, 1);
+	cache_covered_add(cache, 1);
 
 	/* Set required slab fields. */
 	slab = virt_to_slab((void *)meta->addr);
@@ -458,6 +532,7 @@ static void *kfence_guarded_alloc(struct kmem_cache *cache, size_t size, gfp_t g
 static void kfence_guarded_free(void *addr, struct kfence_metadata *meta, bool zombie)
 {
 	struct kcsan_scoped_access assert_page_exclusive;
+	struct kmem_cache *cache;
 	unsigned long flags;
 	bool init;
 
@@ -490,9 +565,11 @@ static void kfence_guarded_free(void *addr, struct kfence_metadata *meta, bool z
 	/* Mark the object as freed. */
 	metadata_update_state(meta, KFENCE_OBJECT_FREED, NULL, 0);
 	init = slab_want_init_on_free(meta->cache);
+	cache = meta->cache;
 	raw_spin_unlock_irqrestore(&meta->lock, flags);
 
 	alloc_covered_add(meta->alloc_stack_hash, -1);
+	cache_covered_add(cache, -1);
 
 	/* Check canary bytes for memory corruption. */
 	for_each_canary(meta, check_canary_byte);
@@ -792,6 +869,37 @@ static DEFINE_IRQ_WORK(wake_up_kfence_timer_work, wake_up_kfence_timer);
  * avoids IPIs, at the cost of not immediately capturing allocations if the
  * instructions remain cached.
  */
+/*
+ * Returns the delay until the next sample. While the adaptive interval
+ * bounds are set, the interval halves after a sample that covered a new
+ * allocation and doubles after a wasted one (skipped as covered, or not
+ * taken at all), spending the sampling budget where new coverage is found.
+ */
+static unsigned long next_sample_interval(void)
+{
+	static unsigned long cur_interval;
+	static unsigned long last_allocs;
+	unsigned long min = READ_ONCE(kfence_sample_interval_min);
+	unsigned long max = READ_ONCE(kfence_sample_interval_max);
+	unsigned long allocs;
+
+	if (!min || !max || min > max)
+		return kfence_sample_interval;
+
+	if (!cur_interval)
+		cur_interval = kfence_sample_interval;
+
+	allocs = atomic_long_read(&counters[KFENCE_COUNTER_ALLOCS]);
+	if (allocs != last_allocs)
+		cur_interval /= 2;
+	else
+		cur_interval *= 2;
+	cur_interval = clamp(cur_interval, min, max);
+	last_allocs = allocs;
+
+	return cur_interval;
+}
+
 static void toggle_allocation_gate(struct work_struct *work)
 {
 	if (!READ_ONCE(kfence_enabled))
@@ -808,7 +916,7 @@ static void toggle_allocation_gate(struct work_struct *work)
 	static_branch_disable(&kfence_allocation_key);
 #endif
 	queue_delayed_work(system_unbound_wq, &kfence_timer,
-			   msecs_to_jiffies(kfence_sample_interval));
+			   msecs_to_jiffies(next_sample_interval()));
 }
 
 /* === Public interface ===================================================== */
@@ -995,6 +1103,16 @@ void *__kfence_alloc(struct kmem_cache *s, size_t size, gfp_t flags)
 	if (s->flags & SLAB_SKIP_KFENCE)
 		return NULL;
 
+	/*
+	 * Skip caches that already occupy much of the pool. Checked before
+	 * the gate is consumed, so the sample remains available for caches
+	 * with less coverage.
+	 */
+	if (cache_covered_saturated(s)) {
+		atomic_long_inc(&counters[KFENCE_COUNTER_SKIP_SATURATED]);
+		return NULL;
+	}
+
 	if (atomic_inc_return(&kfence_allocation_gate) > 1)
 		return NULL;
 #ifdef CONFIG_KFENCE_STATIC_KEYS
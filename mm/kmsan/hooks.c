@@ -163,8 +163,8 @@ void kmsan_ioremap_page_range(unsigned long start, unsigned long end,
 	nr = (end - start) / PAGE_SIZE;
 	kmsan_enter_runtime();
 	for (int i = 0; i < nr; i++, off += PAGE_SIZE) {
-		shadow = alloc_pages(gfp_mask, 1);
-		origin = alloc_pages(gfp_mask, 1);
+		shadow = kmsan_internal_alloc_meta_page(gfp_mask);
+		origin = kmsan_internal_alloc_meta_page(gfp_mask);
 		__vmap_pages_range_noflush(
 			vmalloc_shadow(start + off),
 			vmalloc_shadow(start + off + PAGE_SIZE), prot, &shadow,
@@ -199,9 +199,9 @@ void kmsan_iounmap_page_range(unsigned long start, unsigned long end)
 		__vunmap_range_noflush(v_shadow, vmalloc_shadow(end));
 		__vunmap_range_noflush(v_origin, vmalloc_origin(end));
 		if (shadow)
-			__free_pages(shadow, 1);
+			kmsan_internal_free_meta_page(shadow);
 		if (origin)
-			__free_pages(origin, 1);
+			kmsan_internal_free_meta_page(origin);
 	}
 	flush_cache_vmap(vmalloc_shadow(start), vmalloc_shadow(end));
 	flush_cache_vmap(vmalloc_origin(start), vmalloc_origin(end));
@@ -34,6 +34,9 @@
 #define KMSAN_META_SHADOW (false)
 #define KMSAN_META_ORIGIN (true)
 
+/* Order of the shadow/origin pages allocated for ioremap ranges. */
+#define KMSAN_META_ORDER 1
+
 extern bool kmsan_enabled;
 extern int panic_on_kmsan;
 
@@ -186,6 +189,9 @@ depot_stack_handle_t kmsan_internal_chain_origin(depot_stack_handle_t id);
 void kmsan_internal_task_create(struct task_struct *task);
 
 bool kmsan_metadata_is_contiguous(void *addr, size_t size);
+struct page *kmsan_internal_alloc_meta_page(gfp_t flags);
+void kmsan_internal_free_meta_page(struct page *page);
+
 void kmsan_internal_check_memory(void *addr, size_t size, const void *user_addr,
 				 int reason);
 
@@ -10,11 +10,13 @@
 #include <asm/kmsan.h>
 #include <asm/tlbflush.h>
 #include <linux/cacheflush.h>
+#include <linux/gfp.h>
 #include <linux/memblock.h>
 #include <linux/mm_types.h>
 #include <linux/slab.h>
 #include <linux/smp.h>
 #include <linux/stddef.h>
+#include <linux/workqueue.h>
 
 #include "../internal.h"
 #include "kmsan.h"
@@ -297,3 +299,139 @@ void kmsan_setup_meta(struct page *page, struct page *shadow,
 		origin_page_for(&page[i]) = &origin[i];
 	}
 }
+
+/*
+ * Per-node pools of pre-charged, pre-zeroed metadata pages, so that mapping
+ * in metadata for large ranges does not stall on the page allocator: the
+ * hot path takes pages off the pool and a background worker refills it in
+ * batches. Returned pages are re-zeroed by the worker as well, keeping the
+ * zeroing off both the map and unmap paths.
+ */
+
+/* Target number of metadata pages kept in each node's pool. */
+#define KMSAN_META_POOL_PAGES	256
+/* Refill in the background once the pool falls below this. */
+#define KMSAN_META_POOL_LOW	(KMSAN_META_POOL_PAGES / 4)
+
+struct kmsan_meta_pool {
+	spinlock_t lock;
+	struct list_head clean_pages;
+	struct list_head dirty_pages;
+	int nr_clean;
+	struct work_struct refill_work;
+};
+
+static struct kmsan_meta_pool kmsan_meta_pools[MAX_NUMNODES];
+static bool kmsan_meta_pool_ready __read_mostly;
+
+static void kmsan_meta_pool_refill(struct work_struct *work)
+{
+	struct kmsan_meta_pool *pool =
+		container_of(work, struct kmsan_meta_pool, refill_work);
+	int nid = pool - kmsan_meta_pools;
+	struct page *page;
+	unsigned long flags;
+	LIST_HEAD(dirty);
+	int nr = 0;
+
+	/* Re-zero the returned pages and make them available again. */
+	spin_lock_irqsave(&pool->lock, flags);
+	list_splice_init(&pool->dirty_pages, &dirty);
+	spin_unlock_irqrestore(&pool->lock, flags);
+
+	list_for_each_entry(page, &dirty, lru) {
+		__memset(page_address(page), 0, PAGE_SIZE << KMSAN_META_ORDER);
+		nr++;
+	}
+
+	spin_lock_irqsave(&pool->lock, flags);
+	list_splice(&dirty, &pool->clean_pages);
+	pool->nr_clean += nr;
+	spin_unlock_irqrestore(&pool->lock, flags);
+
+	while (READ_ONCE(pool->nr_clean) < KMSAN_META_POOL_PAGES) {
+		page = alloc_pages_node(nid, GFP_KERNEL | __GFP_ZERO,
+					KMSAN_META_ORDER);
+		if (!page)
+			break;
+		spin_lock_irqsave(&pool->lock, flags);
+		list_add(&page->lru, &pool->clean_pages);
+		pool->nr_clean++;
+		spin_unlock_irqrestore(&pool->lock, flags);
+	}
+}
+
+/*
+ * Grab a pre-zeroed metadata page from the local node's pool, falling back
+ * to the page allocator while the pool is empty or not yet set up.
+ */
+struct page *kmsan_internal_alloc_meta_page(gfp_t flags)
+{
+	int nid = numa_node_id();
+	struct kmsan_meta_pool *pool = &kmsan_meta_pools[nid];
+	struct page *page = NULL;
+	unsigned long irq_flags;
+
+	if (!kmsan_meta_pool_ready)
+		return alloc_pages_node(nid, flags, KMSAN_META_ORDER);
+
+	spin_lock_irqsave(&pool->lock, irq_flags);
+	if (!list_empty(&pool->clean_pages)) {
+		page = list_first_entry(&pool->clean_pages, struct page, lru);
+		list_del(&page->lru);
+		pool->nr_clean--;
+	}
+	spin_unlock_irqrestore(&pool->lock, irq_flags);
+
+	if (READ_ONCE(pool->nr_clean) < KMSAN_META_POOL_LOW)
+		schedule_work(&pool->refill_work);
+
+	return page ?: alloc_pages_node(nid, flags, KMSAN_META_ORDER);
+}
+
+/*
+ * Return a metadata page to its node's pool. The page is dirty at this
+ * point; the refill worker re-zeroes it before reuse.
+ */
+void kmsan_internal_free_meta_page(struct page *page)
+{
+	struct kmsan_meta_pool *pool = &kmsan_meta_pools[page_to_nid(page)];
+	unsigned long flags;
+
+	if (!kmsan_meta_pool_ready ||
+	    READ_ONCE(pool->nr_clean) >= KMSAN_META_POOL_PAGES) {
+		__free_pages(page, KMSAN_META_ORDER);
+		return;
+	}
+
+	spin_lock_irqsave(&pool->lock, flags);
+	list_add(&page->lru, &pool->dirty_pages);
+	spin_unlock_irqrestore(&pool->lock, flags);
+	schedule_work(&pool->refill_work);
+}
+
+static int __init kmsan_meta_pool_init(void)
+{
+	int nid;
+
+	if (!kmsan_enabled)
+		return 0;
+
+	for (nid = 0; nid < MAX_NUMNODES; nid++) {
+		struct kmsan_meta_pool *pool = &kmsan_meta_pools[nid];
+
+		spin_lock_init(&pool->lock);
+		INIT_LIST_HEAD(&pool->clean_pages);
+		INIT_LIST_HEAD(&pool->dirty_pages);
+		INIT_WORK(&pool->refill_work, kmsan_meta_pool_refill);
+	}
+	/* Publish the pools before pre-charging them. */
+	smp_wmb();
+	kmsan_meta_pool_ready = true;
+
+	for_each_online_node(nid)
+		schedule_work(&kmsan_meta_pools[nid].refill_work);
+
+	return 0;
+}
+late_initcall(kmsan_meta_pool_init);
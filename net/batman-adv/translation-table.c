@@ -28,6 +28,7 @@
 #include <linux/net.h>
 #include <linux/netdevice.h>
 #include <linux/netlink.h>
+#include <linux/percpu.h>
 #include <linux/rculist.h>
 #include <linux/rcupdate.h>
 #include <linux/skbuff.h>
@@ -208,6 +209,122 @@ batadv_tt_global_hash_find(struct batadv_priv *bat_priv, const u8 *addr,
 	return tt_global_entry;
 }
 
+/* Timeout after which a cached destination lookup is considered stale even
+ * without a translation table event, bounding how long a metric change
+ * between multiple originators serving the same client can go unnoticed.
+ */
+#define BATADV_TT_DEST_CACHE_TIMEOUT msecs_to_jiffies(250)
+
+/**
+ * batadv_tt_dest_cache_flush() - invalidate all cached destination lookups
+ * @bat_priv: the bat priv with all the soft interface information
+ *
+ * Has to be called whenever the local or global translation table changed.
+ */
+static void batadv_tt_dest_cache_flush(struct batadv_priv *bat_priv)
+{
+	atomic_inc(&bat_priv->tt.dest_cache_gen);
+}
+
+/**
+ * batadv_tt_dest_cache_get() - try to resolve a destination from the cache
+ * @bat_priv: the bat priv with all the soft interface information
+ * @addr: mac address of the destination client
+ * @vid: VLAN identifier
+ * @gen: generation snapshot taken before the lookup started
+ *
+ * Return: the cached originator with its refcounter increased on a hit,
+ * NULL otherwise.
+ */
+static struct batadv_orig_node *
+batadv_tt_dest_cache_get(struct batadv_priv *bat_priv, const u8 *addr,
+			 unsigned short vid, u32 gen)
+{
+	struct batadv_orig_node *orig_node = NULL;
+	struct batadv_tt_dest_cache *cache;
+
+	if (!bat_priv->tt.dest_cache)
+		return NULL;
+
+	local_bh_disable();
+	cache = this_cpu_ptr(bat_priv->tt.dest_cache);
+
+	if (!cache->orig_node || cache->gen != gen ||
+	    batadv_has_timed_out(cache->timestamp,
+				 BATADV_TT_DEST_CACHE_TIMEOUT) ||
+	    cache->vid != vid ||
+	    !batadv_compare_eth(cache->addr, addr))
+		goto unlock;
+
+	if (kref_get_unless_zero(&cache->orig_node->refcount))
+		orig_node = cache->orig_node;
+
+unlock:
+	local_bh_enable();
+	return orig_node;
+}
+
+/**
+ * batadv_tt_dest_cache_store() - remember the result of a destination lookup
+ * @bat_priv: the bat priv with all the soft interface information
+ * @addr: mac address of the destination client
+ * @vid: VLAN identifier
+ * @gen: generation snapshot taken before the lookup started
+ * @orig_node: the originator the lookup resolved to
+ *
+ * Storing @gen instead of the current generation makes sure a lookup that
+ * raced with a table change can never produce a hit later on.
+ */
+static void batadv_tt_dest_cache_store(struct batadv_priv *bat_priv,
+				       const u8 *addr, unsigned short vid,
+				       u32 gen,
+				       struct batadv_orig_node *orig_node)
+{
+	struct batadv_tt_dest_cache *cache;
+	struct batadv_orig_node *old;
+
+	if (!bat_priv->tt.dest_cache)
+		return;
+
+	if (!kref_get_unless_zero(&orig_node->refcount))
+		return;
+
+	local_bh_disable();
+	cache = this_cpu_ptr(bat_priv->tt.dest_cache);
+
+	old = cache->orig_node;
+	cache->orig_node = orig_node;
+	cache->gen = gen;
+	cache->timestamp = jiffies;
+	ether_addr_copy(cache->addr, addr);
+	cache->vid = vid;
+
+	local_bh_enable();
+
+	batadv_orig_node_put(old);
+}
+
+/**
+ * batadv_tt_dest_cache_free() - drop all cached destination lookups
+ * @bat_priv: the bat priv with all the soft interface information
+ */
+static void batadv_tt_dest_cache_free(struct batadv_priv *bat_priv)
+{
+	struct batadv_tt_dest_cache *cache;
+	int cpu;
+
+	if (!bat_priv->tt.dest_cache)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		cache = per_cpu_ptr(bat_priv->tt.dest_cache, cpu);
+		batadv_orig_node_put(cache->orig_node);
+	}
+
+	free_percpu(bat_priv->tt.dest_cache);
+	bat_priv->tt.dest_cache = NULL;
+}
+
 /**
  * batadv_tt_local_entry_free_rcu() - free the tt_local_entry
  * @rcu: rcu pointer of the tt_local_entry
@@ -811,6 +928,8 @@ check_roaming:
 	if (remote_flags ^ (tt_local->common.flags & BATADV_TT_REMOTE_MASK))
 		batadv_tt_local_event(bat_priv, tt_local, BATADV_NO_FLAGS);
 
+	batadv_tt_dest_cache_flush(bat_priv);
+
 	ret = true;
 out:
 	batadv_hardif_put(in_hardif);
@@ -1293,6 +1412,8 @@ u16 batadv_tt_local_remove(struct batadv_priv *bat_priv, const u8 *addr,
 				       common.hash_entry);
 	batadv_tt_local_entry_put(tt_removed_entry);
 
+	batadv_tt_dest_cache_flush(bat_priv);
+
 out:
 	batadv_tt_local_entry_put(tt_local_entry);
 
@@ -1356,6 +1477,8 @@ static void batadv_tt_local_purge(struct batadv_priv *bat_priv,
 		batadv_tt_local_purge_list(bat_priv, head, timeout);
 		spin_unlock_bh(list_lock);
 	}
+
+	batadv_tt_dest_cache_flush(bat_priv);
 }
 
 static void batadv_tt_local_table_free(struct batadv_priv *bat_priv)
@@ -1718,6 +1841,8 @@ add_orig_entry:
 	ret = true;
 
 out_remove:
+	batadv_tt_dest_cache_flush(bat_priv);
+
 	/* Do not remove multicast addresses from the local hash on
 	 * global additions
 	 */
@@ -2177,6 +2302,7 @@ static void batadv_tt_global_del(struct batadv_priv *bat_priv,
 	}
 
 out:
+	batadv_tt_dest_cache_flush(bat_priv);
 	batadv_tt_global_entry_put(tt_global_entry);
 	batadv_tt_local_entry_put(local_entry);
 }
@@ -2237,6 +2363,7 @@ void batadv_tt_global_del_orig(struct batadv_priv *bat_priv,
 		}
 		spin_unlock_bh(list_lock);
 	}
+	batadv_tt_dest_cache_flush(bat_priv);
 	clear_bit(BATADV_ORIG_CAPA_HAS_TT, &orig_node->capa_initialized);
 }
 
@@ -2299,6 +2426,8 @@ static void batadv_tt_global_purge(struct batadv_priv *bat_priv)
 		}
 		spin_unlock_bh(list_lock);
 	}
+
+	batadv_tt_dest_cache_flush(bat_priv);
 }
 
 static void batadv_tt_global_table_free(struct batadv_priv *bat_priv)
@@ -2376,6 +2505,21 @@ struct batadv_orig_node *batadv_transtable_search(struct batadv_priv *bat_priv,
 	struct batadv_tt_global_entry *tt_global_entry = NULL;
 	struct batadv_orig_node *orig_node = NULL;
 	struct batadv_tt_orig_list_entry *best_entry;
+	bool use_cache;
+	u32 gen = 0;
+
+	/* With AP isolation enabled the result depends on the source client
+	 * as well, and the isolation toggle does not invalidate the cache,
+	 * so such lookups always consult the table directly.
+	 */
+	use_cache = !src || !batadv_vlan_ap_isola_get(bat_priv, vid);
+	if (use_cache) {
+		gen = (u32)atomic_read(&bat_priv->tt.dest_cache_gen);
+
+		orig_node = batadv_tt_dest_cache_get(bat_priv, addr, vid, gen);
+		if (orig_node)
+			return orig_node;
+	}
 
 	if (src && batadv_vlan_ap_isola_get(bat_priv, vid)) {
 		tt_local_entry = batadv_tt_local_hash_find(bat_priv, src, vid);
@@ -2404,6 +2548,10 @@ struct batadv_orig_node *batadv_transtable_search(struct batadv_priv *bat_priv,
 		orig_node = NULL;
 	rcu_read_unlock();
 
+	if (orig_node && use_cache)
+		batadv_tt_dest_cache_store(bat_priv, addr, vid, gen,
+					   orig_node);
+
 out:
 	batadv_tt_global_entry_put(tt_global_entry);
 	batadv_tt_local_entry_put(tt_local_entry);
@@ -3580,6 +3728,7 @@ void batadv_tt_free(struct batadv_priv *bat_priv)
 
 	cancel_delayed_work_sync(&bat_priv->tt.work);
 
+	batadv_tt_dest_cache_free(bat_priv);
 	batadv_tt_local_table_free(bat_priv);
 	batadv_tt_global_table_free(bat_priv);
 	batadv_tt_req_list_free(bat_priv);
@@ -4167,6 +4316,12 @@ int batadv_tt_init(struct batadv_priv *bat_priv)
 		return ret;
 	}
 
+	/* the destination cache is an optional accelerator, lookups fall back
+	 * to the global table if the allocation fails
+	 */
+	atomic_set(&bat_priv->tt.dest_cache_gen, 0);
+	bat_priv->tt.dest_cache = alloc_percpu(struct batadv_tt_dest_cache);
+
 	batadv_tvlv_handler_register(bat_priv, batadv_tt_tvlv_ogm_handler_v1,
 				     batadv_tt_tvlv_unicast_handler_v1, NULL,
 				     BATADV_TVLV_TT, 1, BATADV_NO_FLAGS);
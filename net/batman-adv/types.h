@@ -947,6 +947,26 @@ enum batadv_counters {
 /**
  * struct batadv_priv_tt - per mesh interface translation table data
  */
+/**
+ * struct batadv_tt_dest_cache - cached result of a mesh destination lookup
+ */
+struct batadv_tt_dest_cache {
+	/** @orig_node: originator serving @addr, the cache holds a reference */
+	struct batadv_orig_node *orig_node;
+
+	/** @gen: value of batadv_priv_tt::dest_cache_gen at store time */
+	u32 gen;
+
+	/** @timestamp: jiffies when the entry was stored */
+	unsigned long timestamp;
+
+	/** @addr: mac address of the destination client */
+	u8 addr[ETH_ALEN];
+
+	/** @vid: VLAN identifier the lookup was done for */
+	unsigned short vid;
+};
+
 struct batadv_priv_tt {
 	/** @vn: translation table version number */
 	atomic_t vn;
@@ -971,6 +991,15 @@ struct batadv_priv_tt {
 	/** @global_hash: global translation table hash table */
 	struct batadv_hashtable *global_hash;
 
+	/**
+	 * @dest_cache: per-CPU cache of recent batadv_transtable_search()
+	 *  results, NULL if the allocation failed at mesh init
+	 */
+	struct batadv_tt_dest_cache __percpu *dest_cache;
+
+	/** @dest_cache_gen: invalidation generation for @dest_cache */
+	atomic_t dest_cache_gen;
+
 	/** @req_list: list of pending & unanswered tt_requests */
 	struct hlist_head req_list;
 
@@ -52,11 +52,19 @@ void br_fdb_fini(void)
 
 int br_fdb_hash_init(struct net_bridge *br)
 {
-	return rhashtable_init(&br->fdb_hash_tbl, &br_fdb_rht_params);
+	int err;
+
+	err = rhashtable_init(&br->fdb_hash_tbl, &br_fdb_rht_params);
+	if (err)
+		return err;
+
+	rhashtable_walk_enter(&br->fdb_hash_tbl, &br->gc_iter);
+	return 0;
 }
 
 void br_fdb_hash_fini(struct net_bridge *br)
 {
+	rhashtable_walk_exit(&br->gc_iter);
 	rhashtable_destroy(&br->fdb_hash_tbl);
 }
 
@@ -519,22 +527,44 @@ out:
 	spin_unlock_bh(&br->hash_lock);
 }
 
+/* Entries examined per br_fdb_cleanup() invocation; bounds the time the
+ * worker spends in one go on a bridge with a huge fdb.
+ */
+#define BR_FDB_CLEANUP_BUDGET	4096
+
 void br_fdb_cleanup(struct work_struct *work)
 {
 	struct net_bridge *br = container_of(work, struct net_bridge,
 					     gc_work.work);
-	struct net_bridge_fdb_entry *f = NULL;
+	struct net_bridge_fdb_entry *f;
 	unsigned long delay = hold_time(br);
 	unsigned long work_delay = delay;
 	unsigned long now = jiffies;
+	int budget = BR_FDB_CLEANUP_BUDGET;
+	bool done = false;
 
 	/* this part is tricky, in order to avoid blocking learning and
 	 * consequently forwarding, we rely on rcu to delete objects with
-	 * delayed freeing allowing us to continue traversing
+	 * delayed freeing allowing us to continue traversing.
+	 *
+	 * The walk is also incremental: at most BR_FDB_CLEANUP_BUDGET
+	 * entries are examined per invocation and the iterator keeps its
+	 * position across invocations, so one pass over a huge fdb is
+	 * spread over several short runs of the worker.
 	 */
-	rcu_read_lock();
-	hlist_for_each_entry_rcu(f, &br->fdb_list, fdb_node) {
-		unsigned long this_timer = f->updated + delay;
+	rhashtable_walk_start(&br->gc_iter);
+	while (budget-- > 0) {
+		unsigned long this_timer;
+
+		f = rhashtable_walk_next(&br->gc_iter);
+		if (!f) {
+			done = true;
+			break;
+		}
+		if (IS_ERR(f))	/* -EAGAIN, the table was resized */
+			continue;
+
+		this_timer = READ_ONCE(f->updated) + delay;
 
 		if (test_bit(BR_FDB_STATIC, &f->flags) ||
 		    test_bit(BR_FDB_ADDED_BY_EXT_LEARN, &f->flags)) {
@@ -558,7 +588,16 @@ void br_fdb_cleanup(struct work_struct *work)
 			spin_unlock_bh(&br->hash_lock);
 		}
 	}
-	rcu_read_unlock();
+	rhashtable_walk_stop(&br->gc_iter);
+
+	if (done) {
+		/* full pass completed, park the iterator at the start */
+		rhashtable_walk_exit(&br->gc_iter);
+		rhashtable_walk_enter(&br->fdb_hash_tbl, &br->gc_iter);
+	} else {
+		/* budget exhausted, continue the pass soon */
+		work_delay = 0;
+	}
 
 	/* Cleanup minimum 10 milliseconds apart */
 	work_delay = max_t(unsigned long, work_delay, msecs_to_jiffies(10));
@@ -870,8 +909,14 @@ void br_fdb_update(struct net_bridge *br, struct net_bridge_port *source,
 			unsigned long now = jiffies;
 			bool fdb_modified = false;
 
-			if (now != fdb->updated) {
-				fdb->updated = now;
+			/* Refreshing the timestamp once per second is
+			 * plenty for the ageing timer and avoids making
+			 * the entry's cacheline bounce between the
+			 * ingress cpus on every packet of a busy flow.
+			 */
+			if (time_after(now, READ_ONCE(fdb->updated) + HZ) ||
+			    test_bit(BR_FDB_NOTIFY_INACTIVE, &fdb->flags)) {
+				WRITE_ONCE(fdb->updated, now);
 				fdb_modified = __fdb_mark_active(fdb);
 			}
 
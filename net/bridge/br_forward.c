@@ -15,6 +15,7 @@
 #include <linux/skbuff.h>
 #include <linux/if_vlan.h>
 #include <linux/netfilter_bridge.h>
+#include <linux/prefetch.h>
 #include "br_private.h"
 
 /* Don't forward packets to originating port or forwarding disabled */
@@ -288,8 +289,8 @@ void br_multicast_flood(struct net_bridge_mdb_entry *mdst,
 
 	if (mdst) {
 		p = rcu_dereference(mdst->ports);
-		if (br_multicast_should_handle_mode(brmctx, mdst->addr.proto) &&
-		    br_multicast_is_star_g(&mdst->addr))
+		if (mdst->star_g &&
+		    br_multicast_should_handle_mode(brmctx, mdst->addr.proto))
 			allow_mode_include = false;
 	} else {
 		p = NULL;
@@ -298,6 +299,9 @@ void br_multicast_flood(struct net_bridge_mdb_entry *mdst,
 	while (p || rp) {
 		struct net_bridge_port *port, *lport, *rport;
 
+		if (p)
+			prefetch(rcu_access_pointer(p->next));
+
 		lport = p ? p->key.port : NULL;
 		rport = br_multicast_rport_from_node_skb(rp, skb);
 
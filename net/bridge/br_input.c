@@ -202,8 +202,11 @@ int br_handle_frame_finish(struct net *net, struct sock *sk, struct sk_buff *skb
 		if (test_bit(BR_FDB_LOCAL, &dst->flags))
 			return br_pass_frame_up(skb);
 
-		if (now != dst->used)
-			dst->used = now;
+		/* refreshing once per second keeps the entry's cacheline
+		 * clean for the other forwarding cpus
+		 */
+		if (time_after(now, READ_ONCE(dst->used) + HZ))
+			WRITE_ONCE(dst->used, now);
 		br_forward(dst->dst, skb, local_rcv, false);
 	} else {
 		if (!mcast_hit)
@@ -366,6 +366,8 @@ struct net_bridge_mdb_entry {
 	struct net_bridge_port_group __rcu *ports;
 	struct br_ip			addr;
 	bool				host_joined;
+	/* cached br_multicast_is_star_g(&addr), addr never changes */
+	bool				star_g;
 
 	struct timer_list		timer;
 	struct hlist_node		mdb_node;
@@ -549,6 +551,8 @@ struct net_bridge {
 	struct timer_list		tcn_timer;
 	struct timer_list		topology_change_timer;
 	struct delayed_work		gc_work;
+	/* position of the incremental fdb gc walk, only used by gc_work */
+	struct rhashtable_iter		gc_iter;
 	struct kobject			*ifobj;
 	u32				auto_cnt;
 
@@ -644,6 +644,7 @@ void ceph_con_init(struct ceph_connection *con, void *private,
 	INIT_LIST_HEAD(&con->out_queue);
 	INIT_LIST_HEAD(&con->out_sent);
 	INIT_DELAYED_WORK(&con->work, ceph_con_workfn);
+	con->sched_cpu = -1;
 
 	con->state = CEPH_CON_S_CLOSED;
 }
@@ -1366,6 +1367,8 @@ void ceph_con_process_message(struct ceph_connection *con)
  */
 static int queue_con_delay(struct ceph_connection *con, unsigned long delay)
 {
+	int cpu = READ_ONCE(con->sched_cpu);
+
 	if (!con->ops->get(con)) {
 		dout("%s %p ref count 0\n", __func__, con);
 		return -ENOENT;
@@ -1374,8 +1377,15 @@ static int queue_con_delay(struct ceph_connection *con, unsigned long delay)
 	if (delay >= HZ)
 		delay = round_jiffies_relative(delay);
 
+	/* Prefer the cpu of the last thread that queued a message so
+	 * that crc/crypto work stays local to the submitter instead of
+	 * following the socket's softirq cpu.
+	 */
+	if (cpu < 0 || !cpu_online(cpu))
+		cpu = WORK_CPU_UNBOUND;
+
 	dout("%s %p %lu\n", __func__, con, delay);
-	if (!queue_delayed_work(ceph_msgr_wq, &con->work, delay)) {
+	if (!queue_delayed_work_on(cpu, ceph_msgr_wq, &con->work, delay)) {
 		dout("%s %p - already queued\n", __func__, con);
 		con->ops->put(con);
 		return -EBUSY;
@@ -1677,6 +1687,7 @@ void ceph_con_send(struct ceph_connection *con, struct ceph_msg *msg)
 	}
 
 	msg_con_set(msg, con);
+	WRITE_ONCE(con->sched_cpu, raw_smp_processor_id());
 
 	BUG_ON(!list_empty(&msg->list_head));
 	list_add_tail(&msg->list_head, &con->out_queue);
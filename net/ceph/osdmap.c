@@ -4,6 +4,7 @@
 
 #include <linux/module.h>
 #include <linux/slab.h>
+#include <linux/hash.h>
 
 #include <linux/ceph/libceph.h>
 #include <linux/ceph/osdmap.h>
@@ -1120,9 +1121,38 @@ wake:
 /*
  * osd map
  */
+/*
+ * Cache of recently computed placements.
+ *
+ * CRUSH placement is deterministic for a given map, so a PG's up and
+ * acting sets can be reused until the map changes.  The cache is
+ * direct-mapped and sized for the PG working set of a busy client.
+ * An incremental map update invalidates it wholesale by bumping the
+ * map's generation; a full map swap starts with a fresh, empty cache.
+ */
+#define CEPH_PG_CACHE_BITS	7
+#define CEPH_PG_CACHE_SIZE	(1 << CEPH_PG_CACHE_BITS)
+
+struct ceph_pg_cache_entry {
+	spinlock_t lock;
+	u32 gen;		/* map->pg_cache_gen at fill time, 0 = unused */
+	struct ceph_pg pgid;
+	struct ceph_osds up;
+	struct ceph_osds acting;
+};
+
+static struct ceph_pg_cache_entry *pg_cache_entry(struct ceph_osdmap *map,
+						  const struct ceph_pg *pgid)
+{
+	u32 h = hash_64((u64)pgid->seed ^ pgid->pool, CEPH_PG_CACHE_BITS);
+
+	return &map->pg_cache[h];
+}
+
 struct ceph_osdmap *ceph_osdmap_alloc(void)
 {
 	struct ceph_osdmap *map;
+	int i;
 
 	map = kzalloc(sizeof(*map), GFP_NOIO);
 	if (!map)
@@ -1137,6 +1167,15 @@ struct ceph_osdmap *ceph_osdmap_alloc(void)
 
 	init_workspace_manager(&map->crush_wsm);
 
+	/* the map works without the cache, don't fail on ENOMEM */
+	map->pg_cache = kvcalloc(CEPH_PG_CACHE_SIZE, sizeof(*map->pg_cache),
+				 GFP_NOIO);
+	if (map->pg_cache) {
+		for (i = 0; i < CEPH_PG_CACHE_SIZE; i++)
+			spin_lock_init(&map->pg_cache[i].lock);
+		map->pg_cache_gen = 1;
+	}
+
 	return map;
 }
 
@@ -1186,6 +1225,7 @@ void ceph_osdmap_destroy(struct ceph_osdmap *map)
 	kvfree(map->osd_weight);
 	kvfree(map->osd_addr);
 	kvfree(map->osd_primary_affinity);
+	kvfree(map->pg_cache);
 	kfree(map);
 }
 
@@ -2101,6 +2141,10 @@ struct ceph_osdmap *osdmap_apply_incremental(void **p, void *end, bool msgr2,
 	/* ignore the rest */
 	*p = end;
 
+	/* placements may have changed, invalidate all cached ones */
+	if (map->pg_cache && ++map->pg_cache_gen == 0)
+		map->pg_cache_gen = 1;
+
 	dout("inc osdmap epoch %d max_osd %d\n", map->epoch, map->max_osd);
 	return map;
 
@@ -2819,12 +2863,26 @@ void ceph_pg_to_up_acting_osds(struct ceph_osdmap *osdmap,
 			       struct ceph_osds *up,
 			       struct ceph_osds *acting)
 {
+	struct ceph_pg_cache_entry *ent = NULL;
 	struct ceph_pg pgid;
 	u32 pps;
 
 	WARN_ON(pi->id != raw_pgid->pool);
 	raw_pg_to_pg(pi, raw_pgid, &pgid);
 
+	if (osdmap->pg_cache) {
+		ent = pg_cache_entry(osdmap, &pgid);
+		spin_lock(&ent->lock);
+		if (ent->gen == osdmap->pg_cache_gen &&
+		    !ceph_pg_compare(&ent->pgid, &pgid)) {
+			*up = ent->up;
+			*acting = ent->acting;
+			spin_unlock(&ent->lock);
+			return;
+		}
+		spin_unlock(&ent->lock);
+	}
+
 	pg_to_raw_osds(osdmap, pi, raw_pgid, up, &pps);
 	apply_upmap(osdmap, &pgid, up);
 	raw_to_up_osds(osdmap, pi, up);
@@ -2837,6 +2895,15 @@ void ceph_pg_to_up_acting_osds(struct ceph_osdmap *osdmap,
 			acting->primary = up->primary;
 	}
 	WARN_ON(!osds_valid(up) || !osds_valid(acting));
+
+	if (ent) {
+		spin_lock(&ent->lock);
+		ent->pgid = pgid; /* struct */
+		ent->up = *up;
+		ent->acting = *acting;
+		ent->gen = osdmap->pg_cache_gen;
+		spin_unlock(&ent->lock);
+	}
 }
 
 bool ceph_pg_to_primary_shard(struct ceph_osdmap *osdmap,
@@ -32,7 +32,7 @@
 struct dsa_switchdev_event_work {
 	struct net_device *dev;
 	struct net_device *orig_dev;
-	struct work_struct work;
+	struct list_head list;
 	unsigned long event;
 	/* Specific for SWITCHDEV_FDB_ADD_TO_DEVICE and
 	 * SWITCHDEV_FDB_DEL_TO_DEVICE
@@ -3437,10 +3437,9 @@ dsa_fdb_offload_notify(struct dsa_switchdev_event_work *switchdev_work)
 				 switchdev_work->orig_dev, &info.info, NULL);
 }
 
-static void dsa_slave_switchdev_event_work(struct work_struct *work)
+static void
+dsa_slave_fdb_event_work_one(struct dsa_switchdev_event_work *switchdev_work)
 {
-	struct dsa_switchdev_event_work *switchdev_work =
-		container_of(work, struct dsa_switchdev_event_work, work);
 	const unsigned char *addr = switchdev_work->addr;
 	struct net_device *dev = switchdev_work->dev;
 	u16 vid = switchdev_work->vid;
@@ -3483,10 +3482,38 @@ static void dsa_slave_switchdev_event_work(struct work_struct *work)
 
 		break;
 	}
+}
+
+/* FDB events are coalesced on a single list drained by one work item, so
+ * that a learning burst after a topology change is handled in one worker
+ * invocation instead of waking the ordered workqueue once per entry.
+ */
+static DEFINE_SPINLOCK(dsa_fdb_pending_lock);
+static LIST_HEAD(dsa_fdb_pending_list);
+
+static void dsa_slave_switchdev_event_work(struct work_struct *work)
+{
+	struct dsa_switchdev_event_work *switchdev_work, *tmp;
+	LIST_HEAD(batch);
+
+	for (;;) {
+		spin_lock_bh(&dsa_fdb_pending_lock);
+		list_splice_init(&dsa_fdb_pending_list, &batch);
+		spin_unlock_bh(&dsa_fdb_pending_lock);
+
+		if (list_empty(&batch))
+			break;
 
-	kfree(switchdev_work);
+		list_for_each_entry_safe(switchdev_work, tmp, &batch, list) {
+			list_del(&switchdev_work->list);
+			dsa_slave_fdb_event_work_one(switchdev_work);
+			kfree(switchdev_work);
+		}
+	}
 }
 
+static DECLARE_WORK(dsa_fdb_pending_work, dsa_slave_switchdev_event_work);
+
 static bool dsa_foreign_dev_check(const struct net_device *dev,
 				  const struct net_device *foreign_dev)
 {
@@ -3508,7 +3535,7 @@ static int dsa_slave_fdb_event(struct net_device *dev,
 			       unsigned long event, const void *ctx,
 			       const struct switchdev_notifier_fdb_info *fdb_info)
 {
-	struct dsa_switchdev_event_work *switchdev_work;
+	struct dsa_switchdev_event_work *switchdev_work, *pending;
 	struct dsa_port *dp = dsa_slave_to_port(dev);
 	bool host_addr = fdb_info->is_local;
 	struct dsa_switch *ds = dp->ds;
@@ -3558,7 +3585,6 @@ static int dsa_slave_fdb_event(struct net_device *dev,
 		   orig_dev->name, fdb_info->addr, fdb_info->vid,
 		   host_addr ? " as host address" : "");
 
-	INIT_WORK(&switchdev_work->work, dsa_slave_switchdev_event_work);
 	switchdev_work->event = event;
 	switchdev_work->dev = dev;
 	switchdev_work->orig_dev = orig_dev;
@@ -3567,7 +3593,37 @@ static int dsa_slave_fdb_event(struct net_device *dev,
 	switchdev_work->vid = fdb_info->vid;
 	switchdev_work->host_addr = host_addr;
 
-	dsa_schedule_work(&switchdev_work->work);
+	spin_lock_bh(&dsa_fdb_pending_lock);
+
+	/* If the most recent pending event for this address is the opposite
+	 * of the new one, the two cancel out and the switch need not be
+	 * touched at all. Only the newest pending event may be elided, to
+	 * preserve the order of the remaining ones.
+	 */
+	list_for_each_entry_reverse(pending, &dsa_fdb_pending_list, list) {
+		if (pending->dev != dev ||
+		    pending->orig_dev != orig_dev ||
+		    pending->vid != fdb_info->vid ||
+		    pending->host_addr != host_addr ||
+		    !ether_addr_equal(pending->addr, fdb_info->addr))
+			continue;
+
+		if (pending->event != event) {
+			list_del(&pending->list);
+			kfree(pending);
+			kfree(switchdev_work);
+			switchdev_work = NULL;
+		}
+		break;
+	}
+
+	if (switchdev_work)
+		list_add_tail(&switchdev_work->list, &dsa_fdb_pending_list);
+
+	spin_unlock_bh(&dsa_fdb_pending_lock);
+
+	if (switchdev_work)
+		dsa_schedule_work(&dsa_fdb_pending_work);
 
 	return 0;
 }
@@ -795,6 +795,9 @@ static int ethnl_netdev_event(struct notifier_block *this, unsigned long event,
 	case NETDEV_FEAT_CHANGE:
 		ethnl_notify_features(ptr);
 		break;
+	case NETDEV_UNREGISTER:
+		ethnl_stats_cache_flush(netdev_notifier_info_to_dev(ptr));
+		break;
 	}
 
 	return NOTIFY_DONE;
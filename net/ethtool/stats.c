@@ -27,6 +27,50 @@ struct stats_reply_data {
 #define STATS_REPDATA(__reply_base) \
 	container_of(__reply_base, struct stats_reply_data, base)
 
+/* Concurrent monitoring clients usually poll the same counter groups in
+ * lockstep, and every request costs a driver call which may be a firmware
+ * round trip. Keep the most recent poll per device and source for a short
+ * while so the clients share it. Counters are point-in-time samples, so a
+ * snapshot a few jiffies old is indistinguishable from a fresh one as far
+ * as user space is concerned.
+ */
+#define STATS_CACHE_TIMEOUT	(HZ / 10)
+
+struct stats_cache_entry {
+	struct list_head		list;
+	struct net_device		*dev;
+	enum ethtool_mac_stats_src	src;
+	unsigned long			updated;
+	DECLARE_BITMAP(stat_mask, __ETHTOOL_STATS_CNT);
+	struct stats_reply_data		data;
+};
+
+/* Protected by RTNL, as are all prepare_data calls and netdev notifiers. */
+static LIST_HEAD(stats_cache);
+
+static struct stats_cache_entry *
+stats_cache_find(struct net_device *dev, enum ethtool_mac_stats_src src)
+{
+	struct stats_cache_entry *entry;
+
+	list_for_each_entry(entry, &stats_cache, list)
+		if (entry->dev == dev && entry->src == src)
+			return entry;
+	return NULL;
+}
+
+void ethnl_stats_cache_flush(struct net_device *dev)
+{
+	struct stats_cache_entry *entry, *tmp;
+
+	list_for_each_entry_safe(entry, tmp, &stats_cache, list) {
+		if (entry->dev == dev) {
+			list_del(&entry->list);
+			kfree(entry);
+		}
+	}
+}
+
 const char stats_std_names[__ETHTOOL_STATS_CNT][ETH_GSTRING_LEN] = {
 	[ETHTOOL_STATS_ETH_PHY]			= "eth-phy",
 	[ETHTOOL_STATS_ETH_MAC]			= "eth-mac",
@@ -121,6 +165,7 @@ static int stats_prepare_data(const struct ethnl_req_info *req_base,
 	struct stats_reply_data *data = STATS_REPDATA(reply_base);
 	enum ethtool_mac_stats_src src = req_info->src;
 	struct net_device *dev = reply_base->dev;
+	struct stats_cache_entry *entry;
 	int ret;
 
 	ret = ethnl_ops_begin(dev);
@@ -136,6 +181,16 @@ static int stats_prepare_data(const struct ethnl_req_info *req_base,
 		return -EOPNOTSUPP;
 	}
 
+	entry = stats_cache_find(dev, src);
+	if (entry && time_before(jiffies, entry->updated + STATS_CACHE_TIMEOUT) &&
+	    bitmap_subset(req_info->stat_mask, entry->stat_mask,
+			  __ETHTOOL_STATS_CNT)) {
+		memcpy(&data->stats, &entry->data.stats, sizeof(data->stats));
+		data->rmon_ranges = entry->data.rmon_ranges;
+		ethnl_ops_complete(dev);
+		return 0;
+	}
+
 	/* Mark all stats as unset (see ETHTOOL_STAT_NOT_SET) to prevent them
 	 * from being reported to user space in case driver did not set them.
 	 */
@@ -160,6 +215,22 @@ static int stats_prepare_data(const struct ethnl_req_info *req_base,
 		dev->ethtool_ops->get_rmon_stats(dev, &data->rmon_stats,
 						 &data->rmon_ranges);
 
+	if (!entry) {
+		entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+		if (entry) {
+			entry->dev = dev;
+			entry->src = src;
+			list_add(&entry->list, &stats_cache);
+		}
+	}
+	if (entry) {
+		memcpy(&entry->data.stats, &data->stats, sizeof(data->stats));
+		entry->data.rmon_ranges = data->rmon_ranges;
+		bitmap_copy(entry->stat_mask, req_info->stat_mask,
+			    __ETHTOOL_STATS_CNT);
+		entry->updated = jiffies;
+	}
+
 	ethnl_ops_complete(dev);
 	return 0;
 }
@@ -315,7 +315,7 @@ end:
 	mptcp_set_owner_r(skb, sk);
 }
 
-static bool mptcp_rmem_schedule(struct sock *sk, struct sock *ssk, int size)
+static bool mptcp_rmem_schedule(struct sock *sk, int size)
 {
 	struct mptcp_sock *msk = mptcp_sk(sk);
 	int amt, amount;
@@ -333,57 +333,47 @@ static bool mptcp_rmem_schedule(struct sock *sk, struct sock *ssk, int size)
 	return true;
 }
 
-static bool __mptcp_move_skb(struct mptcp_sock *msk, struct sock *ssk,
-			     struct sk_buff *skb, unsigned int offset,
-			     size_t copy_len)
+/* Merge a batch of staged skbs into the msk receive/out-of-order queues;
+ * must be called under the msk data lock.  @bytes is incremented by the
+ * amount of in-sequence data made available to the reader.
+ */
+static void __mptcp_merge_staged_skbs(struct mptcp_sock *msk,
+				      struct sk_buff_head *staged,
+				      unsigned int *bytes)
 {
-	struct mptcp_subflow_context *subflow = mptcp_subflow_ctx(ssk);
 	struct sock *sk = (struct sock *)msk;
-	struct sk_buff *tail;
-	bool has_rxtstamp;
-
-	__skb_unlink(skb, &ssk->sk_receive_queue);
-
-	skb_ext_reset(skb);
-	skb_orphan(skb);
+	struct sk_buff *skb, *tail;
 
-	/* try to fetch required memory from subflow */
-	if (!mptcp_rmem_schedule(sk, ssk, skb->truesize))
-		goto drop;
+	while ((skb = __skb_dequeue(staged)) != NULL) {
+		size_t copy_len = MPTCP_SKB_CB(skb)->end_seq -
+				  MPTCP_SKB_CB(skb)->map_seq;
 
-	has_rxtstamp = TCP_SKB_CB(skb)->has_rxtstamp;
+		/* try to fetch required memory from subflow */
+		if (!mptcp_rmem_schedule(sk, skb->truesize)) {
+			mptcp_drop(sk, skb);
+			continue;
+		}
 
-	/* the skb map_seq accounts for the skb offset:
-	 * mptcp_subflow_get_mapped_dsn() is based on the current tp->copied_seq
-	 * value
-	 */
-	MPTCP_SKB_CB(skb)->map_seq = mptcp_subflow_get_mapped_dsn(subflow);
-	MPTCP_SKB_CB(skb)->end_seq = MPTCP_SKB_CB(skb)->map_seq + copy_len;
-	MPTCP_SKB_CB(skb)->offset = offset;
-	MPTCP_SKB_CB(skb)->has_rxtstamp = has_rxtstamp;
-
-	if (MPTCP_SKB_CB(skb)->map_seq == msk->ack_seq) {
-		/* in sequence */
-		WRITE_ONCE(msk->ack_seq, msk->ack_seq + copy_len);
-		tail = skb_peek_tail(&sk->sk_receive_queue);
-		if (tail && mptcp_try_coalesce(sk, tail, skb))
-			return true;
+		if (MPTCP_SKB_CB(skb)->map_seq == msk->ack_seq) {
+			/* in sequence */
+			WRITE_ONCE(msk->ack_seq, msk->ack_seq + copy_len);
+			*bytes += copy_len;
+			tail = skb_peek_tail(&sk->sk_receive_queue);
+			if (tail && mptcp_try_coalesce(sk, tail, skb))
+				continue;
 
-		mptcp_set_owner_r(skb, sk);
-		__skb_queue_tail(&sk->sk_receive_queue, skb);
-		return true;
-	} else if (after64(MPTCP_SKB_CB(skb)->map_seq, msk->ack_seq)) {
-		mptcp_data_queue_ofo(msk, skb);
-		return false;
+			mptcp_set_owner_r(skb, sk);
+			__skb_queue_tail(&sk->sk_receive_queue, skb);
+		} else if (after64(MPTCP_SKB_CB(skb)->map_seq, msk->ack_seq)) {
+			mptcp_data_queue_ofo(msk, skb);
+		} else {
+			/* old data, keep it simple and drop the whole pkt,
+			 * sender will retransmit as needed, if needed.
+			 */
+			MPTCP_INC_STATS(sock_net(sk), MPTCP_MIB_DUPDATA);
+			mptcp_drop(sk, skb);
+		}
 	}
-
-	/* old data, keep it simple and drop the whole pkt, sender
-	 * will retransmit as needed, if needed.
-	 */
-	MPTCP_INC_STATS(sock_net(sk), MPTCP_MIB_DUPDATA);
-drop:
-	mptcp_drop(sk, skb);
-	return false;
 }
 
 static void mptcp_stop_timer(struct sock *sk)
@@ -616,13 +606,18 @@ static bool mptcp_check_data_fin(struct sock *sk)
 	return ret;
 }
 
-static bool __mptcp_move_skbs_from_subflow(struct mptcp_sock *msk,
-					   struct sock *ssk,
-					   unsigned int *bytes)
+/* Move the skbs from the subflow receive queue to a private staging
+ * list, annotating each with its MPTCP-level sequence numbers.  This
+ * only needs the subflow socket lock, so the per-skb mapping work runs
+ * without serializing the other subflows on the msk data lock; the
+ * staged batch is later merged via __mptcp_merge_staged_skbs().
+ */
+static bool __mptcp_stage_skbs_from_subflow(struct mptcp_sock *msk,
+					    struct sock *ssk,
+					    struct sk_buff_head *staged)
 {
 	struct mptcp_subflow_context *subflow = mptcp_subflow_ctx(ssk);
 	struct sock *sk = (struct sock *)msk;
-	unsigned int moved = 0;
 	bool more_data_avail;
 	struct tcp_sock *tp;
 	bool done = false;
@@ -657,7 +652,7 @@ static bool __mptcp_move_skbs_from_subflow(struct mptcp_sock *msk,
 			 * a different CPU can have already processed the pending
 			 * data, stop here or we can enter an infinite loop
 			 */
-			if (!moved)
+			if (skb_queue_empty(staged))
 				done = true;
 			break;
 		}
@@ -680,12 +675,28 @@ static bool __mptcp_move_skbs_from_subflow(struct mptcp_sock *msk,
 
 		if (offset < skb->len) {
 			size_t len = skb->len - offset;
+			bool has_rxtstamp;
 
 			if (tp->urg_data)
 				done = true;
 
-			if (__mptcp_move_skb(msk, ssk, skb, offset, len))
-				moved += len;
+			__skb_unlink(skb, &ssk->sk_receive_queue);
+			skb_ext_reset(skb);
+			skb_orphan(skb);
+
+			has_rxtstamp = TCP_SKB_CB(skb)->has_rxtstamp;
+
+			/* the skb map_seq accounts for the skb offset:
+			 * mptcp_subflow_get_mapped_dsn() is based on the
+			 * current tp->copied_seq value
+			 */
+			MPTCP_SKB_CB(skb)->map_seq =
+				mptcp_subflow_get_mapped_dsn(subflow);
+			MPTCP_SKB_CB(skb)->end_seq =
+				MPTCP_SKB_CB(skb)->map_seq + len;
+			MPTCP_SKB_CB(skb)->offset = offset;
+			MPTCP_SKB_CB(skb)->has_rxtstamp = has_rxtstamp;
+			__skb_queue_tail(staged, skb);
 			seq += len;
 
 			if (WARN_ON_ONCE(map_remaining < len))
@@ -705,7 +716,6 @@ static bool __mptcp_move_skbs_from_subflow(struct mptcp_sock *msk,
 		}
 	} while (more_data_avail);
 
-	*bytes += moved;
 	return done;
 }
 
@@ -756,12 +766,13 @@ static bool __mptcp_ofo_queue(struct mptcp_sock *msk)
 /* In most cases we will be able to lock the mptcp socket.  If its already
  * owned, we need to defer to the work queue to avoid ABBA deadlock.
  */
-static bool move_skbs_to_msk(struct mptcp_sock *msk, struct sock *ssk)
+static bool move_skbs_to_msk(struct mptcp_sock *msk, struct sock *ssk,
+			     struct sk_buff_head *staged)
 {
 	struct sock *sk = (struct sock *)msk;
 	unsigned int moved = 0;
 
-	__mptcp_move_skbs_from_subflow(msk, ssk, &moved);
+	__mptcp_merge_staged_skbs(msk, staged, &moved);
 	__mptcp_ofo_queue(msk);
 	if (unlikely(ssk->sk_err)) {
 		if (!sock_owned_by_user(sk))
@@ -784,6 +795,7 @@ void mptcp_data_ready(struct sock *sk, struct sock *ssk)
 {
 	struct mptcp_subflow_context *subflow = mptcp_subflow_ctx(ssk);
 	struct mptcp_sock *msk = mptcp_sk(sk);
+	struct sk_buff_head staged;
 	int sk_rbuf, ssk_rbuf;
 
 	/* The peer can send data while we are shutting down this
@@ -804,9 +816,15 @@ void mptcp_data_ready(struct sock *sk, struct sock *ssk)
 		return;
 	}
 
+	/* annotate the batch before taking the msk data lock, so that
+	 * the mapping work does not serialize the other subflows
+	 */
+	__skb_queue_head_init(&staged);
+	__mptcp_stage_skbs_from_subflow(msk, ssk, &staged);
+
 	/* Wake-up the reader only for in-sequence data */
 	mptcp_data_lock(sk);
-	if (move_skbs_to_msk(msk, ssk))
+	if (move_skbs_to_msk(msk, ssk, &staged))
 		sk->sk_data_ready(sk);
 
 	mptcp_data_unlock(sk);
@@ -1391,11 +1409,11 @@ bool mptcp_subflow_active(struct mptcp_subflow_context *subflow)
 #define SSK_MODE_BACKUP	1
 #define SSK_MODE_MAX	2
 
-/* implement the mptcp packet scheduler;
+/* implement the default mptcp packet scheduler;
  * returns the subflow that will transmit the next DSS
  * additionally updates the rtx timeout
  */
-static struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk)
+struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk)
 {
 	struct subflow_send_info send_info[SSK_MODE_MAX];
 	struct mptcp_subflow_context *subflow;
@@ -1437,6 +1455,16 @@ static struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk)
 
 		tout = max(tout, mptcp_timeout_from_subflow(subflow));
 		nr_active += !subflow->backup;
+
+		/* A subflow with an exhausted send buffer must not stall the
+		 * others: leave it out of the election and reconsider it once
+		 * it has room again.  It still counts as active above, so a
+		 * merely saturated subflow does not force a backup one into
+		 * service.
+		 */
+		if (!sk_stream_memory_free(ssk))
+			continue;
+
 		pace = subflow->avg_pacing_rate;
 		if (unlikely(!pace)) {
 			/* init pacing rate from socket */
@@ -1545,7 +1573,7 @@ void __mptcp_push_pending(struct sock *sk, unsigned int flags)
 			int ret = 0;
 
 			prev_ssk = ssk;
-			ssk = mptcp_subflow_get_send(msk);
+			ssk = mptcp_sched_get_send(msk);
 
 			/* First check. If the ssk has changed since
 			 * the last round, release prev_ssk
@@ -1612,7 +1640,7 @@ static void __mptcp_subflow_push_pending(struct sock *sk, struct sock *ssk, bool
 			/* check for a different subflow usage only after
 			 * spooling the first chunk of data
 			 */
-			xmit_ssk = first ? ssk : mptcp_subflow_get_send(msk);
+			xmit_ssk = first ? ssk : mptcp_sched_get_send(msk);
 			if (!xmit_ssk)
 				goto out;
 			if (xmit_ssk != ssk) {
@@ -2002,6 +2030,7 @@ static bool __mptcp_move_skbs(struct mptcp_sock *msk)
 
 	do {
 		struct sock *ssk = mptcp_subflow_recv_lookup(msk);
+		struct sk_buff_head staged;
 		bool slowpath;
 
 		/* we can have data pending in the subflows only if the msk
@@ -2012,9 +2041,11 @@ static bool __mptcp_move_skbs(struct mptcp_sock *msk)
 			break;
 
 		slowpath = lock_sock_fast(ssk);
+		__skb_queue_head_init(&staged);
+		done = __mptcp_stage_skbs_from_subflow(msk, ssk, &staged);
 		mptcp_data_lock(sk);
 		__mptcp_update_rmem(sk);
-		done = __mptcp_move_skbs_from_subflow(msk, ssk, &moved);
+		__mptcp_merge_staged_skbs(msk, &staged, &moved);
 		mptcp_data_unlock(sk);
 
 		if (unlikely(ssk->sk_err))
@@ -2694,6 +2725,10 @@ static int __mptcp_init_sock(struct sock *sk)
 
 	mptcp_pm_data_init(msk);
 
+	rcu_read_lock();
+	mptcp_init_sched(msk, mptcp_sched_find(mptcp_get_scheduler(sock_net(sk))));
+	rcu_read_unlock();
+
 	/* re-use the csk retrans timer for MPTCP-level retrans */
 	timer_setup(&msk->sk.icsk_retransmit_timer, mptcp_retransmit_timer, 0);
 	timer_setup(&sk->sk_timer, mptcp_timeout_timer, 0);
@@ -3219,6 +3254,7 @@ static void mptcp_destroy(struct sock *sk)
 	 */
 	mptcp_dispose_initial_subflow(msk);
 	mptcp_destroy_common(msk, 0);
+	mptcp_release_sched(msk);
 	sk_sockets_allocated_dec(sk);
 }
 
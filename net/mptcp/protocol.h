@@ -255,6 +255,23 @@ struct mptcp_data_frag {
 	struct page *page;
 };
 
+#define MPTCP_SCHED_NAME_MAX	16
+
+struct mptcp_sock;
+
+/* MPTCP packet scheduler: elects the subflow that will carry the next
+ * DSS.  get_send() is invoked under the msk socket lock and may update
+ * the msk burst state; schedulers are registered at boot (or module
+ * load) and selected per namespace via the "scheduler" sysctl.
+ */
+struct mptcp_sched_ops {
+	struct sock *(*get_send)(struct mptcp_sock *msk);
+
+	char			name[MPTCP_SCHED_NAME_MAX];
+	struct module		*owner;
+	struct list_head	list;
+};
+
 /* MPTCP connection sock */
 struct mptcp_sock {
 	/* inet_connection_sock must be the first member */
@@ -318,6 +335,7 @@ struct mptcp_sock {
 
 	u32 setsockopt_seq;
 	char		ca_name[TCP_CA_NAME_MAX];
+	struct mptcp_sched_ops	*sched;
 	struct mptcp_sock	*dl_next;
 };
 
@@ -616,7 +634,16 @@ int mptcp_is_checksum_enabled(const struct net *net);
 int mptcp_allow_join_id0(const struct net *net);
 unsigned int mptcp_stale_loss_cnt(const struct net *net);
 int mptcp_get_pm_type(const struct net *net);
+const char *mptcp_get_scheduler(const struct net *net);
 void mptcp_copy_inaddrs(struct sock *msk, const struct sock *ssk);
+struct mptcp_sched_ops *mptcp_sched_find(const char *name);
+int mptcp_register_scheduler(struct mptcp_sched_ops *sched);
+void mptcp_unregister_scheduler(struct mptcp_sched_ops *sched);
+void __init mptcp_sched_init(void);
+void mptcp_init_sched(struct mptcp_sock *msk, struct mptcp_sched_ops *sched);
+void mptcp_release_sched(struct mptcp_sock *msk);
+struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk);
+struct sock *mptcp_sched_get_send(struct mptcp_sock *msk);
 void mptcp_subflow_fully_established(struct mptcp_subflow_context *subflow,
 				     const struct mptcp_options_received *mp_opt);
 bool __mptcp_retransmit_pending_data(struct sock *sk);
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-2.0
+/* Multipath TCP
+ *
+ * Copyright (c) 2023, SUSE.
+ */
+
+#define pr_fmt(fmt) "MPTCP: " fmt
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/list.h>
+#include <linux/rculist.h>
+#include <linux/spinlock.h>
+#include "protocol.h"
+
+static DEFINE_SPINLOCK(mptcp_sched_list_lock);
+static LIST_HEAD(mptcp_sched_list);
+
+/* The default scheduler wraps the historic in-kernel election: reuse
+ * the last subflow while the burst allows it, otherwise pick the
+ * subflow with the lowest estimated linger time.
+ */
+static struct mptcp_sched_ops mptcp_sched_default = {
+	.get_send	= mptcp_subflow_get_send,
+	.name		= "default",
+	.owner		= THIS_MODULE,
+};
+
+/* Amount of enqueued-but-unsent data above which a transfer stops
+ * being considered latency-sensitive and is striped over every
+ * available subflow instead.
+ */
+#define MPTCP_SCHED_LOWLAT_THRESH	(16 * 1024)
+
+/* Keep short, latency-sensitive writes on the subflow with the lowest
+ * RTT; bulk transfers gain more from striping than they lose from
+ * receiver-side reordering, so hand them to the default election.
+ */
+static struct sock *mptcp_sched_lowlat_get_send(struct mptcp_sock *msk)
+{
+	struct mptcp_subflow_context *subflow;
+	struct sock *best = NULL;
+	u32 best_srtt = ~0U;
+
+	if (msk->write_seq - msk->snd_nxt > MPTCP_SCHED_LOWLAT_THRESH)
+		return mptcp_subflow_get_send(msk);
+
+	mptcp_for_each_subflow(msk, subflow) {
+		struct sock *ssk = mptcp_subflow_tcp_sock(subflow);
+		u32 srtt;
+
+		if (!mptcp_subflow_active(subflow) || subflow->backup)
+			continue;
+		if (!sk_stream_memory_free(ssk))
+			continue;
+
+		srtt = READ_ONCE(tcp_sk(ssk)->srtt_us);
+		if (srtt < best_srtt) {
+			best_srtt = srtt;
+			best = ssk;
+		}
+	}
+
+	if (!best)
+		return mptcp_subflow_get_send(msk);
+
+	/* short writes don't build up a burst worth reusing */
+	msk->last_snd = best;
+	msk->snd_burst = 0;
+	return best;
+}
+
+static struct mptcp_sched_ops mptcp_sched_lowlat = {
+	.get_send	= mptcp_sched_lowlat_get_send,
+	.name		= "lowlatency",
+	.owner		= THIS_MODULE,
+};
+
+/* Must be called with rcu read lock held */
+struct mptcp_sched_ops *mptcp_sched_find(const char *name)
+{
+	struct mptcp_sched_ops *sched, *ret = NULL;
+
+	list_for_each_entry_rcu(sched, &mptcp_sched_list, list) {
+		if (!strcmp(sched->name, name)) {
+			ret = sched;
+			break;
+		}
+	}
+
+	return ret;
+}
+
+int mptcp_register_scheduler(struct mptcp_sched_ops *sched)
+{
+	if (!sched->get_send)
+		return -EINVAL;
+
+	spin_lock(&mptcp_sched_list_lock);
+	if (mptcp_sched_find(sched->name)) {
+		spin_unlock(&mptcp_sched_list_lock);
+		return -EEXIST;
+	}
+	list_add_tail_rcu(&sched->list, &mptcp_sched_list);
+	spin_unlock(&mptcp_sched_list_lock);
+
+	pr_debug("%s registered", sched->name);
+	return 0;
+}
+
+void mptcp_unregister_scheduler(struct mptcp_sched_ops *sched)
+{
+	if (sched == &mptcp_sched_default)
+		return;
+
+	spin_lock(&mptcp_sched_list_lock);
+	list_del_rcu(&sched->list);
+	spin_unlock(&mptcp_sched_list_lock);
+	synchronize_rcu();
+}
+
+void __init mptcp_sched_init(void)
+{
+	mptcp_register_scheduler(&mptcp_sched_default);
+	mptcp_register_scheduler(&mptcp_sched_lowlat);
+}
+
+void mptcp_init_sched(struct mptcp_sock *msk, struct mptcp_sched_ops *sched)
+{
+	if (!sched)
+		sched = &mptcp_sched_default;
+
+	if (!try_module_get(sched->owner))
+		sched = &mptcp_sched_default;
+
+	msk->sched = sched;
+}
+
+void mptcp_release_sched(struct mptcp_sock *msk)
+{
+	struct mptcp_sched_ops *sched = msk->sched;
+
+	msk->sched = NULL;
+	if (sched)
+		module_put(sched->owner);
+}
+
+struct sock *mptcp_sched_get_send(struct mptcp_sock *msk)
+{
+	msk_owned_by_me(msk);
+
+	/* after a fallback there is a single subflow and nothing to
+	 * schedule; don't bother the ops with that case
+	 */
+	if (__mptcp_check_fallback(msk)) {
+		if (msk->first &&
+		    __tcp_can_send(msk->first) &&
+		    sk_stream_memory_free(msk->first))
+			return msk->first;
+		return NULL;
+	}
+
+	return msk->sched->get_send(msk);
+}
@@ -158,6 +158,7 @@ static int clone_execute(struct datapath *dp, struct sk_buff *skb,
 
 static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			      struct sw_flow_key *key,
+			      const struct sw_flow_actions *acts,
 			      const struct nlattr *attr, int len);
 
 static int push_mpls(struct sk_buff *skb, struct sw_flow_key *key,
@@ -1276,19 +1277,43 @@ static int execute_dec_ttl(struct sk_buff *skb, struct sw_flow_key *key)
 /* Execute a list of actions against 'skb'. */
 static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			      struct sw_flow_key *key,
+			      const struct sw_flow_actions *acts,
 			      const struct nlattr *attr, int len)
 {
+	const struct sw_flow_op *op = NULL, *op_end = NULL;
 	const struct nlattr *a;
 	int rem;
 
-	for (a = attr, rem = len; rem > 0;
-	     a = nla_next(a, &rem)) {
+	/* Top-level action lists come with a pre-resolved op array; walk
+	 * that instead of re-parsing the attribute headers per packet.
+	 * Nested and deferred lists fall back to the attribute walk.
+	 */
+	if (acts && acts->ops) {
+		op = acts->ops;
+		op_end = op + acts->ops_cnt;
+	}
+
+	a = attr;
+	rem = len;
+	while (op ? op < op_end : rem > 0) {
 		int err = 0;
+		bool last;
+		int type;
+
+		if (op) {
+			a = (const struct nlattr *)((u8 *)attr + op->ofs);
+			rem = len - op->ofs;
+			type = op->type;
+			last = op->is_last;
+		} else {
+			type = nla_type(a);
+			last = nla_is_last(a, rem);
+		}
 
 		if (trace_ovs_do_execute_action_enabled())
 			trace_ovs_do_execute_action(dp, skb, key, a, rem);
 
-		switch (nla_type(a)) {
+		switch (type) {
 		case OVS_ACTION_ATTR_OUTPUT: {
 			int port = nla_get_u32(a);
 			struct sk_buff *clone;
@@ -1297,7 +1322,7 @@ static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			 * of 'skb', In case the output action is the
 			 * last action, cloning can be avoided.
 			 */
-			if (nla_is_last(a, rem)) {
+			if (last) {
 				do_output(dp, skb, port, key);
 				/* 'skb' has been used for output.
 				 */
@@ -1359,9 +1384,7 @@ static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			err = pop_vlan(skb, key);
 			break;
 
-		case OVS_ACTION_ATTR_RECIRC: {
-			bool last = nla_is_last(a, rem);
-
+		case OVS_ACTION_ATTR_RECIRC:
 			err = execute_recirc(dp, skb, key, a, last);
 			if (last) {
 				/* If this is the last action, the skb has
@@ -1371,7 +1394,6 @@ static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 				return err;
 			}
 			break;
-		}
 
 		case OVS_ACTION_ATTR_SET:
 			err = execute_set_action(skb, key, nla_data(a));
@@ -1382,15 +1404,12 @@ static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			err = execute_masked_set_action(skb, key, nla_data(a));
 			break;
 
-		case OVS_ACTION_ATTR_SAMPLE: {
-			bool last = nla_is_last(a, rem);
-
+		case OVS_ACTION_ATTR_SAMPLE:
 			err = sample(dp, skb, key, a, last);
 			if (last)
 				return err;
 
 			break;
-		}
 
 		case OVS_ACTION_ATTR_CT:
 			if (!is_flow_key_valid(key)) {
@@ -1442,25 +1461,19 @@ static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			}
 			break;
 
-		case OVS_ACTION_ATTR_CLONE: {
-			bool last = nla_is_last(a, rem);
-
+		case OVS_ACTION_ATTR_CLONE:
 			err = clone(dp, skb, key, a, last);
 			if (last)
 				return err;
 
 			break;
-		}
-
-		case OVS_ACTION_ATTR_CHECK_PKT_LEN: {
-			bool last = nla_is_last(a, rem);
 
+		case OVS_ACTION_ATTR_CHECK_PKT_LEN:
 			err = execute_check_pkt_len(dp, skb, key, a, last);
 			if (last)
 				return err;
 
 			break;
-		}
 
 		case OVS_ACTION_ATTR_DEC_TTL:
 			err = execute_dec_ttl(skb, key);
@@ -1474,6 +1487,11 @@ static int do_execute_actions(struct datapath *dp, struct sk_buff *skb,
 			kfree_skb(skb);
 			return err;
 		}
+
+		if (op)
+			op++;
+		else
+			a = nla_next(a, &rem);
 	}
 
 	consume_skb(skb);
@@ -1516,7 +1534,7 @@ static int clone_execute(struct datapath *dp, struct sk_buff *skb,
 				__this_cpu_inc(exec_actions_level);
 
 			err = do_execute_actions(dp, skb, clone,
-						 actions, len);
+						 NULL, actions, len);
 
 			if (clone_flow_key)
 				__this_cpu_dec(exec_actions_level);
@@ -1570,7 +1588,8 @@ static void process_deferred_actions(struct datapath *dp)
 		int actions_len = da->actions_len;
 
 		if (actions)
-			do_execute_actions(dp, skb, key, actions, actions_len);
+			do_execute_actions(dp, skb, key, NULL, actions,
+					   actions_len);
 		else
 			ovs_dp_process_packet(skb, key);
 	} while (!action_fifo_is_empty(fifo));
@@ -1596,7 +1615,7 @@ int ovs_execute_actions(struct datapath *dp, struct sk_buff *skb,
 	}
 
 	OVS_CB(skb)->acts_origlen = acts->orig_len;
-	err = do_execute_actions(dp, skb, key,
+	err = do_execute_actions(dp, skb, key, acts,
 				 acts->actions, acts->actions_len);
 
 	if (level == 1)
@@ -203,9 +203,21 @@ struct sw_flow_id {
 	};
 };
 
+/* Pre-resolved top-level action, built once when the action list is
+ * validated so that execution does not have to re-parse the netlink
+ * attribute headers for every packet.
+ */
+struct sw_flow_op {
+	u32 ofs;		/* Attribute offset from actions[]. */
+	u8 type;		/* nla_type() of the attribute. */
+	u8 is_last;		/* No action follows this one. */
+};
+
 struct sw_flow_actions {
 	struct rcu_head rcu;
 	size_t orig_len;	/* From flow_cmd_new netlink actions size */
+	struct sw_flow_op *ops;	/* Top-level actions, NULL if not compiled. */
+	u32 ops_cnt;
 	u32 actions_len;
 	struct nlattr actions[];
 };
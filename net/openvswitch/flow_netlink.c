@@ -2314,6 +2314,8 @@ static struct sw_flow_actions *nla_alloc_flow_actions(int size)
 		return ERR_PTR(-ENOMEM);
 
 	sfa->actions_len = 0;
+	sfa->ops = NULL;
+	sfa->ops_cnt = 0;
 	return sfa;
 }
 
@@ -2434,6 +2436,7 @@ void ovs_nla_free_flow_actions(struct sw_flow_actions *sf_acts)
 		return;
 
 	ovs_nla_free_nested_actions(sf_acts->actions, sf_acts->actions_len);
+	kfree(sf_acts->ops);
 	kfree(sf_acts);
 }
 
@@ -3468,6 +3471,39 @@ static int __ovs_nla_copy_actions(struct net *net, const struct nlattr *attr,
 	return 0;
 }
 
+/* Pre-resolve the top-level actions into a compact op array so that
+ * do_execute_actions() does not have to walk the netlink attribute
+ * headers per packet.  Compilation is best effort: if the allocation
+ * fails the flow is still executed off the attribute list.
+ */
+static void ovs_nla_compile_actions(struct sw_flow_actions *sfa)
+{
+	const struct nlattr *a;
+	struct sw_flow_op *op;
+	int count = 0;
+	int rem;
+
+	for (a = sfa->actions, rem = sfa->actions_len; rem > 0;
+	     a = nla_next(a, &rem))
+		count++;
+
+	if (!count)
+		return;
+
+	op = kmalloc_array(count, sizeof(*op), GFP_KERNEL);
+	if (!op)
+		return;
+
+	sfa->ops = op;
+	sfa->ops_cnt = count;
+	for (a = sfa->actions, rem = sfa->actions_len; rem > 0;
+	     a = nla_next(a, &rem), op++) {
+		op->ofs = (u8 *)a - (u8 *)sfa->actions;
+		op->type = nla_type(a);
+		op->is_last = nla_is_last(a, rem);
+	}
+}
+
 /* 'key' must be the masked key. */
 int ovs_nla_copy_actions(struct net *net, const struct nlattr *attr,
 			 const struct sw_flow_key *key,
@@ -3488,6 +3524,8 @@ int ovs_nla_copy_actions(struct net *net, const struct nlattr *attr,
 				     key->eth.vlan.tci, mpls_label_count, log);
 	if (err)
 		ovs_nla_free_flow_actions(*sfa);
+	else
+		ovs_nla_compile_actions(*sfa);
 
 	return err;
 }
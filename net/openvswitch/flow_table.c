@@ -1109,6 +1109,7 @@ void ovs_flow_masks_rebalance(struct flow_table *table)
 {
 	struct mask_array *ma = rcu_dereference_ovsl(table->mask_array);
 	struct mask_count *masks_and_count;
+	struct mask_cache *mc;
 	struct mask_array *new;
 	int masks_entries = 0;
 	int i;
@@ -1156,8 +1157,25 @@ void ovs_flow_masks_rebalance(struct flow_table *table)
 	if (i == 0)
 		goto free_mask_entries;
 
-	/* Sort the entries */
 	masks_entries = i;
+
+	/* Grow the mask cache while the active masks outnumber its slots
+	 * by 4x or more; every miss then walks a long mask list per
+	 * packet.  Growing drops the cached entries, so it only happens
+	 * when the threshold is crossed, and never shrinks -- an explicit
+	 * OVS_DP_ATTR_MASKS_CACHE_SIZE request can still set (or disable)
+	 * any allowed size.
+	 */
+	mc = rcu_dereference_ovsl(table->mask_cache);
+	if (mc->cache_size && masks_entries > mc->cache_size / 4) {
+		u32 size = roundup_pow_of_two(masks_entries * 4);
+
+		if (size * sizeof(struct mask_cache_entry) <=
+		    PCPU_MIN_UNIT_SIZE)
+			ovs_flow_tbl_masks_cache_resize(table, size);
+	}
+
+	/* Sort the entries */
 	sort(masks_and_count, masks_entries, sizeof(*masks_and_count),
 	     compare_mask_and_count, NULL);
 
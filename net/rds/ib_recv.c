@@ -556,7 +556,6 @@ int rds_ib_inc_copy_to_user(struct rds_incoming *inc, struct iov_iter *to)
 		to_copy = min_t(unsigned long, to_copy, len - copied);
 
 		/* XXX needs + offset for multiple recvs per page */
-		rds_stats_add(s_copy_to_user, to_copy);
 		ret = copy_page_to_iter(sg_page(&frag->f_sg),
 					frag->f_sg.offset + frag_off,
 					to_copy,
@@ -567,6 +566,8 @@ int rds_ib_inc_copy_to_user(struct rds_incoming *inc, struct iov_iter *to)
 		frag_off += to_copy;
 		copied += to_copy;
 	}
+	/* one counter update per message, not one per fragment */
+	rds_stats_add(s_copy_to_user, copied);
 
 	return copied;
 }
@@ -93,8 +93,13 @@ enum {
 
 /* Max number of multipaths per RDS connection. Must be a power of 2 */
 #define	RDS_MPATH_WORKERS	8
-#define	RDS_MPATH_HASH(rs, n) (jhash_1word((rs)->rs_bound_port, \
-			       (rs)->rs_hash_initval) & ((n) - 1))
+/* Hash both ports of the socket pair, so that one bound socket talking
+ * to several peer sockets on the same node spreads across the paths
+ * while each pair stays ordered on its own path
+ */
+#define	RDS_MPATH_HASH(rs, dport, n) \
+	(jhash_2words((rs)->rs_bound_port, (__force u32)(dport), \
+		      (rs)->rs_hash_initval) & ((n) - 1))
 
 #define IS_CANONICAL(laddr, faddr) (htonl(laddr) < htonl(faddr))
 
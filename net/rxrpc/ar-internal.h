@@ -424,6 +424,13 @@ enum rxrpc_conn_proto_state {
 	RXRPC_CONN__NR_STATES
 };
 
+/* Connections per client bundle.  The protocol fixes the channels per
+ * connection at RXRPC_MAXCALLS, so the bundle multiplexes calls over
+ * several security-negotiated connections instead; the product must not
+ * exceed the bits in avail_chans (32 on the smallest builds).
+ */
+#define RXRPC_MAX_BUNDLE_CONNS	8
+
 /*
  * RxRPC client connection bundle.
  */
@@ -444,7 +451,8 @@ struct rxrpc_bundle {
 	struct rb_node		local_node;	/* Node in local->client_conns */
 	struct list_head	waiting_calls;	/* Calls waiting for channels */
 	unsigned long		avail_chans;	/* Mask of available channels */
-	struct rxrpc_connection	*conns[4];	/* The connections in the bundle (max 4) */
+	struct rxrpc_connection	*conns[RXRPC_MAX_BUNDLE_CONNS];
+						/* The connections in the bundle */
 };
 
 /*
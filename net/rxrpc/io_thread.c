@@ -407,6 +407,11 @@ static int rxrpc_input_packet_on_conn(struct rxrpc_connection *conn,
 	return ret;
 }
 
+/* Max packets handled per loop iteration before the other work sources
+ * (conn/call attention queues, new client calls) are serviced again.
+ */
+#define RXRPC_IO_THREAD_RX_BUDGET 64
+
 /*
  * I/O and event handling thread.
  */
@@ -416,6 +421,7 @@ int rxrpc_io_thread(void *data)
 	struct sk_buff_head rx_queue;
 	struct rxrpc_local *local = data;
 	struct rxrpc_call *call;
+	unsigned int nr_processed;
 	struct sk_buff *skb;
 #ifdef CONFIG_AF_RXRPC_INJECT_RX_DELAY
 	ktime_t now;
@@ -466,8 +472,13 @@ int rxrpc_io_thread(void *data)
 		if (!list_empty(&local->new_client_calls))
 			rxrpc_connect_client_calls(local);
 
-		/* Process received packets and errors. */
-		if ((skb = __skb_dequeue(&rx_queue))) {
+		/* Process a batch of received packets and errors before
+		 * looking at the other work sources again; the budget
+		 * bounds the latency of conn and call attention requests
+		 * while sparing each packet the full dispatch cascade.
+		 */
+		nr_processed = 0;
+		while ((skb = __skb_dequeue(&rx_queue))) {
 			struct rxrpc_skb_priv *sp = rxrpc_skb(skb);
 			switch (skb->mark) {
 			case RXRPC_SKB_MARK_PACKET:
@@ -491,8 +502,11 @@ int rxrpc_io_thread(void *data)
 				rxrpc_free_skb(skb, rxrpc_skb_put_unknown);
 				break;
 			}
-			continue;
+			if (++nr_processed >= RXRPC_IO_THREAD_RX_BUDGET)
+				break;
 		}
+		if (nr_processed)
+			continue;
 
 		/* Inject a delay into packets if requested. */
 #ifdef CONFIG_AF_RXRPC_INJECT_RX_DELAY
@@ -108,7 +108,8 @@ static inline void smc_cdc_add_pending_send(struct smc_connection *conn,
 
 int smc_cdc_msg_send(struct smc_connection *conn,
 		     struct smc_wr_buf *wr_buf,
-		     struct smc_cdc_tx_pend *pend)
+		     struct smc_cdc_tx_pend *pend,
+		     struct ib_send_wr *first_wr)
 {
 	struct smc_link *link = conn->lnk;
 	union smc_host_cursor cfed;
@@ -126,7 +127,8 @@ int smc_cdc_msg_send(struct smc_connection *conn,
 	atomic_inc(&conn->cdc_pend_tx_wr);
 	smp_mb__after_atomic(); /* Make sure cdc_pend_tx_wr added before post */
 
-	rc = smc_wr_tx_send(link, (struct smc_wr_tx_pend_priv *)pend);
+	rc = smc_wr_tx_send_chain(link, (struct smc_wr_tx_pend_priv *)pend,
+				  first_wr);
 	if (!rc) {
 		smc_curs_copy(&conn->rx_curs_confirmed, &cfed, conn);
 		conn->local_rx_ctrl.prod_flags.cons_curs_upd_req = 0;
@@ -199,7 +201,7 @@ again:
 		again = true;
 		goto again;
 	}
-	rc = smc_cdc_msg_send(conn, wr_buf, pend);
+	rc = smc_cdc_msg_send(conn, wr_buf, pend, NULL);
 	spin_unlock_bh(&conn->send_lock);
 put_out:
 	smc_wr_tx_link_put(link);
@@ -39,6 +39,7 @@
 #define SMC_LGR_NUM_INCR		256
 #define SMC_LGR_FREE_DELAY_SERV		(600 * HZ)
 #define SMC_LGR_FREE_DELAY_CLNT		(SMC_LGR_FREE_DELAY_SERV + 10 * HZ)
+#define SMC_BUF_REUSE_EXPIRE		(120 * HZ)
 
 struct smc_lgr_list smc_lgr_list = {	/* established link groups */
 	.lock = __SPIN_LOCK_UNLOCKED(smc_lgr_list.lock),
@@ -54,6 +55,7 @@ static void smc_buf_free(struct smc_link_group *lgr, bool is_rmb,
 static void __smc_lgr_terminate(struct smc_link_group *lgr, bool soft);
 
 static void smc_link_down_work(struct work_struct *work);
+static void smc_buf_reclaim_work(struct work_struct *work);
 
 /* return head of link group list and its lock for a given link group */
 static inline struct list_head *smc_lgr_list_head(struct smc_link_group *lgr,
@@ -865,6 +867,7 @@ static int smc_lgr_create(struct smc_sock *smc, struct smc_init_info *ini)
 	smc_lgr_list.num += SMC_LGR_NUM_INCR;
 	memcpy(&lgr->id, (u8 *)&smc_lgr_list.num, SMC_LGR_ID_SIZE);
 	INIT_DELAYED_WORK(&lgr->free_work, smc_lgr_free_work);
+	INIT_DELAYED_WORK(&lgr->buf_reclaim_work, smc_buf_reclaim_work);
 	INIT_WORK(&lgr->terminate_work, smc_lgr_terminate_work);
 	lgr->conns_all = RB_ROOT;
 	if (ini->is_smcd) {
@@ -1126,10 +1129,71 @@ static void smcr_buf_unuse(struct smc_buf_desc *buf_desc, bool is_rmb,
 	} else {
 		/* memzero_explicit provides potential memory barrier semantics */
 		memzero_explicit(buf_desc->cpu_addr, buf_desc->len);
+		buf_desc->unused_at = jiffies;
 		WRITE_ONCE(buf_desc->used, 0);
+		schedule_delayed_work(&lgr->buf_reclaim_work,
+				      SMC_BUF_REUSE_EXPIRE);
 	}
 }
 
+/* free cached bufs of one list type that have not been reused for
+ * SMC_BUF_REUSE_EXPIRE; returns true if unexpired unused bufs remain
+ */
+static bool smcr_buf_expire(struct smc_link_group *lgr, bool is_rmb)
+{
+	struct rw_semaphore *lock = is_rmb ? &lgr->rmbs_lock :
+					     &lgr->sndbufs_lock;
+	struct smc_buf_desc *buf_desc, *bf;
+	LIST_HEAD(expired);
+	bool pending = false;
+	int i;
+
+	down_write(lock);
+	for (i = 0; i < SMC_RMBE_SIZES; i++) {
+		list_for_each_entry_safe(buf_desc, bf,
+					 is_rmb ? &lgr->rmbs[i] :
+						  &lgr->sndbufs[i], list) {
+			if (READ_ONCE(buf_desc->used))
+				continue;
+			if (time_before(jiffies, buf_desc->unused_at +
+						 SMC_BUF_REUSE_EXPIRE)) {
+				pending = true;
+				continue;
+			}
+			list_move(&buf_desc->list, &expired);
+		}
+	}
+	up_write(lock);
+
+	list_for_each_entry_safe(buf_desc, bf, &expired, list) {
+		list_del(&buf_desc->list);
+		smc_buf_free(lgr, is_rmb, buf_desc);
+	}
+
+	return pending;
+}
+
+/* caching unused bufs in the link group speeds up connection setup, but
+ * after a connection burst it pins the peak amount of buffer memory
+ * forever; free bufs that saw no reuse within the grace period
+ */
+static void smc_buf_reclaim_work(struct work_struct *work)
+{
+	struct smc_link_group *lgr = container_of(to_delayed_work(work),
+						  struct smc_link_group,
+						  buf_reclaim_work);
+	bool pending;
+
+	if (lgr->freeing)
+		return;
+
+	pending = smcr_buf_expire(lgr, false);
+	pending |= smcr_buf_expire(lgr, true);
+	if (pending)
+		schedule_delayed_work(&lgr->buf_reclaim_work,
+				      SMC_BUF_REUSE_EXPIRE);
+}
+
 static void smc_buf_unuse(struct smc_connection *conn,
 			  struct smc_link_group *lgr)
 {
@@ -1376,6 +1440,7 @@ static void smc_lgr_free(struct smc_link_group *lgr)
 {
 	int i;
 
+	cancel_delayed_work_sync(&lgr->buf_reclaim_work);
 	if (!lgr->is_smcd) {
 		down_write(&lgr->llc_conf_mutex);
 		for (i = 0; i < SMC_LINKS_PER_LGR_MAX; i++) {
@@ -330,15 +330,19 @@ int smcd_tx_ism_write(struct smc_connection *conn, void *data, size_t len,
 	return rc;
 }
 
-/* sndbuf consumer: actual data transfer of one target chunk with RDMA write */
-static int smc_tx_rdma_write(struct smc_connection *conn, int peer_rmbe_offset,
-			     int num_sges, struct ib_rdma_wr *rdma_wr)
+/* sndbuf consumer: prepare the RDMA write of one target chunk; the WR is
+ * not posted here, but chained in front of the subsequent CDC message so
+ * that data and cursor update share a single doorbell
+ */
+static void smc_tx_rdma_write_prep(struct smc_connection *conn,
+				   int peer_rmbe_offset, int num_sges,
+				   struct ib_rdma_wr *rdma_wr)
 {
 	struct smc_link_group *lgr = conn->lgr;
 	struct smc_link *link = conn->lnk;
-	int rc;
 
 	rdma_wr->wr.wr_id = smc_wr_tx_get_next_wr_id(link);
+	rdma_wr->wr.next = NULL;
 	rdma_wr->wr.num_sge = num_sges;
 	rdma_wr->remote_addr =
 		lgr->rtokens[conn->rtoken_idx][link->link_idx].dma_addr +
@@ -347,10 +351,6 @@ static int smc_tx_rdma_write(struct smc_connection *conn, int peer_rmbe_offset,
 		/* offset within RMBE */
 		peer_rmbe_offset;
 	rdma_wr->rkey = lgr->rtokens[conn->rtoken_idx][link->link_idx].rkey;
-	rc = ib_post_send(link->roce_qp, &rdma_wr->wr, NULL);
-	if (rc)
-		smcr_link_down_cond_sched(link);
-	return rc;
 }
 
 /* sndbuf consumer */
@@ -373,7 +373,8 @@ static inline void smc_tx_advance_cursors(struct smc_connection *conn,
 static int smcr_tx_rdma_writes(struct smc_connection *conn, size_t len,
 			       size_t src_off, size_t src_len,
 			       size_t dst_off, size_t dst_len,
-			       struct smc_rdma_wr *wr_rdma_buf)
+			       struct smc_rdma_wr *wr_rdma_buf,
+			       struct ib_send_wr **first_wr)
 {
 	struct smc_link *link = conn->lnk;
 
@@ -381,10 +382,10 @@ static int smcr_tx_rdma_writes(struct smc_connection *conn, size_t len,
 		sg_dma_address(conn->sndbuf_desc->sgt[link->link_idx].sgl);
 	u64 virt_addr = (uintptr_t)conn->sndbuf_desc->cpu_addr;
 	int src_len_sum = src_len, dst_len_sum = dst_len;
+	struct ib_send_wr *last_wr = NULL;
 	int sent_count = src_off;
 	int srcchunk, dstchunk;
 	int num_sges;
-	int rc;
 
 	for (dstchunk = 0; dstchunk < 2; dstchunk++) {
 		struct ib_rdma_wr *wr = &wr_rdma_buf->wr_tx_rdma[dstchunk];
@@ -418,9 +419,12 @@ static int smcr_tx_rdma_writes(struct smc_connection *conn, size_t len,
 			src_len = dst_len - src_len; /* remainder */
 			src_len_sum += src_len;
 		}
-		rc = smc_tx_rdma_write(conn, dst_off, num_sges, wr);
-		if (rc)
-			return rc;
+		smc_tx_rdma_write_prep(conn, dst_off, num_sges, wr);
+		if (last_wr)
+			last_wr->next = &wr->wr;
+		else
+			*first_wr = &wr->wr;
+		last_wr = &wr->wr;
 		if (dst_len_sum == len)
 			break; /* either on 1st or 2nd iteration */
 		/* prepare next (== 2nd) iteration */
@@ -478,7 +482,8 @@ static int smcd_tx_rdma_writes(struct smc_connection *conn, size_t len,
  * usable snd_wnd as max transmit
  */
 static int smc_tx_rdma_writes(struct smc_connection *conn,
-			      struct smc_rdma_wr *wr_rdma_buf)
+			      struct smc_rdma_wr *wr_rdma_buf,
+			      struct ib_send_wr **first_wr)
 {
 	size_t len, src_len, dst_off, dst_len; /* current chunk values */
 	union smc_host_cursor sent, prep, prod, cons;
@@ -543,7 +548,8 @@ static int smc_tx_rdma_writes(struct smc_connection *conn,
 					 dst_off, dst_len);
 	else
 		rc = smcr_tx_rdma_writes(conn, len, sent.count, src_len,
-					 dst_off, dst_len, wr_rdma_buf);
+					 dst_off, dst_len, wr_rdma_buf,
+					 first_wr);
 	if (rc)
 		return rc;
 
@@ -564,6 +570,7 @@ static int smc_tx_rdma_writes(struct smc_connection *conn,
 static int smcr_tx_sndbuf_nonempty(struct smc_connection *conn)
 {
 	struct smc_cdc_producer_flags *pflags = &conn->local_tx_ctrl.prod_flags;
+	struct ib_send_wr *first_wr = NULL;
 	struct smc_link *link = conn->lnk;
 	struct smc_rdma_wr *wr_rdma_buf;
 	struct smc_cdc_tx_pend *pend;
@@ -599,7 +606,7 @@ static int smcr_tx_sndbuf_nonempty(struct smc_connection *conn)
 		goto out_unlock;
 	}
 	if (!pflags->urg_data_present) {
-		rc = smc_tx_rdma_writes(conn, wr_rdma_buf);
+		rc = smc_tx_rdma_writes(conn, wr_rdma_buf, &first_wr);
 		if (rc) {
 			smc_wr_tx_put_slot(link,
 					   (struct smc_wr_tx_pend_priv *)pend);
@@ -607,7 +614,8 @@ static int smcr_tx_sndbuf_nonempty(struct smc_connection *conn)
 		}
 	}
 
-	rc = smc_cdc_msg_send(conn, wr_buf, pend);
+	/* post the RDMA writes and the CDC message with one doorbell */
+	rc = smc_cdc_msg_send(conn, wr_buf, pend, first_wr);
 	if (!rc && pflags->urg_data_present) {
 		pflags->urg_data_pending = 0;
 		pflags->urg_data_present = 0;
@@ -626,7 +634,7 @@ static int smcd_tx_sndbuf_nonempty(struct smc_connection *conn)
 
 	spin_lock_bh(&conn->send_lock);
 	if (!pflags->urg_data_present)
-		rc = smc_tx_rdma_writes(conn, NULL);
+		rc = smc_tx_rdma_writes(conn, NULL, NULL);
 	if (!rc)
 		rc = smcd_cdc_msg_send(conn);
 
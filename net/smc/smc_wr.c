@@ -298,18 +298,34 @@ int smc_wr_tx_put_slot(struct smc_link *link,
 	return 0;
 }
 
-/* Send prepared WR slot via ib_post_send.
+/* Send prepared WR slot via ib_post_send, with an optional chain of
+ * prepared, not yet posted WRs linked in front of it, so that e.g. RDMA
+ * writes and the subsequent CDC message share a single doorbell.
  * @priv: pointer to smc_wr_tx_pend_priv identifying prepared message buffer
+ * @first_wr: head of a WR chain to post before the slot WR, or NULL
  */
-int smc_wr_tx_send(struct smc_link *link, struct smc_wr_tx_pend_priv *priv)
+int smc_wr_tx_send_chain(struct smc_link *link,
+			 struct smc_wr_tx_pend_priv *priv,
+			 struct ib_send_wr *first_wr)
 {
 	struct smc_wr_tx_pend *pend;
+	struct ib_send_wr *wr;
 	int rc;
 
+	pend = container_of(priv, struct smc_wr_tx_pend, priv);
+	wr = &link->wr_tx_ibs[pend->idx];
+	if (first_wr) {
+		struct ib_send_wr *tail = first_wr;
+
+		while (tail->next)
+			tail = tail->next;
+		tail->next = wr;
+	} else {
+		first_wr = wr;
+	}
 	ib_req_notify_cq(link->smcibdev->roce_cq_send,
 			 IB_CQ_NEXT_COMP | IB_CQ_REPORT_MISSED_EVENTS);
-	pend = container_of(priv, struct smc_wr_tx_pend, priv);
-	rc = ib_post_send(link->roce_qp, &link->wr_tx_ibs[pend->idx], NULL);
+	rc = ib_post_send(link->roce_qp, first_wr, NULL);
 	if (rc) {
 		smc_wr_tx_put_slot(link, priv);
 		smcr_link_down_cond_sched(link);
@@ -317,6 +333,14 @@ int smc_wr_tx_send(struct smc_link *link, struct smc_wr_tx_pend_priv *priv)
 	return rc;
 }
 
+/* Send prepared WR slot via ib_post_send.
+ * @priv: pointer to smc_wr_tx_pend_priv identifying prepared message buffer
+ */
+int smc_wr_tx_send(struct smc_link *link, struct smc_wr_tx_pend_priv *priv)
+{
+	return smc_wr_tx_send_chain(link, priv, NULL);
+}
+
 int smc_wr_tx_v2_send(struct smc_link *link, struct smc_wr_tx_pend_priv *priv,
 		      int len)
 {
@@ -123,6 +123,9 @@ int smc_wr_tx_get_v2_slot(struct smc_link *link,
 			  struct smc_wr_tx_pend_priv **wr_pend_priv);
 int smc_wr_tx_put_slot(struct smc_link *link,
 		       struct smc_wr_tx_pend_priv *wr_pend_priv);
+int smc_wr_tx_send_chain(struct smc_link *link,
+			 struct smc_wr_tx_pend_priv *priv,
+			 struct ib_send_wr *first_wr);
 int smc_wr_tx_send(struct smc_link *link,
 		   struct smc_wr_tx_pend_priv *wr_pend_priv);
 int smc_wr_tx_v2_send(struct smc_link *link,
@@ -507,6 +507,30 @@ out:
 	return xprt;
 }
 
+/*
+ * This thread's pool had no transport ready; try to take one that is
+ * queued on another pool. Transports are not bound to a pool -- each
+ * enqueue picks the pool for the current cpu -- so stealing one merely
+ * moves the work to a thread that would otherwise go to sleep.
+ */
+static struct svc_xprt *svc_xprt_steal(struct svc_rqst *rqstp)
+{
+	struct svc_serv *serv = rqstp->rq_server;
+	struct svc_pool *pool = rqstp->rq_pool;
+	struct svc_xprt *xprt;
+	unsigned int i;
+
+	for (i = 1; i < serv->sv_nrpools; i++) {
+		struct svc_pool *victim;
+
+		victim = &serv->sv_pools[(pool->sp_id + i) % serv->sv_nrpools];
+		xprt = svc_xprt_dequeue(victim);
+		if (xprt)
+			return xprt;
+	}
+	return NULL;
+}
+
 /**
  * svc_reserve - change the space reserved for the reply to a request.
  * @rqstp:  The request in question
@@ -740,6 +764,9 @@ static struct svc_xprt *svc_get_next_xprt(struct svc_rqst *rqstp, long timeout)
 	WARN_ON_ONCE(rqstp->rq_xprt);
 
 	rqstp->rq_xprt = svc_xprt_dequeue(pool);
+	if (rqstp->rq_xprt)
+		goto out_found;
+	rqstp->rq_xprt = svc_xprt_steal(rqstp);
 	if (rqstp->rq_xprt)
 		goto out_found;
 
@@ -763,6 +790,9 @@ static struct svc_xprt *svc_get_next_xprt(struct svc_rqst *rqstp, long timeout)
 	set_bit(RQ_BUSY, &rqstp->rq_flags);
 	smp_mb__after_atomic();
 	rqstp->rq_xprt = svc_xprt_dequeue(pool);
+	if (rqstp->rq_xprt)
+		goto out_found;
+	rqstp->rq_xprt = svc_xprt_steal(rqstp);
 	if (rqstp->rq_xprt)
 		goto out_found;
 
@@ -231,6 +231,24 @@ _shift_data_left_pages(struct page **pages, size_t pgto_base,
 	pgto_base &= ~PAGE_MASK;
 	pgfrom_base &= ~PAGE_MASK;
 
+	/* If both areas start on a page boundary, shift whole pages by
+	 * swapping the page pointers rather than copying the contents.
+	 * The bytes left behind in the source area are dead space: the
+	 * caller is shrinking the buffer, so they are never read again,
+	 * and keeping every page in the vector keeps the eventual page
+	 * frees correct.
+	 */
+	if (pgto_base == 0 && pgfrom_base == 0) {
+		while (len >= PAGE_SIZE) {
+			swap(*pgto, *pgfrom);
+			pgto++;
+			pgfrom++;
+			len -= PAGE_SIZE;
+		}
+		if (!len)
+			return;
+	}
+
 	do {
 		if (pgto_base >= PAGE_SIZE) {
 			pgto_base = 0;
@@ -1038,7 +1038,7 @@ int tipc_link_xmit(struct tipc_link *l, struct sk_buff_head *list,
 {
 	struct sk_buff_head *backlogq = &l->backlogq;
 	struct sk_buff_head *transmq = &l->transmq;
-	struct sk_buff *skb, *_skb;
+	struct sk_buff *skb, *_skb, *nskb;
 	u16 bc_ack = l->bc_rcvlink->rcv_nxt - 1;
 	u16 ack = l->rcv_nxt - 1;
 	u16 seqno = l->snd_nxt;
@@ -1082,6 +1082,31 @@ int tipc_link_xmit(struct tipc_link *l, struct sk_buff_head *list,
 	while ((skb = __skb_dequeue(list))) {
 		if (likely(skb_queue_len(transmq) < cwin)) {
 			hdr = buf_msg(skb);
+			/* Proactively pack trailing small messages from the
+			 * same call into this one, even though the link is
+			 * not congested; one MTU-filling bundle is much
+			 * cheaper to send and receive than a train of tiny
+			 * packets
+			 */
+			if (msg_user(hdr) != MSG_FRAGMENTER &&
+			    msg_user(hdr) != TUNNEL_PROTOCOL &&
+			    msg_user(hdr) != BCAST_PROTOCOL) {
+				while ((nskb = __skb_dequeue(list))) {
+					if (!tipc_msg_try_bundle(skb, &nskb,
+								 mss, l->addr,
+								 &new_bundle) ||
+					    nskb) {
+						__skb_queue_head(list, nskb);
+						break;
+					}
+					if (new_bundle) {
+						l->stats.sent_bundles++;
+						l->stats.sent_bundled++;
+					}
+					l->stats.sent_bundled++;
+				}
+				hdr = buf_msg(skb);
+			}
 			msg_set_seqno(hdr, seqno);
 			msg_set_ack(hdr, ack);
 			msg_set_bcast_ack(hdr, bc_ack);
@@ -36,6 +36,7 @@
  */
 
 #include <net/sock.h>
+#include <linux/hash.h>
 #include <linux/list_sort.h>
 #include <linux/rbtree_augmented.h>
 #include "core.h"
@@ -99,6 +100,85 @@ RB_DECLARE_CALLBACKS_MAX(static, sr_callbacks,
 #define service_range_overlap(sr, start, end)				\
 	((sr)->lower <= (end) && (sr)->upper >= (start))
 
+/* Anycast resolutions vastly outnumber binding changes, so deterministic
+ * lookup results are kept in a small per-cpu cache, keyed by service type,
+ * instance and requested node. Any binding change bumps the name table
+ * generation counter and thereby invalidates all cached entries at once.
+ */
+#define TIPC_ANYCAST_CACHE_BITS	6
+#define TIPC_ANYCAST_CACHE_SIZE	(1 << TIPC_ANYCAST_CACHE_BITS)
+
+struct tipc_anycast_entry {
+	u32 gen;
+	u32 type;
+	u32 instance;
+	u32 node;
+	struct tipc_socket_addr sk;
+};
+
+struct tipc_anycast_cache {
+	struct tipc_anycast_entry entry[TIPC_ANYCAST_CACHE_SIZE];
+};
+
+/* The per-cpu entries are written with bottom halves disabled, so a
+ * reader or writer can never observe a half-updated entry
+ */
+static struct tipc_anycast_entry *tipc_anycast_entry(struct name_table *nt,
+						     u32 type, u32 instance,
+						     u32 node)
+{
+	u32 hash = hash_32(type ^ instance ^ node, TIPC_ANYCAST_CACHE_BITS);
+
+	return this_cpu_ptr(&nt->acast_cache->entry[hash]);
+}
+
+static bool tipc_anycast_cache_hit(struct name_table *nt, u32 type,
+				   u32 instance, struct tipc_socket_addr *sk)
+{
+	struct tipc_anycast_entry *e;
+	bool hit = false;
+
+	local_bh_disable();
+	e = tipc_anycast_entry(nt, type, instance, sk->node);
+	if (e->gen == READ_ONCE(nt->cache_gen) &&
+	    e->type == type && e->instance == instance &&
+	    e->node == sk->node) {
+		*sk = e->sk;
+		hit = true;
+	}
+	local_bh_enable();
+	return hit;
+}
+
+static void tipc_anycast_cache_fill(struct name_table *nt, u32 gen, u32 type,
+				    u32 instance, u32 node,
+				    struct tipc_socket_addr *sk)
+{
+	struct tipc_anycast_entry *e;
+
+	local_bh_disable();
+	e = tipc_anycast_entry(nt, type, instance, node);
+	e->type = type;
+	e->instance = instance;
+	e->node = node;
+	e->sk = *sk;
+	/* @gen was sampled before the table walk; if a binding changed
+	 * in between, the entry is born stale and never matches
+	 */
+	e->gen = gen;
+	local_bh_enable();
+}
+
+static void tipc_anycast_cache_flush(struct name_table *nt)
+{
+	/* ensure a reader sampling the new generation before its table
+	 * walk also sees the changed table contents; pairs with the
+	 * read barrier in tipc_nametbl_lookup_anycast()
+	 */
+	smp_wmb();
+	WRITE_ONCE(nt->cache_gen, nt->cache_gen + 1);
+}
+
 /**
  * service_range_foreach_match - iterate over tipc service rbtree for each
  *                               range match
@@ -488,8 +568,10 @@ struct publication *tipc_nametbl_insert_publ(struct net *net,
 	sc = tipc_service_find(net, ua);
 	if (!sc)
 		sc = tipc_service_create(net, ua);
-	if (sc && tipc_service_insert_publ(net, sc, p))
+	if (sc && tipc_service_insert_publ(net, sc, p)) {
+		tipc_anycast_cache_flush(tipc_name_table(net));
 		return p;
+	}
 	kfree(p);
 	return NULL;
 }
@@ -537,7 +619,9 @@ struct publication *tipc_nametbl_remove_publ(struct net *net,
 unlock:
 	spin_unlock_bh(&sc->lock);
 exit:
-	if (!p) {
+	if (p) {
+		tipc_anycast_cache_flush(tipc_name_table(net));
+	} else {
 		pr_err("Failed to remove unknown binding: %u,%u,%u/%u:%u/%u\n",
 		       ua->sr.type, ua->sr.lower, ua->sr.upper,
 		       sk->node, sk->ref, key);
@@ -570,19 +654,30 @@ bool tipc_nametbl_lookup_anycast(struct net *net,
 				 struct tipc_uaddr *ua,
 				 struct tipc_socket_addr *sk)
 {
+	struct name_table *nt = tipc_name_table(net);
 	struct tipc_net *tn = tipc_net(net);
 	bool legacy = tn->legacy_addr_format;
 	u32 self = tipc_own_addr(net);
 	u32 inst = ua->sa.instance;
+	u32 dnode = sk->node;
 	struct service_range *r;
 	struct tipc_service *sc;
+	bool cacheable = false;
 	struct publication *p;
 	struct list_head *l;
 	bool res = false;
+	u32 cache_gen;
 
 	if (!tipc_in_scope(legacy, sk->node, self))
 		return true;
 
+	/* in stable topologies most resolutions hit the per-cpu cache */
+	if (tipc_anycast_cache_hit(nt, ua->sr.type, inst, sk))
+		return true;
+
+	cache_gen = READ_ONCE(nt->cache_gen);
+	smp_rmb(); /* pairs with tipc_anycast_cache_flush() */
+
 	rcu_read_lock();
 	sc = tipc_service_find(net, ua);
 	if (unlikely(!sc))
@@ -608,6 +703,11 @@ bool tipc_nametbl_lookup_anycast(struct net *net,
 		}
 		*sk = p->sk;
 		res = true;
+		/* A single publication means the rotation above is a no-op,
+		 * so the result is deterministic and may be cached without
+		 * disturbing the round-robin distribution
+		 */
+		cacheable = list_is_singular(l);
 		/* Todo: as for legacy, pick the first matching range only, a
 		 * "true" round-robin will be performed as needed.
 		 */
@@ -617,6 +717,9 @@ bool tipc_nametbl_lookup_anycast(struct net *net,
 
 exit:
 	rcu_read_unlock();
+	if (res && cacheable)
+		tipc_anycast_cache_fill(nt, cache_gen, ua->sr.type, inst,
+					dnode, sk);
 	return res;
 }
 
@@ -892,6 +995,14 @@ int tipc_nametbl_init(struct net *net)
 	if (!nt)
 		return -ENOMEM;
 
+	nt->acast_cache = alloc_percpu(struct tipc_anycast_cache);
+	if (!nt->acast_cache) {
+		kfree(nt);
+		return -ENOMEM;
+	}
+	/* zeroed per-cpu entries must never match the live generation */
+	nt->cache_gen = 1;
+
 	for (i = 0; i < TIPC_NAMETBL_SIZE; i++)
 		INIT_HLIST_HEAD(&nt->services[i]);
 
@@ -950,6 +1061,7 @@ void tipc_nametbl_stop(struct net *net)
 	spin_unlock_bh(&tn->nametbl_lock);
 
 	synchronize_net();
+	free_percpu(nt->acast_cache);
 	kfree(nt);
 }
 
@@ -43,6 +43,7 @@ struct tipc_plist;
 struct tipc_nlist;
 struct tipc_group;
 struct tipc_uaddr;
+struct tipc_anycast_cache;
 
 /*
  * TIPC name types reserved for internal TIPC use (both current and planned)
@@ -100,6 +101,9 @@ struct publication {
  * @local_publ_count: number of publications issued by this node
  * @rc_dests: destination node counter
  * @snd_nxt: next sequence number to be used
+ * @acast_cache: per-cpu cache of deterministic anycast lookup results
+ * @cache_gen: name table generation; bumped on every binding change to
+ *             invalidate all cached lookup results at once
  */
 struct name_table {
 	struct hlist_head services[TIPC_NAMETBL_SIZE];
@@ -109,6 +113,8 @@ struct name_table {
 	u32 local_publ_count;
 	u32 rc_dests;
 	u32 snd_nxt;
+	struct tipc_anycast_cache __percpu *acast_cache;
+	u32 cache_gen;
 };
 
 int tipc_nl_name_table_dump(struct sk_buff *skb, struct netlink_callback *cb);
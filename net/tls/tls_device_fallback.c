@@ -136,19 +136,6 @@ static void tls_init_aead_request(struct aead_request *aead_req,
 	aead_request_set_ad(aead_req, TLS_AAD_SPACE_SIZE);
 }
 
-static struct aead_request *tls_alloc_aead_request(struct crypto_aead *aead,
-						   gfp_t flags)
-{
-	unsigned int req_size = sizeof(struct aead_request) +
-		crypto_aead_reqsize(aead);
-	struct aead_request *aead_req;
-
-	aead_req = kzalloc(req_size, flags);
-	if (aead_req)
-		tls_init_aead_request(aead_req, aead);
-	return aead_req;
-}
-
 static int tls_enc_records(struct aead_request *aead_req,
 			   struct crypto_aead *aead, struct scatterlist *sg_in,
 			   struct scatterlist *sg_out, char *aad, char *iv,
@@ -323,20 +310,19 @@ static struct sk_buff *tls_enc_skb(struct tls_context *tls_ctx,
 				   struct scatterlist sg_out[3],
 				   struct scatterlist *sg_in,
 				   struct sk_buff *skb,
-				   s32 sync_size, u64 rcd_sn)
+				   s32 sync_size, u64 rcd_sn,
+				   struct aead_request *aead_req)
 {
 	struct tls_offload_context_tx *ctx = tls_offload_ctx_tx(tls_ctx);
 	int tcp_payload_offset = skb_tcp_all_headers(skb);
 	int payload_len = skb->len - tcp_payload_offset;
 	const struct tls_cipher_size_desc *cipher_sz;
 	void *buf, *iv, *aad, *dummy_buf, *salt;
-	struct aead_request *aead_req;
 	struct sk_buff *nskb = NULL;
 	int buf_len;
 
-	aead_req = tls_alloc_aead_request(ctx->aead_send, GFP_ATOMIC);
-	if (!aead_req)
-		return NULL;
+	tls_init_aead_request(aead_req, ctx->aead_send);
+	aead_request_set_callback(aead_req, 0, NULL, NULL);
 
 	switch (tls_ctx->crypto_send.info.cipher_type) {
 	case TLS_CIPHER_AES_GCM_128:
@@ -346,14 +332,14 @@ static struct sk_buff *tls_enc_skb(struct tls_context *tls_ctx,
 		salt = tls_ctx->crypto_send.aes_gcm_256.salt;
 		break;
 	default:
-		goto free_req;
+		return NULL;
 	}
 	cipher_sz = &tls_cipher_size_desc[tls_ctx->crypto_send.info.cipher_type];
 	buf_len = cipher_sz->salt + cipher_sz->iv + TLS_AAD_SPACE_SIZE +
 		  sync_size + cipher_sz->tag;
 	buf = kmalloc(buf_len, GFP_ATOMIC);
 	if (!buf)
-		goto free_req;
+		return NULL;
 
 	iv = buf;
 	memcpy(iv, salt, cipher_sz->salt);
@@ -383,8 +369,6 @@ static struct sk_buff *tls_enc_skb(struct tls_context *tls_ctx,
 
 free_buf:
 	kfree(buf);
-free_req:
-	kfree(aead_req);
 	return nskb;
 free_nskb:
 	kfree_skb(nskb);
@@ -399,9 +383,11 @@ static struct sk_buff *tls_sw_fallback(struct sock *sk, struct sk_buff *skb)
 	struct tls_offload_context_tx *ctx = tls_offload_ctx_tx(tls_ctx);
 	int payload_len = skb->len - tcp_payload_offset;
 	struct scatterlist *sg_in, sg_out[3];
+	struct aead_request *aead_req;
 	struct sk_buff *nskb = NULL;
 	int sg_in_max_elements;
 	int resync_sgs = 0;
+	size_t sg_bytes;
 	s32 sync_size = 0;
 	u64 rcd_sn;
 
@@ -414,9 +400,14 @@ static struct sk_buff *tls_sw_fallback(struct sock *sk, struct sk_buff *skb)
 	if (!payload_len)
 		return skb;
 
-	sg_in = kmalloc_array(sg_in_max_elements, sizeof(*sg_in), GFP_ATOMIC);
+	/* single allocation for the sg vector and the aead request */
+	sg_bytes = ALIGN(array_size(sg_in_max_elements, sizeof(*sg_in)),
+			 __alignof__(*aead_req));
+	sg_in = kmalloc(sg_bytes + sizeof(*aead_req) +
+			crypto_aead_reqsize(ctx->aead_send), GFP_ATOMIC);
 	if (!sg_in)
 		goto free_orig;
+	aead_req = (struct aead_request *)((u8 *)sg_in + sg_bytes);
 
 	sg_init_table(sg_in, sg_in_max_elements);
 	sg_init_table(sg_out, ARRAY_SIZE(sg_out));
@@ -428,7 +419,8 @@ static struct sk_buff *tls_sw_fallback(struct sock *sk, struct sk_buff *skb)
 		goto put_sg;
 	}
 
-	nskb = tls_enc_skb(tls_ctx, sg_out, sg_in, skb, sync_size, rcd_sn);
+	nskb = tls_enc_skb(tls_ctx, sg_out, sg_in, skb, sync_size, rcd_sn,
+			   aead_req);
 
 put_sg:
 	while (resync_sgs)
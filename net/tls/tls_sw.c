@@ -222,10 +222,12 @@ static void tls_decrypt_done(void *data, int err)
 
 	kfree(aead_req);
 
-	spin_lock_bh(&ctx->decrypt_compl_lock);
-	if (!atomic_dec_return(&ctx->decrypt_pending))
+	/* decrypt_pending is biased by one, so it can only hit zero
+	 * once the reader has announced itself in tls_sw_recvmsg() --
+	 * the completion never fires without a waiter.
+	 */
+	if (atomic_dec_and_test(&ctx->decrypt_pending))
 		complete(&ctx->async_wait.completion);
-	spin_unlock_bh(&ctx->decrypt_compl_lock);
 }
 
 static int tls_do_decryption(struct sock *sk,
@@ -2105,16 +2107,17 @@ put_on_rx_list:
 
 recv_end:
 	if (async) {
-		int ret, pending;
+		int ret;
 
 		/* Wait for all previously submitted records to be decrypted */
-		spin_lock_bh(&ctx->decrypt_compl_lock);
-		reinit_completion(&ctx->async_wait.completion);
-		pending = atomic_read(&ctx->decrypt_pending);
-		spin_unlock_bh(&ctx->decrypt_compl_lock);
 		ret = 0;
-		if (pending)
+		if (!atomic_dec_and_test(&ctx->decrypt_pending))
 			ret = crypto_wait_req(-EINPROGRESS, &ctx->async_wait);
+		/* no completions are in flight past this point, rearm for
+		 * the next batch
+		 */
+		atomic_set(&ctx->decrypt_pending, 1);
+		reinit_completion(&ctx->async_wait.completion);
 		__skb_queue_purge(&ctx->async_hold);
 
 		if (ret) {
@@ -2550,7 +2553,8 @@ int tls_set_sw_offload(struct sock *sk, struct tls_context *ctx, int tx)
 		sw_ctx_tx->tx_work.sk = sk;
 	} else {
 		crypto_init_wait(&sw_ctx_rx->async_wait);
-		spin_lock_init(&sw_ctx_rx->decrypt_compl_lock);
+		/* bias the pending count, see tls_decrypt_done() */
+		atomic_set(&sw_ctx_rx->decrypt_pending, 1);
 		init_waitqueue_head(&sw_ctx_rx->wq);
 		crypto_info = &ctx->crypto_recv.info;
 		cctx = &ctx->rx;
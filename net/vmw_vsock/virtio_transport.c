@@ -83,12 +83,50 @@ out_rcu:
 	return ret;
 }
 
+/* Caller must hold vsock->tx_lock and have checked tx_run */
+static int virtio_transport_send_skb(struct virtio_vsock *vsock,
+				     struct sk_buff *skb, gfp_t gfp,
+				     bool *restart_rx)
+{
+	struct virtqueue *vq = vsock->vqs[VSOCK_VQ_TX];
+	struct scatterlist hdr, buf, *sgs[2];
+	int ret, out_sg = 0;
+
+	sg_init_one(&hdr, virtio_vsock_hdr(skb), sizeof(*virtio_vsock_hdr(skb)));
+	sgs[out_sg++] = &hdr;
+	if (skb->len > 0) {
+		sg_init_one(&buf, skb->data, skb->len);
+		sgs[out_sg++] = &buf;
+	}
+
+	ret = virtqueue_add_sgs(vq, sgs, out_sg, 0, skb, gfp);
+	/* Usually this means that there is no more space available in
+	 * the vq
+	 */
+	if (ret < 0)
+		return ret;
+
+	virtio_transport_deliver_tap_pkt(skb);
+
+	if (virtio_vsock_skb_reply(skb)) {
+		struct virtqueue *rx_vq = vsock->vqs[VSOCK_VQ_RX];
+		int val;
+
+		val = atomic_dec_return(&vsock->queued_replies);
+
+		/* Do we now have resources to resume rx processing? */
+		if (val + 1 == virtqueue_get_vring_size(rx_vq))
+			*restart_rx = true;
+	}
+
+	return 0;
+}
+
 static void
 virtio_transport_send_pkt_work(struct work_struct *work)
 {
 	struct virtio_vsock *vsock =
 		container_of(work, struct virtio_vsock, send_pkt_work);
-	struct virtqueue *vq;
 	bool added = false;
 	bool restart_rx = false;
 
@@ -97,53 +135,24 @@ virtio_transport_send_pkt_work(struct work_struct *work)
 	if (!vsock->tx_run)
 		goto out;
 
-	vq = vsock->vqs[VSOCK_VQ_TX];
-
 	for (;;) {
-		struct scatterlist hdr, buf, *sgs[2];
-		int ret, in_sg = 0, out_sg = 0;
 		struct sk_buff *skb;
-		bool reply;
 
 		skb = virtio_vsock_skb_dequeue(&vsock->send_pkt_queue);
 		if (!skb)
 			break;
 
-		virtio_transport_deliver_tap_pkt(skb);
-		reply = virtio_vsock_skb_reply(skb);
-
-		sg_init_one(&hdr, virtio_vsock_hdr(skb), sizeof(*virtio_vsock_hdr(skb)));
-		sgs[out_sg++] = &hdr;
-		if (skb->len > 0) {
-			sg_init_one(&buf, skb->data, skb->len);
-			sgs[out_sg++] = &buf;
-		}
-
-		ret = virtqueue_add_sgs(vq, sgs, out_sg, in_sg, skb, GFP_KERNEL);
-		/* Usually this means that there is no more space available in
-		 * the vq
-		 */
-		if (ret < 0) {
+		if (virtio_transport_send_skb(vsock, skb, GFP_KERNEL,
+					      &restart_rx) < 0) {
 			virtio_vsock_skb_queue_head(&vsock->send_pkt_queue, skb);
 			break;
 		}
 
-		if (reply) {
-			struct virtqueue *rx_vq = vsock->vqs[VSOCK_VQ_RX];
-			int val;
-
-			val = atomic_dec_return(&vsock->queued_replies);
-
-			/* Do we now have resources to resume rx processing? */
-			if (val + 1 == virtqueue_get_vring_size(rx_vq))
-				restart_rx = true;
-		}
-
 		added = true;
 	}
 
 	if (added)
-		virtqueue_kick(vq);
+		virtqueue_kick(vsock->vqs[VSOCK_VQ_TX]);
 
 out:
 	mutex_unlock(&vsock->tx_lock);
@@ -152,6 +161,31 @@ out:
 		queue_work(virtio_vsock_workqueue, &vsock->rx_work);
 }
 
+/* Called within rcu_read_lock(), so it must not sleep */
+static bool virtio_transport_send_skb_fast_path(struct virtio_vsock *vsock,
+						struct sk_buff *skb)
+{
+	bool restart_rx = false;
+	bool sent = false;
+
+	if (!mutex_trylock(&vsock->tx_lock))
+		return false;
+
+	if (vsock->tx_run &&
+	    virtio_transport_send_skb(vsock, skb, GFP_ATOMIC,
+				      &restart_rx) == 0) {
+		virtqueue_kick(vsock->vqs[VSOCK_VQ_TX]);
+		sent = true;
+	}
+
+	mutex_unlock(&vsock->tx_lock);
+
+	if (restart_rx)
+		queue_work(virtio_vsock_workqueue, &vsock->rx_work);
+
+	return sent;
+}
+
 static int
 virtio_transport_send_pkt(struct sk_buff *skb)
 {
@@ -178,8 +212,16 @@ virtio_transport_send_pkt(struct sk_buff *skb)
 	if (virtio_vsock_skb_reply(skb))
 		atomic_inc(&vsock->queued_replies);
 
-	virtio_vsock_skb_queue_tail(&vsock->send_pkt_queue, skb);
-	queue_work(virtio_vsock_workqueue, &vsock->send_pkt_work);
+	/* If the intermediate queue is empty, packet order is maintained even
+	 * when the packet is put on the virtqueue directly, sparing a worker
+	 * wakeup per packet. If the virtqueue is full or the tx_lock is
+	 * contended, fall back to the worker.
+	 */
+	if (!skb_queue_empty_lockless(&vsock->send_pkt_queue) ||
+	    !virtio_transport_send_skb_fast_path(vsock, skb)) {
+		virtio_vsock_skb_queue_tail(&vsock->send_pkt_queue, skb);
+		queue_work(virtio_vsock_workqueue, &vsock->send_pkt_work);
+	}
 
 out_rcu:
 	rcu_read_unlock();
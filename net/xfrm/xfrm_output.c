@@ -9,6 +9,7 @@
 #include <linux/module.h>
 #include <linux/netdevice.h>
 #include <linux/netfilter.h>
+#include <linux/padata.h>
 #include <linux/skbuff.h>
 #include <linux/slab.h>
 #include <linux/spinlock.h>
@@ -486,62 +487,82 @@ int pktgen_xfrm_outer_mode_output(struct xfrm_state *x, struct sk_buff *skb)
 EXPORT_SYMBOL_GPL(pktgen_xfrm_outer_mode_output);
 #endif
 
-static int xfrm_output_one(struct sk_buff *skb, int err)
+/* Everything that must happen before the transform itself runs: header
+ * space and state checks, outer header construction and, under the state
+ * lock, sequence number assignment.  Counts the error statistic but
+ * leaves freeing the skb to the caller.
+ */
+static int xfrm_output_prepare(struct xfrm_state *x, struct sk_buff *skb)
 {
-	struct dst_entry *dst = skb_dst(skb);
-	struct xfrm_state *x = dst->xfrm;
 	struct net *net = xs_net(x);
+	int err;
 
-	if (err <= 0 || x->xso.type == XFRM_DEV_OFFLOAD_PACKET)
-		goto resume;
+	err = xfrm_skb_check_space(skb);
+	if (err) {
+		XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTERROR);
+		return err;
+	}
 
-	do {
-		err = xfrm_skb_check_space(skb);
-		if (err) {
-			XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTERROR);
-			goto error_nolock;
-		}
+	skb->mark = xfrm_smark_get(skb->mark, x);
 
-		skb->mark = xfrm_smark_get(skb->mark, x);
+	err = xfrm_outer_mode_output(x, skb);
+	if (err) {
+		XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATEMODEERROR);
+		return err;
+	}
 
-		err = xfrm_outer_mode_output(x, skb);
-		if (err) {
-			XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATEMODEERROR);
-			goto error_nolock;
-		}
+	spin_lock_bh(&x->lock);
 
-		spin_lock_bh(&x->lock);
+	if (unlikely(x->km.state != XFRM_STATE_VALID)) {
+		XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATEINVALID);
+		err = -EINVAL;
+		goto error;
+	}
 
-		if (unlikely(x->km.state != XFRM_STATE_VALID)) {
-			XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATEINVALID);
-			err = -EINVAL;
-			goto error;
-		}
+	err = xfrm_state_check_expire(x);
+	if (err) {
+		XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATEEXPIRED);
+		goto error;
+	}
 
-		err = xfrm_state_check_expire(x);
-		if (err) {
-			XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATEEXPIRED);
-			goto error;
-		}
+	err = xfrm_replay_overflow(x, skb);
+	if (err) {
+		XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATESEQERROR);
+		goto error;
+	}
 
-		err = xfrm_replay_overflow(x, skb);
-		if (err) {
-			XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTSTATESEQERROR);
-			goto error;
-		}
+	x->curlft.bytes += skb->len;
+	x->curlft.packets++;
+	x->lastused = ktime_get_real_seconds();
 
-		x->curlft.bytes += skb->len;
-		x->curlft.packets++;
-		x->lastused = ktime_get_real_seconds();
+	spin_unlock_bh(&x->lock);
 
-		spin_unlock_bh(&x->lock);
+	skb_dst_force(skb);
+	if (!skb_dst(skb)) {
+		XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTERROR);
+		return -EHOSTUNREACH;
+	}
 
-		skb_dst_force(skb);
-		if (!skb_dst(skb)) {
-			XFRM_INC_STATS(net, LINUX_MIB_XFRMOUTERROR);
-			err = -EHOSTUNREACH;
+	return 0;
+
+error:
+	spin_unlock_bh(&x->lock);
+	return err;
+}
+
+static int xfrm_output_one(struct sk_buff *skb, int err)
+{
+	struct dst_entry *dst = skb_dst(skb);
+	struct xfrm_state *x = dst->xfrm;
+	struct net *net = xs_net(x);
+
+	if (err <= 0 || x->xso.type == XFRM_DEV_OFFLOAD_PACKET)
+		goto resume;
+
+	do {
+		err = xfrm_output_prepare(x, skb);
+		if (err)
 			goto error_nolock;
-		}
 
 		if (xfrm_offload(skb)) {
 			x->type_offload->encap(x, skb);
@@ -572,8 +593,6 @@ resume:
 
 	return 0;
 
-error:
-	spin_unlock_bh(&x->lock);
 error_nolock:
 	kfree_skb(skb);
 out:
@@ -614,6 +633,108 @@ static int xfrm_output2(struct net *net, struct sock *sk, struct sk_buff *skb)
 	return xfrm_output_resume(sk, skb, 1);
 }
 
+/* Optional parallel dispatch of the output transforms, enabled with the
+ * xfrm_output.parallel boot parameter.
+ *
+ * A single flow is otherwise limited to the one cpu its traffic is
+ * submitted on, with the transform running inline.  When enabled, the
+ * sequence number is still assigned on the submitting cpu in submission
+ * order (xfrm_output_prepare()), the transform itself runs on a padata
+ * worker cpu, and padata's serialization transmits the packets in
+ * submission order again -- so the sequence numbers leave the box
+ * monotonically and the peer's replay window sees no reordering.
+ */
+static bool xfrm_output_parallel __read_mostly;
+module_param_named(parallel, xfrm_output_parallel, bool, 0444);
+MODULE_PARM_DESC(parallel, "Run IPsec output transforms on padata worker cpus");
+
+struct xfrm_output_work {
+	struct padata_priv padata;
+	struct sk_buff *skb;
+	int err;
+};
+
+static struct padata_instance *xfrm_output_pinst __read_mostly;
+static struct padata_shell *xfrm_output_pshell __read_mostly;
+static struct kmem_cache *xfrm_output_work_cache __read_mostly;
+
+static void xfrm_output_work_run(struct padata_priv *padata)
+{
+	struct xfrm_output_work *pw =
+		container_of(padata, struct xfrm_output_work, padata);
+	struct sk_buff *skb = pw->skb;
+	struct xfrm_state *x = skb_dst(skb)->xfrm;
+
+	/* Inner headers are invalid now. */
+	skb->encapsulation = 0;
+
+	pw->err = x->type->output(x, skb);
+	padata_do_serial(padata);
+}
+
+static void xfrm_output_work_done(struct padata_priv *padata)
+{
+	struct xfrm_output_work *pw =
+		container_of(padata, struct xfrm_output_work, padata);
+	struct sk_buff *skb = pw->skb;
+	int err = pw->err;
+
+	kmem_cache_free(xfrm_output_work_cache, pw);
+
+	/* An async transform resumes transmission from its own completion
+	 * callback; ordering then degrades to what inline processing
+	 * provides today.
+	 */
+	if (err == -EINPROGRESS)
+		return;
+
+	xfrm_output_resume(skb->sk, skb, err);
+}
+
+static int xfrm_output_dispatch(struct sock *sk, struct sk_buff *skb)
+{
+	struct xfrm_state *x = skb_dst(skb)->xfrm;
+	struct xfrm_output_work *pw;
+	int cb_cpu;
+	int err;
+
+	err = xfrm_output_prepare(x, skb);
+	if (err) {
+		kfree_skb(skb);
+		return err;
+	}
+
+	pw = kmem_cache_alloc(xfrm_output_work_cache, GFP_ATOMIC);
+	if (!pw)
+		goto fallback;
+
+	memset(&pw->padata, 0, sizeof(pw->padata));
+	pw->padata.parallel = xfrm_output_work_run;
+	pw->padata.serial = xfrm_output_work_done;
+	pw->skb = skb;
+
+	/* Serialize on the submitting cpu to keep the transmit local. */
+	cb_cpu = raw_smp_processor_id();
+	err = padata_do_parallel(xfrm_output_pshell, &pw->padata, &cb_cpu);
+	if (err) {
+		kmem_cache_free(xfrm_output_work_cache, pw);
+		goto fallback;
+	}
+
+	return 0;
+
+fallback:
+	/* The sequence number is already assigned, run the transform
+	 * inline and resume past it.
+	 */
+	skb->encapsulation = 0;
+	err = x->type->output(x, skb);
+	if (err == -EINPROGRESS)
+		return 0;
+
+	return xfrm_output_resume(sk, skb, err);
+}
+
 static int xfrm_output_gso(struct net *net, struct sock *sk, struct sk_buff *skb)
 {
 	struct sk_buff *segs, *nskb;
@@ -771,10 +892,47 @@ int xfrm_output(struct sock *sk, struct sk_buff *skb)
 	}
 
 out:
+	if (xfrm_output_pshell && !xfrm_offload(skb))
+		return xfrm_output_dispatch(sk, skb);
+
 	return xfrm_output2(net, sk, skb);
 }
 EXPORT_SYMBOL_GPL(xfrm_output);
 
+void __init xfrm_output_init(void)
+{
+	struct padata_instance *pinst;
+	struct padata_shell *pshell;
+
+	if (!xfrm_output_parallel)
+		return;
+
+	xfrm_output_work_cache = kmem_cache_create("xfrm_output_work",
+						   sizeof(struct xfrm_output_work),
+						   0, 0, NULL);
+	if (!xfrm_output_work_cache)
+		return;
+
+	pinst = padata_alloc("xfrm_output");
+	if (!pinst)
+		goto err_cache;
+
+	pshell = padata_alloc_shell(pinst);
+	if (!pshell)
+		goto err_pinst;
+
+	xfrm_output_pinst = pinst;
+	/* Checked in xfrm_output(), set last. */
+	xfrm_output_pshell = pshell;
+	return;
+
+err_pinst:
+	padata_free(pinst);
+err_cache:
+	kmem_cache_destroy(xfrm_output_work_cache);
+	xfrm_output_work_cache = NULL;
+}
+
 static int xfrm4_tunnel_check_size(struct sk_buff *skb)
 {
 	int mtu, ret = 0;
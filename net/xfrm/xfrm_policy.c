@@ -194,6 +194,16 @@ static inline bool xfrm_pol_hold_rcu(struct xfrm_policy *policy)
 	return refcount_inc_not_zero(&policy->refcnt);
 }
 
+/* Bumped whenever a policy is added to or removed from an SPD; this
+ * invalidates the per-cpu lookup cache, see xfrm_policy_cache_lookup().
+ */
+static atomic_t xfrm_policy_lookup_genid = ATOMIC_INIT(0);
+
+static void xfrm_policy_lookup_cache_flush(void)
+{
+	atomic_inc(&xfrm_policy_lookup_genid);
+}
+
 static inline bool
 __xfrm4_selector_match(const struct xfrm_selector *sel, const struct flowi *fl)
 {
@@ -1592,6 +1602,7 @@ int xfrm_policy_insert(int dir, struct xfrm_policy *policy, int excl)
 	}
 
 	__xfrm_policy_link(policy, dir);
+	xfrm_policy_lookup_cache_flush();
 
 	/* After previous checking, family can either be AF_INET or AF_INET6 */
 	if (policy->family == AF_INET)
@@ -2144,6 +2155,89 @@ xfrm_policy_eval_candidates(struct xfrm_pol_inexact_candidates *cand,
 	return prefer;
 }
 
+/* Per-cpu cache of the last result of xfrm_policy_lookup_bytype().
+ *
+ * Entries hold no reference.  A hit is only valid while the generation
+ * count matches, i.e. while no policy has been added to or removed from
+ * any SPD since the entry was filled; since the flow key is compared in
+ * full, a hit then resolves to exactly the policy the hash and bin
+ * walks would have found.  The generation count also keeps a hit from
+ * dereferencing a stale pointer: an unlinked policy is not freed before
+ * the RCU grace period following the bump.
+ */
+struct xfrm_policy_lookup_cache {
+	struct net *net;
+	struct xfrm_policy *policy;	/* no reference held */
+	u32 genid;
+	u32 if_id;
+	u16 family;
+	u8 type;
+	u8 dir;
+	struct flowi fl;
+};
+
+static DEFINE_PER_CPU(struct xfrm_policy_lookup_cache, xfrm_policy_lookup_cache);
+
+static unsigned int xfrm_flowi_size(u16 family)
+{
+	switch (family) {
+	case AF_INET:
+		return sizeof(struct flowi4);
+	case AF_INET6:
+		return sizeof(struct flowi6);
+	}
+	return 0;
+}
+
+static struct xfrm_policy *
+xfrm_policy_cache_lookup(struct net *net, u8 type, const struct flowi *fl,
+			 u16 family, u8 dir, u32 if_id, u32 genid)
+{
+	unsigned int flsize = xfrm_flowi_size(family);
+	struct xfrm_policy_lookup_cache *c;
+	struct xfrm_policy *pol = NULL;
+
+	if (!flsize)
+		return NULL;
+
+	local_bh_disable();
+	c = this_cpu_ptr(&xfrm_policy_lookup_cache);
+	if (c->genid == genid && c->net == net && c->type == type &&
+	    c->family == family && c->dir == dir && c->if_id == if_id &&
+	    !memcmp(&c->fl, fl, flsize))
+		pol = c->policy;
+	local_bh_enable();
+
+	if (!pol || unlikely(pol->walk.dead) || !xfrm_pol_hold_rcu(pol))
+		return NULL;
+
+	return pol;
+}
+
+static void xfrm_policy_cache_store(struct net *net, u8 type,
+				    const struct flowi *fl, u16 family,
+				    u8 dir, u32 if_id, u32 genid,
+				    struct xfrm_policy *pol)
+{
+	unsigned int flsize = xfrm_flowi_size(family);
+	struct xfrm_policy_lookup_cache *c;
+
+	if (!flsize)
+		return;
+
+	local_bh_disable();
+	c = this_cpu_ptr(&xfrm_policy_lookup_cache);
+	c->net = net;
+	c->policy = pol;
+	c->genid = genid;
+	c->if_id = if_id;
+	c->family = family;
+	c->type = type;
+	c->dir = dir;
+	memcpy(&c->fl, fl, flsize);
+	local_bh_enable();
+}
+
 static struct xfrm_policy *xfrm_policy_lookup_bytype(struct net *net, u8 type,
 						     const struct flowi *fl,
 						     u16 family, u8 dir,
@@ -2155,6 +2249,7 @@ static struct xfrm_policy *xfrm_policy_lookup_bytype(struct net *net, u8 type,
 	struct xfrm_policy *pol, *ret;
 	struct hlist_head *chain;
 	unsigned int sequence;
+	u32 cache_genid;
 	int err;
 
 	daddr = xfrm_flowi_daddr(fl, family);
@@ -2163,6 +2258,18 @@ static struct xfrm_policy *xfrm_policy_lookup_bytype(struct net *net, u8 type,
 		return NULL;
 
 	rcu_read_lock();
+	/* The generation count is snapshotted before the walk: should the
+	 * found policy be unlinked while the walk is in progress, the
+	 * bump makes the filled entry invalid rather than the next hit
+	 * unsafe.
+	 */
+	cache_genid = (u32)atomic_read(&xfrm_policy_lookup_genid);
+	ret = xfrm_policy_cache_lookup(net, type, fl, family, dir, if_id,
+				       cache_genid);
+	if (ret) {
+		rcu_read_unlock();
+		return ret;
+	}
  retry:
 	do {
 		sequence = read_seqcount_begin(&net->xfrm.xfrm_policy_hash_generation);
@@ -2206,6 +2313,10 @@ skip_inexact:
 
 	if (ret && !xfrm_pol_hold_rcu(ret))
 		goto retry;
+
+	if (ret)
+		xfrm_policy_cache_store(net, type, fl, family, dir, if_id,
+					cache_genid, ret);
 fail:
 	rcu_read_unlock();
 
@@ -2297,6 +2408,7 @@ static struct xfrm_policy *__xfrm_policy_unlink(struct xfrm_policy *pol,
 
 	list_del_init(&pol->walk.all);
 	net->xfrm.policy_count[dir]--;
+	xfrm_policy_lookup_cache_flush();
 
 	return pol;
 }
@@ -4252,6 +4364,7 @@ void __init xfrm_init(void)
 	register_pernet_subsys(&xfrm_net_ops);
 	xfrm_dev_init();
 	xfrm_input_init();
+	xfrm_output_init();
 
 #ifdef CONFIG_XFRM_ESPINTCP
 	espintcp_init();
@@ -55,6 +55,16 @@ static inline bool xfrm_state_hold_rcu(struct xfrm_state __rcu *x)
 	return refcount_inc_not_zero(&x->refcnt);
 }
 
+/* Bumped whenever a state is added to or removed from an SAD; this
+ * invalidates the per-cpu lookup cache, see xfrm_state_cache_get().
+ */
+static atomic_t xfrm_state_find_genid = ATOMIC_INIT(0);
+
+static void xfrm_state_find_cache_flush(void)
+{
+	atomic_inc(&xfrm_state_find_genid);
+}
+
 static inline unsigned int xfrm_dst_hash(struct net *net,
 					 const xfrm_address_t *daddr,
 					 const xfrm_address_t *saddr,
@@ -715,6 +725,7 @@ int __xfrm_state_delete(struct xfrm_state *x)
 		if (x->id.spi)
 			hlist_del_rcu(&x->byspi);
 		net->xfrm.state_num--;
+		xfrm_state_find_cache_flush();
 		spin_unlock(&net->xfrm.xfrm_state_lock);
 
 		if (x->encap_sk)
@@ -1133,6 +1144,111 @@ static void xfrm_state_look_at(struct xfrm_policy *pol, struct xfrm_state *x,
 	}
 }
 
+/* Per-cpu cache of the last result of xfrm_state_find().
+ *
+ * Entries hold no reference.  A hit is only valid while the generation
+ * count matches, i.e. while no state has been added to or removed from
+ * any SAD since the entry was filled; since the flow key is compared in
+ * full, a hit then resolves to exactly the state the hash walks would
+ * have found.  The generation count also keeps a hit from dereferencing
+ * a stale pointer: an unlinked state is not freed before the RCU grace
+ * period following the bump.
+ */
+struct xfrm_state_find_cache {
+	struct net *net;
+	struct xfrm_state *state;	/* no reference held */
+	const struct xfrm_policy *policy;
+	const struct xfrm_tmpl *tmpl;
+	u32 genid;
+	u32 if_id;
+	u16 family;
+	struct flowi fl;
+};
+
+static DEFINE_PER_CPU(struct xfrm_state_find_cache, xfrm_state_find_cache);
+
+static unsigned int xfrm_flowi_size(unsigned short family)
+{
+	switch (family) {
+	case AF_INET:
+		return sizeof(struct flowi4);
+	case AF_INET6:
+		return sizeof(struct flowi6);
+	}
+	return 0;
+}
+
+static struct xfrm_state *
+xfrm_state_cache_get(struct net *net, const xfrm_address_t *daddr,
+		     const xfrm_address_t *saddr, const struct flowi *fl,
+		     struct xfrm_tmpl *tmpl, struct xfrm_policy *pol,
+		     unsigned short family, u32 if_id, u32 mark, u32 genid)
+{
+	unsigned int flsize = xfrm_flowi_size(family);
+	struct xfrm_state_find_cache *c;
+	struct xfrm_state *x = NULL;
+
+	if (!flsize)
+		return NULL;
+
+	local_bh_disable();
+	c = this_cpu_ptr(&xfrm_state_find_cache);
+	if (c->genid == genid && c->net == net && c->policy == pol &&
+	    c->tmpl == tmpl && c->family == family && c->if_id == if_id &&
+	    !memcmp(&c->fl, fl, flsize))
+		x = c->state;
+	local_bh_enable();
+
+	if (!x)
+		return NULL;
+
+	/* The template fields are compared even though the inputs are
+	 * identical: 'pol' may be a different policy that reuses the
+	 * address of the cached one, or its templates may have been
+	 * rewritten by migration.
+	 */
+	if (x->km.state != XFRM_STATE_VALID || x->km.dying ||
+	    x->props.family != tmpl->encap_family ||
+	    x->props.reqid != tmpl->reqid ||
+	    x->props.mode != tmpl->mode ||
+	    x->id.proto != tmpl->id.proto ||
+	    (tmpl->id.spi && tmpl->id.spi != x->id.spi) ||
+	    (mark & x->mark.m) != x->mark.v ||
+	    !xfrm_state_addr_check(x, daddr, saddr, tmpl->encap_family) ||
+	    !security_xfrm_state_pol_flow_match(x, pol, &fl->u.__fl_common))
+		return NULL;
+
+	if (!xfrm_state_hold_rcu(x))
+		return NULL;
+
+	return x;
+}
+
+static void xfrm_state_cache_store(struct net *net, const struct flowi *fl,
+				   const struct xfrm_tmpl *tmpl,
+				   const struct xfrm_policy *pol,
+				   unsigned short family, u32 if_id,
+				   u32 genid, struct xfrm_state *x)
+{
+	unsigned int flsize = xfrm_flowi_size(family);
+	struct xfrm_state_find_cache *c;
+
+	if (!flsize)
+		return;
+
+	local_bh_disable();
+	c = this_cpu_ptr(&xfrm_state_find_cache);
+	c->net = net;
+	c->state = x;
+	c->policy = pol;
+	c->tmpl = tmpl;
+	c->genid = genid;
+	c->if_id = if_id;
+	c->family = family;
+	memcpy(&c->fl, fl, flsize);
+	local_bh_enable();
+}
+
 struct xfrm_state *
 xfrm_state_find(const xfrm_address_t *daddr, const xfrm_address_t *saddr,
 		const struct flowi *fl, struct xfrm_tmpl *tmpl,
@@ -1149,6 +1265,7 @@ xfrm_state_find(const xfrm_address_t *daddr, const xfrm_address_t *saddr,
 	u32 mark = pol->mark.v & pol->mark.m;
 	unsigned short encap_family = tmpl->encap_family;
 	unsigned int sequence;
+	u32 cache_genid;
 	struct km_event c;
 
 	to_put = NULL;
@@ -1156,6 +1273,19 @@ xfrm_state_find(const xfrm_address_t *daddr, const xfrm_address_t *saddr,
 	sequence = read_seqcount_begin(&net->xfrm.xfrm_state_hash_generation);
 
 	rcu_read_lock();
+	/* The generation count is snapshotted before the walk: should the
+	 * found state be unlinked while the walk is in progress, the bump
+	 * makes the filled entry invalid rather than the next hit unsafe.
+	 */
+	cache_genid = (u32)atomic_read(&xfrm_state_find_genid);
+	x = xfrm_state_cache_get(net, daddr, saddr, fl, tmpl, pol, family,
+				 if_id, mark, cache_genid);
+	if (x) {
+		rcu_read_unlock();
+		*err = 0;
+		return x;
+	}
+
 	h = xfrm_dst_hash(net, daddr, saddr, tmpl->reqid, encap_family);
 	hlist_for_each_entry_rcu(x, net->xfrm.state_bydst + h, bydst) {
 #ifdef CONFIG_XFRM_OFFLOAD
@@ -1358,6 +1488,10 @@ out:
 		}
 	}
 
+	if (x && x->km.state == XFRM_STATE_VALID && !x->km.dying)
+		xfrm_state_cache_store(net, fl, tmpl, pol, family, if_id,
+				       cache_genid, x);
+
 	return x;
 }
 
@@ -1453,6 +1587,7 @@ static void __xfrm_state_insert(struct xfrm_state *x)
 		mod_timer(&x->rtimer, jiffies + x->replay_maxage);
 
 	net->xfrm.state_num++;
+	xfrm_state_find_cache_flush();
 
 	xfrm_hash_grow_check(net, x->bydst.next != NULL);
 }
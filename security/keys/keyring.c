@@ -51,6 +51,161 @@ static inline void *keyring_key_to_ptr(struct key *key)
 
 static DEFINE_RWLOCK(keyring_name_lock);
 
+/*
+ * Per-keyring fast index over the assoc_array for direct (type+description)
+ * lookups.  A small direct-mapped table caches the object last found for a
+ * given index-key hash and, for a short TTL, the fact that a hash was not
+ * found at all, so that repeated lookups - and in particular the repeated
+ * misses generated by request_key() storms - don't each pay for a full tree
+ * walk.
+ *
+ * Correctness hangs off @gen: every change to the keyring's content bumps it
+ * and an entry is only believed whilst its recorded generation still matches.
+ * A matching generation means no edit has been applied since the entry was
+ * installed, so a cached object is still linked into the tree (and thus
+ * RCU-live for the duration of the search) and a cached negative result
+ * cannot hide a key that was added afterwards.
+ */
+#define KEYRING_NCACHE_SIZE	16	/* cache slots; must be a power of two */
+#define KEYRING_NCACHE_TTL	30	/* lifetime of a negative result (s) */
+
+struct keyring_ncache_entry {
+	unsigned long	hash;		/* index-key hash this slot caches */
+	unsigned int	gen;		/* cache generation at installation */
+	time64_t	expiry;		/* negative results only: valid until */
+	const void	*object;	/* object found, or NULL if negative */
+};
+
+struct keyring_ncache {
+	atomic_t	gen;		/* bumped on every keyring change */
+	spinlock_t	lock;		/* serialises entry installation */
+	struct keyring_ncache_entry entries[KEYRING_NCACHE_SIZE];
+};
+
+enum keyring_ncache_result {
+	KEYRING_NCACHE_MISS,		/* nothing cached; do a tree walk */
+	KEYRING_NCACHE_POSITIVE,	/* cached object returned */
+	KEYRING_NCACHE_NEGATIVE,	/* cached "not in this keyring" */
+};
+
+/*
+ * Invalidate a keyring's fast index.  Must be called after applying any edit
+ * that changes the set of objects in the keyring's tree.
+ */
+static void keyring_ncache_invalidate(struct key *keyring)
+{
+	struct keyring_ncache *ncache = READ_ONCE(keyring->ncache);
+
+	if (ncache) {
+		/* Order the tree change before the generation bump so that a
+		 * searcher that observes the new generation also observes the
+		 * new tree (pairs with the barrier in search_keyring()).
+		 */
+		smp_mb__before_atomic();
+		atomic_inc(&ncache->gen);
+	}
+}
+
+/*
+ * Get a keyring's fast index, allocating it on first use.  Allocation may be
+ * attempted under the RCU read lock and is allowed to fail quietly - the
+ * cache is strictly an optimisation.
+ */
+static struct keyring_ncache *keyring_ncache_get(struct key *keyring)
+{
+	struct keyring_ncache *ncache = READ_ONCE(keyring->ncache);
+
+	if (ncache)
+		return ncache;
+
+	ncache = kzalloc(sizeof(*ncache), GFP_NOWAIT | __GFP_NOWARN);
+	if (!ncache)
+		return NULL;
+
+	/* Zeroed entries never validate as gen 0 is never current */
+	atomic_set(&ncache->gen, 1);
+	spin_lock_init(&ncache->lock);
+
+	if (cmpxchg(&keyring->ncache, NULL, ncache) != NULL) {
+		kfree(ncache);
+		ncache = READ_ONCE(keyring->ncache);
+	}
+	return ncache;
+}
+
+/*
+ * Look up an index-key hash in a keyring's fast index.  @gen is the
+ * generation sampled by the caller before consulting the cache.  The entry is
+ * read unlocked against concurrent installation; the generation recheck after
+ * the field reads rejects torn entries, as an installer zeroes the generation
+ * around the field updates and 0 is never a live generation (pairs with the
+ * write ordering in keyring_ncache_install()).  A positive result is in any
+ * case revalidated by the caller through ctx->iterator().
+ */
+static enum keyring_ncache_result
+keyring_ncache_lookup(struct keyring_ncache *ncache,
+		      struct keyring_search_context *ctx,
+		      unsigned int gen, const void **_object)
+{
+	struct keyring_ncache_entry *entry;
+	const void *object;
+	time64_t expiry;
+
+	entry = &ncache->entries[ctx->index_key.hash &
+				 (KEYRING_NCACHE_SIZE - 1)];
+
+	if (READ_ONCE(entry->gen) != gen)
+		return KEYRING_NCACHE_MISS;
+	smp_rmb();
+	if (READ_ONCE(entry->hash) != ctx->index_key.hash)
+		return KEYRING_NCACHE_MISS;
+	object = READ_ONCE(entry->object);
+	expiry = READ_ONCE(entry->expiry);
+	smp_rmb();
+	if (READ_ONCE(entry->gen) != gen)
+		return KEYRING_NCACHE_MISS;
+
+	if (!object) {
+		if (ctx->now >= expiry)
+			return KEYRING_NCACHE_MISS;
+		return KEYRING_NCACHE_NEGATIVE;
+	}
+	*_object = object;
+	return KEYRING_NCACHE_POSITIVE;
+}
+
+/*
+ * Install the result of a tree walk in a keyring's fast index.  @gen is the
+ * generation sampled before the walk; if the keyring has been modified in the
+ * meantime the result may already be stale and is not cached.
+ */
+static void keyring_ncache_install(struct keyring_ncache *ncache,
+				   struct keyring_search_context *ctx,
+				   unsigned int gen, const void *object)
+{
+	struct keyring_ncache_entry *entry;
+
+	entry = &ncache->entries[ctx->index_key.hash &
+				 (KEYRING_NCACHE_SIZE - 1)];
+
+	spin_lock(&ncache->lock);
+	if (atomic_read(&ncache->gen) == gen) {
+		/* Invalidate the slot around the field updates so that an
+		 * unlocked reader can't pair the generation with fields from
+		 * a different installation.
+		 */
+		WRITE_ONCE(entry->gen, 0);
+		smp_wmb();
+		WRITE_ONCE(entry->hash, ctx->index_key.hash);
+		WRITE_ONCE(entry->object, object);
+		WRITE_ONCE(entry->expiry,
+			   object ? 0 : ctx->now + KEYRING_NCACHE_TTL);
+		smp_wmb();
+		WRITE_ONCE(entry->gen, gen);
+	}
+	spin_unlock(&ncache->lock);
+}
+
 /*
  * Clean up the bits of user_namespace that belong to us.
  */
@@ -429,6 +584,7 @@ static void keyring_destroy(struct key *keyring)
 	}
 
 	assoc_array_destroy(&keyring->keys, &keyring_assoc_array_ops);
+	kfree(keyring->ncache);
 }
 
 /*
@@ -646,11 +802,45 @@ skipped:
 static int search_keyring(struct key *keyring, struct keyring_search_context *ctx)
 {
 	if (ctx->match_data.lookup_type == KEYRING_SEARCH_LOOKUP_DIRECT) {
+		struct keyring_ncache *ncache = keyring_ncache_get(keyring);
 		const void *object;
+		unsigned int gen = 0;
+		int ret;
+
+		if (ncache) {
+			/* A wrapped generation of 0 would validate slots that
+			 * are mid-installation; just skip the cache then.
+			 */
+			gen = atomic_read(&ncache->gen);
+			/* Order the generation read before the cache and tree
+			 * reads (pairs with keyring_ncache_invalidate()).
+			 */
+			smp_rmb();
+		}
+		if (gen) {
+			switch (keyring_ncache_lookup(ncache, ctx, gen,
+						      &object)) {
+			case KEYRING_NCACHE_NEGATIVE:
+				return 0;
+			case KEYRING_NCACHE_POSITIVE:
+				ret = ctx->iterator(object, ctx);
+				if (ret)
+					return ret;
+				/* The iterator didn't accept the cached
+				 * object (eg. a hash collision or a torn
+				 * entry); fall back to the full walk.
+				 */
+				break;
+			case KEYRING_NCACHE_MISS:
+				break;
+			}
+		}
 
 		object = assoc_array_find(&keyring->keys,
 					  &keyring_assoc_array_ops,
 					  &ctx->index_key);
+		if (gen)
+			keyring_ncache_install(ncache, ctx, gen, object);
 		return object ? ctx->iterator(object, ctx) : 0;
 	}
 	return assoc_array_iterate(&keyring->keys, ctx->iterator, ctx);
@@ -1370,6 +1560,7 @@ void __key_link(struct key *keyring, struct key *key,
 	__key_get(key);
 	assoc_array_insert_set_object(*_edit, keyring_key_to_ptr(key));
 	assoc_array_apply_edit(*_edit);
+	keyring_ncache_invalidate(keyring);
 	*_edit = NULL;
 	notify_key(keyring, NOTIFY_KEY_LINKED, key_serial(key));
 }
@@ -1507,6 +1698,7 @@ static void __key_unlink(struct key *keyring, struct key *key,
 			 struct assoc_array_edit **_edit)
 {
 	assoc_array_apply_edit(*_edit);
+	keyring_ncache_invalidate(keyring);
 	notify_key(keyring, NOTIFY_KEY_UNLINKED, key_serial(key));
 	*_edit = NULL;
 	key_payload_reserve(keyring, keyring->datalen - KEYQUOTA_LINK_BYTES);
@@ -1660,6 +1852,7 @@ int keyring_clear(struct key *keyring)
 	} else {
 		if (edit)
 			assoc_array_apply_edit(edit);
+		keyring_ncache_invalidate(keyring);
 		notify_key(keyring, NOTIFY_KEY_CLEARED, 0);
 		key_payload_reserve(keyring, 0);
 		ret = 0;
@@ -1683,6 +1876,7 @@ static void keyring_revoke(struct key *keyring)
 	if (!IS_ERR(edit)) {
 		if (edit)
 			assoc_array_apply_edit(edit);
+		keyring_ncache_invalidate(keyring);
 		key_payload_reserve(keyring, 0);
 	}
 }
@@ -1739,6 +1933,7 @@ do_gc:
 	down_write(&keyring->sem);
 	assoc_array_gc(&keyring->keys, &keyring_assoc_array_ops,
 		       keyring_gc_select_iterator, &limit);
+	keyring_ncache_invalidate(keyring);
 	up_write(&keyring->sem);
 	kleave(" [gc]");
 }
@@ -26,6 +26,7 @@
 #include <linux/ip.h>
 #include <linux/audit.h>
 #include <linux/ipv6.h>
+#include <linux/local_lock.h>
 #include <net/ipv6.h>
 #include "avc.h"
 #include "avc_ss.h"
@@ -36,8 +37,21 @@
 
 #define AVC_CACHE_SLOTS			512
 #define AVC_DEF_CACHE_THRESHOLD		512
+#define AVC_CACHE_THRESHOLD_MAX		(AVC_DEF_CACHE_THRESHOLD * 16)
 #define AVC_CACHE_RECLAIM		16
 
+/* Per-CPU front cache slots; must be a power of two */
+#define AVC_FCACHE_SLOTS		32
+
+/*
+ * Auto-sizing of the cache threshold: if the shared cache has to reclaim
+ * nodes more than AVC_AUTOSIZE_RECLAIMS times within one window, the
+ * working set doesn't fit and the threshold is doubled; a quiet window
+ * decays an earlier enlargement.
+ */
+#define AVC_AUTOSIZE_WINDOW		(10 * HZ)
+#define AVC_AUTOSIZE_RECLAIMS		64
+
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
 #else
@@ -73,9 +87,44 @@ struct avc_cache {
 	spinlock_t		slots_lock[AVC_CACHE_SLOTS]; /* lock for writes */
 	atomic_t		lru_hint;	/* LRU hint for reclaim scan */
 	atomic_t		active_nodes;
+	atomic_t		fcache_gen;	/* front cache generation */
 	u32			latest_notif;	/* latest revocation notification */
 };
 
+/*
+ * The per-CPU front cache answers repeat (ssid,tsid,tclass) queries on the
+ * plain permission-check path without touching the shared hash table, whose
+ * cachelines bounce between CPUs under diverse workloads.  Entries hold a
+ * copy of the av_decision rather than a node pointer, so they need no
+ * reference counting and cannot outlive the memory they describe; they are
+ * instead tagged with a generation that is bumped whenever a cached decision
+ * may change meaning (policy reload via avc_flush(), node updates via
+ * avc_update_node()).  Plain evictions from the shared cache don't bump the
+ * generation as the copied decisions remain valid.
+ *
+ * Each entry is seqcount-protected: readers may hit another CPU's array
+ * after migration, and writers on one CPU may be interrupted by a softirq
+ * performing its own insertion, so writers serialise via a local lock with
+ * interrupts disabled and readers retry on a torn entry.
+ */
+struct avc_fcache_entry {
+	seqcount_t		seq;
+	u32			ssid;
+	u32			tsid;
+	u32			gen;		/* fcache_gen at insertion */
+	u16			tclass;
+	struct av_decision	avd;
+};
+
+struct avc_fcache {
+	local_lock_t		lock;	/* serialises writers on this CPU */
+	struct avc_fcache_entry	entries[AVC_FCACHE_SLOTS];
+};
+
+static DEFINE_PER_CPU(struct avc_fcache, avc_fcache) = {
+	.lock = INIT_LOCAL_LOCK(lock),
+};
+
 struct avc_callback_node {
 	int (*callback) (u32 event);
 	u32 events;
@@ -88,6 +137,9 @@ DEFINE_PER_CPU(struct avc_cache_stats, avc_cache_stats) = { 0 };
 
 struct selinux_avc {
 	unsigned int avc_cache_threshold;
+	bool avc_cache_threshold_pinned; /* set by the admin; stop auto-sizing */
+	unsigned long autosize_window;	/* start of reclaim pressure window */
+	unsigned int autosize_reclaims;	/* reclaim calls in current window */
 	struct avc_cache avc_cache;
 };
 
@@ -98,12 +150,15 @@ void selinux_avc_init(struct selinux_avc **avc)
 	int i;
 
 	selinux_avc.avc_cache_threshold = AVC_DEF_CACHE_THRESHOLD;
+	selinux_avc.autosize_window = jiffies;
 	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
 		INIT_HLIST_HEAD(&selinux_avc.avc_cache.slots[i]);
 		spin_lock_init(&selinux_avc.avc_cache.slots_lock[i]);
 	}
 	atomic_set(&selinux_avc.avc_cache.active_nodes, 0);
 	atomic_set(&selinux_avc.avc_cache.lru_hint, 0);
+	/* Zeroed front cache entries never validate against generation 1 */
+	atomic_set(&selinux_avc.avc_cache.fcache_gen, 1);
 	*avc = &selinux_avc;
 }
 
@@ -116,6 +171,8 @@ void avc_set_cache_threshold(struct selinux_avc *avc,
 			     unsigned int cache_threshold)
 {
 	avc->avc_cache_threshold = cache_threshold;
+	/* An explicitly configured threshold takes auto-sizing out of play */
+	avc->avc_cache_threshold_pinned = true;
 }
 
 static struct avc_callback_node *avc_callbacks __ro_after_init;
@@ -136,6 +193,15 @@ static inline int avc_hash(u32 ssid, u32 tsid, u16 tclass)
  */
 void __init avc_init(void)
 {
+	int cpu, i;
+
+	for_each_possible_cpu(cpu) {
+		struct avc_fcache *fcache = per_cpu_ptr(&avc_fcache, cpu);
+
+		for (i = 0; i < AVC_FCACHE_SLOTS; i++)
+			seqcount_init(&fcache->entries[i].seq);
+	}
+
 	avc_node_cachep = kmem_cache_create("avc_node", sizeof(struct avc_node),
 					0, SLAB_PANIC, NULL);
 	avc_xperms_cachep = kmem_cache_create("avc_xperms_node",
@@ -462,6 +528,44 @@ static void avc_node_replace(struct selinux_avc *avc,
 	atomic_dec(&avc->avc_cache.active_nodes);
 }
 
+/*
+ * Resize the cache threshold from reclaim pressure.  Sustained reclaim
+ * within one window means the distinct-context working set doesn't fit and
+ * misses are falling through to full security-server computation, so the
+ * threshold is doubled (up to a cap); a quiet window shrinks it back
+ * towards the default.  An explicitly configured threshold is left alone.
+ *
+ * Called without locks from the reclaim path; the counters are updated
+ * racily, which at worst makes a window slightly longer or shorter.
+ */
+static void avc_autosize_cache(struct selinux_avc *avc)
+{
+	unsigned int threshold = READ_ONCE(avc->avc_cache_threshold);
+	unsigned int reclaims = READ_ONCE(avc->autosize_reclaims);
+	unsigned long now = jiffies;
+
+	if (READ_ONCE(avc->avc_cache_threshold_pinned))
+		return;
+
+	if (time_after(now, READ_ONCE(avc->autosize_window) +
+		       AVC_AUTOSIZE_WINDOW)) {
+		if (reclaims < AVC_AUTOSIZE_RECLAIMS / 4 &&
+		    threshold > AVC_DEF_CACHE_THRESHOLD)
+			WRITE_ONCE(avc->avc_cache_threshold, threshold / 2);
+		WRITE_ONCE(avc->autosize_window, now);
+		WRITE_ONCE(avc->autosize_reclaims, 1);
+		return;
+	}
+
+	WRITE_ONCE(avc->autosize_reclaims, reclaims + 1);
+	if (reclaims + 1 >= AVC_AUTOSIZE_RECLAIMS) {
+		if (threshold < AVC_CACHE_THRESHOLD_MAX)
+			WRITE_ONCE(avc->avc_cache_threshold, threshold * 2);
+		WRITE_ONCE(avc->autosize_window, now);
+		WRITE_ONCE(avc->autosize_reclaims, 0);
+	}
+}
+
 static inline int avc_reclaim_node(struct selinux_avc *avc)
 {
 	struct avc_node *node;
@@ -470,6 +574,8 @@ static inline int avc_reclaim_node(struct selinux_avc *avc)
 	struct hlist_head *head;
 	spinlock_t *lock;
 
+	avc_autosize_cache(avc);
+
 	for (try = 0, ecx = 0; try < AVC_CACHE_SLOTS; try++) {
 		hvalue = atomic_inc_return(&avc->avc_cache.lru_hint) &
 			(AVC_CACHE_SLOTS - 1);
@@ -573,6 +679,81 @@ static struct avc_node *avc_lookup(struct selinux_avc *avc,
 	return NULL;
 }
 
+static inline int avc_fcache_hash(u32 ssid, u32 tsid, u16 tclass)
+{
+	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_FCACHE_SLOTS - 1);
+}
+
+/*
+ * Invalidate all front caches.  Must be called after any change that can
+ * alter what a cached decision would be, ie. a policy reload or a node
+ * update.
+ */
+static void avc_fcache_invalidate(struct selinux_avc *avc)
+{
+	/* Order the cache change before the generation bump so that a
+	 * checker that observes the new generation also observes the new
+	 * cache contents (pairs with the barrier in avc_has_perm_noaudit()).
+	 */
+	smp_mb__before_atomic();
+	atomic_inc(&avc->avc_cache.fcache_gen);
+}
+
+/*
+ * Look up a decision in this CPU's front cache.  @gen is the generation
+ * sampled by the caller before consulting any cache.
+ */
+static bool avc_fcache_lookup(u32 ssid, u32 tsid, u16 tclass,
+			      u32 gen, struct av_decision *avd)
+{
+	struct avc_fcache_entry *entry;
+	unsigned int seq;
+
+	/* Racing with migration is fine; the seqcount covers remote access */
+	entry = raw_cpu_ptr(&avc_fcache.entries[avc_fcache_hash(ssid, tsid,
+								tclass)]);
+
+	do {
+		seq = read_seqcount_begin(&entry->seq);
+		if (entry->gen != gen || entry->ssid != ssid ||
+		    entry->tsid != tsid || entry->tclass != tclass)
+			return false;
+		*avd = entry->avd;
+	} while (read_seqcount_retry(&entry->seq, seq));
+
+	avc_cache_stats_incr(lookups);
+	avc_cache_stats_incr(front_hits);
+	return true;
+}
+
+/*
+ * Install a decision in this CPU's front cache.  @gen is the generation
+ * sampled before the decision was obtained; if it has moved on in the
+ * meantime the decision may already be stale and is not cached.
+ */
+static void avc_fcache_insert(struct selinux_avc *avc,
+			      u32 ssid, u32 tsid, u16 tclass,
+			      const struct av_decision *avd, u32 gen)
+{
+	struct avc_fcache_entry *entry;
+	unsigned long flags;
+
+	if (gen != atomic_read(&avc->avc_cache.fcache_gen))
+		return;
+
+	local_lock_irqsave(&avc_fcache.lock, flags);
+	entry = this_cpu_ptr(&avc_fcache.entries[avc_fcache_hash(ssid, tsid,
+								 tclass)]);
+	write_seqcount_begin(&entry->seq);
+	entry->ssid = ssid;
+	entry->tsid = tsid;
+	entry->tclass = tclass;
+	entry->gen = gen;
+	entry->avd = *avd;
+	write_seqcount_end(&entry->seq);
+	local_unlock_irqrestore(&avc_fcache.lock, flags);
+}
+
 static int avc_latest_notif_update(struct selinux_avc *avc,
 				   int seqno, int is_insert)
 {
@@ -927,6 +1108,7 @@ static int avc_update_node(struct selinux_avc *avc,
 		break;
 	}
 	avc_node_replace(avc, node, orig);
+	avc_fcache_invalidate(avc);
 out_unlock:
 	spin_unlock_irqrestore(lock, flag);
 out:
@@ -960,6 +1142,8 @@ static void avc_flush(struct selinux_avc *avc)
 		rcu_read_unlock();
 		spin_unlock_irqrestore(lock, flag);
 	}
+
+	avc_fcache_invalidate(avc);
 }
 
 /**
@@ -1142,18 +1326,28 @@ inline int avc_has_perm_noaudit(struct selinux_state *state,
 	struct avc_node *node;
 	struct avc_xperms_node xp_node;
 	int rc = 0;
-	u32 denied;
+	u32 denied, gen;
 
 	if (WARN_ON(!requested))
 		return -EACCES;
 
 	rcu_read_lock();
 
-	node = avc_lookup(state->avc, ssid, tsid, tclass);
-	if (unlikely(!node))
-		avc_compute_av(state, ssid, tsid, tclass, avd, &xp_node);
-	else
-		memcpy(avd, &node->ae.avd, sizeof(*avd));
+	gen = atomic_read(&state->avc->avc_cache.fcache_gen);
+	/* Order the generation read before the cache and table reads
+	 * (pairs with avc_fcache_invalidate()).
+	 */
+	smp_rmb();
+
+	if (!avc_fcache_lookup(ssid, tsid, tclass, gen, avd)) {
+		node = avc_lookup(state->avc, ssid, tsid, tclass);
+		if (unlikely(!node))
+			avc_compute_av(state, ssid, tsid, tclass, avd,
+				       &xp_node);
+		else
+			memcpy(avd, &node->ae.avd, sizeof(*avd));
+		avc_fcache_insert(state->avc, ssid, tsid, tclass, avd, gen);
+	}
 
 	denied = requested & ~(avd->allowed);
 	if (unlikely(denied))
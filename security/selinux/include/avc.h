@@ -39,6 +39,7 @@ struct avc_cache_stats {
 	unsigned int allocations;
 	unsigned int reclaims;
 	unsigned int frees;
+	unsigned int front_hits;	/* hits in the per-CPU front cache */
 };
 
 /*
@@ -1647,14 +1647,14 @@ static int sel_avc_stats_seq_show(struct seq_file *seq, void *v)
 
 	if (v == SEQ_START_TOKEN) {
 		seq_puts(seq,
-			 "lookups hits misses allocations reclaims frees\n");
+			 "lookups hits misses allocations reclaims frees front_hits\n");
 	} else {
 		unsigned int lookups = st->lookups;
 		unsigned int misses = st->misses;
 		unsigned int hits = lookups - misses;
-		seq_printf(seq, "%u %u %u %u %u %u\n", lookups,
+		seq_printf(seq, "%u %u %u %u %u %u %u\n", lookups,
 			   hits, misses, st->allocations,
-			   st->reclaims, st->frees);
+			   st->reclaims, st->frees, st->front_hits);
 	}
 	return 0;
 }
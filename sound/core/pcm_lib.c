@@ -1851,6 +1851,135 @@ void snd_pcm_period_elapsed(struct snd_pcm_substream *substream)
 }
 EXPORT_SYMBOL(snd_pcm_period_elapsed);
 
+/*
+ * Shared period tick: report the elapsed period for every member of the
+ * group from a single hrtimer expiry.  Each stream is still updated under
+ * its own stream lock, but the per-stream timers (and their per-period
+ * interrupts) are replaced by one tick per group.
+ */
+static enum hrtimer_restart snd_pcm_period_group_tick(struct hrtimer *timer)
+{
+	struct snd_pcm_period_group *group =
+		container_of(timer, struct snd_pcm_period_group, timer);
+	struct snd_pcm_substream *substream;
+	unsigned long flags;
+
+	spin_lock_irqsave(&group->lock, flags);
+	list_for_each_entry(substream, &group->substreams, period_group_link)
+		snd_pcm_period_elapsed(substream);
+	spin_unlock_irqrestore(&group->lock, flags);
+
+	hrtimer_forward_now(timer, group->period);
+	return HRTIMER_RESTART;
+}
+
+/**
+ * snd_pcm_period_group_init() - initialize a period group.
+ * @group: the group to initialize.
+ *
+ * A period group batches the period-elapsed bookkeeping of many substreams
+ * whose data transmission is driven by the same clock; e.g. the substreams
+ * of a virtual or loopback card.  Instead of arming one timer per stream,
+ * the driver adds the substreams to a group and starts the group with the
+ * common period; every member is then processed in one shared tick.
+ */
+void snd_pcm_period_group_init(struct snd_pcm_period_group *group)
+{
+	spin_lock_init(&group->lock);
+	INIT_LIST_HEAD(&group->substreams);
+	hrtimer_init(&group->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	group->timer.function = snd_pcm_period_group_tick;
+	group->period = 0;
+	group->running = false;
+}
+EXPORT_SYMBOL(snd_pcm_period_group_init);
+
+/**
+ * snd_pcm_period_group_add() - add a substream to a period group.
+ * @group: the group to add to.
+ * @substream: the instance of PCM substream.
+ *
+ * The caller guarantees that the substream's data transmission is aligned
+ * to the group clock, and that the substream is removed from the group
+ * before it's closed.  Must not be called under the stream lock.
+ *
+ * Return: Zero if successful, or -EBUSY if already grouped.
+ */
+int snd_pcm_period_group_add(struct snd_pcm_period_group *group,
+			     struct snd_pcm_substream *substream)
+{
+	unsigned long flags;
+
+	if (substream->period_group)
+		return -EBUSY;
+
+	spin_lock_irqsave(&group->lock, flags);
+	list_add_tail(&substream->period_group_link, &group->substreams);
+	substream->period_group = group;
+	spin_unlock_irqrestore(&group->lock, flags);
+	return 0;
+}
+EXPORT_SYMBOL(snd_pcm_period_group_add);
+
+/**
+ * snd_pcm_period_group_remove() - remove a substream from a period group.
+ * @group: the group to remove from.
+ * @substream: the instance of PCM substream.
+ *
+ * Must not be called under the stream lock.  On return the substream is
+ * guaranteed not to be visited by the group tick any longer.
+ */
+void snd_pcm_period_group_remove(struct snd_pcm_period_group *group,
+				 struct snd_pcm_substream *substream)
+{
+	unsigned long flags;
+
+	if (snd_BUG_ON(substream->period_group != group))
+		return;
+
+	spin_lock_irqsave(&group->lock, flags);
+	list_del_init(&substream->period_group_link);
+	substream->period_group = NULL;
+	spin_unlock_irqrestore(&group->lock, flags);
+}
+EXPORT_SYMBOL(snd_pcm_period_group_remove);
+
+/**
+ * snd_pcm_period_group_start() - start the shared period tick.
+ * @group: the group to start.
+ * @period: the period duration common to all members.
+ *
+ * Return: Zero if successful, or a negative error code.
+ */
+int snd_pcm_period_group_start(struct snd_pcm_period_group *group,
+			       ktime_t period)
+{
+	if (ktime_to_ns(period) <= 0)
+		return -EINVAL;
+	if (group->running)
+		return -EBUSY;
+
+	group->period = period;
+	group->running = true;
+	hrtimer_start(&group->timer, period, HRTIMER_MODE_REL);
+	return 0;
+}
+EXPORT_SYMBOL(snd_pcm_period_group_start);
+
+/**
+ * snd_pcm_period_group_stop() - stop the shared period tick.
+ * @group: the group to stop.
+ *
+ * Waits until a concurrently running tick has finished.  The membership
+ * of the group is left untouched.
+ */
+void snd_pcm_period_group_stop(struct snd_pcm_period_group *group)
+{
+	hrtimer_cancel(&group->timer);
+	group->running = false;
+}
+EXPORT_SYMBOL(snd_pcm_period_group_stop);
+
 /*
  * Wait until avail_min data becomes available
  * Returns a negative error code if any error occurs during operation.
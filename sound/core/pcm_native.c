@@ -3015,6 +3015,76 @@ static snd_pcm_sframes_t snd_pcm_forward(struct snd_pcm_substream *substream,
 	return ret;
 }
 
+/* max number of entries accepted by a single bulk commit */
+#define SND_PCM_BULK_COMMIT_MAX		1024
+
+/*
+ * Commit the appl_ptr of many mmap'ed substreams with one syscall.  Each
+ * entry names a PCM file descriptor and the number of frames to forward;
+ * the frames field is updated in place with the processed count or a
+ * negative error code.  Entries are processed independently, so one
+ * xrun'ed stream doesn't fail the whole batch.
+ */
+static int snd_pcm_forward_bulk(struct snd_pcm_substream *substream,
+				struct snd_pcm_bulk_commit __user *_bulk)
+{
+	struct snd_pcm_bulk_commit bulk;
+	struct snd_pcm_bulk_commit_entry *entries;
+	size_t size;
+	unsigned int i;
+	int err = 0;
+
+	if (copy_from_user(&bulk, _bulk, sizeof(bulk)))
+		return -EFAULT;
+	if (bulk.reserved)
+		return -EINVAL;
+	if (!bulk.count || bulk.count > SND_PCM_BULK_COMMIT_MAX)
+		return -EINVAL;
+
+	size = array_size(bulk.count, sizeof(*entries));
+	entries = kmalloc(size, GFP_KERNEL);
+	if (!entries)
+		return -ENOMEM;
+	if (copy_from_user(entries, _bulk->entries, size)) {
+		err = -EFAULT;
+		goto out;
+	}
+
+	for (i = 0; i < bulk.count; i++) {
+		struct snd_pcm_bulk_commit_entry *entry = &entries[i];
+		struct snd_pcm_file *pcm_file;
+		struct fd f;
+
+		if (entry->reserved || entry->frames < 0) {
+			entry->frames = -EINVAL;
+			continue;
+		}
+		f = fdget(entry->fd);
+		if (!f.file) {
+			entry->frames = -EBADFD;
+			continue;
+		}
+		if (!is_pcm_file(f.file)) {
+			fdput(f);
+			entry->frames = -EBADFD;
+			continue;
+		}
+		pcm_file = f.file->private_data;
+		if (PCM_RUNTIME_CHECK(pcm_file->substream))
+			entry->frames = -ENXIO;
+		else
+			entry->frames = snd_pcm_forward(pcm_file->substream,
+							entry->frames);
+		fdput(f);
+	}
+
+	if (copy_to_user(_bulk->entries, entries, size))
+		err = -EFAULT;
+out:
+	kfree(entries);
+	return err;
+}
+
 static int snd_pcm_delay(struct snd_pcm_substream *substream,
 			 snd_pcm_sframes_t *delay)
 {
@@ -3393,6 +3463,8 @@ static int snd_pcm_common_ioctl(struct file *file,
 		return snd_pcm_rewind_ioctl(substream, arg);
 	case SNDRV_PCM_IOCTL_FORWARD:
 		return snd_pcm_forward_ioctl(substream, arg);
+	case SNDRV_PCM_IOCTL_FORWARD_BULK:
+		return snd_pcm_forward_bulk(substream, arg);
 	}
 	pcm_dbg(substream->pcm, "unknown ioctl = 0x%x\n", cmd);
 	return -ENOTTY;
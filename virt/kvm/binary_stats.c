@@ -7,7 +7,10 @@
 
 #include <linux/kvm_host.h>
 #include <linux/kvm.h>
+#include <linux/anon_inodes.h>
 #include <linux/errno.h>
+#include <linux/file.h>
+#include <linux/mm.h>
 #include <linux/uaccess.h>
 
 /**
@@ -142,3 +145,250 @@ ssize_t kvm_stats_read(char *id, const struct kvm_stats_header *header,
 	*offset = pos;
 	return len;
 }
+
+/*
+ * Streaming statistics file descriptor, one per VM, covering all vCPUs.
+ *
+ * Agents that sample thousands of per-vCPU stats fds re-read full stats
+ * blocks that are mostly unchanged.  The stream instead starts with the
+ * shared vCPU descriptor block (header, VM id string, descriptors - the
+ * same layout a per-vCPU fd serves, sent exactly once), and every
+ * subsequent read returns packed records carrying only the stats words
+ * that changed since the previous read:
+ *
+ *   struct kvm_stats_stream_record  (vcpu_idx, ndeltas)
+ *   ndeltas x struct kvm_stats_stream_delta  (word index, new value)
+ *
+ * A delta's index is the u64 word offset within the per-vCPU stats data
+ * block; userspace maps it back to a stat via the descriptor offsets it
+ * already parsed.  vCPUs created after the stream was opened simply show
+ * up with all their non-zero stats on the next read.  A read returning 0
+ * means nothing changed.
+ */
+struct kvm_stats_stream_record {
+	__u32 vcpu_idx;
+	__u32 ndeltas;
+};
+
+struct kvm_stats_stream_delta {
+	__u32 index;
+	__u64 value;
+} __packed;
+
+struct kvm_stats_stream {
+	struct kvm *kvm;
+	struct mutex lock;
+	bool descs_sent;
+	void *buf;		/* pending, partially consumed output */
+	size_t buf_size;
+	size_t buf_len;
+	size_t buf_pos;
+	unsigned long nr_snaps;	/* vCPUs with a previous-value snapshot */
+	u64 *snaps;
+};
+
+#define KVM_STATS_STREAM_WORDS	(sizeof(struct kvm_vcpu_stat) / sizeof(u64))
+
+static int kvm_stats_stream_reserve(struct kvm_stats_stream *stream,
+				    size_t size)
+{
+	void *buf;
+
+	if (size <= stream->buf_size)
+		return 0;
+
+	buf = kvmalloc(size, GFP_KERNEL_ACCOUNT);
+	if (!buf)
+		return -ENOMEM;
+
+	kvfree(stream->buf);
+	stream->buf = buf;
+	stream->buf_size = size;
+	return 0;
+}
+
+static int kvm_stats_stream_fill_descs(struct kvm_stats_stream *stream)
+{
+	size_t size_desc = kvm_vcpu_stats_header.num_desc *
+			   sizeof(struct _kvm_stats_desc);
+	void *pos;
+	int ret;
+
+	ret = kvm_stats_stream_reserve(stream, sizeof(kvm_vcpu_stats_header) +
+				       KVM_STATS_NAME_SIZE + size_desc);
+	if (ret)
+		return ret;
+
+	pos = stream->buf;
+	memcpy(pos, &kvm_vcpu_stats_header, sizeof(kvm_vcpu_stats_header));
+	pos += sizeof(kvm_vcpu_stats_header);
+	memcpy(pos, stream->kvm->stats_id, KVM_STATS_NAME_SIZE);
+	pos += KVM_STATS_NAME_SIZE;
+	memcpy(pos, &kvm_vcpu_stats_desc[0], size_desc);
+	pos += size_desc;
+
+	stream->buf_len = pos - stream->buf;
+	stream->buf_pos = 0;
+	return 0;
+}
+
+static int kvm_stats_stream_fill_deltas(struct kvm_stats_stream *stream)
+{
+	struct kvm *kvm = stream->kvm;
+	unsigned long nvcpus = atomic_read(&kvm->online_vcpus);
+	struct kvm_vcpu *vcpu;
+	unsigned long i;
+	void *pos;
+	int ret;
+
+	/* vCPUs are only ever added; extend the snapshots with zeroes. */
+	if (nvcpus > stream->nr_snaps) {
+		u64 *snaps;
+
+		snaps = kvcalloc(nvcpus, KVM_STATS_STREAM_WORDS *
+				 sizeof(u64), GFP_KERNEL_ACCOUNT);
+		if (!snaps)
+			return -ENOMEM;
+
+		if (stream->nr_snaps)
+			memcpy(snaps, stream->snaps, stream->nr_snaps *
+			       KVM_STATS_STREAM_WORDS * sizeof(u64));
+		kvfree(stream->snaps);
+		stream->snaps = snaps;
+		stream->nr_snaps = nvcpus;
+	}
+
+	ret = kvm_stats_stream_reserve(stream, nvcpus *
+			(sizeof(struct kvm_stats_stream_record) +
+			 KVM_STATS_STREAM_WORDS *
+			 sizeof(struct kvm_stats_stream_delta)));
+	if (ret)
+		return ret;
+
+	pos = stream->buf;
+	kvm_for_each_vcpu(i, vcpu, kvm) {
+		struct kvm_stats_stream_record *rec = pos;
+		struct kvm_stats_stream_delta *delta = pos + sizeof(*rec);
+		u64 *snap = &stream->snaps[(size_t)vcpu->vcpu_idx *
+					   KVM_STATS_STREAM_WORDS];
+		u64 *cur = (u64 *)&vcpu->stat;
+		u32 n = 0;
+		size_t w;
+
+		if (vcpu->vcpu_idx >= stream->nr_snaps)
+			continue;
+
+		/*
+		 * Stats are updated without locking; torn or slightly stale
+		 * values are as acceptable here as they are for the regular
+		 * stats fds.
+		 */
+		for (w = 0; w < KVM_STATS_STREAM_WORDS; w++) {
+			u64 val = READ_ONCE(cur[w]);
+
+			if (val == snap[w])
+				continue;
+			snap[w] = val;
+			delta[n].index = w;
+			delta[n].value = val;
+			n++;
+		}
+
+		if (!n)
+			continue;
+
+		rec->vcpu_idx = vcpu->vcpu_idx;
+		rec->ndeltas = n;
+		pos += sizeof(*rec) + n * sizeof(*delta);
+	}
+
+	stream->buf_len = pos - stream->buf;
+	stream->buf_pos = 0;
+	return 0;
+}
+
+static ssize_t kvm_stats_stream_read(struct file *file,
+				     char __user *user_buffer,
+				     size_t size, loff_t *offset)
+{
+	struct kvm_stats_stream *stream = file->private_data;
+	ssize_t copylen;
+	int ret = 0;
+
+	mutex_lock(&stream->lock);
+
+	if (stream->buf_pos == stream->buf_len) {
+		if (!stream->descs_sent) {
+			ret = kvm_stats_stream_fill_descs(stream);
+			if (!ret)
+				stream->descs_sent = true;
+		} else {
+			ret = kvm_stats_stream_fill_deltas(stream);
+		}
+		if (ret)
+			goto out_unlock;
+	}
+
+	copylen = min(size, stream->buf_len - stream->buf_pos);
+	if (copylen &&
+	    copy_to_user(user_buffer, stream->buf + stream->buf_pos, copylen)) {
+		ret = -EFAULT;
+		goto out_unlock;
+	}
+	stream->buf_pos += copylen;
+	ret = copylen;
+
+out_unlock:
+	mutex_unlock(&stream->lock);
+	return ret;
+}
+
+static int kvm_stats_stream_release(struct inode *inode, struct file *file)
+{
+	struct kvm_stats_stream *stream = file->private_data;
+
+	kvm_put_kvm(stream->kvm);
+	kvfree(stream->snaps);
+	kvfree(stream->buf);
+	kfree(stream);
+	return 0;
+}
+
+static const struct file_operations kvm_stats_stream_fops = {
+	.read = kvm_stats_stream_read,
+	.release = kvm_stats_stream_release,
+	.llseek = noop_llseek,
+};
+
+int kvm_vm_create_stats_stream_fd(struct kvm *kvm)
+{
+	struct kvm_stats_stream *stream;
+	struct file *file;
+	int fd;
+
+	stream = kzalloc(sizeof(*stream), GFP_KERNEL_ACCOUNT);
+	if (!stream)
+		return -ENOMEM;
+
+	mutex_init(&stream->lock);
+	stream->kvm = kvm;
+
+	fd = get_unused_fd_flags(O_CLOEXEC);
+	if (fd < 0) {
+		kfree(stream);
+		return fd;
+	}
+
+	file = anon_inode_getfile("kvm-vm-stats-stream",
+				  &kvm_stats_stream_fops, stream, O_RDONLY);
+	if (IS_ERR(file)) {
+		put_unused_fd(fd);
+		kfree(stream);
+		return PTR_ERR(file);
+	}
+
+	kvm_get_kvm(kvm);
+	fd_install(fd, file);
+
+	return fd;
+}
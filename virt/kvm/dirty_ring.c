@@ -6,11 +6,21 @@
  */
 #include <linux/kvm_host.h>
 #include <linux/kvm.h>
+#include <linux/module.h>
 #include <linux/vmalloc.h>
 #include <linux/kvm_dirty_ring.h>
 #include <trace/events/kvm.h>
 #include "kvm_mm.h"
 
+/*
+ * When the ring goes soft full and the VM runs in ring+bitmap mode, let
+ * the vcpu harvest its own ring into the memslot dirty bitmaps instead
+ * of stopping until userspace resets the ring.  Userspace picks the
+ * spilled pages up via KVM_GET_DIRTY_LOG as it already must in that mode.
+ */
+static bool dirty_ring_auto_harvest;
+module_param(dirty_ring_auto_harvest, bool, 0644);
+
 int __weak kvm_cpu_dirty_log_size(void)
 {
 	return 0;
@@ -82,6 +92,7 @@ int kvm_dirty_ring_alloc(struct kvm_dirty_ring *ring, int index, u32 size)
 	ring->dirty_index = 0;
 	ring->reset_index = 0;
 	ring->index = index;
+	spin_lock_init(&ring->reset_lock);
 
 	return 0;
 }
@@ -113,6 +124,8 @@ int kvm_dirty_ring_reset(struct kvm *kvm, struct kvm_dirty_ring *ring)
 	/* This is only needed to make compilers happy */
 	cur_slot = cur_offset = mask = 0;
 
+	spin_lock(&ring->reset_lock);
+
 	while (true) {
 		entry = &ring->dirty_gfns[ring->reset_index & (ring->size - 1)];
 
@@ -156,6 +169,8 @@ int kvm_dirty_ring_reset(struct kvm *kvm, struct kvm_dirty_ring *ring)
 
 	kvm_reset_dirty_gfn(kvm, cur_slot, cur_offset, mask);
 
+	spin_unlock(&ring->reset_lock);
+
 	/*
 	 * The request KVM_REQ_DIRTY_RING_SOFT_FULL will be cleared
 	 * by the VCPU thread next time when it enters the guest.
@@ -166,6 +181,98 @@ int kvm_dirty_ring_reset(struct kvm *kvm, struct kvm_dirty_ring *ring)
 	return count;
 }
 
+static void kvm_dirty_ring_spill_gfn(struct kvm *kvm, u32 slot, u64 offset)
+{
+	struct kvm_memory_slot *memslot;
+	int as_id, id;
+
+	as_id = slot >> 16;
+	id = (u16)slot;
+
+	if (as_id >= KVM_ADDRESS_SPACE_NUM || id >= KVM_USER_MEM_SLOTS)
+		return;
+
+	memslot = id_to_memslot(__kvm_memslots(kvm, as_id), id);
+
+	if (!memslot || offset >= memslot->npages || !memslot->dirty_bitmap)
+		return;
+
+	set_bit_le(offset, memslot->dirty_bitmap);
+}
+
+/*
+ * Drain the whole ring into the memslot dirty bitmaps and re-arm the
+ * dirty traps, whether or not userspace has collected the entries yet.
+ * Pages that userspace collects concurrently are merely reported twice,
+ * once via the ring and once via the bitmap, which is benign.
+ *
+ * The caller must be in a SRCU read-side critical section of kvm->srcu
+ * to keep the memslots alive; slots_lock cannot be taken here as the
+ * vcpu is inside its SRCU read section and memslot updates synchronize
+ * SRCU while holding slots_lock.
+ */
+static int kvm_dirty_ring_harvest(struct kvm *kvm, struct kvm_dirty_ring *ring)
+{
+	u32 cur_slot, next_slot;
+	u64 cur_offset, next_offset;
+	unsigned long mask;
+	int count = 0;
+	struct kvm_dirty_gfn *entry;
+	bool first_round = true;
+
+	/* This is only needed to make compilers happy */
+	cur_slot = cur_offset = mask = 0;
+
+	spin_lock(&ring->reset_lock);
+
+	while (ring->reset_index != ring->dirty_index) {
+		entry = &ring->dirty_gfns[ring->reset_index & (ring->size - 1)];
+
+		next_slot = READ_ONCE(entry->slot);
+		next_offset = READ_ONCE(entry->offset);
+
+		kvm_dirty_ring_spill_gfn(kvm, next_slot, next_offset);
+
+		kvm_dirty_gfn_set_invalid(entry);
+
+		ring->reset_index++;
+		count++;
+		/*
+		 * Try to coalesce the reset operations when the guest is
+		 * scanning pages in the same slot.
+		 */
+		if (!first_round && next_slot == cur_slot) {
+			s64 delta = next_offset - cur_offset;
+
+			if (delta >= 0 && delta < BITS_PER_LONG) {
+				mask |= 1ull << delta;
+				continue;
+			}
+
+			/* Backwards visit, careful about overflows!  */
+			if (delta > -BITS_PER_LONG && delta < 0 &&
+			    (mask << -delta >> -delta) == mask) {
+				cur_offset = next_offset;
+				mask = (mask << -delta) | 1;
+				continue;
+			}
+		}
+		kvm_reset_dirty_gfn(kvm, cur_slot, cur_offset, mask);
+		cur_slot = next_slot;
+		cur_offset = next_offset;
+		mask = 1;
+		first_round = false;
+	}
+
+	kvm_reset_dirty_gfn(kvm, cur_slot, cur_offset, mask);
+
+	spin_unlock(&ring->reset_lock);
+
+	trace_kvm_dirty_ring_reset(ring);
+
+	return count;
+}
+
 void kvm_dirty_ring_push(struct kvm_vcpu *vcpu, u32 slot, u64 offset)
 {
 	struct kvm_dirty_ring *ring = &vcpu->dirty_ring;
@@ -201,6 +308,21 @@ bool kvm_dirty_ring_check_request(struct kvm_vcpu *vcpu)
 	 */
 	if (kvm_check_request(KVM_REQ_DIRTY_RING_SOFT_FULL, vcpu) &&
 	    kvm_dirty_ring_soft_full(&vcpu->dirty_ring)) {
+		/*
+		 * In ring+bitmap mode the ring overflow can be absorbed in
+		 * the kernel: spill the entries into the memslot bitmaps
+		 * and reset the ring, then let the vcpu keep running.
+		 */
+		if (READ_ONCE(dirty_ring_auto_harvest) &&
+		    vcpu->kvm->dirty_ring_with_bitmap) {
+			if (kvm_dirty_ring_harvest(vcpu->kvm,
+						   &vcpu->dirty_ring))
+				kvm_flush_remote_tlbs(vcpu->kvm);
+
+			if (!kvm_dirty_ring_soft_full(&vcpu->dirty_ring))
+				return false;
+		}
+
 		kvm_make_request(KVM_REQ_DIRTY_RING_SOFT_FULL, vcpu);
 		vcpu->run->exit_reason = KVM_EXIT_DIRTY_RING_FULL;
 		trace_kvm_dirty_ring_exit(vcpu);
@@ -26,11 +26,14 @@ void gfn_to_pfn_cache_invalidate_start(struct kvm *kvm, unsigned long start,
 				       unsigned long end, bool may_block)
 {
 	DECLARE_BITMAP(vcpu_bitmap, KVM_MAX_VCPUS);
+	struct interval_tree_node *node;
 	struct gfn_to_pfn_cache *gpc;
 	bool evict_vcpus = false;
 
 	spin_lock(&kvm->gpc_lock);
-	list_for_each_entry(gpc, &kvm->gpc_list, list) {
+	for (node = interval_tree_iter_first(&kvm->gpc_itree, start, end - 1);
+	     node; node = interval_tree_iter_next(node, start, end - 1)) {
+		gpc = container_of(node, struct gfn_to_pfn_cache, node);
 		write_lock_irq(&gpc->lock);
 
 		/* Only a single page so no need to care about length */
@@ -137,6 +140,31 @@ static inline bool mmu_notifier_retry_cache(struct kvm *kvm, unsigned long mmu_s
 	return kvm->mmu_invalidate_seq != mmu_seq;
 }
 
+/*
+ * (Re)position the cache in the VM's interval tree to cover the page
+ * backing gpc->uhva.  Must be done while gpc->valid is false and before
+ * it can become true again, so that mmu_notifier events targeting the
+ * new uhva find the cache once a mapping is established.
+ */
+static void gpc_reindex(struct gfn_to_pfn_cache *gpc)
+{
+	struct kvm *kvm = gpc->kvm;
+	unsigned long start = gpc->uhva & PAGE_MASK;
+
+	lockdep_assert_held(&gpc->refresh_lock);
+
+	if (!RB_EMPTY_NODE(&gpc->node.rb) && gpc->node.start == start)
+		return;
+
+	spin_lock(&kvm->gpc_lock);
+	if (!RB_EMPTY_NODE(&gpc->node.rb))
+		interval_tree_remove(&gpc->node, &kvm->gpc_itree);
+	gpc->node.start = start;
+	gpc->node.last = start + PAGE_SIZE - 1;
+	interval_tree_insert(&gpc->node, &kvm->gpc_itree);
+	spin_unlock(&kvm->gpc_lock);
+}
+
 static kvm_pfn_t hva_to_pfn_retry(struct gfn_to_pfn_cache *gpc)
 {
 	/* Note, the new page offset may be different than the old! */
@@ -162,6 +190,9 @@ static kvm_pfn_t hva_to_pfn_retry(struct gfn_to_pfn_cache *gpc)
 
 		write_unlock_irq(&gpc->lock);
 
+		/* No-op on all but the first iteration. */
+		gpc_reindex(gpc);
+
 		/*
 		 * If the previous iteration "failed" due to an mmu_notifier
 		 * event, release the pfn and unmap the kernel virtual address
@@ -345,6 +376,7 @@ void kvm_gpc_init(struct gfn_to_pfn_cache *gpc, struct kvm *kvm,
 
 	rwlock_init(&gpc->lock);
 	mutex_init(&gpc->refresh_lock);
+	RB_CLEAR_NODE(&gpc->node.rb);
 
 	gpc->kvm = kvm;
 	gpc->vcpu = vcpu;
@@ -362,14 +394,11 @@ int kvm_gpc_activate(struct gfn_to_pfn_cache *gpc, gpa_t gpa, unsigned long len)
 		if (KVM_BUG_ON(gpc->valid, kvm))
 			return -EIO;
 
-		spin_lock(&kvm->gpc_lock);
-		list_add(&gpc->list, &kvm->gpc_list);
-		spin_unlock(&kvm->gpc_lock);
-
 		/*
-		 * Activate the cache after adding it to the list, a concurrent
-		 * refresh must not establish a mapping until the cache is
-		 * reachable by mmu_notifier events.
+		 * The cache is inserted into the interval tree by the refresh
+		 * below, once the uhva it maps is known; a mapping cannot be
+		 * established before the cache is reachable by mmu_notifier
+		 * events.
 		 */
 		write_lock_irq(&gpc->lock);
 		gpc->active = true;
@@ -399,7 +428,7 @@ void kvm_gpc_deactivate(struct gfn_to_pfn_cache *gpc)
 		 * Leave the GPA => uHVA cache intact, it's protected by the
 		 * memslot generation.  The PFN lookup needs to be redone every
 		 * time as mmu_notifier protection is lost when the cache is
-		 * removed from the VM's gpc_list.
+		 * removed from the VM's interval tree.
 		 */
 		old_khva = gpc->khva - offset_in_page(gpc->khva);
 		gpc->khva = NULL;
@@ -409,7 +438,10 @@ void kvm_gpc_deactivate(struct gfn_to_pfn_cache *gpc)
 		write_unlock_irq(&gpc->lock);
 
 		spin_lock(&kvm->gpc_lock);
-		list_del(&gpc->list);
+		if (!RB_EMPTY_NODE(&gpc->node.rb)) {
+			interval_tree_remove(&gpc->node, &kvm->gpc_itree);
+			RB_CLEAR_NODE(&gpc->node.rb);
+		}
 		spin_unlock(&kvm->gpc_lock);
 
 		gpc_unmap_khva(old_pfn, old_khva);